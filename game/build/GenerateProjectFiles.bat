@@ -182,7 +182,7 @@ echo INCLUDES = -I$^(CORE_DIR^) -I$^(CLASSES_DIR^) -I$^(WORLD_DIR^) -I$^(SYSTEMS
 echo.
 echo # Compiler and linker flags
 echo C_FLAGS = -Wall -O2 $^(INCLUDES^)
-echo SQLITE_FLAGS = -w -O2 -DSQLITE_THREADSAFE=0 -DSQLITE_OMIT_LOAD_EXTENSION -DSQLITE_DEFAULT_MEMSTATUS=0 $^(INCLUDES^)
+echo SQLITE_FLAGS = -w -O2 -DSQLITE_THREADSAFE=2 -DSQLITE_OMIT_LOAD_EXTENSION -DSQLITE_DEFAULT_MEMSTATUS=0 $^(INCLUDES^)
 echo LUA_FLAGS = -w -O2 $^(INCLUDES^)
 echo L_FLAGS = -lz -lcrypt -lpthread -ldl -lm
 echo.
@@ -416,7 +416,7 @@ for %%d in (%SUBDIRS%) do (
             for %%n in (%%~nf) do (
                 if /i "%%n"=="sqlite3" (
                     echo     ^<ClCompile Include="%%f"^>>> dystopia.vcxproj
-                    echo       ^<PreprocessorDefinitions^>SQLITE_THREADSAFE=0;SQLITE_OMIT_LOAD_EXTENSION;SQLITE_DEFAULT_MEMSTATUS=0;%%(PreprocessorDefinitions^)^</PreprocessorDefinitions^>>> dystopia.vcxproj
+                    echo       ^<PreprocessorDefinitions^>SQLITE_THREADSAFE=2;SQLITE_OMIT_LOAD_EXTENSION;SQLITE_DEFAULT_MEMSTATUS=0;%%(PreprocessorDefinitions^)^</PreprocessorDefinitions^>>> dystopia.vcxproj
                     echo       ^<WarningLevel^>TurnOffAllWarnings^</WarningLevel^>>> dystopia.vcxproj
                     echo     ^</ClCompile^>>> dystopia.vcxproj
                 ) else if /i "%%n"=="lua_lib" (
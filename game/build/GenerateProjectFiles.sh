@@ -118,9 +118,9 @@ INCLUDES = -I$(CORE_DIR) -I$(CLASSES_DIR) -I$(WORLD_DIR) -I$(SYSTEMS_DIR) -I$(DB
 
 # Compiler and linker flags
 C_FLAGS = -Wall -O2 $(INCLUDES)
-SQLITE_FLAGS = -w -O2 -DSQLITE_THREADSAFE=0 -DSQLITE_OMIT_LOAD_EXTENSION -DSQLITE_DEFAULT_MEMSTATUS=0 $(INCLUDES)
+SQLITE_FLAGS = -w -O2 -DSQLITE_THREADSAFE=2 -DSQLITE_OMIT_LOAD_EXTENSION -DSQLITE_DEFAULT_MEMSTATUS=0 $(INCLUDES)
 LUA_FLAGS = -w -O2 $(INCLUDES)
-L_FLAGS = -lz -lcrypt -lpthread -ldl -lm
+L_FLAGS = -lz -lcrypt -lpthread -ldl -lm -rdynamic
 
 MAKEFILE_HEADER
 
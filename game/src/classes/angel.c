@@ -26,6 +26,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_spiritform( CHAR_DATA *ch, char *argument ) {
 	if ( IS_NPC( ch ) ) return;
@@ -231,7 +232,7 @@ void do_harmony( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 	level = number_range( 100, 200 );
-	sn = skill_lookup( "spirit kiss" );
+	sn = gsn_spirit_kiss;
 	if ( sn > 0 ) ( *skill_table[sn].spell_fun )( sn, level, ch, victim );
 	WAIT_STATE( ch, cfg( CFG_ABILITY_ANGEL_HARMONY_COOLDOWN ) );
 	return;
@@ -582,3 +583,26 @@ void do_eyeforaneye( CHAR_DATA *ch, char *argument ) {
 void do_angelicarmor( CHAR_DATA *ch, char *argument ) {
 	do_classarmor_generic( ch, argument, CLASS_ANGEL );
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static int dam_angel( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	/*
+	 * This one for angels have no effect, take a look and rebalance. Jobo
+	 */
+	dam *= ( 1 + ch->pcdata->powers[ANGEL_JUSTICE] / 10 );
+	return dam;
+}
+
+const CLASS_OPS class_ops_angel = {
+	CLASS_ANGEL,
+	class_regen_item, /* regen */
+	update_angel,     /* tick */
+	FALSE,            /* tick_first */
+	NULL,             /* prompt */
+	dam_angel,        /* dam_mod */
+	NULL,             /* dam_mod_late */
+	NULL              /* minion_death */
+};
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "artificer.h"
 #include "../db/db_class.h"
 #include "../systems/quest_new.h"
@@ -312,7 +313,7 @@ void do_turret( CHAR_DATA *ch, char *argument ) {
 	char_to_room( turret, ch->in_room );
 	add_follower( turret, ch );
 
-	af.type = skill_lookup( "charm person" );
+	af.type = gsn_charm_person;
 	af.duration = 666;
 	af.location = APPLY_NONE;
 	af.modifier = 0;
@@ -1035,7 +1036,7 @@ void do_techtrain( CHAR_DATA *ch, char *argument ) {
 			send_to_char( buf, ch );
 		}
 	}
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "techtrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "techtrain", 1 );
 	return;
 }
 
@@ -1220,3 +1221,26 @@ void artificer_turret_attacks( CHAR_DATA *ch ) {
 	}
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static void minion_death_artificer( CHAR_DATA *owner, CHAR_DATA *minion ) {
+	/* Decrement Artificer turret count if a turret was killed */
+	if ( minion->pIndexData->vnum == VNUM_ART_TURRET && owner->pcdata->powers[ART_TURRET_COUNT] > 0 ) {
+		owner->pcdata->powers[ART_TURRET_COUNT]--;
+		send_to_char( "One of your turrets has been destroyed!\n\r", owner );
+	}
+}
+
+const CLASS_OPS class_ops_artificer = {
+	CLASS_ARTIFICER,
+	NULL,                   /* regen */
+	update_artificer,       /* tick */
+	FALSE,                  /* tick_first */
+	class_prompt_rage,      /* prompt */
+	NULL,                   /* dam_mod */
+	NULL,                   /* dam_mod_late */
+	minion_death_artificer  /* minion_death */
+};
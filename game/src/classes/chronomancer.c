@@ -10,6 +10,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "chronomancer.h"
 #include "../db/db_class.h"
 #include "../systems/quest_new.h"
@@ -264,7 +265,7 @@ void do_timetrain( CHAR_DATA *ch, char *argument )
 			"#x215Time accelerates around you... Acceleration is now level %d.#n\n\r",
 			ch->pcdata->powers[CHRONO_TRAIN_ACCEL] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "timetrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "timetrain", 1 );
 		return;
 	}
 
@@ -288,7 +289,7 @@ void do_timetrain( CHAR_DATA *ch, char *argument )
 			"#x215Time slows to a crawl... Deceleration is now level %d.#n\n\r",
 			ch->pcdata->powers[CHRONO_TRAIN_DECEL] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "timetrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "timetrain", 1 );
 		return;
 	}
 
@@ -312,7 +313,7 @@ void do_timetrain( CHAR_DATA *ch, char *argument )
 			"#x215Your perception expands across timelines... Temporal Sight is now level %d.#n\n\r",
 			ch->pcdata->powers[CHRONO_TRAIN_SIGHT] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "timetrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "timetrain", 1 );
 		return;
 	}
 
@@ -1095,3 +1096,18 @@ void do_chronoarmor( CHAR_DATA *ch, char *argument )
 {
 	do_classarmor_generic( ch, argument, CLASS_CHRONOMANCER );
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_chronomancer = {
+	CLASS_CHRONOMANCER,
+	NULL,                /* regen */
+	update_chronomancer, /* tick */
+	FALSE,               /* tick_first */
+	class_prompt_rage,   /* prompt */
+	NULL,                /* dam_mod */
+	NULL,                /* dam_mod_late */
+	NULL                 /* minion_death */
+};
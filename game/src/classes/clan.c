@@ -2627,7 +2627,7 @@ void do_readaura( CHAR_DATA *ch, char *argument ) {
 		}
 
 		act( "$n examines $p intently.", ch, obj, NULL, TO_ROOM );
-		spell_identify( skill_lookup( "identify" ), ch->level, ch, obj );
+		spell_identify( gsn_identify, ch->level, ch, obj );
 		return;
 	}
 
@@ -3829,7 +3829,7 @@ void do_web( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 
-	if ( ( sn = skill_lookup( "web" ) ) < 0 ) return;
+	if ( ( sn = gsn_web ) < 0 ) return;
 	spelltype = skill_table[sn].target;
 	level = (int) ( ch_spl(ch)[spelltype] * 0.25 );
 	( *skill_table[sn].spell_fun )( sn, level, ch, victim );
@@ -3913,7 +3913,7 @@ void do_koryou( CHAR_DATA *ch, char *argument ) {
 			return;
 		}
 		act( "$n examines $p intently.", ch, obj, NULL, TO_ROOM );
-		spell_identify( skill_lookup( "identify" ), ch->level, ch, obj );
+		spell_identify( gsn_identify, ch->level, ch, obj );
 		return;
 	}
 
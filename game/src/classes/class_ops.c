@@ -0,0 +1,128 @@
+/***************************************************************************
+ *  class_ops.c - Per-class function table
+ *
+ *  See class_ops.h.  Each class file defines its own CLASS_OPS entry next
+ *  to the rest of the class; this file holds the hooks several classes
+ *  share, the registry of entries and the lookup index built from it.
+ ***************************************************************************/
+
+#include "merc.h"
+#include "class_ops.h"
+#include "../db/db_class.h"
+
+const CLASS_OPS *class_ops_slot[CLASS_OPS_SLOTS];
+
+/* ===================================================================
+ * Shared hooks
+ * =================================================================== */
+
+void class_regen_item( CHAR_DATA *ch ) {
+	if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
+		update_arti_regen( ch );
+}
+
+bool class_prompt_rage( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code != 'R' )
+		return FALSE;
+	snprintf( buf, len, "#r%d#n", ch->rage );
+	return TRUE;
+}
+
+/* %d: demon, drow, tanarri and droid power */
+bool class_prompt_power( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code != 'd' )
+		return FALSE;
+	snprintf( buf, len, "%s%d#n", col_scale_code( ch->pcdata->stats[8], ch->pcdata->stats[9] > 0 ? ch->pcdata->stats[9] : ch->pcdata->stats[8] ), ch->pcdata->stats[8] );
+	return TRUE;
+}
+
+/* %D on top of %d: demon and drow */
+bool class_prompt_power_total( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code != 'D' )
+		return class_prompt_power( ch, code, buf, len );
+	snprintf( buf, len, "#C%d#n", ch->pcdata->stats[9] );
+	return TRUE;
+}
+
+/* ===================================================================
+ * The registry
+ * =================================================================== */
+
+const CLASS_OPS class_ops_none = { 0 };
+
+/* No class: only regenerates from ITEMA_REGENERATE */
+const CLASS_OPS class_ops_classless = { 0, class_regen_item };
+
+static const CLASS_OPS *const class_ops_all[] = {
+	&class_ops_demon,
+	&class_ops_mage,
+	&class_ops_werewolf,
+	&class_ops_vampire,
+	&class_ops_samurai,
+	&class_ops_drow,
+	&class_ops_monk,
+	&class_ops_ninja,
+	&class_ops_lich,
+	&class_ops_shapeshifter,
+	&class_ops_tanarri,
+	&class_ops_angel,
+	&class_ops_undead_knight,
+	&class_ops_droid,
+	&class_ops_dirgesinger,
+	&class_ops_siren,
+	&class_ops_psion,
+	&class_ops_mindflayer,
+	&class_ops_dragonkin,
+	&class_ops_wyrm,
+	&class_ops_artificer,
+	&class_ops_mechanist,
+	&class_ops_cultist,
+	&class_ops_voidborn,
+	&class_ops_chronomancer,
+	&class_ops_paradox,
+	&class_ops_shaman,
+	&class_ops_spiritlord,
+};
+
+#define CLASS_OPS_COUNT ( (int) ( sizeof( class_ops_all ) / sizeof( class_ops_all[0] ) ) )
+
+const CLASS_OPS *class_ops_by_id( int class_id ) {
+	int i;
+
+	for ( i = 0; i < CLASS_OPS_COUNT; i++ ) {
+		if ( class_ops_all[i]->class_id == class_id )
+			return class_ops_all[i];
+	}
+	return NULL;
+}
+
+/*
+ * Fill the slot index, then check it against the class registry so a
+ * class added to class.db without a table entry shows up in the log.
+ */
+void class_ops_init( void ) {
+	const CLASS_REGISTRY_ENTRY *reg;
+	int i, id, slot;
+
+	memset( class_ops_slot, 0, sizeof( class_ops_slot ) );
+	for ( i = 0; i < CLASS_OPS_COUNT; i++ ) {
+		id = class_ops_all[i]->class_id;
+		slot = ( id & -id ) % CLASS_OPS_SLOTS;
+		if ( id <= 0 || ( id & ( id - 1 ) ) != 0 || class_ops_slot[slot] != NULL ) {
+			bug( "Class_ops_init: bad or duplicate class id %d.", id );
+			continue;
+		}
+		class_ops_slot[slot] = class_ops_all[i];
+	}
+
+	for ( i = 0; ( reg = db_class_get_registry_by_index( i ) ) != NULL; i++ ) {
+		if ( class_ops_by_id( reg->class_id ) == NULL )
+			bug( "Class_ops_init: no CLASS_OPS entry for class %d.", reg->class_id );
+	}
+}
+
+bool class_prompt( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	const CLASS_OPS *ops = class_ops( ch );
+
+	return ops->prompt != NULL && ops->prompt( ch, code, buf, len );
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+ *  class_ops.h - Per-class function table
+ *
+ *  The per-pulse class work that used to walk an IS_CLASS() chain --
+ *  mobile_update()'s tick and regen, the class prompt codes, one_hit()'s
+ *  class damage multipliers and raw_kill()'s summon bookkeeping -- is
+ *  one CLASS_OPS entry per class, defined at the end of that class's own
+ *  file and listed in class_ops.c.  class_ops( ch ) finds the entry with
+ *  one table index; NULL members mean the class has no hook there.
+ *
+ *  The gates match the chains they replaced: NPCs and classed characters
+ *  below LEVEL_AVATAR get an empty entry, classless players get one that
+ *  only regenerates from ITEMA_REGENERATE.
+ ***************************************************************************/
+
+#ifndef CLASS_OPS_H
+#define CLASS_OPS_H
+
+typedef struct class_ops {
+	int class_id; /* CLASS_* constant, 0 for classless */
+
+	/* mobile_update(), heroes not AFK: regen, then tick, unless tick_first */
+	void ( *regen )( CHAR_DATA *ch );
+	void ( *tick )( CHAR_DATA *ch );
+	bool tick_first;
+
+	/* bust_a_prompt(): fill buf for a class prompt code, FALSE if not ours */
+	bool ( *prompt )( CHAR_DATA *ch, int code, char *buf, size_t len );
+
+	/* one_hit(): attacker multipliers before and after stance bonuses */
+	int ( *dam_mod )( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt );
+	int ( *dam_mod_late )( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt );
+
+	/* raw_kill(): an NPC whose ->wizard is this character died */
+	void ( *minion_death )( CHAR_DATA *owner, CHAR_DATA *minion );
+} CLASS_OPS;
+
+/*
+ * Class ids are single bits below 2^28, and ( id & -id ) % 37 is distinct
+ * for every power of two up to 2^35, so the lowest class bit indexes a
+ * 37-slot table directly.
+ */
+#define CLASS_OPS_SLOTS 37
+
+extern const CLASS_OPS *class_ops_slot[CLASS_OPS_SLOTS];
+extern const CLASS_OPS class_ops_none;
+extern const CLASS_OPS class_ops_classless;
+
+/* One entry per class, each in its class file */
+extern const CLASS_OPS class_ops_demon;
+extern const CLASS_OPS class_ops_mage;
+extern const CLASS_OPS class_ops_werewolf;
+extern const CLASS_OPS class_ops_vampire;
+extern const CLASS_OPS class_ops_samurai;
+extern const CLASS_OPS class_ops_drow;
+extern const CLASS_OPS class_ops_monk;
+extern const CLASS_OPS class_ops_ninja;
+extern const CLASS_OPS class_ops_lich;
+extern const CLASS_OPS class_ops_shapeshifter;
+extern const CLASS_OPS class_ops_tanarri;
+extern const CLASS_OPS class_ops_angel;
+extern const CLASS_OPS class_ops_undead_knight;
+extern const CLASS_OPS class_ops_droid;
+extern const CLASS_OPS class_ops_dirgesinger;
+extern const CLASS_OPS class_ops_siren;
+extern const CLASS_OPS class_ops_psion;
+extern const CLASS_OPS class_ops_mindflayer;
+extern const CLASS_OPS class_ops_dragonkin;
+extern const CLASS_OPS class_ops_wyrm;
+extern const CLASS_OPS class_ops_artificer;
+extern const CLASS_OPS class_ops_mechanist;
+extern const CLASS_OPS class_ops_cultist;
+extern const CLASS_OPS class_ops_voidborn;
+extern const CLASS_OPS class_ops_chronomancer;
+extern const CLASS_OPS class_ops_paradox;
+extern const CLASS_OPS class_ops_shaman;
+extern const CLASS_OPS class_ops_spiritlord;
+
+/* Hooks several classes share, in class_ops.c */
+void class_regen_item( CHAR_DATA *ch );	/* ITEMA_REGENERATE only */
+bool class_prompt_rage( CHAR_DATA *ch, int code, char *buf, size_t len );
+bool class_prompt_power( CHAR_DATA *ch, int code, char *buf, size_t len );
+bool class_prompt_power_total( CHAR_DATA *ch, int code, char *buf, size_t len );
+bool prompt_dragon( CHAR_DATA *ch, int code, char *buf, size_t len );	/* dragonkin.c, also wyrm */
+
+void class_ops_init( void );
+const CLASS_OPS *class_ops_by_id( int class_id );
+bool class_prompt( CHAR_DATA *ch, int code, char *buf, size_t len );
+
+/* Class tick and regen functions, in update.c and the class files */
+void update_vampire( CHAR_DATA *ch );
+void update_vampire_regen( CHAR_DATA *ch );
+void update_cyborg( CHAR_DATA *ch );
+void update_drider( CHAR_DATA *ch );
+void update_lich( CHAR_DATA *ch );
+void update_lich_regen( CHAR_DATA *ch );
+void update_angel( CHAR_DATA *ch );
+void update_tanarri( CHAR_DATA *ch );
+void update_monk( CHAR_DATA *ch );
+void update_ninja( CHAR_DATA *ch );
+void update_knight( CHAR_DATA *ch );
+void update_werewolf( CHAR_DATA *ch );
+void update_demon( CHAR_DATA *ch );
+void update_demon_regen( CHAR_DATA *ch );
+void update_shapeshifter( CHAR_DATA *ch );
+void update_drow( CHAR_DATA *ch );
+void update_highlander( CHAR_DATA *ch );
+void update_mage( CHAR_DATA *ch );
+void update_dirgesinger( CHAR_DATA *ch );
+void update_siren( CHAR_DATA *ch );
+void update_psion( CHAR_DATA *ch );
+void update_mindflayer( CHAR_DATA *ch );
+void update_artificer( CHAR_DATA *ch );
+void update_mechanist( CHAR_DATA *ch );
+void update_cultist( CHAR_DATA *ch );
+void update_voidborn( CHAR_DATA *ch );
+void update_chronomancer( CHAR_DATA *ch );
+void update_paradox( CHAR_DATA *ch );
+void update_shaman( CHAR_DATA *ch );
+void update_spiritlord( CHAR_DATA *ch );
+void update_arti_regen( CHAR_DATA *ch );
+
+static inline const CLASS_OPS *class_ops( CHAR_DATA *ch ) {
+	const CLASS_OPS *ops;
+
+	if ( IS_NPC( ch ) )
+		return &class_ops_none;
+	if ( ch->class == 0 )
+		return &class_ops_classless;
+	if ( ch->level < LEVEL_AVATAR )
+		return &class_ops_none;
+	ops = class_ops_slot[( ch->class & -ch->class ) % CLASS_OPS_SLOTS];
+	return ops != NULL ? ops : &class_ops_none;
+}
+
+/* mobile_update()'s per-pulse class work for a hero who is not AFK */
+static inline void class_tick( CHAR_DATA *ch ) {
+	const CLASS_OPS *ops = class_ops( ch );
+
+	if ( ops->tick_first && ops->tick != NULL )
+		ops->tick( ch );
+	if ( ops->regen != NULL )
+		ops->regen( ch );
+	if ( !ops->tick_first && ops->tick != NULL )
+		ops->tick( ch );
+}
+
+#endif /* CLASS_OPS_H */
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "cultist.h"
 #include "../db/db_class.h"
 #include "../systems/quest_new.h"
@@ -184,7 +185,7 @@ void do_voidtrain( CHAR_DATA *ch, char *argument ) {
 				"#x120The void whispers deeper secrets... Forbidden Lore is now level %d.#n\n\r",
 				ch->pcdata->powers[CULT_TRAIN_LORE] );
 			send_to_char( buf, ch );
-			quest_check_progress( ch, QOBJ_CLASS_TRAIN, "voidtrain", 1 );
+			quest_check_progress( ch, QOT_CLASS_TRAIN, "voidtrain", 1 );
 			return;
 		}
 
@@ -205,7 +206,7 @@ void do_voidtrain( CHAR_DATA *ch, char *argument ) {
 				"#x120Void tendrils writhe with new purpose... Tentacle Arts is now level %d.#n\n\r",
 				ch->pcdata->powers[CULT_TRAIN_TENTACLE] );
 			send_to_char( buf, ch );
-			quest_check_progress( ch, QOBJ_CLASS_TRAIN, "voidtrain", 1 );
+			quest_check_progress( ch, QOT_CLASS_TRAIN, "voidtrain", 1 );
 			return;
 		}
 
@@ -226,7 +227,7 @@ void do_voidtrain( CHAR_DATA *ch, char *argument ) {
 				"#x120Your mind cracks further open... Madness is now level %d.#n\n\r",
 				ch->pcdata->powers[CULT_TRAIN_MADNESS] );
 			send_to_char( buf, ch );
-			quest_check_progress( ch, QOBJ_CLASS_TRAIN, "voidtrain", 1 );
+			quest_check_progress( ch, QOT_CLASS_TRAIN, "voidtrain", 1 );
 			return;
 		}
 
@@ -276,7 +277,7 @@ void do_voidtrain( CHAR_DATA *ch, char *argument ) {
 				"#x097Reality bends to your will... Reality Warp is now level %d.#n\n\r",
 				ch->pcdata->powers[VOID_TRAIN_WARP] );
 			send_to_char( buf, ch );
-			quest_check_progress( ch, QOBJ_CLASS_TRAIN, "voidtrain", 1 );
+			quest_check_progress( ch, QOT_CLASS_TRAIN, "voidtrain", 1 );
 			return;
 		}
 
@@ -297,7 +298,7 @@ void do_voidtrain( CHAR_DATA *ch, char *argument ) {
 				"#x097Your form shifts beyond humanity... Elder Form is now level %d.#n\n\r",
 				ch->pcdata->powers[VOID_TRAIN_FORM] );
 			send_to_char( buf, ch );
-			quest_check_progress( ch, QOBJ_CLASS_TRAIN, "voidtrain", 1 );
+			quest_check_progress( ch, QOT_CLASS_TRAIN, "voidtrain", 1 );
 			return;
 		}
 
@@ -318,7 +319,7 @@ void do_voidtrain( CHAR_DATA *ch, char *argument ) {
 				"#x097The cosmos reveals its horrors... Cosmic Horror is now level %d.#n\n\r",
 				ch->pcdata->powers[VOID_TRAIN_COSMIC] );
 			send_to_char( buf, ch );
-			quest_check_progress( ch, QOBJ_CLASS_TRAIN, "voidtrain", 1 );
+			quest_check_progress( ch, QOT_CLASS_TRAIN, "voidtrain", 1 );
 			return;
 		}
 
@@ -929,3 +930,18 @@ void update_cultist( CHAR_DATA *ch ) {
 void do_cultistarmor( CHAR_DATA *ch, char *argument ) {
 	do_classarmor_generic( ch, argument, CLASS_CULTIST );
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_cultist = {
+	CLASS_CULTIST,
+	NULL,              /* regen */
+	update_cultist,    /* tick */
+	FALSE,             /* tick_first */
+	class_prompt_rage, /* prompt */
+	NULL,              /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
@@ -939,7 +939,7 @@ void fire_effect( void *vo, int level, int dam, int target ) {
 			act( "Your eyes tear up from smoke...you can't see a thing!",
 				victim, NULL, NULL, TO_CHAR );
 
-			af.type = skill_lookup( "fire breath" );
+			af.type = gsn_fire_breath;
 			af.duration = number_range( 0, level / 10 );
 			af.location = APPLY_HITROLL;
 			af.modifier = -20;
@@ -1297,7 +1297,7 @@ void cold_effect( void *vo, int level, int dam, int target ) {
 		/* chill touch effect */
 		AFFECT_DATA af;
 
-		int sn = skill_lookup( "chill touch" );
+		int sn = gsn_chill_touch;
 		if ( is_affected( victim, sn ) ) return;
 
 		af.type = sn;
@@ -1387,7 +1387,7 @@ void frost_breath( CHAR_DATA *ch, CHAR_DATA *victim, bool all ) {
 				continue;
 
 			cold_effect( vch, ch->explevel, dam, TARGET_CHAR );
-			damage( ch, vch, dam, skill_lookup( "frost breath" ) );
+			damage( ch, vch, dam, gsn_frost_breath );
 		}
 		return;
 	}
@@ -1399,6 +1399,6 @@ void frost_breath( CHAR_DATA *ch, CHAR_DATA *victim, bool all ) {
 	act( "$n breathes a stream of frost over you!", ch, NULL, victim, TO_VICT );
 	act( "You breath forth a stream of frost over $N.", ch, NULL, victim, TO_CHAR );
 
-	damage( ch, victim, dam, skill_lookup( "frost breath" ) );
+	damage( ch, victim, dam, gsn_frost_breath );
 	cold_effect( victim, ch->explevel, dam, TARGET_CHAR );
 }
@@ -22,6 +22,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 /*
  * Local functions.
@@ -845,7 +846,7 @@ void do_cone( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 
-	if ( ( sn = skill_lookup( "cone" ) ) < 0 ) return;
+	if ( ( sn = gsn_cone ) < 0 ) return;
 	spelltype = skill_table[sn].target;
 	level = (int) ( ch_spl(ch)[spelltype] * 1.0 );
 	level = (int) ( level * 1.0 );
@@ -881,3 +882,33 @@ void do_dstake( CHAR_DATA *ch, char *argument ) {
 	act( "A Stake appears in $n's hands in a flash of light.", ch, NULL, NULL, TO_ROOM );
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static void regen_demon( CHAR_DATA *ch ) {
+	if ( IS_SET( ch->warp, WARP_REGENERATE ) )
+		update_demon_regen( ch );
+	else
+		class_regen_item( ch );
+}
+
+static int dam_demon( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( IS_DEMPOWER( ch, DEM_MIGHT ) )
+		dam = dam * cfg( CFG_COMBAT_DMG_MULT_DEMON_MIGHT ) / 100;
+	if ( IS_SET( ch->warp, WARP_STRONGARMS ) )
+		dam = dam * cfg( CFG_COMBAT_DMG_MULT_DEMON_STRONGARMS ) / 100;
+	return dam;
+}
+
+const CLASS_OPS class_ops_demon = {
+	CLASS_DEMON,
+	regen_demon,              /* regen */
+	update_demon,             /* tick */
+	TRUE,                     /* tick_first */
+	class_prompt_power_total, /* prompt */
+	dam_demon,                /* dam_mod */
+	NULL,                     /* dam_mod_late */
+	NULL                      /* minion_death */
+};
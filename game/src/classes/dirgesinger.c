@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "dirgesinger.h"
 #include "../systems/quest_new.h"
 
@@ -529,7 +530,7 @@ void do_songtrain( CHAR_DATA *ch, char *argument ) {
 		if ( *path == 1 ) send_to_char( "You have learned #Rironsong#n!\n\r", ch );
 		else if ( *path == 2 ) send_to_char( "You have learned #Rrally#n!\n\r", ch );
 	}
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "songtrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "songtrain", 1 );
 	return;
 }
 
@@ -602,3 +603,18 @@ void update_dirgesinger( CHAR_DATA *ch ) {
 		}
 	}
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_dirgesinger = {
+	CLASS_DIRGESINGER,
+	NULL,               /* regen */
+	update_dirgesinger, /* tick */
+	FALSE,              /* tick_first */
+	class_prompt_rage,  /* prompt */
+	NULL,               /* dam_mod */
+	NULL,               /* dam_mod_late */
+	NULL                /* minion_death */
+};
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "dragonkin.h"
 #include "../systems/quest_new.h"
 
@@ -698,7 +699,7 @@ void do_dragontrain( CHAR_DATA *ch, char *argument ) {
 
 	snprintf( buf, sizeof( buf ), "You have trained %s to level %d.\n\r", tree_name, *train_ptr );
 	send_to_char( buf, ch );
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "dragontrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "dragontrain", 1 );
 	return;
 }
 
@@ -768,3 +769,32 @@ void update_dragonkin( CHAR_DATA *ch ) {
 
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+/* %E and %R, for wyrm as well */
+bool prompt_dragon( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	static const char *attune_names[] = { "Fire", "Frost", "Storm", "Earth" };
+	int attune;
+
+	if ( code != 'E' )
+		return class_prompt_rage( ch, code, buf, len );
+	attune = ch->pcdata->powers[DRAGON_ATTUNEMENT];
+	if ( attune < 0 || attune > 3 ) attune = 0;
+	snprintf( buf, len, "#C%s#n", attune_names[attune] );
+	return TRUE;
+}
+
+/* update_dragonkin() has never been called from mobile_update() */
+const CLASS_OPS class_ops_dragonkin = {
+	CLASS_DRAGONKIN,
+	NULL,          /* regen */
+	NULL,          /* tick */
+	FALSE,         /* tick_first */
+	prompt_dragon, /* prompt */
+	NULL,          /* dam_mod */
+	NULL,          /* dam_mod_late */
+	NULL           /* minion_death */
+};
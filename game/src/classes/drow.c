@@ -22,6 +22,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 /*
  * Local functions.
@@ -242,7 +243,7 @@ void do_chaosblast( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 
-	if ( ( sn = skill_lookup( "chaos blast" ) ) < 0 ) return;
+	if ( ( sn = gsn_chaos_blast ) < 0 ) return;
 	spelltype = skill_table[sn].target;
 	level = ch_spl(ch)[spelltype] / 3;
 	act( "You concentrate your power on $N.", ch, NULL, victim, TO_CHAR );
@@ -360,7 +361,7 @@ void do_drowfire( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 
-	if ( ( sn = skill_lookup( "drowfire" ) ) < 0 ) return;
+	if ( ( sn = gsn_drowfire ) < 0 ) return;
 	spelltype = skill_table[sn].target;
 	level = (int) ( ch_spl(ch)[spelltype] * 1.5 );
 	( *skill_table[sn].spell_fun )( sn, level, ch, victim );
@@ -886,8 +887,23 @@ void do_earthshatter( CHAR_DATA *ch, char *argument ) {
 		dam = dice( level, 7 );
 		if ( saves_spell( level, vch ) )
 			dam /= 2;
-		damage( ch, vch, dam, skill_lookup( "earthquake" ) );
+		damage( ch, vch, dam, gsn_earthquake );
 	}
 	WAIT_STATE( ch, cfg( CFG_ABILITY_DROW_EARTHSHATTER_COOLDOWN ) );
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_drow = {
+	CLASS_DROW,
+	class_regen_item,         /* regen */
+	update_drow,              /* tick */
+	TRUE,                     /* tick_first */
+	class_prompt_power_total, /* prompt */
+	NULL,                     /* dam_mod */
+	NULL,                     /* dam_mod_late */
+	NULL                      /* minion_death */
+};
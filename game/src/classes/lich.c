@@ -24,6 +24,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_planeshift( CHAR_DATA *ch, char *argument ) {
 	if ( IS_NPC( ch ) ) return;
@@ -339,7 +340,7 @@ void do_chillhand( CHAR_DATA *ch, char *argument ) {
 	if ( !IS_NPC( victim ) ) dam /= cfg( CFG_ABILITY_LICH_CHILLHAND_PVP_DAMAGE_DIVISOR );
 	damage( ch, victim, dam, gsn_chillhand );
 	WAIT_STATE( ch, cfg( CFG_ABILITY_LICH_CHILLHAND_COOLDOWN ) );
-	sn = skill_lookup( "chill touch" );
+	sn = gsn_chill_touch;
 	af.type = sn;
 	af.duration = cfg( CFG_ABILITY_LICH_CHILLHAND_DEBUFF_DURATION );
 	af.location = APPLY_STR;
@@ -683,7 +684,7 @@ void do_summongolem( CHAR_DATA *ch, char *argument ) {
 		victim->damroll = ch_spl(ch)[RED_MAGIC];
 		char_to_room( victim, ch->in_room );
 		add_follower( victim, ch );
-		af.type = skill_lookup( "charm person" );
+		af.type = gsn_charm_person;
 		af.duration = 666;
 		af.location = APPLY_NONE;
 		af.modifier = 0;
@@ -714,7 +715,7 @@ void do_summongolem( CHAR_DATA *ch, char *argument ) {
 		victim->damroll = ch_spl(ch)[YELLOW_MAGIC];
 		char_to_room( victim, ch->in_room );
 		add_follower( victim, ch );
-		af.type = skill_lookup( "charm person" );
+		af.type = gsn_charm_person;
 		af.duration = 666;
 		af.location = APPLY_NONE;
 		af.modifier = 0;
@@ -745,7 +746,7 @@ void do_summongolem( CHAR_DATA *ch, char *argument ) {
 		victim->damroll = ch_spl(ch)[GREEN_MAGIC];
 		char_to_room( victim, ch->in_room );
 		add_follower( victim, ch );
-		af.type = skill_lookup( "charm person" );
+		af.type = gsn_charm_person;
 		af.duration = 666;
 		af.location = APPLY_NONE;
 		af.modifier = 0;
@@ -776,7 +777,7 @@ void do_summongolem( CHAR_DATA *ch, char *argument ) {
 		victim->damroll = ch_spl(ch)[BLUE_MAGIC];
 		char_to_room( victim, ch->in_room );
 		add_follower( victim, ch );
-		af.type = skill_lookup( "charm person" );
+		af.type = gsn_charm_person;
 		af.duration = 666;
 		af.location = APPLY_NONE;
 		af.modifier = 0;
@@ -790,3 +791,25 @@ void do_summongolem( CHAR_DATA *ch, char *argument ) {
 		send_to_char( "No such golem.\n\r", ch );
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static void regen_lich( CHAR_DATA *ch ) {
+	if ( ch->pcdata->powers[LIFE_LORE] > 0 )
+		update_lich_regen( ch );
+	else
+		class_regen_item( ch );
+}
+
+const CLASS_OPS class_ops_lich = {
+	CLASS_LICH,
+	regen_lich,  /* regen */
+	update_lich, /* tick */
+	FALSE,       /* tick_first */
+	NULL,        /* prompt */
+	NULL,        /* dam_mod */
+	NULL,        /* dam_mod_late */
+	NULL         /* minion_death */
+};
@@ -26,6 +26,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_reveal( CHAR_DATA *ch, char *argument ) {
 	CHAR_DATA *ich;
@@ -106,29 +107,29 @@ void do_chaosmagic( CHAR_DATA *ch, char *argument ) {
 	}
 	random = number_range( 1, 12 );
 	if ( random == 1 )
-		sn = skill_lookup( "spirit kiss" );
+		sn = gsn_spirit_kiss;
 	else if ( random == 2 )
-		sn = skill_lookup( "desanct" );
+		sn = gsn_desanct;
 	else if ( random == 3 )
-		sn = skill_lookup( "imp heal" );
+		sn = gsn_imp_heal;
 	else if ( random == 4 )
-		sn = skill_lookup( "imp fireball" );
+		sn = gsn_imp_fireball;
 	else if ( random == 5 )
-		sn = skill_lookup( "imp faerie fire" );
+		sn = gsn_imp_faerie_fire;
 	else if ( random == 6 )
-		sn = skill_lookup( "imp teleport" );
+		sn = gsn_imp_teleport;
 	else if ( random == 7 )
-		sn = skill_lookup( "change sex" );
+		sn = gsn_change_sex;
 	else if ( random == 8 )
-		sn = skill_lookup( "shield" );
+		sn = gsn_shield;
 	else if ( random == 9 )
-		sn = skill_lookup( "readaura" );
+		sn = gsn_readaura;
 	else if ( random == 10 )
-		sn = skill_lookup( "earthquake" );
+		sn = gsn_earthquake;
 	else if ( random == 11 )
-		sn = skill_lookup( "gate" );
+		sn = gsn_gate;
 	else if ( random == 12 )
-		sn = skill_lookup( "dispel magic" );
+		sn = gsn_dispel_magic;
 	else
 		sn = 0;
 	if ( sn > 0 ) ( *skill_table[sn].spell_fun )( sn, level, ch, victim );
@@ -308,23 +309,23 @@ void do_chant( CHAR_DATA *ch, char *argument ) {
 		count = 0;
 		for ( i = 0; i < 5; i++ ) {
 			if ( i == 0 ) {
-				sn = skill_lookup( "purple sorcery" );
+				sn = gsn_purple_sorcery;
 				dam = purple_magic;
 			}
 			if ( i == 1 ) {
-				sn = skill_lookup( "yellow sorcery" );
+				sn = gsn_yellow_sorcery;
 				dam = yellow_magic;
 			}
 			if ( i == 2 ) {
-				sn = skill_lookup( "green sorcery" );
+				sn = gsn_green_sorcery;
 				dam = green_magic;
 			}
 			if ( i == 3 ) {
-				sn = skill_lookup( "red sorcery" );
+				sn = gsn_red_sorcery;
 				dam = red_magic;
 			}
 			if ( i == 4 ) {
-				sn = skill_lookup( "blue sorcery" );
+				sn = gsn_blue_sorcery;
 				dam = blue_magic;
 			}
 			if ( is_affected( victim, sn ) )
@@ -394,23 +395,23 @@ void do_chant( CHAR_DATA *ch, char *argument ) {
 		count = 0;
 		for ( i = 0; i < 5; i++ ) {
 			if ( i == 0 ) {
-				sn = skill_lookup( "purple sorcery" );
+				sn = gsn_purple_sorcery;
 				dam = purple_magic;
 			}
 			if ( i == 1 ) {
-				sn = skill_lookup( "yellow sorcery" );
+				sn = gsn_yellow_sorcery;
 				dam = yellow_magic;
 			}
 			if ( i == 2 ) {
-				sn = skill_lookup( "green sorcery" );
+				sn = gsn_green_sorcery;
 				dam = green_magic;
 			}
 			if ( i == 3 ) {
-				sn = skill_lookup( "red sorcery" );
+				sn = gsn_red_sorcery;
 				dam = red_magic;
 			}
 			if ( i == 4 ) {
-				sn = skill_lookup( "blue sorcery" );
+				sn = gsn_blue_sorcery;
 				dam = blue_magic;
 			}
 			if ( is_affected( victim, sn ) )
@@ -845,3 +846,24 @@ void do_mgate( int sn, int level, CHAR_DATA *ch, void *vo )
 	return;
 }
 */
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static int dam_mage( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( dt == gsn_mageshield && ch->pcdata->powers[PINVOKE] > 6 ) dam = (int) ( dam * 1.4 );
+	if ( dt == gsn_mageshield && ch->pcdata->powers[PINVOKE] > 9 ) dam = (int) ( dam * 1.4 );
+	return dam;
+}
+
+const CLASS_OPS class_ops_mage = {
+	CLASS_MAGE,
+	class_regen_item, /* regen */
+	update_mage,      /* tick */
+	TRUE,             /* tick_first */
+	NULL,             /* prompt */
+	dam_mage,         /* dam_mod */
+	NULL,             /* dam_mod_late */
+	NULL              /* minion_death */
+};
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "artificer.h"
 #include "../db/db_class.h"
 #include "../systems/quest_new.h"
@@ -238,7 +239,7 @@ void do_combatdrone( CHAR_DATA *ch, char *argument ) {
 	char_to_room( drone, ch->in_room );
 	add_follower( drone, ch );
 
-	af.type = skill_lookup( "charm person" );
+	af.type = gsn_charm_person;
 	af.duration = 666;
 	af.location = APPLY_NONE;
 	af.modifier = 0;
@@ -382,7 +383,7 @@ void do_bomberdrone( CHAR_DATA *ch, char *argument ) {
 	char_to_room( drone, ch->in_room );
 	add_follower( drone, ch );
 
-	af.type = skill_lookup( "charm person" );
+	af.type = gsn_charm_person;
 	af.duration = 666;
 	af.location = APPLY_NONE;
 	af.modifier = 0;
@@ -557,7 +558,7 @@ void do_dronearmy( CHAR_DATA *ch, char *argument ) {
 		char_to_room( drone, ch->in_room );
 		add_follower( drone, ch );
 
-		af.type = skill_lookup( "charm person" );
+		af.type = gsn_charm_person;
 		af.duration = 666;
 		af.location = APPLY_NONE;
 		af.modifier = 0;
@@ -1064,7 +1065,7 @@ void do_cybtrain( CHAR_DATA *ch, char *argument ) {
 			send_to_char( buf, ch );
 		}
 	}
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "cybtrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "cybtrain", 1 );
 	return;
 }
 
@@ -1426,3 +1427,40 @@ void mechanist_drone_attacks( CHAR_DATA *ch ) {
 	}
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static int dam_mechanist( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	/* Servo Arms: flat damage bonus on melee */
+	if ( ch->pcdata->powers[MECH_SERVO_ARMS] > 0 && dt >= TYPE_HIT && dt <= TYPE_HIT + 12 )
+		dam += cfg( CFG_ABILITY_MECHANIST_SERVOARMS_DAM_BONUS );
+
+	/* Power Arms implant: flat damage bonus on melee */
+	if ( ch->pcdata->powers[MECH_SERVO_IMPLANT] == IMPLANT_SERVO_POWER_ARMS && dt >= TYPE_HIT && dt <= TYPE_HIT + 12 )
+		dam += cfg( CFG_ABILITY_MECHANIST_IMPLANT_SERVO_POWER_DAM );
+	return dam;
+}
+
+static void minion_death_mechanist( CHAR_DATA *owner, CHAR_DATA *minion ) {
+	/* Decrement Mechanist drone counts if a drone was killed */
+	if ( minion->pIndexData->vnum == VNUM_MECH_COMBAT_DRONE && owner->pcdata->powers[MECH_DRONE_COUNT] > 0 ) {
+		owner->pcdata->powers[MECH_DRONE_COUNT]--;
+		send_to_char( "One of your combat drones has been destroyed!\n\r", owner );
+	} else if ( minion->pIndexData->vnum == VNUM_MECH_BOMBER_DRONE ) {
+		owner->pcdata->powers[MECH_BOMBER_ACTIVE] = 0;
+		send_to_char( "Your bomber drone has been destroyed!\n\r", owner );
+	}
+}
+
+const CLASS_OPS class_ops_mechanist = {
+	CLASS_MECHANIST,
+	NULL,                   /* regen */
+	update_mechanist,       /* tick */
+	FALSE,                  /* tick_first */
+	class_prompt_rage,      /* prompt */
+	dam_mechanist,          /* dam_mod */
+	NULL,                   /* dam_mod_late */
+	minion_death_mechanist  /* minion_death */
+};
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "psion.h"
 #include "../systems/quest_new.h"
 
@@ -106,7 +107,7 @@ void do_mindtrain( CHAR_DATA *ch, char *argument ) {
 		else if ( *path == 2 ) send_to_char( "You have learned #x035mindblast#n!\n\r", ch );
 		else if ( *path == 3 ) send_to_char( "You have learned #x035realityfracture#n!\n\r", ch );
 	}
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "mindtrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "mindtrain", 1 );
 	return;
 }
 
@@ -799,3 +800,18 @@ void update_mindflayer( CHAR_DATA *ch ) {
 
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_mindflayer = {
+	CLASS_MINDFLAYER,
+	NULL,              /* regen */
+	update_mindflayer, /* tick */
+	FALSE,             /* tick_first */
+	class_prompt_rage, /* prompt */
+	NULL,              /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
@@ -22,6 +22,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_monkarmor( CHAR_DATA *ch, char *argument ) {
 	do_classarmor_generic( ch, argument, CLASS_MONK );
@@ -678,7 +679,7 @@ void do_godsbless( CHAR_DATA *ch, char *argument ) {
 		send_to_char( "You don't have enough mana.\n\r", ch );
 		return;
 	}
-	if ( ( sn = skill_lookup( "godbless" ) ) < 0 ) return;
+	if ( ( sn = gsn_godbless ) < 0 ) return;
 	level = 500;
 	( *skill_table[sn].spell_fun )( sn, level, ch, ch );
 	WAIT_STATE( ch, cfg( CFG_ABILITY_MONK_GODSBLESS_COOLDOWN ) );
@@ -762,7 +763,7 @@ void do_darkblaze( CHAR_DATA *ch, char *argument ) {
 		REMOVE_BIT( victim->affected_by, AFF_DETECT_HIDDEN );
 	if ( IS_SET( victim->affected_by, AFF_DETECT_INVIS ) )
 		REMOVE_BIT( victim->affected_by, AFF_DETECT_INVIS );
-	af.type = skill_lookup( "blindness" );
+	af.type = gsn_blindness;
 	af.location = APPLY_HITROLL;
 	af.modifier = -4;
 	af.duration = cfg( CFG_ABILITY_MONK_DARKBLAZE_BLIND_DURATION );
@@ -826,3 +827,30 @@ void do_ghold( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static bool prompt_monk( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code == 'i' && ch_chi(ch)[MAXIMUM] > 0 ) {
+		snprintf( buf, len, "%s%d#n", col_scale_code( ch_chi(ch)[CURRENT], ch_chi(ch)[MAXIMUM] ), ch_chi(ch)[CURRENT] );
+		return TRUE;
+	}
+	if ( code == 'I' ) {
+		snprintf( buf, len, "#C%d#n", ch_chi(ch)[MAXIMUM] );
+		return TRUE;
+	}
+	return FALSE;
+}
+
+const CLASS_OPS class_ops_monk = {
+	CLASS_MONK,
+	NULL,        /* regen */
+	update_monk, /* tick */
+	FALSE,       /* tick_first */
+	prompt_monk, /* prompt */
+	NULL,        /* dam_mod */
+	NULL,        /* dam_mod_late */
+	NULL         /* minion_death */
+};
@@ -22,6 +22,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_stalk( CHAR_DATA *ch, char *argument ) {
 	CHAR_DATA *victim;
@@ -542,3 +543,26 @@ void do_strangle( CHAR_DATA *ch, char *argument ) {
 	}
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static int dam_ninja( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	int belt = ch->pcdata->rank;
+
+	if ( belt >= BELT_ONE && belt <= BELT_TEN )
+		dam = dam * cfg_ninja_belt_mult( belt - BELT_ONE + 1 ) / 100;
+	return dam;
+}
+
+const CLASS_OPS class_ops_ninja = {
+	CLASS_NINJA,
+	NULL,              /* regen */
+	update_ninja,      /* tick */
+	FALSE,             /* tick_first */
+	class_prompt_rage, /* prompt */
+	dam_ninja,         /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
@@ -10,6 +10,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "chronomancer.h"
 #include "../db/db_class.h"
 #include "../systems/quest_new.h"
@@ -761,7 +762,7 @@ void do_paratrain( CHAR_DATA *ch, char *argument ) {
 	snprintf( buf, sizeof( buf ),
 		"#x160You advance %s to level #x210%d#x160!#n\n\r", train_name, *train_ptr );
 	send_to_char( buf, ch );
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "paratrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "paratrain", 1 );
 }
 
 
@@ -901,3 +902,18 @@ void update_paradox( CHAR_DATA *ch ) {
 	if ( ch->pcdata->stats[PARA_COLLAPSE_CD] > 0 )       ch->pcdata->stats[PARA_COLLAPSE_CD]--;
 	if ( ch->pcdata->stats[PARA_DESTABILIZE_CD] > 0 )    ch->pcdata->stats[PARA_DESTABILIZE_CD]--;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_paradox = {
+	CLASS_PARADOX,
+	NULL,              /* regen */
+	update_paradox,    /* tick */
+	FALSE,             /* tick_first */
+	class_prompt_rage, /* prompt */
+	NULL,              /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
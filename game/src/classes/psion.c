@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "psion.h"
 #include "../systems/quest_new.h"
 
@@ -184,7 +185,7 @@ void do_psitrain( CHAR_DATA *ch, char *argument ) {
 		else if ( *path == 2 ) send_to_char( "You have learned #x039psychicscream#n!\n\r", ch );
 		else if ( *path == 3 ) send_to_char( "You have learned #x039brainburn#n!\n\r", ch );
 	}
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "psitrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "psitrain", 1 );
 	return;
 }
 
@@ -715,3 +716,18 @@ void update_psion( CHAR_DATA *ch ) {
 
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_psion = {
+	CLASS_PSION,
+	NULL,              /* regen */
+	update_psion,      /* tick */
+	FALSE,             /* tick_first */
+	class_prompt_rage, /* prompt */
+	NULL,              /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
@@ -22,6 +22,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void check_samuraiattack ( CHAR_DATA * ch, CHAR_DATA *victim );
 
@@ -437,3 +438,25 @@ void do_martial( CHAR_DATA *ch, char *argument ) {
 		do_martial( ch, "" );
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static bool prompt_samurai( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code != 'k' )
+		return FALSE;
+	snprintf( buf, len, "%d", ch->pcdata->powers[SAMURAI_FOCUS] );
+	return TRUE;
+}
+
+const CLASS_OPS class_ops_samurai = {
+	CLASS_SAMURAI,
+	NULL,              /* regen */
+	update_highlander, /* tick */
+	FALSE,             /* tick_first */
+	prompt_samurai,    /* prompt */
+	NULL,              /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
@@ -12,6 +12,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "shaman.h"
 #include "../db/db_class.h"
 #include "../systems/quest_new.h"
@@ -320,7 +321,7 @@ void do_spirittrain( CHAR_DATA *ch, char *argument )
 			"#GThe spirit of the earth answers... Totems is now level %d.#n\n\r",
 			ch->pcdata->powers[SHAMAN_TRAIN_TOTEM] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "spirittrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "spirittrain", 1 );
 		return;
 	}
 
@@ -344,7 +345,7 @@ void do_spirittrain( CHAR_DATA *ch, char *argument )
 			"#BSpirits swirl around you... Spirits is now level %d.#n\n\r",
 			ch->pcdata->powers[SHAMAN_TRAIN_SPIRIT] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "spirittrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "spirittrain", 1 );
 		return;
 	}
 
@@ -368,7 +369,7 @@ void do_spirittrain( CHAR_DATA *ch, char *argument )
 			"#CWhispers of the ancestors fill your mind... Communion is now level %d.#n\n\r",
 			ch->pcdata->powers[SHAMAN_TRAIN_COMMUNE] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "spirittrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "spirittrain", 1 );
 		return;
 	}
 
@@ -466,7 +467,7 @@ static CHAR_DATA *shaman_create_totem( CHAR_DATA *ch, int totem_type )
 	char_to_room( totem, ch->in_room );
 	add_follower( totem, ch );
 
-	af.type      = skill_lookup( "charm person" );
+	af.type      = gsn_charm_person;
 	af.duration  = 666;
 	af.location  = APPLY_NONE;
 	af.modifier  = 0;
@@ -1178,3 +1179,29 @@ void update_shaman( CHAR_DATA *ch )
 	if ( ch->pcdata->powers[SHAMAN_SPIRITBOLT_CD] > 0 )
 		ch->pcdata->powers[SHAMAN_SPIRITBOLT_CD]--;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static void minion_death_shaman( CHAR_DATA *owner, CHAR_DATA *minion ) {
+	/* Totem killed: clear totem state */
+	if ( minion->pIndexData->vnum == VNUM_SHAMAN_TOTEM ) {
+		owner->pcdata->powers[SHAMAN_ACTIVE_TOTEM] = TOTEM_NONE;
+		owner->pcdata->powers[SHAMAN_WARD_TICKS] = 0;
+		owner->pcdata->powers[SHAMAN_WRATH_TICKS] = 0;
+		owner->pcdata->powers[SHAMAN_SPIRIT_TOTEM_TICKS] = 0;
+		send_to_char( "Your totem has been destroyed!\n\r", owner );
+	}
+}
+
+const CLASS_OPS class_ops_shaman = {
+	CLASS_SHAMAN,
+	NULL,                /* regen */
+	update_shaman,       /* tick */
+	FALSE,               /* tick_first */
+	class_prompt_rage,   /* prompt */
+	NULL,                /* dam_mod */
+	NULL,                /* dam_mod_late */
+	minion_death_shaman  /* minion_death */
+};
@@ -26,6 +26,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_stomp( CHAR_DATA *ch, char *argument ) {
 	CHAR_DATA *victim;
@@ -111,12 +112,12 @@ void do_faeriecurse( CHAR_DATA *ch, char *argument ) {
 	act( "$n points at you and flickering rays of energy strikes your body.", ch, NULL, victim, TO_VICT );
 	act( "$n points at $N and flickering rays of energy strikes $S.", ch, NULL, victim, TO_NOTVICT );
 	if ( number_range( 1, 3 ) != 1 ) {
-		if ( ( sn = skill_lookup( "web" ) ) < 0 ) return;
+		if ( ( sn = gsn_web ) < 0 ) return;
 		level = 50;
 		( *skill_table[sn].spell_fun )( sn, level, ch, victim );
 	}
 	if ( number_range( 1, 3 ) != 1 ) {
-		if ( ( sn = skill_lookup( "curse" ) ) < 0 ) return;
+		if ( ( sn = gsn_curse ) < 0 ) return;
 		level = 50;
 		( *skill_table[sn].spell_fun )( sn, level, ch, victim );
 	}
@@ -144,7 +145,7 @@ void do_breath( CHAR_DATA *ch, char *argument ) {
 		send_to_char( "You aren't fighting anyone.\n\r", ch );
 		return;
 	}
-	if ( !( ( sn = skill_lookup( "fire breath" ) ) > 0 ) ) return;
+	if ( !( ( sn = gsn_fire_breath ) > 0 ) ) return;
 	( *skill_table[sn].spell_fun )( sn, level, ch, victim );
 	if ( ch->pcdata->powers[HYDRA_LEVEL] > 0 ) ( *skill_table[sn].spell_fun )( sn, level, ch, victim );
 	if ( ch->pcdata->powers[HYDRA_LEVEL] > 1 ) ( *skill_table[sn].spell_fun )( sn, level, ch, victim );
@@ -738,3 +739,43 @@ void do_charge( CHAR_DATA *ch, char *argument ) {
 	}
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static bool prompt_shapeshifter( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code == 'k' ) {
+		snprintf( buf, len, "#C%d#n", ch->pcdata->powers[SHAPE_COUNTER] );
+		return TRUE;
+	}
+	if ( code == 'B' ) {
+		snprintf( buf, len, "#r%d#n", ch->pcdata->condition[COND_FULL] );
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static int dam_late_shapeshifter( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	dam = (int) ( dam * 1.4 );
+	if ( ch->pcdata->powers[SHAPE_FORM] == TIGER_FORM && ch->pcdata->powers[TIGER_LEVEL] > 1 )
+		dam = (int) ( dam * 1.5 );
+	else if ( ch->pcdata->powers[SHAPE_FORM] == FAERIE_FORM && ch->pcdata->powers[FAERIE_LEVEL] > 1 )
+		dam = (int) ( dam * 1.2 );
+	else if ( ch->pcdata->powers[SHAPE_FORM] == HYDRA_FORM && ch->pcdata->powers[HYDRA_LEVEL] > 1 )
+		dam = (int) ( dam * 1.6 );
+	else if ( ch->pcdata->powers[SHAPE_FORM] == BULL_FORM && ch->pcdata->powers[BULL_LEVEL] > 1 )
+		dam = (int) ( dam * 1.7 );
+	return dam;
+}
+
+const CLASS_OPS class_ops_shapeshifter = {
+	CLASS_SHAPESHIFTER,
+	NULL,                  /* regen */
+	update_shapeshifter,   /* tick */
+	FALSE,                 /* tick_first */
+	prompt_shapeshifter,   /* prompt */
+	NULL,                  /* dam_mod */
+	dam_late_shapeshifter, /* dam_mod_late */
+	NULL                   /* minion_death */
+};
@@ -10,6 +10,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "dirgesinger.h"
 #include "../systems/quest_new.h"
 
@@ -648,7 +649,7 @@ void do_voicetrain( CHAR_DATA *ch, char *argument ) {
 		else if ( *path == 2 ) send_to_char( "You have learned #Rcacophony#n!\n\r", ch );
 		else if ( *path == 3 ) send_to_char( "You have learned #Rariaofunmaking#n!\n\r", ch );
 	}
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "voicetrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "voicetrain", 1 );
 	return;
 }
 
@@ -689,3 +690,18 @@ void update_siren( CHAR_DATA *ch ) {
 		send_to_char( "Your crescendo fades without a finale.\n\r", ch );
 	}
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_siren = {
+	CLASS_SIREN,
+	NULL,              /* regen */
+	update_siren,      /* tick */
+	FALSE,             /* tick_first */
+	class_prompt_rage, /* prompt */
+	NULL,              /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
@@ -26,6 +26,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_implant( CHAR_DATA *ch, char *argument ) {
 	char arg1[MAX_INPUT_LENGTH];
@@ -368,3 +369,31 @@ void do_dridereq( CHAR_DATA *ch, char *argument ) {
 	act( "$p appears in $n's hands in a blast of flames.", ch, obj, NULL, TO_ROOM );
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static void regen_droid( CHAR_DATA *ch ) {
+	if ( ch->pcdata->powers[CYBORG_BODY] > 5 )
+		update_cyborg( ch );
+	else
+		class_regen_item( ch );
+}
+
+static int dam_late_droid( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( ch->pcdata->powers[CYBORG_LIMBS] > 0 ) dam = (int) ( dam * 1.3 );
+	if ( ch->pcdata->powers[CYBORG_LIMBS] > 2 ) dam = (int) ( dam * 1.5 );
+	return dam;
+}
+
+const CLASS_OPS class_ops_droid = {
+	CLASS_DROID,
+	regen_droid,        /* regen */
+	update_drider,      /* tick */
+	TRUE,               /* tick_first */
+	class_prompt_power, /* prompt */
+	NULL,               /* dam_mod */
+	dam_late_droid,     /* dam_mod_late */
+	NULL                /* minion_death */
+};
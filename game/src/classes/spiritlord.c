@@ -12,6 +12,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "shaman.h"
 #include "../db/db_class.h"
 #include "../systems/quest_new.h"
@@ -116,7 +117,7 @@ void do_lordtrain( CHAR_DATA *ch, char *argument )
 			"#GSpiritual energy coalesces within you... Embodiment is now level %d.#n\n\r",
 			ch->pcdata->powers[SL_TRAIN_EMBODY] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "lordtrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "lordtrain", 1 );
 		return;
 	}
 
@@ -140,7 +141,7 @@ void do_lordtrain( CHAR_DATA *ch, char *argument )
 			"#BThe spirits bend to your will... Dominion is now level %d.#n\n\r",
 			ch->pcdata->powers[SL_TRAIN_DOMINION] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "lordtrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "lordtrain", 1 );
 		return;
 	}
 
@@ -164,7 +165,7 @@ void do_lordtrain( CHAR_DATA *ch, char *argument )
 			"#CThe boundary between worlds thins... Transcendence is now level %d.#n\n\r",
 			ch->pcdata->powers[SL_TRAIN_TRANSCEND] );
 		send_to_char( buf, ch );
-		quest_check_progress( ch, QOBJ_CLASS_TRAIN, "lordtrain", 1 );
+		quest_check_progress( ch, QOT_CLASS_TRAIN, "lordtrain", 1 );
 		return;
 	}
 
@@ -556,7 +557,7 @@ void do_possess( CHAR_DATA *ch, char *argument )
 
 	add_follower( victim, ch );
 
-	af.type      = skill_lookup( "charm person" );
+	af.type      = gsn_charm_person;
 	af.duration  = cfg( CFG_SL_POSSESS_DURATION );
 	af.location  = APPLY_NONE;
 	af.modifier  = 0;
@@ -672,7 +673,7 @@ void do_spiritarmy( CHAR_DATA *ch, char *argument )
 		char_to_room( warrior, ch->in_room );
 		add_follower( warrior, ch );
 
-		af.type      = skill_lookup( "charm person" );
+		af.type      = gsn_charm_person;
 		af.duration  = 666;
 		af.location  = APPLY_NONE;
 		af.modifier  = 0;
@@ -1206,3 +1207,26 @@ void update_spiritlord( CHAR_DATA *ch )
 	if ( ch->pcdata->stats[SL_STAT_ASCENSION_CD] > 0 )
 		ch->pcdata->stats[SL_STAT_ASCENSION_CD]--;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static void minion_death_spiritlord( CHAR_DATA *owner, CHAR_DATA *minion ) {
+	/* Spirit warrior killed: decrement army count */
+	if ( minion->pIndexData->vnum == VNUM_SL_SPIRIT_WARRIOR && owner->pcdata->stats[SL_STAT_ARMY_COUNT] > 0 ) {
+		owner->pcdata->stats[SL_STAT_ARMY_COUNT]--;
+		send_to_char( "One of your spirit warriors has been destroyed!\n\r", owner );
+	}
+}
+
+const CLASS_OPS class_ops_spiritlord = {
+	CLASS_SPIRITLORD,
+	NULL,                    /* regen */
+	update_spiritlord,       /* tick */
+	FALSE,                   /* tick_first */
+	class_prompt_rage,       /* prompt */
+	NULL,                    /* dam_mod */
+	NULL,                    /* dam_mod_late */
+	minion_death_spiritlord  /* minion_death */
+};
@@ -26,6 +26,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_taneq( CHAR_DATA *ch, char *argument ) {
 	OBJ_INDEX_DATA *pObjIndex;
@@ -584,3 +585,24 @@ void do_infernal( CHAR_DATA *ch, char *argument ) {
 	WAIT_STATE( ch, cfg( CFG_ABILITY_TANARRI_INFERNAL_COOLDOWN ) );
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static int dam_tanarri( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( IS_SET( ch->pcdata->powers[TANARRI_POWER], TANARRI_MIGHT ) )
+		dam = dam * cfg( CFG_COMBAT_DMG_MULT_TANARRI_MIGHT ) / 100;
+	return dam;
+}
+
+const CLASS_OPS class_ops_tanarri = {
+	CLASS_TANARRI,
+	class_regen_item,   /* regen */
+	update_tanarri,     /* tick */
+	FALSE,              /* tick_first */
+	class_prompt_power, /* prompt */
+	dam_tanarri,        /* dam_mod */
+	NULL,               /* dam_mod_late */
+	NULL                /* minion_death */
+};
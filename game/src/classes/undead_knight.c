@@ -26,6 +26,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_ride( CHAR_DATA *ch, char *argument ) {
 	CHAR_DATA *victim;
@@ -346,7 +347,7 @@ void do_powerword( CHAR_DATA *ch, char *argument ) {
 				REMOVE_BIT( victim->affected_by, AFF_DETECT_HIDDEN );
 			if ( IS_SET( victim->affected_by, AFF_DETECT_INVIS ) )
 				REMOVE_BIT( victim->affected_by, AFF_DETECT_INVIS );
-			af.type = skill_lookup( "blindness" );
+			af.type = gsn_blindness;
 			af.location = APPLY_HITROLL;
 			af.modifier = -4;
 			af.duration = cfg( CFG_ABILITY_UNDEAD_KNIGHT_POWERWORD_BLIND_DURATION );
@@ -425,3 +426,30 @@ void do_powerword( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static int dam_knight( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( !IS_NPC( victim ) && IS_CLASS( victim, CLASS_SHAPESHIFTER ) )
+		dam = dam * cfg( CFG_COMBAT_DMG_MULT_UK_VS_SHAPE ) / 100;
+	return dam;
+}
+
+static int dam_late_knight( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( ch->pcdata->powers[WEAPONSKILL] > 4 ) dam = (int) ( dam * 1.2 );
+	if ( ch->pcdata->powers[WEAPONSKILL] > 8 ) dam = (int) ( dam * 1.3 );
+	return dam;
+}
+
+const CLASS_OPS class_ops_undead_knight = {
+	CLASS_UNDEAD_KNIGHT,
+	NULL,            /* regen */
+	update_knight,   /* tick */
+	FALSE,           /* tick_first */
+	NULL,            /* prompt */
+	dam_knight,      /* dam_mod */
+	dam_late_knight, /* dam_mod_late */
+	NULL             /* minion_death */
+};
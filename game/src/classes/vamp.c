@@ -22,6 +22,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 /*
  * Vampire armor - now database-driven via class_armor system.
@@ -737,7 +738,7 @@ void do_spew( CHAR_DATA *ch, char *argument ) {
 		send_to_char( "You cannot do that here.\n\r", ch );
 		return;
 	}
-	if ( ( sn = skill_lookup( "spew" ) ) < 0 ) {
+	if ( ( sn = gsn_spew ) < 0 ) {
 		snprintf( buf, sizeof( buf ), "Yep, sn is bieng set to %d.", sn );
 		send_to_char( buf, ch );
 		return;
@@ -1224,7 +1225,7 @@ void do_zombie( CHAR_DATA *ch, char *argument ) {
 
 	if ( victim->level < 100 ) {
 		add_follower( victim, ch );
-		af.type = skill_lookup( "charm person" );
+		af.type = gsn_charm_person;
 		af.duration = 666;
 		af.location = APPLY_NONE;
 		af.modifier = 0;
@@ -1362,7 +1363,7 @@ void do_entrance( CHAR_DATA *ch, char *argument ) {
 	snprintf( buf, sizeof( buf ), "A look of concentration crosses over $n's face.\n\r" );
 	act( buf, ch, NULL, victim, TO_ROOM );
 
-	if ( ( sn = skill_lookup( "charm" ) ) < 0 ) return;
+	if ( ( sn = gsn_charm_person ) < 0 ) return;
 	level = ch_power(ch)[DISC_VAMP_PRES] * 40;
 	( *skill_table[sn].spell_fun )( sn, level, ch, victim );
 	WAIT_STATE( ch, 12 );
@@ -1405,7 +1406,7 @@ void do_tendrils( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 	if ( is_safe( ch, victim ) == TRUE ) return;
-	if ( ( sn = skill_lookup( "web" ) ) < 0 ) return;
+	if ( ( sn = gsn_web ) < 0 ) return;
 	spelltype = skill_table[sn].target;
 	level = (int) ( ch_spl(ch)[spelltype] * 0.25 );
 	( *skill_table[sn].spell_fun )( sn, level, ch, victim );
@@ -2634,7 +2635,7 @@ void do_infirmity( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 	if ( is_safe( ch, victim ) == TRUE ) return;
-	if ( ( sn = skill_lookup( "infirmity" ) ) < 0 ) {
+	if ( ( sn = gsn_infirmity ) < 0 ) {
 		snprintf( buf, sizeof( buf ), "Yep, sn is bieng set to %d.", sn );
 		send_to_char( buf, ch );
 		return;
@@ -3752,3 +3753,41 @@ void do_bonemod( CHAR_DATA *ch, char *argument ) {
 	do_bonemod( ch, "" );
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static void regen_vampire( CHAR_DATA *ch ) {
+	if ( ch->rage > 0 )
+		update_vampire_regen( ch );
+	else
+		class_regen_item( ch );
+}
+
+static bool prompt_vampire( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code != 'B' )
+		return class_prompt_rage( ch, code, buf, len );
+	snprintf( buf, len, "#r%d#n", ch->pcdata->condition[COND_THIRST] );
+	return TRUE;
+}
+
+static int dam_vampire( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	/*
+	 * I doubt this has much effect - Jobo
+	 */
+	if ( IS_NPC( victim ) )
+		dam *= ( 1 + ch_power(ch)[DISC_VAMP_POTE] / 15 );
+	return dam;
+}
+
+const CLASS_OPS class_ops_vampire = {
+	CLASS_VAMPIRE,
+	regen_vampire,  /* regen */
+	update_vampire, /* tick */
+	FALSE,          /* tick_first */
+	prompt_vampire, /* prompt */
+	dam_vampire,    /* dam_mod */
+	NULL,           /* dam_mod_late */
+	NULL            /* minion_death */
+};
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "cultist.h"
 #include "../db/db_class.h"
 
@@ -622,3 +623,18 @@ void update_voidborn( CHAR_DATA *ch ) {
 void do_voidbornarmor( CHAR_DATA *ch, char *argument ) {
 	do_classarmor_generic( ch, argument, CLASS_VOIDBORN );
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+const CLASS_OPS class_ops_voidborn = {
+	CLASS_VOIDBORN,
+	NULL,              /* regen */
+	update_voidborn,   /* tick */
+	FALSE,             /* tick_first */
+	class_prompt_rage, /* prompt */
+	NULL,              /* dam_mod */
+	NULL,              /* dam_mod_late */
+	NULL               /* minion_death */
+};
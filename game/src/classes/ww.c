@@ -22,6 +22,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 
 void do_tribe( CHAR_DATA *ch, char *argument ) {
 	char buf[MAX_STRING_LENGTH];
@@ -843,14 +844,14 @@ void do_disquiet( CHAR_DATA *ch, char *argument ) {
 		return;
 	}
 
-	af.type = skill_lookup( "reserved" );
+	af.type = gsn_reserved;
 	af.duration = ch_power(ch)[DISC_WERE_OWL];
 	af.location = APPLY_DAMROLL;
 	af.modifier = -( ch_power(ch)[DISC_WERE_OWL] * 5 );
 	af.bitvector = 0;
 	affect_to_char( victim, &af );
 
-	af.type = skill_lookup( "reserved" );
+	af.type = gsn_reserved;
 	af.duration = ch_power(ch)[DISC_WERE_OWL];
 	af.location = APPLY_HITROLL;
 	af.modifier = -( ch_power(ch)[DISC_WERE_OWL] * 5 );
@@ -1280,3 +1281,33 @@ void do_razorclaws( CHAR_DATA *ch, char *argument ) {
 	}
 	return;
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+static bool prompt_werewolf( CHAR_DATA *ch, int code, char *buf, size_t len ) {
+	if ( code != 'G' )
+		return class_prompt_rage( ch, code, buf, len );
+	if ( ch_gnosis(ch)[GMAXIMUM] <= 0 )
+		return FALSE;
+	snprintf( buf, len, "%s%d#n", col_scale_code( ch_gnosis(ch)[GCURRENT], ch_gnosis(ch)[GMAXIMUM] ), ch_gnosis(ch)[GCURRENT] );
+	return TRUE;
+}
+
+static int dam_late_werewolf( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( ch_power(ch)[DISC_WERE_BEAR] > 5 )
+		dam = (int) ( dam * 1.2 );
+	return dam;
+}
+
+const CLASS_OPS class_ops_werewolf = {
+	CLASS_WEREWOLF,
+	NULL,              /* regen */
+	update_werewolf,   /* tick */
+	FALSE,             /* tick_first */
+	prompt_werewolf,   /* prompt */
+	NULL,              /* dam_mod */
+	dam_late_werewolf, /* dam_mod_late */
+	NULL               /* minion_death */
+};
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "class_ops.h"
 #include "dragonkin.h"
 #include "../systems/quest_new.h"
 
@@ -581,7 +582,7 @@ void do_wyrmtrain( CHAR_DATA *ch, char *argument ) {
 
 	snprintf( buf, sizeof( buf ), "You have trained %s to level %d.\n\r", tree_name, *train_ptr );
 	send_to_char( buf, ch );
-	quest_check_progress( ch, QOBJ_CLASS_TRAIN, "wyrmtrain", 1 );
+	quest_check_progress( ch, QOT_CLASS_TRAIN, "wyrmtrain", 1 );
 }
 
 /*
@@ -629,3 +630,26 @@ void update_wyrm( CHAR_DATA *ch ) {
 		/* Terrain effects can persist - decayed elsewhere or manually cleared */
 	}
 }
+
+/*
+ * CLASS_OPS entry, see class_ops.h.
+ */
+
+/* Wyrm: ancientwrath damage bonus */
+static int dam_late_wyrm( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
+	if ( ch->pcdata->powers[DRAGON_ANCIENTWRATH] > 0 )
+		dam = dam * ( 100 + cfg( CFG_ABILITY_WYRM_ANCIENTWRATH_DAMAGE_BONUS ) ) / 100;
+	return dam;
+}
+
+/* update_wyrm() has never been called from mobile_update() */
+const CLASS_OPS class_ops_wyrm = {
+	CLASS_WYRM,
+	NULL,          /* regen */
+	NULL,          /* tick */
+	FALSE,         /* tick_first */
+	prompt_dragon, /* prompt */
+	NULL,          /* dam_mod */
+	dam_late_wyrm, /* dam_mod_late */
+	NULL           /* minion_death */
+};
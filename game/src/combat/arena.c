@@ -190,7 +190,7 @@ void do_resign( CHAR_DATA *ch, char *argument ) {
 	if ( found == 1 ) {
 		snprintf( buf, sizeof( buf ), "#C%s #oemerges victorious from the #Rarena#n", gch->name );
 		gch->pcdata->awins++;
-		quest_check_progress( gch, QOBJ_ARENA_WIN, "any", 1 );
+		quest_check_progress( gch, QOT_ARENA_WIN, "any", 1 );
 		do_info( gch, buf );
 		if ( ( location = get_room_index( ROOM_VNUM_ALTAR ) ) == NULL ) return;
 		char_from_room( gch );
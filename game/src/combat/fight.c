@@ -29,9 +29,11 @@
 #include "cultist.h"
 #include "chronomancer.h"
 #include "shaman.h"
+#include "class_ops.h"
 #include "../systems/mcmp.h"
 #include "../systems/quest_new.h"
 #include "../systems/profile.h"
+#include "../systems/combatsum.h"
 #include "../db/db_quest.h"
 #include "../script/script.h"
 
@@ -72,7 +74,8 @@ void violence_update( void ) {
 	CHAR_DATA *rch_next;
 	CHAR_DATA *mount;
 
-	PROFILE_START( "violence_update" );
+	PROFILE_START( PROF_VIOLENCE_UPDATE );
+	combatsum_begin();
 
 	LIST_FOR_EACH_SAFE( ch, ch_next_v, &g_characters, CHAR_DATA, char_node ) {
 		if ( ch->extracted ) continue;
@@ -188,7 +191,7 @@ void violence_update( void ) {
 		if ( ( victim = ch->fighting ) == NULL || ch->in_room == NULL ) continue;
 
 		/* Actual combat processing */
-		PROFILE_START( "violence_combat" );
+		PROFILE_START( PROF_VIOLENCE_COMBAT );
 
 		if ( !IS_NPC( ch ) && !IS_NPC( victim ) && !is_safe( ch, victim ) && !is_safe( victim, ch ) ) {
 			if ( ch->fight_timer < 10 )
@@ -212,7 +215,7 @@ void violence_update( void ) {
 		/*
 		 * Fun for the whole family!
 		 */
-		PROFILE_START( "group_assist" );
+		PROFILE_START( PROF_GROUP_ASSIST );
 		LIST_FOR_EACH_SAFE(rch, rch_next, &ch->in_room->characters, CHAR_DATA, room_node) {
 			if ( ch->fighting == NULL ) break; /* victim died during assist */
 			if ( IS_AWAKE( rch ) && rch->fighting == NULL ) {
@@ -254,7 +257,7 @@ void violence_update( void ) {
 				}
 			}
 		}
-		PROFILE_END( "group_assist" );
+		PROFILE_END( PROF_GROUP_ASSIST );
 
 		/* Artificer turret attacks */
 		if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_ARTIFICER ) &&
@@ -266,10 +269,11 @@ void violence_update( void ) {
 			ch->pcdata->powers[MECH_DRONE_COUNT] > 0 && ch->fighting != NULL )
 			mechanist_drone_attacks( ch );
 
-		PROFILE_END( "violence_combat" );
+		PROFILE_END( PROF_VIOLENCE_COMBAT );
 	}
 
-	PROFILE_END( "violence_update" );
+	combatsum_end();
+	PROFILE_END( PROF_VIOLENCE_UPDATE );
 	return;
 }
 
@@ -567,7 +571,7 @@ bool multi_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt ) {
 					sn = wield->value[0] - ( ( wield->value[0] / 1000 ) * 1000 );
 				else
 					sn = wield->value[0];
-				if ( sn != skill_lookup( "gas breath" ) && sn != skill_lookup( "desanct" ) && sn != skill_lookup( "sleep" ) && sn != 0 ) {
+				if ( sn != gsn_gas_breath && sn != gsn_desanct && sn != gsn_sleep && sn != 0 ) {
 					if ( victim->position == POS_FIGHTING ) ( *skill_table[sn].spell_fun )( sn, wield->level, ch, victim );
 				}
 			}
@@ -688,20 +692,20 @@ bool multi_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt ) {
 	/* Golems speciels */
 	if ( IS_NPC( ch ) ) {
 		if ( ch->pIndexData->vnum == MOB_VNUM_FIRE ) {
-			if ( ( sn = skill_lookup( "curse" ) ) > 0 )
+			if ( ( sn = gsn_curse ) > 0 )
 				( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
-			if ( ( sn = skill_lookup( "imp faerie fire" ) ) > 0 )
+			if ( ( sn = gsn_imp_faerie_fire ) > 0 )
 				( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 		}
 		if ( ch->pIndexData->vnum == MOB_VNUM_STONE ) {
-			af.type = skill_lookup( "reserved" );
+			af.type = gsn_reserved;
 			af.duration = 20;
 			af.location = APPLY_DAMROLL;
 			af.modifier = -50;
 			af.bitvector = 0;
 			affect_to_char( victim, &af );
 
-			af.type = skill_lookup( "reserved" );
+			af.type = gsn_reserved;
 			af.duration = 20;
 			af.location = APPLY_HITROLL;
 			af.modifier = -50;
@@ -710,11 +714,11 @@ bool multi_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt ) {
 			send_to_char( "You feel weak in the presence of the stone golem.\n\r", victim );
 		}
 		if ( ch->pIndexData->vnum == MOB_VNUM_CLAY ) {
-			if ( ( sn = skill_lookup( "clay" ) ) > 0 )
+			if ( ( sn = gsn_clay_ball ) > 0 )
 				( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 		}
 		if ( ch->pIndexData->vnum == MOB_VNUM_IRON ) {
-			if ( ( sn = skill_lookup( "group heal" ) ) > 0 )
+			if ( ( sn = gsn_group_heal ) > 0 )
 				( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 		}
 	}
@@ -850,23 +854,23 @@ bool multi_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt ) {
 			default:
 				break;
 			case 1:
-				if ( ( sn = skill_lookup( "curse" ) ) > 0 )
+				if ( ( sn = gsn_curse ) > 0 )
 					( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 				break;
 			case 2:
-				if ( ( sn = skill_lookup( "web" ) ) > 0 )
+				if ( ( sn = gsn_web ) > 0 )
 					( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 				break;
 			case 3:
-				if ( ( sn = skill_lookup( "imp heal" ) ) > 0 )
+				if ( ( sn = gsn_imp_heal ) > 0 )
 					( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 				break;
 			case 4:
-				if ( ( sn = skill_lookup( "imp fireball" ) ) > 0 )
+				if ( ( sn = gsn_imp_fireball ) > 0 )
 					( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 				break;
 			case 5:
-				if ( ( sn = skill_lookup( "godbless" ) ) > 0 )
+				if ( ( sn = gsn_godbless ) > 0 )
 					( *skill_table[sn].spell_fun )( sn, 50, ch, victim );
 				break;
 			}
@@ -927,14 +931,14 @@ bool multi_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt ) {
 				one_hit( victim, ch, gsn_deathaura, 0 );
 		}
 		if ( IS_SET( victim->pcdata->powers[AURAS], FEAR_AURA ) && IS_CLASS( victim, CLASS_UNDEAD_KNIGHT ) ) {
-			af.type = skill_lookup( "reserved" );
+			af.type = gsn_reserved;
 			af.duration = 20;
 			af.location = APPLY_DAMROLL;
 			af.modifier = -20;
 			af.bitvector = 0;
 			affect_to_char( ch, &af );
 
-			af.type = skill_lookup( "reserved" );
+			af.type = gsn_reserved;
 			af.duration = 20;
 			af.location = APPLY_HITROLL;
 			af.modifier = -20;
@@ -944,19 +948,19 @@ bool multi_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt ) {
 		}
 	}
 	if ( IS_ITEMAFF( victim, ITEMA_SHOCKSHIELD ) && ch->position == POS_FIGHTING )
-		if ( ( sn = skill_lookup( "lightning bolt" ) ) > 0 )
+		if ( ( sn = gsn_lightning_bolt ) > 0 )
 			( *skill_table[sn].spell_fun )( sn, level, victim, ch );
 	if ( IS_ITEMAFF( victim, ITEMA_FIRESHIELD ) && ch->position == POS_FIGHTING )
-		if ( ( sn = skill_lookup( "fireball" ) ) > 0 )
+		if ( ( sn = gsn_fireball_spell ) > 0 )
 			( *skill_table[sn].spell_fun )( sn, level, victim, ch );
 	if ( IS_ITEMAFF( victim, ITEMA_ICESHIELD ) && ch->position == POS_FIGHTING )
-		if ( ( sn = skill_lookup( "chill touch" ) ) > 0 )
+		if ( ( sn = gsn_chill_touch ) > 0 )
 			( *skill_table[sn].spell_fun )( sn, level, victim, ch );
 	if ( IS_ITEMAFF( victim, ITEMA_ACIDSHIELD ) && ch->position == POS_FIGHTING )
-		if ( ( sn = skill_lookup( "acid blast" ) ) > 0 )
+		if ( ( sn = gsn_acid_blast ) > 0 )
 			( *skill_table[sn].spell_fun )( sn, level, victim, ch );
 	if ( IS_ITEMAFF( victim, ITEMA_CHAOSSHIELD ) && ch->position == POS_FIGHTING )
-		if ( ( sn = skill_lookup( "chaos blast" ) ) > 0 )
+		if ( ( sn = gsn_chaos_blast ) > 0 )
 			( *skill_table[sn].spell_fun )( sn, level, victim, ch );
 	return false;
 }
@@ -1221,6 +1225,7 @@ bool one_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int handtype ) {
 	int level;
 	int attack_modify;
 	int right_hand;
+	const CLASS_OPS *ops;
 
 	/*
 	 * Can't beat a dead char!
@@ -1368,47 +1373,9 @@ bool one_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int handtype ) {
 			dam = dam * cfg_upgrade_dmg( ulvl ) / 100;
 	}
 
-	/*
-	 * I doubt this has much effect - Jobo
-	 */
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_VAMPIRE ) && IS_NPC( victim ) )
-		dam *= ( 1 + ch_power(ch)[DISC_VAMP_POTE] / 15 );
-
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_TANARRI ) ) {
-		if ( IS_SET( ch->pcdata->powers[TANARRI_POWER], TANARRI_MIGHT ) ) dam = dam * cfg( CFG_COMBAT_DMG_MULT_TANARRI_MIGHT ) / 100;
-	}
-
-	/*
-	 * This one for angels have no effect, take a look and rebalance. Jobo
-	 */
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_ANGEL ) ) dam *= ( 1 + ch->pcdata->powers[ANGEL_JUSTICE] / 10 );
-
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_DEMON ) && IS_DEMPOWER( ch, DEM_MIGHT ) )
-		dam = dam * cfg( CFG_COMBAT_DMG_MULT_DEMON_MIGHT ) / 100;
-	if ( !IS_NPC( ch ) && !IS_NPC( victim ) && IS_CLASS( ch, CLASS_UNDEAD_KNIGHT ) && IS_CLASS( victim, CLASS_SHAPESHIFTER ) ) dam = dam * cfg( CFG_COMBAT_DMG_MULT_UK_VS_SHAPE ) / 100;
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_MAGE ) ) {
-		if ( dt == gsn_mageshield && ch->pcdata->powers[PINVOKE] > 6 ) dam = (int) ( dam * 1.4 );
-		if ( dt == gsn_mageshield && ch->pcdata->powers[PINVOKE] > 9 ) dam = (int) ( dam * 1.4 );
-	}
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_NINJA ) ) {
-		int belt = ch->pcdata->rank;
-		if ( belt >= BELT_ONE && belt <= BELT_TEN )
-			dam = dam * cfg_ninja_belt_mult( belt - BELT_ONE + 1 ) / 100;
-	}
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_DEMON ) && IS_SET( ch->warp, WARP_STRONGARMS ) )
-		dam = dam * cfg( CFG_COMBAT_DMG_MULT_DEMON_STRONGARMS ) / 100;
-
-	/* Mechanist Servo Arms: flat damage bonus on melee */
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_MECHANIST ) &&
-		ch->pcdata->powers[MECH_SERVO_ARMS] > 0 &&
-		dt >= TYPE_HIT && dt <= TYPE_HIT + 12 )
-		dam += cfg( CFG_ABILITY_MECHANIST_SERVOARMS_DAM_BONUS );
-
-	/* Mechanist Power Arms implant: flat damage bonus on melee */
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_MECHANIST ) &&
-		ch->pcdata->powers[MECH_SERVO_IMPLANT] == IMPLANT_SERVO_POWER_ARMS &&
-		dt >= TYPE_HIT && dt <= TYPE_HIT + 12 )
-		dam += cfg( CFG_ABILITY_MECHANIST_IMPLANT_SERVO_POWER_DAM );
+	ops = class_ops( ch );
+	if ( ops->dam_mod != NULL )
+		dam = ops->dam_mod( ch, victim, dam, dt );
 
 	if ( IS_NPC( victim ) ) {
 
@@ -1439,33 +1406,8 @@ bool one_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int handtype ) {
 
 	/* The test ends here */
 
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_SHAPESHIFTER ) ) {
-		dam = (int) ( dam * 1.4 );
-		if ( ch->pcdata->powers[SHAPE_FORM] == TIGER_FORM && ch->pcdata->powers[TIGER_LEVEL] > 1 )
-			dam = (int) ( dam * 1.5 );
-		else if ( ch->pcdata->powers[SHAPE_FORM] == FAERIE_FORM && ch->pcdata->powers[FAERIE_LEVEL] > 1 )
-			dam = (int) ( dam * 1.2 );
-		else if ( ch->pcdata->powers[SHAPE_FORM] == HYDRA_FORM && ch->pcdata->powers[HYDRA_LEVEL] > 1 )
-			dam = (int) ( dam * 1.6 );
-		else if ( ch->pcdata->powers[SHAPE_FORM] == BULL_FORM && ch->pcdata->powers[BULL_LEVEL] > 1 )
-			dam = (int) ( dam * 1.7 );
-		else
-			dam = dam;
-	}
-	if ( IS_CLASS( ch, CLASS_DROID ) && !IS_NPC( ch ) ) {
-		if ( ch->pcdata->powers[CYBORG_LIMBS] > 0 ) dam = (int) ( dam * 1.3 );
-		if ( ch->pcdata->powers[CYBORG_LIMBS] > 2 ) dam = (int) ( dam * 1.5 );
-	}
-	if ( IS_CLASS( ch, CLASS_UNDEAD_KNIGHT ) ) {
-		if ( ch->pcdata->powers[WEAPONSKILL] > 4 ) dam = (int) ( dam * 1.2 );
-		if ( ch->pcdata->powers[WEAPONSKILL] > 8 ) dam = (int) ( dam * 1.3 );
-	}
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_WEREWOLF ) && ch_power(ch)[DISC_WERE_BEAR] > 5 )
-		dam = (int) ( dam * 1.2 );
-	/* Wyrm: ancientwrath damage bonus */
-	if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_WYRM ) &&
-		ch->pcdata->powers[DRAGON_ANCIENTWRATH] > 0 )
-		dam = dam * ( 100 + cfg( CFG_ABILITY_WYRM_ANCIENTWRATH_DAMAGE_BONUS ) ) / 100;
+	if ( ops->dam_mod_late != NULL )
+		dam = ops->dam_mod_late( ch, victim, dam, dt );
 	if ( !IS_NPC( victim ) && IS_CLASS( victim, CLASS_SHAPESHIFTER ) ) {
 		if ( victim->pcdata->powers[SHAPE_FORM] == FAERIE_FORM && victim->pcdata->powers[FAERIE_LEVEL] > 0 ) {
 			int growl = number_range( 1, 50 );
@@ -1509,7 +1451,7 @@ bool one_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int handtype ) {
 				if ( hurt_person( ch, victim, wdam ) ) return true;
 			}
 			if ( ch->fighting == victim && ( IS_WEAP( wield, WEAPON_FROST ) || IS_WEAP( wield, WEAPON_ELE_WATER ) ) ) {
-				int sn = skill_lookup( "chill touch" );
+				int sn = gsn_chill_touch;
 				if ( !is_affected( victim, sn ) ) {
 					wdam = number_range( 1, wield->level / 6 + 2 );
 					if ( !IS_SET( ch->act, PLR_BRIEF2 ) ) act( "Your $p freezes $N.", ch, wield, victim, TO_CHAR );
@@ -2458,7 +2400,7 @@ bool hurt_person( CHAR_DATA *ch, CHAR_DATA *victim, int dam ) {
 		if ( IS_NPC( victim ) && !IS_NPC( ch ) ) {
 			ch->pcdata->mkill += 1;
 			ch->pcdata->stats_dirty = TRUE;
-			quest_check_progress( ch, QOBJ_KILL_MOB, "any", 1 );
+			quest_check_progress( ch, QOT_KILL_MOB, "any", 1 );
 
 			if ( IS_CLASS( ch, CLASS_DEMON ) || IS_CLASS( ch, CLASS_DROW ) || IS_CLASS( ch, CLASS_DROID ) || IS_CLASS( ch, CLASS_TANARRI ) ) {
 				if ( IS_NPC( victim ) && !IS_SET( victim->act, ACT_NOEXP ) ) {
@@ -2481,7 +2423,7 @@ bool hurt_person( CHAR_DATA *ch, CHAR_DATA *victim, int dam ) {
 			victim->pcdata->stats_dirty = TRUE;
 		}
 		if ( !IS_NPC( victim ) && !IS_NPC( ch ) && ch != victim )
-			quest_check_progress( ch, QOBJ_KILL_PLAYER, "any", 1 );
+			quest_check_progress( ch, QOT_KILL_PLAYER, "any", 1 );
 		mcmp_combat_death( ch, victim );
 		raw_kill( victim );
 		if ( !IS_NPC( ch ) && !IS_NPC( victim ) && victim->pcdata->bounty > 0 ) {
@@ -3458,46 +3400,12 @@ void raw_kill( CHAR_DATA *victim ) {
 		victim->mounted = IS_ON_FOOT;
 	}
 	if ( IS_NPC( victim ) ) {
-		/* Decrement Artificer turret count if a turret was killed */
-		if ( victim->pIndexData != NULL && victim->wizard != NULL &&
-			!IS_NPC( victim->wizard ) && victim->pIndexData->vnum == VNUM_ART_TURRET &&
-			IS_CLASS( victim->wizard, CLASS_ARTIFICER ) &&
-			victim->wizard->pcdata->powers[ART_TURRET_COUNT] > 0 ) {
-			victim->wizard->pcdata->powers[ART_TURRET_COUNT]--;
-			send_to_char( "One of your turrets has been destroyed!\n\r", victim->wizard );
-		}
-
-		/* Decrement Mechanist drone counts if a drone was killed */
-		if ( victim->pIndexData != NULL && victim->wizard != NULL &&
-			!IS_NPC( victim->wizard ) && IS_CLASS( victim->wizard, CLASS_MECHANIST ) ) {
-			if ( victim->pIndexData->vnum == VNUM_MECH_COMBAT_DRONE &&
-				victim->wizard->pcdata->powers[MECH_DRONE_COUNT] > 0 ) {
-				victim->wizard->pcdata->powers[MECH_DRONE_COUNT]--;
-				send_to_char( "One of your combat drones has been destroyed!\n\r", victim->wizard );
-			} else if ( victim->pIndexData->vnum == VNUM_MECH_BOMBER_DRONE ) {
-				victim->wizard->pcdata->powers[MECH_BOMBER_ACTIVE] = 0;
-				send_to_char( "Your bomber drone has been destroyed!\n\r", victim->wizard );
-			}
-		}
-
-		/* Shaman totem killed: clear totem state */
-		if ( victim->pIndexData != NULL && victim->wizard != NULL &&
-			!IS_NPC( victim->wizard ) && victim->pIndexData->vnum == VNUM_SHAMAN_TOTEM &&
-			IS_CLASS( victim->wizard, CLASS_SHAMAN ) ) {
-			victim->wizard->pcdata->powers[SHAMAN_ACTIVE_TOTEM] = TOTEM_NONE;
-			victim->wizard->pcdata->powers[SHAMAN_WARD_TICKS] = 0;
-			victim->wizard->pcdata->powers[SHAMAN_WRATH_TICKS] = 0;
-			victim->wizard->pcdata->powers[SHAMAN_SPIRIT_TOTEM_TICKS] = 0;
-			send_to_char( "Your totem has been destroyed!\n\r", victim->wizard );
-		}
+		/* Summons: let the owner's class update its counts */
+		if ( victim->pIndexData != NULL && victim->wizard != NULL && !IS_NPC( victim->wizard ) ) {
+			const CLASS_OPS *ops = class_ops( victim->wizard );
 
-		/* Spirit Lord spirit warrior killed: decrement army count */
-		if ( victim->pIndexData != NULL && victim->wizard != NULL &&
-			!IS_NPC( victim->wizard ) && victim->pIndexData->vnum == VNUM_SL_SPIRIT_WARRIOR &&
-			IS_CLASS( victim->wizard, CLASS_SPIRITLORD ) &&
-			victim->wizard->pcdata->stats[SL_STAT_ARMY_COUNT] > 0 ) {
-			victim->wizard->pcdata->stats[SL_STAT_ARMY_COUNT]--;
-			send_to_char( "One of your spirit warriors has been destroyed!\n\r", victim->wizard );
+			if ( ops->minion_death != NULL )
+				ops->minion_death( victim->wizard, victim );
 		}
 
 		victim->pIndexData->killed++;
@@ -3952,11 +3860,12 @@ void dam_message( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt ) {
 				}
 			}
 		}
-		act( buf1, ch, NULL, victim, TO_NOTVICT );
+		if ( combatsum_hit( ch, victim, dam ) )
+			act( buf1, ch, NULL, victim, TO_NOTVICT_HIT );
 
-		if ( !( IS_SET( ch->act, PLR_BRIEF2 ) && ( dam == 0 || dt == skill_lookup( "lightning bolt" ) || dt == skill_lookup( "acid blast" ) || dt == skill_lookup( "chill touch" ) || dt == skill_lookup( "fireball" ) ) ) )
+		if ( !( IS_SET( ch->act, PLR_BRIEF2 ) && ( dam == 0 || dt == gsn_lightning_bolt || dt == gsn_acid_blast || dt == gsn_chill_touch || dt == gsn_fireball_spell ) ) )
 			act( buf2, ch, NULL, victim, TO_CHAR );
-		if ( !( IS_SET( victim->act, PLR_BRIEF2 ) && ( dam == 0 || dt == skill_lookup( "lightning bolt" ) || dt == skill_lookup( "acid blast" ) || dt == skill_lookup( "chill touch" ) || dt == skill_lookup( "fireball" ) ) ) )
+		if ( !( IS_SET( victim->act, PLR_BRIEF2 ) && ( dam == 0 || dt == gsn_lightning_bolt || dt == gsn_acid_blast || dt == gsn_chill_touch || dt == gsn_fireball_spell ) ) )
 			act( buf3, ch, NULL, victim, TO_VICT );
 		if ( critical ) critical_hit( ch, victim, dt, dam );
 		return;
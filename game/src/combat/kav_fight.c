@@ -1113,7 +1113,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1152,7 +1152,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1191,7 +1191,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1223,7 +1223,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1257,7 +1257,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1292,7 +1292,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1344,7 +1344,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1396,7 +1396,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1433,7 +1433,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1470,7 +1470,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1518,7 +1518,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1569,7 +1569,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1670,7 +1670,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1764,7 +1764,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1868,7 +1868,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -1958,7 +1958,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -2004,7 +2004,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -2050,7 +2050,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -2084,7 +2084,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -2118,7 +2118,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -2159,7 +2159,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -2208,7 +2208,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -2282,7 +2282,7 @@ void critical_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dt, int dam ) {
 		/*
 		 * Stone skin will prevent any damage done to arms/legs.
 		 */
-		if ( is_affected( victim, skill_lookup( "stone skin" ) ) ) return;
+		if ( is_affected( victim, gsn_stone_skin ) ) return;
 
 		if ( IS_CLASS( ch, CLASS_SAMURAI ) && number_range( 1, 3 ) == 2 ) return;
 
@@ -126,21 +126,116 @@ bool is_obj( CHAR_DATA *ch ) {
 }
 
 /*
- * Lookup a skill by name.
+ * Skill name index: every prefix of every skill name, lowercased, maps
+ * to the lowest sn it abbreviates -- the entry the old linear scan over
+ * skill_table found first.  skill_table is const, so it is built once on
+ * first use.  Open addressing; a few thousand prefixes in all.
+ */
+#define SKILL_HASH_SIZE 8192 /* Power of two */
+
+typedef struct skill_prefix {
+	int sn;	 /* -1 for an empty slot */
+	int len; /* Prefix length */
+} SKILL_PREFIX;
+
+static SKILL_PREFIX skill_hash[SKILL_HASH_SIZE];
+static int skill_name_max; /* Longest skill name */
+static bool skill_hash_built;
+
+static unsigned int skill_hash_fn( const char *name, int len ) {
+	unsigned int h = 5381;
+	int i;
+
+	for ( i = 0; i < len; i++ )
+		h = ( h << 5 ) + h + (unsigned int) tolower( (unsigned char) name[i] );
+	return h & ( SKILL_HASH_SIZE - 1 );
+}
+
+static bool skill_prefix_eq( const char *a, const char *b, int len ) {
+	int i;
+
+	for ( i = 0; i < len; i++ ) {
+		if ( tolower( (unsigned char) a[i] ) != tolower( (unsigned char) b[i] ) )
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static void skill_hash_build( void ) {
+	int sn, len, used = 0;
+	unsigned int i;
+
+	for ( i = 0; i < SKILL_HASH_SIZE; i++ )
+		skill_hash[i].sn = -1;
+
+	for ( sn = 0; sn < MAX_SKILL && skill_table[sn].name != NULL; sn++ ) {
+		const char *name = skill_table[sn].name;
+		int name_len = (int) strlen( name );
+
+		if ( name_len > skill_name_max )
+			skill_name_max = name_len;
+
+		for ( len = 1; len <= name_len; len++ ) {
+			for ( i = skill_hash_fn( name, len ); skill_hash[i].sn >= 0; i = ( i + 1 ) & ( SKILL_HASH_SIZE - 1 ) ) {
+				if ( skill_hash[i].len == len
+					&& skill_prefix_eq( skill_table[skill_hash[i].sn].name, name, len ) )
+					break;
+			}
+			if ( skill_hash[i].sn >= 0 )
+				continue; /* A lower sn already owns this prefix */
+			if ( ++used > SKILL_HASH_SIZE * 3 / 4 ) {
+				bug( "Skill_lookup: name index full, raise SKILL_HASH_SIZE.", 0 );
+				abort();
+			}
+			skill_hash[i].sn = sn;
+			skill_hash[i].len = len;
+		}
+	}
+	skill_hash_built = TRUE;
+}
+
+/*
+ * Lookup a skill by name.  Any case-insensitive prefix matches; the
+ * lowest sn wins.
  */
 int skill_lookup( const char *name ) {
-	int sn;
+	unsigned int i;
+	int len;
 
-	for ( sn = 0; sn < MAX_SKILL; sn++ ) {
-		if ( skill_table[sn].name == NULL )
-			break;
-		if ( tolower( name[0] ) == tolower( skill_table[sn].name[0] ) && !str_prefix( name, skill_table[sn].name ) )
-			return sn;
+	if ( !skill_hash_built )
+		skill_hash_build();
+
+	len = (int) strlen( name );
+	if ( len == 0 || len > skill_name_max )
+		return -1;
+
+	for ( i = skill_hash_fn( name, len ); skill_hash[i].sn >= 0; i = ( i + 1 ) & ( SKILL_HASH_SIZE - 1 ) ) {
+		if ( skill_hash[i].len == len && !str_prefix( name, skill_table[skill_hash[i].sn].name ) )
+			return skill_hash[i].sn;
 	}
 
 	return -1;
 }
 
+/*
+ * Fill in the skill_names.h handles.  Called from boot_db() after the
+ * pgsn pass.
+ */
+void resolve_skill_names( void ) {
+	static const struct {
+		int *pgsn;
+		const char *name;
+	} names[] = {
+#define SKILL_X( gsn, name ) { &gsn, name },
+		SKILL_NAME_ENTRIES
+#undef SKILL_X
+	};
+	size_t i;
+
+	for ( i = 0; i < sizeof( names ) / sizeof( names[0] ); i++ )
+		*names[i].pgsn = skill_lookup( names[i].name );
+}
+
 /*
  * Lookup a skill by slot number.
  * Used for object loading.
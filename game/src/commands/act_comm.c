@@ -24,6 +24,7 @@
 #include "merc.h"
 #include "gmcp.h"
 #include "../systems/mcmp.h"
+#include "../systems/textfilter.h"
 #include "../db/db_game.h"
 #include "../script/script.h"
 #include "../db/db_player.h"
@@ -95,6 +96,7 @@ void do_bounty( CHAR_DATA *ch, char *argument ) {
  */
 void talk_channel( CHAR_DATA *ch, char *argument, int channel, const char *verb ) {
 	char buf[MAX_STRING_LENGTH];
+	char masked[MAX_INPUT_LENGTH * 4];
 	DESCRIPTOR_DATA *d;
 	int position;
 
@@ -127,6 +129,10 @@ void talk_channel( CHAR_DATA *ch, char *argument, int channel, const char *verb
 		return;
 	}
 
+	/* Profanity filter patterns (see nameban) are starred out */
+	if ( textfilter_mask( argument, masked, sizeof( masked ) ) )
+		argument = masked;
+
 	REMOVE_BIT( ch->deaf, channel );
 
 	switch ( channel ) {
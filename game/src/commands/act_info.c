@@ -22,11 +22,14 @@
 #include <string.h>
 #include <time.h>
 #include "merc.h"
+#include "prompt.h"
 #include "utf8.h"
 #include "../script/script.h"
 #include "../db/db_player.h"
 #include "../db/db_game.h"
 #include "../systems/mxp.h"
+#include "mem_arena.h"
+#include "../world/room_render.h"
 #include "../systems/ttype.h"
 #include "../classes/artificer.h"
 
@@ -270,73 +273,138 @@ const char *get_room_tint_color( ROOM_INDEX_DATA *room ) {
 }
 
 /*
- * Build item prefixes with MXP tooltips into prefix_buf.
- * Returns the prefix string (may be empty).
+ * Which item prefixes an object shows to a viewer.  The tags themselves
+ * are fixed text, so two objects with the same bits and description
+ * render identically; show_list_to_char() groups on that.
  */
-static char *format_obj_prefixes( OBJ_DATA *obj, CHAR_DATA *ch ) {
-	static char prefix_buf[MAX_STRING_LENGTH];
-	char *ptr = prefix_buf;
-	prefix_buf[0] = '\0';
-
-#define OBJ_PREFIX_APPEND( text ) \
-	do { \
-		ptr = buf_append_safe( ptr, (text), prefix_buf, sizeof( prefix_buf ), 10 ); \
-		if ( ptr == NULL ) { ptr = prefix_buf + sizeof( prefix_buf ) - 10; goto done; } \
-	} while( 0 )
+#define OBJ_PFX_ARTIFACT     ( 1 << 0 )
+#define OBJ_PFX_PRIZE        ( 1 << 1 )
+#define OBJ_PFX_RELIC        ( 1 << 2 )
+#define OBJ_PFX_LEGENDARY    ( 1 << 3 )
+#define OBJ_PFX_MYTHICAL     ( 1 << 4 )
+#define OBJ_PFX_PRICELESS    ( 1 << 5 )
+#define OBJ_PFX_GLOW         ( 1 << 6 )
+#define OBJ_PFX_HUM          ( 1 << 7 )
+#define OBJ_PFX_INVIS        ( 1 << 8 )
+#define OBJ_PFX_BLUE_AURA    ( 1 << 9 )
+#define OBJ_PFX_RED_AURA     ( 1 << 10 )
+#define OBJ_PFX_YELLOW_AURA  ( 1 << 11 )
+#define OBJ_PFX_MAGICAL      ( 1 << 12 )
+#define OBJ_PFX_COPPER       ( 1 << 13 )
+#define OBJ_PFX_IRON         ( 1 << 14 )
+#define OBJ_PFX_STEEL        ( 1 << 15 )
+#define OBJ_PFX_ADAMANTITE   ( 1 << 16 )
+#define OBJ_PFX_HILT         ( 1 << 17 )
+#define OBJ_PFX_GEMSTONE     ( 1 << 18 )
+#define OBJ_PFX_SHADOWPLANE  ( 1 << 19 )
+#define OBJ_PFX_NORMALPLANE  ( 1 << 20 )
+
+static int obj_prefix_bits( OBJ_DATA *obj, CHAR_DATA *ch ) {
+	int bits = 0;
 
 	/* === Item rarity/quest prefixes === */
 	if ( IS_SET( obj->quest, QUEST_ARTIFACT ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#y(Artifact)#n ", "Artifact - unique powerful item", -1 ) );
+		bits |= OBJ_PFX_ARTIFACT;
 	else if ( IS_SET( obj->quest, QUEST_PRIZE ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#3(#CPrize#3)#n ", "Prize - quest reward", -1 ) );
+		bits |= OBJ_PFX_PRIZE;
 	else if ( IS_SET( obj->quest, QUEST_RELIC ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#3(#7Relic#3)#n ", "Relic - ancient powerful item", -1 ) );
+		bits |= OBJ_PFX_RELIC;
 	else if ( obj->points < 750 && obj->points != 0 )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#3(Legendary)#n ", "Legendary item", -1 ) );
+		bits |= OBJ_PFX_LEGENDARY;
 	else if ( obj->points < 1250 && obj->points != 0 )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#7(#2Mythical#7)#n ", "Mythical item", -1 ) );
+		bits |= OBJ_PFX_MYTHICAL;
 	else if ( obj->points != 0 )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#6(#3Priceless#6)#n ", "Priceless item", -1 ) );
+		bits |= OBJ_PFX_PRICELESS;
 
 	/* === Magical property prefixes === */
 	if ( IS_OBJ_STAT( obj, ITEM_GLOW ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#y(#rGlow#y)#n ", "Glowing - continual light", skill_lookup( "continual light" ) ) );
+		bits |= OBJ_PFX_GLOW;
 	if ( IS_OBJ_STAT( obj, ITEM_HUM ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#y(#rHum#y)#n ", "Humming - magical resonance", -1 ) );
+		bits |= OBJ_PFX_HUM;
 	if ( IS_OBJ_STAT( obj, ITEM_INVIS ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#6(Invis)#n ", "Invisible item", skill_lookup( "invis" ) ) );
+		bits |= OBJ_PFX_INVIS;
 
 	/* === Alignment auras (requires detect evil) === */
 	if ( IS_AFFECTED( ch, AFF_DETECT_EVIL ) && !IS_OBJ_STAT( obj, ITEM_ANTI_GOOD ) && IS_OBJ_STAT( obj, ITEM_ANTI_EVIL ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#4(Blue Aura)#n ", "Good-aligned item", -1 ) );
+		bits |= OBJ_PFX_BLUE_AURA;
 	else if ( IS_AFFECTED( ch, AFF_DETECT_EVIL ) && IS_OBJ_STAT( obj, ITEM_ANTI_GOOD ) && !IS_OBJ_STAT( obj, ITEM_ANTI_EVIL ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#1(Red Aura)#n ", "Evil-aligned item", -1 ) );
+		bits |= OBJ_PFX_RED_AURA;
 	else if ( IS_AFFECTED( ch, AFF_DETECT_EVIL ) && IS_OBJ_STAT( obj, ITEM_ANTI_GOOD ) && !IS_OBJ_STAT( obj, ITEM_ANTI_NEUTRAL ) && IS_OBJ_STAT( obj, ITEM_ANTI_EVIL ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#3(Yellow Aura)#n ", "Neutral-aligned item", -1 ) );
+		bits |= OBJ_PFX_YELLOW_AURA;
 
 	/* === Magical detection (requires detect magic) === */
 	if ( IS_AFFECTED( ch, AFF_DETECT_MAGIC ) && IS_OBJ_STAT( obj, ITEM_MAGIC ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#4(Magical)#n ", "Magical enchantment", skill_lookup( "detect magic" ) ) );
+		bits |= OBJ_PFX_MAGICAL;
 
 	/* === Material prefixes === */
 	if ( IS_SET( obj->spectype, SITEM_COPPER ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#r(Copper)#n ", "Copper material", -1 ) );
+		bits |= OBJ_PFX_COPPER;
 	if ( IS_SET( obj->spectype, SITEM_IRON ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#c(Iron)#n ", "Iron material", -1 ) );
+		bits |= OBJ_PFX_IRON;
 	if ( IS_SET( obj->spectype, SITEM_STEEL ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#C(Steel)#n ", "Steel material", -1 ) );
+		bits |= OBJ_PFX_STEEL;
 	if ( IS_SET( obj->spectype, SITEM_ADAMANTITE ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#0(#CAdamantite#0)#n ", "Adamantite material", -1 ) );
+		bits |= OBJ_PFX_ADAMANTITE;
 	if ( IS_SET( obj->spectype, SITEM_HILT ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#P(Hilted)#n ", "Custom hilt", -1 ) );
+		bits |= OBJ_PFX_HILT;
 	if ( IS_SET( obj->spectype, SITEM_GEMSTONE ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#C(#yGemstoned#C)#n ", "Gemstone embedded", -1 ) );
+		bits |= OBJ_PFX_GEMSTONE;
 
 	/* === Plane indicators === */
 	if ( IS_OBJ_STAT( obj, ITEM_SHADOWPLANE ) && obj->in_room != NULL && !IS_AFFECTED( ch, AFF_SHADOWPLANE ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#0(Shadowplane)#n ", "On shadow plane", -1 ) );
+		bits |= OBJ_PFX_SHADOWPLANE;
 	if ( !IS_OBJ_STAT( obj, ITEM_SHADOWPLANE ) && obj->in_room != NULL && IS_AFFECTED( ch, AFF_SHADOWPLANE ) )
-		OBJ_PREFIX_APPEND( mxp_aura_tag( ch, "#7(Normal plane)#n ", "On normal plane", -1 ) );
+		bits |= OBJ_PFX_NORMALPLANE;
+
+	return bits;
+}
+
+/*
+ * Build item prefixes with MXP tooltips into prefix_buf.
+ * Returns the prefix string (may be empty).
+ */
+static char *format_prefix_bits( int bits, CHAR_DATA *ch ) {
+	static char prefix_buf[MAX_STRING_LENGTH];
+	char *ptr = prefix_buf;
+	prefix_buf[0] = '\0';
+
+#define OBJ_PREFIX_APPEND( flag, text, tip, sn ) \
+	do { \
+		if ( bits & ( flag ) ) { \
+			ptr = buf_append_safe( ptr, mxp_aura_tag( ch, (text), (tip), (sn) ), prefix_buf, sizeof( prefix_buf ), 10 ); \
+			if ( ptr == NULL ) { ptr = prefix_buf + sizeof( prefix_buf ) - 10; goto done; } \
+		} \
+	} while( 0 )
+
+	if ( bits == 0 )
+		return prefix_buf;
+
+	OBJ_PREFIX_APPEND( OBJ_PFX_ARTIFACT, "#y(Artifact)#n ", "Artifact - unique powerful item", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_PRIZE, "#3(#CPrize#3)#n ", "Prize - quest reward", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_RELIC, "#3(#7Relic#3)#n ", "Relic - ancient powerful item", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_LEGENDARY, "#3(Legendary)#n ", "Legendary item", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_MYTHICAL, "#7(#2Mythical#7)#n ", "Mythical item", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_PRICELESS, "#6(#3Priceless#6)#n ", "Priceless item", -1 );
+
+	OBJ_PREFIX_APPEND( OBJ_PFX_GLOW, "#y(#rGlow#y)#n ", "Glowing - continual light", gsn_continual_light );
+	OBJ_PREFIX_APPEND( OBJ_PFX_HUM, "#y(#rHum#y)#n ", "Humming - magical resonance", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_INVIS, "#6(Invis)#n ", "Invisible item", gsn_invis );
+
+	OBJ_PREFIX_APPEND( OBJ_PFX_BLUE_AURA, "#4(Blue Aura)#n ", "Good-aligned item", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_RED_AURA, "#1(Red Aura)#n ", "Evil-aligned item", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_YELLOW_AURA, "#3(Yellow Aura)#n ", "Neutral-aligned item", -1 );
+
+	OBJ_PREFIX_APPEND( OBJ_PFX_MAGICAL, "#4(Magical)#n ", "Magical enchantment", gsn_detect_magic );
+
+	OBJ_PREFIX_APPEND( OBJ_PFX_COPPER, "#r(Copper)#n ", "Copper material", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_IRON, "#c(Iron)#n ", "Iron material", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_STEEL, "#C(Steel)#n ", "Steel material", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_ADAMANTITE, "#0(#CAdamantite#0)#n ", "Adamantite material", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_HILT, "#P(Hilted)#n ", "Custom hilt", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_GEMSTONE, "#C(#yGemstoned#C)#n ", "Gemstone embedded", -1 );
+
+	OBJ_PREFIX_APPEND( OBJ_PFX_SHADOWPLANE, "#0(Shadowplane)#n ", "On shadow plane", -1 );
+	OBJ_PREFIX_APPEND( OBJ_PFX_NORMALPLANE, "#7(Normal plane)#n ", "On normal plane", -1 );
 
 done:
 	*ptr = '\0';
@@ -344,6 +412,10 @@ done:
 	return prefix_buf;
 }
 
+static char *format_obj_prefixes( OBJ_DATA *obj, CHAR_DATA *ch ) {
+	return format_prefix_bits( obj_prefix_bits( obj, ch ), ch );
+}
+
 /*
  * Build item description (without prefixes).
  * Returns just the item name/description.
@@ -534,6 +606,131 @@ int char_ac( CHAR_DATA *ch ) {
 	return value;
 }
 
+/*
+ * show_list_to_char() groups identical lines through a hash table keyed
+ * on what the line is built from: the prefix bits for this viewer, the
+ * damaged flag and the description text.  Each group is formatted once
+ * into a scratch arena, so a pile of n objects costs O(n) hashing plus
+ * one format per distinct line instead of n formats and an O(n^2) scan.
+ */
+typedef struct obj_show_group {
+	OBJ_DATA   *obj;        /* First object in the group, for MXP links */
+	const char *desc;       /* Raw description the group was keyed on */
+	unsigned    hash;
+	int         bits;       /* obj_prefix_bits(), plus OBJ_SHOW_DAMAGED */
+	int         count;
+	char       *text;       /* Prefixes + description, in show_arena */
+	char       *link_desc;  /* Description part of text, for MXP */
+} OBJ_SHOW_GROUP;
+
+#define OBJ_SHOW_DAMAGED ( 1 << 30 )
+
+static MEM_ARENA       show_arena;
+static OBJ_SHOW_GROUP *show_groups;
+static int             show_groups_alloc;
+static int            *show_table;      /* Group index + 1, 0 = empty */
+static int             show_table_size;
+
+static unsigned obj_show_hash( const char *desc, int bits ) {
+	unsigned h = 2166136261u ^ (unsigned) bits;
+
+	while ( *desc != '\0' ) {
+		h ^= (unsigned char) *desc++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/* Size the scratch arrays for count objects */
+static void obj_show_reserve( int count ) {
+	int size;
+
+	if ( count > show_groups_alloc ) {
+		free( show_groups );
+		show_groups_alloc = count + count / 2;
+		show_groups = calloc( show_groups_alloc, sizeof( *show_groups ) );
+		if ( show_groups == NULL ) {
+			bug( "show_list_to_char: calloc failed", 0 );
+			exit( 1 );
+		}
+	}
+
+	/* Power of two, at most half full */
+	for ( size = 64; size < count * 2; size <<= 1 )
+		;
+	if ( size > show_table_size ) {
+		free( show_table );
+		show_table_size = size;
+		show_table = malloc( size * sizeof( *show_table ) );
+		if ( show_table == NULL ) {
+			bug( "show_list_to_char: malloc failed", 0 );
+			exit( 1 );
+		}
+	}
+}
+
+/*
+ * Add obj to its group, formatting it if it starts a new one.
+ * Returns the new group count.
+ */
+static int obj_show_add( OBJ_DATA *obj, CHAR_DATA *ch, bool fShort, bool fCombine, int nShow ) {
+	OBJ_SHOW_GROUP *g;
+	const char *desc;
+	char *prefix;
+	unsigned hash, mask;
+	size_t plen, dlen;
+	int bits;
+	int slot = 0;
+
+	if ( !IS_NPC( ch ) && ch->pcdata->chobj != NULL && obj->chobj != NULL && obj->chobj == ch )
+		return nShow;
+	if ( obj->wear_loc != WEAR_NONE || !can_see_obj( ch, obj ) )
+		return nShow;
+
+	/* Mirrors format_obj_desc() */
+	bits = obj_prefix_bits( obj, ch );
+	if ( fShort ) {
+		desc = obj->short_descr != NULL ? obj->short_descr : "";
+		if ( obj->condition < 100 )
+			bits |= OBJ_SHOW_DAMAGED;
+	} else {
+		desc = obj->description != NULL ? obj->description : "";
+	}
+	hash = obj_show_hash( desc, bits );
+
+	if ( fCombine ) {
+		mask = (unsigned) show_table_size - 1;
+		for ( slot = (int) ( hash & mask ); show_table[slot] != 0; slot = (int) ( ( slot + 1 ) & mask ) ) {
+			g = &show_groups[show_table[slot] - 1];
+			if ( g->hash == hash && g->bits == bits && !strcmp( g->desc, desc ) ) {
+				g->count++;
+				return nShow;
+			}
+		}
+		show_table[slot] = nShow + 1;
+	}
+
+	/* First of its kind: format once */
+	g = &show_groups[nShow];
+	g->obj   = obj;
+	g->desc  = desc;
+	g->hash  = hash;
+	g->bits  = bits;
+	g->count = 1;
+
+	prefix = format_prefix_bits( bits & ~OBJ_SHOW_DAMAGED, ch );
+	plen = strlen( prefix );
+	dlen = strlen( desc );
+	g->text = mem_arena_alloc( &show_arena, plen + dlen + sizeof( " #1(Damaged)#n" ) );
+	memcpy( g->text, prefix, plen );
+	memcpy( g->text + plen, desc, dlen + 1 );
+	if ( bits & OBJ_SHOW_DAMAGED )
+		strcpy( g->text + plen + dlen, " #1(Damaged)#n" );
+	g->link_desc = g->text + plen;
+
+	return nShow + 1;
+}
+
 /*
  * Show a list to a character.
  * Can coalesce duplicated items.
@@ -543,135 +740,54 @@ int char_ac( CHAR_DATA *ch ) {
  */
 void show_list_to_char( void *list, CHAR_DATA *ch, bool fShort, bool fShowNothing, bool in_room ) {
 	char buf[MAX_STRING_LENGTH];
-	char **prgpstrShow;		/* Full string for comparison (prefix + desc) */
-	char **prgpstrPrefix;	/* Just the MXP-tagged prefixes */
-	char **prgpstrDesc;		/* Just the item description */
-	OBJ_DATA **prgpObjShow; /* Track first object of each type for MXP */
-	int *prgnShow;
-	char *pstrShow;
-	char *pstrPrefix;
-	char *pstrDesc;
+	list_head_t *head = (list_head_t *) list;
+	OBJ_SHOW_GROUP *g;
 	OBJ_DATA *obj;
 	int nShow;
 	int iShow;
-	int count;
 	bool fCombine;
 	bool fMxp;
 
 	if ( ch->desc == NULL )
 		return;
 
-	if ( in_room ) {
-		if ( list_empty( (list_head_t *) list ) ) {
-			if ( fShowNothing )
-				send_to_char( "     Nothing.\n\r", ch );
-			return;
-		}
-	} else {
-		if ( (OBJ_DATA *) list == NULL ) {
-			if ( fShowNothing )
-				send_to_char( "     Nothing.\n\r", ch );
-			return;
-		}
+	if ( in_room && list_empty( head ) ) {
+		if ( fShowNothing )
+			send_to_char( "     Nothing.\n\r", ch );
+		return;
 	}
 
 	/* Check if MXP is enabled for this character */
 	fMxp = ( ch->desc->mxp_enabled == TRUE );
+	fCombine = ( IS_NPC( ch ) || IS_SET( ch->act, PLR_COMBINE ) );
 
-	/*
-	 * Alloc space for output lines.
-	 */
-	count = 0;
-	if ( in_room ) {
-		LIST_FOR_EACH( obj, (list_head_t *) list, OBJ_DATA, room_node )
-			count++;
-	} else {
-		LIST_FOR_EACH( obj, (list_head_t *) list, OBJ_DATA, content_node )
-			count++;
-	}
-	prgpstrShow = calloc( count, sizeof( char * ) );
-	prgpstrPrefix = calloc( count, sizeof( char * ) );
-	prgpstrDesc = calloc( count, sizeof( char * ) );
-	prgpObjShow = calloc( count, sizeof( OBJ_DATA * ) );
-	prgnShow = calloc( count, sizeof( int ) );
-	if ( !prgpstrShow || !prgpstrPrefix || !prgpstrDesc || !prgpObjShow || !prgnShow )
-		return;
+	obj_show_reserve( list_count( head ) );
+	memset( show_table, 0, show_table_size * sizeof( *show_table ) );
+	mem_arena_reset( &show_arena );
 	nShow = 0;
 
 	/*
-	 * Format the list of objects.
+	 * Group the visible objects.
 	 * Room objects use the intrusive doubly-linked list with room_node;
 	 * container/inventory objects use the intrusive doubly-linked list with content_node.
 	 */
 	if ( in_room ) {
-		LIST_FOR_EACH( obj, (list_head_t *) list, OBJ_DATA, room_node ) {
-			if ( !IS_NPC( ch ) && ch->pcdata->chobj != NULL && obj->chobj != NULL && obj->chobj == ch )
-				continue;
-			if ( obj->wear_loc == WEAR_NONE && can_see_obj( ch, obj ) ) {
-				pstrShow = format_obj_to_char( obj, ch, fShort );
-				pstrPrefix = format_obj_prefixes( obj, ch );
-				pstrDesc = format_obj_desc( obj, ch, fShort );
-				fCombine = FALSE;
-
-				if ( IS_NPC( ch ) || IS_SET( ch->act, PLR_COMBINE ) ) {
-					for ( iShow = nShow - 1; iShow >= 0; iShow-- ) {
-						if ( !strcmp( prgpstrShow[iShow], pstrShow ) ) {
-							prgnShow[iShow]++;
-							fCombine = TRUE;
-							break;
-						}
-					}
-				}
-
-				if ( !fCombine ) {
-					prgpstrShow[nShow] = str_dup( pstrShow );
-					prgpstrPrefix[nShow] = str_dup( pstrPrefix );
-					prgpstrDesc[nShow] = str_dup( pstrDesc );
-					prgpObjShow[nShow] = obj;
-					prgnShow[nShow] = 1;
-					nShow++;
-				}
-			}
-		}
+		LIST_FOR_EACH( obj, head, OBJ_DATA, room_node )
+			nShow = obj_show_add( obj, ch, fShort, fCombine, nShow );
 	} else {
-		LIST_FOR_EACH( obj, (list_head_t *) list, OBJ_DATA, content_node ) {
-			if ( !IS_NPC( ch ) && ch->pcdata->chobj != NULL && obj->chobj != NULL && obj->chobj == ch )
-				continue;
-			if ( obj->wear_loc == WEAR_NONE && can_see_obj( ch, obj ) ) {
-				pstrShow = format_obj_to_char( obj, ch, fShort );
-				pstrPrefix = format_obj_prefixes( obj, ch );
-				pstrDesc = format_obj_desc( obj, ch, fShort );
-				fCombine = FALSE;
-
-				if ( IS_NPC( ch ) || IS_SET( ch->act, PLR_COMBINE ) ) {
-					for ( iShow = nShow - 1; iShow >= 0; iShow-- ) {
-						if ( !strcmp( prgpstrShow[iShow], pstrShow ) ) {
-							prgnShow[iShow]++;
-							fCombine = TRUE;
-							break;
-						}
-					}
-				}
-
-				if ( !fCombine ) {
-					prgpstrShow[nShow] = str_dup( pstrShow );
-					prgpstrPrefix[nShow] = str_dup( pstrPrefix );
-					prgpstrDesc[nShow] = str_dup( pstrDesc );
-					prgpObjShow[nShow] = obj;
-					prgnShow[nShow] = 1;
-					nShow++;
-				}
-			}
-		}
+		LIST_FOR_EACH( obj, head, OBJ_DATA, content_node )
+			nShow = obj_show_add( obj, ch, fShort, fCombine, nShow );
 	}
 
 	/*
 	 * Output the formatted list.
 	 */
 	for ( iShow = 0; iShow < nShow; iShow++ ) {
-		if ( IS_NPC( ch ) || IS_SET( ch->act, PLR_COMBINE ) ) {
-			if ( prgnShow[iShow] != 1 ) {
-				snprintf( buf, sizeof( buf ), "(%2d) ", prgnShow[iShow] );
+		g = &show_groups[iShow];
+
+		if ( fCombine ) {
+			if ( g->count != 1 ) {
+				snprintf( buf, sizeof( buf ), "(%2d) ", g->count );
 				send_to_char( buf, ch );
 			} else {
 				send_to_char( "     ", ch );
@@ -682,46 +798,37 @@ void show_list_to_char( void *list, CHAR_DATA *ch, bool fShort, bool fShowNothin
 		 * MXP output: prefixes first (already MXP-wrapped), then description wrapped
 		 * Non-MXP output: just send the combined string
 		 */
-		if ( fMxp && prgpObjShow[iShow] != NULL ) {
+		if ( fMxp ) {
 			/* Output prefixes first (each already has its own MXP tooltip) */
-			if ( prgpstrPrefix[iShow][0] != '\0' )
-				send_to_char( prgpstrPrefix[iShow], ch );
+			if ( g->link_desc != g->text ) {
+				char saved = *g->link_desc;
+
+				*g->link_desc = '\0';
+				send_to_char( g->text, ch );
+				*g->link_desc = saved;
+			}
 
 			/* Check if item is inside a container */
-			if ( prgpObjShow[iShow]->in_obj != NULL ) {
+			if ( g->obj->in_obj != NULL ) {
 				/* Item in container: click to get from container */
-				send_to_char( mxp_container_item_link( prgpObjShow[iShow],
-								  prgpObjShow[iShow]->in_obj, ch, prgpstrDesc[iShow] ),
-					ch );
+				send_to_char( mxp_container_item_link( g->obj, g->obj->in_obj, ch, g->link_desc ), ch );
 			} else {
 				/* Normal item: use standard get/wear/look menu */
-				send_to_char( mxp_obj_link( prgpObjShow[iShow], ch, prgpstrDesc[iShow], in_room, prgnShow[iShow] ), ch );
+				send_to_char( mxp_obj_link( g->obj, ch, g->link_desc, in_room, g->count ), ch );
 			}
 		} else {
-			send_to_char( prgpstrShow[iShow], ch );
+			send_to_char( g->text, ch );
 		}
 
 		send_to_char( "\n\r", ch );
-		free(prgpstrShow[iShow]);
-		free(prgpstrPrefix[iShow]);
-		free(prgpstrDesc[iShow]);
 	}
 
 	if ( fShowNothing && nShow == 0 ) {
-		if ( IS_NPC( ch ) || IS_SET( ch->act, PLR_COMBINE ) )
+		if ( fCombine )
 			send_to_char( "     ", ch );
 		send_to_char( "Nothing.\n\r", ch );
 	}
 
-	/*
-	 * Clean up.
-	 */
-	free( prgpstrShow );
-	free( prgpstrPrefix );
-	free( prgpstrDesc );
-	free( prgpObjShow );
-	free( prgnShow );
-
 	return;
 }
 
@@ -776,12 +883,6 @@ void show_char_to_char_0( CHAR_DATA *victim, CHAR_DATA *ch ) {
 	char *pptr; /* tracked pointer for prefix_buf */
 	CHAR_DATA *mount;
 
-	/* Cache spell lookups for MXP tooltips */
-	int sn_invis = skill_lookup( "invis" );
-	int sn_charm = skill_lookup( "charm person" );
-	int sn_faerie = skill_lookup( "faerie fire" );
-	int sn_sanctuary = skill_lookup( "sanctuary" );
-
 	prefix_buf[0] = '\0';
 	desc_buf[0] = '\0';
 	suffix_buf[0] = '\0';
@@ -816,21 +917,21 @@ void show_char_to_char_0( CHAR_DATA *victim, CHAR_DATA *ch ) {
 		if ( !IS_NPC( victim ) && victim->desc == NULL )
 			PFX_APPEND( mxp_aura_tag( ch, "#y(Link-Dead)#n ", "Player disconnected", -1 ) );
 		if ( IS_AFFECTED( victim, AFF_INVISIBLE ) )
-			PFX_APPEND( mxp_aura_tag( ch, "#L(Invis)#n ", "Invisibility", sn_invis ) );
+			PFX_APPEND( mxp_aura_tag( ch, "#L(Invis)#n ", "Invisibility", gsn_invis ) );
 		if ( IS_AFFECTED( victim, AFF_HIDE ) )
 			PFX_APPEND( mxp_aura_tag( ch, "#0(Hide)#n ", "Hiding", -1 ) );
 		if ( IS_AFFECTED( victim, AFF_CHARM ) )
-			PFX_APPEND( mxp_aura_tag( ch, "#R(Charmed)#n ", "Charm person", sn_charm ) );
+			PFX_APPEND( mxp_aura_tag( ch, "#R(Charmed)#n ", "Charm person", gsn_charm_person ) );
 		if ( IS_AFFECTED( victim, AFF_PASS_DOOR ) || IS_AFFECTED( victim, AFF_ETHEREAL ) )
 			PFX_APPEND( mxp_aura_tag( ch, "#l(Translucent)#n ", "Pass door / Ethereal", -1 ) );
 		if ( IS_AFFECTED( victim, AFF_FAERIE_FIRE ) )
-			PFX_APPEND( mxp_aura_tag( ch, "#P(Pink Aura)#n ", "Faerie fire", sn_faerie ) );
+			PFX_APPEND( mxp_aura_tag( ch, "#P(Pink Aura)#n ", "Faerie fire", gsn_faerie_fire ) );
 		if ( IS_EVIL( victim ) && IS_AFFECTED( ch, AFF_DETECT_EVIL ) )
 			PFX_APPEND( mxp_aura_tag( ch, "#R(Red Aura)#n ", "Evil alignment", -1 ) );
 		if ( IS_GOOD( victim ) && IS_AFFECTED( ch, AFF_DETECT_EVIL ) )
 			PFX_APPEND( mxp_aura_tag( ch, "#x220(Golden Aura)#n ", "Good alignment", -1 ) );
 		if ( IS_AFFECTED( victim, AFF_SANCTUARY ) )
-			PFX_APPEND( mxp_aura_tag( ch, "#C(White Aura)#n ", "Sanctuary", sn_sanctuary ) );
+			PFX_APPEND( mxp_aura_tag( ch, "#C(White Aura)#n ", "Sanctuary", gsn_sanctuary ) );
 	}
 
 	/* Plane indicators */
@@ -1338,11 +1439,8 @@ void do_look( CHAR_DATA *ch, char *argument ) {
 			send_to_char( "You are standing in complete darkness.\n\r", ch );
 		else if ( ( !IS_NPC( ch ) && !IS_SET( ch->act, PLR_BRIEF ) ) &&
 			( arg1[0] == '\0' || !str_cmp( arg1, "auto" ) ) ) {
-			/* Apply time-of-day color tint to room description */
-			snprintf( buf, sizeof( buf ), "%s%s#n",
-				get_room_tint_color( ch->in_room ),
-				ch->in_room->description ? ch->in_room->description : "" );
-			send_to_char( buf, ch );
+			/* Description with time-of-day color tint, shared by all viewers */
+			send_to_char( room_render_get( ch->in_room, RR_DESC, 0 ), ch );
 			if ( ch->in_room->dynamic && ch->in_room->dynamic->blood > 0 ) {
 				int blood = ch->in_room->dynamic->blood;
 				if ( blood == 1000 )
@@ -1369,36 +1467,8 @@ void do_look( CHAR_DATA *ch, char *argument ) {
 
 		show_list_to_char( &ch->in_room->objects, ch, FALSE, FALSE, TRUE );
 
-		for ( door = 0; door < 6; door++ ) {
-			if ( ch->in_room == NULL ) continue;
-			if ( ch->in_room->exit[door] == NULL ) continue;
-
-			if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_PRISMATIC_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "     You see a shimmering wall of many colours %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			} else if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_ICE_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "     You see a glacier of ice %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			} else if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_CALTROP_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "     You see a wall of caltrops %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			} else if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_FIRE_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "     You see a blazing wall of fire %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			} else if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_SWORD_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "     You see a spinning wall of swords %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			} else if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_MUSHROOM_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "     You see a vibrating mound of mushrooms %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			} else if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_IRON_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "    You see a solid wall of iron %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			} else if ( IS_SET( ch->in_room->exit[door]->exit_info, EX_ASH_WALL ) ) {
-				snprintf( buf, sizeof( buf ), "    You see a deadly wall of ash %s.\n\r", exitname2[door] );
-				send_to_char( buf, ch );
-			}
-		}
+		if ( ch->in_room != NULL )
+			send_to_char( room_render_get( ch->in_room, RR_WALLS, 0 ), ch );
 
 		show_char_to_char( &ch->in_room->characters, ch );
 		if ( str_cmp( arg1, "scry" ) ) aggr_test( ch );
@@ -1701,6 +1771,68 @@ void do_examine( CHAR_DATA *ch, char *argument ) {
 /*
  * Thanks to Zrin for auto-exit part.
  */
+/*
+ * Wall lines for 'look', one per walled exit (RR_WALLS builder)
+ */
+void render_room_walls( ROOM_INDEX_DATA *room, int variant, char *buf, size_t len ) {
+	static const struct {
+		int bit;
+		const char *text;
+	} walls[] = {
+		{ EX_PRISMATIC_WALL, "     You see a shimmering wall of many colours %s.\n\r" },
+		{ EX_ICE_WALL,       "     You see a glacier of ice %s.\n\r" },
+		{ EX_CALTROP_WALL,   "     You see a wall of caltrops %s.\n\r" },
+		{ EX_FIRE_WALL,      "     You see a blazing wall of fire %s.\n\r" },
+		{ EX_SWORD_WALL,     "     You see a spinning wall of swords %s.\n\r" },
+		{ EX_MUSHROOM_WALL,  "     You see a vibrating mound of mushrooms %s.\n\r" },
+		{ EX_IRON_WALL,      "    You see a solid wall of iron %s.\n\r" },
+		{ EX_ASH_WALL,       "    You see a deadly wall of ash %s.\n\r" },
+	};
+	size_t used = 0;
+	size_t i;
+	int door;
+
+	(void) variant;
+	buf[0] = '\0';
+	for ( door = 0; door < 6; door++ ) {
+		if ( room->exit[door] == NULL )
+			continue;
+		for ( i = 0; i < sizeof( walls ) / sizeof( walls[0] ); i++ ) {
+			if ( IS_SET( room->exit[door]->exit_info, walls[i].bit ) ) {
+				snprintf( buf + used, len - used, walls[i].text, exitname2[door] );
+				used += strlen( buf + used );
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * 'exits auto' line without MXP links (RR_EXITS builder).
+ * variant 1 is the plain comma-separated screen reader form.
+ */
+void render_room_exits( ROOM_INDEX_DATA *room, int variant, char *buf, size_t len ) {
+	extern char *const dir_name[];
+	EXIT_DATA *pexit;
+	bool found = FALSE;
+	int door;
+
+	snprintf( buf, len, "%s", variant ? "Exits:" : "#R[#GExits#7:#C" );
+	for ( door = 0; door <= 5; door++ ) {
+		if ( ( pexit = room->exit[door] ) != NULL && pexit->to_room != NULL ) {
+			if ( variant )
+				strncat( buf, found ? ", " : " ", len - strlen( buf ) - 1 );
+			else
+				strncat( buf, " ", len - strlen( buf ) - 1 );
+			strncat( buf, dir_name[door], len - strlen( buf ) - 1 );
+			found = TRUE;
+		}
+	}
+	if ( !found )
+		strncat( buf, " none", len - strlen( buf ) - 1 );
+	strncat( buf, variant ? "\n\r" : "#R]#x\n\r", len - strlen( buf ) - 1 );
+}
+
 void do_exits( CHAR_DATA *ch, char *argument ) {
 	extern char *const dir_name[];
 	char buf[MAX_STRING_LENGTH];
@@ -1717,41 +1849,38 @@ void do_exits( CHAR_DATA *ch, char *argument ) {
 	if ( !check_blind( ch ) )
 		return;
 
+	/* The auto line only depends on the room unless it carries MXP links */
+	if ( fAuto && ( !fMxp || IS_SCREENREADER( ch ) ) ) {
+		send_to_char( room_render_get( ch->in_room, RR_EXITS, IS_SCREENREADER( ch ) ? 1 : 0 ), ch );
+		return;
+	}
+
 	/*
 	 * Screen reader mode: plain comma-separated exit list.
 	 */
 	if ( IS_SCREENREADER( ch ) ) {
-		strcpy( buf, fAuto ? "Exits:" : "Obvious exits:\n\r" );
+		strcpy( buf, "Obvious exits:\n\r" );
 		found = FALSE;
 		for ( door = 0; door <= 5; door++ ) {
 			if ( ( pexit = ch->in_room->exit[door] ) != NULL && pexit->to_room != NULL ) {
-				if ( fAuto ) {
-					strcat( buf, found ? ", " : " " );
-					strcat( buf, dir_name[door] );
-				} else {
-					char exit_line[256];
-					snprintf( exit_line, sizeof( exit_line ), "%s - %s\n\r",
-						capitalize( dir_name[door] ),
-						room_is_dark( pexit->to_room )
-							? "Too dark to tell"
-							: pexit->to_room->name );
-					strcat( buf, exit_line );
-				}
+				char exit_line[256];
+				snprintf( exit_line, sizeof( exit_line ), "%s - %s\n\r",
+					capitalize( dir_name[door] ),
+					room_is_dark( pexit->to_room )
+						? "Too dark to tell"
+						: pexit->to_room->name );
+				strcat( buf, exit_line );
 				found = TRUE;
 			}
 		}
 		if ( !found )
-			strcat( buf, fAuto ? " none" : "None.\n\r" );
-		if ( fAuto )
-			strcat( buf, "\n\r" );
+			strcat( buf, "None.\n\r" );
 		send_to_char( buf, ch );
 		return;
 	}
 
-	if ( fAuto && fMxp )
-		strcpy( buf, MXP_SECURE_LINE "#R[#GExits#7:#C" );
-	else
-		strcpy( buf, fAuto ? "#R[#GExits#7:#C" : "Obvious exits:\n\r" );
+	/* From here the auto line always carries MXP links */
+	strcpy( buf, fAuto ? MXP_SECURE_LINE "#R[#GExits#7:#C" : "Obvious exits:\n\r" );
 
 	found = FALSE;
 	for ( door = 0; door <= 5; door++ ) {
@@ -1761,10 +1890,7 @@ void do_exits( CHAR_DATA *ch, char *argument ) {
 			found = TRUE;
 			if ( fAuto ) {
 				strcat( buf, " " );
-				if ( fMxp )
-					strcat( buf, mxp_exit_link( pexit, door, ch, (char *) dir_name[door] ) );
-				else
-					strcat( buf, dir_name[door] );
+				strcat( buf, mxp_exit_link( pexit, door, ch, (char *) dir_name[door] ) );
 			} else {
 				char exit_line[256];
 				char dir_display[32];
@@ -4214,6 +4340,11 @@ void do_config( CHAR_DATA *ch, char *argument ) {
 				: "[-truecolor] True color (24-bit RGB) mode disabled.\n\r",
 			ch );
 
+		send_to_char( IS_EXTRA( ch, EXTRA_COMBATSUM )
+				? "[+COMBATSUM] Other people's fights are summed up once a round.\n\r"
+				: "[-combatsum] You see every hit in other people's fights.\n\r",
+			ch );
+
 		send_to_char( IS_SET( ch->act, PLR_SCREENREADER )
 				? "[+SCREENRD ] Screen reader accessibility mode on.\n\r"
 				: "[-screenrd ] Screen reader accessibility mode off.\n\r",
@@ -4288,6 +4419,17 @@ void do_config( CHAR_DATA *ch, char *argument ) {
 			}
 			return;
 		}
+		else if ( !str_cmp( arg + 1, "combatsum" ) ) {
+			/* Like truecolor, kept in ch->extra */
+			if ( fSet ) {
+				SET_BIT( ch->extra, EXTRA_COMBATSUM );
+				send_to_char( "Fights you watch are now summed up once a round.\n\r", ch );
+			} else {
+				REMOVE_BIT( ch->extra, EXTRA_COMBATSUM );
+				send_to_char( "You now see every hit of the fights you watch.\n\r", ch );
+			}
+			return;
+		}
 		else {
 			send_to_char( "Config which option?\n\r", ch );
 			return;
@@ -5244,6 +5386,7 @@ void do_prompt( CHAR_DATA *ch, char *argument ) {
 	} else if ( !strcmp( argument, "clear" ) ) {
 		free(ch->pcdata->prompt);
 		ch->pcdata->prompt = str_dup( "" );
+		prompt_recompile( ch );
 		return;
 	} else {
 		if ( strlen( argument ) > 50 )
@@ -5254,6 +5397,7 @@ void do_prompt( CHAR_DATA *ch, char *argument ) {
 
 	free(ch->pcdata->prompt);
 	ch->pcdata->prompt = str_dup( buf );
+	prompt_recompile( ch );
 	send_to_char( "Ok.\n\r", ch );
 	return;
 }
@@ -5273,6 +5417,7 @@ void do_cprompt( CHAR_DATA *ch, char *argument ) {
 	if ( !strcmp( argument, "clear" ) ) {
 		free(ch->pcdata->cprompt);
 		ch->pcdata->cprompt = str_dup( "" );
+		prompt_recompile( ch );
 		return;
 	} else {
 		if ( strlen( argument ) > 50 )
@@ -5283,6 +5428,7 @@ void do_cprompt( CHAR_DATA *ch, char *argument ) {
 
 	free(ch->pcdata->cprompt);
 	ch->pcdata->cprompt = str_dup( buf );
+	prompt_recompile( ch );
 	send_to_char( "Ok.\n\r", ch );
 	return;
 }
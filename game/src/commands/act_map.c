@@ -10,9 +10,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include "merc.h"
+#include "../world/map_layout.h"
 
-/* Maximum map radius (creates 2*radius+1 square grid) */
-#define MAX_MAP_RADIUS 5
+/* Map radius creates a 2*radius+1 square grid (MAX_MAP_RADIUS in map_layout.h) */
 #define MAX_MAP_SIZE   ( MAX_MAP_RADIUS * 2 + 1 )
 
 /* Map cell types */
@@ -21,6 +21,13 @@
 #define MAP_PLAYER	 2
 #define MAP_DEAD_END 3
 
+/* Exit kinds beyond MAP_EXIT_*, overlaid from live exit state */
+#define MAP_EXIT_DOOR 4
+#define MAP_EXIT_WALL 5
+
+#define MAP_WALL_BITS ( EX_ICE_WALL | EX_FIRE_WALL | EX_SWORD_WALL | EX_PRISMATIC_WALL \
+	| EX_IRON_WALL | EX_MUSHROOM_WALL | EX_CALTROP_WALL | EX_ASH_WALL )
+
 /* Direction offsets: N=0, E=1, S=2, W=3, U=4, D=5 */
 static const int dir_x[] = { 0, 1, 0, -1, 0, 0 };
 static const int dir_y[] = { 1, 0, -1, 0, 0, 0 };
@@ -34,7 +41,7 @@ typedef struct map_data {
 	ROOM_INDEX_DATA *rooms[MAX_MAP_SIZE][MAX_MAP_SIZE];
 	bool has_up[MAX_MAP_SIZE][MAX_MAP_SIZE];
 	bool has_down[MAX_MAP_SIZE][MAX_MAP_SIZE];
-	/* Exit info: 0=none, 1=bidirectional, 2=one-way out, 3=warped */
+	/* Exit info: 0=none, 1=bidirectional, 2=one-way out, 3=warped, 4=closed door, 5=wall */
 	int exit_n[MAX_MAP_SIZE][MAX_MAP_SIZE];
 	int exit_e[MAX_MAP_SIZE][MAX_MAP_SIZE];
 	int exit_s[MAX_MAP_SIZE][MAX_MAP_SIZE];
@@ -42,11 +49,105 @@ typedef struct map_data {
 } MAP_DATA;
 
 /* Local function prototypes */
+static void fill_map ( ROOM_INDEX_DATA * start, MAP_DATA *map, int radius );
+static bool fill_map_layout ( ROOM_INDEX_DATA * start, MAP_DATA *map, int radius );
 static void fill_map_bfs ( ROOM_INDEX_DATA * start, MAP_DATA *map,
 	int cx, int cy, int radius );
+static void overlay_map_exits ( MAP_DATA *map, int radius );
 static bool is_exit_one_way ( ROOM_INDEX_DATA * from, int dir );
 static void render_map ( CHAR_DATA * ch, MAP_DATA *map, int radius );
 
+/*
+ * Fill map for a radius-sized window centred on start.  The room graph
+ * comes from the precomputed layout.  Where the window holds a warped
+ * exit, any fixed placement is arbitrary, so the map is drawn by walking
+ * out from the viewer as before; so are rooms the layout has not seen.
+ * Doors and walls go on top either way.
+ */
+static void fill_map( ROOM_INDEX_DATA *start, MAP_DATA *map, int radius ) {
+	memset( map, 0, sizeof( *map ) );
+	if ( !fill_map_layout( start, map, radius ) ) {
+		memset( map, 0, sizeof( *map ) );
+		fill_map_bfs( start, map, radius, radius, radius );
+	}
+	overlay_map_exits( map, radius );
+}
+
+/*
+ * Copy the window around start out of its layout sheet.  FALSE if start
+ * is not laid out or the window is not Euclidean.
+ */
+static bool fill_map_layout( ROOM_INDEX_DATA *start, MAP_DATA *map, int radius ) {
+	MAP_SHEET *sheet;
+	int sx, sy, x, y;
+	int size = radius * 2 + 1;
+
+	if ( !map_layout_find( start, &sheet, &sx, &sy ) )
+		return FALSE;
+
+	for ( x = 0; x < size; x++ ) {
+		for ( y = 0; y < size; y++ ) {
+			ROOM_INDEX_DATA *room = map_sheet_room( sheet, sx - radius + x, sy - radius + y );
+			unsigned short bits;
+
+			if ( room == NULL )
+				continue;
+			bits = map_sheet_cell( sheet, sx - radius + x, sy - radius + y );
+			if ( MAP_CELL_EXIT( bits, DIR_NORTH ) == MAP_EXIT_WARPED
+				|| MAP_CELL_EXIT( bits, DIR_EAST ) == MAP_EXIT_WARPED
+				|| MAP_CELL_EXIT( bits, DIR_SOUTH ) == MAP_EXIT_WARPED
+				|| MAP_CELL_EXIT( bits, DIR_WEST ) == MAP_EXIT_WARPED )
+				return FALSE;
+			map->rooms[x][y] = room;
+			map->cell[x][y] = ( bits & MAP_CELL_DEAD_END ) ? MAP_DEAD_END : MAP_ROOM;
+			map->has_up[x][y] = ( bits & MAP_CELL_UP ) != 0;
+			map->has_down[x][y] = ( bits & MAP_CELL_DOWN ) != 0;
+			map->exit_n[x][y] = MAP_CELL_EXIT( bits, DIR_NORTH );
+			map->exit_e[x][y] = MAP_CELL_EXIT( bits, DIR_EAST );
+			map->exit_s[x][y] = MAP_CELL_EXIT( bits, DIR_SOUTH );
+			map->exit_w[x][y] = MAP_CELL_EXIT( bits, DIR_WEST );
+		}
+	}
+	map->cell[radius][radius] = MAP_PLAYER;
+	return TRUE;
+}
+
+/*
+ * Closed doors and walls change without OLC, so they are read live.
+ */
+static void overlay_map_exits( MAP_DATA *map, int radius ) {
+	int size = radius * 2 + 1;
+	int x, y, dir;
+
+	for ( x = 0; x < size; x++ ) {
+		for ( y = 0; y < size; y++ ) {
+			ROOM_INDEX_DATA *room = map->rooms[x][y];
+
+			if ( room == NULL )
+				continue;
+			for ( dir = 0; dir < 4; dir++ ) {
+				EXIT_DATA *pexit = room->exit[dir];
+				int *kind;
+
+				if ( pexit == NULL || pexit->to_room == NULL )
+					continue;
+				switch ( dir ) {
+				case DIR_NORTH: kind = &map->exit_n[x][y]; break;
+				case DIR_EAST:  kind = &map->exit_e[x][y]; break;
+				case DIR_SOUTH: kind = &map->exit_s[x][y]; break;
+				default:        kind = &map->exit_w[x][y]; break;
+				}
+				if ( *kind == MAP_EXIT_NONE )
+					continue;
+				if ( pexit->exit_info & MAP_WALL_BITS )
+					*kind = MAP_EXIT_WALL;
+				else if ( IS_SET( pexit->exit_info, EX_CLOSED ) )
+					*kind = MAP_EXIT_DOOR;
+			}
+		}
+	}
+}
+
 /*
  * Fill the map using BFS from the starting room.
  */
@@ -259,7 +360,11 @@ static void render_map( CHAR_DATA *ch, MAP_DATA *map, int radius ) {
 				if ( ( cell != MAP_EMPTY && next_cell != MAP_EMPTY ) &&
 					( exit_e > 0 || exit_w_next > 0 ) ) {
 					int type = ( exit_e > exit_w_next ) ? exit_e : exit_w_next;
-					if ( type == 3 )
+					if ( type == MAP_EXIT_WALL )
+						strcat( line, "#Rx#n" ); /* Wall */
+					else if ( type == MAP_EXIT_DOOR )
+						strcat( line, "#y+#n" ); /* Closed door */
+					else if ( type == 3 )
 						strcat( line, "#R~#n" ); /* Warped */
 					else if ( type == 2 )
 						strcat( line, "#Y-#n" ); /* One-way */
@@ -284,7 +389,11 @@ static void render_map( CHAR_DATA *ch, MAP_DATA *map, int radius ) {
 				/* Room position is 3 chars wide, center the vertical connector */
 				if ( exit_s > 0 || exit_n_below > 0 ) {
 					int type = ( exit_s > exit_n_below ) ? exit_s : exit_n_below;
-					if ( type == 3 )
+					if ( type == MAP_EXIT_WALL )
+						strcat( line, " #Rx#n " ); /* Wall - 3 visible chars */
+					else if ( type == MAP_EXIT_DOOR )
+						strcat( line, " #y+#n " ); /* Closed door - 3 visible chars */
+					else if ( type == 3 )
 						strcat( line, " #R~#n " ); /* Warped - 3 visible chars */
 					else if ( type == 2 )
 						strcat( line, " #Yv#n " ); /* One-way - 3 visible chars */
@@ -308,6 +417,7 @@ static void render_map( CHAR_DATA *ch, MAP_DATA *map, int radius ) {
 	send_to_char( "\n\r", ch );
 	send_to_char( "  #wLegend:#n #G[@]#n=You #C[ ]#n=Room #R[!]#n=Dead-end\n\r", ch );
 	send_to_char( "          #w|#n=Exit #Y-v#n=One-way #R~#n=Warped #w^v*#n=Up/Down\n\r", ch );
+	send_to_char( "          #y+#n=Closed door #Rx#n=Wall\n\r", ch );
 }
 
 /*
@@ -317,7 +427,6 @@ static void render_map( CHAR_DATA *ch, MAP_DATA *map, int radius ) {
 void do_map( CHAR_DATA *ch, char *argument ) {
 	MAP_DATA map;
 	int radius = 2; /* Default 5x5 */
-	int center;
 	char arg[MAX_INPUT_LENGTH];
 
 	if ( ch->in_room == NULL ) {
@@ -335,13 +444,8 @@ void do_map( CHAR_DATA *ch, char *argument ) {
 			radius = MAX_MAP_RADIUS;
 	}
 
-	center = radius;
-
-	/* Initialize map data */
-	memset( &map, 0, sizeof( map ) );
-
-	/* Fill the map using BFS */
-	fill_map_bfs( ch->in_room, &map, center, center, radius );
+	/* Fill the map from the layout */
+	fill_map( ch->in_room, &map, radius );
 
 	/* Render and send to character */
 	render_map( ch, &map, radius );
@@ -364,7 +468,6 @@ void do_amap( CHAR_DATA *ch, char *argument ) {
 	char buf[MAX_STRING_LENGTH];
 	char line[MAX_STRING_LENGTH];
 	int radius = 3;
-	int center;
 	int size;
 	int x, y;
 	char arg[MAX_INPUT_LENGTH];
@@ -390,12 +493,10 @@ void do_amap( CHAR_DATA *ch, char *argument ) {
 			radius = MAX_MAP_RADIUS;
 	}
 
-	center = radius;
 	size = radius * 2 + 1;
 
-	/* Initialize and fill map */
-	memset( &map, 0, sizeof( map ) );
-	fill_map_bfs( ch->in_room, &map, center, center, radius );
+	/* Fill map */
+	fill_map( ch->in_room, &map, radius );
 
 	/* Render with VNUMs */
 	send_to_char( "\n\r  #wArea Map (Builder View)#n\n\r\n\r", ch );
@@ -449,121 +550,108 @@ void do_amap( CHAR_DATA *ch, char *argument ) {
 }
 
 /*
- * Show automap with standardized delimiters for client parsing.
- * Called from move_char() when PLR_AUTOMAP is set.
- * Uses fixed radius of 3 (7x7 grid) for consistent output.
+ * Copy s to p, stopping at end; returns the new end of text.
+ */
+static char *map_append( char *p, char *end, const char *s ) {
+	while ( *s != '\0' && p < end )
+		*p++ = *s++;
+	return p;
+}
+
+/*
+ * Render the automap block for room into buf, with standardized
+ * delimiters for client parsing.
  *
  * Output format (for client regex parsing):
  *   [AUTOMAP vnum=12345 area="Area Name"]
  *   ... map content ...
  *   [/AUTOMAP]
  */
-void show_automap( CHAR_DATA *ch ) {
+void render_automap( ROOM_INDEX_DATA *room, int radius, char *buf, size_t len ) {
+	/* Indexed by up | down << 1, and by exit kind */
+	static const char *const room_sym[] = { "#C[ ]#n", "#C[^]#n", "#C[v]#n", "#C[*]#n" };
+	static const char *const h_link[] = { " ", "#w-#n", "#Y-#n", "#R~#n", "#y+#n", "#Rx#n" };
+	static const char *const v_link[] = { "   ", " #w|#n ", " #Yv#n ", " #R~#n ", " #y+#n ", " #Rx#n " };
 	MAP_DATA map;
-	char buf[MAX_STRING_LENGTH];
-	char line[MAX_STRING_LENGTH];
-	int radius = 3; /* Fixed 7x7 grid */
-	int center = radius;
-	int size = radius * 2 + 1;
+	char *p, *end;
+	int size;
 	int x, y;
 
-	if ( ch == NULL || ch->in_room == NULL )
-		return;
-
-	if ( IS_NPC( ch ) )
+	buf[0] = '\0';
+	if ( room == NULL || len == 0 )
 		return;
+	if ( radius < 1 )
+		radius = 1;
+	if ( radius > MAX_MAP_RADIUS )
+		radius = MAX_MAP_RADIUS;
+	size = radius * 2 + 1;
 
-	/* Initialize and fill map */
-	memset( &map, 0, sizeof( map ) );
-	fill_map_bfs( ch->in_room, &map, center, center, radius );
+	/* Fill map */
+	fill_map( room, &map, radius );
 
 	/* Start delimiter with room info for client parsing */
-	snprintf( buf, sizeof( buf ), "[AUTOMAP vnum=%d area=\"%s\"]\n\r",
-		ch->in_room->vnum,
-		ch->in_room->area ? ch->in_room->area->name : "Unknown" );
-	send_to_char( buf, ch );
+	snprintf( buf, len, "[AUTOMAP vnum=%d area=\"%s\"]\n\r",
+		room->vnum,
+		room->area ? room->area->name : "Unknown" );
+	p = buf + strlen( buf );
+	end = buf + len - 1;
 
 	/* Draw from top (north) to bottom (south) */
 	for ( y = size - 1; y >= 0; y-- ) {
 		/* Room row with horizontal exits */
-		strcpy( line, "" );
 		for ( x = 0; x < size; x++ ) {
 			int cell = map.cell[x][y];
-			bool up = map.has_up[x][y];
-			bool down = map.has_down[x][y];
-			int exit_e = map.exit_e[x][y];
-			int exit_w_next = ( x + 1 < size ) ? map.exit_w[x + 1][y] : 0;
-
-			if ( cell == MAP_EMPTY ) {
-				strcat( line, "   " );
-			} else {
-				char room_str[32];
 
-				if ( cell == MAP_PLAYER )
-					snprintf( room_str, sizeof( room_str ), "#G[@]#n" );
-				else if ( cell == MAP_DEAD_END )
-					snprintf( room_str, sizeof( room_str ), "#R[!]#n" );
-				else {
-					char ud_char = ' ';
-					if ( up && down )
-						ud_char = '*';
-					else if ( up )
-						ud_char = '^';
-					else if ( down )
-						ud_char = 'v';
-					snprintf( room_str, sizeof( room_str ), "#C[%c]#n", ud_char );
-				}
-
-				strcat( line, room_str );
-			}
+			if ( cell == MAP_EMPTY )
+				p = map_append( p, end, "   " );
+			else if ( cell == MAP_PLAYER )
+				p = map_append( p, end, "#G[@]#n" );
+			else if ( cell == MAP_DEAD_END )
+				p = map_append( p, end, "#R[!]#n" );
+			else
+				p = map_append( p, end, room_sym[map.has_up[x][y] | map.has_down[x][y] << 1] );
 
 			/* Horizontal exit connector */
 			if ( x < size - 1 ) {
-				int next_cell = map.cell[x + 1][y];
-				if ( ( cell != MAP_EMPTY && next_cell != MAP_EMPTY ) &&
-					( exit_e > 0 || exit_w_next > 0 ) ) {
-					int type = ( exit_e > exit_w_next ) ? exit_e : exit_w_next;
-					if ( type == 3 )
-						strcat( line, "#R~#n" );
-					else if ( type == 2 )
-						strcat( line, "#Y-#n" );
-					else
-						strcat( line, "#w-#n" );
-				} else {
-					strcat( line, " " );
-				}
+				int type = 0;
+
+				if ( cell != MAP_EMPTY && map.cell[x + 1][y] != MAP_EMPTY )
+					type = UMAX( map.exit_e[x][y], map.exit_w[x + 1][y] );
+				p = map_append( p, end, h_link[type] );
 			}
 		}
-		snprintf( buf, sizeof( buf ), "%s\n\r", line );
-		send_to_char( buf, ch );
+		p = map_append( p, end, "\n\r" );
 
 		/* Vertical exit line between rows */
 		if ( y > 0 ) {
-			strcpy( line, "" );
 			for ( x = 0; x < size; x++ ) {
-				int exit_s = map.exit_s[x][y];
-				int exit_n_below = map.exit_n[x][y - 1];
-
-				if ( exit_s > 0 || exit_n_below > 0 ) {
-					int type = ( exit_s > exit_n_below ) ? exit_s : exit_n_below;
-					if ( type == 3 )
-						strcat( line, " #R~#n " );
-					else if ( type == 2 )
-						strcat( line, " #Yv#n " );
-					else
-						strcat( line, " #w|#n " );
-				} else {
-					strcat( line, "   " );
-				}
-
+				p = map_append( p, end, v_link[UMAX( map.exit_s[x][y], map.exit_n[x][y - 1] )] );
 				if ( x < size - 1 )
-					strcat( line, " " );
+					p = map_append( p, end, " " );
 			}
-			snprintf( buf, sizeof( buf ), "%s\n\r", line );
-			send_to_char( buf, ch );
+			p = map_append( p, end, "\n\r" );
 		}
 	}
 
 	/* End delimiter */
-	send_to_char( "[/AUTOMAP]\n\r", ch );
+	p = map_append( p, end, "[/AUTOMAP]\n\r" );
+	*p = '\0';
+}
+
+/*
+ * Show automap before the room description.
+ * Called from move_char() when PLR_AUTOMAP is set.
+ * Uses fixed radius of 3 (7x7 grid) for consistent output.
+ */
+void show_automap( CHAR_DATA *ch ) {
+	char buf[MAX_STRING_LENGTH * 2];
+
+	if ( ch == NULL || ch->in_room == NULL )
+		return;
+
+	if ( IS_NPC( ch ) )
+		return;
+
+	render_automap( ch->in_room, 3, buf, sizeof( buf ) );
+	send_to_char( buf, ch );
 }
@@ -21,10 +21,12 @@
 #include <string.h>
 #include <time.h>
 #include "merc.h"
+#include "../core/cfg.h"
 #include "../systems/gmcp.h"
 #include "../systems/mcmp.h"
 #include "../systems/quest_new.h"
 #include "../db/db_quest.h"
+#include "../world/pathfind.h"
 #include "../classes/artificer.h"
 #include "../script/script.h"
 
@@ -459,9 +461,9 @@ void move_char( CHAR_DATA *ch, int door ) {
 	if ( !IS_NPC( ch ) ) {
 		char vnum_str[20];
 		snprintf( vnum_str, sizeof( vnum_str ), "%d", to_room->vnum );
-		quest_check_progress( ch, QOBJ_VISIT_ROOM, vnum_str, 1 );
+		quest_check_progress( ch, QOT_VISIT_ROOM, vnum_str, 1 );
 		if ( in_room->area != to_room->area )
-			quest_check_progress( ch, QOBJ_VISIT_AREA, to_room->area->name, 1 );
+			quest_check_progress( ch, QOT_VISIT_AREA, to_room->area->name, 1 );
 	}
 
 	/* Send GMCP Room.Info */
@@ -4106,6 +4108,50 @@ void check_hunt( CHAR_DATA *ch ) {
 	return;
 }
 
+/*
+ * NPC movement with a destination: chase ch->hunting anywhere in the
+ * world, or walk a stay-area mob that was pushed out back to the room it
+ * reset in.  TRUE if it moved or is still on its way.
+ */
+bool mob_path_step( CHAR_DATA *ch ) {
+	ROOM_INDEX_DATA *in_room = ch->in_room;
+	ROOM_INDEX_DATA *target;
+	CHAR_DATA *victim;
+	int flags = PATH_OPEN_ONLY | PATH_NO_MOB;
+	int dir;
+
+	if ( !IS_NPC( ch ) || in_room == NULL || ch->fighting != NULL )
+		return FALSE;
+
+	if ( ch->hunting != NULL && strlen( ch->hunting ) > 1 ) {
+		if ( ( victim = get_char_world( ch, ch->hunting ) ) == NULL || victim->in_room == NULL
+			|| victim->in_room == in_room ) {
+			free( ch->hunting );
+			ch->hunting = str_dup( "" );
+			return FALSE;
+		}
+		if ( IS_SET( ch->act, ACT_STAY_AREA ) )
+			flags |= PATH_STAY_AREA;
+		dir = path_next_dir( in_room, victim->in_room, flags, cfg( CFG_WORLD_PATH_MAX_DEPTH ) );
+		if ( dir < 0 ) {
+			free( ch->hunting );
+			ch->hunting = str_dup( "" );
+			return FALSE;
+		}
+		move_char( ch, dir );
+		return TRUE;
+	}
+
+	if ( !IS_SET( ch->act, ACT_STAY_AREA ) || IS_SET( ch->act, ACT_SENTINEL ) || ch->master != NULL
+		|| ch->home == 0 || ( target = get_room_index( ch->home ) ) == NULL
+		|| target->area == in_room->area )
+		return FALSE;
+	if ( ( dir = path_next_dir( in_room, target, flags, cfg( CFG_WORLD_PATH_MAX_DEPTH ) ) ) < 0 )
+		return FALSE;
+	move_char( ch, dir );
+	return TRUE;
+}
+
 void add_tracks( CHAR_DATA *ch, int direction ) {
 	ROOM_DYNAMIC_DATA *dyn;
 	int loop;
@@ -27,6 +27,10 @@
 #include "../systems/charset.h"
 #include "../db/db_game.h"
 #include "../db/db_player.h"
+#include "../world/help_index.h"
+#include "../core/input.h"
+#include "../systems/textfilter.h"
+#include "../systems/capture.h"
 #if !defined( WIN32 )
 #include <unistd.h>
 #include <fcntl.h> /* fcntl, F_SETFL, FNDELAY */
@@ -4003,6 +4007,7 @@ void do_hreload( CHAR_DATA *ch, char *argument ) {
 		if ( is_name( arg, h->keyword ) ) {
 			snprintf( keyword_saved, sizeof( keyword_saved ), "%s", h->keyword );
 			list_remove( &g_helps, &h->node );
+			help_index_invalidate();
 			free(h->keyword);
 			free(h->text);
 			free( h );
@@ -4306,6 +4311,7 @@ void do_copyover( CHAR_DATA *ch, char *argument ) {
 
 	/* Wait for all background saves to complete before exec */
 	db_player_wait_pending();
+	db_game_flush();
 
 	fprintf( fp, "-1\n" );
 	fclose( fp );
@@ -4325,6 +4331,10 @@ void do_copyover( CHAR_DATA *ch, char *argument ) {
 
 	/* recycle descriptors */
 	recycle_descriptors();
+	capture_stop();
+
+	/* Leave unread input in the sockets for the new process */
+	input_stop();
 
 	/* exec - descriptors are inherited (on Unix) */
 
@@ -4392,6 +4402,7 @@ void do_copyover( CHAR_DATA *ch, char *argument ) {
 
 	perror( "do_copyover: execl" );
 	send_to_char( "Copyover FAILED!\n\r", ch );
+	input_start();
 
 	/* Here you might want to reopen fpReserve */
 #endif
@@ -4496,6 +4507,7 @@ void copyover_recover() {
 			close( desc ); /* nope */
 #endif
 			/* Clean up the descriptor we just allocated */
+			input_close( d->input );
 			free( d->outbuf );
 			continue;
 		}
@@ -4920,6 +4932,7 @@ void do_nameban( CHAR_DATA *ch, char *argument ) {
 			pf->added_by = str_dup( ch->name );
 			list_push_front( &profanity_filter_list, &pf->node );
 
+			textfilter_rebuild();
 			db_game_save_profanity_filters();
 
 			snprintf( buf, sizeof( buf ),
@@ -4956,6 +4969,7 @@ void do_nameban( CHAR_DATA *ch, char *argument ) {
 			fn->added_by = str_dup( ch->name );
 			list_push_front( &forbidden_name_list, &fn->node );
 
+			textfilter_rebuild();
 			db_game_save_forbidden_names();
 
 			snprintf( buf, sizeof( buf ),
@@ -4982,6 +4996,7 @@ void do_nameban( CHAR_DATA *ch, char *argument ) {
 					free(pf->added_by);
 					free( pf );
 
+					textfilter_rebuild();
 					db_game_save_profanity_filters();
 
 					snprintf( buf, sizeof( buf ),
@@ -5016,6 +5031,7 @@ void do_nameban( CHAR_DATA *ch, char *argument ) {
 					free(fn->added_by);
 					free( fn );
 
+					textfilter_rebuild();
 					db_game_save_forbidden_names();
 
 					snprintf( buf, sizeof( buf ),
@@ -34,8 +34,8 @@ static void forge_extract_and_notify( CHAR_DATA *ch, OBJ_DATA *mat ) {
 	else
 		cat = "metal";
 	extract_obj( mat );
-	quest_check_progress( ch, QOBJ_FORGE_ITEM, cat, 1 );
-	quest_check_progress( ch, QOBJ_FORGE_ITEM, "any", 1 );
+	quest_check_progress( ch, QOT_FORGE_ITEM, cat, 1 );
+	quest_check_progress( ch, QOT_FORGE_ITEM, "any", 1 );
 }
 
 void do_forge( CHAR_DATA *ch, char *argument ) {
@@ -1387,7 +1387,7 @@ void do_questcreate( CHAR_DATA *ch, char *argument ) {
 		obj->questowner = str_dup( ch->pcdata->switchname );
 		act( "You reach up into the air and draw out a ball of protoplasm.", ch, obj, NULL, TO_CHAR );
 		act( "$n reaches up into the air and draws out a ball of protoplasm.", ch, obj, NULL, TO_ROOM );
-		quest_check_progress( ch, QOBJ_QUEST_CREATE, "any", 1 );
+		quest_check_progress( ch, QOT_QUEST_CREATE, "any", 1 );
 		return;
 	}
 	if ( arg1[0] == '\0' || arg2[0] == '\0' ) {
@@ -1465,7 +1465,7 @@ void do_questcreate( CHAR_DATA *ch, char *argument ) {
 		ch->pcdata->quest -= value;
 		if ( obj->questmaker != NULL ) free(obj->questmaker);
 		obj->questmaker = str_dup( ch->pcdata->switchname );
-		quest_check_progress( ch, QOBJ_QUEST_MODIFY, "any", 1 );
+		quest_check_progress( ch, QOT_QUEST_MODIFY, "any", 1 );
 		return;
 	}
 	if ( !str_cmp( arg2, "min" ) ) {
@@ -1494,7 +1494,7 @@ void do_questcreate( CHAR_DATA *ch, char *argument ) {
 		ch->pcdata->quest -= value;
 		if ( obj->questmaker != NULL ) free(obj->questmaker);
 		obj->questmaker = str_dup( ch->pcdata->switchname );
-		quest_check_progress( ch, QOBJ_QUEST_MODIFY, "any", 1 );
+		quest_check_progress( ch, QOT_QUEST_MODIFY, "any", 1 );
 		return;
 	}
 	if ( !str_cmp( arg2, "max" ) ) {
@@ -1523,7 +1523,7 @@ void do_questcreate( CHAR_DATA *ch, char *argument ) {
 		ch->pcdata->quest -= value;
 		if ( obj->questmaker != NULL ) free(obj->questmaker);
 		obj->questmaker = str_dup( ch->pcdata->switchname );
-		quest_check_progress( ch, QOBJ_QUEST_MODIFY, "any", 1 );
+		quest_check_progress( ch, QOT_QUEST_MODIFY, "any", 1 );
 		return;
 	}
 	if ( !str_cmp( arg2, "weapon" ) ) {
@@ -3757,7 +3757,7 @@ void oset_affect( CHAR_DATA *ch, OBJ_DATA *obj, int value, int affect, bool is_q
 	send_to_char("Ok.\n\r",ch);
 
 */
-	quest_check_progress( ch, QOBJ_QUEST_MODIFY, "any", 1 );
+	quest_check_progress( ch, QOT_QUEST_MODIFY, "any", 1 );
 	return;
 }
 
@@ -184,6 +184,8 @@
     \
     /* =========== WORLD =========== */ \
     CFG_X(WORLD_TIME_SCALE                                       , "world.time_scale",          5) \
+    CFG_X(WORLD_RESET_ROOMS_PER_PULSE                            , "world.reset_rooms_per_pulse",        100) \
+    CFG_X(WORLD_PATH_MAX_DEPTH                                   , "world.path_max_depth",               100) \
     \
     /* =========== ABILITY - ANGEL =========== */ \
     CFG_X(ABILITY_ANGEL_ANGELICARMOR_PRACTICE_COST               , "ability.angel.angelicarmor.practice_cost",        150) \
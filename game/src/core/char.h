@@ -769,7 +769,7 @@ struct kill_data {
 /*
  * EXTRA bits for players. (KaVir)
  */
-/*    1 */
+#define EXTRA_COMBATSUM	   1 /* Onlooker sees one line per fight a round */
 /*    2 */
 #define EXTRA_TRUSTED	   4
 #define EXTRA_NEWPASS	   8
@@ -873,7 +873,7 @@ struct kill_data {
 struct mob_index_data {
 	MOB_INDEX_DATA *next;
 	list_head_t scripts;      /* Lua scripts attached to this mob template */
-	bool has_tick_scripts;    /* TRUE if any script has TRIG_TICK */
+	uint32_t script_trigs;    /* OR of all scripts' TRIG_* bits */
 	SHOP_DATA *pShop;
 	CHAR_DATA *mount;
 	CHAR_DATA *wizard;
@@ -898,6 +898,7 @@ struct mob_index_data {
 	int loc_hp[7];
 	int vnum;
 	int count;
+	list_head_t instances;    /* Live NPCs of this template, via proto_node */
 	int killed;
 	int sex;
 	int mounted;
@@ -941,6 +942,8 @@ struct char_data {
 	list_node_t npc_node; /* g_npcs list (NPCs only, unlinked for PCs) */
 	list_node_t room_node;
 	list_node_t extracted_node; /* node for g_extracted list (separate from char_node) */
+	list_node_t script_node;    /* room script_mobs list (scripted NPCs only) */
+	list_node_t proto_node;     /* pIndexData->instances (NPCs only) */
 	bool            extracted;  /* deferred free: TRUE after extract_char(ch, TRUE) */
 	CHAR_DATA *master;
 	CHAR_DATA *leader;
@@ -1052,6 +1055,7 @@ struct pc_data {
 	OBJ_DATA *memorised;
 	BOARD_DATA *board;			 /* The current board */
 	time_t last_note[MAX_BOARD]; /* last note for the boards */
+	NOTE_CURSOR note_cursor[MAX_BOARD]; /* unread counts, see unread_notes() */
 	NOTE_DATA *in_progress;
 	list_head_t aliases;
 	char *last_decap[2];
@@ -1159,6 +1163,8 @@ struct pc_data {
 	char *powertype;
 	char *prompt;
 	char *cprompt;
+	PROMPT_PROG *prompt_prog;  /* prompt and cprompt compiled, see prompt.h */
+	PROMPT_PROG *cprompt_prog;
 	char *objdesc;
 	/* Player-only int/ptr fields (moved from CHAR_DATA to save NPC memory) */
 	CHAR_DATA *reply;
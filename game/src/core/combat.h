@@ -5,6 +5,7 @@
 /* Extracted from merc.h — Phase 3 struct decomposition */
 
 #include "types.h"
+#include "skill_names.h"
 
 /*
  * Damcap values.
@@ -161,7 +162,6 @@ extern int gsn_peek;
 extern int gsn_pick_lock;
 extern int gsn_sneak;
 extern int gsn_steal;
-extern int gsn_godbless;	  /* Vic - Monks */
 extern int gsn_totalblind; /* Vic - Monks */
 extern int gsn_tendrils;
 extern int gsn_berserk;
@@ -200,7 +200,6 @@ extern int gsn_rescue;
 extern int gsn_track;
 extern int gsn_polymorph;
 extern int gsn_web;
-extern int gsn_infirmity;
 extern int gsn_drowfire;
 extern int gsn_blindness;
 extern int gsn_charm_person;
@@ -213,6 +212,11 @@ extern int gsn_paradox;
 extern int gsn_spew;
 extern int gsn_darkness;
 extern int gsn_multiplearms;
+
+/* Handles for skills named in code, resolved at boot (skill_names.h) */
+#define SKILL_X( gsn, name ) extern int gsn;
+SKILL_NAME_ENTRIES
+#undef SKILL_X
 /*
  * Spell functions.
  * Defined in magic.c.
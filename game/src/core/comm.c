@@ -54,10 +54,13 @@
 #include "merc.h"
 #include "utf8.h"
 #include "intro.h"
+#include "input.h"
 #include "../systems/ttype.h"
 #include "../systems/charset.h"
 #include "../db/db_game.h"
 #include "../systems/profile.h"
+#include "../systems/mcmp.h"
+#include "../systems/capture.h"
 #if !defined( WIN32 )
 #include "../systems/deploybot.h"
 #endif
@@ -235,7 +238,6 @@ const char *col_scale_code_tc( int current, int max, CHAR_DATA *ch ) {
 void game_loop ( int control );
 int init_socket ( int port );
 void new_descriptor ( int control );
-bool read_from_descriptor ( DESCRIPTOR_DATA * d );
 bool write_to_descriptor ( DESCRIPTOR_DATA * d, char *txt, int length );
 bool write_to_descriptor_2 ( int desc, char *txt, int length );
 
@@ -250,7 +252,7 @@ int main ( int argc, char **argv );
 #endif
 void nanny ( DESCRIPTOR_DATA * d, char *argument );
 bool process_output ( DESCRIPTOR_DATA * d, bool fPrompt );
-void read_from_buffer ( DESCRIPTOR_DATA * d );
+bool read_from_buffer ( DESCRIPTOR_DATA * d, bool want_line );
 void stop_idling ( CHAR_DATA * ch );
 void bust_a_prompt ( DESCRIPTOR_DATA * d );
 void bust_a_header ( DESCRIPTOR_DATA * d );
@@ -536,7 +538,11 @@ int main( int argc, char **argv ) {
 	arena = FIGHT_OPEN;
 	snprintf( log_buf, MAX_STRING_LENGTH, "%s is ready to rock on port %d.", game_config.game_name, port );
 	log_string( log_buf );
+	input_start();
 	game_loop( control );
+	input_stop();
+	capture_stop();
+	db_game_close_writer();  /* Commit queued game.db writes */
 #if !defined( WIN32 )
 	close( control );
 #else
@@ -661,6 +667,7 @@ void game_tick( void ) {
 #endif
 	free_extracted_chars();
 	log_flush();
+	capture_pulse();
 }
 
 void game_loop( int control ) {
@@ -686,7 +693,7 @@ void game_loop( int control ) {
 			abort();
 #endif
 
-		PROFILE_START("game_loop_work");
+		PROFILE_START( PROF_GAME_LOOP_WORK );
 
 		/*
 		 * Poll all active descriptors.
@@ -701,7 +708,9 @@ void game_loop( int control ) {
 		*/
 		LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node ) {
 			maxdesc = UMAX( maxdesc, d->descriptor );
-			FD_SET( d->descriptor, &in_set );
+			/* The I/O thread reads client sockets (input.c) */
+			if ( !input_threaded() )
+				FD_SET( d->descriptor, &in_set );
 			FD_SET( d->descriptor, &out_set );
 			FD_SET( d->descriptor, &exc_set );
 		}
@@ -737,17 +746,18 @@ void game_loop( int control ) {
 		LIST_FOR_EACH_SAFE( d, d_tmp, &g_descriptors, DESCRIPTOR_DATA, node ) {
 			d->fcommand = FALSE;
 
-			if ( FD_ISSET( d->descriptor, &in_set ) ) {
+			if ( !input_threaded() && FD_ISSET( d->descriptor, &in_set ) )
+				input_pump( d->input );
+
+			/* Capability detection holds player input; it stays queued. */
+			if ( !read_from_buffer( d, d->connected != CON_DETECT_CAPS
+					&& ( d->character == NULL || d->character->wait <= 0 ) ) ) {
+				FD_CLR( d->descriptor, &out_set );
 				if ( d->character != NULL )
-					d->character->timer = 0;
-				if ( !read_from_descriptor( d ) ) {
-					FD_CLR( d->descriptor, &out_set );
-					if ( d->character != NULL )
-						save_char_obj( d->character );
-					d->outtop = 0;
-					close_socket( d );
-					continue;
-				}
+					save_char_obj( d->character );
+				d->outtop = 0;
+				close_socket( d );
+				continue;
 			}
 
 			if ( d->character != NULL && d->character->wait > 0 ) {
@@ -755,11 +765,8 @@ void game_loop( int control ) {
 				continue;
 			}
 
-			read_from_buffer( d );
-
 			/* Capability detection: tick the intro timer each pulse.
-			 * Telnet responses are parsed by read_from_buffer() above.
-			 * Don't process player input during detection — it stays buffered. */
+			 * Telnet responses were handled by read_from_buffer() above. */
 			if ( d->connected == CON_DETECT_CAPS ) {
 				intro_check_ready( d );
 				continue;
@@ -780,8 +787,10 @@ void game_loop( int control ) {
 						nanny( d, d->incomm );
 						break;
 					case CON_PLAYING:
-						if ( !run_olc_editor( d ) )
+						if ( !run_olc_editor( d ) ) {
+							capture_expect( d );
 							interpret( d->character, d->incomm );
+						}
 						break;
 					case CON_EDITING:
 						edit_buffer( d->character, d->incomm );
@@ -820,8 +829,11 @@ void game_loop( int control ) {
 						save_char_obj( d->character );
 					d->outtop = 0;
 					close_socket( d );
+					continue;
 				}
 			}
+			/* This pulse's sounds, behind the text that caused them */
+			mcmp_flush( d );
 		}
 
 		/*
@@ -829,7 +841,7 @@ void game_loop( int control ) {
 		 */
 		recycle_dns_lookups();
 
-		PROFILE_END("game_loop_work");
+		PROFILE_END( PROF_GAME_LOOP_WORK );
 
 		/*
 		 * Synchronize to a clock.
@@ -921,7 +933,6 @@ void init_descriptor( DESCRIPTOR_DATA *dnew, int desc ) {
 	dnew->client_width = NAWS_DEFAULT_WIDTH;
 	dnew->client_height = NAWS_DEFAULT_HEIGHT;
 	/* TTYPE/MTTS defaults */
-	dnew->inbuf_len         = 0;
 	dnew->ttype_enabled     = FALSE;
 	dnew->ttype_round       = 0;
 	dnew->mtts_flags        = 0;
@@ -930,6 +941,8 @@ void init_descriptor( DESCRIPTOR_DATA *dnew, int desc ) {
 	/* CHARSET defaults */
 	dnew->client_charset    = CHARSET_UNKNOWN;
 	dnew->charset_negotiated = FALSE;
+	dnew->input = input_open( desc );
+	if ( !dnew->input ) { bug( "new_descriptor: input_open failed", 0 ); exit( 1 ); }
 }
 
 void new_descriptor( int control ) {
@@ -1111,6 +1124,7 @@ void close_socket( DESCRIPTOR_DATA *dclose ) {
 
 	if ( dclose->lookup_status > STATUS_DONE ) return;
 	dclose->lookup_status += 2;
+	capture_close( dclose );
 
 	if ( dclose->outtop > 0 ) process_output( dclose, FALSE );
 	if ( dclose->snoop_by != NULL )
@@ -1158,6 +1172,7 @@ void close_socket2( DESCRIPTOR_DATA *dclose, bool kickoff ) {
 
 	if ( dclose->lookup_status > STATUS_DONE ) return;
 	dclose->lookup_status += 2;
+	capture_close( dclose );
 
 	if ( dclose->outtop > 0 ) process_output( dclose, FALSE );
 	if ( dclose->snoop_by != NULL )
@@ -1192,468 +1207,113 @@ void close_socket2( DESCRIPTOR_DATA *dclose, bool kickoff ) {
 	return;
 }
 
-bool read_from_descriptor( DESCRIPTOR_DATA *d ) {
-	int iStart;
-
-	/* Hold horses if pending command already. */
-	if ( d->incomm[0] != '\0' )
-		return TRUE;
-
-	/* one dirty patch to avoid spams of EOF's */
-	if ( d->connected == CON_NOT_PLAYING )
-		return TRUE;
-
-	/* Check for overflow. */
-	iStart = d->inbuf_len;
-	if ( iStart >= (int) sizeof( d->inbuf ) - 10 ) {
-		if ( d != NULL && d->character != NULL ) {
-			snprintf( log_buf, MAX_STRING_LENGTH, "%s input overflow!", mask_ip( d->character->pcdata->lasthost ) );
-			log_string( log_buf );
-		} else if ( d->lookup_status != STATUS_LOOKUP ) {
-			snprintf( log_buf, MAX_STRING_LENGTH, "%s input overflow!", mask_ip( d->host ) );
-			log_string( log_buf );
-		}
-		write_to_descriptor( d,
-			"\n\r*** PUT A LID ON IT!!! ***\n\r", 0 );
-		return FALSE;
-	}
-
-	/* Snarf input. */
-	for ( ;; ) {
-		int nRead;
-
-#if !defined( WIN32 )
-		nRead = read( d->descriptor, d->inbuf + iStart,
-			sizeof( d->inbuf ) - 10 - iStart );
-#else
-		nRead = recv( d->descriptor, d->inbuf + iStart,
-			sizeof( d->inbuf ) - 10 - iStart, 0 );
-#endif
-		if ( nRead > 0 ) {
-			iStart += nRead;
-			if ( d->inbuf[iStart - 1] == '\n' || d->inbuf[iStart - 1] == '\r' )
-				break;
-		} else if ( nRead == 0 ) {
-			log_string( "EOF encountered on read." );
-			return FALSE;
-		}
-#if !defined( WIN32 )
-		else if ( errno == EWOULDBLOCK )
-			break;
-#else
-		else if ( WSAGetLastError() == WSAEWOULDBLOCK || errno == EAGAIN )
-			break;
-#endif
-		else {
-#if !defined( WIN32 )
-			perror( "Read_from_descriptor" );
-#else
-			snprintf( log_buf, MAX_STRING_LENGTH, "Read_from_descriptor: recv error %d on fd %d.",
-				WSAGetLastError(), d->descriptor );
-			log_string( log_buf );
-#endif
-			return FALSE;
-		}
+/*
+ * WILL/WONT/DO/DONT from the client.
+ */
+static void telnet_option( DESCRIPTOR_DATA *d, int cmd, int opt ) {
+	switch ( opt ) {
+	case TELOPT_COMPRESS2:
+		if ( cmd == DO )
+			compressStart( d, 2 );
+		else if ( cmd == DONT && d->mccp_version == 2 )
+			compressEnd( d );
+		break;
+	case TELOPT_COMPRESS:
+		if ( cmd == DO )
+			compressStart( d, 1 );
+		else if ( cmd == DONT && d->mccp_version == 1 )
+			compressEnd( d );
+		break;
+	case TELOPT_MSSP:
+		if ( cmd == DO )
+			mssp_send( d );
+		break;
+	case TELOPT_GMCP:
+		if ( cmd == DO )
+			gmcp_init( d );
+		else if ( cmd == DONT )
+			d->gmcp_enabled = FALSE;
+		break;
+	case TELOPT_MXP:
+		if ( cmd == DO )
+			mxpStart( d );
+		else if ( cmd == DONT )
+			mxpEnd( d );
+		break;
+	case TELOPT_NAWS:
+		/* WILL: the size follows as a subnegotiation */
+		if ( cmd == WONT )
+			d->naws_enabled = FALSE;
+		break;
+	case TELOPT_TTYPE:
+		if ( cmd == WILL ) {
+			d->ttype_enabled = TRUE;
+			ttype_request( d ); /* Send first TTYPE SEND */
+		} else if ( cmd == WONT )
+			d->ttype_enabled = FALSE;
+		break;
+	case TELOPT_CHARSET:
+		/* DONT just means the client won't negotiate CHARSET, not that it
+		 * is ASCII-only; charset_finalize() falls back to MTTS or UTF-8. */
+		if ( cmd == DO )
+			charset_send_request( d );
+		break;
+	default:
+		break;
 	}
-
-	d->inbuf[iStart] = '\0';
-	d->inbuf_len = iStart;
-	return TRUE;
 }
 
 /*
- * Transfer one line from input buffer to input line.
+ * IAC SB opt <data> IAC SE from the client.  data is still IAC-escaped and
+ * may hold NUL bytes (TTYPE IS, NAWS high bytes), so handlers take a length.
  */
-void read_from_buffer( DESCRIPTOR_DATA *d ) {
-	int i, k;
-	bool has_newline = FALSE;
-
-	/*
-	 * Hold horses if pending command already.
-	 */
-	if ( d->incomm[0] != '\0' )
-		return;
-
-	/*
-	 * Look for at least one new line, but still process telnet sequences.
-	 * Use inbuf_len (not NUL) because TTYPE subneg contains embedded NUL bytes.
-	 */
-	for ( i = 0; i < d->inbuf_len; i++ ) {
-		if ( d->inbuf[i] == '\n' || d->inbuf[i] == '\r' ) {
-			has_newline = TRUE;
-			break;
-		}
+static void telnet_subneg( DESCRIPTOR_DATA *d, int opt, unsigned char *data, int len ) {
+	switch ( opt ) {
+	case TELOPT_GMCP:
+		if ( len > 0 )
+			gmcp_handle_subnegotiation( d, data, len );
+		break;
+	case TELOPT_NAWS:
+		/* 4 data bytes, up to 8 with IAC escaping */
+		if ( len >= 4 && len <= 8 )
+			naws_handle_subnegotiation( d, data, len );
+		break;
+	case TELOPT_TTYPE:
+		if ( len > 0 )
+			ttype_handle_subnegotiation( d, data, len );
+		break;
+	case TELOPT_CHARSET:
+		if ( len > 0 )
+			charset_handle_subnegotiation( d, data, len );
+		break;
+	default:
+		break;
 	}
+}
 
-	/* Process telnet sequences even without newline */
-	if ( !has_newline ) {
-		/* Scan for and handle IAC sequences */
-		for ( i = 0; i < d->inbuf_len; i++ ) {
-			if ( d->inbuf[i] == (signed char) IAC ) {
-				/* MCCP v2 (preferred) */
-				if ( !memcmp( &d->inbuf[i], compress2_do, strlen( compress2_do ) ) ) {
-					i += (int) strlen( compress2_do ) - 1;
-					compressStart( d, 2 );
-				} else if ( !memcmp( &d->inbuf[i], compress2_dont, strlen( compress2_dont ) ) ) {
-					i += (int) strlen( compress2_dont ) - 1;
-					/* Only end compression if we're using v2 */
-					if ( d->mccp_version == 2 )
-						compressEnd( d );
-				}
-				/* MCCP v1 (fallback) */
-				else if ( !memcmp( &d->inbuf[i], compress_do, strlen( compress_do ) ) ) {
-					i += (int) strlen( compress_do ) - 1;
-					compressStart( d, 1 );
-				} else if ( !memcmp( &d->inbuf[i], compress_dont, strlen( compress_dont ) ) ) {
-					i += (int) strlen( compress_dont ) - 1;
-					/* Only end compression if we're using v1 */
-					if ( d->mccp_version == 1 )
-						compressEnd( d );
-				}
-				/* MSSP */
-				else if ( !memcmp( &d->inbuf[i], mssp_do, strlen( mssp_do ) ) ) {
-					i += (int) strlen( mssp_do ) - 1;
-					mssp_send( d );
-				}
-				/* GMCP */
-				else if ( !memcmp( &d->inbuf[i], gmcp_do, strlen( gmcp_do ) ) ) {
-					i += (int) strlen( gmcp_do ) - 1;
-					gmcp_init( d );
-				} else if ( !memcmp( &d->inbuf[i], gmcp_dont, strlen( gmcp_dont ) ) ) {
-					i += (int) strlen( gmcp_dont ) - 1;
-					d->gmcp_enabled = FALSE;
-				}
-				/* GMCP subnegotiation: IAC SB GMCP ... IAC SE */
-				else if ( d->inbuf[i + 1] == (signed char) SB &&
-					d->inbuf[i + 2] == (signed char) TELOPT_GMCP ) {
-					int sb_start = i + 3;
-					int sb_len = 0;
-					/* Use bounded scan — NUL bytes may appear in buffer from other subneg data */
-					while ( sb_start + sb_len < d->inbuf_len ) {
-						if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-							(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-							break;
-						}
-						sb_len++;
-					}
-					if ( sb_len > 0 ) {
-						gmcp_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-					}
-					i += 3 + sb_len + 1; /* Skip IAC SB GMCP ... IAC SE */
-				}
-				/* MXP - check strlen > 0 to avoid matching empty strings */
-				else if ( strlen( mxp_do ) > 0 && !memcmp( &d->inbuf[i], mxp_do, strlen( mxp_do ) ) ) {
-					i += (int) strlen( mxp_do ) - 1;
-					mxpStart( d );
-				} else if ( strlen( mxp_dont ) > 0 && !memcmp( &d->inbuf[i], mxp_dont, strlen( mxp_dont ) ) ) {
-					i += (int) strlen( mxp_dont ) - 1;
-					mxpEnd( d );
-				}
-				/* NAWS - client agrees to send window size */
-				else if ( !memcmp( &d->inbuf[i], naws_will, strlen( naws_will ) ) ) {
-					i += (int) strlen( naws_will ) - 1;
-					/* Client will send subnegotiation with size */
-				} else if ( !memcmp( &d->inbuf[i], naws_wont, strlen( naws_wont ) ) ) {
-					i += (int) strlen( naws_wont ) - 1;
-					d->naws_enabled = FALSE;
-				}
-				/* NAWS subnegotiation: IAC SB NAWS <4+ bytes> IAC SE */
-				else if ( d->inbuf[i + 1] == (signed char) SB &&
-					d->inbuf[i + 2] == (signed char) TELOPT_NAWS ) {
-					int sb_start = i + 3;
-					int sb_len = 0;
-					/* Find IAC SE that ends subnegotiation
-					 * Note: NAWS data can contain NUL bytes (width/height high byte = 0)
-					 * so we can't use '\0' as terminator. Limit search to reasonable length. */
-					while ( sb_len < 16 ) {
-						if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-							(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-							break;
-						}
-						sb_len++;
-					}
-					/* 4-8 bytes: 4 data bytes, possibly with IAC escaping */
-					if ( sb_len >= 4 && sb_len <= 8 ) {
-						naws_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-					}
-					i += 3 + sb_len + 1; /* Skip IAC SB NAWS ... IAC SE */
-				}
-				/* TTYPE - client agrees to send terminal type */
-				else if ( !memcmp( &d->inbuf[i], ttype_will, strlen( ttype_will ) ) ) {
-					i += (int) strlen( ttype_will ) - 1;
-					d->ttype_enabled = TRUE;
-					ttype_request( d ); /* Send first TTYPE SEND */
-				} else if ( !memcmp( &d->inbuf[i], ttype_wont, strlen( ttype_wont ) ) ) {
-					i += (int) strlen( ttype_wont ) - 1;
-					d->ttype_enabled = FALSE;
-				}
-				/* TTYPE subnegotiation: IAC SB TTYPE IS <string> IAC SE
-				 * Note: TTYPE data starts with TELQUAL_IS (0x00), a NUL byte,
-				 * so we cannot use '\0' as terminator. Use bounded scan like NAWS. */
-				else if ( d->inbuf[i + 1] == (signed char) SB &&
-					d->inbuf[i + 2] == (signed char) TELOPT_TTYPE ) {
-					int sb_start = i + 3;
-					int sb_len = 0;
-					while ( sb_len < 256 ) {
-						if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-							(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-							break;
-						}
-						sb_len++;
-					}
-					if ( sb_len > 0 ) {
-						ttype_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-					}
-					i += 3 + sb_len + 1; /* Skip IAC SB TTYPE ... IAC SE */
-				}
-				/* CHARSET - client agrees to negotiate */
-				else if ( !memcmp( &d->inbuf[i], charset_do, strlen( charset_do ) ) ) {
-					i += (int) strlen( charset_do ) - 1;
-					charset_send_request( d );
-				} else if ( !memcmp( &d->inbuf[i], charset_dont, strlen( charset_dont ) ) ) {
-					i += (int) strlen( charset_dont ) - 1;
-					/* DONT just means client won't negotiate CHARSET option.
-					 * It does NOT mean client is ASCII-only. Leave as unknown
-					 * so charset_finalize() can use MTTS or default to UTF-8. */
-				}
-				/* CHARSET subnegotiation: IAC SB CHARSET <opcode> ... IAC SE */
-				else if ( d->inbuf[i + 1] == (signed char) SB &&
-					d->inbuf[i + 2] == (signed char) TELOPT_CHARSET ) {
-					int sb_start = i + 3;
-					int sb_len = 0;
-					while ( sb_start + sb_len < d->inbuf_len ) {
-						if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-							(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-							break;
-						}
-						sb_len++;
-					}
-					if ( sb_len > 0 ) {
-						charset_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-					}
-					i += 3 + sb_len + 1; /* Skip IAC SB CHARSET ... IAC SE */
-				}
-				/* Fallback: skip any unrecognized 3-byte IAC sequence (WILL/WONT/DO/DONT + option) */
-				else if ( d->inbuf[i + 1] == (signed char) WILL ||
-					d->inbuf[i + 1] == (signed char) WONT ||
-					d->inbuf[i + 1] == (signed char) DO ||
-					d->inbuf[i + 1] == (signed char) DONT ) {
-					i += 2; /* skip command + option (loop adds 1) */
-				}
-				else {
-					i += 1; /* skip unknown 2-byte IAC sequence (loop adds 1) */
-				}
-			}
-		}
-		/* Clear buffer after processing telnet-only data */
-		d->inbuf[0] = '\0';
-		d->inbuf_len = 0;
-		return;
+static void input_overflow( DESCRIPTOR_DATA *d ) {
+	if ( d->character != NULL && !IS_NPC( d->character ) ) {
+		snprintf( log_buf, MAX_STRING_LENGTH, "%s input overflow!", mask_ip( d->character->pcdata->lasthost ) );
+		log_string( log_buf );
+	} else if ( d->lookup_status != STATUS_LOOKUP ) {
+		snprintf( log_buf, MAX_STRING_LENGTH, "%s input overflow!", mask_ip( d->host ) );
+		log_string( log_buf );
 	}
+	write_to_descriptor( d, "\n\r*** PUT A LID ON IT!!! ***\n\r", 0 );
+}
 
-	/*
-	 * Canonical input processing.
-	 */
-	for ( i = 0, k = 0; i < d->inbuf_len && d->inbuf[i] != '\n' && d->inbuf[i] != '\r'; i++ ) {
-		if ( k >= MAX_INPUT_LENGTH - 2 ) {
-			write_to_descriptor( d, "Line too long.\n\r", 0 );
+/*
+ * Turn a parsed line into incomm.
+ */
+static void read_line( DESCRIPTOR_DATA *d, INPUT_EVENT *ev ) {
+	int k = 0;
 
-			/* skip the rest of the line */
-			for ( ; i < d->inbuf_len; i++ ) {
-				if ( d->inbuf[i] == '\n' || d->inbuf[i] == '\r' )
-					break;
-			}
-			d->inbuf[i] = '\n';
-			d->inbuf[i + 1] = '\0';
-			break;
-		}
+	if ( ev->truncated )
+		write_to_descriptor( d, "Line too long.\n\r", 0 );
 
-		if ( d->inbuf[i] == '\b' && k > 0 ) {
-			--k;
-			/* UTF-8: backspace should erase the whole multi-byte character */
-			while ( k > 0 && utf8_is_cont( (unsigned char) d->incomm[k] ) )
-				--k;
-		}
-		else if ( (unsigned char) d->inbuf[i] >= 0xC2
-			&& (unsigned char) d->inbuf[i] <= 0xF4 ) {
-			/* UTF-8 lead byte - validate and copy the full sequence */
-			int seq = utf8_seq_len( (unsigned char) d->inbuf[i] );
-			if ( seq >= 2 ) {
-				int j;
-				bool valid = TRUE;
-				for ( j = 1; j < seq; j++ ) {
-					if ( d->inbuf[i + j] == '\n' || d->inbuf[i + j] == '\r'
-						|| d->inbuf[i + j] == '\0'
-						|| !utf8_is_cont( (unsigned char) d->inbuf[i + j] ) ) {
-						valid = FALSE;
-						break;
-					}
-				}
-				if ( valid && k + seq < MAX_INPUT_LENGTH - 2 ) {
-					for ( j = 0; j < seq; j++ )
-						d->incomm[k++] = d->inbuf[i + j];
-					i += seq - 1; /* -1 because the for loop increments */
-				}
-				/* else: invalid/incomplete sequence or buffer full, silently dropped */
-			}
-		}
-		else if ( isascii( d->inbuf[i] ) && isprint( d->inbuf[i] ) )
-			d->incomm[k++] = d->inbuf[i];
-		else if ( d->inbuf[i] == (signed char) IAC ) {
-			/* MCCP v2 (preferred) */
-			if ( !memcmp( &d->inbuf[i], compress2_do, strlen( compress2_do ) ) ) {
-				i += (int) strlen( compress2_do ) - 1;
-				compressStart( d, 2 );
-			} else if ( !memcmp( &d->inbuf[i], compress2_dont, strlen( compress2_dont ) ) ) {
-				i += (int) strlen( compress2_dont ) - 1;
-				/* Only end compression if we're using v2 */
-				if ( d->mccp_version == 2 )
-					compressEnd( d );
-			}
-			/* MCCP v1 (fallback) */
-			else if ( !memcmp( &d->inbuf[i], compress_do, strlen( compress_do ) ) ) {
-				i += (int) strlen( compress_do ) - 1;
-				compressStart( d, 1 );
-			} else if ( !memcmp( &d->inbuf[i], compress_dont, strlen( compress_dont ) ) ) {
-				i += (int) strlen( compress_dont ) - 1;
-				/* Only end compression if we're using v1 */
-				if ( d->mccp_version == 1 )
-					compressEnd( d );
-			}
-			/* MSSP */
-			else if ( !memcmp( &d->inbuf[i], mssp_do, strlen( mssp_do ) ) ) {
-				i += (int) strlen( mssp_do ) - 1;
-				mssp_send( d );
-			}
-			/* MXP - check strlen > 0 to avoid matching empty strings */
-			else if ( strlen( mxp_do ) > 0 && !memcmp( &d->inbuf[i], mxp_do, strlen( mxp_do ) ) ) {
-				i += (int) strlen( mxp_do ) - 1;
-				mxpStart( d );
-			} else if ( strlen( mxp_dont ) > 0 && !memcmp( &d->inbuf[i], mxp_dont, strlen( mxp_dont ) ) ) {
-				i += (int) strlen( mxp_dont ) - 1;
-				mxpEnd( d );
-			}
-			/* GMCP */
-			else if ( !memcmp( &d->inbuf[i], gmcp_do, strlen( gmcp_do ) ) ) {
-				i += (int) strlen( gmcp_do ) - 1;
-				gmcp_init( d );
-			} else if ( !memcmp( &d->inbuf[i], gmcp_dont, strlen( gmcp_dont ) ) ) {
-				i += (int) strlen( gmcp_dont ) - 1;
-				d->gmcp_enabled = FALSE;
-			}
-			/* GMCP subnegotiation: IAC SB GMCP ... IAC SE */
-			else if ( d->inbuf[i + 1] == (signed char) SB &&
-				d->inbuf[i + 2] == (signed char) TELOPT_GMCP ) {
-				int sb_start = i + 3;
-				int sb_len = 0;
-				/* Use bounded scan — NUL bytes may appear in buffer from other subneg data */
-				while ( sb_start + sb_len < d->inbuf_len ) {
-					if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-						(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-						break;
-					}
-					sb_len++;
-				}
-				if ( sb_len > 0 ) {
-					gmcp_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-				}
-				i += 3 + sb_len + 1; /* Skip IAC SB GMCP ... IAC SE */
-			}
-			/* NAWS - client agrees to send window size */
-			else if ( !memcmp( &d->inbuf[i], naws_will, strlen( naws_will ) ) ) {
-				i += (int) strlen( naws_will ) - 1;
-				/* Client will send subnegotiation with size */
-			} else if ( !memcmp( &d->inbuf[i], naws_wont, strlen( naws_wont ) ) ) {
-				i += (int) strlen( naws_wont ) - 1;
-				d->naws_enabled = FALSE;
-			}
-			/* NAWS subnegotiation: IAC SB NAWS <4+ bytes> IAC SE */
-			else if ( d->inbuf[i + 1] == (signed char) SB &&
-				d->inbuf[i + 2] == (signed char) TELOPT_NAWS ) {
-				int sb_start = i + 3;
-				int sb_len = 0;
-				/* Find IAC SE that ends subnegotiation
-				 * Note: NAWS data can contain NUL bytes (width/height high byte = 0)
-				 * so we can't use '\0' as terminator. Limit search to reasonable length. */
-				while ( sb_len < 16 ) {
-					if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-						(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-						break;
-					}
-					sb_len++;
-				}
-				/* 4-8 bytes: 4 data bytes, possibly with IAC escaping */
-				if ( sb_len >= 4 && sb_len <= 8 ) {
-					naws_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-				}
-				i += 3 + sb_len + 1; /* Skip IAC SB NAWS ... IAC SE */
-			}
-			/* TTYPE - client agrees to send terminal type */
-			else if ( !memcmp( &d->inbuf[i], ttype_will, strlen( ttype_will ) ) ) {
-				i += (int) strlen( ttype_will ) - 1;
-				d->ttype_enabled = TRUE;
-					ttype_request( d ); /* Send first TTYPE SEND */
-			} else if ( !memcmp( &d->inbuf[i], ttype_wont, strlen( ttype_wont ) ) ) {
-				i += (int) strlen( ttype_wont ) - 1;
-				d->ttype_enabled = FALSE;
-			}
-			/* TTYPE subnegotiation: IAC SB TTYPE IS <string> IAC SE
-			 * Note: TTYPE data starts with TELQUAL_IS (0x00), a NUL byte,
-			 * so we cannot use '\0' as terminator. Use bounded scan like NAWS. */
-			else if ( d->inbuf[i + 1] == (signed char) SB &&
-				d->inbuf[i + 2] == (signed char) TELOPT_TTYPE ) {
-				int sb_start = i + 3;
-				int sb_len = 0;
-				while ( sb_len < 256 ) {
-					if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-						(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-						break;
-					}
-					sb_len++;
-				}
-				if ( sb_len > 0 ) {
-					ttype_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-				}
-				i += 3 + sb_len + 1; /* Skip IAC SB TTYPE ... IAC SE */
-			}
-			/* CHARSET - client agrees to negotiate */
-			else if ( !memcmp( &d->inbuf[i], charset_do, strlen( charset_do ) ) ) {
-				i += (int) strlen( charset_do ) - 1;
-				charset_send_request( d );
-			} else if ( !memcmp( &d->inbuf[i], charset_dont, strlen( charset_dont ) ) ) {
-				i += (int) strlen( charset_dont ) - 1;
-				/* DONT just means client won't negotiate CHARSET option.
-				 * It does NOT mean client is ASCII-only. Leave as unknown
-				 * so charset_finalize() can use MTTS or default to UTF-8. */
-			}
-			/* CHARSET subnegotiation: IAC SB CHARSET <opcode> ... IAC SE */
-			else if ( d->inbuf[i + 1] == (signed char) SB &&
-				d->inbuf[i + 2] == (signed char) TELOPT_CHARSET ) {
-				int sb_start = i + 3;
-				int sb_len = 0;
-				while ( sb_start + sb_len < d->inbuf_len ) {
-					if ( (unsigned char) d->inbuf[sb_start + sb_len] == IAC &&
-						(unsigned char) d->inbuf[sb_start + sb_len + 1] == SE ) {
-						break;
-					}
-					sb_len++;
-				}
-				if ( sb_len > 0 ) {
-					charset_handle_subnegotiation( d, (unsigned char *) &d->inbuf[sb_start], sb_len );
-				}
-				i += 3 + sb_len + 1; /* Skip IAC SB CHARSET ... IAC SE */
-			}
-			/* Fallback: skip any unrecognized 3-byte IAC sequence (WILL/WONT/DO/DONT + option) */
-			else if ( d->inbuf[i + 1] == (signed char) WILL ||
-				d->inbuf[i + 1] == (signed char) WONT ||
-				d->inbuf[i + 1] == (signed char) DO ||
-				d->inbuf[i + 1] == (signed char) DONT ) {
-				i += 2; /* skip command + option (loop adds 1) */
-			}
-			else {
-				i += 1; /* skip unknown 2-byte IAC sequence (loop adds 1) */
-			}
-		}
+	if ( ev->data != NULL ) {
+		k = UMIN( ev->len, MAX_INPUT_LENGTH - 1 );
+		memcpy( d->incomm, ev->data, k );
 	}
 
 	/*
@@ -1671,15 +1331,7 @@ void read_from_buffer( DESCRIPTOR_DATA *d ) {
 			d->repeat = 0;
 		} else {
 			if ( ++d->repeat >= 40 ) {
-				if ( d != NULL && d->character != NULL ) {
-					snprintf( log_buf, MAX_STRING_LENGTH, "%s input overflow!", mask_ip( d->character->pcdata->lasthost ) );
-					log_string( log_buf );
-				} else if ( d->lookup_status != STATUS_LOOKUP ) {
-					snprintf( log_buf, MAX_STRING_LENGTH, "%s input overflow!", mask_ip( d->host ) );
-					log_string( log_buf );
-				}
-				write_to_descriptor( d,
-					"\n\r*** PUT A LID ON IT!!! ***\n\r", 0 );
+				input_overflow( d );
 				snprintf( d->incomm, sizeof( d->incomm ), "quit" );
 			}
 		}
@@ -1692,18 +1344,53 @@ void read_from_buffer( DESCRIPTOR_DATA *d ) {
 		strcpy( d->incomm, d->inlast );
 	else
 		strcpy( d->inlast, d->incomm );
+}
 
-	/*
-	 * Shift the input buffer.
-	 * Use memmove with inbuf_len — NUL-terminated copy would truncate at
-	 * embedded NUL bytes in TTYPE subnegotiation data (TELQUAL_IS = 0x00).
-	 */
-	while ( i < d->inbuf_len && ( d->inbuf[i] == '\n' || d->inbuf[i] == '\r' ) )
-		i++;
-	d->inbuf_len -= i;
-	memmove( d->inbuf, d->inbuf + i, d->inbuf_len );
-	d->inbuf[d->inbuf_len] = '\0';
-	return;
+/*
+ * Act on d's queued input.  Telnet negotiation is handled as it comes;
+ * the next command line is moved into incomm if want_line is set and no
+ * command is already pending, otherwise it stays queued behind the rest.
+ * Returns FALSE if the client went away or flooded the queue.
+ */
+bool read_from_buffer( DESCRIPTOR_DATA *d, bool want_line ) {
+	INPUT_EVENT *ev;
+
+	/* one dirty patch to avoid spams of EOF's */
+	if ( d->input == NULL || d->connected == CON_NOT_PLAYING )
+		return TRUE;
+
+	/* Hold horses if pending command already. */
+	if ( d->incomm[0] != '\0' )
+		want_line = FALSE;
+
+	while ( ( ev = input_front( d->input ) ) != NULL ) {
+		switch ( ev->type ) {
+		case INPUT_EV_LINE:
+			if ( !want_line )
+				return TRUE;
+			read_line( d, ev );
+			break;
+		case INPUT_EV_OPTION:
+			telnet_option( d, ev->cmd, ev->opt );
+			break;
+		case INPUT_EV_SUBNEG:
+			telnet_subneg( d, ev->opt, (unsigned char *) ev->data, ev->len );
+			break;
+		case INPUT_EV_FLOOD:
+			input_overflow( d );
+			return FALSE;
+		case INPUT_EV_CLOSED:
+			log_string( "EOF encountered on read." );
+			return FALSE;
+		}
+
+		if ( d->character != NULL )
+			d->character->timer = 0;
+		input_pop( d->input );
+		if ( ev->type == INPUT_EV_LINE )
+			break;
+	}
+	return TRUE;
 }
 
 /* COPYOVER_FILE and EXE_FILE are now defined in merc.h using mud_path() */
@@ -2215,8 +1902,13 @@ const char *rgb_to_ansi16( int r, int g, int b ) {
 	return ansi_buf;
 }
 
-void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
-	static char output[65536];  /* 64KB - increased for MXP/color expansion */
+/*
+ * Translate the # codes in txt for d into output (size bytes), the way
+ * write_to_buffer() sends them.  Returns the translated length, or -1
+ * if txt is too big to send.  The prompt cache (prompt.c) keeps the
+ * result to replay through write_to_buffer_raw().
+ */
+int write_translate( DESCRIPTOR_DATA *d, const char *txt, int length, char *output, size_t size ) {
 	char *ptr;
 	char *output_end;
 	int i = 0;
@@ -2230,21 +1922,14 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 	/* clear the output buffer, and set the pointer */
 	output[0] = '\0';
 	ptr = output;
-	output_end = output + sizeof(output) - 20;  /* Reserve space for final ANSI reset + safety margin */
+	output_end = output + size - 20;  /* Reserve space for final ANSI reset + safety margin */
 
 	if ( length <= 0 )
 		length = (int) strlen( txt );
 
 	if ( length >= MAX_STRING_LENGTH ) {
 		bug( "Write_to_buffer: Way too big. Closing.", 0 );
-		return;
-	}
-
-	/* initial linebreak */
-	if ( d->outtop == 0 && !d->fcommand ) {
-		d->outbuf[0] = '\n';
-		d->outbuf[1] = '\r';
-		d->outtop = 2;
+		return -1;
 	}
 
 	while ( *txt != '\0' && i++ < length && ptr != NULL && ptr < output_end ) {
@@ -2282,7 +1967,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 		if ( ( ansi = lookup_color( *txt ) ) != NULL ) {
 			had_color = TRUE;
 			if ( use_ansi ) {
-				char *new_ptr = buf_append_safe( ptr, ansi, output, sizeof(output), 20 );
+				char *new_ptr = buf_append_safe( ptr, ansi, output, size, 20 );
 				if ( new_ptr == NULL ) {
 					bug( "write_to_buffer: color lookup overflow, truncating", 0 );
 					break; /* Exit while loop */
@@ -2300,7 +1985,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 			if ( use_ansi ) {
 				ansi = random_colors[number_range( 0, NUM_RANDOM_COLORS - 1 )];
 				{
-					char *new_ptr = buf_append_safe( ptr, ansi, output, sizeof(output), 20 );
+					char *new_ptr = buf_append_safe( ptr, ansi, output, size, 20 );
 					if ( new_ptr == NULL ) {
 						bug( "write_to_buffer: random color overflow, truncating", 0 );
 						ptr = NULL; /* Signal to exit main loop */
@@ -2348,7 +2033,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 					char tc_buf[24];
 					snprintf( tc_buf, sizeof( tc_buf ), "\033[38;2;%d;%d;%dm", r, g, b );
 					{
-						char *new_ptr = buf_append_safe( ptr, tc_buf, output, sizeof(output), 20 );
+						char *new_ptr = buf_append_safe( ptr, tc_buf, output, size, 20 );
 						if ( new_ptr == NULL ) {
 							bug( "write_to_buffer: truecolor fg overflow, truncating", 0 );
 							ptr = NULL;
@@ -2361,7 +2046,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 					char xc_buf[16];
 					snprintf( xc_buf, sizeof( xc_buf ), "\033[38;5;%dm", idx );
 					{
-						char *new_ptr = buf_append_safe( ptr, xc_buf, output, sizeof(output), 20 );
+						char *new_ptr = buf_append_safe( ptr, xc_buf, output, size, 20 );
 						if ( new_ptr == NULL )
 							ptr = NULL;
 						else
@@ -2369,7 +2054,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 					}
 				} else if ( use_ansi ) {
 					const char *a16 = rgb_to_ansi16( r, g, b );
-					char *new_ptr = buf_append_safe( ptr, a16, output, sizeof(output), 20 );
+					char *new_ptr = buf_append_safe( ptr, a16, output, size, 20 );
 					if ( new_ptr == NULL )
 						ptr = NULL;
 					else
@@ -2391,7 +2076,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 					char tc_buf[24];
 					snprintf( tc_buf, sizeof( tc_buf ), "\033[48;2;%d;%d;%dm", r, g, b );
 					{
-						char *new_ptr = buf_append_safe( ptr, tc_buf, output, sizeof(output), 20 );
+						char *new_ptr = buf_append_safe( ptr, tc_buf, output, size, 20 );
 						if ( new_ptr == NULL )
 							ptr = NULL;
 						else
@@ -2402,7 +2087,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 					char xc_buf[16];
 					snprintf( xc_buf, sizeof( xc_buf ), "\033[48;5;%dm", idx );
 					{
-						char *new_ptr = buf_append_safe( ptr, xc_buf, output, sizeof(output), 20 );
+						char *new_ptr = buf_append_safe( ptr, xc_buf, output, size, 20 );
 						if ( new_ptr == NULL )
 							ptr = NULL;
 						else
@@ -2443,7 +2128,7 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 		case 'b': /* Reset background only */
 			had_color = TRUE;
 			if ( use_ansi ) {
-				char *new_ptr = buf_append_safe( ptr, "\033[49m", output, sizeof(output), 20 );
+				char *new_ptr = buf_append_safe( ptr, "\033[49m", output, size, 20 );
 				if ( new_ptr == NULL )
 					ptr = NULL;
 				else
@@ -2500,32 +2185,32 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 
 	/* Terminate with reset color (we reserved space for this) */
 	/* Handle case where ptr might be invalid */
-	if ( ptr == NULL || ptr < output || ptr >= output + sizeof(output) ) {
+	if ( ptr == NULL || ptr < output || ptr >= output + size ) {
 		/* Buffer overflow - find last valid position */
 		bug( "write_to_buffer: buffer overflow detected, truncating", 0 );
 		/* Scan backwards to find null terminator or use safe fallback */
 		ptr = output;
-		while ( *ptr != '\0' && ptr < output + sizeof(output) - 5 ) {
+		while ( *ptr != '\0' && ptr < output + size - 5 ) {
 			ptr++;
 		}
-		if ( ptr >= output + sizeof(output) - 5 ) {
-			ptr = output + sizeof(output) - 5;
+		if ( ptr >= output + size - 5 ) {
+			ptr = output + size - 5;
 		}
 	}
 
 	/* Add ANSI reset sequence only if colors were used and ANSI enabled */
-	if ( had_color && use_ansi && ptr >= output && ptr + 5 <= output + sizeof(output) ) {
+	if ( had_color && use_ansi && ptr >= output && ptr + 5 <= output + size ) {
 		*ptr++ = '\033';
 		*ptr++ = '[';
 		*ptr++ = '0';
 		*ptr++ = 'm';
 	}
 	/* Null terminate */
-	if ( ptr >= output && ptr < output + sizeof(output) ) {
+	if ( ptr >= output && ptr < output + size ) {
 		*ptr = '\0';
 	} else {
-		output[sizeof(output) - 1] = '\0';
-		ptr = output + sizeof(output) - 1;
+		output[size - 1] = '\0';
+		ptr = output + size - 1;
 	}
 
 	length = (int) ( ptr - output );
@@ -2559,6 +2244,20 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 	if ( d->charset_negotiated && d->client_charset != CHARSET_UTF8 )
 		length = charset_transliterate( output, length );
 
+	return length;
+}
+
+/*
+ * Append already translated bytes to d's output buffer.
+ */
+void write_to_buffer_raw( DESCRIPTOR_DATA *d, const char *output, int length ) {
+	/* initial linebreak */
+	if ( d->outtop == 0 && !d->fcommand ) {
+		d->outbuf[0] = '\n';
+		d->outbuf[1] = '\r';
+		d->outtop = 2;
+	}
+
 	/* Expand the buffer as needed */
 	while ( d->outtop + length >= d->outsize ) {
 		char *obuf;
@@ -2586,6 +2285,15 @@ void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
 	return;
 }
 
+void write_to_buffer( DESCRIPTOR_DATA *d, const char *txt, int length ) {
+	static char output[65536];  /* 64KB - increased for MXP/color expansion */
+
+	length = write_translate( d, txt, length, output, sizeof( output ) );
+	if ( length < 0 )
+		return;
+	write_to_buffer_raw( d, output, length );
+}
+
 /*
  * Lowest level output function.
  * Write a block of text to the file descriptor.
@@ -24,8 +24,13 @@
 #include <time.h>
 #include "merc.h"
 #include "cfg.h"
+#include "prompt.h"
+#include "rng.h"
 #include "../systems/mcmp.h"
 #include "../systems/profile.h"
+#include "../world/help_index.h"
+#include "../world/map_layout.h"
+#include "../classes/class_ops.h"
 #include "../db/db_sql.h"
 #include "../db/db_game.h"
 #include "../db/db_player.h"
@@ -241,7 +246,6 @@ int gsn_track;
 int gsn_polymorph;
 int gsn_web;
 int gsn_drowfire;
-int gsn_infirmity;
 int gsn_spew;
 int gsn_blindness;
 int gsn_charm_person;
@@ -255,6 +259,10 @@ int gsn_multiplearms;
 int gsn_darkness;
 int gsn_paradox;
 
+#define SKILL_X( gsn, name ) int gsn;
+SKILL_NAME_ENTRIES
+#undef SKILL_X
+
 /*
  * Locals.
  */
@@ -383,7 +391,8 @@ void boot_db( bool fCopyOver ) {
 	}
 
 	/*
-	 * Assign gsn's for skills which have them.
+	 * Assign gsn's for skills which have them, then resolve the
+	 * named handles in skill_names.h.
 	 */
 	{
 		int sn;
@@ -392,6 +401,8 @@ void boot_db( bool fCopyOver ) {
 			if ( skill_table[sn].pgsn != NULL )
 				*skill_table[sn].pgsn = sn;
 		}
+
+		resolve_skill_names();
 	}
 
 	/*
@@ -441,6 +452,7 @@ void boot_db( bool fCopyOver ) {
 	 */
 	{
 		fix_exits();
+		map_layout_build();
 		fBootDb = FALSE;
 		area_update();
 
@@ -474,6 +486,7 @@ void boot_db( bool fCopyOver ) {
 		db_class_build_vnum_ranges();  /* Build vnum ranges for equipment restrictions */
 		db_class_load_starting();
 		db_class_load_score();
+		class_ops_init();  /* After the registry: checks every class has an entry */
 		db_tables_load_socials();
 		db_tables_load_slays();
 		db_tables_load_liquids();
@@ -534,12 +547,14 @@ void add_help( HELP_DATA *pHelp ) {
 			( match == 0 && pHelp->level > tHelp->level ) ) {
 			list_insert_before( &g_helps, &pHelp->node, &tHelp->node );
 			top_help++;
+			help_index_invalidate();
 			return;
 		}
 	}
 
 	list_push_back( &g_helps, &pHelp->node );
 	top_help++;
+	help_index_invalidate();
 }
 
 
@@ -626,7 +641,7 @@ void fix_exits( void ) {
 void area_update( void ) {
 	AREA_DATA *pArea;
 
-	PROFILE_START( "area_update" );
+	PROFILE_START( PROF_AREA_UPDATE );
 
 	LIST_FOR_EACH( pArea, &g_areas, AREA_DATA, node ) {
 		CHAR_DATA *pch;
@@ -657,10 +672,10 @@ void area_update( void ) {
 			ROOM_INDEX_DATA *pRoomIndex;
 
 			if ( pArea->nplayer > 0 ) {
-				/* Players present - reset immediately */
-				PROFILE_START( "area_reset" );
-				reset_area( pArea );
-				PROFILE_END( "area_reset" );
+				/* Players present - their rooms now, the rest over the next pulses */
+				PROFILE_START( PROF_AREA_RESET );
+				reset_area_begin( pArea );
+				PROFILE_END( PROF_AREA_RESET );
 				pArea->needs_reset = FALSE;
 			} else {
 				/* No players - defer reset until someone enters */
@@ -673,7 +688,7 @@ void area_update( void ) {
 		}
 	}
 
-	PROFILE_END( "area_update" );
+	PROFILE_END( PROF_AREA_UPDATE );
 	return;
 }
 
@@ -748,6 +763,7 @@ void reset_room( ROOM_INDEX_DATA *pRoom ) {
 					SET_BIT( pMob->act, ACT_PET );
 			}
 
+			pMob->home = pRoom->vnum;	/* Stay-area mobs walk back here */
 			char_to_room( pMob, pRoom );
 
 			LastMob = pMob;
@@ -898,51 +914,170 @@ void reset_room( ROOM_INDEX_DATA *pRoom ) {
 	return;
 }
 
-/* OLC
- * Reset one area.
+/*
+ * Area resets run incrementally.  reset_area_begin() starts a new
+ * generation and resets the rooms players are standing in; after that
+ * area_reset_pulse() walks room_first a bounded number of rooms per
+ * pulse, and reset_area_room_now() catches up any room a player walks
+ * into before the cursor gets there.  Every room still resets exactly
+ * once per generation, so the end state matches an atomic reset_area().
  */
-void reset_area( AREA_DATA *pArea ) {
-	ROOM_INDEX_DATA *pRoom;
-	int room_count = 0;
-	struct timeval start_time, end_time;
 
-	/* Track per-area reset timing when profiling is enabled */
-	if ( profile_stats.enabled )
-		gettimeofday( &start_time, NULL );
+/* Reset pRoom unless it already has this generation's reset */
+static bool reset_room_once( ROOM_INDEX_DATA *pRoom ) {
+	if ( pRoom->reset_gen == pRoom->area->reset_gen )
+		return FALSE;
+	pRoom->reset_gen = pRoom->area->reset_gen;
+	PROFILE_START( PROF_RESET_ROOM );
+	reset_room( pRoom );
+	PROFILE_END( PROF_RESET_ROOM );
+	return TRUE;
+}
 
-	/*
-	 * Use the area's room list for efficient iteration.
-	 * This avoids iterating sparse vnum ranges (e.g., 2-30073 with only 3324 rooms).
-	 */
-	for ( pRoom = pArea->room_first; pRoom != NULL; pRoom = pRoom->next_in_area ) {
-		room_count++;
-		PROFILE_START( "reset_room" );
-		reset_room( pRoom );
-		PROFILE_END( "reset_room" );
-	}
+/* Account one pulse's slice of work on pArea's running reset */
+static void reset_area_slice( AREA_DATA *pArea, int64_t start_ns ) {
+	long us;
+
+	if ( start_ns == 0 )
+		return;
+	us = (long) ( ( profile_now_ns() - start_ns ) / 1000 );
+	pArea->reset_run_us += us;
+	pArea->reset_pulses++;
+	if ( us > pArea->profile_reset_slice_us )
+		pArea->profile_reset_slice_us = us;
+}
+
+/* Every room has had this generation's reset */
+static void reset_area_done( AREA_DATA *pArea ) {
+	pArea->reset_next = NULL;
 
 	/* Update per-area profiling stats */
 	if ( profile_stats.enabled ) {
-		long elapsed_us;
-		gettimeofday( &end_time, NULL );
-		elapsed_us = ( end_time.tv_sec - start_time.tv_sec ) * 1000000
-		           + ( end_time.tv_usec - start_time.tv_usec );
 		pArea->profile_reset_count++;
-		pArea->profile_reset_time_us += elapsed_us;
+		pArea->profile_reset_time_us += pArea->reset_run_us;
+		pArea->profile_reset_pulses += pArea->reset_pulses;
 	}
 
 	/* Debug: Log areas with many rooms */
-	if ( profile_stats.verbose && room_count > 500 ) {
+	if ( profile_stats.verbose && pArea->room_count > 500 ) {
 		char debug_buf[256];
 		int vnum_range = pArea->uvnum - pArea->lvnum + 1;
 		snprintf( debug_buf, sizeof( debug_buf ),
-			"AREA RESET: %s - vnum range %d-%d (%d span), %d rooms reset (list)",
+			"AREA RESET: %s - vnum range %d-%d (%d span), %d rooms reset over %d pulses",
 			pArea->name ? pArea->name : "Unknown",
-			pArea->lvnum, pArea->uvnum, vnum_range, room_count );
+			pArea->lvnum, pArea->uvnum, vnum_range, pArea->room_count, pArea->reset_pulses );
 		log_string( debug_buf );
 	}
+}
 
-	return;
+/* Reset every room the cursor has not reached yet */
+static void reset_area_finish( AREA_DATA *pArea ) {
+	for ( ; pArea->reset_next != NULL; pArea->reset_next = pArea->reset_next->next_in_area )
+		reset_room_once( pArea->reset_next );
+	reset_area_done( pArea );
+}
+
+/*
+ * Start a reset of pArea.  Rooms with players in them reset now; the
+ * rest follow from area_reset_pulse().
+ */
+void reset_area_begin( AREA_DATA *pArea ) {
+	DESCRIPTOR_DATA *d;
+	int64_t start_ns;
+
+	/* Still working through the previous reset: complete it first */
+	if ( pArea->reset_next != NULL )
+		reset_area_finish( pArea );
+
+	pArea->reset_gen++;
+	pArea->reset_next = pArea->room_first;
+	pArea->reset_pulses = 0;
+	pArea->reset_run_us = 0;
+	if ( pArea->reset_next == NULL )
+		return;
+
+	start_ns = profile_stats.enabled ? profile_now_ns() : 0;
+	LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node ) {
+		if ( d->connected == CON_PLAYING && d->character != NULL
+			&& d->character->in_room != NULL && d->character->in_room->area == pArea )
+			reset_room_once( d->character->in_room );
+	}
+	reset_area_slice( pArea, start_ns );
+}
+
+/*
+ * A player is entering pRoom: if its area is part way through a reset
+ * and this room's turn has not come yet, reset it now.
+ */
+void reset_area_room_now( ROOM_INDEX_DATA *pRoom ) {
+	AREA_DATA *pArea = pRoom->area;
+	int64_t start_ns;
+
+	if ( pArea == NULL || pArea->reset_next == NULL || pRoom->reset_gen == pArea->reset_gen )
+		return;
+
+	start_ns = profile_stats.enabled ? profile_now_ns() : 0;
+	reset_room_once( pRoom );
+	if ( start_ns != 0 )
+		pArea->reset_run_us += (long) ( ( profile_now_ns() - start_ns ) / 1000 );
+}
+
+/*
+ * Advance running resets by up to world.reset_rooms_per_pulse rooms in
+ * total.  Rooms that were already reset out of turn cost nothing.
+ */
+void area_reset_pulse( void ) {
+	AREA_DATA *pArea;
+	int budget = UMAX( 1, cfg( CFG_WORLD_RESET_ROOMS_PER_PULSE ) );
+
+	LIST_FOR_EACH( pArea, &g_areas, AREA_DATA, node ) {
+		int64_t start_ns;
+
+		if ( budget <= 0 )
+			break;
+		if ( pArea->reset_next == NULL )
+			continue;
+
+		PROFILE_START( PROF_AREA_RESET );
+		start_ns = profile_stats.enabled ? profile_now_ns() : 0;
+		while ( pArea->reset_next != NULL ) {
+			ROOM_INDEX_DATA *pRoom = pArea->reset_next;
+
+			if ( budget <= 0 && pRoom->reset_gen != pArea->reset_gen )
+				break;
+			pArea->reset_next = pRoom->next_in_area;
+			if ( reset_room_once( pRoom ) )
+				budget--;
+		}
+		reset_area_slice( pArea, start_ns );
+		if ( pArea->reset_next == NULL )
+			reset_area_done( pArea );
+		PROFILE_END( PROF_AREA_RESET );
+	}
+}
+
+/* OLC
+ * Reset one area completely, right now.  Used at boot and by OLC.
+ */
+void reset_area( AREA_DATA *pArea ) {
+	int64_t start_ns = profile_stats.enabled ? profile_now_ns() : 0;
+
+	reset_area_begin( pArea );
+	if ( pArea->reset_next == NULL )
+		return;
+
+	/*
+	 * Use the area's room list for efficient iteration.
+	 * This avoids iterating sparse vnum ranges (e.g., 2-30073 with only 3324 rooms).
+	 */
+	for ( ; pArea->reset_next != NULL; pArea->reset_next = pArea->reset_next->next_in_area )
+		reset_room_once( pArea->reset_next );
+
+	/* Track per-area reset timing when profiling is enabled */
+	pArea->reset_pulses = 0;
+	pArea->reset_run_us = 0;
+	reset_area_slice( pArea, start_ns );
+	reset_area_done( pArea );
 }
 
 /*
@@ -975,7 +1110,7 @@ CHAR_DATA *create_mobile( MOB_INDEX_DATA *pMobIndex ) {
 	mob->long_descr = pMobIndex->long_descr;	/* Flyweight: shared with template */
 	mob->description = pMobIndex->description;	/* Flyweight: shared with template */
 
-	mob->home = 3001;
+	mob->home = 0;	/* Set by the reset that places it */
 	mob->form = 32767;
 	mob->level = number_fuzzy( pMobIndex->level );
 	mob->act = pMobIndex->act;
@@ -1026,6 +1161,7 @@ CHAR_DATA *create_mobile( MOB_INDEX_DATA *pMobIndex ) {
 	 */
 	list_push_back( &g_characters, &mob->char_node );
 	list_push_back( &g_npcs, &mob->npc_node );
+	list_push_back( &pMobIndex->instances, &mob->proto_node );
 	pMobIndex->count++;
 	return mob;
 }
@@ -1050,6 +1186,8 @@ OBJ_DATA *create_object( OBJ_INDEX_DATA *pObjIndex, int level ) {
 	list_node_init( &obj->obj_node );
 	list_node_init( &obj->room_node );
 	list_node_init( &obj->content_node );
+	list_node_init( &obj->script_node );
+	list_node_init( &obj->proto_node );
 	list_init( &obj->affects );
 	list_init( &obj->contents );
 	list_init( &obj->extra_descr );
@@ -1222,6 +1360,7 @@ OBJ_DATA *create_object( OBJ_INDEX_DATA *pObjIndex, int level ) {
 	}
 
 	list_push_back( &g_objects, &obj->obj_node );
+	list_push_back( &pObjIndex->instances, &obj->proto_node );
 	pObjIndex->count++;
 
 	return obj;
@@ -1246,6 +1385,8 @@ void clear_char( CHAR_DATA *ch ) {
 	list_node_init( &ch->npc_node );
 	list_node_init( &ch->room_node );
 	list_node_init( &ch->extracted_node );
+	list_node_init( &ch->script_node );
+	list_node_init( &ch->proto_node );
 	list_init( &ch->affects );
 	list_init( &ch->carrying );
 	ch->logon = current_time;
@@ -1279,6 +1420,12 @@ void free_char( CHAR_DATA *ch ) {
 	ALIAS_DATA *ali;
 	ALIAS_DATA *ali_tmp;
 
+	script_forget_entity( ch );
+
+	/* Normally already unlinked by extract_char() */
+	if ( IS_NPC( ch ) && ch->pIndexData != NULL && list_node_is_linked( &ch->proto_node ) )
+		list_remove( &ch->pIndexData->instances, &ch->proto_node );
+
 	LIST_FOR_EACH_SAFE( obj, obj_next, &ch->carrying, OBJ_DATA, content_node ) {
 		extract_obj( obj );
 	}
@@ -1308,6 +1455,8 @@ void free_char( CHAR_DATA *ch ) {
 		free(ch->pcdata->powertype);
 		free(ch->pcdata->prompt);
 		free(ch->pcdata->cprompt);
+		prompt_free( ch->pcdata->prompt_prog );
+		prompt_free( ch->pcdata->cprompt_prog );
 		free(ch->pcdata->switchname);
 		free(ch->pcdata->logoutmessage);
 		free(ch->pcdata->avatarmessage);
@@ -1650,108 +1799,47 @@ int number_fuzzy( int number ) {
  * Generate a random number.
  */
 int number_range( int from, int to ) {
-	int power;
-	int number;
-
-	if ( ( to = to - from + 1 ) <= 1 )
-		return from;
-
-	for ( power = 2; power < to; power <<= 1 );
-
-	while ( ( number = number_mm() & ( power - 1 ) ) >= to );
-
-	return from + number;
+	return rng_range( rng_active(), from, to );
 }
 
 /*
  * Generate a percentile roll.
  */
 int number_percent( void ) {
-	int percent;
-
-	while ( ( percent = number_mm() & ( 128 - 1 ) ) > 99 );
-
-	return 1 + percent;
+	return 1 + (int) rng_bounded( rng_stream( rng_active() ), 100 );
 }
 
 /*
  * Generate a random door.
  */
 int number_door( void ) {
-	int door;
-
-	while ( ( door = number_mm() & ( 8 - 1 ) ) > 5 );
-
-	return door;
+	return (int) rng_bounded( rng_stream( rng_active() ), 6 );
 }
 
 int number_bits( int width ) {
-	return number_mm() & ( ( 1 << width ) - 1 );
+	return (int) ( rng_next( rng_stream( rng_active() ) ) & ( ( 1u << width ) - 1 ) );
 }
 
 /*
- * I've gotten too many bad reports on OS-supplied random number generators.
- * This is the Mitchell-Moore algorithm from Knuth Volume II.
- * Best to leave the constants alone unless you've read Knuth.
- * -- Furey
+ * The Mitchell-Moore generator that used to live here is replaced by the
+ * streams in rng.c; init_mm() keeps its name and seeds all of them from
+ * current_time.
  */
-static int rgiState[2 + 55];
-
 void init_mm() {
-	int *piState;
-	int iState;
-
-	piState = &rgiState[2];
-
-	piState[-2] = 55 - 55;
-	piState[-1] = 55 - 24;
-
-	piState[0] = ( (int) current_time ) & ( ( 1 << 30 ) - 1 );
-	piState[1] = 1;
-	for ( iState = 2; iState < 55; iState++ ) {
-		piState[iState] = ( piState[iState - 1] + piState[iState - 2] ) & ( ( 1 << 30 ) - 1 );
-	}
-	return;
+	rng_seed_all( (uint64_t) current_time );
+	rng_select( RNG_DEFAULT );
 }
 
+/* 24 random bits, the range number_mm() always returned */
 int number_mm( void ) {
-	int *piState;
-	int iState1;
-	int iState2;
-	int iRand;
-
-	piState = &rgiState[2];
-	iState1 = piState[-2];
-	iState2 = piState[-1];
-	iRand = ( piState[iState1] + piState[iState2] ) & ( ( 1 << 30 ) - 1 );
-	piState[iState1] = iRand;
-	if ( ++iState1 == 55 )
-		iState1 = 0;
-	if ( ++iState2 == 55 )
-		iState2 = 0;
-	piState[-2] = iState1;
-	piState[-1] = iState2;
-	return iRand >> 6;
+	return (int) ( rng_next( rng_stream( rng_active() ) ) >> 8 );
 }
 
 /*
  * Roll some dice.
  */
 int dice( int number, int size ) {
-	int idice;
-	int sum;
-
-	switch ( size ) {
-	case 0:
-		return 0;
-	case 1:
-		return number;
-	}
-
-	for ( idice = 0, sum = 0; idice < number; idice++ )
-		sum += number_range( 1, size );
-
-	return sum;
+	return rng_dice( rng_active(), number, size );
 }
 
 /*
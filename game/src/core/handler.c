@@ -23,6 +23,7 @@
 #include "merc.h"
 #include "gmcp.h"
 #include "../db/db_class.h"
+#include "../script/script.h"
 
 
 /*
@@ -230,10 +231,10 @@ bool is_full_name( const char *str, char *namelist ) {
 }
 
 /*
- * Apply or remove an affect to a character.
+ * Apply or remove an affect to a character, without the wield check.
+ * Returns TRUE if the wielded weapon may now be too heavy.
  */
-void affect_modify( CHAR_DATA *ch, AFFECT_DATA *paf, bool fAdd, OBJ_DATA *obj ) {
-	OBJ_DATA *wield;
+static bool affect_apply( CHAR_DATA *ch, AFFECT_DATA *paf, bool fAdd, OBJ_DATA *obj ) {
 	int mod;
 
 	mod = paf->modifier;
@@ -288,13 +289,13 @@ void affect_modify( CHAR_DATA *ch, AFFECT_DATA *paf, bool fAdd, OBJ_DATA *obj )
 			ch->polyaff += mod;
 			break;
 		}
-		return;
+		return FALSE;
 	}
 	if ( !IS_NPC( ch ) && obj != NULL && IS_CLASS( ch, CLASS_SAMURAI ) && obj->pIndexData->vnum == 33177 ) {
 		switch ( paf->location ) {
 		default:
 			bug( "Affect_modify: unknown location %d.", paf->location );
-			return;
+			return FALSE;
 
 		case APPLY_NONE:
 			break;
@@ -369,7 +370,7 @@ void affect_modify( CHAR_DATA *ch, AFFECT_DATA *paf, bool fAdd, OBJ_DATA *obj )
 			ch->polyaff += mod;
 			break;
 		}
-		return;
+		return FALSE;
 	}
 	if ( IS_CLASS( ch, CLASS_SAMURAI ) ) {
 		switch ( paf->location ) {
@@ -378,13 +379,13 @@ void affect_modify( CHAR_DATA *ch, AFFECT_DATA *paf, bool fAdd, OBJ_DATA *obj )
 		case APPLY_NONE:
 			break;
 		}
-		return;
+		return FALSE;
 	}
 
 	switch ( paf->location ) {
 	default:
 		bug( "Affect_modify: unknown location %d.", paf->location );
-		return;
+		return FALSE;
 
 	case APPLY_NONE:
 		break;
@@ -460,24 +461,34 @@ void affect_modify( CHAR_DATA *ch, AFFECT_DATA *paf, bool fAdd, OBJ_DATA *obj )
 		break;
 	}
 
-	/*
-	 * Check for weapon wielding.
-	 * Guard against recursion (for weapons with affects).
-	 */
-	if ( ( wield = get_eq_char( ch, WEAR_WIELD ) ) != NULL && wield->item_type == ITEM_WEAPON && get_obj_weight( wield ) > str_app[get_curr_str( ch )].wield ) {
-		static int depth;
-
-		if ( depth == 0 ) {
-			depth++;
-			act( "You drop $p.", ch, wield, NULL, TO_CHAR );
-			act( "$n drops $p.", ch, wield, NULL, TO_ROOM );
-			obj_from_char( wield );
-			obj_to_room( wield, ch->in_room );
-			depth--;
-		}
+	return TRUE;
+}
+
+/*
+ * Drop the wielded weapon if it has become too heavy.
+ * Guard against recursion (for weapons with affects).
+ */
+static void check_wield_weight( CHAR_DATA *ch ) {
+	OBJ_DATA *wield;
+	static int depth;
+
+	if ( depth == 0 && ( wield = get_eq_char( ch, WEAR_WIELD ) ) != NULL && wield->item_type == ITEM_WEAPON
+		&& get_obj_weight( wield ) > str_app[get_curr_str( ch )].wield ) {
+		depth++;
+		act( "You drop $p.", ch, wield, NULL, TO_CHAR );
+		act( "$n drops $p.", ch, wield, NULL, TO_ROOM );
+		obj_from_char( wield );
+		obj_to_room( wield, ch->in_room );
+		depth--;
 	}
+}
 
-	return;
+/*
+ * Apply or remove an affect to a character.
+ */
+void affect_modify( CHAR_DATA *ch, AFFECT_DATA *paf, bool fAdd, OBJ_DATA *obj ) {
+	if ( affect_apply( ch, paf, fAdd, obj ) )
+		check_wield_weight( ch );
 }
 
 
@@ -737,6 +748,7 @@ void char_from_room( CHAR_DATA *ch ) {
 	} else {
 		list_remove( &ch->in_room->characters, &ch->room_node );
 	}
+	script_sub_char_from_room( ch );
 
 	ch->in_room = NULL;
 	return;
@@ -760,14 +772,17 @@ void char_to_room( CHAR_DATA *ch, ROOM_INDEX_DATA *pRoomIndex ) {
 
 	ch->in_room = pRoomIndex;
 	list_push_front( &pRoomIndex->characters, &ch->room_node );
+	script_sub_char_to_room( ch, pRoomIndex );
 
 	if ( !IS_NPC(ch) && ch->in_room->area != NULL ) {
 		++ch->in_room->area->nplayer;
 		/* Deferred reset: trigger when first player enters area */
 		if ( ch->in_room->area->nplayer == 1 && ch->in_room->area->needs_reset ) {
-			reset_area( ch->in_room->area );
+			reset_area_begin( ch->in_room->area );
 			ch->in_room->area->needs_reset = FALSE;
 		}
+		/* Mid-reset area: this room goes before the rest */
+		reset_area_room_now( pRoomIndex );
 	}
 
 	if ( ( obj = get_eq_char( ch, WEAR_WIELD ) ) != NULL && obj->item_type == ITEM_LIGHT && obj->value[2] != 0 )
@@ -795,6 +810,7 @@ void obj_to_char( OBJ_DATA *obj, CHAR_DATA *ch ) {
 	obj->carried_by = ch;
 	obj->in_room = NULL;
 	obj->in_obj = NULL;
+	script_sub_obj_to_char( obj );
 	ch->carry_number += 1;
 	ch->carry_weight += get_obj_weight( obj );
 }
@@ -819,6 +835,7 @@ void obj_from_char( OBJ_DATA *obj ) {
 	} else {
 		list_remove( &ch->carrying, &obj->content_node );
 	}
+	script_sub_obj_from_char( obj );
 
 	obj->carried_by = NULL;
 	ch->carry_number -= 1;
@@ -898,6 +915,7 @@ void equip_char( CHAR_DATA *ch, OBJ_DATA *obj, int iWear ) {
 	CHAR_DATA *chch;
 	AFFECT_DATA *paf;
 	int sn;
+	bool heavy;
 
 	if ( obj->item_type == ITEM_ARMOR )
 		sn = obj->value[3];
@@ -1011,10 +1029,14 @@ void equip_char( CHAR_DATA *ch, OBJ_DATA *obj, int iWear ) {
 		ch->armor -= apply_ac( obj, iWear );
 	obj->wear_loc = iWear;
 
+	/* All of the object's affects go on before the one wield check */
+	heavy = FALSE;
 	LIST_FOR_EACH( paf, &obj->pIndexData->affects, AFFECT_DATA, node )
-		affect_modify( ch, paf, TRUE, obj );
+		heavy |= affect_apply( ch, paf, TRUE, obj );
 	LIST_FOR_EACH( paf, &obj->affects, AFFECT_DATA, node )
-		affect_modify( ch, paf, TRUE, obj );
+		heavy |= affect_apply( ch, paf, TRUE, obj );
+	if ( heavy )
+		check_wield_weight( ch );
 
 	if ( obj->item_type == ITEM_LIGHT && obj->value[2] != 0 && ch->in_room != NULL )
 		++ch->in_room->light;
@@ -1254,6 +1276,7 @@ void unequip_char( CHAR_DATA *ch, OBJ_DATA *obj ) {
 	CHAR_DATA *chch;
 	AFFECT_DATA *paf;
 	int sn;
+	bool heavy;
 	int oldpos = obj->wear_loc;
 
 	if ( obj->wear_loc == WEAR_NONE ) {
@@ -1271,10 +1294,14 @@ void unequip_char( CHAR_DATA *ch, OBJ_DATA *obj ) {
 		ch->armor += apply_ac( obj, obj->wear_loc );
 	obj->wear_loc = -1;
 
+	/* All of the object's affects go on before the one wield check */
+	heavy = FALSE;
 	LIST_FOR_EACH( paf, &obj->pIndexData->affects, AFFECT_DATA, node )
-		affect_modify( ch, paf, FALSE, obj );
+		heavy |= affect_apply( ch, paf, FALSE, obj );
 	LIST_FOR_EACH( paf, &obj->affects, AFFECT_DATA, node )
-		affect_modify( ch, paf, FALSE, obj );
+		heavy |= affect_apply( ch, paf, FALSE, obj );
+	if ( heavy )
+		check_wield_weight( ch );
 
 	if ( obj->item_type == ITEM_LIGHT && obj->value[2] != 0 && ch->in_room != NULL && ch->in_room->light > 0 )
 		--ch->in_room->light;
@@ -1424,12 +1451,23 @@ void unequip_char( CHAR_DATA *ch, OBJ_DATA *obj ) {
 
 /*
  * Count occurrences of an obj in a list.
+ * Content lists are a carried inventory or a container; whichever of
+ * the list and the template's live instances is shorter gets walked.
  */
 int count_obj_list( OBJ_INDEX_DATA *pObjIndex, list_head_t *list ) {
 	OBJ_DATA *obj;
 	int nMatch;
 
 	nMatch = 0;
+	if ( list_count( &pObjIndex->instances ) < list_count( list ) ) {
+		LIST_FOR_EACH( obj, &pObjIndex->instances, OBJ_DATA, proto_node ) {
+			if ( ( obj->in_obj != NULL && &obj->in_obj->contents == list )
+				|| ( obj->carried_by != NULL && &obj->carried_by->carrying == list ) )
+				nMatch++;
+		}
+		return nMatch;
+	}
+
 	LIST_FOR_EACH( obj, list, OBJ_DATA, content_node ) {
 		if ( obj->pIndexData == pObjIndex )
 			nMatch++;
@@ -1446,6 +1484,14 @@ int count_obj_room( OBJ_INDEX_DATA *pObjIndex, list_head_t *list ) {
 	int nMatch;
 
 	nMatch = 0;
+	if ( list_count( &pObjIndex->instances ) < list_count( list ) ) {
+		LIST_FOR_EACH( obj, &pObjIndex->instances, OBJ_DATA, proto_node ) {
+			if ( obj->in_room != NULL && &obj->in_room->objects == list )
+				nMatch++;
+		}
+		return nMatch;
+	}
+
 	LIST_FOR_EACH( obj, list, OBJ_DATA, room_node ) {
 		if ( obj->pIndexData == pObjIndex )
 			nMatch++;
@@ -1650,6 +1696,10 @@ void extract_obj( OBJ_DATA *obj ) {
 	if ( obj->victpoweruse != NULL ) free(obj->victpoweruse);
 	if ( obj->questmaker != NULL ) free(obj->questmaker);
 	if ( obj->questowner != NULL ) free(obj->questowner);
+	free( obj->mxp_hint );
+	script_forget_entity( obj );
+	if ( list_node_is_linked( &obj->proto_node ) )
+		list_remove( &obj->pIndexData->instances, &obj->proto_node );
 	--obj->pIndexData->count;
 	free( obj );
 	return;
@@ -1684,9 +1734,11 @@ void extract_char( CHAR_DATA *ch, bool fPull ) {
 
 	char_from_room( ch );
 
-	if ( IS_NPC( ch ) )
+	if ( IS_NPC( ch ) ) {
+		if ( list_node_is_linked( &ch->proto_node ) )
+			list_remove( &ch->pIndexData->instances, &ch->proto_node );
 		--ch->pIndexData->count;
-	else if ( ch->pcdata->chobj != NULL ) {
+	} else if ( ch->pcdata->chobj != NULL ) {
 		ch->pcdata->chobj->chobj = NULL;
 		ch->pcdata->chobj = NULL;
 	}
@@ -1699,6 +1751,9 @@ void extract_char( CHAR_DATA *ch, bool fPull ) {
 	if ( ch->desc != NULL && ch->desc->original != NULL )
 		do_return( ch, "" );
 
+	/* Scripts must not keep acting on a char that is pending free */
+	script_forget_entity( ch );
+
 	/*
 	 * Remove ch from global character list (O(1) with intrusive list),
 	 * then clear reply/propose/partner pointers and decrement follower counts.
@@ -1832,18 +1887,14 @@ CHAR_DATA *get_char_world( CHAR_DATA *ch, char *argument ) {
 }
 
 /*
- * Find some object with a given index data.
+ * Find some object with a given index data: the oldest live instance.
  * Used by area-reset 'P' command.
  */
 OBJ_DATA *get_obj_type( OBJ_INDEX_DATA *pObjIndex ) {
-	OBJ_DATA *obj;
-
-	LIST_FOR_EACH( obj, &g_objects, OBJ_DATA, obj_node ) {
-		if ( obj->pIndexData == pObjIndex )
-			return obj;
-	}
+	if ( list_empty( &pObjIndex->instances ) )
+		return NULL;
 
-	return NULL;
+	return LIST_ENTRY( list_first( &pObjIndex->instances ), OBJ_DATA, proto_node );
 }
 
 /*
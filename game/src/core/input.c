@@ -0,0 +1,494 @@
+/***************************************************************************
+ *  input.c - Socket reads and telnet parsing off the game thread
+ *
+ *  See input.h.  The registration list and the stats are guarded by
+ *  input_lock, which the I/O thread holds while it reads and parses, so
+ *  input_close() cannot free a connection out from under it.  Each ring
+ *  is lock-free: tail is only written by the producer and head only by
+ *  the game thread, published with release stores and read with acquire
+ *  loads, so an event's fields are complete before it becomes visible.
+ ***************************************************************************/
+
+#include "merc.h"
+#include "utf8.h"
+#include "input.h"
+#include "../systems/telnet.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#if !defined( WIN32 )
+#include <unistd.h>
+#include <sys/select.h>
+#endif
+
+/* How long the I/O thread waits before noticing new connections or a stop */
+#define INPUT_POLL_USEC 10000
+
+/* Most bytes read from one socket per wakeup, so one sender cannot starve the rest */
+#define INPUT_PUMP_MAX 16384
+
+#define INPUT_RING_MASK ( INPUT_QUEUE_SIZE - 1 )
+
+#if defined( _MSC_VER )
+#define INPUT_LOAD( p )		( (unsigned int) InterlockedCompareExchange( (volatile LONG *) ( p ), 0, 0 ) )
+#define INPUT_STORE( p, v ) InterlockedExchange( (volatile LONG *) ( p ), (LONG) ( v ) )
+#else
+#define INPUT_LOAD( p )		__atomic_load_n( ( p ), __ATOMIC_ACQUIRE )
+#define INPUT_STORE( p, v ) __atomic_store_n( ( p ), ( v ), __ATOMIC_RELEASE )
+#endif
+
+/* Parser states */
+enum {
+	IN_DATA,	/* Line text */
+	IN_IAC,		/* After IAC */
+	IN_CMD,		/* After IAC WILL/WONT/DO/DONT, waiting for the option */
+	IN_SB_OPT,	/* After IAC SB, waiting for the option */
+	IN_SB,		/* Subnegotiation payload */
+	IN_SB_IAC	/* IAC inside a subnegotiation */
+};
+
+struct input_conn {
+	INPUT_CONN *next;			/* Registered connections */
+	int fd;
+	bool done;					/* FLOOD or CLOSED queued; nothing more is read */
+
+	unsigned int head;			/* Next event to pop; game thread */
+	unsigned int tail;			/* Next slot to fill; producer */
+	INPUT_EVENT ring[INPUT_QUEUE_SIZE];
+
+	/* Parser state, producer only */
+	int state;
+	int cmd;
+	int opt;
+	unsigned char last_eol;		/* CR or LF that ended the previous line */
+	char line[MAX_INPUT_LENGTH];
+	int line_len;
+	bool line_long;
+	int utf8_start;				/* Where an unfinished UTF-8 character begins */
+	int utf8_need;				/* Continuation bytes it still needs */
+	unsigned char *sb;
+	int sb_len;
+	int sb_cap;
+	bool sb_dropped;			/* Over INPUT_SUBNEG_MAX; discard until IAC SE */
+};
+
+static pthread_mutex_t input_lock;
+static pthread_cond_t input_stopped;
+static bool input_ready;
+static bool input_running;
+static bool input_stopping;
+static INPUT_CONN *input_conns;
+static INPUT_STATS input_stats;
+
+static void input_byte( INPUT_CONN *c, unsigned char b );
+
+static void input_init( void ) {
+	if ( input_ready )
+		return;
+	pthread_mutex_init( &input_lock, NULL );
+	pthread_cond_init( &input_stopped, NULL );
+	input_ready = TRUE;
+}
+
+
+/*
+ * Ring
+ */
+
+/* Queue an event, copying data.  Past the last free slot it becomes FLOOD. */
+static void input_push( INPUT_CONN *c, int type, int cmd, int opt,
+	const void *data, int len, bool truncated ) {
+	INPUT_EVENT *ev;
+
+	if ( c->done )
+		return;
+
+	if ( c->tail - INPUT_LOAD( &c->head ) >= INPUT_QUEUE_SIZE - 1 && type != INPUT_EV_CLOSED ) {
+		type = INPUT_EV_FLOOD;
+		data = NULL;
+		input_stats.floods++;
+	}
+
+	ev = &c->ring[c->tail & INPUT_RING_MASK];
+	ev->type = type;
+	ev->cmd = cmd;
+	ev->opt = opt;
+	ev->len = 0;
+	ev->truncated = truncated;
+	ev->data = NULL;
+	if ( data != NULL && ( ev->data = malloc( len + 1 ) ) != NULL ) {
+		memcpy( ev->data, data, len );
+		ev->data[len] = '\0';
+		ev->len = len;
+	}
+	if ( type == INPUT_EV_FLOOD || type == INPUT_EV_CLOSED )
+		c->done = TRUE;
+
+	input_stats.events++;
+	INPUT_STORE( &c->tail, c->tail + 1 );
+}
+
+INPUT_EVENT *input_front( INPUT_CONN *c ) {
+	if ( c->head == INPUT_LOAD( &c->tail ) )
+		return NULL;
+	return &c->ring[c->head & INPUT_RING_MASK];
+}
+
+void input_pop( INPUT_CONN *c ) {
+	INPUT_EVENT *ev = input_front( c );
+
+	if ( ev == NULL )
+		return;
+	free( ev->data );
+	ev->data = NULL;
+	INPUT_STORE( &c->head, c->head + 1 );
+}
+
+
+/*
+ * Parser
+ */
+
+static void input_end_line( INPUT_CONN *c ) {
+	if ( c->utf8_need > 0 ) {
+		c->line_len = c->utf8_start;
+		c->utf8_need = 0;
+	}
+	input_push( c, INPUT_EV_LINE, 0, 0, c->line, c->line_len, c->line_long );
+	c->line_len = 0;
+	c->line_long = FALSE;
+}
+
+/* One byte of line text */
+static void input_text( INPUT_CONN *c, unsigned char b ) {
+	int seq;
+
+	/* CR NUL: the NUL only marks a bare CR */
+	if ( b == '\0' ) {
+		c->last_eol = 0;
+		return;
+	}
+
+	/* CR LF and LF CR end one line, not two */
+	if ( b == '\r' || b == '\n' ) {
+		if ( c->last_eol != 0 && c->last_eol != b ) {
+			c->last_eol = 0;
+			return;
+		}
+		input_end_line( c );
+		c->last_eol = b;
+		return;
+	}
+	c->last_eol = 0;
+
+	if ( c->line_long )
+		return;
+
+	if ( c->utf8_need > 0 ) {
+		if ( utf8_is_cont( b ) ) {
+			c->line[c->line_len++] = (char) b;
+			c->utf8_need--;
+			return;
+		}
+		/* Broken sequence: drop what we have of it */
+		c->line_len = c->utf8_start;
+		c->utf8_need = 0;
+	}
+
+	/* Backspace erases a whole UTF-8 character */
+	if ( b == '\b' ) {
+		if ( c->line_len > 0 ) {
+			--c->line_len;
+			while ( c->line_len > 0 && utf8_is_cont( c->line[c->line_len] ) )
+				--c->line_len;
+		}
+		return;
+	}
+
+	if ( b >= 0xC2 && b <= 0xF4 ) {
+		seq = utf8_seq_len( b );
+		if ( c->line_len + seq >= MAX_INPUT_LENGTH - 2 ) {
+			c->line_long = TRUE;
+			return;
+		}
+		c->utf8_start = c->line_len;
+		c->line[c->line_len++] = (char) b;
+		c->utf8_need = seq - 1;
+		return;
+	}
+
+	if ( b < ' ' || b > '~' )
+		return;
+	if ( c->line_len >= MAX_INPUT_LENGTH - 2 ) {
+		c->line_long = TRUE;
+		return;
+	}
+	c->line[c->line_len++] = (char) b;
+}
+
+static void input_sb_add( INPUT_CONN *c, unsigned char b ) {
+	unsigned char *grown;
+	int cap;
+
+	if ( c->sb_dropped )
+		return;
+	if ( c->sb_len >= INPUT_SUBNEG_MAX ) {
+		c->sb_dropped = TRUE;
+		return;
+	}
+	if ( c->sb_len >= c->sb_cap ) {
+		cap = c->sb_cap > 0 ? c->sb_cap * 2 : 64;
+		if ( ( grown = realloc( c->sb, cap ) ) == NULL ) {
+			c->sb_dropped = TRUE;
+			return;
+		}
+		c->sb = grown;
+		c->sb_cap = cap;
+	}
+	c->sb[c->sb_len++] = b;
+}
+
+static void input_byte( INPUT_CONN *c, unsigned char b ) {
+	switch ( c->state ) {
+	case IN_DATA:
+		if ( b == IAC )
+			c->state = IN_IAC;
+		else
+			input_text( c, b );
+		break;
+
+	case IN_IAC:
+		c->state = IN_DATA;
+		switch ( b ) {
+		case IAC:
+			input_text( c, b );
+			break;
+		case WILL:
+		case WONT:
+		case DO:
+		case DONT:
+			c->cmd = b;
+			c->state = IN_CMD;
+			break;
+		case SB:
+			c->state = IN_SB_OPT;
+			break;
+		default:
+			break;	/* NOP, GA, AYT, a stray SE ... */
+		}
+		break;
+
+	case IN_CMD:
+		input_push( c, INPUT_EV_OPTION, c->cmd, b, NULL, 0, FALSE );
+		c->state = IN_DATA;
+		break;
+
+	case IN_SB_OPT:
+		c->opt = b;
+		c->sb_len = 0;
+		c->sb_dropped = FALSE;
+		c->state = IN_SB;
+		break;
+
+	case IN_SB:
+		if ( b == IAC )
+			c->state = IN_SB_IAC;
+		else
+			input_sb_add( c, b );
+		break;
+
+	case IN_SB_IAC:
+		if ( b == SE ) {
+			if ( !c->sb_dropped )
+				input_push( c, INPUT_EV_SUBNEG, 0, c->opt, c->sb ? (void *) c->sb : (void *) "", c->sb_len, FALSE );
+			c->state = IN_DATA;
+		} else if ( b == IAC ) {
+			/* Escaped 255: handlers unescape their own payloads */
+			input_sb_add( c, IAC );
+			input_sb_add( c, IAC );
+			c->state = IN_SB;
+		} else {
+			/* Any other command ends an unterminated subnegotiation, which is dropped */
+			c->state = IN_IAC;
+			input_byte( c, b );
+		}
+		break;
+	}
+}
+
+void input_feed( INPUT_CONN *c, const unsigned char *buf, int len ) {
+	int i;
+
+	for ( i = 0; i < len && !c->done; i++ )
+		input_byte( c, buf[i] );
+}
+
+void input_pump( INPUT_CONN *c ) {
+	unsigned char buf[4096];
+	int total = 0;
+	int n;
+
+	while ( !c->done && total < INPUT_PUMP_MAX ) {
+#if !defined( WIN32 )
+		n = (int) read( c->fd, buf, sizeof( buf ) );
+#else
+		n = recv( c->fd, (char *) buf, sizeof( buf ), 0 );
+#endif
+		if ( n > 0 ) {
+			total += n;
+			input_stats.bytes += n;
+			input_feed( c, buf, n );
+			continue;
+		}
+		if ( n < 0 ) {
+#if !defined( WIN32 )
+			if ( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR )
+				break;
+#else
+			if ( WSAGetLastError() == WSAEWOULDBLOCK )
+				break;
+#endif
+		}
+		input_push( c, INPUT_EV_CLOSED, 0, 0, NULL, 0, FALSE );
+	}
+}
+
+
+/*
+ * Connections
+ */
+INPUT_CONN *input_open( int fd ) {
+	INPUT_CONN *c;
+
+	input_init();
+	c = calloc( 1, sizeof( *c ) );
+	if ( c == NULL ) {
+		bug( "input_open: calloc failed", 0 );
+		return NULL;
+	}
+	c->fd = fd;
+	c->state = IN_DATA;
+
+	pthread_mutex_lock( &input_lock );
+	c->next = input_conns;
+	input_conns = c;
+	pthread_mutex_unlock( &input_lock );
+	return c;
+}
+
+void input_close( INPUT_CONN *c ) {
+	INPUT_CONN **prev;
+
+	if ( c == NULL )
+		return;
+
+	pthread_mutex_lock( &input_lock );
+	for ( prev = &input_conns; *prev != NULL; prev = &( *prev )->next ) {
+		if ( *prev == c ) {
+			*prev = c->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock( &input_lock );
+
+	while ( input_front( c ) != NULL )
+		input_pop( c );
+	free( c->sb );
+	free( c );
+}
+
+
+/*
+ * I/O thread
+ */
+static void *input_thread( void *arg ) {
+	struct timeval tv;
+	fd_set in_set;
+	INPUT_CONN *c;
+	int maxfd, ready;
+
+	(void) arg;
+	pthread_mutex_lock( &input_lock );
+	while ( !input_stopping ) {
+		FD_ZERO( &in_set );
+		maxfd = -1;
+		for ( c = input_conns; c != NULL; c = c->next ) {
+			if ( c->fd < 0 || c->done )
+				continue;
+			FD_SET( c->fd, &in_set );
+			maxfd = UMAX( maxfd, c->fd );
+		}
+		pthread_mutex_unlock( &input_lock );
+
+		/* A socket closed since the snapshot makes select() fail; just go round */
+		tv.tv_sec = 0;
+		tv.tv_usec = INPUT_POLL_USEC;
+		ready = 0;
+		if ( maxfd >= 0 )
+			ready = select( maxfd + 1, &in_set, NULL, NULL, &tv );
+		else {
+#if defined( WIN32 )
+			Sleep( INPUT_POLL_USEC / 1000 );
+#else
+			select( 0, NULL, NULL, NULL, &tv );
+#endif
+		}
+
+		pthread_mutex_lock( &input_lock );
+		if ( ready <= 0 )
+			continue;
+		for ( c = input_conns; c != NULL; c = c->next ) {
+			if ( c->fd >= 0 && !c->done && FD_ISSET( c->fd, &in_set ) )
+				input_pump( c );
+		}
+	}
+	input_running = FALSE;
+	pthread_cond_broadcast( &input_stopped );
+	pthread_mutex_unlock( &input_lock );
+	return NULL;
+}
+
+void input_start( void ) {
+	pthread_t thread;
+	pthread_attr_t attr;
+
+	input_init();
+	if ( input_running )
+		return;
+
+	input_stopping = FALSE;
+	input_running = TRUE;
+	pthread_attr_init( &attr );
+	pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+	if ( pthread_create( &thread, &attr, input_thread, NULL ) != 0 ) {
+		bug( "input_start: cannot start I/O thread; reading on the game thread.", 0 );
+		input_running = FALSE;
+	}
+}
+
+void input_stop( void ) {
+	if ( !input_running )
+		return;
+
+	pthread_mutex_lock( &input_lock );
+	input_stopping = TRUE;
+	while ( input_running )
+		pthread_cond_wait( &input_stopped, &input_lock );
+	input_stopping = FALSE;
+	pthread_mutex_unlock( &input_lock );
+}
+
+bool input_threaded( void ) {
+	return input_running;
+}
+
+void input_get_stats( INPUT_STATS *stats ) {
+	input_init();
+	pthread_mutex_lock( &input_lock );
+	*stats = input_stats;
+	pthread_mutex_unlock( &input_lock );
+	stats->threaded = input_running;
+}
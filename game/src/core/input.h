@@ -0,0 +1,85 @@
+/***************************************************************************
+ *  input.h - Socket reads and telnet parsing off the game thread
+ *
+ *  Every descriptor has an INPUT_CONN.  A single I/O thread waits on all
+ *  client sockets, reads whatever arrives and runs it through an
+ *  incremental telnet parser: IAC commands and subnegotiations are
+ *  recognised across packet boundaries, lines are split and cleaned
+ *  (backspace, UTF-8 validation, length limit) as bytes come in.  What
+ *  comes out is a stream of events -- a finished command line, a
+ *  WILL/WONT/DO/DONT, a complete subnegotiation -- pushed onto the
+ *  connection's single-producer single-consumer ring.  The game loop
+ *  pops events in order and never touches the socket or a raw byte.
+ *
+ *  The ring is the flood limit: a client that gets INPUT_QUEUE_SIZE - 1
+ *  events ahead of the game is sent INPUT_EV_FLOOD and no more is read.
+ *  Subnegotiations longer than INPUT_SUBNEG_MAX are discarded whole.
+ *
+ *  Without input_start() (tests, or if the thread cannot be created)
+ *  the game thread calls input_pump() on readable sockets itself and
+ *  everything else behaves the same.
+ ***************************************************************************/
+
+#ifndef INPUT_H
+#define INPUT_H
+
+/* Events per connection, one of them reserved for FLOOD/CLOSED; power of two */
+#define INPUT_QUEUE_SIZE 256
+
+/* Longest subnegotiation kept, IAC escapes included */
+#define INPUT_SUBNEG_MAX 8192
+
+enum {
+	INPUT_EV_LINE,	   /* data: command line, NUL-terminated */
+	INPUT_EV_OPTION,   /* cmd (WILL/WONT/DO/DONT) for opt */
+	INPUT_EV_SUBNEG,   /* data: payload between IAC SB opt and IAC SE, still escaped */
+	INPUT_EV_FLOOD,	   /* Queue overran; nothing further is read */
+	INPUT_EV_CLOSED	   /* EOF or read error */
+};
+
+typedef struct input_event {
+	int type;
+	int cmd;
+	int opt;
+	int len;		   /* LINE, SUBNEG: bytes in data, not counting the NUL */
+	bool truncated;	   /* LINE: cut at MAX_INPUT_LENGTH - 2 */
+	char *data;		   /* LINE, SUBNEG: owned by the queue until popped */
+} INPUT_EVENT;
+
+typedef struct input_conn INPUT_CONN;
+
+typedef struct input_stats {
+	long bytes;		   /* Read from sockets */
+	long events;	   /* Pushed onto rings */
+	long floods;	   /* Connections cut off by a full ring */
+	bool threaded;	   /* FALSE: the game thread pumps sockets itself */
+} INPUT_STATS;
+
+/* Connection for socket fd (-1 for one fed only by input_feed()) */
+INPUT_CONN *input_open( int fd );
+
+/* Stop reading c and free it with anything still queued.  Before close(fd). */
+void input_close( INPUT_CONN *c );
+
+void input_start( void );
+void input_stop( void );
+bool input_threaded( void );
+void input_get_stats( INPUT_STATS *stats );
+
+/*
+ * Producer side: the I/O thread, or the game thread when not threaded.
+ * input_pump() reads everything available on the socket; input_feed()
+ * parses bytes from anywhere else.
+ */
+void input_pump( INPUT_CONN *c );
+void input_feed( INPUT_CONN *c, const unsigned char *buf, int len );
+
+/*
+ * Consumer side: the game thread only.  input_front() returns the oldest
+ * event, or NULL when the ring is empty; it stays queued until
+ * input_pop(), so a line can be left waiting while a character is lagged.
+ */
+INPUT_EVENT *input_front( INPUT_CONN *c );
+void input_pop( INPUT_CONN *c );
+
+#endif /* INPUT_H */
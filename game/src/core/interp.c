@@ -30,6 +30,7 @@
 #include "../db/db_quest.h"
 #include "../systems/quest_new.h"
 #include "../systems/profile.h"
+#include "../systems/capture.h"
 
 bool check_social ( CHAR_DATA * ch, char *command,
 	char *argument );
@@ -358,6 +359,7 @@ const struct cmd_type cmd_table[] =
 		{ "setstance", do_setstance, POS_STANDING, 0, LOG_NORMAL, 0, 0, 0 },
 		{ "mudstat", do_mudstat, POS_DEAD, 2, LOG_NORMAL, 0, 0, 0 },
 		{ "profile", do_profile, POS_DEAD, 10, LOG_ALWAYS, 0, 0, 0 },
+		{ "capture", do_capture, POS_DEAD, 10, LOG_ALWAYS, 0, 0, 0 },
 		{ "level", do_level, POS_FIGHTING, 0, LOG_NORMAL, 0, 0, 0 },
 		{ "top", do_top, POS_FIGHTING, 0, LOG_NORMAL, 0, 0, 0 },
 		{ "topclear", do_topclear, POS_DEAD, 12, LOG_NORMAL, 0, 0, 0 },
@@ -1470,6 +1472,13 @@ const struct cmd_type cmd_table[] =
 		 */
 		{ "", 0, POS_DEAD, 0, LOG_NORMAL, 0, 0, 0 } };
 
+/*
+ * What input capture records for a line that resolved to cmd.
+ */
+static const char *capture_line( int cmd, const char *logline ) {
+	return cmd_table[cmd].log == LOG_NEVER ? cmd_table[cmd].name : logline;
+}
+
 /*
  * The main entry point for executing commands.
  * Can be recursively called from 'at', 'order', 'force'.
@@ -1487,7 +1496,9 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 	int col = 0;
 	int star = 0;
 	char cmd_copy[MAX_INPUT_LENGTH];
+	bool captured;
 
+	captured = capture_claim( ch );
 	if ( !ch || !ch->in_room ) return;
 
 	snprintf( argu, sizeof( argu ), "%s %s", arg, one_argument( argument, arg ) );
@@ -1506,6 +1517,8 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 	 * Implement freeze command.
 	 */
 	if ( !IS_NPC( ch ) && IS_SET( ch->act, PLR_FREEZE ) ) {
+		if ( captured )
+			capture_command( ch, argument );
 		send_to_char( "You can't do anything while crying like a bitch!\n\r", ch );
 		return;
 	}
@@ -1557,6 +1570,8 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 		if ( !foundstar ) {
 			stc( "No commands found.\n\r", ch );
 		}
+		if ( captured )
+			capture_command( ch, logline );
 		return;
 	}
 
@@ -1569,6 +1584,9 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 		LIST_FOR_EACH( ali, &ch->pcdata->aliases, ALIAS_DATA, node ) {
 			if ( !str_cmp( command, ali->short_n ) ) {
 				snprintf( buf, sizeof( buf ), "%s %s", ali->long_n, argument );
+				/* The expansion is recorded, redacted as it needs */
+				if ( captured )
+					capture_expect( ch->desc );
 				interpret( ch, buf );
 				return;
 			}
@@ -1600,6 +1618,8 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 					  !str_cmp( cmd_table[cmd].name, "humanform" ) ) )
 					found = TRUE;
 				else {
+					if ( captured )
+						capture_command( ch, capture_line( cmd, logline ) );
 					send_to_char( "Not without a body!\n\r", ch );
 					return;
 				}
@@ -1607,6 +1627,8 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 				if ( is_cmd_in_list( cmd_table[cmd].name, cmd_allow_earthmeld, cmd_allow_earthmeld_count ) )
 					found = TRUE;
 				else {
+					if ( captured )
+						capture_command( ch, capture_line( cmd, logline ) );
 					send_to_char( "Not while in the ground.\n\r", ch );
 					return;
 				}
@@ -1617,6 +1639,8 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 				else if ( ch->embracing != NULL && !str_cmp( cmd_table[cmd].name, "diablerize" ) )
 					found = TRUE;
 				else {
+					if ( captured )
+						capture_command( ch, capture_line( cmd, logline ) );
 					send_to_char( "Not while in an embrace.\n\r", ch );
 					return;
 				}
@@ -1624,6 +1648,8 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 				if ( is_cmd_in_list( cmd_table[cmd].name, cmd_allow_tied, cmd_allow_tied_count ) )
 					found = TRUE;
 				else {
+					if ( captured )
+						capture_command( ch, capture_line( cmd, logline ) );
 					send_to_char( "Not while tied up.\n\r", ch );
 					if ( ch->position > POS_STUNNED )
 						act( "$n strains against $s bonds.", ch, NULL, NULL, TO_ROOM );
@@ -1640,6 +1666,8 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 	 */
 	if ( cmd_table[cmd].log == LOG_NEVER )
 		strcpy( logline, "XXXXXXXX XXXXXXXX XXXXXXXX" );
+	if ( captured )
+		capture_command( ch, capture_line( cmd, logline ) );
 	if ( ( !IS_NPC( ch ) && IS_SET( ch->act, PLR_LOG ) ) || fLogAll || cmd_table[cmd].log == LOG_ALWAYS ) {
 		if ( !IS_CREATOR( ch ) && !IS_NPC( ch ) ) {
 			snprintf( log_buf, MAX_STRING_LENGTH, "Log %s: %s", ch->pcdata->switchname, logline );
@@ -1732,7 +1760,7 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 
 	/* Profile command execution and log slow commands */
 	{
-		struct timeval cmd_start, cmd_end;
+		int64_t cmd_start = 0;
 		bool was_profiling = profile_stats.enabled;
 		char cmd_player_name[MAX_INPUT_LENGTH];
 
@@ -1742,12 +1770,14 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 				IS_NPC(ch) ? ch->short_descr : ch->name,
 				sizeof( cmd_player_name ) - 1 );
 			cmd_player_name[sizeof( cmd_player_name ) - 1] = '\0';
-			gettimeofday( &cmd_start, NULL );
+			cmd_start = profile_now_ns();
 		}
 
-		PROFILE_START("cmd_dispatch");
+		PROFILE_START( PROF_CMD_DISPATCH );
+		profile_current_cmd = cmd;
 		( *cmd_table[cmd].do_fun )( ch, argument );
-		PROFILE_END("cmd_dispatch");
+		profile_current_cmd = -1;
+		PROFILE_END( PROF_CMD_DISPATCH );
 
 		/* Quest system: track command usage + milestone re-check */
 		if ( ch->desc ) {
@@ -1762,16 +1792,13 @@ void interpret( CHAR_DATA *ch, char *argument ) {
 					}
 				}
 			}
-			quest_check_progress( ch, QOBJ_USE_COMMAND, cmd_name, 1 );
+			quest_check_progress( ch, QOT_USE_COMMAND, cmd_name, 1 );
 			quest_check_milestones( ch );
 		}
 
 		/* Only check timing if profiling was enabled BEFORE command ran */
 		if ( was_profiling ) {
-			long elapsed_us;
-			gettimeofday( &cmd_end, NULL );
-			elapsed_us = ( cmd_end.tv_sec - cmd_start.tv_sec ) * 1000000
-			           + ( cmd_end.tv_usec - cmd_start.tv_usec );
+			long elapsed_us = (long) ( ( profile_now_ns() - cmd_start ) / 1000 );
 			if ( elapsed_us > PROFILE_CMD_THRESHOLD_US ) {
 				snprintf( log_buf, MAX_STRING_LENGTH, "SLOW CMD: %s by %s took %ldms",
 					cmd_table[cmd].name, cmd_player_name,
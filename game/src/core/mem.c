@@ -30,6 +30,9 @@
 #include <string.h>
 #include <time.h>
 #include "merc.h"
+#include "../world/map_layout.h"
+#include "../world/pathfind.h"
+#include "../world/room_render.h"
 
 /*
  * Globals — allocation counters for statistics
@@ -172,6 +175,9 @@ void free_room_index( ROOM_INDEX_DATA *pRoom ) {
 
 	free(pRoom->name);
 	free(pRoom->description);
+	room_render_free( pRoom );
+	map_layout_invalidate();
+	path_invalidate();
 
 	if ( pRoom->dynamic ) {
 		for ( door = 0; door < 5; door++ )
@@ -252,6 +258,7 @@ OBJ_INDEX_DATA *new_obj_index( void ) {
 
 	list_init( &pObj->affects );
 	list_init( &pObj->extra_descr );
+	list_init( &pObj->instances );
 	pObj->name = str_dup( "no name" );
 	pObj->short_descr = str_dup( "(no short description)" );
 	pObj->description = str_dup( "(no description)" );
@@ -295,6 +302,7 @@ MOB_INDEX_DATA *new_mob_index( void ) {
 	}
 	top_mob_index++;
 
+	list_init( &pMob->instances );
 	pMob->player_name = str_dup( "no name" );
 	pMob->short_descr = str_dup( "(no short description)" );
 	pMob->long_descr = str_dup( "(no long description)\n\r" );
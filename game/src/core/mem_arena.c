@@ -0,0 +1,92 @@
+/***************************************************************************
+ *  mem_arena.c - Bump allocator for short-lived scratch data              *
+ ***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "merc.h"
+#include "mem_arena.h"
+
+#define MEM_ARENA_ALIGN 16
+
+struct mem_arena_block {
+	MEM_ARENA_BLOCK *next;
+	size_t           size;      /* Usable bytes in data[] */
+	size_t           pos;
+	/* Keep data[] aligned on every platform */
+	union { long double ld; void *p; long long ll; } data[1];
+};
+
+static MEM_ARENA_BLOCK *mem_arena_new_block( size_t size ) {
+	MEM_ARENA_BLOCK *block;
+
+	block = malloc( offsetof( MEM_ARENA_BLOCK, data ) + size );
+	if ( block == NULL ) {
+		bug( "mem_arena_new_block: malloc failed", 0 );
+		exit( 1 );
+	}
+	block->next = NULL;
+	block->size = size;
+	block->pos  = 0;
+	return block;
+}
+
+void *mem_arena_alloc( MEM_ARENA *arena, size_t size ) {
+	MEM_ARENA_BLOCK *block = arena->current;
+	MEM_ARENA_BLOCK *fresh;
+	char *p;
+
+	size = ( size + MEM_ARENA_ALIGN - 1 ) & ~(size_t) ( MEM_ARENA_ALIGN - 1 );
+	if ( size == 0 )
+		size = MEM_ARENA_ALIGN;
+
+	/* Move on to a kept block, or chain a new one big enough */
+	while ( block == NULL || block->pos + size > block->size ) {
+		if ( block != NULL && block->next != NULL ) {
+			block = block->next;
+			block->pos = 0;
+			continue;
+		}
+		fresh = mem_arena_new_block(
+			size > MEM_ARENA_BLOCK_SIZE ? size : MEM_ARENA_BLOCK_SIZE );
+		if ( block == NULL )
+			arena->first = fresh;
+		else
+			block->next = fresh;
+		block = fresh;
+	}
+
+	arena->current = block;
+	p = (char *) block->data + block->pos;
+	block->pos += size;
+	arena->used += size;
+	return p;
+}
+
+char *mem_arena_strdup( MEM_ARENA *arena, const char *str ) {
+	size_t len = str ? strlen( str ) : 0;
+	char *copy = mem_arena_alloc( arena, len + 1 );
+
+	if ( len > 0 )
+		memcpy( copy, str, len );
+	copy[len] = '\0';
+	return copy;
+}
+
+void mem_arena_reset( MEM_ARENA *arena ) {
+	arena->current = arena->first;
+	if ( arena->first != NULL )
+		arena->first->pos = 0;
+	arena->used = 0;
+}
+
+void mem_arena_free( MEM_ARENA *arena ) {
+	MEM_ARENA_BLOCK *block, *next;
+
+	for ( block = arena->first; block != NULL; block = next ) {
+		next = block->next;
+		free( block );
+	}
+	arena->first = arena->current = NULL;
+	arena->used = 0;
+}
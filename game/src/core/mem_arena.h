@@ -0,0 +1,44 @@
+/*
+ * mem_arena.h — Bump allocator for short-lived scratch data
+ *
+ * Allocations are carved from large blocks and never freed one by one;
+ * mem_arena_reset() forgets everything at once and keeps the blocks for
+ * the next use.  Suited to building a reply or a table that is thrown
+ * away when the command finishes, where per-string malloc/free would
+ * dominate.
+ *
+ * Usage:
+ *   static MEM_ARENA scratch;
+ *
+ *   mem_arena_reset( &scratch );
+ *   line = mem_arena_strdup( &scratch, text );
+ *   ...
+ *   (no frees; the next reset reuses the memory)
+ */
+
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#include <stddef.h>
+
+#define MEM_ARENA_BLOCK_SIZE 16384
+
+typedef struct mem_arena_block MEM_ARENA_BLOCK;
+
+typedef struct mem_arena {
+	MEM_ARENA_BLOCK *first;     /* All blocks, oldest first */
+	MEM_ARENA_BLOCK *current;   /* Block being carved */
+	size_t           used;      /* Bytes handed out since the last reset */
+} MEM_ARENA;
+
+/* Aligned for any type; exits on out-of-memory like the rest of the game */
+void *mem_arena_alloc( MEM_ARENA *arena, size_t size );
+char *mem_arena_strdup( MEM_ARENA *arena, const char *str );
+
+/* Release every allocation but keep the blocks */
+void mem_arena_reset( MEM_ARENA *arena );
+
+/* Return the blocks to the system */
+void mem_arena_free( MEM_ARENA *arena );
+
+#endif /* MEM_ARENA_H */
@@ -99,6 +99,7 @@ typedef unsigned char bool;
 #define TO_VICT	   2
 #define TO_CHAR	   3
 #define TO_ALL	   4
+#define TO_NOTVICT_HIT 5 /* TO_NOTVICT less onlookers taking round summaries (combatsum.h) */
 
 /*
  * Structure for a command in the command lookup table.
@@ -14,6 +14,7 @@
 #include "../systems/ttype.h"
 #include "../systems/charset.h"
 #include "../systems/quest_new.h"
+#include "../systems/textfilter.h"
 
 /* External variables from comm.c */
 extern char echo_off_str[];
@@ -958,45 +959,12 @@ bool check_parse_name( char *name ) {
 	}
 
 	/*
-	 * 5. Forbidden names (database-driven).
+	 * 5. Forbidden names + 6. Profanity (database-driven), with
+	 * confusable-character detection: the name is skeletonized (Unicode
+	 * lookalikes -> ASCII canonical) and every rule checked in one pass.
 	 */
-	{
-		FORBIDDEN_NAME *fn;
-
-		LIST_FOR_EACH( fn, &forbidden_name_list, FORBIDDEN_NAME, node ) {
-			switch ( fn->type ) {
-			case NAMETYPE_RESERVED:
-			case NAMETYPE_BLOCKED:
-				/* Exact match (case-insensitive) */
-				if ( !str_cmp( name, fn->name ) )
-					return FALSE;
-				break;
-			case NAMETYPE_PROTECTED:
-				/* Contains but not exact match */
-				if ( is_contained( fn->name, name )
-					&& str_cmp( name, fn->name ) )
-					return FALSE;
-				break;
-			}
-		}
-	}
-
-	/*
-	 * 6. Profanity check with confusable-character detection.
-	 * Skeletonize the name (Unicode lookalikes -> ASCII canonical)
-	 * then check against profanity filter patterns.
-	 */
-	{
-		char skeleton[256];
-		PROFANITY_FILTER *pf;
-
-		utf8_skeletonize( name, skeleton, sizeof( skeleton ) );
-
-		LIST_FOR_EACH( pf, &profanity_filter_list, PROFANITY_FILTER, node ) {
-			if ( is_contained( pf->pattern, skeleton ) )
-				return FALSE;
-		}
-	}
+	if ( textfilter_name_blocked( name ) )
+		return FALSE;
 
 	/*
 	 * 7. Lock out IllIll twits (ASCII names only).
@@ -68,8 +68,7 @@ struct descriptor_data {
 	int lookup_status;
 	bool fcommand;
 	bool vt102;
-	char inbuf[4 * MAX_INPUT_LENGTH];
-	int  inbuf_len; /* Actual byte count in inbuf (not NUL-terminated for binary telnet data) */
+	struct input_conn *input; /* Parsed input queued by the I/O thread (input.h) */
 	char incomm[MAX_INPUT_LENGTH];
 	char inlast[MAX_INPUT_LENGTH];
 	int repeat;
@@ -78,6 +77,9 @@ struct descriptor_data {
 	char *outbuf;
 	int outsize;
 	int outtop;
+	PROMPT_CACHE *prompt_cache; /* Last prompt sent, replayed if unchanged (prompt.h) */
+	MCMP_QUEUE *media_queue;    /* Sounds waiting for the end of the pulse (mcmp.h) */
+	int capture_id;             /* Session in the input capture, 0 = none (capture.h) */
 	void *pEdit;	/* OLC */
 	char **pString; /* OLC */
 	int editor;		/* OLC */
@@ -91,6 +93,7 @@ struct descriptor_data {
 	char discord_user[128]; /* Discord username from External.Discord.Hello */
 	/* mxp: MUD eXtension Protocol support */
 	bool mxp_enabled; /* MXP negotiation successful */
+	bool mxp_elements; /* Custom link elements sent (mxpStart) */
 	/* naws: window size support (RFC 1073) */
 	bool naws_enabled; /* NAWS negotiation successful */
 	int client_width;  /* Terminal width in columns */
@@ -381,7 +381,8 @@ struct obj_index_data {
 	OBJ_INDEX_DATA *next;
 	list_head_t extra_descr;
 	list_head_t affects;
-	list_head_t scripts;      /* Lua scripts (future use) */
+	list_head_t scripts;      /* Lua scripts attached to this object template */
+	uint32_t script_trigs;    /* OR of all scripts' TRIG_* bits */
 	AREA_DATA *area; /* OLC */
 	char *name;
 	char *short_descr;
@@ -400,6 +401,7 @@ struct obj_index_data {
 	uint32_t extra_flags2;
 	uint32_t wear_flags;
 	int count;
+	list_head_t instances;    /* Live objects of this template, via proto_node */
 	int weight;
 	uint32_t weapflags;
 	int spectype;
@@ -420,6 +422,8 @@ struct obj_data {
 	list_node_t obj_node;
 	list_node_t room_node;
 	list_node_t content_node;
+	list_node_t script_node;  /* carried TRIG_TICK objects (script_trigger.c) */
+	list_node_t proto_node;   /* pIndexData->instances */
 	list_head_t contents;
 	OBJ_DATA *in_obj;
 	CHAR_DATA *carried_by;
@@ -457,6 +461,8 @@ struct obj_data {
 	int level;
 	int timer;
 	int value[4];
+	char *mxp_hint;           /* Escaped MXP tooltip, valid while mxp_hint_sig matches */
+	uint32_t mxp_hint_sig;
 };
 /*
  * Object Macros.
@@ -5,6 +5,7 @@
 
 #include "merc.h"
 #include "utf8.h"
+#include "../systems/combatsum.h"
 
 /*
  * Test output capture: intercepts raw output for a specific character
@@ -230,6 +231,7 @@ void act( const char *format, CHAR_DATA *ch, const void *arg1, const void *arg2,
 		if ( type == TO_VICT && ( to != vch || to == ch ) ) continue;
 		if ( type == TO_ROOM && to == ch ) continue;
 		if ( type == TO_NOTVICT && ( to == ch || to == vch ) ) continue;
+		if ( type == TO_NOTVICT_HIT && ( to == ch || to == vch || combatsum_wants( to ) ) ) continue;
 		if ( to->desc == NULL && IS_NPC( to ) && ( wizard = to->wizard ) != NULL ) {
 			if ( !IS_NPC( wizard ) && ( ( familiar = wizard->pcdata->familiar ) != NULL ) && familiar == to ) {
 				if ( to->in_room == ch->in_room &&
@@ -4,6 +4,8 @@
  ***************************************************************************/
 
 #include "merc.h"
+#include "class_ops.h"
+#include "prompt.h"
 
 void bust_a_header( DESCRIPTOR_DATA *d ) {
 	/* Disabled - header bar no longer used */
@@ -12,17 +14,387 @@ void bust_a_header( DESCRIPTOR_DATA *d ) {
 /*
  * Bust a prompt (player settable prompt)
  * coded by Morgenes for Aldara Mud
+ *
+ * The prompt string is compiled once into ops (see prompt.h).  Each flush
+ * reads the fields the ops name, and replays the last translated prompt
+ * if none of them, nor the descriptor's colour settings, have changed.
  */
-void bust_a_prompt( DESCRIPTOR_DATA *d ) {
-	CHAR_DATA *ch;
+
+/* Fields past this many in one prompt are dropped */
+#define PROMPT_MAX_CODES 64
+
+/* Room for one class code's text, e.g. "#C1234#n" */
+#define PROMPT_CLASS_TEXT 64
+
+typedef struct prompt_op {
+	char code;			/* The %code, or 0 for a literal run */
+	int len;			/* Literal length */
+	const char *text;	/* Literal, inside prog->text */
+} PROMPT_OP;
+
+struct prompt_prog {
+	const char *src;	/* The pcdata string compiled from */
+	unsigned serial;	/* Told apart from a freed program at the same address */
+	int nops;
+	PROMPT_OP *ops;
+	char *text;			/* Literal runs, back to back */
+};
+
+/* What one op read from the character; prompt_format() turns it into text */
+typedef struct prompt_val {
+	int a;
+	int b;
+	const char *s;
+} PROMPT_VAL;
+
+struct prompt_cache {
+	bool valid;
+	unsigned serial;	/* Program the bytes came from */
+	uint64_t key;		/* Field values and colour settings they were built with */
+	int len;
+	int size;
+	char *bytes;		/* Already translated by write_translate() */
+};
+
+static unsigned prompt_serial;
+static long prompt_hits;
+static long prompt_misses;
+
+void prompt_cache_get_stats( long *hits, long *misses ) {
+	*hits = prompt_hits;
+	*misses = prompt_misses;
+}
+
+static bool prompt_code_known( int code ) {
+	return code != '\0' && strchr( "hHmMvVxgqfFnNaAtrkERGiIdDBbcpPsOl", code ) != NULL;
+}
+
+PROMPT_PROG *prompt_compile( const char *src ) {
+	PROMPT_OP ops[PROMPT_MAX_CODES * 2 + 1];
+	PROMPT_PROG *prog;
+	const char *s;
+	char *t, *lit;
+	int nops = 0, ncodes = 0;
+
+	if ( src == NULL )
+		src = "";
+
+	prog = calloc( 1, sizeof( *prog ) );
+	if ( prog == NULL ) {
+		bug( "prompt_compile: calloc failed", 0 );
+		exit( 1 );
+	}
+	/* Every code takes two bytes and leaves at most one literal byte */
+	prog->text = malloc( strlen( src ) + 1 );
+	if ( prog->text == NULL ) {
+		bug( "prompt_compile: malloc failed", 0 );
+		exit( 1 );
+	}
+	prog->src = src;
+	prog->serial = ++prompt_serial;
+
+	t = lit = prog->text;
+	for ( s = src; *s != '\0'; s++ ) {
+		if ( *s != '%' ) {
+			*t++ = *s;
+			continue;
+		}
+		if ( *++s == '\0' ) {
+			/* A trailing % showed as a blank */
+			*t++ = ' ';
+			break;
+		}
+		if ( !prompt_code_known( *s ) ) {
+			*t++ = ( *s == '%' ) ? '%' : ' ';
+			continue;
+		}
+		if ( ncodes == PROMPT_MAX_CODES )
+			break;
+		if ( t > lit ) {
+			ops[nops].code = '\0';
+			ops[nops].len = (int) ( t - lit );
+			ops[nops++].text = lit;
+		}
+		ops[nops].code = *s;
+		ops[nops].len = 0;
+		ops[nops++].text = NULL;
+		ncodes++;
+		lit = t;
+	}
+	if ( t > lit ) {
+		ops[nops].code = '\0';
+		ops[nops].len = (int) ( t - lit );
+		ops[nops++].text = lit;
+	}
+	*t = '\0';
+
+	prog->nops = nops;
+	prog->ops = calloc( nops > 0 ? nops : 1, sizeof( PROMPT_OP ) );
+	if ( prog->ops == NULL ) {
+		bug( "prompt_compile: calloc failed", 0 );
+		exit( 1 );
+	}
+	memcpy( prog->ops, ops, nops * sizeof( PROMPT_OP ) );
+	return prog;
+}
+
+void prompt_free( PROMPT_PROG *prog ) {
+	if ( prog == NULL )
+		return;
+	free( prog->ops );
+	free( prog->text );
+	free( prog );
+}
+
+/* Call whenever pcdata->prompt or ->cprompt is replaced */
+void prompt_recompile( CHAR_DATA *ch ) {
+	if ( IS_NPC( ch ) || ch->pcdata == NULL )
+		return;
+	prompt_free( ch->pcdata->prompt_prog );
+	prompt_free( ch->pcdata->cprompt_prog );
+	ch->pcdata->prompt_prog = prompt_compile( ch->pcdata->prompt );
+	ch->pcdata->cprompt_prog = prompt_compile( ch->pcdata->cprompt );
+}
+
+void prompt_cache_free( DESCRIPTOR_DATA *d ) {
+	if ( d->prompt_cache == NULL )
+		return;
+	free( d->prompt_cache->bytes );
+	free( d->prompt_cache );
+	d->prompt_cache = NULL;
+}
+
+/* Compiled program for src, recompiling if src was replaced without telling us */
+static PROMPT_PROG *prompt_prog_get( PROMPT_PROG **pprog, const char *src ) {
+	if ( *pprog == NULL || ( *pprog )->src != src ) {
+		prompt_free( *pprog );
+		*pprog = prompt_compile( src );
+	}
+	return *pprog;
+}
+
+/* 0 for no one, else 1 (awful) to 5 (perfect) */
+static int prompt_condition( CHAR_DATA *victim ) {
+	int pct;
+
+	if ( victim == NULL )
+		return 0;
+	pct = victim->hit * 100 / victim->max_hit;
+	if ( pct < 25 ) return 1;
+	if ( pct < 50 ) return 2;
+	if ( pct < 75 ) return 3;
+	if ( pct < 100 ) return 4;
+	return 5;
+}
+
+static const char *prompt_name( CHAR_DATA *victim ) {
+	if ( IS_AFFECTED( victim, AFF_POLYMORPH ) )
+		return victim->morph;
+	if ( IS_NPC( victim ) )
+		return victim->short_descr;
+	return victim->name;
+}
+
+static bool prompt_stage_ready( CHAR_DATA *victim ) {
+	return !IS_NPC( victim ) && victim->pcdata->stage[1] > 0
+		&& victim->pcdata->stage[2] + 25 >= victim->pcdata->stage[1];
+}
+
+/*
+ * Read the field a code shows.  Class codes are rendered into scratch
+ * (len bytes) straight away, since only class_prompt() knows what they
+ * read.
+ */
+static void prompt_read( CHAR_DATA *ch, int code, PROMPT_VAL *v, char *scratch, size_t len ) {
 	CHAR_DATA *victim;
 	CHAR_DATA *tank;
-	const char *str;
-	const char *i;
-	char *point;
+
+	v->a = 0;
+	v->b = 0;
+	v->s = NULL;
+
+	switch ( code ) {
+	case 'h': v->a = ch->hit; v->b = ch->max_hit; break;
+	case 'H': v->a = ch->max_hit; break;
+	case 'm': v->a = ch->mana; v->b = ch->max_mana; break;
+	case 'M': v->a = ch->max_mana; break;
+	case 'v': v->a = ch->move; v->b = ch->max_move; break;
+	case 'V': v->a = ch->max_move; break;
+	case 'x': v->a = ch->exp; break;
+	case 'g': v->a = ch->gold; break;
+	case 'q': v->a = ch->pcdata->quest; break;
+	case 'A': v->a = ch->alignment; break;
+	case 't': v->a = ch->fight_timer; break;
+	case 'b': v->a = ch->beast; break;
+	case 'c': v->a = char_ac( ch ); break;
+	case 'p': v->a = char_hitroll( ch ); break;
+	case 'P': v->a = char_damroll( ch ); break;
+	case 'a': v->a = IS_GOOD( ch ) ? 0 : IS_EVIL( ch ) ? 1 : 2; break;
+	case 'f':
+		v->a = prompt_condition( ch->fighting );
+		break;
+	case 'F':
+		v->a = ( victim = ch->fighting ) != NULL ? prompt_condition( victim->fighting ) : 0;
+		break;
+	case 'n':
+		if ( ( victim = ch->fighting ) != NULL ) {
+			v->a = 1;
+			v->s = prompt_name( victim );
+		}
+		break;
+	case 'N':
+		if ( ( victim = ch->fighting ) == NULL || ( tank = victim->fighting ) == NULL )
+			break;
+		if ( ch == tank )
+			v->a = 1;
+		else {
+			/* Whether to use short_descr goes by the victim, as it always has */
+			v->a = 2;
+			if ( IS_AFFECTED( tank, AFF_POLYMORPH ) )
+				v->s = tank->morph;
+			else if ( IS_NPC( victim ) )
+				v->s = tank->short_descr;
+			else
+				v->s = tank->name;
+		}
+		break;
+	case 'r':
+		if ( ch->in_room != NULL ) {
+			v->a = 1;
+			v->s = ch->in_room->name;
+		}
+		break;
+	case 's':
+		v->a = !IS_NPC( ch ) && ch->pcdata->stage[2] + 25 >= ch->pcdata->stage[1] && ch->pcdata->stage[1] > 0;
+		break;
+	case 'O':
+		v->a = ( victim = ch->pcdata->partner ) != NULL && prompt_stage_ready( victim );
+		break;
+	case 'l':
+		if ( ( victim = ch->pcdata->partner ) != NULL ) {
+			v->a = 1;
+			v->s = prompt_name( victim );
+		}
+		break;
+	case 'k':
+	case 'E':
+		/* Class prompt codes: see class_ops.c */
+		if ( !class_prompt( ch, code, scratch, len ) )
+			snprintf( scratch, len, " " );
+		v->s = scratch;
+		break;
+	case 'R':
+	case 'G':
+	case 'i':
+	case 'I':
+	case 'd':
+	case 'D':
+	case 'B':
+		if ( !class_prompt( ch, code, scratch, len ) )
+			snprintf( scratch, len, "0" );
+		v->s = scratch;
+		break;
+	}
+}
+
+static uint64_t prompt_mix( uint64_t h, uint64_t x ) {
+	return ( h ^ x ) * 1099511628211ull;
+}
+
+static uint64_t prompt_mix_str( uint64_t h, const char *s ) {
+	if ( s == NULL )
+		return prompt_mix( h, 0xffffffffffffffffull );
+	for ( ; *s != '\0'; s++ )
+		h = prompt_mix( h, (unsigned char) *s );
+	return prompt_mix( h, 0x100 );
+}
+
+/* Text for one field, as bust_a_prompt() always printed it */
+static void prompt_format( int code, const PROMPT_VAL *v, char *buf, size_t len ) {
+	static const char *condition[] = {
+		"#CN/A#n", "#RAwful#n", "#LPoor#n", "#GFair#n", "#yGood#n", "#CPerfect#n"
+	};
+	static const char *align[] = { "good", "evil", "neutral" };
+	char xp_tmp[32];
+
+	switch ( code ) {
+	case 'h':
+	case 'm':
+	case 'v':
+		snprintf( buf, len, "%s%d#n", col_scale_code( v->a, v->b ), v->a );
+		break;
+	case 'H':
+	case 'M':
+	case 'V':
+	case 'g':
+	case 'q':
+	case 'A':
+	case 't':
+	case 'b':
+		snprintf( buf, len, "#C%d#n", v->a );
+		break;
+	case 'x':
+		add_commas_to_number( v->a, xp_tmp, sizeof( xp_tmp ) );
+		snprintf( buf, len, "%s%s#n", col_scale_code( v->a, 10000000 ), xp_tmp );
+		break;
+	case 'f':
+	case 'F':
+		snprintf( buf, len, "%s", condition[v->a] );
+		break;
+	case 'n':
+	case 'N':
+	case 'l':
+		if ( v->a == 0 )
+			snprintf( buf, len, "%s", code == 'l' ? "Nobody" : "N/A" );
+		else if ( code == 'N' && v->a == 1 )
+			snprintf( buf, len, "You" );
+		else {
+			snprintf( buf, len, "%s", v->s );
+			buf[0] = toupper( buf[0] );
+		}
+		break;
+	case 'a':
+		snprintf( buf, len, "#C%s#n", align[v->a] );
+		break;
+	case 'r':
+		if ( v->a )
+			snprintf( buf, len, "#C%s#n", v->s );
+		else
+			snprintf( buf, len, " " );
+		break;
+	case 'c':
+		snprintf( buf, len, "%d", v->a );
+		break;
+	case 'p':
+	case 'P':
+		snprintf( buf, len, "%s%d#n", col_scale_code( v->a, 200 ), v->a );
+		break;
+	case 's':
+	case 'O':
+		snprintf( buf, len, "%s", v->a ? "#Cyes#n" : "no" );
+		break;
+	default:
+		/* Class codes, already rendered by prompt_read() */
+		snprintf( buf, len, "%s", v->s );
+		break;
+	}
+}
+
+void bust_a_prompt( DESCRIPTOR_DATA *d ) {
+	static char out[MAX_STRING_LENGTH * 8];
+	CHAR_DATA *ch;
+	CHAR_DATA *wch;
+	PC_DATA *pc;
+	PROMPT_PROG *prog;
+	PROMPT_CACHE *pcache;
+	PROMPT_VAL vals[PROMPT_MAX_CODES];
+	char scratch[PROMPT_MAX_CODES][PROMPT_CLASS_TEXT];
 	char buf[MAX_STRING_LENGTH];
 	char buf2[MAX_STRING_LENGTH];
+	char *point;
+	uint64_t key;
 	bool is_fighting = TRUE;
+	int i, n, len;
 
 	if ( ( ch = d->character ) == NULL ) return;
 	if ( ch->pcdata == NULL ) {
@@ -40,290 +412,93 @@ void bust_a_prompt( DESCRIPTOR_DATA *d ) {
 		return;
 	}
 
-	point = buf;
+	wch = d->original ? d->original : d->character;
+	pc = wch->pcdata;
 	if ( ch->position == POS_FIGHTING && is_fighting )
-		str = d->original ? d->original->pcdata->cprompt : d->character->pcdata->cprompt;
+		prog = prompt_prog_get( &pc->cprompt_prog, pc->cprompt );
 	else
-		str = d->original ? d->original->pcdata->prompt : d->character->pcdata->prompt;
-	while ( *str != '\0' ) {
-		if ( point >= buf + sizeof( buf ) - 10 )
-			break;
-		if ( *str != '%' ) {
-			*point++ = *str++;
+		prog = prompt_prog_get( &pc->prompt_prog, pc->prompt );
+
+	/* Everything write_translate() looks at, then every field shown */
+	key = prompt_mix( 14695981039346656037ull, prog->serial );
+	key = prompt_mix( key, (uint32_t) wch->act );
+	key = prompt_mix( key, (uint32_t) wch->extra );
+	key = prompt_mix( key, (uint32_t) d->mtts_flags );
+	key = prompt_mix( key, d->mxp_enabled );
+	key = prompt_mix( key, d->charset_negotiated ? 1 + d->client_charset : 0 );
+	for ( i = 0, n = 0; i < prog->nops; i++ ) {
+		PROMPT_VAL *v;
+
+		if ( prog->ops[i].code == '\0' )
 			continue;
-		}
-		++str;
-		switch ( *str ) {
-		default:
-			i = " ";
-			break;
-		case 'h':
-			snprintf( buf2, sizeof(buf2), "%s%d#n", col_scale_code(ch->hit, ch->max_hit), ch->hit );
-			i = buf2;
-			break;
-		case 'H':
-			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->max_hit );
-			i = buf2;
-			break;
-		case 'm':
-			snprintf( buf2, sizeof(buf2), "%s%d#n", col_scale_code(ch->mana, ch->max_mana), ch->mana );
-			i = buf2;
-			break;
-		case 'M':
-			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->max_mana );
-			i = buf2;
-			break;
-		case 'v':
-			snprintf( buf2, sizeof(buf2), "%s%d#n", col_scale_code(ch->move, ch->max_move), ch->move );
-			i = buf2;
-			break;
-		case 'V':
-			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->max_move );
-			i = buf2;
-			break;
-		case 'x': {
-			char xp_tmp[32];
-			add_commas_to_number( ch->exp, xp_tmp, sizeof( xp_tmp ) );
-			snprintf( buf2, sizeof( buf2 ), "%s%s#n", col_scale_code( ch->exp, 10000000 ), xp_tmp );
-			i = buf2;
-			break;
-		}
-		case 'g':
-			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->gold );
-			i = buf2;
-			break;
-		case 'q':
-			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->pcdata->quest );
-			i = buf2;
-			break;
-		case 'f':
-			if ( ( victim = ch->fighting ) == NULL ) {
-				snprintf( buf2, sizeof( buf2 ), "#CN/A#n" );
-			} else {
-				if ( ( victim->hit * 100 / victim->max_hit ) < 25 ) {
-					snprintf( buf2, sizeof( buf2 ), "#RAwful#n" );
-				} else if ( ( victim->hit * 100 / victim->max_hit ) < 50 ) {
-					snprintf( buf2, sizeof( buf2 ), "#LPoor#n" );
-				} else if ( ( victim->hit * 100 / victim->max_hit ) < 75 ) {
-					snprintf( buf2, sizeof( buf2 ), "#GFair#n" );
-				} else if ( ( victim->hit * 100 / victim->max_hit ) < 100 ) {
-					snprintf( buf2, sizeof( buf2 ), "#yGood#n" );
-				} else {
-					snprintf( buf2, sizeof( buf2 ), "#CPerfect#n" );
-				}
-			}
-			i = buf2;
-			break;
-		case 'F':
-			if ( ( victim = ch->fighting ) == NULL ) {
-				snprintf( buf2, sizeof( buf2 ), "#CN/A#n" );
-			} else if ( ( tank = victim->fighting ) == NULL ) {
-				snprintf( buf2, sizeof( buf2 ), "#CN/A#n" );
-			} else {
-				if ( ( tank->hit * 100 / tank->max_hit ) < 25 ) {
-					snprintf( buf2, sizeof( buf2 ), "#RAwful#n" );
-				} else if ( ( tank->hit * 100 / tank->max_hit ) < 50 ) {
-					snprintf( buf2, sizeof( buf2 ), "#LPoor#n" );
-				} else if ( ( tank->hit * 100 / tank->max_hit ) < 75 ) {
-					snprintf( buf2, sizeof( buf2 ), "#GFair#n" );
-				} else if ( ( tank->hit * 100 / tank->max_hit ) < 100 ) {
-					snprintf( buf2, sizeof( buf2 ), "#yGood#n" );
-				} else {
-					snprintf( buf2, sizeof( buf2 ), "#CPerfect#n" );
-				}
-			}
-			i = buf2;
-			break;
-		case 'n':
-			if ( ( victim = ch->fighting ) == NULL )
-				snprintf( buf2, sizeof( buf2 ), "N/A" );
-			else {
-				if ( IS_AFFECTED( victim, AFF_POLYMORPH ) )
-					snprintf( buf2, sizeof( buf2 ), "%s", victim->morph );
-				else if ( IS_NPC( victim ) )
-					snprintf( buf2, sizeof( buf2 ), "%s", victim->short_descr );
-				else
-					snprintf( buf2, sizeof( buf2 ), "%s", victim->name );
-				buf2[0] = toupper( buf2[0] );
-			}
-			i = buf2;
-			break;
-		case 'N':
-			if ( ( victim = ch->fighting ) == NULL )
-				snprintf( buf2, sizeof( buf2 ), "N/A" );
-			else if ( ( tank = victim->fighting ) == NULL )
-				snprintf( buf2, sizeof( buf2 ), "N/A" );
-			else {
-				if ( ch == tank )
-					snprintf( buf2, sizeof( buf2 ), "You" );
-				else if ( IS_AFFECTED( tank, AFF_POLYMORPH ) )
-					snprintf( buf2, sizeof( buf2 ), "%s", tank->morph );
-				else if ( IS_NPC( victim ) )
-					snprintf( buf2, sizeof( buf2 ), "%s", tank->short_descr );
-				else
-					snprintf( buf2, sizeof( buf2 ), "%s", tank->name );
-				buf2[0] = toupper( buf2[0] );
-			}
-			i = buf2;
-			break;
-		case 'a':
-			snprintf( buf2, sizeof( buf2 ), "#C%s#n", IS_GOOD( ch ) ? "good" : IS_EVIL( ch ) ? "evil"
-																							   : "neutral" );
-			i = buf2;
-			break;
-		case 'A':
-			snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->alignment );
-			i = buf2;
-			break;
-		case 't':
-			snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->fight_timer );
-			i = buf2;
-			break;
-		case 'k':
-			if ( IS_CLASS( ch, CLASS_SHAPESHIFTER ) && !IS_NPC( ch ) ) {
-				snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->pcdata->powers[SHAPE_COUNTER] );
-				i = buf2;
-				break;
-			} else if ( IS_CLASS( ch, CLASS_SAMURAI ) && !IS_NPC( ch ) ) {
-				snprintf( buf2, sizeof( buf2 ), "%d", ch->pcdata->powers[SAMURAI_FOCUS] );
-				i = buf2;
-				break;
-			} else {
-				snprintf( buf2, sizeof( buf2 ), " " );
-				i = buf2;
+		v = &vals[n++];
+		prompt_read( ch, prog->ops[i].code, v, scratch[n - 1], sizeof( scratch[0] ) );
+		key = prompt_mix( key, (uint32_t) v->a );
+		key = prompt_mix( key, (uint32_t) v->b );
+		key = prompt_mix_str( key, v->s );
+	}
+
+	pcache = d->prompt_cache;
+	if ( pcache != NULL && pcache->valid && pcache->serial == prog->serial && pcache->key == key ) {
+		prompt_hits++;
+		write_to_buffer_raw( d, pcache->bytes, pcache->len );
+		return;
+	}
+	prompt_misses++;
+
+	point = buf;
+	for ( i = 0, n = 0; i < prog->nops; i++ ) {
+		const PROMPT_OP *op = &prog->ops[i];
+
+		if ( op->code == '\0' ) {
+			for ( len = 0; len < op->len && point < buf + sizeof( buf ) - 10; len++ )
+				*point++ = op->text[len];
+			if ( len < op->len )
 				break;
-			}
-		case 'r':
-			if ( ch->in_room )
-				snprintf( buf2, sizeof( buf2 ), "#C%s#n", ch->in_room->name );
-			else
-				snprintf( buf2, sizeof( buf2 ), " " );
-			i = buf2;
-			break;
-		case 'R':
-			if ( !IS_NPC( ch ) && ( IS_CLASS( ch, CLASS_WEREWOLF ) || IS_CLASS( ch, CLASS_VAMPIRE ) || IS_CLASS( ch, CLASS_NINJA ) || IS_CLASS( ch, CLASS_DIRGESINGER ) || IS_CLASS( ch, CLASS_SIREN ) || IS_CLASS( ch, CLASS_PSION ) || IS_CLASS( ch, CLASS_MINDFLAYER ) || IS_CLASS( ch, CLASS_DRAGONKIN ) || IS_CLASS( ch, CLASS_WYRM ) || IS_CLASS( ch, CLASS_ARTIFICER ) || IS_CLASS( ch, CLASS_MECHANIST ) || IS_CLASS( ch, CLASS_CULTIST ) || IS_CLASS( ch, CLASS_VOIDBORN ) || IS_CLASS( ch, CLASS_CHRONOMANCER ) || IS_CLASS( ch, CLASS_PARADOX ) || IS_CLASS( ch, CLASS_SHAMAN ) || IS_CLASS( ch, CLASS_SPIRITLORD ) ) ) {
-				snprintf( buf2, sizeof( buf2 ), "#r%d#n", ch->rage );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "0" );
-			i = buf2;
-			break;
-		case 'E':
-			if ( !IS_NPC( ch ) && ch->pcdata != NULL &&
-				( IS_CLASS( ch, CLASS_DRAGONKIN ) || IS_CLASS( ch, CLASS_WYRM ) ) ) {
-				const char *attune_names[] = { "Fire", "Frost", "Storm", "Earth" };
-				int attune = ch->pcdata->powers[0];  /* DRAGON_ATTUNEMENT */
-				if ( attune < 0 || attune > 3 ) attune = 0;
-				snprintf( buf2, sizeof( buf2 ), "#C%s#n", attune_names[attune] );
-			} else
-				snprintf( buf2, sizeof( buf2 ), " " );
-			i = buf2;
-			break;
-		case 'G':
-			if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_WEREWOLF ) && ch_gnosis(ch)[GMAXIMUM] > 0 ) {
-				snprintf( buf2, sizeof( buf2 ), "%s%d#n", col_scale_code( ch_gnosis(ch)[GCURRENT], ch_gnosis(ch)[GMAXIMUM] ), ch_gnosis(ch)[GCURRENT] );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "0" );
-			i = buf2;
-			break;
-		case 'i':
-			if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_MONK ) && ch_chi(ch)[MAXIMUM] > 0 ) {
-				snprintf( buf2, sizeof( buf2 ), "%s%d#n", col_scale_code( ch_chi(ch)[CURRENT], ch_chi(ch)[MAXIMUM] ), ch_chi(ch)[CURRENT] );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "0" );
-			i = buf2;
-			break;
-		case 'I':
-			if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_MONK ) ) {
-				snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch_chi(ch)[MAXIMUM] );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "0" );
-			i = buf2;
-			break;
-		case 'd':
-			if ( !IS_NPC( ch ) && ch->pcdata != NULL &&
-				( IS_CLASS( ch, CLASS_DEMON ) || IS_CLASS( ch, CLASS_DROW ) || IS_CLASS( ch, CLASS_TANARRI ) || IS_CLASS( ch, CLASS_DROID ) ) ) {
-				snprintf( buf2, sizeof( buf2 ), "%s%d#n", col_scale_code( ch->pcdata->stats[8], ch->pcdata->stats[9] > 0 ? ch->pcdata->stats[9] : ch->pcdata->stats[8] ), ch->pcdata->stats[8] );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "0" );
-			i = buf2;
-			break;
-		case 'D':
-			if ( !IS_NPC( ch ) && ch->pcdata != NULL &&
-				( IS_CLASS( ch, CLASS_DEMON ) || IS_CLASS( ch, CLASS_DROW ) ) ) {
-				snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->pcdata->stats[9] );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "0" );
-			i = buf2;
-			break;
-		case 'b':
-			snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->beast );
-			i = buf2;
-			break;
-		case 'B':
-			if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_VAMPIRE ) ) {
-				snprintf( buf2, sizeof( buf2 ), "#r%d#n", ch->pcdata->condition[COND_THIRST] );
-			} else if ( !IS_NPC( ch ) && IS_CLASS( ch, CLASS_SHAPESHIFTER ) ) {
-				snprintf( buf2, sizeof( buf2 ), "#r%d#n", ch->pcdata->condition[COND_FULL] );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "0" );
-			i = buf2;
-			break;
-		case 'c':
-			snprintf( buf2, sizeof( buf2 ), "%d", char_ac( ch ) );
-			i = buf2;
-			break;
-		case 'p':
-			snprintf( buf2, sizeof( buf2 ), "%s%d#n", col_scale_code( char_hitroll( ch ), 200 ), char_hitroll( ch ) );
-			i = buf2;
-			break;
-		case 'P':
-			snprintf( buf2, sizeof( buf2 ), "%s%d#n", col_scale_code( char_damroll( ch ), 200 ), char_damroll( ch ) );
-			i = buf2;
-			break;
-		case 's':
-			if ( !IS_NPC( ch ) && ch->pcdata->stage[2] + 25 >= ch->pcdata->stage[1] && ch->pcdata->stage[1] > 0 ) {
-				snprintf( buf2, sizeof( buf2 ), "#Cyes#n" );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "no" );
-			i = buf2;
-			break;
-		case 'O':
-			if ( ( victim = ch->pcdata->partner ) == NULL )
-				snprintf( buf2, sizeof( buf2 ), "no" );
-			else if ( !IS_NPC( victim ) && victim != NULL && victim->pcdata->stage[1] > 0 && victim->pcdata->stage[2] + 25 >= victim->pcdata->stage[1] ) {
-				snprintf( buf2, sizeof( buf2 ), "#Cyes#n" );
-			} else
-				snprintf( buf2, sizeof( buf2 ), "no" );
-			i = buf2;
-			break;
-		case 'l':
-			if ( ( victim = ch->pcdata->partner ) == NULL )
-				snprintf( buf2, sizeof( buf2 ), "Nobody" );
-			else {
-				if ( IS_AFFECTED( victim, AFF_POLYMORPH ) )
-					snprintf( buf2, sizeof( buf2 ), "%s", victim->morph );
-				else if ( IS_NPC( victim ) )
-					snprintf( buf2, sizeof( buf2 ), "%s", victim->short_descr );
-				else
-					snprintf( buf2, sizeof( buf2 ), "%s", victim->name );
-				buf2[0] = toupper( buf2[0] );
-			}
-			i = buf2;
-			break;
-		case '%':
-			snprintf( buf2, sizeof( buf2 ), "%%" );
-			i = buf2;
-			break;
+			continue;
 		}
-		++str;
-		point = buf_append_safe( point, i, buf, sizeof( buf ), 10 );
+		if ( point >= buf + sizeof( buf ) - 10 )
+			break;
+		prompt_format( op->code, &vals[n++], buf2, sizeof( buf2 ) );
+		point = buf_append_safe( point, buf2, buf, sizeof( buf ), 10 );
 		if ( point == NULL ) {
 			point = buf + sizeof( buf ) - 10;
 			break;
 		}
 	}
 	*point = '\0';
-	write_to_buffer( d, buf, (int) ( point - buf ) );
+
+	len = write_translate( d, buf, (int) ( point - buf ), out, sizeof( out ) );
+	if ( len < 0 )
+		return;
+
+	/* Random colour is meant to change every time */
+	if ( strstr( buf, "#s" ) == NULL ) {
+		if ( pcache == NULL ) {
+			pcache = d->prompt_cache = calloc( 1, sizeof( *pcache ) );
+			if ( pcache == NULL ) {
+				bug( "bust_a_prompt: calloc failed", 0 );
+				exit( 1 );
+			}
+		}
+		if ( pcache->size < len ) {
+			free( pcache->bytes );
+			pcache->size = len + 64;
+			pcache->bytes = malloc( pcache->size );
+			if ( pcache->bytes == NULL ) {
+				bug( "bust_a_prompt: malloc failed", 0 );
+				exit( 1 );
+			}
+		}
+		memcpy( pcache->bytes, out, len );
+		pcache->len = len;
+		pcache->key = key;
+		pcache->serial = prog->serial;
+		pcache->valid = TRUE;
+	} else if ( pcache != NULL )
+		pcache->valid = FALSE;
+
+	write_to_buffer_raw( d, out, len );
 	return;
 }
 
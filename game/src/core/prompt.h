@@ -0,0 +1,26 @@
+/*
+ * prompt.h - Compiled player prompts and the per-descriptor prompt cache
+ *
+ * pcdata->prompt and ->cprompt are compiled into a PROMPT_PROG when they
+ * are set or loaded: literal runs and one op per %code.  bust_a_prompt()
+ * runs the ops to read each field the prompt shows and folds the values,
+ * and the colour settings of the descriptor, into a 64-bit key.  When the
+ * key matches the last prompt sent on that descriptor the translated
+ * bytes are replayed as they are; otherwise the prompt is formatted and
+ * translated as before and becomes the new cached copy.
+ *
+ * Prompts whose text holds #s (random colour) are never replayed, since
+ * each send is meant to differ.
+ */
+
+#ifndef PROMPT_H
+#define PROMPT_H
+
+void bust_a_prompt( DESCRIPTOR_DATA *d );
+PROMPT_PROG *prompt_compile( const char *src );
+void prompt_free( PROMPT_PROG *prog );
+void prompt_recompile( CHAR_DATA *ch );
+void prompt_cache_free( DESCRIPTOR_DATA *d );
+void prompt_cache_get_stats( long *hits, long *misses );
+
+#endif /* PROMPT_H */
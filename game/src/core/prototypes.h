@@ -738,6 +738,7 @@ DO_FUN do_multicheck;
 
 DO_FUN do_mudstat;
 DO_FUN do_profile;
+DO_FUN do_capture;
 DO_FUN do_scry;
 DO_FUN do_pkscry;
 DO_FUN do_pkmind;
@@ -965,6 +966,7 @@ void show_list_to_char ( void *list, CHAR_DATA *ch,
 int char_hitroll ( CHAR_DATA * ch );
 int char_damroll ( CHAR_DATA * ch );
 int char_ac ( CHAR_DATA * ch );
+const char *get_room_tint_color ( ROOM_INDEX_DATA * room );
 
 /* darkheart.c */
 
@@ -974,6 +976,7 @@ void set_switchname ( CHAR_DATA * ch, char *title );
 /* act_move.c */
 void move_char ( CHAR_DATA * ch, int door );
 void check_hunt ( CHAR_DATA * ch );
+bool mob_path_step ( CHAR_DATA * ch );
 
 int disc_points_needed ( CHAR_DATA * ch );
 void gain_disc_points ( CHAR_DATA * ch, int points );
@@ -1015,6 +1018,10 @@ void close_socket ( DESCRIPTOR_DATA * dclose );
 void close_socket2 ( DESCRIPTOR_DATA * dclose, bool kickoff );
 void write_to_buffer ( DESCRIPTOR_DATA * d, const char *txt,
 	int length );
+int write_translate ( DESCRIPTOR_DATA * d, const char *txt, int length,
+	char *output, size_t size );
+void write_to_buffer_raw ( DESCRIPTOR_DATA * d, const char *output,
+	int length );
 bool write_to_descriptor ( DESCRIPTOR_DATA * d, char *txt, int length );
 bool process_output ( DESCRIPTOR_DATA * d, bool fPrompt );
 const char *col_scale_code ( int current, int max );
@@ -1286,6 +1293,7 @@ void make_preg ( CHAR_DATA * mother, CHAR_DATA *father );
 
 /* magic.c */
 int skill_lookup ( const char *name );
+void resolve_skill_names ( void );
 int slot_lookup ( int slot );
 bool saves_spell ( int level, CHAR_DATA *victim );
 void obj_cast_spell ( int sn, int level, CHAR_DATA *ch,
@@ -1326,6 +1334,7 @@ void gmcp_handle_subnegotiation( DESCRIPTOR_DATA *d, unsigned char *data, int le
 
 /* act_map.c */
 void show_automap( CHAR_DATA *ch );
+void render_automap( ROOM_INDEX_DATA *room, int radius, char *buf, size_t len );
 
 /* naws.c */
 void naws_init( DESCRIPTOR_DATA *d );
@@ -1598,6 +1607,9 @@ DO_FUN do_lordarmor;
 
 /* db.c */
 void reset_area ( AREA_DATA * pArea );
+void reset_area_begin ( AREA_DATA * pArea );
+void reset_area_room_now ( ROOM_INDEX_DATA * pRoom );
+void area_reset_pulse ( void );
 void reset_room ( ROOM_INDEX_DATA * pRoom );
 
 /* string.c */
@@ -0,0 +1,161 @@
+/*
+ * rng.c - Named random number streams
+ *
+ * xoshiro128** (Blackman and Vigna), seeded through splitmix64.  Bounded
+ * draws use Lemire's multiply-and-reject, which needs one multiply per
+ * draw and rejects fewer than bound / 2^32 of them, instead of masking
+ * to a power of two and throwing away up to half.
+ */
+
+#include <math.h>
+#include "merc.h"
+#include "rng.h"
+
+static RNG_STREAM rng_streams[RNG_MAX];
+static int rng_cur = RNG_DEFAULT;
+
+static uint64_t splitmix64( uint64_t *x ) {
+	uint64_t z = ( *x += 0x9e3779b97f4a7c15ULL );
+
+	z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+	z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+	return z ^ ( z >> 31 );
+}
+
+static inline uint32_t rotl32( uint32_t x, int k ) {
+	return ( x << k ) | ( x >> ( 32 - k ) );
+}
+
+void rng_seed( int stream, uint64_t seed ) {
+	RNG_STREAM *r;
+	uint64_t x, w;
+
+	if ( stream < 0 || stream >= RNG_MAX )
+		return;
+
+	/* Different streams get different sequences from the same seed */
+	r = &rng_streams[stream];
+	x = seed ^ ( (uint64_t) stream * 0xd1b54a32d192ed03ULL );
+	w = splitmix64( &x );
+	r->s[0] = (uint32_t) w;
+	r->s[1] = (uint32_t) ( w >> 32 );
+	w = splitmix64( &x );
+	r->s[2] = (uint32_t) w;
+	r->s[3] = (uint32_t) ( w >> 32 );
+
+	/* All-zero state never leaves zero */
+	if ( ( r->s[0] | r->s[1] | r->s[2] | r->s[3] ) == 0 )
+		r->s[0] = 1;
+}
+
+void rng_seed_all( uint64_t seed ) {
+	int i;
+
+	for ( i = 0; i < RNG_MAX; i++ )
+		rng_seed( i, seed );
+}
+
+int rng_select( int stream ) {
+	int old = rng_cur;
+
+	if ( stream >= 0 && stream < RNG_MAX )
+		rng_cur = stream;
+	return old;
+}
+
+int rng_active( void ) {
+	return rng_cur;
+}
+
+RNG_STREAM *rng_stream( int stream ) {
+	if ( stream < 0 || stream >= RNG_MAX )
+		stream = rng_cur;
+	return &rng_streams[stream];
+}
+
+uint32_t rng_next( RNG_STREAM *r ) {
+	uint32_t *s = r->s;
+	uint32_t result = rotl32( s[1] * 5, 7 ) * 9;
+	uint32_t t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl32( s[3], 11 );
+	return result;
+}
+
+/* Uniform in [0, bound), bound > 0 */
+uint32_t rng_bounded( RNG_STREAM *r, uint32_t bound ) {
+	uint64_t m = (uint64_t) rng_next( r ) * bound;
+	uint32_t low = (uint32_t) m;
+
+	if ( low < bound ) {
+		uint32_t threshold = -bound % bound;
+
+		while ( low < threshold ) {
+			m = (uint64_t) rng_next( r ) * bound;
+			low = (uint32_t) m;
+		}
+	}
+	return (uint32_t) ( m >> 32 );
+}
+
+int rng_range( int stream, int from, int to ) {
+	int64_t span = (int64_t) to - from + 1;
+
+	if ( span <= 1 )
+		return from;
+	if ( span > UINT32_MAX )
+		return (int) ( from + (int64_t) rng_next( rng_stream( stream ) ) );
+	return (int) ( from + (int64_t) rng_bounded( rng_stream( stream ), (uint32_t) span ) );
+}
+
+/*
+ * Sum of number rolls of 1..size.  Up to DICE_EXACT_MAX rolls are made one
+ * by one; past that the sum is drawn from the normal distribution with
+ * the same mean and variance, n(size+1)/2 and n(size^2-1)/12, which the
+ * sum is already very close to, and kept inside [number, number*size].
+ */
+int rng_dice( int stream, int number, int size ) {
+	RNG_STREAM *r = rng_stream( stream );
+	double mean, sd, u1, u2, z, sum;
+	int i, total;
+
+	switch ( size ) {
+	case 0:
+		return 0;
+	case 1:
+		return number;
+	}
+
+	if ( number <= 0 )
+		return 0;
+	if ( size < 0 )
+		return number;
+
+	if ( number <= DICE_EXACT_MAX ) {
+		for ( i = 0, total = 0; i < number; i++ )
+			total += 1 + (int) rng_bounded( r, (uint32_t) size );
+		return total;
+	}
+
+	/* Box-Muller; u1 is kept off zero so log() is finite */
+	u1 = ( ( rng_next( r ) >> 8 ) + 1.0 ) / 16777217.0;
+	u2 = ( rng_next( r ) >> 8 ) / 16777216.0;
+	z  = sqrt( -2.0 * log( u1 ) ) * cos( 6.283185307179586 * u2 );
+
+	mean = number * ( size + 1.0 ) / 2.0;
+	sd   = sqrt( number * ( (double) size * size - 1.0 ) / 12.0 );
+	sum  = floor( mean + z * sd + 0.5 );
+
+	if ( sum < number )
+		sum = number;
+	if ( sum > (double) number * size )
+		sum = (double) number * size;
+	if ( sum > INT_MAX )
+		sum = INT_MAX;
+	return (int) sum;
+}
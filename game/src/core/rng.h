@@ -0,0 +1,49 @@
+/*
+ * rng.h - Named random number streams
+ *
+ * Each stream is its own xoshiro128** generator (four 32-bit words of
+ * state), so combat, loot, mob AI and weather draw from separate
+ * sequences and one can be reseeded without disturbing the others.
+ * number_range(), number_percent(), dice() and friends in db.c read the
+ * active stream; update_handler() makes the matching stream active
+ * around each pulse and puts RNG_DEFAULT back afterwards.
+ *
+ * init_mm() seeds every stream from current_time, as before.
+ * rng_seed_all() seeds them from a fixed value instead, which makes
+ * headless combat runs and benchmarks repeatable.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+enum {
+	RNG_DEFAULT = 0,   /* Commands, and anything outside the pulses below */
+	RNG_COMBAT,        /* violence_update()                               */
+	RNG_LOOT,          /* Area resets: mob and object loads               */
+	RNG_AI,            /* mobile_update()                                 */
+	RNG_WEATHER,       /* weather_update()                                */
+	RNG_MAX
+};
+
+typedef struct rng_stream {
+	uint32_t s[4];
+} RNG_STREAM;
+
+/* Dice with more than this many rolls use a normal approximation */
+#define DICE_EXACT_MAX 12
+
+void rng_seed( int stream, uint64_t seed );
+void rng_seed_all( uint64_t seed );
+int rng_select( int stream );   /* Returns the stream that was active */
+int rng_active( void );
+
+uint32_t rng_next( RNG_STREAM *r );
+uint32_t rng_bounded( RNG_STREAM *r, uint32_t bound );
+int rng_range( int stream, int from, int to );
+int rng_dice( int stream, int number, int size );
+
+RNG_STREAM *rng_stream( int stream );
+
+#endif /* RNG_H */
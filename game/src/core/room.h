@@ -186,6 +186,7 @@ struct room_dynamic_data {
 	char *track[5];					/* Player tracking names (FIFO)  */
 	int   track_dir[5];				/* Direction for each track       */
 	int   blood;					/* Blood splatter level (0-1000) */
+	list_head_t script_mobs;		/* Scripted NPCs here (script_node) */
 };
 
 /*
@@ -219,12 +220,23 @@ struct room_index_data {
 
 	/* Area room list linkage for efficient reset iteration */
 	ROOM_INDEX_DATA *next_in_area;  /* Next room in same area */
+	int reset_gen;                  /* area->reset_gen when this room last reset */
+
+	struct room_render *render;      /* Cached look text (world/room_render.c) */
+
+	/* Automap placement (world/map_layout.c) */
+	struct map_sheet *map_sheet;     /* Sheet this room is laid out on; NULL if unseen */
+	short map_x, map_y;              /* Cell on map_sheet */
+	unsigned int map_stamp;          /* Layout walk that last visited this room */
+
+	int path_id;                     /* Index in the route graph (world/pathfind.c) */
 };
 
 static inline ROOM_DYNAMIC_DATA *room_dynamic( ROOM_INDEX_DATA *room ) {
 	if ( !room->dynamic ) {
 		room->dynamic = calloc( 1, sizeof( ROOM_DYNAMIC_DATA ) );
 		/* calloc zeros tick_timer, track_dir, blood; track[] are NULL */
+		list_init( &room->dynamic->script_mobs );
 	}
 	return room->dynamic;
 }
@@ -0,0 +1,62 @@
+/***************************************************************************
+ *  skill_names.h - Boot-resolved handles for skills named in code
+ *
+ *  Skills without a pgsn slot in skill_table used to be found by calling
+ *  skill_lookup( "name" ) at the point of use, often every combat round.
+ *  Each such name gets a gsn_* handle here instead; boot_db() resolves
+ *  the whole list once, right after the pgsn pass, with the same prefix
+ *  rules skill_lookup() uses, so a handle holds exactly what the old
+ *  call returned (-1 included).
+ *
+ *  Skills that already have a pgsn (gsn_blindness, gsn_charm_person,
+ *  gsn_web and so on) are used directly and are not listed.
+ *
+ *  Format: SKILL_X(handle, "name as it was passed to skill_lookup")
+ ***************************************************************************/
+
+#ifndef SKILL_NAMES_H
+#define SKILL_NAMES_H
+
+#define SKILL_NAME_ENTRIES \
+	SKILL_X( gsn_acid_blast,      "acid blast" ) \
+	SKILL_X( gsn_blue_sorcery,    "blue sorcery" ) \
+	SKILL_X( gsn_change_sex,      "change sex" ) \
+	SKILL_X( gsn_chaos_blast,     "chaos blast" ) \
+	SKILL_X( gsn_chill_touch,     "chill touch" ) \
+	SKILL_X( gsn_clay_ball,       "clay" ) \
+	SKILL_X( gsn_clot,            "clot" ) \
+	/* No such skill: resolves to -1 and do_cone bails, as it always has */ \
+	SKILL_X( gsn_cone,            "cone" ) \
+	SKILL_X( gsn_continual_light, "continual light" ) \
+	SKILL_X( gsn_desanct,         "desanct" ) \
+	SKILL_X( gsn_detect_magic,    "detect magic" ) \
+	SKILL_X( gsn_dispel_magic,    "dispel magic" ) \
+	SKILL_X( gsn_earthquake,      "earthquake" ) \
+	SKILL_X( gsn_faerie_fire,     "faerie fire" ) \
+	SKILL_X( gsn_fire_breath,     "fire breath" ) \
+	/* The spell; gsn_fireball is the combat skill of the same name */ \
+	SKILL_X( gsn_fireball_spell,  "fireball" ) \
+	SKILL_X( gsn_frost_breath,    "frost breath" ) \
+	SKILL_X( gsn_gas_breath,      "gas breath" ) \
+	SKILL_X( gsn_gate,            "gate" ) \
+	SKILL_X( gsn_godbless,        "godbless" ) \
+	SKILL_X( gsn_green_sorcery,   "green sorcery" ) \
+	SKILL_X( gsn_group_heal,      "group heal" ) \
+	SKILL_X( gsn_identify,        "identify" ) \
+	SKILL_X( gsn_imp_faerie_fire, "imp faerie fire" ) \
+	SKILL_X( gsn_imp_fireball,    "imp fireball" ) \
+	SKILL_X( gsn_imp_heal,        "imp heal" ) \
+	SKILL_X( gsn_imp_teleport,    "imp teleport" ) \
+	SKILL_X( gsn_infirmity,       "infirmity" ) \
+	SKILL_X( gsn_lightning_bolt,  "lightning bolt" ) \
+	SKILL_X( gsn_purple_sorcery,  "purple sorcery" ) \
+	SKILL_X( gsn_readaura,        "readaura" ) \
+	SKILL_X( gsn_red_sorcery,     "red sorcery" ) \
+	SKILL_X( gsn_reserved,        "reserved" ) \
+	SKILL_X( gsn_sanctuary,       "sanctuary" ) \
+	SKILL_X( gsn_shield,          "shield" ) \
+	SKILL_X( gsn_spirit_kiss,     "spirit kiss" ) \
+	SKILL_X( gsn_stone_skin,      "stone skin" ) \
+	SKILL_X( gsn_yellow_sorcery,  "yellow sorcery" )
+
+#endif /* SKILL_NAMES_H */
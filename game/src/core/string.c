@@ -36,6 +36,9 @@
 #include <time.h>
 #include "merc.h"
 #include "utf8.h"
+#include "../world/olc.h"
+#include "../world/help_index.h"
+#include "../world/room_render.h"
 
 /*****************************************************************************
  Name:		string_append
@@ -184,6 +187,12 @@ void string_add( CHAR_DATA *ch, char *argument ) {
 	}
 
 	if ( *argument == '@' ) {
+		/* Finished help text needs re-indexing for help search */
+		if ( ch->desc->editor == ED_HELP )
+			help_index_invalidate();
+		/* Finished room description drops the cached look text */
+		if ( ch->desc->editor == ED_ROOM )
+			room_render_invalidate_all();
 		ch->desc->pString = NULL;
 		return;
 	}
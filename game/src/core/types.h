@@ -24,12 +24,15 @@ typedef struct exit_data EXIT_DATA;
 typedef struct extra_descr_data EXTRA_DESCR_DATA;
 typedef struct help_data HELP_DATA;
 typedef struct kill_data KILL_DATA;
+typedef struct mcmp_queue MCMP_QUEUE;
 typedef struct mob_index_data MOB_INDEX_DATA;
 typedef struct war_data WAR_DATA;
 typedef struct note_data NOTE_DATA;
 typedef struct obj_data OBJ_DATA;
 typedef struct obj_index_data OBJ_INDEX_DATA;
 typedef struct pc_data PC_DATA;
+typedef struct prompt_cache PROMPT_CACHE;
+typedef struct prompt_prog PROMPT_PROG;
 typedef struct reset_data RESET_DATA;
 typedef struct room_index_data ROOM_INDEX_DATA;
 typedef struct room_dynamic_data ROOM_DYNAMIC_DATA;
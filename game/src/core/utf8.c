@@ -1008,14 +1008,32 @@ int utf8_char_script( unsigned int cp ) {
  * Returns byte length of the NUL-terminated output.
  */
 int utf8_skeletonize( const char *input, char *output, int max_out ) {
+	return utf8_skeletonize_map( input, output, max_out, NULL );
+}
+
+/*
+ * As utf8_skeletonize(), also filling map[i] with the input offset of the
+ * codepoint that produced output[i], and map[len] with the offset where
+ * the input stopped.  map must hold max_out ints.
+ */
+int utf8_skeletonize_map( const char *input, char *output, int max_out, int *map ) {
 	const char *p = input;
 	int out = 0;
+	int mapped = 0;	  /* output[] before this has its map[] entry */
+	int from = 0;	  /* Input offset of the codepoint being written */
 
 	if ( !input || !output || max_out <= 0 )
 		return 0;
 
 	while ( *p != '\0' && out < max_out - 1 ) {
-		unsigned int cp = utf8_decode( &p );
+		unsigned int cp;
+
+		if ( map != NULL ) {
+			while ( mapped < out )
+				map[mapped++] = from;
+			from = (int) ( p - input );
+		}
+		cp = utf8_decode( &p );
 
 		/* Fullwidth ASCII: U+FF01-FF5E -> 0x21-0x7E */
 		if ( cp >= 0xFF01 && cp <= 0xFF5E ) {
@@ -1071,5 +1089,10 @@ int utf8_skeletonize( const char *input, char *output, int max_out ) {
 	}
 
 	output[out] = '\0';
+	if ( map != NULL ) {
+		while ( mapped < out )
+			map[mapped++] = from;
+		map[out] = (int) ( p - input );
+	}
 	return out;
 }
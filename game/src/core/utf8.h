@@ -99,4 +99,9 @@ int utf8_char_script( unsigned int codepoint );
  * Returns byte length of output (NUL-terminated). */
 int utf8_skeletonize( const char *input, char *output, int max_out );
 
+/* utf8_skeletonize(), also recording in map[i] the input byte offset of
+ * the codepoint that produced output[i]; map[len] is where input stopped.
+ * map must hold max_out ints. */
+int utf8_skeletonize_map( const char *input, char *output, int max_out, int *map );
+
 #endif /* UTF8_H */
@@ -98,6 +98,14 @@ struct note_data {
 	char *text;
 	time_t date_stamp;
 	time_t expire;
+
+	/* Recipients, parsed from to_list when the note joins a board */
+	unsigned int seq;	/* Order of arrival on its board              */
+	int to_flags;		/* NOTE_TO_* from board.h                      */
+	int to_level;		/* Trust needed when to_list is a number       */
+	int sender_id;		/* note_name_id() of sender                    */
+	int *to_ids;		/* note_name_id() of every word of to_list     */
+	int to_count;
 };
 
 struct top_board {
@@ -190,9 +198,19 @@ struct area_data {
 	ROOM_INDEX_DATA *room_first;  /* Head of linked list of rooms in this area */
 	int room_count;               /* Number of rooms in this area */
 
+	/* Incremental reset in progress (reset_area_begin / area_reset_pulse) */
+	ROOM_INDEX_DATA *reset_next;  /* Next room in room_first order; NULL when idle */
+	int reset_gen;                /* Bumped when a reset starts */
+	int reset_pulses;             /* Pulses the running reset has touched */
+	long reset_run_us;            /* Time spent on the running reset so far */
+
+	struct path_area *path;       /* Next-hop table (world/pathfind.c) */
+
 	/* Per-area profiling statistics (reset with profile reset) */
 	long profile_reset_count;     /* Times this area was reset during profiling */
 	long profile_reset_time_us;   /* Total microseconds spent resetting this area */
+	long profile_reset_pulses;    /* Pulses those resets were spread over */
+	long profile_reset_slice_us;  /* Longest single-pulse slice of any reset */
 };
 /*****************************************************************************
  *                                    OLC                                    *
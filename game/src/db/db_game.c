@@ -7,9 +7,12 @@
 
 #include "db_util.h"
 #include "db_game.h"
+#include "db_writer.h"
 #include "../core/cfg.h"
 #include "../core/utf8.h"
+#include "../systems/textfilter.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,6 +37,52 @@ static sqlite3 *base_help_db = NULL;
 static sqlite3 *live_help_db = NULL;
 static sqlite3 *game_db = NULL;
 
+/*
+ * game.db writes go through a write-behind queue (db_writer.c) instead of
+ * opening the database per save.  Every statement the save functions use
+ * is listed here and prepared once on the writer's connection.
+ */
+#define GAME_WRITE_SQL_LIST( X ) \
+	X( GSQL_GAMECONFIG_PUT,   "INSERT OR REPLACE INTO gameconfig (key, value) VALUES (?,?)" ) \
+	X( GSQL_TOPBOARD_PUT,     "INSERT OR REPLACE INTO topboard (rank, name, pkscore) VALUES (?,?,?)" ) \
+	X( GSQL_LEADERBOARD_PUT,  "INSERT OR REPLACE INTO leaderboard (category, name, value) VALUES (?,?,?)" ) \
+	X( GSQL_KINGDOM_PUT,      "INSERT OR REPLACE INTO kingdoms " \
+		"(id, name, whoname, leader, general, kills, deaths, qps, " \
+		"req_hit, req_move, req_mana, req_qps) VALUES (?,?,?,?,?,?,?,?,?,?,?,?)" ) \
+	X( GSQL_NOTES_CLEAR,      "DELETE FROM notes WHERE board_idx=?" ) \
+	X( GSQL_NOTE_INSERT,      "INSERT INTO notes (board_idx, sender, date, date_stamp, expire, " \
+		"to_list, subject, text) VALUES (?,?,?,?,?,?,?,?)" ) \
+	X( GSQL_BUG_INSERT,       "INSERT INTO bugs (room_vnum, player, message, timestamp) VALUES (?,?,?,?)" ) \
+	X( GSQL_BANS_CLEAR,       "DELETE FROM bans" ) \
+	X( GSQL_BAN_INSERT,       "INSERT INTO bans (name, reason) VALUES (?,?)" ) \
+	X( GSQL_DISABLED_CLEAR,   "DELETE FROM disabled_commands" ) \
+	X( GSQL_DISABLED_INSERT,  "INSERT INTO disabled_commands (command_name, level, disabled_by) VALUES (?,?,?)" ) \
+	X( GSQL_CFG_PUT,          "INSERT OR REPLACE INTO config (key, value) VALUES (?,?)" ) \
+	X( GSQL_SUPER_ADMIN_ADD,  "INSERT OR IGNORE INTO super_admins (name) VALUES (?)" ) \
+	X( GSQL_SUPER_ADMIN_DEL,  "DELETE FROM super_admins WHERE name = ?" ) \
+	X( GSQL_AUDIO_UPDATE,     "UPDATE audio_config SET filename=?, volume=?, priority=?, " \
+		"loops=?, media_type=?, tag=?, caption=?, use_key=?, use_continue=? " \
+		"WHERE category=? AND trigger_key=?" ) \
+	X( GSQL_PRETITLE_PUT,     "INSERT OR REPLACE INTO immortal_pretitles " \
+		"(immortal_name, pretitle, set_by, set_date) VALUES (?,?,?,?)" ) \
+	X( GSQL_PRETITLE_DEL,     "DELETE FROM immortal_pretitles WHERE immortal_name = ?" ) \
+	X( GSQL_FORBIDDEN_CLEAR,  "DELETE FROM forbidden_names" ) \
+	X( GSQL_FORBIDDEN_INSERT, "INSERT INTO forbidden_names (name, type, added_by) VALUES (?,?,?)" ) \
+	X( GSQL_PROFANITY_CLEAR,  "DELETE FROM profanity_filters" ) \
+	X( GSQL_PROFANITY_INSERT, "INSERT INTO profanity_filters (pattern, added_by) VALUES (?,?)" )
+
+#define GAME_WRITE_SQL_ID( id, sql ) id,
+enum { GAME_WRITE_SQL_LIST( GAME_WRITE_SQL_ID ) GSQL_MAX };
+#undef GAME_WRITE_SQL_ID
+
+#define GAME_WRITE_SQL_TEXT( id, sql ) sql,
+static const char *const game_write_sql[GSQL_MAX] = {
+	GAME_WRITE_SQL_LIST( GAME_WRITE_SQL_TEXT )
+};
+#undef GAME_WRITE_SQL_TEXT
+
+static DB_WRITER *game_writer = NULL;
+
 /* Directory for game databases (non-static for db_class.c access) */
 char mud_db_game_dir[MUD_PATH_MAX] = "";
 
@@ -265,6 +314,10 @@ void db_game_init( void ) {
 		 * Together these reduce write latency ~5-10x vs defaults. */
 		sqlite3_exec( game_db, "PRAGMA journal_mode=WAL", NULL, NULL, NULL );
 		sqlite3_exec( game_db, "PRAGMA synchronous=NORMAL", NULL, NULL, NULL );
+
+		/* Long-lived write connection, kept after the boot connections close */
+		db_game_close_writer();
+		game_writer = db_writer_open( path, game_write_sql, GSQL_MAX );
 	}
 }
 
@@ -302,10 +355,85 @@ void db_game_close_boot_connections( void ) {
 
 
 /*
- * Helper: Open game.db for a write or query operation.
+ * game.db write-behind queue.
+ * Saves build a batch and queue it; the writer commits everything queued
+ * once a second (db_game_writer_pulse) in one transaction.  Batches with
+ * a key replace a pending batch with the same key.
+ */
+static DB_BATCH *db_game_batch( const char *key ) {
+	return game_writer ? db_batch_new( key ) : NULL;
+}
+
+static void db_game_submit( DB_BATCH *b ) {
+	db_writer_submit( game_writer, b );
+}
+
+/*
+ * Commit anything queued and wait for it.  Called before reading game.db
+ * back and before copyover, so nothing queued is lost or stale.
+ */
+void db_game_flush( void ) {
+	db_writer_flush( game_writer );
+}
+
+/* Flush and close the writer at shutdown */
+void db_game_close_writer( void ) {
+	if ( game_writer == NULL )
+		return;
+	db_writer_close( game_writer );
+	game_writer = NULL;
+}
+
+/* Once a pulse from update_handler: start a group commit every second */
+void db_game_writer_pulse( void ) {
+	static int pulse_commit;
+	char buf[MAX_INPUT_LENGTH];
+
+	if ( db_writer_take_error( game_writer, buf, sizeof( buf ) ) )
+		bug( buf, 0 );
+
+	if ( --pulse_commit > 0 )
+		return;
+	pulse_commit = PULSE_PER_SECOND;
+	db_writer_kick( game_writer );
+}
+
+void db_game_writer_stats( DB_WRITER_STATS *out ) {
+	db_writer_get_stats( game_writer, out );
+}
+
+/* 'profile db' */
+void db_game_writer_report( CHAR_DATA *ch ) {
+	DB_WRITER_STATS st;
+	char buf[MAX_STRING_LENGTH];
+
+	if ( game_writer == NULL ) {
+		send_to_char( "The game.db writer is not running.\n\r", ch );
+		return;
+	}
+
+	db_game_writer_stats( &st );
+	send_to_char( "#C=== game.db Writer ===#n\n\r", ch );
+	snprintf( buf, sizeof( buf ),
+		"Queue depth: #W%d#n   Peak: %d   Mode: %s\n\r",
+		st.depth, st.peak_depth, st.threaded ? "background" : "synchronous" );
+	send_to_char( buf, ch );
+	snprintf( buf, sizeof( buf ),
+		"Batches: %ld   Coalesced: %ld   Statements: %ld   Errors: %ld\n\r",
+		st.batches, st.coalesced, st.ops, st.errors );
+	send_to_char( buf, ch );
+	snprintf( buf, sizeof( buf ),
+		"Commits: %ld   Avg: %lldus   Max: %lldus\n\r",
+		st.commits, st.commits > 0 ? st.commit_us_total / st.commits : 0, st.commit_us_max );
+	send_to_char( buf, ch );
+}
+
+/*
+ * Helper: Open game.db for a query that is not served from memory.
+ * Flushes the write queue first so the query sees every save.
  * Returns NULL on failure.
  */
-static sqlite3 *db_game_open_for_write( void ) {
+static sqlite3 *db_game_open_for_read( void ) {
 	char path[MUD_PATH_MAX];
 	sqlite3 *db = NULL;
 
@@ -314,20 +442,18 @@ static sqlite3 *db_game_open_for_write( void ) {
 
 	if ( snprintf( path, sizeof( path ), "%s%sgame.db",
 			mud_db_game_dir, PATH_SEPARATOR ) >= (int)sizeof( path ) ) {
-		bug( "db_game_open_for_write: path truncated.", 0 );
+		bug( "db_game_open_for_read: path truncated.", 0 );
 		return NULL;
 	}
 
+	db_game_flush();
+
 	if ( sqlite3_open( path, &db ) != SQLITE_OK ) {
-		bug( "db_game_open_for_write: cannot open game.db", 0 );
+		bug( "db_game_open_for_read: cannot open game.db", 0 );
 		if ( db ) sqlite3_close( db );
 		return NULL;
 	}
 
-	/* WAL mode for faster writes (matches db_game_init settings) */
-	sqlite3_exec( db, "PRAGMA journal_mode=WAL", NULL, NULL, NULL );
-	sqlite3_exec( db, "PRAGMA synchronous=NORMAL", NULL, NULL, NULL );
-
 	return db;
 }
 
@@ -592,34 +718,22 @@ void db_game_load_gameconfig( void ) {
 }
 
 void db_game_save_gameconfig( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "INSERT OR REPLACE INTO gameconfig (key, value) VALUES (?,?)";
+	DB_BATCH *b;
 	char buf[64];
 
-	db = db_game_open_for_write();
-	if ( !db )
-		return;
-
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
+	if ( ( b = db_game_batch( "gameconfig" ) ) == NULL )
 		return;
-	}
-
-	db_begin( db );
 
 #define SAVE_INT( k, v ) \
-	sqlite3_reset( stmt ); \
+	db_batch_op( b, GSQL_GAMECONFIG_PUT ); \
 	snprintf( buf, sizeof( buf ), "%d", v ); \
-	sqlite3_bind_text( stmt, 1, k, -1, SQLITE_STATIC ); \
-	sqlite3_bind_text( stmt, 2, buf, -1, SQLITE_TRANSIENT ); \
-	sqlite3_step( stmt )
+	db_batch_text( b, k ); \
+	db_batch_text( b, buf )
 
 #define SAVE_STR( k, v ) \
-	sqlite3_reset( stmt ); \
-	sqlite3_bind_text( stmt, 1, k, -1, SQLITE_STATIC ); \
-	sqlite3_bind_text( stmt, 2, v ? v : "", -1, SQLITE_TRANSIENT ); \
-	sqlite3_step( stmt )
+	db_batch_op( b, GSQL_GAMECONFIG_PUT ); \
+	db_batch_text( b, k ); \
+	db_batch_text( b, v ? v : "" )
 
 	SAVE_INT( "base_xp", game_config.base_xp );
 	SAVE_INT( "max_xp_per_kill", game_config.max_xp_per_kill );
@@ -635,9 +749,7 @@ void db_game_save_gameconfig( void ) {
 #undef SAVE_INT
 #undef SAVE_STR
 
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -668,33 +780,20 @@ void db_game_load_topboard( void ) {
 }
 
 void db_game_save_topboard( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "INSERT OR REPLACE INTO topboard (rank, name, pkscore) VALUES (?,?,?)";
+	DB_BATCH *b;
 	int i;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( "topboard" ) ) == NULL )
 		return;
 
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
-		return;
-	}
-
-	db_begin( db );
-
 	for ( i = 1; i <= MAX_TOP_PLAYERS; i++ ) {
-		sqlite3_reset( stmt );
-		sqlite3_bind_int( stmt, 1, i );
-		sqlite3_bind_text( stmt, 2, top_board[i].name, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_int( stmt, 3, top_board[i].pkscore );
-		sqlite3_step( stmt );
+		db_batch_op( b, GSQL_TOPBOARD_PUT );
+		db_batch_int( b, i );
+		db_batch_text( b, top_board[i].name );
+		db_batch_int( b, top_board[i].pkscore );
 	}
 
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -752,27 +851,16 @@ void db_game_load_leaderboard( void ) {
 }
 
 void db_game_save_leaderboard( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "INSERT OR REPLACE INTO leaderboard (category, name, value) VALUES (?,?,?)";
+	DB_BATCH *b;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( "leaderboard" ) ) == NULL )
 		return;
 
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
-		return;
-	}
-
-	db_begin( db );
-
 #define SAVE_LB( cat, n, v ) \
-	sqlite3_reset( stmt ); \
-	sqlite3_bind_text( stmt, 1, cat, -1, SQLITE_STATIC ); \
-	sqlite3_bind_text( stmt, 2, n ? n : "Nobody", -1, SQLITE_TRANSIENT ); \
-	sqlite3_bind_int( stmt, 3, v ); \
-	sqlite3_step( stmt )
+	db_batch_op( b, GSQL_LEADERBOARD_PUT ); \
+	db_batch_text( b, cat ); \
+	db_batch_text( b, n ? n : "Nobody" ); \
+	db_batch_int( b, v )
 
 	SAVE_LB( "bestpk", leader_board.bestpk_name, leader_board.bestpk_number );
 	SAVE_LB( "pk", leader_board.pk_name, leader_board.pk_number );
@@ -784,9 +872,7 @@ void db_game_save_leaderboard( void ) {
 
 #undef SAVE_LB
 
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -831,45 +917,29 @@ void db_game_load_kingdoms( void ) {
 }
 
 void db_game_save_kingdoms( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "INSERT OR REPLACE INTO kingdoms "
-		"(id, name, whoname, leader, general, kills, deaths, qps, "
-		"req_hit, req_move, req_mana, req_qps) "
-		"VALUES (?,?,?,?,?,?,?,?,?,?,?,?)";
+	DB_BATCH *b;
 	int i;
 
-	db = db_game_open_for_write();
-	if ( !db )
-		return;
-
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
+	if ( ( b = db_game_batch( "kingdoms" ) ) == NULL )
 		return;
-	}
-
-	db_begin( db );
 
 	for ( i = 1; i <= MAX_KINGDOM; i++ ) {
-		sqlite3_reset( stmt );
-		sqlite3_bind_int( stmt, 1, i );
-		sqlite3_bind_text( stmt, 2, kingdom_table[i].name, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( stmt, 3, kingdom_table[i].whoname, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( stmt, 4, kingdom_table[i].leader, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( stmt, 5, kingdom_table[i].general, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_int( stmt, 6, kingdom_table[i].kills );
-		sqlite3_bind_int( stmt, 7, kingdom_table[i].deaths );
-		sqlite3_bind_int( stmt, 8, kingdom_table[i].qps );
-		sqlite3_bind_int( stmt, 9, kingdom_table[i].req_hit );
-		sqlite3_bind_int( stmt, 10, kingdom_table[i].req_move );
-		sqlite3_bind_int( stmt, 11, kingdom_table[i].req_mana );
-		sqlite3_bind_int( stmt, 12, kingdom_table[i].req_qps );
-		sqlite3_step( stmt );
-	}
-
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+		db_batch_op( b, GSQL_KINGDOM_PUT );
+		db_batch_int( b, i );
+		db_batch_text( b, kingdom_table[i].name );
+		db_batch_text( b, kingdom_table[i].whoname );
+		db_batch_text( b, kingdom_table[i].leader );
+		db_batch_text( b, kingdom_table[i].general );
+		db_batch_int( b, kingdom_table[i].kills );
+		db_batch_int( b, kingdom_table[i].deaths );
+		db_batch_int( b, kingdom_table[i].qps );
+		db_batch_int( b, kingdom_table[i].req_hit );
+		db_batch_int( b, kingdom_table[i].req_move );
+		db_batch_int( b, kingdom_table[i].req_mana );
+		db_batch_int( b, kingdom_table[i].req_qps );
+	}
+
+	db_game_submit( b );
 }
 
 
@@ -916,87 +986,51 @@ void db_game_load_notes( int board_idx ) {
 		pnote->subject    = str_dup( col_text( stmt, 5 ) );
 		pnote->text       = str_dup( col_text( stmt, 6 ) );
 
-		list_push_back( &boards[board_idx].notes, &pnote->node );
+		board_append_note( &boards[board_idx], pnote );
 	}
 
 	sqlite3_finalize( stmt );
 }
 
+static void db_game_note_insert( DB_BATCH *b, int board_idx, NOTE_DATA *note ) {
+	db_batch_op( b, GSQL_NOTE_INSERT );
+	db_batch_int( b, board_idx );
+	db_batch_text( b, note->sender );
+	db_batch_text( b, note->date );
+	db_batch_int( b, (long long)note->date_stamp );
+	db_batch_int( b, (long long)note->expire );
+	db_batch_text( b, note->to_list );
+	db_batch_text( b, note->subject );
+	db_batch_text( b, note->text );
+}
+
 void db_game_save_board_notes( int board_idx ) {
-	sqlite3 *db;
-	sqlite3_stmt *del_stmt, *ins_stmt;
+	DB_BATCH *b;
 	NOTE_DATA *note;
+	char key[32];
 
-	db = db_game_open_for_write();
-	if ( !db )
+	snprintf( key, sizeof( key ), "notes:%d", board_idx );
+	if ( ( b = db_game_batch( key ) ) == NULL )
 		return;
 
-	db_begin( db );
-
-	/* Delete all notes for this board */
-	if ( sqlite3_prepare_v2( db,
-			"DELETE FROM notes WHERE board_idx=?",
-			-1, &del_stmt, NULL ) == SQLITE_OK ) {
-		sqlite3_bind_int( del_stmt, 1, board_idx );
-		sqlite3_step( del_stmt );
-		sqlite3_finalize( del_stmt );
-	}
-
-	/* Re-insert all current notes */
-	if ( sqlite3_prepare_v2( db,
-			"INSERT INTO notes (board_idx, sender, date, date_stamp, expire, "
-			"to_list, subject, text) VALUES (?,?,?,?,?,?,?,?)",
-			-1, &ins_stmt, NULL ) != SQLITE_OK ) {
-		db_rollback( db );
-		sqlite3_close( db );
-		return;
-	}
+	/* Delete all notes for this board, then re-insert the current ones */
+	db_batch_op( b, GSQL_NOTES_CLEAR );
+	db_batch_int( b, board_idx );
 
-	LIST_FOR_EACH( note, &boards[board_idx].notes, NOTE_DATA, node ) {
-		sqlite3_reset( ins_stmt );
-		sqlite3_bind_int( ins_stmt, 1, board_idx );
-		sqlite3_bind_text( ins_stmt, 2, note->sender, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( ins_stmt, 3, note->date, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_int64( ins_stmt, 4, (sqlite3_int64)note->date_stamp );
-		sqlite3_bind_int64( ins_stmt, 5, (sqlite3_int64)note->expire );
-		sqlite3_bind_text( ins_stmt, 6, note->to_list, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( ins_stmt, 7, note->subject, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( ins_stmt, 8, note->text, -1, SQLITE_TRANSIENT );
-		sqlite3_step( ins_stmt );
-	}
+	LIST_FOR_EACH( note, &boards[board_idx].notes, NOTE_DATA, node )
+		db_game_note_insert( b, board_idx, note );
 
-	sqlite3_finalize( ins_stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 void db_game_append_note( int board_idx, NOTE_DATA *note ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql =
-		"INSERT INTO notes (board_idx, sender, date, date_stamp, expire, "
-		"to_list, subject, text) VALUES (?,?,?,?,?,?,?,?)";
+	DB_BATCH *b;
 
-	db = db_game_open_for_write();
-	if ( !db )
-		return;
-
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
+	if ( ( b = db_game_batch( NULL ) ) == NULL )
 		return;
-	}
 
-	sqlite3_bind_int( stmt, 1, board_idx );
-	sqlite3_bind_text( stmt, 2, note->sender, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 3, note->date, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_int64( stmt, 4, (sqlite3_int64)note->date_stamp );
-	sqlite3_bind_int64( stmt, 5, (sqlite3_int64)note->expire );
-	sqlite3_bind_text( stmt, 6, note->to_list, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 7, note->subject, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 8, note->text, -1, SQLITE_TRANSIENT );
-	sqlite3_step( stmt );
-	sqlite3_finalize( stmt );
-	sqlite3_close( db );
+	db_game_note_insert( b, board_idx, note );
+	db_game_submit( b );
 }
 
 
@@ -1005,27 +1039,17 @@ void db_game_append_note( int board_idx, NOTE_DATA *note ) {
  * Append-only log of player bug reports and system bugs.
  */
 void db_game_append_bug( int room_vnum, const char *player, const char *message ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql =
-		"INSERT INTO bugs (room_vnum, player, message, timestamp) VALUES (?,?,?,?)";
-
-	db = db_game_open_for_write();
-	if ( !db )
-		return;
+	DB_BATCH *b;
 
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
+	if ( ( b = db_game_batch( NULL ) ) == NULL )
 		return;
-	}
 
-	sqlite3_bind_int( stmt, 1, room_vnum );
-	sqlite3_bind_text( stmt, 2, player, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 3, message, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_int64( stmt, 4, (sqlite3_int64)current_time );
-	sqlite3_step( stmt );
-	sqlite3_finalize( stmt );
-	sqlite3_close( db );
+	db_batch_op( b, GSQL_BUG_INSERT );
+	db_batch_int( b, room_vnum );
+	db_batch_text( b, player );
+	db_batch_text( b, message );
+	db_batch_int( b, (long long)current_time );
+	db_game_submit( b );
 }
 
 
@@ -1055,35 +1079,21 @@ void db_game_load_bans( void ) {
 }
 
 void db_game_save_bans( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
+	DB_BATCH *b;
 	BAN_DATA *p;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( "bans" ) ) == NULL )
 		return;
 
-	db_begin( db );
-	sqlite3_exec( db, "DELETE FROM bans", NULL, NULL, NULL );
-
-	if ( sqlite3_prepare_v2( db,
-			"INSERT INTO bans (name, reason) VALUES (?,?)",
-			-1, &stmt, NULL ) != SQLITE_OK ) {
-		db_rollback( db );
-		sqlite3_close( db );
-		return;
-	}
+	db_batch_op( b, GSQL_BANS_CLEAR );
 
 	LIST_FOR_EACH( p, &ban_list, BAN_DATA, node ) {
-		sqlite3_reset( stmt );
-		sqlite3_bind_text( stmt, 1, p->name, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( stmt, 2, p->reason, -1, SQLITE_TRANSIENT );
-		sqlite3_step( stmt );
+		db_batch_op( b, GSQL_BAN_INSERT );
+		db_batch_text( b, p->name );
+		db_batch_text( b, p->reason );
 	}
 
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -1125,40 +1135,22 @@ void db_game_load_disabled( void ) {
 }
 
 void db_game_save_disabled( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
+	DB_BATCH *b;
 	DISABLED_DATA *p;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( "disabled" ) ) == NULL )
 		return;
 
-	db_begin( db );
-	sqlite3_exec( db, "DELETE FROM disabled_commands", NULL, NULL, NULL );
-
-	if ( !list_empty( &disabled_list ) ) {
-		if ( sqlite3_prepare_v2( db,
-				"INSERT INTO disabled_commands (command_name, level, disabled_by) "
-				"VALUES (?,?,?)",
-				-1, &stmt, NULL ) != SQLITE_OK ) {
-			db_rollback( db );
-			sqlite3_close( db );
-			return;
-		}
-
-		LIST_FOR_EACH( p, &disabled_list, DISABLED_DATA, node ) {
-			sqlite3_reset( stmt );
-			sqlite3_bind_text( stmt, 1, p->command->name, -1, SQLITE_TRANSIENT );
-			sqlite3_bind_int( stmt, 2, p->level );
-			sqlite3_bind_text( stmt, 3, p->disabled_by, -1, SQLITE_TRANSIENT );
-			sqlite3_step( stmt );
-		}
+	db_batch_op( b, GSQL_DISABLED_CLEAR );
 
-		sqlite3_finalize( stmt );
+	LIST_FOR_EACH( p, &disabled_list, DISABLED_DATA, node ) {
+		db_batch_op( b, GSQL_DISABLED_INSERT );
+		db_batch_text( b, p->command->name );
+		db_batch_int( b, p->level );
+		db_batch_text( b, p->disabled_by );
 	}
 
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -1198,21 +1190,11 @@ void db_game_load_cfg( void ) {
 }
 
 void db_game_save_cfg( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "INSERT OR REPLACE INTO config (key, value) VALUES (?,?)";
+	DB_BATCH *b;
 	int i, total;
 
-	db = db_game_open_for_write();
-	if ( !db )
-		return;
-
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
+	if ( ( b = db_game_batch( "cfg" ) ) == NULL )
 		return;
-	}
-
-	db_begin( db );
 
 	/* Only save values that differ from defaults */
 	total = cfg_count();
@@ -1220,15 +1202,12 @@ void db_game_save_cfg( void ) {
 		cfg_entry_t *e = cfg_entry_by_index( i );
 		if ( !e || e->value == e->default_value )
 			continue;
-		sqlite3_reset( stmt );
-		sqlite3_bind_text( stmt, 1, e->key, -1, SQLITE_STATIC );
-		sqlite3_bind_int( stmt, 2, e->value );
-		sqlite3_step( stmt );
+		db_batch_op( b, GSQL_CFG_PUT );
+		db_batch_text( b, e->key );
+		db_batch_int( b, e->value );
 	}
 
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -1246,7 +1225,7 @@ bool db_game_is_super_admin( const char *name ) {
 	if ( !name || !name[0] )
 		return FALSE;
 
-	db = db_game_open_for_write();
+	db = db_game_open_for_read();
 	if ( !db )
 		return FALSE;
 
@@ -1266,49 +1245,31 @@ bool db_game_is_super_admin( const char *name ) {
 }
 
 void db_game_add_super_admin( const char *name ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "INSERT OR IGNORE INTO super_admins (name) VALUES (?)";
+	DB_BATCH *b;
 
 	if ( !name || !name[0] )
 		return;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( NULL ) ) == NULL )
 		return;
 
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
-		return;
-	}
-
-	sqlite3_bind_text( stmt, 1, name, -1, SQLITE_TRANSIENT );
-	sqlite3_step( stmt );
-	sqlite3_finalize( stmt );
-	sqlite3_close( db );
+	db_batch_op( b, GSQL_SUPER_ADMIN_ADD );
+	db_batch_text( b, name );
+	db_game_submit( b );
 }
 
 void db_game_remove_super_admin( const char *name ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "DELETE FROM super_admins WHERE name = ?";
+	DB_BATCH *b;
 
 	if ( !name || !name[0] )
 		return;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( NULL ) ) == NULL )
 		return;
 
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
-		return;
-	}
-
-	sqlite3_bind_text( stmt, 1, name, -1, SQLITE_TRANSIENT );
-	sqlite3_step( stmt );
-	sqlite3_finalize( stmt );
-	sqlite3_close( db );
+	db_batch_op( b, GSQL_SUPER_ADMIN_DEL );
+	db_batch_text( b, name );
+	db_game_submit( b );
 }
 
 void db_game_list_super_admins( CHAR_DATA *ch ) {
@@ -1317,7 +1278,7 @@ void db_game_list_super_admins( CHAR_DATA *ch ) {
 	const char *sql = "SELECT name FROM super_admins ORDER BY name";
 	int count = 0;
 
-	db = db_game_open_for_write();
+	db = db_game_open_for_read();
 	if ( !db ) {
 		send_to_char( "Database not available.\n\r", ch );
 		return;
@@ -1359,6 +1320,10 @@ static AUDIO_ENTRY *audio_entries = NULL;
 static int audio_entry_count = 0;
 static int audio_entry_alloc = 0;
 
+/* (category, trigger_key) -> entry index + 1, 0 = empty; open addressing */
+static int *audio_hash = NULL;
+static int audio_hash_size = 0;
+
 /* Sector-indexed lookup arrays */
 AUDIO_ENTRY *audio_ambient[SECT_MAX];
 AUDIO_ENTRY *audio_footstep[SECT_MAX];
@@ -1379,6 +1344,51 @@ static int parse_sector_key( const char *key ) {
 	return -1;
 }
 
+/* Case-folded FNV-1a over category, a separator, then trigger_key */
+static unsigned int audio_hash_key( const char *category, const char *trigger_key ) {
+	unsigned int h = 2166136261u;
+	const char *p;
+
+	for ( p = category; *p != '\0'; p++ ) {
+		h ^= (unsigned char) tolower( (unsigned char) *p );
+		h *= 16777619u;
+	}
+	h ^= '\n';
+	h *= 16777619u;
+	for ( p = trigger_key; *p != '\0'; p++ ) {
+		h ^= (unsigned char) tolower( (unsigned char) *p );
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/* Index every loaded entry; a later duplicate of a pair never shadows the first */
+static void audio_hash_build( void ) {
+	int i, h;
+
+	free( audio_hash );
+	audio_hash = NULL;
+	audio_hash_size = 0;
+	if ( audio_entry_count == 0 )
+		return;
+
+	for ( audio_hash_size = 16; audio_hash_size < audio_entry_count * 2; )
+		audio_hash_size *= 2;
+	audio_hash = calloc( audio_hash_size, sizeof( int ) );
+	if ( !audio_hash ) { bug( "audio_hash_build: calloc failed", 0 ); exit( 1 ); }
+
+	for ( i = 0; i < audio_entry_count; i++ ) {
+		AUDIO_ENTRY *ae = &audio_entries[i];
+
+		if ( audio_config_find( ae->category, ae->trigger_key ) != NULL )
+			continue;
+		h = audio_hash_key( ae->category, ae->trigger_key ) & ( audio_hash_size - 1 );
+		while ( audio_hash[h] != 0 )
+			h = ( h + 1 ) & ( audio_hash_size - 1 );
+		audio_hash[h] = i + 1;
+	}
+}
+
 /*
  * Load audio config from database into memory.
  * Call this during boot after db_game_init().
@@ -1410,6 +1420,7 @@ void db_game_load_audio_config( void ) {
 		audio_entry_count = 0;
 		audio_entry_alloc = 0;
 	}
+	audio_hash_build();
 
 	/* Clear sector lookup arrays */
 	for ( i = 0; i < SECT_MAX; i++ ) {
@@ -1457,6 +1468,8 @@ void db_game_load_audio_config( void ) {
 
 	sqlite3_finalize( stmt );
 
+	audio_hash_build();
+
 	/* Build sector-indexed lookup arrays */
 	for ( i = 0; i < audio_entry_count; i++ ) {
 		AUDIO_ENTRY *ae = &audio_entries[i];
@@ -1483,15 +1496,18 @@ void db_game_load_audio_config( void ) {
  * Returns NULL if not found.
  */
 AUDIO_ENTRY *audio_config_find( const char *category, const char *trigger_key ) {
-	int i;
+	AUDIO_ENTRY *ae;
+	int h;
 
-	if ( category == NULL || trigger_key == NULL )
+	if ( category == NULL || trigger_key == NULL || audio_hash == NULL )
 		return NULL;
 
-	for ( i = 0; i < audio_entry_count; i++ ) {
-		if ( !str_cmp( audio_entries[i].category, category ) &&
-		     !str_cmp( audio_entries[i].trigger_key, trigger_key ) )
-			return &audio_entries[i];
+	h = audio_hash_key( category, trigger_key ) & ( audio_hash_size - 1 );
+	for ( ; audio_hash[h] != 0; h = ( h + 1 ) & ( audio_hash_size - 1 ) ) {
+		ae = &audio_entries[audio_hash[h] - 1];
+		if ( !str_cmp( ae->category, category ) &&
+		     !str_cmp( ae->trigger_key, trigger_key ) )
+			return ae;
 	}
 
 	return NULL;
@@ -1501,42 +1517,30 @@ AUDIO_ENTRY *audio_config_find( const char *category, const char *trigger_key )
  * Save a single audio config entry to the database.
  */
 static void audio_config_save_entry( AUDIO_ENTRY *ae ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "UPDATE audio_config SET filename=?, volume=?, priority=?, "
-		"loops=?, media_type=?, tag=?, caption=?, use_key=?, use_continue=? "
-		"WHERE category=? AND trigger_key=?";
+	DB_BATCH *b;
+	char key[MAX_INPUT_LENGTH];
 
 	if ( !ae )
 		return;
 
-	db = db_game_open_for_write();
-	if ( !db )
-		return;
-
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
-		return;
-	}
-
-	sqlite3_bind_text( stmt, 1, ae->filename, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_int( stmt, 2, ae->volume );
-	sqlite3_bind_int( stmt, 3, ae->priority );
-	sqlite3_bind_int( stmt, 4, ae->loops );
-	sqlite3_bind_text( stmt, 5, ae->media_type, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 6, ae->tag, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 7, ae->caption, -1, SQLITE_TRANSIENT );
-	if ( ae->use_key )
-		sqlite3_bind_text( stmt, 8, ae->use_key, -1, SQLITE_TRANSIENT );
-	else
-		sqlite3_bind_null( stmt, 8 );
-	sqlite3_bind_int( stmt, 9, ae->use_continue ? 1 : 0 );
-	sqlite3_bind_text( stmt, 10, ae->category, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 11, ae->trigger_key, -1, SQLITE_TRANSIENT );
-
-	sqlite3_step( stmt );
-	sqlite3_finalize( stmt );
-	sqlite3_close( db );
+	/* Each save writes the whole row, so only the latest edit matters */
+	snprintf( key, sizeof( key ), "audio:%s:%s", ae->category, ae->trigger_key );
+	if ( ( b = db_game_batch( key ) ) == NULL )
+		return;
+
+	db_batch_op( b, GSQL_AUDIO_UPDATE );
+	db_batch_text( b, ae->filename );
+	db_batch_int( b, ae->volume );
+	db_batch_int( b, ae->priority );
+	db_batch_int( b, ae->loops );
+	db_batch_text( b, ae->media_type );
+	db_batch_text( b, ae->tag );
+	db_batch_text( b, ae->caption );
+	db_batch_text( b, ae->use_key );
+	db_batch_int( b, ae->use_continue ? 1 : 0 );
+	db_batch_text( b, ae->category );
+	db_batch_text( b, ae->trigger_key );
+	db_game_submit( b );
 }
 
 /*
@@ -1752,7 +1756,7 @@ void db_game_load_pretitles( void ) {
 	}
 
 	/* Use global game_db if available (during boot), otherwise open fresh */
-	db = game_db ? game_db : db_game_open_for_write();
+	db = game_db ? game_db : db_game_open_for_read();
 	if ( !db )
 		return;
 
@@ -1807,56 +1811,37 @@ const char *db_game_get_pretitle( const char *name ) {
 }
 
 void db_game_set_pretitle( const char *name, const char *pretitle, const char *set_by ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "INSERT OR REPLACE INTO immortal_pretitles "
-		"(immortal_name, pretitle, set_by, set_date) VALUES (?,?,?,?)";
+	DB_BATCH *b;
 
 	if ( !name || !name[0] || !pretitle || !pretitle[0] )
 		return;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( NULL ) ) == NULL )
 		return;
 
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
-		return;
-	}
-
-	sqlite3_bind_text( stmt, 1, name, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 2, pretitle, -1, SQLITE_TRANSIENT );
-	sqlite3_bind_text( stmt, 3, set_by ? set_by : "system", -1, SQLITE_TRANSIENT );
-	sqlite3_bind_int64( stmt, 4, (sqlite3_int64)current_time );
-	sqlite3_step( stmt );
-	sqlite3_finalize( stmt );
-	sqlite3_close( db );
+	db_batch_op( b, GSQL_PRETITLE_PUT );
+	db_batch_text( b, name );
+	db_batch_text( b, pretitle );
+	db_batch_text( b, set_by ? set_by : "system" );
+	db_batch_int( b, (long long)current_time );
+	db_game_submit( b );
 
 	/* Reload the cache */
 	db_game_load_pretitles();
 }
 
 void db_game_delete_pretitle( const char *name ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
-	const char *sql = "DELETE FROM immortal_pretitles WHERE immortal_name = ?";
+	DB_BATCH *b;
 
 	if ( !name || !name[0] )
 		return;
 
-	db = db_game_open_for_write();
-	if ( !db )
-		return;
-
-	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) != SQLITE_OK ) {
-		sqlite3_close( db );
+	if ( ( b = db_game_batch( NULL ) ) == NULL )
 		return;
-	}
 
-	sqlite3_bind_text( stmt, 1, name, -1, SQLITE_TRANSIENT );
-	sqlite3_step( stmt );
-	sqlite3_finalize( stmt );
-	sqlite3_close( db );
+	db_batch_op( b, GSQL_PRETITLE_DEL );
+	db_batch_text( b, name );
+	db_game_submit( b );
 
 	/* Reload the cache */
 	db_game_load_pretitles();
@@ -2080,42 +2065,30 @@ void db_game_load_forbidden_names( void ) {
 
 	snprintf( buf, sizeof( buf ), "  Loaded %d forbidden name rules.", count );
 	log_string( buf );
+
+	textfilter_rebuild();
 }
 
 /*
  * Save forbidden names from memory to game.db.
  */
 void db_game_save_forbidden_names( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
+	DB_BATCH *b;
 	FORBIDDEN_NAME *p;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( "forbidden_names" ) ) == NULL )
 		return;
 
-	db_begin( db );
-	sqlite3_exec( db, "DELETE FROM forbidden_names", NULL, NULL, NULL );
-
-	if ( sqlite3_prepare_v2( db,
-			"INSERT INTO forbidden_names (name, type, added_by) VALUES (?,?,?)",
-			-1, &stmt, NULL ) != SQLITE_OK ) {
-		db_rollback( db );
-		sqlite3_close( db );
-		return;
-	}
+	db_batch_op( b, GSQL_FORBIDDEN_CLEAR );
 
 	LIST_FOR_EACH( p, &forbidden_name_list, FORBIDDEN_NAME, node ) {
-		sqlite3_reset( stmt );
-		sqlite3_bind_text( stmt, 1, p->name, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_int( stmt, 2, p->type );
-		sqlite3_bind_text( stmt, 3, p->added_by, -1, SQLITE_TRANSIENT );
-		sqlite3_step( stmt );
+		db_batch_op( b, GSQL_FORBIDDEN_INSERT );
+		db_batch_text( b, p->name );
+		db_batch_int( b, p->type );
+		db_batch_text( b, p->added_by );
 	}
 
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -2157,41 +2130,29 @@ void db_game_load_profanity_filters( void ) {
 
 	snprintf( buf, sizeof( buf ), "  Loaded %d profanity filter patterns.", count );
 	log_string( buf );
+
+	textfilter_rebuild();
 }
 
 /*
  * Save profanity filters from memory to game.db.
  */
 void db_game_save_profanity_filters( void ) {
-	sqlite3 *db;
-	sqlite3_stmt *stmt;
+	DB_BATCH *b;
 	PROFANITY_FILTER *p;
 
-	db = db_game_open_for_write();
-	if ( !db )
+	if ( ( b = db_game_batch( "profanity_filters" ) ) == NULL )
 		return;
 
-	db_begin( db );
-	sqlite3_exec( db, "DELETE FROM profanity_filters", NULL, NULL, NULL );
-
-	if ( sqlite3_prepare_v2( db,
-			"INSERT INTO profanity_filters (pattern, added_by) VALUES (?,?)",
-			-1, &stmt, NULL ) != SQLITE_OK ) {
-		db_rollback( db );
-		sqlite3_close( db );
-		return;
-	}
+	db_batch_op( b, GSQL_PROFANITY_CLEAR );
 
 	LIST_FOR_EACH( p, &profanity_filter_list, PROFANITY_FILTER, node ) {
-		sqlite3_reset( stmt );
-		sqlite3_bind_text( stmt, 1, p->pattern, -1, SQLITE_TRANSIENT );
-		sqlite3_bind_text( stmt, 2, p->added_by, -1, SQLITE_TRANSIENT );
-		sqlite3_step( stmt );
+		db_batch_op( b, GSQL_PROFANITY_INSERT );
+		db_batch_text( b, p->pattern );
+		db_batch_text( b, p->added_by );
 	}
 
-	sqlite3_finalize( stmt );
-	db_commit( db );
-	sqlite3_close( db );
+	db_game_submit( b );
 }
 
 
@@ -2256,4 +2217,7 @@ void db_game_load_confusables( void ) {
 
 	snprintf( buf, sizeof( buf ), "  Loaded %d confusable character mappings.", count );
 	log_string( buf );
+
+	/* Patterns are matched by skeleton, which these just changed */
+	textfilter_rebuild();
 }
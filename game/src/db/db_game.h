@@ -14,6 +14,7 @@
 
 #include "../core/merc.h"
 #include "db_class.h"
+#include "db_writer.h"
 
 /* Initialize game databases (creates game/ subdir, opens connections) */
 void db_game_init( void );
@@ -21,6 +22,13 @@ void db_game_init( void );
 /* Close game database connections after boot (data cached in memory) */
 void db_game_close_boot_connections( void );
 
+/* game.db write-behind queue (db_writer.c) */
+void db_game_writer_pulse( void );  /* Once a pulse: group commit every second */
+void db_game_flush( void );         /* Commit everything queued and wait */
+void db_game_close_writer( void );  /* Flush and close at shutdown */
+void db_game_writer_stats( DB_WRITER_STATS *out );
+void db_game_writer_report( CHAR_DATA *ch );
+
 /* Help entries (base_help.db + live_help.db) */
 void db_game_load_helps( void );
 void db_game_save_helps( void );
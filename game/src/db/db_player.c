@@ -15,6 +15,7 @@
 #include <string.h>
 #include "../systems/profile.h"
 #include "../core/compat.h"
+#include "../core/prompt.h"
 
 /* External globals */
 extern char mud_db_dir[MUD_PATH_MAX];
@@ -494,7 +495,7 @@ static int format_short_array( char *buf, size_t bufsize, const int *arr, int co
  * Much faster than 26 individual INSERT statements.
  */
 static void save_all_arrays( sqlite3 *db, CHAR_DATA *ch ) {
-	PROFILE_START( "save_arrays" );
+	PROFILE_START( PROF_SAVE_ARRAYS );
 	/* Pre-allocated buffers for each array's data string */
 	char power[512], stance[256], gifts[256], paradox[64], monkab[64], damcap[64];
 	char wpn[128], spl[64], cmbt[128], loc_hp[64], chi_buf[64], focus_buf[64];
@@ -615,7 +616,7 @@ static void save_all_arrays( sqlite3 *db, CHAR_DATA *ch ) {
 		sqlite3_step( stmt );
 		sqlite3_finalize( stmt );
 	}
-	PROFILE_END( "save_arrays" );
+	PROFILE_END( PROF_SAVE_ARRAYS );
 }
 
 
@@ -729,7 +730,7 @@ bool db_player_delete( const char *name ) {
  * reconstructed using nest levels on load.
  */
 static void save_objects( sqlite3 *db, CHAR_DATA *ch ) {
-	PROFILE_START( "save_objects" );
+	PROFILE_START( PROF_SAVE_OBJECTS );
 	sqlite3_stmt *obj_stmt = NULL;
 	sqlite3_stmt *aff_stmt = NULL;
 	sqlite3_stmt *ed_stmt = NULL;
@@ -910,7 +911,7 @@ static void save_objects( sqlite3 *db, CHAR_DATA *ch ) {
 	sqlite3_finalize( obj_stmt );
 	sqlite3_finalize( aff_stmt );
 	sqlite3_finalize( ed_stmt );
-	PROFILE_END( "save_objects" );
+	PROFILE_END( PROF_SAVE_OBJECTS );
 }
 
 
@@ -924,7 +925,7 @@ static void db_player_save_to_db( sqlite3 *db, CHAR_DATA *ch ) {
 	AFFECT_DATA *paf;
 	ALIAS_DATA *ali;
 
-	PROFILE_START( "save_delete_all" );
+	PROFILE_START( PROF_SAVE_DELETE_ALL );
 	/* Clear all tables for full rewrite (batched for efficiency) */
 	sqlite3_exec( db,
 		"DELETE FROM player;"
@@ -937,7 +938,9 @@ static void db_player_save_to_db( sqlite3 *db, CHAR_DATA *ch ) {
 		"DELETE FROM obj_affects;"
 		"DELETE FROM obj_extra_descr",
 		NULL, NULL, NULL );
-	PROFILE_END( "save_delete_all" );
+	PROFILE_END( PROF_SAVE_DELETE_ALL );
+
+	PROFILE_START( PROF_SAVE_PLAYER_ROW );
 	/* ================================================================
 	 * Player table - single row with all scalar fields
 	 * ================================================================ */
@@ -1125,14 +1128,14 @@ static void db_player_save_to_db( sqlite3 *db, CHAR_DATA *ch ) {
 		sqlite3_step( stmt );
 		sqlite3_finalize( stmt );
 	}
-	PROFILE_END( "save_player_row" );
+	PROFILE_END( PROF_SAVE_PLAYER_ROW );
 
 	/* ================================================================
 	 * Integer arrays (batched for efficiency - 27 arrays in 1 INSERT)
 	 * ================================================================ */
 	save_all_arrays( db, ch );
 
-	PROFILE_START( "save_skills" );
+	PROFILE_START( PROF_SAVE_SKILLS );
 	/* ================================================================
 	 * Skills (only non-zero)
 	 * ================================================================ */
@@ -1150,9 +1153,9 @@ static void db_player_save_to_db( sqlite3 *db, CHAR_DATA *ch ) {
 			sqlite3_finalize( stmt );
 		}
 	}
-	PROFILE_END( "save_skills" );
+	PROFILE_END( PROF_SAVE_SKILLS );
 
-	PROFILE_START( "save_aliases" );
+	PROFILE_START( PROF_SAVE_ALIASES );
 	/* ================================================================
 	 * Aliases
 	 * ================================================================ */
@@ -1168,9 +1171,9 @@ static void db_player_save_to_db( sqlite3 *db, CHAR_DATA *ch ) {
 			sqlite3_finalize( stmt );
 		}
 	}
-	PROFILE_END( "save_aliases" );
+	PROFILE_END( PROF_SAVE_ALIASES );
 
-	PROFILE_START( "save_affects" );
+	PROFILE_START( PROF_SAVE_AFFECTS );
 	/* ================================================================
 	 * Character affects
 	 * ================================================================ */
@@ -1193,9 +1196,9 @@ static void db_player_save_to_db( sqlite3 *db, CHAR_DATA *ch ) {
 			sqlite3_finalize( stmt );
 		}
 	}
-	PROFILE_END( "save_affects" );
+	PROFILE_END( PROF_SAVE_AFFECTS );
 
-	PROFILE_START( "save_boards" );
+	PROFILE_START( PROF_SAVE_BOARDS );
 	/* ================================================================
 	 * Board timestamps (only save non-zero timestamps)
 	 * ================================================================ */
@@ -1213,7 +1216,7 @@ static void db_player_save_to_db( sqlite3 *db, CHAR_DATA *ch ) {
 			sqlite3_finalize( stmt );
 		}
 	}
-	PROFILE_END( "save_boards" );
+	PROFILE_END( PROF_SAVE_BOARDS );
 
 	/* ================================================================
 	 * Quest Progress
@@ -1248,23 +1251,23 @@ void db_player_save( CHAR_DATA *ch ) {
 	if ( IS_NPC( ch ) || ch->level < 2 )
 		return;
 
-	PROFILE_START( "db_player_save" );
+	PROFILE_START( PROF_DB_PLAYER_SAVE );
 
 	/* Build path for background thread */
 	if ( db_player_path( ch->pcdata->switchname, path, sizeof( path ) ) < 0 ) {
-		PROFILE_END( "db_player_save" );
+		PROFILE_END( PROF_DB_PLAYER_SAVE );
 		return;
 	}
 
 	/* Open in-memory database with schema */
 	if ( sqlite3_open( ":memory:", &db ) != SQLITE_OK ) {
-		PROFILE_END( "db_player_save" );
+		PROFILE_END( PROF_DB_PLAYER_SAVE );
 		return;
 	}
 
 	if ( sqlite3_exec( db, PLAYER_SCHEMA_SQL, NULL, NULL, NULL ) != SQLITE_OK ) {
 		sqlite3_close( db );
-		PROFILE_END( "db_player_save" );
+		PROFILE_END( PROF_DB_PLAYER_SAVE );
 		return;
 	}
 
@@ -1279,7 +1282,7 @@ void db_player_save( CHAR_DATA *ch ) {
 
 	if ( serialized == NULL || size == 0 ) {
 		if ( serialized ) sqlite3_free( serialized );
-		PROFILE_END( "db_player_save" );
+		PROFILE_END( PROF_DB_PLAYER_SAVE );
 		return;
 	}
 
@@ -1287,7 +1290,7 @@ void db_player_save( CHAR_DATA *ch ) {
 	task = (PLAYER_SAVE_TASK *)malloc( sizeof( PLAYER_SAVE_TASK ) );
 	if ( task == NULL ) {
 		sqlite3_free( serialized );
-		PROFILE_END( "db_player_save" );
+		PROFILE_END( PROF_DB_PLAYER_SAVE );
 		return;
 	}
 
@@ -1320,7 +1323,7 @@ void db_player_save( CHAR_DATA *ch ) {
 		pthread_mutex_unlock( &save_mutex );
 	}
 
-	PROFILE_END( "db_player_save" );
+	PROFILE_END( PROF_DB_PLAYER_SAVE );
 }
 
 
@@ -1566,6 +1569,7 @@ static void load_player_row( sqlite3 *db, CHAR_DATA *ch ) {
 		ch->pcdata->prompt = str_dup( col_text( stmt, col++ ) );
 		free(ch->pcdata->cprompt);
 		ch->pcdata->cprompt = str_dup( col_text( stmt, col++ ) );
+		prompt_recompile( ch );
 		/* PC-only strings */
 		free(ch->pcdata->pwd);
 		ch->pcdata->pwd = str_dup( col_text( stmt, col++ ) );
@@ -1981,6 +1985,8 @@ static void load_player_objects( sqlite3 *db, CHAR_DATA *ch ) {
 		list_node_init( &obj->obj_node );
 		list_node_init( &obj->room_node );
 		list_node_init( &obj->content_node );
+		list_node_init( &obj->script_node );
+		list_node_init( &obj->proto_node );
 		list_init( &obj->affects );
 		list_init( &obj->contents );
 		list_init( &obj->extra_descr );
@@ -2083,6 +2089,7 @@ static void load_player_objects( sqlite3 *db, CHAR_DATA *ch ) {
 
 		/* Link into global object list */
 		list_push_back( &g_objects, &obj->obj_node );
+		list_push_back( &obj->pIndexData->instances, &obj->proto_node );
 		obj->pIndexData->count++;
 
 		/* Nest into inventory or container */
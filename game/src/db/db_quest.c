@@ -36,6 +36,50 @@ static int       quest_count = 0;
 static char story_clue_table[STORY_NODE_MAX + 1][STORY_STAGE_COUNT][STORY_CLUE_MAX];
 static int  story_clue_count = 0;
 
+/*--------------------------------------------------------------------------
+ * Objective type names, indexed by QOT_*
+ *--------------------------------------------------------------------------*/
+
+static const char *quest_obj_type_names[QOT_MAX] = {
+    "",
+    QOBJ_USE_COMMAND,
+    QOBJ_KILL_MOB,
+    QOBJ_KILL_PLAYER,
+    QOBJ_VISIT_ROOM,
+    QOBJ_VISIT_AREA,
+    QOBJ_REACH_STAT,
+    QOBJ_REACH_GEN,
+    QOBJ_REACH_PKSCORE,
+    QOBJ_REACH_UPGRADE,
+    QOBJ_EARN_QP,
+    QOBJ_LEARN_STANCE,
+    QOBJ_LEARN_SUPERSTANCE,
+    QOBJ_LEARN_DISCIPLINE,
+    QOBJ_WEAPON_SKILL,
+    QOBJ_SPELL_SKILL,
+    QOBJ_FORGE_ITEM,
+    QOBJ_QUEST_CREATE,
+    QOBJ_QUEST_MODIFY,
+    QOBJ_ARENA_WIN,
+    QOBJ_COLLECT_ITEM,
+    QOBJ_COMPLETE_QUEST,
+    QOBJ_MASTERY,
+    QOBJ_CLASS_TRAIN,
+    QOBJ_CLASS_POWER,
+};
+
+/*--------------------------------------------------------------------------
+ * Target atoms: open-addressed hash over every objective target string.
+ * The names point into quest_defs, which never move.
+ *--------------------------------------------------------------------------*/
+
+#define QUEST_ATOM_MAX   ( MAX_QUEST_DEFS * MAX_QUEST_OBJECTIVES + 1 )
+#define QUEST_ATOM_HASH  4096   /* Power of two, > 2 * QUEST_ATOM_MAX  */
+
+static const char *quest_atom_names[QUEST_ATOM_MAX];
+static int         quest_atom_count = 0;
+static int         quest_atom_hash[QUEST_ATOM_HASH];  /* atom + 1, 0 = empty */
+
 /*--------------------------------------------------------------------------
  * Player progress table schema (added to each player.db)
  *--------------------------------------------------------------------------*/
@@ -63,6 +107,104 @@ static void safe_copy( char *dst, int dst_size, const char *src ) {
     snprintf( dst, dst_size, "%s", src );
 }
 
+/*--------------------------------------------------------------------------
+ * Interning: objective types and targets
+ *--------------------------------------------------------------------------*/
+
+int quest_obj_type_lookup( const char *type ) {
+    int t;
+
+    if ( !type ) return QOT_NONE;
+    for ( t = 1; t < QOT_MAX; t++ ) {
+        if ( !strcmp( quest_obj_type_names[t], type ) )
+            return t;
+    }
+    return QOT_NONE;
+}
+
+static unsigned int quest_atom_hash_str( const char *s ) {
+    unsigned int h = 2166136261u;
+
+    for ( ; *s != '\0'; s++ ) {
+        h ^= (unsigned char) *s;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+int quest_atom_find( const char *target ) {
+    unsigned int h;
+
+    if ( !target ) return QUEST_ATOM_NONE;
+    for ( h = quest_atom_hash_str( target ) & ( QUEST_ATOM_HASH - 1 );
+          quest_atom_hash[h] != 0;
+          h = ( h + 1 ) & ( QUEST_ATOM_HASH - 1 ) ) {
+        if ( !strcmp( quest_atom_names[quest_atom_hash[h] - 1], target ) )
+            return quest_atom_hash[h] - 1;
+    }
+    return QUEST_ATOM_NONE;
+}
+
+static int quest_atom_intern( const char *target ) {
+    unsigned int h;
+    int atom = quest_atom_find( target );
+
+    if ( atom != QUEST_ATOM_NONE )
+        return atom;
+    if ( quest_atom_count >= QUEST_ATOM_MAX ) {
+        bug( "quest_atom_intern: too many objective targets.", 0 );
+        return QUEST_ATOM_NONE;
+    }
+
+    atom = quest_atom_count++;
+    quest_atom_names[atom] = target;
+    for ( h = quest_atom_hash_str( target ) & ( QUEST_ATOM_HASH - 1 );
+          quest_atom_hash[h] != 0;
+          h = ( h + 1 ) & ( QUEST_ATOM_HASH - 1 ) )
+        ;
+    quest_atom_hash[h] = atom + 1;
+    return atom;
+}
+
+/* Fill in type_id, target_atom, target_kind and target_arg */
+static void quest_intern_objective( QUEST_OBJ_DEF *obj ) {
+    int d;
+
+    obj->type_id     = quest_obj_type_lookup( obj->type );
+    obj->target_atom = quest_atom_intern( obj->target );
+    obj->target_arg  = 0;
+
+    if ( !strcmp( obj->target, "any" ) )       obj->target_kind = QTGT_ANY;
+    else if ( !strcmp( obj->target, "all" ) )  obj->target_kind = QTGT_ALL;
+    else if ( !strcmp( obj->target, "hp" ) )   obj->target_kind = QTGT_HP;
+    else if ( !strcmp( obj->target, "mana" ) ) obj->target_kind = QTGT_MANA;
+    else if ( !strcmp( obj->target, "move" ) ) obj->target_kind = QTGT_MOVE;
+    else if ( !strcmp( obj->target, "class" ) ) obj->target_kind = QTGT_CLASS;
+    else if ( !strncmp( obj->target, "count_", 6 ) ) {
+        obj->target_kind = QTGT_COUNT;
+        obj->target_arg  = atoi( obj->target + 6 );
+    }
+    else obj->target_kind = QTGT_NAME;
+
+    if ( obj->type_id == QOT_CLASS_POWER ) {
+        obj->target_kind = QTGT_NAME;
+        for ( d = 1; d < MAX_DISCIPLINES; d++ ) {
+            if ( discipline[d][0] != '\0' && !str_cmp( obj->target, discipline[d] ) ) {
+                obj->target_kind = QTGT_DISCIPLINE;
+                obj->target_arg  = d;
+                break;
+            }
+        }
+    }
+
+    if ( obj->type_id == QOT_NONE ) {
+        char buf[MAX_STRING_LENGTH];
+        snprintf( buf, sizeof( buf ),
+            "db_quest_init: unknown objective type '%s'.", obj->type );
+        bug( buf, 0 );
+    }
+}
+
 /*--------------------------------------------------------------------------
  * Lifecycle: Load quest definitions from quest.db
  *--------------------------------------------------------------------------*/
@@ -101,6 +243,9 @@ void db_quest_init( void ) {
     }
 
     quest_count = 0;
+    quest_atom_count = 0;
+    memset( quest_atom_hash, 0, sizeof( quest_atom_hash ) );
+    quest_atom_intern( "any" );  /* QUEST_ATOM_ANY */
     while ( sqlite3_step( stmt ) == SQLITE_ROW && quest_count < MAX_QUEST_DEFS ) {
         QUEST_DEF *q = &quest_defs[quest_count];
         memset( q, 0, sizeof( *q ) );
@@ -145,6 +290,7 @@ void db_quest_init( void ) {
             safe_copy( obj->target,      sizeof( obj->target ),      col_text( stmt, 2 ) );
             obj->threshold = sqlite3_column_int( stmt, 3 );
             safe_copy( obj->description, sizeof( obj->description ), col_text( stmt, 4 ) );
+            quest_intern_objective( obj );
             q->obj_count++;
         }
         sqlite3_finalize( stmt );
@@ -254,12 +400,15 @@ QUEST_TRACKER *quest_tracker_new( void ) {
     t->entries  = NULL;
     t->count    = 0;
     t->capacity = 0;
+    t->slots    = NULL;
+    t->index_dirty = TRUE;
     return t;
 }
 
 void quest_tracker_free( QUEST_TRACKER *tracker ) {
     if ( !tracker ) return;
     free( tracker->entries );
+    free( tracker->slots );
     free( tracker );
 }
 
@@ -286,6 +435,7 @@ QUEST_PROGRESS *quest_tracker_get( QUEST_TRACKER *tracker, int quest_index ) {
     QUEST_PROGRESS *p;
     if ( !tracker ) return NULL;
 
+    tracker->index_dirty = TRUE;
     p = quest_tracker_find( tracker, quest_index );
     if ( p ) return p;
 
@@ -302,6 +452,77 @@ QUEST_PROGRESS *quest_tracker_get( QUEST_TRACKER *tracker, int quest_index ) {
     return p;
 }
 
+/*--------------------------------------------------------------------------
+ * Quest Tracker: Open-objective index
+ *
+ * Counting sort of the unmet objectives of active quests by type.  An
+ * event whose type has no open slot is then one array probe, and the
+ * milestone walk knows which character stats it would read.
+ *--------------------------------------------------------------------------*/
+
+void quest_index_refresh( QUEST_TRACKER *t ) {
+    int counts[QOT_MAX];
+    int fill[QOT_MAX];
+    int i, j, type, total = 0;
+
+    if ( !t->index_dirty )
+        return;
+
+    memset( counts, 0, sizeof( counts ) );
+    for ( i = 0; i < t->count; i++ ) {
+        const QUEST_PROGRESS *p = &t->entries[i];
+        const QUEST_DEF *q;
+
+        if ( p->status != QSTATUS_ACTIVE ) continue;
+        if ( ( q = quest_def_by_index( p->quest_index ) ) == NULL ) continue;
+        for ( j = 0; j < q->obj_count; j++ ) {
+            if ( p->obj_progress[j].current >= q->objectives[j].threshold )
+                continue;
+            counts[q->objectives[j].type_id]++;
+            total++;
+        }
+    }
+
+    if ( total > t->slot_cap ) {
+        QUEST_SLOT *slots = realloc( t->slots, total * sizeof( QUEST_SLOT ) );
+        if ( !slots ) {
+            bug( "quest_index_refresh: realloc failed", 0 );
+            return;
+        }
+        t->slots    = slots;
+        t->slot_cap = total;
+    }
+
+    t->open_types = 0;
+    t->slot_start[0] = 0;
+    for ( type = 0; type < QOT_MAX; type++ ) {
+        fill[type] = t->slot_start[type];
+        t->slot_start[type + 1] = t->slot_start[type] + counts[type];
+        if ( counts[type] > 0 )
+            t->open_types |= 1u << type;
+    }
+
+    for ( i = 0; i < t->count; i++ ) {
+        const QUEST_PROGRESS *p = &t->entries[i];
+        const QUEST_DEF *q;
+
+        if ( p->status != QSTATUS_ACTIVE ) continue;
+        if ( ( q = quest_def_by_index( p->quest_index ) ) == NULL ) continue;
+        for ( j = 0; j < q->obj_count; j++ ) {
+            QUEST_SLOT *slot;
+
+            if ( p->obj_progress[j].current >= q->objectives[j].threshold )
+                continue;
+            slot = &t->slots[fill[q->objectives[j].type_id]++];
+            slot->entry = (short) i;
+            slot->obj   = (short) j;
+        }
+    }
+
+    t->index_dirty = FALSE;
+    t->index_gen++;
+}
+
 /*--------------------------------------------------------------------------
  * Player Progress: Table Creation
  *--------------------------------------------------------------------------*/
@@ -72,6 +72,73 @@
 #define QOBJ_CLASS_TRAIN       "CLASS_TRAIN"
 #define QOBJ_CLASS_POWER       "CLASS_POWER"
 
+/*--------------------------------------------------------------------------
+ * Objective types, interned from the strings above at load
+ *
+ * quest_check_progress() takes one of these.  Event callers and the
+ * milestone walk switch on QUEST_OBJ_DEF.type_id instead of comparing
+ * type strings.
+ *--------------------------------------------------------------------------*/
+
+enum {
+    QOT_NONE = 0,             /* Type string not recognised           */
+    QOT_USE_COMMAND,
+    QOT_KILL_MOB,
+    QOT_KILL_PLAYER,
+    QOT_VISIT_ROOM,
+    QOT_VISIT_AREA,
+    QOT_REACH_STAT,
+    QOT_REACH_GEN,
+    QOT_REACH_PKSCORE,
+    QOT_REACH_UPGRADE,
+    QOT_EARN_QP,
+    QOT_LEARN_STANCE,
+    QOT_LEARN_SUPERSTANCE,
+    QOT_LEARN_DISCIPLINE,
+    QOT_WEAPON_SKILL,
+    QOT_SPELL_SKILL,
+    QOT_FORGE_ITEM,
+    QOT_QUEST_CREATE,
+    QOT_QUEST_MODIFY,
+    QOT_ARENA_WIN,
+    QOT_COLLECT_ITEM,
+    QOT_COMPLETE_QUEST,
+    QOT_MASTERY,
+    QOT_CLASS_TRAIN,
+    QOT_CLASS_POWER,
+    QOT_MAX
+};
+
+/* Types quest_check_milestones() reads from character state */
+#define QOT_MILESTONE_MASK \
+    ( ( 1u << QOT_REACH_STAT ) | ( 1u << QOT_REACH_GEN ) \
+    | ( 1u << QOT_REACH_PKSCORE ) | ( 1u << QOT_REACH_UPGRADE ) \
+    | ( 1u << QOT_EARN_QP ) | ( 1u << QOT_MASTERY ) \
+    | ( 1u << QOT_LEARN_STANCE ) | ( 1u << QOT_LEARN_SUPERSTANCE ) \
+    | ( 1u << QOT_WEAPON_SKILL ) | ( 1u << QOT_SPELL_SKILL ) \
+    | ( 1u << QOT_LEARN_DISCIPLINE ) | ( 1u << QOT_CLASS_POWER ) )
+
+/*--------------------------------------------------------------------------
+ * Objective targets, interned at load
+ *
+ * Every target string gets an atom; event targets are looked up once per
+ * event and compared by atom.  "any" is always atom 0.  Milestone targets
+ * are also sorted into a kind, with any number they carry in target_arg.
+ *--------------------------------------------------------------------------*/
+
+#define QUEST_ATOM_NONE      -1   /* Not the target of any objective     */
+#define QUEST_ATOM_ANY        0
+
+#define QTGT_NAME            0    /* Anything else: a command, vnum, ... */
+#define QTGT_ANY             1
+#define QTGT_ALL             2
+#define QTGT_HP              3
+#define QTGT_MANA            4
+#define QTGT_MOVE            5
+#define QTGT_CLASS           6
+#define QTGT_COUNT           7    /* count_N: target_arg = N             */
+#define QTGT_DISCIPLINE      8    /* CLASS_POWER: target_arg = index     */
+
 /*--------------------------------------------------------------------------
  * Data Structures
  *--------------------------------------------------------------------------*/
@@ -81,6 +148,10 @@ typedef struct quest_objective_def {
     char  target[64];         /* Target (vnum, command name, stat)     */
     int   threshold;          /* Required count/level                  */
     char  description[256];   /* Human-readable description            */
+    int   type_id;            /* QOT_*, from type                      */
+    int   target_atom;        /* quest_atom_find( target )             */
+    int   target_kind;        /* QTGT_*, for milestone objectives      */
+    int   target_arg;         /* Number the target carries, see QTGT_* */
 } QUEST_OBJ_DEF;
 
 typedef struct quest_def {
@@ -123,10 +194,32 @@ typedef struct quest_progress {
     QUEST_OBJ_PROGRESS obj_progress[MAX_QUEST_OBJECTIVES];
 } QUEST_PROGRESS;
 
+/* An objective of an active quest that is not yet met */
+typedef struct quest_slot {
+    short entry;              /* Index into tracker->entries          */
+    short obj;                /* Objective index within the quest     */
+} QUEST_SLOT;
+
 typedef struct quest_tracker {
     QUEST_PROGRESS *entries;  /* Dynamic array of tracked quests      */
     int   count;              /* Number of entries                    */
     int   capacity;           /* Allocated capacity                   */
+
+    /*
+     * Open objectives by type, rebuilt by quest_index_refresh() after
+     * quest_tracker_touch().  Slots of type t are slots[slot_start[t]]
+     * up to slots[slot_start[t + 1]], in entry order.
+     */
+    QUEST_SLOT *slots;
+    int   slot_cap;
+    int   slot_start[QOT_MAX + 1];
+    unsigned int open_types;  /* Bit per QOT_* with an open slot      */
+    unsigned int index_gen;   /* Bumped on every rebuild              */
+    bool  index_dirty;
+
+    /* quest_check_milestones() skips the walk while this still matches */
+    unsigned int milestone_sig;
+    bool  milestone_valid;
 } QUEST_TRACKER;
 
 /*--------------------------------------------------------------------------
@@ -152,6 +245,13 @@ const QUEST_DEF *quest_def_by_id( const char *id );
 /* Find quest definition index by ID string. Returns -1 if not found. */
 int quest_def_index_by_id( const char *id );
 
+/* QOT_* for an objective type string, QOT_NONE if unknown. */
+int quest_obj_type_lookup( const char *type );
+
+/* Atom of an objective target, QUEST_ATOM_NONE if no objective has it.
+ * Exact, case-sensitive match, as targets were always compared. */
+int quest_atom_find( const char *target );
+
 /*--------------------------------------------------------------------------
  * Story Clue Lookup (centralized in quest.db story_clues table)
  *--------------------------------------------------------------------------*/
@@ -184,7 +284,23 @@ void quest_progress_ensure_tables( sqlite3 *player_db );
 /* Get progress entry for a quest, or NULL if not tracked. */
 QUEST_PROGRESS *quest_tracker_find( QUEST_TRACKER *tracker, int quest_index );
 
-/* Get or create a progress entry for a quest. */
+/* Get or create a progress entry for a quest.  The caller may change it,
+ * so this also marks the open-objective index stale. */
 QUEST_PROGRESS *quest_tracker_get( QUEST_TRACKER *tracker, int quest_index );
 
+/* Call after changing the status or objective progress of an entry
+ * reached some other way than quest_tracker_get(). */
+static inline void quest_tracker_touch( QUEST_TRACKER *tracker ) {
+    tracker->index_dirty = TRUE;
+}
+
+/* Rebuild the open-objective index if anything touched the tracker. */
+void quest_index_refresh( QUEST_TRACKER *tracker );
+
+/* Open slots of one type, after refreshing the index. */
+static inline int quest_open_count( QUEST_TRACKER *tracker, int type ) {
+    quest_index_refresh( tracker );
+    return tracker->slot_start[type + 1] - tracker->slot_start[type];
+}
+
 #endif /* DB_QUEST_H */
@@ -406,6 +406,7 @@ static void sql_load_mobiles( sqlite3 *db, AREA_DATA *pArea ) {
 			exit( 1 );
 		}
 		list_init( &pMobIndex->scripts );
+		list_init( &pMobIndex->instances );
 		pMobIndex->vnum         = vnum;
 		pMobIndex->area         = pArea;
 		pMobIndex->player_name  = str_dup( col_text( stmt, 1 ) );
@@ -530,6 +531,7 @@ static void sql_load_objects( sqlite3 *db, AREA_DATA *pArea ) {
 		list_init( &pObjIndex->affects );
 		list_init( &pObjIndex->extra_descr );
 		list_init( &pObjIndex->scripts );
+		list_init( &pObjIndex->instances );
 
 		/* Load affects */
 		if ( af_stmt ) {
@@ -876,6 +878,8 @@ static void sql_load_scripts( sqlite3 *db ) {
 		const char *lib_name = ( sqlite3_column_type( stmt, 7 ) != SQLITE_NULL )
 			? (const char *) sqlite3_column_text( stmt, 7 ) : NULL;
 		list_head_t *list = NULL;
+		MOB_INDEX_DATA *pMob;
+		OBJ_INDEX_DATA *pObj;
 		SCRIPT_DATA *script;
 
 		/* Resolve library reference — override inline fields */
@@ -897,15 +901,13 @@ static void sql_load_scripts( sqlite3 *db ) {
 			chance  = entry->chance;
 		}
 
+		pMob = NULL;
+		pObj = NULL;
 		if ( !strcmp( owner_type, "mob" ) ) {
-			MOB_INDEX_DATA *pMob = get_mob_index( vnum );
-			if ( pMob ) {
-				list = &pMob->scripts;
-				if ( IS_SET( trigger, TRIG_TICK ) )
-					pMob->has_tick_scripts = TRUE;
-			}
+			pMob = get_mob_index( vnum );
+			if ( pMob ) list = &pMob->scripts;
 		} else if ( !strcmp( owner_type, "obj" ) ) {
-			OBJ_INDEX_DATA *pObj = get_obj_index( vnum );
+			pObj = get_obj_index( vnum );
 			if ( pObj ) list = &pObj->scripts;
 		} else if ( !strcmp( owner_type, "room" ) ) {
 			ROOM_INDEX_DATA *pRoom = get_room_index( vnum );
@@ -933,6 +935,12 @@ static void sql_load_scripts( sqlite3 *db ) {
 		script->lua_ref      = SCRIPT_LUA_NOREF;
 
 		list_push_back( list, &script->node );
+
+		/* Keep the trigger masks (and any live subscriptions) current */
+		if ( pMob )
+			script_index_refresh_mob( pMob );
+		if ( pObj )
+			script_index_refresh_obj( pObj );
 	}
 
 	sqlite3_finalize( stmt );
@@ -0,0 +1,472 @@
+/***************************************************************************
+ *  db_writer.c - Write-behind queue for a SQLite database
+ *
+ *  See db_writer.h.  The game thread only ever touches the queue under
+ *  the writer's mutex; the connection and its cached statements belong
+ *  to the writer thread (or to the game thread in synchronous mode).
+ ***************************************************************************/
+
+#include "db_util.h"
+#include "db_writer.h"
+#include "../systems/profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define DB_WRITER_BUSY_MS 5000
+
+enum { DBW_PARAM_INT, DBW_PARAM_TEXT, DBW_PARAM_NULL };
+
+typedef struct {
+	int       type;
+	long long value;        /* DBW_PARAM_INT value, or offset into text arena */
+} DB_BATCH_PARAM;
+
+typedef struct {
+	int stmt;
+	int first_param;
+	int param_count;
+} DB_BATCH_OP;
+
+struct db_batch {
+	DB_BATCH       *next;
+	char           *key;        /* Coalesce key, or NULL */
+	DB_BATCH_OP    *ops;
+	int             op_count, op_alloc;
+	DB_BATCH_PARAM *params;
+	int             param_count, param_alloc;
+	char           *text;       /* All bound strings, NUL-separated */
+	size_t          text_len, text_alloc;
+};
+
+struct db_writer {
+	sqlite3            *db;
+	const char *const  *sql;
+	sqlite3_stmt      **stmts;      /* Prepared on first use */
+	int                 sql_count;
+
+	pthread_mutex_t     lock;
+	pthread_cond_t      work;       /* Game -> writer: batches, kick, close */
+	pthread_cond_t      idle;       /* Writer -> game: queue drained */
+	DB_BATCH           *head, *tail;
+	bool                kicked;
+	bool                busy;       /* Writer is committing a detached queue */
+	bool                closing;
+	bool                running;    /* Writer thread alive */
+
+	DB_WRITER_STATS     stats;
+	char                last_error[MAX_INPUT_LENGTH];
+	bool                error_pending;
+};
+
+
+static void *db_writer_xrealloc( void *p, size_t size ) {
+	void *q = realloc( p, size );
+
+	if ( q == NULL ) {
+		bug( "db_writer: out of memory", 0 );
+		exit( 1 );
+	}
+	return q;
+}
+
+
+/*
+ * Batches
+ */
+DB_BATCH *db_batch_new( const char *coalesce_key ) {
+	DB_BATCH *b = calloc( 1, sizeof( *b ) );
+
+	if ( b == NULL ) {
+		bug( "db_batch_new: calloc failed", 0 );
+		exit( 1 );
+	}
+	if ( coalesce_key != NULL )
+		b->key = str_dup( coalesce_key );
+	return b;
+}
+
+void db_batch_free( DB_BATCH *b ) {
+	if ( b == NULL )
+		return;
+	free( b->key );
+	free( b->ops );
+	free( b->params );
+	free( b->text );
+	free( b );
+}
+
+void db_batch_op( DB_BATCH *b, int stmt ) {
+	DB_BATCH_OP *op;
+
+	if ( b->op_count == b->op_alloc ) {
+		b->op_alloc = b->op_alloc ? b->op_alloc * 2 : 8;
+		b->ops = db_writer_xrealloc( b->ops, b->op_alloc * sizeof( *b->ops ) );
+	}
+	op = &b->ops[b->op_count++];
+	op->stmt        = stmt;
+	op->first_param = b->param_count;
+	op->param_count = 0;
+}
+
+static DB_BATCH_PARAM *db_batch_param( DB_BATCH *b, int type ) {
+	DB_BATCH_PARAM *p;
+
+	if ( b->op_count == 0 ) {
+		bug( "db_batch_param: parameter before any statement", 0 );
+		return NULL;
+	}
+	if ( b->param_count == b->param_alloc ) {
+		b->param_alloc = b->param_alloc ? b->param_alloc * 2 : 32;
+		b->params = db_writer_xrealloc( b->params, b->param_alloc * sizeof( *b->params ) );
+	}
+	b->ops[b->op_count - 1].param_count++;
+	p = &b->params[b->param_count++];
+	p->type  = type;
+	p->value = 0;
+	return p;
+}
+
+void db_batch_int( DB_BATCH *b, long long value ) {
+	DB_BATCH_PARAM *p = db_batch_param( b, DBW_PARAM_INT );
+
+	if ( p != NULL )
+		p->value = value;
+}
+
+void db_batch_text( DB_BATCH *b, const char *text ) {
+	DB_BATCH_PARAM *p;
+	size_t len;
+
+	if ( text == NULL ) {
+		db_batch_null( b );
+		return;
+	}
+	if ( ( p = db_batch_param( b, DBW_PARAM_TEXT ) ) == NULL )
+		return;
+
+	len = strlen( text ) + 1;
+	if ( b->text_len + len > b->text_alloc ) {
+		while ( b->text_len + len > b->text_alloc )
+			b->text_alloc = b->text_alloc ? b->text_alloc * 2 : 256;
+		b->text = db_writer_xrealloc( b->text, b->text_alloc );
+	}
+	memcpy( b->text + b->text_len, text, len );
+	p->value = (long long) b->text_len;
+	b->text_len += len;
+}
+
+void db_batch_null( DB_BATCH *b ) {
+	db_batch_param( b, DBW_PARAM_NULL );
+}
+
+
+/*
+ * Execution.  Runs on the writer thread, or on the game thread in
+ * synchronous mode; either way the caller does not hold w->lock.
+ */
+static void db_writer_error( DB_WRITER *w, const char *what ) {
+	pthread_mutex_lock( &w->lock );
+	w->stats.errors++;
+	snprintf( w->last_error, sizeof( w->last_error ), "db_writer: %s: %s",
+		what, sqlite3_errmsg( w->db ) );
+	w->error_pending = TRUE;
+	pthread_mutex_unlock( &w->lock );
+}
+
+static sqlite3_stmt *db_writer_stmt( DB_WRITER *w, int id ) {
+	if ( id < 0 || id >= w->sql_count )
+		return NULL;
+	if ( w->stmts[id] == NULL
+		&& sqlite3_prepare_v2( w->db, w->sql[id], -1, &w->stmts[id], NULL ) != SQLITE_OK ) {
+		db_writer_error( w, w->sql[id] );
+		w->stmts[id] = NULL;
+	}
+	return w->stmts[id];
+}
+
+static long db_writer_run_batch( DB_WRITER *w, DB_BATCH *b ) {
+	sqlite3_stmt *stmt;
+	DB_BATCH_PARAM *p;
+	long ops = 0;
+	int i, j;
+
+	for ( i = 0; i < b->op_count; i++ ) {
+		if ( ( stmt = db_writer_stmt( w, b->ops[i].stmt ) ) == NULL )
+			continue;
+
+		sqlite3_reset( stmt );
+		sqlite3_clear_bindings( stmt );
+		for ( j = 0; j < b->ops[i].param_count; j++ ) {
+			p = &b->params[b->ops[i].first_param + j];
+			if ( p->type == DBW_PARAM_INT )
+				sqlite3_bind_int64( stmt, j + 1, (sqlite3_int64) p->value );
+			else if ( p->type == DBW_PARAM_TEXT )
+				sqlite3_bind_text( stmt, j + 1, b->text + p->value, -1, SQLITE_STATIC );
+			else
+				sqlite3_bind_null( stmt, j + 1 );
+		}
+
+		if ( sqlite3_step( stmt ) != SQLITE_DONE )
+			db_writer_error( w, w->sql[b->ops[i].stmt] );
+		sqlite3_reset( stmt );
+		ops++;
+	}
+	return ops;
+}
+
+/*
+ * Run a detached list of batches in one transaction, free them, and
+ * fold the timings into the stats.
+ */
+static void db_writer_commit( DB_WRITER *w, DB_BATCH *list ) {
+	DB_BATCH *b, *next;
+	int64_t start = profile_now_ns();
+	long long us;
+	long ops = 0;
+
+	db_begin( w->db );
+	for ( b = list; b != NULL; b = b->next )
+		ops += db_writer_run_batch( w, b );
+	if ( sqlite3_exec( w->db, "COMMIT", NULL, NULL, NULL ) != SQLITE_OK ) {
+		db_writer_error( w, "COMMIT" );
+		db_rollback( w->db );
+	}
+
+	for ( b = list; b != NULL; b = next ) {
+		next = b->next;
+		db_batch_free( b );
+	}
+
+	us = ( profile_now_ns() - start ) / 1000;
+	pthread_mutex_lock( &w->lock );
+	w->stats.ops += ops;
+	w->stats.commits++;
+	w->stats.commit_us_total += us;
+	if ( us > w->stats.commit_us_max )
+		w->stats.commit_us_max = us;
+	pthread_mutex_unlock( &w->lock );
+}
+
+static void *db_writer_thread( void *arg ) {
+	DB_WRITER *w = (DB_WRITER *) arg;
+	DB_BATCH *list;
+
+	pthread_mutex_lock( &w->lock );
+	for ( ;; ) {
+		while ( !w->closing
+			&& ( w->head == NULL || ( !w->kicked && w->stats.depth < DB_WRITER_MAX_DEPTH ) ) )
+			pthread_cond_wait( &w->work, &w->lock );
+
+		if ( w->head == NULL )
+			break;  /* Closing with nothing left */
+
+		list = w->head;
+		w->head = w->tail = NULL;
+		w->stats.depth = 0;
+		w->kicked = FALSE;
+		w->busy = TRUE;
+		pthread_mutex_unlock( &w->lock );
+
+		db_writer_commit( w, list );
+
+		pthread_mutex_lock( &w->lock );
+		w->busy = FALSE;
+		pthread_cond_broadcast( &w->idle );
+	}
+	w->running = FALSE;
+	pthread_cond_broadcast( &w->idle );
+	pthread_mutex_unlock( &w->lock );
+	return NULL;
+}
+
+
+/*
+ * Queue
+ */
+void db_writer_submit( DB_WRITER *w, DB_BATCH *b ) {
+	DB_BATCH *prev = NULL, *cur;
+
+	if ( w == NULL || b == NULL ) {
+		db_batch_free( b );
+		return;
+	}
+
+	if ( !w->stats.threaded ) {
+		w->stats.batches++;
+		b->next = NULL;
+		db_writer_commit( w, b );
+		return;
+	}
+
+	pthread_mutex_lock( &w->lock );
+	w->stats.batches++;
+
+	/*
+	 * A newer snapshot supersedes the pending one.  It goes to the tail,
+	 * not the old slot, so it still runs after anything queued between
+	 * the two (e.g. a note appended between two board rewrites).
+	 */
+	if ( b->key != NULL ) {
+		for ( cur = w->head; cur != NULL; prev = cur, cur = cur->next ) {
+			if ( cur->key == NULL || strcmp( cur->key, b->key ) )
+				continue;
+			if ( prev != NULL )
+				prev->next = cur->next;
+			else
+				w->head = cur->next;
+			if ( w->tail == cur )
+				w->tail = prev;
+			w->stats.depth--;
+			w->stats.coalesced++;
+			db_batch_free( cur );
+			break;
+		}
+	}
+
+	b->next = NULL;
+	if ( w->tail != NULL )
+		w->tail->next = b;
+	else
+		w->head = b;
+	w->tail = b;
+
+	if ( ++w->stats.depth > w->stats.peak_depth )
+		w->stats.peak_depth = w->stats.depth;
+	if ( w->stats.depth >= DB_WRITER_MAX_DEPTH )
+		pthread_cond_signal( &w->work );
+	pthread_mutex_unlock( &w->lock );
+}
+
+void db_writer_kick( DB_WRITER *w ) {
+	if ( w == NULL || !w->stats.threaded )
+		return;
+	pthread_mutex_lock( &w->lock );
+	if ( w->head != NULL ) {
+		w->kicked = TRUE;
+		pthread_cond_signal( &w->work );
+	}
+	pthread_mutex_unlock( &w->lock );
+}
+
+void db_writer_flush( DB_WRITER *w ) {
+	if ( w == NULL || !w->stats.threaded )
+		return;
+	pthread_mutex_lock( &w->lock );
+	while ( w->running && ( w->head != NULL || w->busy ) ) {
+		w->kicked = TRUE;
+		pthread_cond_signal( &w->work );
+		pthread_cond_wait( &w->idle, &w->lock );
+	}
+	pthread_mutex_unlock( &w->lock );
+}
+
+void db_writer_get_stats( DB_WRITER *w, DB_WRITER_STATS *out ) {
+	if ( w == NULL ) {
+		memset( out, 0, sizeof( *out ) );
+		return;
+	}
+	pthread_mutex_lock( &w->lock );
+	*out = w->stats;
+	pthread_mutex_unlock( &w->lock );
+}
+
+bool db_writer_take_error( DB_WRITER *w, char *buf, size_t len ) {
+	bool found;
+
+	if ( w == NULL )
+		return FALSE;
+	pthread_mutex_lock( &w->lock );
+	found = w->error_pending;
+	if ( found ) {
+		snprintf( buf, len, "%s", w->last_error );
+		w->error_pending = FALSE;
+	}
+	pthread_mutex_unlock( &w->lock );
+	return found;
+}
+
+
+/*
+ * Lifetime
+ */
+DB_WRITER *db_writer_open( const char *path, const char *const *sql, int sql_count ) {
+	DB_WRITER *w;
+	pthread_t thread;
+	pthread_attr_t attr;
+
+	w = calloc( 1, sizeof( *w ) );
+	if ( w == NULL ) {
+		bug( "db_writer_open: calloc failed", 0 );
+		return NULL;
+	}
+
+	if ( sqlite3_open( path, &w->db ) != SQLITE_OK ) {
+		bug( "db_writer_open: cannot open database", 0 );
+		sqlite3_close( w->db );
+		free( w );
+		return NULL;
+	}
+	sqlite3_exec( w->db, "PRAGMA journal_mode=WAL", NULL, NULL, NULL );
+	sqlite3_exec( w->db, "PRAGMA synchronous=NORMAL", NULL, NULL, NULL );
+	sqlite3_busy_timeout( w->db, DB_WRITER_BUSY_MS );
+
+	w->sql       = sql;
+	w->sql_count = sql_count;
+	w->stmts     = calloc( sql_count > 0 ? sql_count : 1, sizeof( *w->stmts ) );
+	if ( w->stmts == NULL ) {
+		bug( "db_writer_open: calloc failed", 0 );
+		sqlite3_close( w->db );
+		free( w );
+		return NULL;
+	}
+
+	pthread_mutex_init( &w->lock, NULL );
+	pthread_cond_init( &w->work, NULL );
+	pthread_cond_init( &w->idle, NULL );
+
+	/* The connection moves to another thread: SQLite must have mutexes */
+	if ( !sqlite3_threadsafe() ) {
+		log_string( "db_writer: SQLite built single-threaded; writing synchronously." );
+		return w;
+	}
+
+	w->running = TRUE;
+	w->stats.threaded = TRUE;
+	pthread_attr_init( &attr );
+	pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+	if ( pthread_create( &thread, &attr, db_writer_thread, w ) != 0 ) {
+		bug( "db_writer_open: cannot start writer thread; writing synchronously.", 0 );
+		w->running = FALSE;
+		w->stats.threaded = FALSE;
+	}
+	return w;
+}
+
+void db_writer_close( DB_WRITER *w ) {
+	int i;
+
+	if ( w == NULL )
+		return;
+
+	if ( w->stats.threaded ) {
+		pthread_mutex_lock( &w->lock );
+		w->closing = TRUE;
+		pthread_cond_signal( &w->work );
+		while ( w->running )
+			pthread_cond_wait( &w->idle, &w->lock );
+		pthread_mutex_unlock( &w->lock );
+	}
+
+	for ( i = 0; i < w->sql_count; i++ )
+		if ( w->stmts[i] != NULL )
+			sqlite3_finalize( w->stmts[i] );
+	free( w->stmts );
+	sqlite3_close( w->db );
+	pthread_mutex_destroy( &w->lock );
+	pthread_cond_destroy( &w->work );
+	pthread_cond_destroy( &w->idle );
+	free( w );
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+ *  db_writer.h - Write-behind queue for a SQLite database
+ *
+ *  One long-lived connection, owned by a background thread, executes
+ *  batches of parameterised statements queued from the game thread.
+ *  Queued batches are group-committed in a single transaction whenever
+ *  the writer is kicked (once a second from the pulse loop), flushed,
+ *  or the queue grows past DB_WRITER_MAX_DEPTH.
+ *
+ *  Statements are named by index into a SQL table supplied at open and
+ *  prepared once on first use.  A batch may carry a coalesce key: a new
+ *  batch with the same key replaces the pending one, so whole-table
+ *  snapshots (topboard, bans, ...) saved many times a second cost one
+ *  write.  Does not require sqlite3.h.
+ ***************************************************************************/
+
+#ifndef DB_WRITER_H
+#define DB_WRITER_H
+
+#include "../core/merc.h"
+
+/* Pending batches that force a commit without waiting for the next kick */
+#define DB_WRITER_MAX_DEPTH 512
+
+typedef struct db_writer DB_WRITER;
+typedef struct db_batch  DB_BATCH;
+
+typedef struct db_writer_stats {
+	int       depth;            /* Batches queued right now */
+	int       peak_depth;       /* Highest depth since open */
+	long      batches;          /* Batches submitted */
+	long      coalesced;        /* Batches replaced by a newer one with the same key */
+	long      ops;              /* Statements executed */
+	long      commits;          /* Transactions committed */
+	long      errors;           /* Statements or commits that failed */
+	long long commit_us_total;  /* Time spent in commits */
+	long long commit_us_max;
+	bool      threaded;         /* FALSE: batches run synchronously on submit */
+} DB_WRITER_STATS;
+
+/*
+ * Open a writer on the database at path.  sql[] is the statement table
+ * batches refer to; it must outlive the writer.  Falls back to
+ * synchronous execution if the thread cannot be started or SQLite was
+ * built without thread support.  Returns NULL if the database cannot
+ * be opened.
+ */
+DB_WRITER *db_writer_open( const char *path, const char *const *sql, int sql_count );
+
+/* Flush everything queued, stop the thread and close the connection */
+void db_writer_close( DB_WRITER *w );
+
+/* Commit everything queued and wait until it is on disk */
+void db_writer_flush( DB_WRITER *w );
+
+/* Ask the writer to commit what is queued now, without waiting */
+void db_writer_kick( DB_WRITER *w );
+
+void db_writer_get_stats( DB_WRITER *w, DB_WRITER_STATS *out );
+
+/*
+ * Most recent error not yet reported; copies it into buf and returns TRUE
+ * once per error.  The writer thread cannot call bug() itself.
+ */
+bool db_writer_take_error( DB_WRITER *w, char *buf, size_t len );
+
+/*
+ * Batches.  Build on the game thread, then hand to db_writer_submit(),
+ * which takes ownership.  Text is copied, so callers may pass buffers
+ * that change afterwards; NULL text binds SQL NULL.
+ */
+DB_BATCH *db_batch_new( const char *coalesce_key );
+void db_batch_op( DB_BATCH *b, int stmt );
+void db_batch_int( DB_BATCH *b, long long value );
+void db_batch_text( DB_BATCH *b, const char *text );
+void db_batch_null( DB_BATCH *b );
+void db_batch_free( DB_BATCH *b );
+
+void db_writer_submit( DB_WRITER *w, DB_BATCH *b );
+
+#endif /* DB_WRITER_H */
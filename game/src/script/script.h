@@ -30,6 +30,8 @@ typedef struct script_data {
 	int           chance;         /* Percent chance to fire (0 = always) */
 	char         *library_name;   /* NULL = inline, set = library reference */
 	int           lua_ref;        /* Lua registry ref for cached on_tick */
+	long          cpu_us;         /* Wall time spent running this script */
+	long          resumes;        /* Coroutine slices run (first run + resumes) */
 	list_node_t   node;           /* Intrusive list linkage */
 } SCRIPT_DATA;
 
@@ -37,7 +39,26 @@ typedef struct script_data {
 void script_init( void );
 void script_shutdown( void );
 
-/* Trigger dispatch — mob scripts (iterate NPCs in room) */
+/*
+ * Subscription index — scripted NPCs sit on their room's script_mobs list
+ * and carried TRIG_TICK objects on a global list, so dispatch only walks
+ * entities that can fire.  Hooked into char_to_room/char_from_room and
+ * obj_to_char/obj_from_char.
+ */
+void script_sub_char_to_room( CHAR_DATA *ch, ROOM_INDEX_DATA *room );
+void script_sub_char_from_room( CHAR_DATA *ch );
+void script_sub_obj_to_char( OBJ_DATA *obj );
+void script_sub_obj_from_char( OBJ_DATA *obj );
+
+/* Recompute script_trigs after a template's script list changes */
+void script_index_refresh_mob( MOB_INDEX_DATA *pMob );
+void script_index_refresh_obj( OBJ_INDEX_DATA *pObj );
+
+/* Dispatch counters: scripts evaluated vs callbacks fired */
+void script_trigger_totals( long *evals, long *fires );
+void script_trigger_report( CHAR_DATA *ch );
+
+/* Trigger dispatch — mob scripts (scripted NPCs in room) */
 void script_trigger_greet( CHAR_DATA *ch, ROOM_INDEX_DATA *room );
 void script_trigger_speech( CHAR_DATA *ch, const char *text );
 void script_trigger_speech_one( CHAR_DATA *speaker, CHAR_DATA *target, const char *text );
@@ -61,7 +82,30 @@ void script_trigger_mob_death( CHAR_DATA *killer, MOB_INDEX_DATA *victim_idx );
 void script_run( SCRIPT_DATA *script, const char *func,
 	CHAR_DATA *mob, CHAR_DATA *ch, const char *text );
 
-/* Cache management */
+/* Cache management (also cancels the script's suspended coroutines) */
 void script_invalidate_cache( SCRIPT_DATA *script );
 
+/*
+ * Coroutine scheduler.
+ *
+ * Every trigger runs as a Lua coroutine.  A script that calls wait(),
+ * wait_for_event() or yield() -- or that uses up its per-slice instruction
+ * budget -- is suspended and resumed by script_scheduler_pulse() on a later
+ * pulse instead of blocking the game loop.
+ */
+void script_scheduler_pulse( void );
+
+/* Wake coroutines on owner blocked in wait_for_event(event).  Delivered on
+ * the next scheduler pulse as (actor, text). */
+void script_signal_event( void *owner, const char *event,
+	CHAR_DATA *actor, const char *text );
+
+/* A char or object is leaving the world: cancel its coroutines and null
+ * every Lua reference to it.  Called from extract_char/extract_obj/free_char. */
+void script_forget_entity( void *ptr );
+
+/* Number of suspended coroutines, and a scheduler/CPU report for "profile scripts" */
+int  script_thread_count( void );
+void script_report( CHAR_DATA *ch );
+
 #endif /* SCRIPT_H */
@@ -3,18 +3,24 @@
  *
  * Three metatables are registered for full userdata (pointer boxes):
  *   "Char" — CHAR_DATA methods (name, say, send, etc.)
- *   "Room" — ROOM_INDEX_DATA methods (vnum, find_mob, echo)
+ *   "Room" — ROOM_INDEX_DATA methods (vnum, find_mob, echo, path_to)
  *   "Obj"  — OBJ_DATA methods (name, to_char, to_room)
  *
  * A "game" global table provides factory functions:
  *   game.create_object(vnum)
  *   game.create_portal(dest_vnum, room)
  *   game.cast_spell(sn, level, ch)
+ *   game.signal(target, event [, text [, actor]])
+ *
+ * wait(pulses), yield() and wait_for_event(name [, timeout]) are globals
+ * that suspend the calling trigger coroutine (see script_lua.c).
  */
 
 #include "merc.h"
 #include "script.h"
+#include "../core/cfg.h"
 #include "../systems/quest_new.h"
+#include "../world/pathfind.h"
 
 #include "lua.h"
 #include "lauxlib.h"
@@ -58,28 +64,24 @@ static OBJ_DATA *check_obj( lua_State *L, int idx ) {
 }
 
 
+/* Defined in script_lua.c */
+void script_push_entity( lua_State *L, void *ptr, const char *mt );
+int  script_wait_pulses( lua_State *L, int pulses );
+int  script_wait_event( lua_State *L, const char *event, int timeout );
+
 /* Helper: push a CHAR_DATA* as full userdata with Char metatable */
 static void push_char( lua_State *L, CHAR_DATA *ch ) {
-	void **ud = (void **) lua_newuserdatauv( L, sizeof( void * ), 0 );
-	*ud = ch;
-	luaL_getmetatable( L, "Char" );
-	lua_setmetatable( L, -2 );
+	script_push_entity( L, ch, "Char" );
 }
 
 /* Helper: push a ROOM_INDEX_DATA* as full userdata with Room metatable */
 static void push_room( lua_State *L, ROOM_INDEX_DATA *room ) {
-	void **ud = (void **) lua_newuserdatauv( L, sizeof( void * ), 0 );
-	*ud = room;
-	luaL_getmetatable( L, "Room" );
-	lua_setmetatable( L, -2 );
+	script_push_entity( L, room, "Room" );
 }
 
 /* Helper: push an OBJ_DATA* as full userdata with Obj metatable */
 static void push_obj( lua_State *L, OBJ_DATA *obj ) {
-	void **ud = (void **) lua_newuserdatauv( L, sizeof( void * ), 0 );
-	*ud = obj;
-	luaL_getmetatable( L, "Obj" );
-	lua_setmetatable( L, -2 );
+	script_push_entity( L, obj, "Obj" );
 }
 
 
@@ -448,6 +450,27 @@ static int api_char_take_object( lua_State *L ) {
 	return 1;
 }
 
+/*
+ * ch:step_toward(room) — move an NPC one step along the shortest open
+ * route to room.  Returns true if it moved.
+ */
+static int api_char_step_toward( lua_State *L ) {
+	CHAR_DATA *ch = check_char( L, 1 );
+	ROOM_INDEX_DATA *dest = check_room( L, 2 );
+	ROOM_INDEX_DATA *was_in = ch->in_room;
+	int dir;
+
+	if ( !IS_NPC( ch ) || was_in == NULL ) {
+		lua_pushboolean( L, 0 );
+		return 1;
+	}
+	dir = path_next_dir( was_in, dest, PATH_OPEN_ONLY | PATH_NO_MOB, cfg( CFG_WORLD_PATH_MAX_DEPTH ) );
+	if ( dir >= 0 )
+		move_char( ch, dir );
+	lua_pushboolean( L, ch->in_room != was_in );
+	return 1;
+}
+
 
 static const luaL_Reg char_methods[] = {
 	{ "name",         api_char_name },
@@ -478,6 +501,7 @@ static const luaL_Reg char_methods[] = {
 	{ "story_kills",        api_char_story_kills },
 	{ "add_story_kill",     api_char_add_story_kill },
 	{ "story_progress",     api_char_story_progress },
+	{ "step_toward",        api_char_step_toward },
 	{ "set_story_progress", api_char_set_story_progress },
 	{ "story_has_task",     api_char_story_has_task },
 	{ "set_story_task",     api_char_set_story_task },
@@ -584,12 +608,37 @@ static int api_room_find_trash( lua_State *L ) {
 }
 
 
-/* room:has_mob() — returns true if any living NPC is in the room */
+/*
+ * room:has_mob([vnum]) — returns true if any living NPC (of that vnum,
+ * if given) is in the room.  With a vnum only that mob's live instances
+ * are checked, when there are fewer of them than people in the room.
+ */
 static int api_room_has_mob( lua_State *L ) {
 	ROOM_INDEX_DATA *room = check_room( L, 1 );
+	MOB_INDEX_DATA *pMobIndex = NULL;
 	CHAR_DATA *vch;
 
+	if ( !lua_isnoneornil( L, 2 ) ) {
+		if ( ( pMobIndex = get_mob_index( (int) luaL_checkinteger( L, 2 ) ) ) == NULL
+			|| list_empty( &pMobIndex->instances ) ) {
+			lua_pushboolean( L, 0 );
+			return 1;
+		}
+		if ( list_count( &pMobIndex->instances ) < list_count( &room->characters ) ) {
+			LIST_FOR_EACH( vch, &pMobIndex->instances, CHAR_DATA, proto_node ) {
+				if ( vch->in_room == room && vch->position != POS_DEAD ) {
+					lua_pushboolean( L, 1 );
+					return 1;
+				}
+			}
+			lua_pushboolean( L, 0 );
+			return 1;
+		}
+	}
+
 	LIST_FOR_EACH( vch, &room->characters, CHAR_DATA, room_node ) {
+		if ( pMobIndex != NULL && vch->pIndexData != pMobIndex )
+			continue;
 		if ( IS_NPC( vch ) && vch->position != POS_DEAD ) {
 			lua_pushboolean( L, 1 );
 			return 1;
@@ -616,6 +665,35 @@ static int api_room_first_mob_reset_vnum( lua_State *L ) {
 	return 1;
 }
 
+/*
+ * room:path_to(dest [, stay_area]) — shortest route as a list of
+ * direction names ("north", ...), empty when dest is this room, or nil
+ * if there is none.  Closed doors do not block.
+ */
+static int api_room_path_to( lua_State *L ) {
+	ROOM_INDEX_DATA *room = check_room( L, 1 );
+	ROOM_INDEX_DATA *dest = check_room( L, 2 );
+	int flags = lua_toboolean( L, 3 ) ? PATH_STAY_AREA : 0;
+	int depth = cfg( CFG_WORLD_PATH_MAX_DEPTH );
+	int *dirs;
+	int len, i;
+
+	dirs = malloc( depth * sizeof( *dirs ) );
+	len = path_find( room, dest, flags, depth, dirs, depth );
+	if ( len < 0 ) {
+		free( dirs );
+		lua_pushnil( L );
+		return 1;
+	}
+	lua_createtable( L, len, 0 );
+	for ( i = 0; i < len; i++ ) {
+		lua_pushstring( L, dir_name[dirs[i]] );
+		lua_rawseti( L, -2, i + 1 );
+	}
+	free( dirs );
+	return 1;
+}
+
 
 static const luaL_Reg room_methods[] = {
 	{ "vnum",                 api_room_vnum },
@@ -626,6 +704,7 @@ static const luaL_Reg room_methods[] = {
 	{ "find_trash",           api_room_find_trash },
 	{ "has_mob",              api_room_has_mob },
 	{ "first_mob_reset_vnum", api_room_first_mob_reset_vnum },
+	{ "path_to",              api_room_path_to },
 	{ NULL,                   NULL }
 };
 
@@ -902,6 +981,25 @@ static int api_game_hour( lua_State *L ) {
 }
 
 
+/*
+ * game.signal(target, event [, text [, actor]]) — deliver a named event to
+ * coroutines on target (Char, Obj or Room) blocked in wait_for_event().
+ */
+static int api_game_signal( lua_State *L ) {
+	void **ud = NULL;
+	const char *event = luaL_checkstring( L, 2 );
+	const char *text = luaL_optstring( L, 3, NULL );
+	CHAR_DATA *actor = lua_isuserdata( L, 4 ) ? check_char( L, 4 ) : NULL;
+
+	if ( ( ud = luaL_testudata( L, 1, "Char" ) ) == NULL
+		&& ( ud = luaL_testudata( L, 1, "Obj" ) ) == NULL )
+		ud = luaL_checkudata( L, 1, "Room" );
+
+	script_signal_event( *ud, event, actor, text );
+	return 0;
+}
+
+
 static const luaL_Reg game_funcs[] = {
 	{ "create_object",  api_game_create_object },
 	{ "create_portal",  api_game_create_portal },
@@ -910,6 +1008,47 @@ static const luaL_Reg game_funcs[] = {
 	{ "cast_spell",     api_game_cast_spell },
 	{ "random",         api_game_random },
 	{ "hour",           api_game_hour },
+	{ "signal",         api_game_signal },
+	{ NULL,             NULL }
+};
+
+
+/* ================================================================
+ * Coroutine control — globals, valid inside any trigger callback
+ * ================================================================ */
+
+/* wait(pulses) — resume this script after the given number of pulses */
+static int api_wait( lua_State *L ) {
+	int pulses = (int) luaL_checkinteger( L, 1 );
+
+	if ( pulses > PULSE_PER_SECOND * 3600 )
+		pulses = PULSE_PER_SECOND * 3600;
+	return script_wait_pulses( L, pulses );
+}
+
+/* yield() — give up the rest of this pulse, resume on the next one */
+static int api_yield( lua_State *L ) {
+	return script_wait_pulses( L, 1 );
+}
+
+/*
+ * wait_for_event(name [, timeout]) — sleep until the owner of this
+ * script receives event name.  Returns (actor, text), or nil on timeout.
+ * Engine events: "greet" and "speech" on mobs, "enter", "say" and
+ * "examine" on rooms, "kill" on objects; game.signal() sends any name.
+ */
+static int api_wait_for_event( lua_State *L ) {
+	const char *event = luaL_checkstring( L, 1 );
+	int timeout = (int) luaL_optinteger( L, 2, 0 );
+
+	return script_wait_event( L, event, timeout );
+}
+
+
+static const luaL_Reg sched_funcs[] = {
+	{ "wait",           api_wait },
+	{ "yield",          api_yield },
+	{ "wait_for_event", api_wait_for_event },
 	{ NULL,             NULL }
 };
 
@@ -949,3 +1088,9 @@ void script_register_obj_api( lua_State *L ) {
 	luaL_setfuncs( L, game_funcs, 0 );
 	lua_setglobal( L, "game" );
 }
+
+void script_register_sched_api( lua_State *L ) {
+	lua_pushglobaltable( L );
+	luaL_setfuncs( L, sched_funcs, 0 );
+	lua_pop( L, 1 );
+}
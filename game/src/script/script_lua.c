@@ -1,9 +1,17 @@
 /*
- * script_lua.c — Lua state management and sandbox for MUD scripting.
+ * script_lua.c — Lua state management, sandbox and coroutine scheduler.
  *
- * Manages a single global lua_State used by all scripts. Provides
- * sandbox setup (remove dangerous libraries), instruction-count
- * timeout protection, and the core script execution function.
+ * Manages a single global lua_State used by all scripts.  Provides
+ * sandbox setup (remove dangerous libraries), the coroutine scheduler
+ * that runs every trigger callback, and the entity box cache that lets
+ * suspended scripts hold Char/Obj/Room references safely.
+ *
+ * Each trigger callback runs in its own Lua thread.  A callback that
+ * calls wait(), wait_for_event() or yield() is parked on the scheduler
+ * list and resumed by script_scheduler_pulse() on a later pulse.  A
+ * callback that runs through its per-slice instruction budget is
+ * preempted the same way; only a script that keeps burning full slices
+ * without ever yielding is killed.
  */
 
 #include "merc.h"
@@ -14,36 +22,97 @@
 #include "lauxlib.h"
 #include "lualib.h"
 
-/* Maximum Lua instructions before a script is killed */
+/* Lua instructions a coroutine may run before it is preempted */
 #define SCRIPT_MAX_INSTRUCTIONS  100000
 
+/* Consecutive full slices (no voluntary yield) before a script is killed */
+#define SCRIPT_MAX_PREEMPTS      50
+
+/* Cap on suspended coroutines across the whole game */
+#define SCRIPT_MAX_THREADS       512
+
+/* Longest event name accepted by wait_for_event() */
+#define SCRIPT_EVENT_LEN         32
+
+/* Registry key of the weak pointer -> userdata box cache */
+#define SCRIPT_BOXES_KEY         "dystopia.boxes"
+
+/* Why a coroutine is suspended */
+#define SCRIPT_WAIT_NONE         0
+#define SCRIPT_WAIT_PULSE        1   /* wait(n), yield() or preempted */
+#define SCRIPT_WAIT_EVENT        2   /* wait_for_event(name [, timeout]) */
+
 /*
- * Push a C pointer as full userdata with a named metatable.
- * Full userdata is required because Lua 5.4 lightuserdata all share
- * a single metatable — using lightuserdata for multiple types (Char,
- * Room, Obj) causes the last-set metatable to overwrite all others.
+ * One running or suspended trigger callback.
+ * The record is allocated when the callback starts and only linked onto
+ * sched_threads if it yields; callbacks that run to completion never
+ * touch the list.
  */
-#define PUSH_UD(L, ptr, mt) do { \
-	void **_ud = (void **) lua_newuserdatauv( (L), sizeof(void*), 0 ); \
-	*_ud = (ptr); \
-	luaL_getmetatable( (L), (mt) ); \
-	lua_setmetatable( (L), -2 ); \
-} while (0)
+typedef struct script_thread {
+	lua_State     *co;            /* The coroutine */
+	int            ref;           /* Registry ref keeping co alive */
+	SCRIPT_DATA   *script;        /* Script the callback belongs to */
+	const char    *func;          /* Callback name (static string) */
+	void          *owner;         /* Mob/obj/room the trigger fired on */
+	int            wait;          /* SCRIPT_WAIT_* */
+	long           wake_pulse;    /* Resume at this pulse (0 = no timeout) */
+	char           event[SCRIPT_EVENT_LEN];
+	int            nargs;         /* Values pushed on co for the next resume */
+	int            preempts;      /* Consecutive slices ended by the hook */
+	bool           ready;         /* Event delivered, resume next pulse */
+	bool           killed;        /* Ran out of preempts */
+	bool           dead;          /* Finished or cancelled, awaiting release */
+	struct script_thread *prev_running;
+	list_node_t    node;          /* sched_threads linkage */
+} SCRIPT_THREAD;
 
 /* Forward declarations for script_api.c */
 void script_register_char_api( lua_State *L );
 void script_register_room_api( lua_State *L );
 void script_register_obj_api( lua_State *L );
+void script_register_sched_api( lua_State *L );
 
 /* Global Lua state */
 static lua_State *g_lua = NULL;
 
+/* Scheduler state */
+static list_head_t    sched_threads;
+static SCRIPT_THREAD *sched_running = NULL;   /* Innermost running callback */
+static bool           sched_walking = FALSE;  /* Inside script_scheduler_pulse */
+static long           sched_pulse = 0;
+static int            sched_count = 0;        /* Linked (suspended) threads */
+static int            sched_peak = 0;
+static int            sched_event_waiters = 0;
+
+/* Lifetime counters for the report */
+static long sched_started   = 0;
+static long sched_finished  = 0;
+static long sched_errors    = 0;
+static long sched_killed    = 0;
+static long sched_preempted = 0;
+
 
 /*
- * Instruction count hook — kills runaway scripts.
+ * Instruction count hook.
+ * Preempts the running coroutine so it continues next pulse; a script
+ * that never yields on its own is killed after SCRIPT_MAX_PREEMPTS slices.
+ * Code running outside a coroutine (chunk definitions) is killed outright.
  */
 static void script_timeout_hook( lua_State *L, lua_Debug *ar ) {
+	SCRIPT_THREAD *t = sched_running;
+
 	(void) ar;
+	if ( t != NULL && t->co == L && lua_isyieldable( L ) ) {
+		if ( t->preempts < SCRIPT_MAX_PREEMPTS ) {
+			t->preempts++;
+			t->wait = SCRIPT_WAIT_PULSE;
+			t->wake_pulse = sched_pulse + 1;
+			sched_preempted++;
+			lua_yield( L, 0 );
+			return;
+		}
+		t->killed = TRUE;
+	}
 	luaL_error( L, "script exceeded instruction limit (%d)",
 		SCRIPT_MAX_INSTRUCTIONS );
 }
@@ -71,6 +140,55 @@ static void script_sandbox( lua_State *L ) {
 }
 
 
+/*
+ * Push a C pointer as full userdata with a named metatable.
+ *
+ * Full userdata is required because Lua 5.4 lightuserdata all share
+ * a single metatable — using lightuserdata for multiple types (Char,
+ * Room, Obj) causes the last-set metatable to overwrite all others.
+ *
+ * Boxes are cached in a weak table keyed by the raw pointer, so every
+ * reference a script holds to an entity shares one box.  When the entity
+ * leaves the world script_forget_entity() clears that box, and a
+ * suspended script touching it gets a clean "NULL character" error
+ * instead of a dangling pointer.
+ */
+void script_push_entity( lua_State *L, void *ptr, const char *mt ) {
+	void **ud;
+
+	if ( ptr == NULL ) {
+		ud = (void **) lua_newuserdatauv( L, sizeof( void * ), 0 );
+		*ud = NULL;
+		luaL_getmetatable( L, mt );
+		lua_setmetatable( L, -2 );
+		return;
+	}
+
+	lua_getfield( L, LUA_REGISTRYINDEX, SCRIPT_BOXES_KEY );
+	if ( lua_rawgetp( L, -1, ptr ) == LUA_TUSERDATA
+		&& lua_getmetatable( L, -1 ) ) {
+		bool same;
+
+		luaL_getmetatable( L, mt );
+		same = lua_rawequal( L, -1, -2 );
+		lua_pop( L, 2 );
+		if ( same ) {
+			lua_remove( L, -2 );
+			return;
+		}
+	}
+	lua_pop( L, 1 );
+
+	ud = (void **) lua_newuserdatauv( L, sizeof( void * ), 0 );
+	*ud = ptr;
+	luaL_getmetatable( L, mt );
+	lua_setmetatable( L, -2 );
+	lua_pushvalue( L, -1 );
+	lua_rawsetp( L, -3, ptr );
+	lua_remove( L, -2 );
+}
+
+
 /*
  * Initialize the Lua scripting engine.
  * Called from boot_db() during server startup.
@@ -85,6 +203,8 @@ void script_init( void ) {
 		return;
 	}
 
+	list_init( &sched_threads );
+
 	/* Open safe standard libraries */
 	luaL_requiref( g_lua, "_G",        luaopen_base,      1 );  lua_pop( g_lua, 1 );
 	luaL_requiref( g_lua, "string",    luaopen_string,    1 );  lua_pop( g_lua, 1 );
@@ -95,20 +215,64 @@ void script_init( void ) {
 	/* Lock down the environment */
 	script_sandbox( g_lua );
 
+	/* Weak-valued entity box cache */
+	lua_newtable( g_lua );
+	lua_newtable( g_lua );
+	lua_pushstring( g_lua, "v" );
+	lua_setfield( g_lua, -2, "__mode" );
+	lua_setmetatable( g_lua, -2 );
+	lua_setfield( g_lua, LUA_REGISTRYINDEX, SCRIPT_BOXES_KEY );
+
 	/* Register C API for Lua scripts */
 	script_register_char_api( g_lua );
 	script_register_room_api( g_lua );
 	script_register_obj_api( g_lua );
+	script_register_sched_api( g_lua );
 
 	log_string( "Lua scripting engine initialized (Lua 5.4)." );
 }
 
 
+/* Drop a thread record and let Lua collect the coroutine */
+static void script_thread_release( SCRIPT_THREAD *t ) {
+	if ( t->wait == SCRIPT_WAIT_EVENT && !t->ready )
+		sched_event_waiters--;
+	if ( list_node_is_linked( &t->node ) ) {
+		list_remove( &sched_threads, &t->node );
+		sched_count--;
+	}
+	if ( g_lua != NULL )
+		luaL_unref( g_lua, LUA_REGISTRYINDEX, t->ref );
+	free( t );
+}
+
+
+/* Release dead threads once nothing is iterating the list */
+static void script_reap( void ) {
+	SCRIPT_THREAD *t;
+	SCRIPT_THREAD *t_next;
+
+	if ( sched_walking )
+		return;
+
+	LIST_FOR_EACH_SAFE( t, t_next, &sched_threads, SCRIPT_THREAD, node ) {
+		if ( t->dead )
+			script_thread_release( t );
+	}
+}
+
+
 /*
  * Shut down the Lua scripting engine.
  */
 void script_shutdown( void ) {
+	SCRIPT_THREAD *t;
+	SCRIPT_THREAD *t_next;
+
 	if ( g_lua != NULL ) {
+		LIST_FOR_EACH_SAFE( t, t_next, &sched_threads, SCRIPT_THREAD, node ) {
+			script_thread_release( t );
+		}
 		lua_close( g_lua );
 		g_lua = NULL;
 		log_string( "Lua scripting engine shut down." );
@@ -117,61 +281,192 @@ void script_shutdown( void ) {
 
 
 /*
- * Execute a script's Lua code, calling the named function with arguments.
- *
- * The script's code is loaded (defining functions), then the specified
- * callback function is called.  Any errors are logged and swallowed —
- * a broken script must never crash the game.
+ * Run one slice of a coroutine.
  *
- * Parameters:
- *   script   - The script data (contains Lua source code)
- *   func     - Name of the Lua function to call (e.g. "on_greet")
- *   mob      - The NPC that owns the script (pushed as first arg)
- *   ch       - The player that triggered the event (second arg)
- *   text     - Optional text argument for speech triggers (NULL if none)
+ * Returns the lua_resume() status.  On LUA_OK and with result non-NULL,
+ * *result receives the truthiness of the callback's first return value.
+ * A thread that yields is linked onto the scheduler list; one that ends
+ * (or was cancelled while running) is released.
  */
-void script_run( SCRIPT_DATA *script, const char *func,
-	CHAR_DATA *mob, CHAR_DATA *ch, const char *text ) {
+static int script_resume( SCRIPT_THREAD *t, int nargs, const char *caller,
+	bool *result ) {
 	char buf[MAX_STRING_LENGTH];
-	int nargs;
-	int top;
+	int64_t start_ns, elapsed_ns;
+	int status;
+	int nres = 0;
+
+	if ( t->wait == SCRIPT_WAIT_EVENT && !t->ready )
+		sched_event_waiters--;
+	t->wait = SCRIPT_WAIT_NONE;
+	t->wake_pulse = 0;
+	t->event[0] = '\0';
+	t->ready = FALSE;
+	t->nargs = 0;
+
+	/* Fresh instruction budget for this slice */
+	lua_sethook( t->co, script_timeout_hook, LUA_MASKCOUNT,
+		SCRIPT_MAX_INSTRUCTIONS );
 
-	if ( g_lua == NULL || script == NULL || script->code == NULL )
-		return;
+	t->prev_running = sched_running;
+	sched_running = t;
 
-	top = lua_gettop( g_lua );
+	start_ns = profile_now_ns();
+	PROFILE_START( PROF_LUA_EXEC );
+	status = lua_resume( t->co, g_lua, nargs, &nres );
+	PROFILE_END( PROF_LUA_EXEC );
+	elapsed_ns = profile_now_ns() - start_ns;
+
+	sched_running = t->prev_running;
+	t->prev_running = NULL;
+
+	if ( t->script != NULL ) {
+		t->script->cpu_us += (long) ( elapsed_ns / 1000 );
+		t->script->resumes++;
+	}
+
+	if ( status == LUA_YIELD ) {
+		lua_pop( t->co, nres );
+		if ( t->wait == SCRIPT_WAIT_NONE ) {
+			t->wait = SCRIPT_WAIT_PULSE;
+			t->wake_pulse = sched_pulse + 1;
+		}
+		if ( !t->dead && !list_node_is_linked( &t->node ) ) {
+			if ( sched_count >= SCRIPT_MAX_THREADS ) {
+				snprintf( buf, sizeof( buf ),
+					"%s: too many suspended scripts, dropping '%s.%s'",
+					caller, t->func, t->script ? t->script->name : "?" );
+				bug( buf, 0 );
+				t->dead = TRUE;
+			} else {
+				list_push_back( &sched_threads, &t->node );
+				if ( ++sched_count > sched_peak )
+					sched_peak = sched_count;
+			}
+		}
+	} else if ( status != LUA_OK ) {
+		const char *err = lua_tostring( t->co, -1 );
+		snprintf( buf, sizeof( buf ), "%s: runtime error in '%s.%s'",
+			caller, t->func, t->script ? t->script->name : "?" );
+		bug( buf, 0 );
+		if ( err )
+			log_string( err );
+		if ( t->killed )
+			sched_killed++;
+		sched_errors++;
+		t->dead = TRUE;
+	} else {
+		if ( result != NULL && nres > 0 )
+			*result = lua_toboolean( t->co, -nres );
+		sched_finished++;
+		t->dead = TRUE;
+	}
 
-	/* Reset instruction counter so each script gets a full budget */
+	if ( t->dead ) {
+		if ( !list_node_is_linked( &t->node ) )
+			script_thread_release( t );
+		else
+			script_reap();
+	}
+	return status;
+}
+
+
+/*
+ * Start a callback as a new coroutine.
+ * Expects the function and its nargs arguments on top of g_lua's stack;
+ * they are moved onto the new thread.
+ */
+static int script_start( SCRIPT_DATA *script, const char *func, void *owner,
+	int nargs, const char *caller, bool *result ) {
+	SCRIPT_THREAD *t;
+
+	t = calloc( 1, sizeof( *t ) );
+	if ( t == NULL ) {
+		bug( "script_start: calloc failed", 0 );
+		lua_pop( g_lua, nargs + 1 );
+		return LUA_ERRMEM;
+	}
+
+	t->co = lua_newthread( g_lua );
+	t->ref = luaL_ref( g_lua, LUA_REGISTRYINDEX );
+	lua_xmove( g_lua, t->co, nargs + 1 );
+	t->script = script;
+	t->func = func;
+	t->owner = owner;
+	list_node_init( &t->node );
+
+	sched_started++;
+	return script_resume( t, nargs, caller, result );
+}
+
+
+/*
+ * Load a script's code (defining its functions) and push the named
+ * callback onto g_lua.  Returns FALSE, with the stack restored to top,
+ * if the code fails to load or does not define func.
+ */
+static bool script_load( SCRIPT_DATA *script, const char *func,
+	const char *caller, int top ) {
+	char buf[MAX_STRING_LENGTH];
+
+	/* Reset instruction counter so each chunk gets a full budget */
 	lua_sethook( g_lua, script_timeout_hook, LUA_MASKCOUNT,
 		SCRIPT_MAX_INSTRUCTIONS );
 
-	/* Load and execute the script code to define its functions */
-	PROFILE_START( "lua_compile" );
+	PROFILE_START( PROF_LUA_COMPILE );
 	if ( luaL_dostring( g_lua, script->code ) != LUA_OK ) {
-		PROFILE_END( "lua_compile" );
+		PROFILE_END( PROF_LUA_COMPILE );
 		const char *err = lua_tostring( g_lua, -1 );
 		snprintf( buf, sizeof( buf ),
-			"script_run: load error in '%s'", script->name );
+			"%s: load error in '%s'", caller, script->name );
 		bug( buf, 0 );
 		if ( err )
 			log_string( err );
 		lua_settop( g_lua, top );
-		return;
+		return FALSE;
 	}
-	PROFILE_END( "lua_compile" );
+	PROFILE_END( PROF_LUA_COMPILE );
 
-	/* Look up the callback function */
 	lua_getglobal( g_lua, func );
 	if ( !lua_isfunction( g_lua, -1 ) ) {
 		/* Function not defined — not an error, script may only handle
 		 * some trigger types */
 		lua_settop( g_lua, top );
-		return;
+		return FALSE;
 	}
+	return TRUE;
+}
+
+
+/*
+ * Execute a script's Lua code, calling the named function with arguments.
+ *
+ * The script's code is loaded (defining functions), then the specified
+ * callback is started as a coroutine.  Any errors are logged and
+ * swallowed — a broken script must never crash the game.
+ *
+ * Parameters:
+ *   script   - The script data (contains Lua source code)
+ *   func     - Name of the Lua function to call (e.g. "on_greet")
+ *   mob      - The NPC that owns the script (pushed as first arg)
+ *   ch       - The player that triggered the event (second arg)
+ *   text     - Optional text argument for speech triggers (NULL if none)
+ */
+void script_run( SCRIPT_DATA *script, const char *func,
+	CHAR_DATA *mob, CHAR_DATA *ch, const char *text ) {
+	int nargs;
+	int top;
+
+	if ( g_lua == NULL || script == NULL || script->code == NULL )
+		return;
+
+	top = lua_gettop( g_lua );
+	if ( !script_load( script, func, "script_run", top ) )
+		return;
 
 	/* Push arguments: mob, ch, [text] */
-	PUSH_UD( g_lua, mob, "Char" );
-	PUSH_UD( g_lua, ch, "Char" );
+	script_push_entity( g_lua, mob, "Char" );
+	script_push_entity( g_lua, ch, "Char" );
 
 	nargs = 2;
 
@@ -180,50 +475,61 @@ void script_run( SCRIPT_DATA *script, const char *func,
 		nargs = 3;
 	}
 
-	/* Call the function with error handling */
-	PROFILE_START( "lua_exec" );
-	if ( lua_pcall( g_lua, nargs, 0, 0 ) != LUA_OK ) {
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run: runtime error in '%s.%s'", func, script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
-	}
-	PROFILE_END( "lua_exec" );
-
-	/* Clean up the stack */
+	script_start( script, func, mob, nargs, "script_run", NULL );
 	lua_settop( g_lua, top );
 }
 
 
+/* TRUE if owner already has a live coroutine running script */
+static bool script_thread_busy( void *owner, SCRIPT_DATA *script ) {
+	SCRIPT_THREAD *t;
+
+	for ( t = sched_running; t != NULL; t = t->prev_running ) {
+		if ( t->owner == owner && t->script == script && !t->dead )
+			return TRUE;
+	}
+	LIST_FOR_EACH( t, &sched_threads, SCRIPT_THREAD, node ) {
+		if ( t->owner == owner && t->script == script && !t->dead )
+			return TRUE;
+	}
+	return FALSE;
+}
+
+
 /*
  * Execute a mob's tick script and return its boolean result.
  * Lua callback: on_tick(mob) → true to skip remaining AI, false to continue.
  * Used for autonomous NPC behaviors (replaces C spec_funs).
  *
+ * While an earlier on_tick for the same mob is still suspended (waiting
+ * or preempted) no new one is started and the mob counts as busy, so a
+ * multi-step behavior owns the mob until it finishes.
+ *
  * The on_tick function is cached in the Lua registry after first compilation
  * so subsequent calls skip parsing/compilation entirely.
  */
 bool script_run_tick( SCRIPT_DATA *script, CHAR_DATA *mob ) {
 	char buf[MAX_STRING_LENGTH];
 	int top;
+	int status;
 	bool result = FALSE;
 
 	if ( g_lua == NULL || script == NULL || script->code == NULL )
 		return FALSE;
 
-	top = lua_gettop( g_lua );
+	if ( script_thread_busy( mob, script ) )
+		return TRUE;
 
-	/* Reset instruction counter so each script gets a full budget */
-	lua_sethook( g_lua, script_timeout_hook, LUA_MASKCOUNT,
-		SCRIPT_MAX_INSTRUCTIONS );
+	top = lua_gettop( g_lua );
 
 	/* Compile and cache on first use */
 	if ( script->lua_ref == LUA_NOREF ) {
-		PROFILE_START( "lua_compile" );
+		lua_sethook( g_lua, script_timeout_hook, LUA_MASKCOUNT,
+			SCRIPT_MAX_INSTRUCTIONS );
+
+		PROFILE_START( PROF_LUA_COMPILE );
 		if ( luaL_dostring( g_lua, script->code ) != LUA_OK ) {
-			PROFILE_END( "lua_compile" );
+			PROFILE_END( PROF_LUA_COMPILE );
 			const char *err = lua_tostring( g_lua, -1 );
 			snprintf( buf, sizeof( buf ),
 				"script_run_tick: load error in '%s'", script->name );
@@ -233,7 +539,7 @@ bool script_run_tick( SCRIPT_DATA *script, CHAR_DATA *mob ) {
 			lua_settop( g_lua, top );
 			return FALSE;
 		}
-		PROFILE_END( "lua_compile" );
+		PROFILE_END( PROF_LUA_COMPILE );
 
 		/* Grab on_tick and cache it in the registry */
 		lua_getglobal( g_lua, "on_tick" );
@@ -244,28 +550,18 @@ bool script_run_tick( SCRIPT_DATA *script, CHAR_DATA *mob ) {
 		script->lua_ref = luaL_ref( g_lua, LUA_REGISTRYINDEX );
 	}
 
-	/* Retrieve cached on_tick function */
-	PROFILE_START( "lua_exec" );
+	/* Retrieve cached on_tick function and push argument: mob */
 	lua_rawgeti( g_lua, LUA_REGISTRYINDEX, script->lua_ref );
+	script_push_entity( g_lua, mob, "Char" );
 
-	/* Push argument: mob */
-	PUSH_UD( g_lua, mob, "Char" );
-
-	/* Call with 1 arg, 1 return value */
-	if ( lua_pcall( g_lua, 1, 1, 0 ) != LUA_OK ) {
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run_tick: runtime error in '%s'", script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
+	status = script_start( script, "on_tick", mob, 1, "script_run_tick", &result );
+	if ( status == LUA_YIELD ) {
+		result = TRUE;
+	} else if ( status != LUA_OK && script->lua_ref != LUA_NOREF ) {
 		/* Invalidate cache so script is recompiled next tick */
 		luaL_unref( g_lua, LUA_REGISTRYINDEX, script->lua_ref );
 		script->lua_ref = LUA_NOREF;
-	} else {
-		result = lua_toboolean( g_lua, -1 );
 	}
-	PROFILE_END( "lua_exec" );
 
 	lua_settop( g_lua, top );
 	return result;
@@ -285,7 +581,6 @@ bool script_run_tick( SCRIPT_DATA *script, CHAR_DATA *mob ) {
  */
 void script_run_obj( SCRIPT_DATA *script, const char *func,
 	OBJ_DATA *obj, CHAR_DATA *ch, CHAR_DATA *victim ) {
-	char buf[MAX_STRING_LENGTH];
 	int nargs;
 	int top;
 
@@ -293,57 +588,21 @@ void script_run_obj( SCRIPT_DATA *script, const char *func,
 		return;
 
 	top = lua_gettop( g_lua );
-
-	/* Reset instruction counter so each script gets a full budget */
-	lua_sethook( g_lua, script_timeout_hook, LUA_MASKCOUNT,
-		SCRIPT_MAX_INSTRUCTIONS );
-
-	/* Load and execute the script code to define its functions */
-	PROFILE_START( "lua_compile" );
-	if ( luaL_dostring( g_lua, script->code ) != LUA_OK ) {
-		PROFILE_END( "lua_compile" );
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run_obj: load error in '%s'", script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
-		lua_settop( g_lua, top );
+	if ( !script_load( script, func, "script_run_obj", top ) )
 		return;
-	}
-	PROFILE_END( "lua_compile" );
-
-	/* Look up the callback function */
-	lua_getglobal( g_lua, func );
-	if ( !lua_isfunction( g_lua, -1 ) ) {
-		lua_settop( g_lua, top );
-		return;
-	}
 
 	/* Push arguments: obj, ch, [victim] */
-	PUSH_UD( g_lua, obj, "Obj" );
-	PUSH_UD( g_lua, ch, "Char" );
+	script_push_entity( g_lua, obj, "Obj" );
+	script_push_entity( g_lua, ch, "Char" );
 
 	nargs = 2;
 
 	if ( victim != NULL ) {
-		PUSH_UD( g_lua, victim, "Char" );
+		script_push_entity( g_lua, victim, "Char" );
 		nargs = 3;
 	}
 
-	/* Call the function with error handling */
-	PROFILE_START( "lua_exec" );
-	if ( lua_pcall( g_lua, nargs, 0, 0 ) != LUA_OK ) {
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run_obj: runtime error in '%s.%s'", func, script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
-	}
-	PROFILE_END( "lua_exec" );
-
-	/* Clean up the stack */
+	script_start( script, func, obj, nargs, "script_run_obj", NULL );
 	lua_settop( g_lua, top );
 }
 
@@ -354,7 +613,6 @@ void script_run_obj( SCRIPT_DATA *script, const char *func,
  */
 void script_run_room( SCRIPT_DATA *script, const char *func,
 	CHAR_DATA *ch, ROOM_INDEX_DATA *room, const char *text ) {
-	char buf[MAX_STRING_LENGTH];
 	int nargs;
 	int top;
 
@@ -362,34 +620,12 @@ void script_run_room( SCRIPT_DATA *script, const char *func,
 		return;
 
 	top = lua_gettop( g_lua );
-
-	/* Reset instruction counter so each script gets a full budget */
-	lua_sethook( g_lua, script_timeout_hook, LUA_MASKCOUNT,
-		SCRIPT_MAX_INSTRUCTIONS );
-
-	PROFILE_START( "lua_compile" );
-	if ( luaL_dostring( g_lua, script->code ) != LUA_OK ) {
-		PROFILE_END( "lua_compile" );
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run_room: load error in '%s'", script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
-		lua_settop( g_lua, top );
-		return;
-	}
-	PROFILE_END( "lua_compile" );
-
-	lua_getglobal( g_lua, func );
-	if ( !lua_isfunction( g_lua, -1 ) ) {
-		lua_settop( g_lua, top );
+	if ( !script_load( script, func, "script_run_room", top ) )
 		return;
-	}
 
 	/* Push arguments: ch, room, [text] */
-	PUSH_UD( g_lua, ch, "Char" );
-	PUSH_UD( g_lua, room, "Room" );
+	script_push_entity( g_lua, ch, "Char" );
+	script_push_entity( g_lua, room, "Room" );
 
 	nargs = 2;
 
@@ -398,17 +634,7 @@ void script_run_room( SCRIPT_DATA *script, const char *func,
 		nargs = 3;
 	}
 
-	PROFILE_START( "lua_exec" );
-	if ( lua_pcall( g_lua, nargs, 0, 0 ) != LUA_OK ) {
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run_room: runtime error in '%s.%s'", func, script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
-	}
-	PROFILE_END( "lua_exec" );
-
+	script_start( script, func, room, nargs, "script_run_room", NULL );
 	lua_settop( g_lua, top );
 }
 
@@ -422,71 +648,315 @@ void script_run_room( SCRIPT_DATA *script, const char *func,
  *   area_high — integer (area upper vnum bound)
  *
  * Lua callback: on_death(killer, mob_vnum, area_low, area_high)
+ * The coroutine has no owner; it can still wait() but not wait_for_event().
  */
 void script_run_death( SCRIPT_DATA *script, const char *func,
 	CHAR_DATA *killer, int mob_vnum, int area_low, int area_high ) {
-	char buf[MAX_STRING_LENGTH];
 	int top;
 
 	if ( g_lua == NULL || script == NULL || script->code == NULL )
 		return;
 
 	top = lua_gettop( g_lua );
-
-	lua_sethook( g_lua, script_timeout_hook, LUA_MASKCOUNT,
-		SCRIPT_MAX_INSTRUCTIONS );
-
-	PROFILE_START( "lua_compile" );
-	if ( luaL_dostring( g_lua, script->code ) != LUA_OK ) {
-		PROFILE_END( "lua_compile" );
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run_death: load error in '%s'", script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
-		lua_settop( g_lua, top );
-		return;
-	}
-	PROFILE_END( "lua_compile" );
-
-	lua_getglobal( g_lua, func );
-	if ( !lua_isfunction( g_lua, -1 ) ) {
-		lua_settop( g_lua, top );
+	if ( !script_load( script, func, "script_run_death", top ) )
 		return;
-	}
 
 	/* Push arguments: killer, mob_vnum, area_low, area_high */
-	PUSH_UD( g_lua, killer, "Char" );
+	script_push_entity( g_lua, killer, "Char" );
 	lua_pushinteger( g_lua, mob_vnum );
 	lua_pushinteger( g_lua, area_low );
 	lua_pushinteger( g_lua, area_high );
 
-	PROFILE_START( "lua_exec" );
-	if ( lua_pcall( g_lua, 4, 0, 0 ) != LUA_OK ) {
-		const char *err = lua_tostring( g_lua, -1 );
-		snprintf( buf, sizeof( buf ),
-			"script_run_death: runtime error in '%s.%s'", func, script->name );
-		bug( buf, 0 );
-		if ( err )
-			log_string( err );
-	}
-	PROFILE_END( "lua_exec" );
-
+	script_start( script, func, NULL, 4, "script_run_death", NULL );
 	lua_settop( g_lua, top );
 }
 
 
 /*
  * Invalidate a script's cached Lua function.
- * Forces recompilation on the next tick.  Call when script code changes
- * (e.g., OLC editing or hot-reload).
+ * Forces recompilation on the next tick and cancels any of the script's
+ * suspended coroutines.  Call when script code changes (e.g., OLC editing
+ * or hot-reload) and before freeing a SCRIPT_DATA.
  */
 void script_invalidate_cache( SCRIPT_DATA *script ) {
+	SCRIPT_THREAD *t;
+
 	if ( script == NULL )
 		return;
 	if ( g_lua != NULL && script->lua_ref != LUA_NOREF ) {
 		luaL_unref( g_lua, LUA_REGISTRYINDEX, script->lua_ref );
 	}
 	script->lua_ref = LUA_NOREF;
+
+	if ( g_lua == NULL )
+		return;
+	for ( t = sched_running; t != NULL; t = t->prev_running ) {
+		if ( t->script == script ) {
+			t->dead = TRUE;
+			t->script = NULL;
+		}
+	}
+	LIST_FOR_EACH( t, &sched_threads, SCRIPT_THREAD, node ) {
+		if ( t->script == script ) {
+			t->dead = TRUE;
+			t->script = NULL;
+		}
+	}
+	script_reap();
+}
+
+
+/* ================================================================
+ * Scheduler
+ * ================================================================ */
+
+/* Check that L is the running trigger coroutine and can yield */
+static SCRIPT_THREAD *script_check_yield( lua_State *L, const char *what ) {
+	SCRIPT_THREAD *t = sched_running;
+
+	if ( t == NULL || t->co != L || !lua_isyieldable( L ) ) {
+		luaL_error( L, "%s: can only be called from a trigger callback", what );
+		return NULL;
+	}
+	t->preempts = 0;
+	return t;
+}
+
+
+/*
+ * wait(pulses) / yield() — suspend the calling script for a number of
+ * pulses.  Called from the Lua API in script_api.c; never returns normally.
+ */
+int script_wait_pulses( lua_State *L, int pulses ) {
+	SCRIPT_THREAD *t = script_check_yield( L, "wait" );
+
+	if ( pulses < 1 )
+		pulses = 1;
+	t->wait = SCRIPT_WAIT_PULSE;
+	t->wake_pulse = sched_pulse + pulses;
+	return lua_yield( L, 0 );
+}
+
+
+/*
+ * wait_for_event(name [, timeout]) — suspend until script_signal_event()
+ * delivers name to this script's owner.  The Lua call returns the event's
+ * (actor, text), or nothing if timeout pulses pass first.
+ */
+int script_wait_event( lua_State *L, const char *event, int timeout ) {
+	SCRIPT_THREAD *t = script_check_yield( L, "wait_for_event" );
+
+	if ( t->owner == NULL )
+		return luaL_error( L, "wait_for_event: this trigger has no owner" );
+
+	t->wait = SCRIPT_WAIT_EVENT;
+	t->wake_pulse = timeout > 0 ? sched_pulse + timeout : 0;
+	strncpy( t->event, event, SCRIPT_EVENT_LEN - 1 );
+	t->event[SCRIPT_EVENT_LEN - 1] = '\0';
+	sched_event_waiters++;
+	return lua_yield( L, 0 );
+}
+
+
+/*
+ * Mark coroutines waiting for event on owner as ready.  The event's
+ * values are pushed onto each waiting coroutine now and handed to it
+ * when the scheduler resumes it on the next pulse; resuming here would
+ * re-enter scripts from arbitrary game code.
+ */
+void script_signal_event( void *owner, const char *event,
+	CHAR_DATA *actor, const char *text ) {
+	SCRIPT_THREAD *t;
+
+	if ( g_lua == NULL || sched_event_waiters == 0 )
+		return;
+	if ( owner == NULL || event == NULL )
+		return;
+
+	LIST_FOR_EACH( t, &sched_threads, SCRIPT_THREAD, node ) {
+		if ( t->dead || t->ready || t->wait != SCRIPT_WAIT_EVENT )
+			continue;
+		if ( t->owner != owner || str_cmp( t->event, event ) )
+			continue;
+
+		if ( actor != NULL )
+			script_push_entity( t->co, actor, "Char" );
+		else
+			lua_pushnil( t->co );
+		if ( text != NULL )
+			lua_pushstring( t->co, text );
+		else
+			lua_pushnil( t->co );
+		t->nargs = 2;
+		t->ready = TRUE;
+		sched_event_waiters--;
+	}
+}
+
+
+/*
+ * Resume every coroutine whose wait has expired or whose event arrived.
+ * Called once per pulse from update_handler().
+ */
+void script_scheduler_pulse( void ) {
+	SCRIPT_THREAD *t;
+
+	if ( g_lua == NULL )
+		return;
+
+	sched_pulse++;
+	if ( list_empty( &sched_threads ) )
+		return;
+
+	PROFILE_START( PROF_SCRIPT_SCHEDULER );
+	sched_walking = TRUE;
+	LIST_FOR_EACH( t, &sched_threads, SCRIPT_THREAD, node ) {
+		if ( t->dead )
+			continue;
+		if ( !t->ready && ( t->wake_pulse == 0 || sched_pulse < t->wake_pulse ) )
+			continue;
+		script_resume( t, t->nargs, "script_scheduler", NULL );
+	}
+	sched_walking = FALSE;
+	script_reap();
+	PROFILE_END( PROF_SCRIPT_SCHEDULER );
+}
+
+
+/*
+ * A char or object is leaving the world.  Null its cached Lua box so
+ * scripts still holding it fail cleanly, and cancel coroutines it owns.
+ */
+void script_forget_entity( void *ptr ) {
+	SCRIPT_THREAD *t;
+
+	if ( g_lua == NULL || ptr == NULL )
+		return;
+
+	lua_getfield( g_lua, LUA_REGISTRYINDEX, SCRIPT_BOXES_KEY );
+	if ( lua_rawgetp( g_lua, -1, ptr ) == LUA_TUSERDATA ) {
+		void **ud = (void **) lua_touserdata( g_lua, -1 );
+		*ud = NULL;
+		lua_pushnil( g_lua );
+		lua_rawsetp( g_lua, -3, ptr );
+	}
+	lua_pop( g_lua, 2 );
+
+	for ( t = sched_running; t != NULL; t = t->prev_running ) {
+		if ( t->owner == ptr )
+			t->dead = TRUE;
+	}
+	LIST_FOR_EACH( t, &sched_threads, SCRIPT_THREAD, node ) {
+		if ( t->owner == ptr )
+			t->dead = TRUE;
+	}
+	script_reap();
+}
+
+
+int script_thread_count( void ) {
+	return sched_count;
+}
+
+
+/* Insert script into a top-N list ordered by cpu_us */
+static void script_rank( SCRIPT_DATA **top, const char **kind, int *vnum,
+	int max, int *n, SCRIPT_DATA *script, const char *k, int v ) {
+	int i;
+
+	if ( script->resumes == 0 )
+		return;
+	if ( *n == max && top[max - 1]->cpu_us >= script->cpu_us )
+		return;
+
+	i = ( *n < max ) ? ( *n )++ : max - 1;
+	while ( i > 0 && top[i - 1]->cpu_us < script->cpu_us ) {
+		top[i] = top[i - 1];
+		kind[i] = kind[i - 1];
+		vnum[i] = vnum[i - 1];
+		i--;
+	}
+	top[i] = script;
+	kind[i] = k;
+	vnum[i] = v;
+}
+
+
+/*
+ * Scheduler counters and the scripts that have used the most time.
+ * Shown by "profile scripts".
+ */
+void script_report( CHAR_DATA *ch ) {
+	enum { TOP_MAX = 10 };
+	SCRIPT_DATA *top[TOP_MAX];
+	const char *kind[TOP_MAX];
+	int vnum[TOP_MAX];
+	char buf[MAX_STRING_LENGTH];
+	SCRIPT_THREAD *t;
+	SCRIPT_DATA *script;
+	MOB_INDEX_DATA *pMob;
+	OBJ_INDEX_DATA *pObj;
+	ROOM_INDEX_DATA *pRoom;
+	AREA_DATA *pArea;
+	int timed = 0, events = 0;
+	int n = 0;
+	int i;
+
+	if ( g_lua == NULL ) {
+		send_to_char( "Lua scripting is not running.\n\r", ch );
+		return;
+	}
+
+	LIST_FOR_EACH( t, &sched_threads, SCRIPT_THREAD, node ) {
+		if ( t->wait == SCRIPT_WAIT_EVENT )
+			events++;
+		else
+			timed++;
+	}
+
+	send_to_char( "#C=== Lua Coroutines ===#n\n\r", ch );
+	snprintf( buf, sizeof( buf ),
+		"Suspended: #W%d#n (%d timed, %d on events)   Peak: %d   Cap: %d\n\r",
+		sched_count, timed, events, sched_peak, SCRIPT_MAX_THREADS );
+	send_to_char( buf, ch );
+	snprintf( buf, sizeof( buf ),
+		"Started: %ld   Finished: %ld   Errors: %ld   Killed: %ld   Preempted: %ld\n\r\n\r",
+		sched_started, sched_finished, sched_errors, sched_killed, sched_preempted );
+	send_to_char( buf, ch );
+
+	for ( i = 0; i < MAX_KEY_HASH; i++ ) {
+		for ( pMob = mob_index_hash[i]; pMob != NULL; pMob = pMob->next ) {
+			LIST_FOR_EACH( script, &pMob->scripts, SCRIPT_DATA, node )
+				script_rank( top, kind, vnum, TOP_MAX, &n, script, "mob", pMob->vnum );
+		}
+		for ( pObj = obj_index_hash[i]; pObj != NULL; pObj = pObj->next ) {
+			LIST_FOR_EACH( script, &pObj->scripts, SCRIPT_DATA, node )
+				script_rank( top, kind, vnum, TOP_MAX, &n, script, "obj", pObj->vnum );
+		}
+	}
+	LIST_FOR_EACH( pArea, &g_areas, AREA_DATA, node ) {
+		for ( pRoom = pArea->room_first; pRoom; pRoom = pRoom->next_in_area ) {
+			LIST_FOR_EACH( script, room_scripts( pRoom ), SCRIPT_DATA, node )
+				script_rank( top, kind, vnum, TOP_MAX, &n, script, "room", pRoom->vnum );
+		}
+	}
+
+	if ( n == 0 ) {
+		send_to_char( "No scripts have run yet.\n\r", ch );
+		script_trigger_report( ch );
+		return;
+	}
+
+	send_to_char( "#CScript               Owner         Slices    Total ms   Avg us#n\n\r", ch );
+	for ( i = 0; i < n; i++ ) {
+		char owner[32];
+
+		snprintf( owner, sizeof( owner ), "%s %d", kind[i], vnum[i] );
+		snprintf( buf, sizeof( buf ), "%-20.20s %-12s %7ld %11.2f %8ld\n\r",
+			top[i]->name ? top[i]->name : "(unnamed)", owner,
+			top[i]->resumes, top[i]->cpu_us / 1000.0,
+			top[i]->cpu_us / top[i]->resumes );
+		send_to_char( buf, ch );
+	}
+	script_trigger_report( ch );
 }
@@ -2,8 +2,10 @@
  * script_trigger.c — Trigger dispatch for Lua scripts.
  *
  * Each trigger function is called from a specific game hook point.
- * It iterates NPCs or room scripts, checks trigger type and conditions,
- * then calls script_run() to execute the Lua callback.
+ * It walks the subscribed NPCs, objects or room scripts, checks trigger
+ * type and conditions, then calls script_run() to execute the Lua
+ * callback.  Each hook also signals its event to coroutines blocked in
+ * wait_for_event().
  */
 
 #include "merc.h"
@@ -23,6 +25,176 @@ void script_run_death( SCRIPT_DATA *script, const char *func,
 	CHAR_DATA *killer, int mob_vnum, int area_low, int area_high );
 
 
+
+
+/* ================================================================
+ * Subscription index
+ *
+ * Dispatch used to walk every character in a room (and every object in
+ * the game for obj ticks) and then each template's script list.  Now a
+ * scripted NPC registers on its room's script_mobs list as it enters and
+ * leaves, and an object with TRIG_TICK scripts registers on tick_objs
+ * while it is carried.  Dispatch only touches those subscribers, and each
+ * template's script_trigs mask skips templates without the trigger.
+ * ================================================================ */
+
+/* Carried objects with TRIG_TICK scripts */
+static list_head_t *tick_objs( void ) {
+	static list_head_t head;
+	if ( !head.sentinel.next ) list_init( &head );
+	return &head;
+}
+
+/*
+ * Scripts can move or extract subscribers while a dispatch loop is
+ * walking their list.  Each loop registers its saved "next" pointer
+ * here, and unlinking a node steps any cursor that points at it.  Loops
+ * also register the current node, so they can tell that the subscriber
+ * they are firing left the list (or was freed) mid-callback.
+ */
+#define SUB_MAX_CURSORS 16
+
+static list_node_t **sub_cursors[SUB_MAX_CURSORS];
+static int sub_cursor_depth = 0;
+
+static bool sub_cursor_push( list_node_t **cur, list_node_t **next ) {
+	if ( sub_cursor_depth + 2 > SUB_MAX_CURSORS ) {
+		bug( "script dispatch: trigger nesting too deep (%d)", sub_cursor_depth );
+		return FALSE;
+	}
+	sub_cursors[sub_cursor_depth++] = cur;
+	sub_cursors[sub_cursor_depth++] = next;
+	return TRUE;
+}
+
+static void sub_cursor_pop( void ) {
+	sub_cursor_depth -= 2;
+}
+
+static void sub_unlink( list_head_t *head, list_node_t *node ) {
+	int i;
+
+	for ( i = 0; i < sub_cursor_depth; i++ ) {
+		if ( *sub_cursors[i] == node )
+			*sub_cursors[i] = node->next;
+	}
+	list_remove( head, node );
+}
+
+
+/* Per-trigger dispatch counters, shown by "profile scripts" */
+enum {
+	TS_GREET, TS_SPEECH, TS_TICK, TS_ROOM_ENTER, TS_ROOM_SAY,
+	TS_ROOM_EXAMINE, TS_OBJ_TICK, TS_OBJ_KILL, TS_DEATH, TS_MAX
+};
+
+typedef struct trigger_stat {
+	const char *name;
+	long        visits;   /* Subscribers touched */
+	long        evals;    /* Scripts whose trigger bit matched */
+	long        fires;    /* Callbacks started */
+} TRIGGER_STAT;
+
+static TRIGGER_STAT trig_stats[TS_MAX] = {
+	{ "greet" }, { "speech" }, { "mob tick" }, { "room enter" },
+	{ "room say" }, { "room examine" }, { "obj tick" }, { "obj kill" },
+	{ "mob death" }
+};
+
+
+/* OR of every trigger bit on a template's script list */
+static uint32_t script_trigger_mask( list_head_t *scripts ) {
+	SCRIPT_DATA *script;
+	uint32_t mask = 0;
+
+	LIST_FOR_EACH( script, scripts, SCRIPT_DATA, node )
+		mask |= script->trigger;
+	return mask;
+}
+
+
+/*
+ * Called from char_to_room().  Any scripted NPC subscribes, not only
+ * those with GREET/SPEECH scripts, so its suspended coroutines still
+ * hear room events through wait_for_event().
+ */
+void script_sub_char_to_room( CHAR_DATA *ch, ROOM_INDEX_DATA *room ) {
+	if ( !IS_NPC( ch ) || ch->pIndexData == NULL || ch->pIndexData->script_trigs == 0 )
+		return;
+	if ( list_node_is_linked( &ch->script_node ) )
+		return;
+	list_push_back( &room_dynamic( room )->script_mobs, &ch->script_node );
+}
+
+/* Called from char_from_room() while ch->in_room is still set */
+void script_sub_char_from_room( CHAR_DATA *ch ) {
+	if ( !IS_NPC( ch ) || ch->pIndexData == NULL )
+		return;
+	if ( ch->in_room == NULL || ch->in_room->dynamic == NULL )
+		return;
+	if ( !list_node_is_linked( &ch->script_node ) )
+		return;
+	sub_unlink( &ch->in_room->dynamic->script_mobs, &ch->script_node );
+}
+
+/* Called from obj_to_char() */
+void script_sub_obj_to_char( OBJ_DATA *obj ) {
+	if ( obj->pIndexData == NULL || !IS_SET( obj->pIndexData->script_trigs, TRIG_TICK ) )
+		return;
+	if ( list_node_is_linked( &obj->script_node ) )
+		return;
+	list_push_back( tick_objs(), &obj->script_node );
+}
+
+/* Called from obj_from_char() */
+void script_sub_obj_from_char( OBJ_DATA *obj ) {
+	if ( obj->pIndexData == NULL || !IS_SET( obj->pIndexData->script_trigs, TRIG_TICK ) )
+		return;
+	if ( !list_node_is_linked( &obj->script_node ) )
+		return;
+	sub_unlink( tick_objs(), &obj->script_node );
+}
+
+
+/*
+ * Recompute a template's trigger mask after its script list changed,
+ * and bring the subscriptions of its live instances in line.
+ */
+void script_index_refresh_mob( MOB_INDEX_DATA *pMob ) {
+	CHAR_DATA *mob;
+
+	pMob->script_trigs = script_trigger_mask( &pMob->scripts );
+	if ( pMob->count <= 0 )
+		return;
+
+	LIST_FOR_EACH( mob, &pMob->instances, CHAR_DATA, proto_node ) {
+		if ( mob->in_room == NULL )
+			continue;
+		if ( pMob->script_trigs != 0 )
+			script_sub_char_to_room( mob, mob->in_room );
+		else
+			script_sub_char_from_room( mob );
+	}
+}
+
+void script_index_refresh_obj( OBJ_INDEX_DATA *pObj ) {
+	OBJ_DATA *obj;
+
+	pObj->script_trigs = script_trigger_mask( &pObj->scripts );
+	if ( pObj->count <= 0 )
+		return;
+
+	LIST_FOR_EACH( obj, &pObj->instances, OBJ_DATA, proto_node ) {
+		if ( obj->carried_by == NULL )
+			continue;
+		if ( IS_SET( pObj->script_trigs, TRIG_TICK ) )
+			script_sub_obj_to_char( obj );
+		else if ( list_node_is_linked( &obj->script_node ) )
+			sub_unlink( tick_objs(), &obj->script_node );
+	}
+}
+
+
 /*
  * Check if a script's chance roll succeeds.
  * chance == 0 means always fire.
@@ -49,55 +221,84 @@ static bool script_pattern_match( SCRIPT_DATA *script, const char *text ) {
 
 
 /*
- * TRIG_GREET — fired when a player enters a room.
- * Iterates all NPCs in the room and fires their TRIG_GREET scripts.
- *
- * Called from act_move.c and nanny.c after char_to_room().
+ * Walk the scripted NPCs in a room for a GREET or SPEECH event.
+ * text is NULL for greet.
  */
-void script_trigger_greet( CHAR_DATA *ch, ROOM_INDEX_DATA *room ) {
+static void script_dispatch_room_mobs( CHAR_DATA *ch, ROOM_INDEX_DATA *room,
+	int which, uint32_t trig, const char *event, const char *func,
+	const char *text ) {
+	TRIGGER_STAT *ts = &trig_stats[which];
+	list_head_t *head;
+	list_node_t *pos;
+	list_node_t *cur;
+	list_node_t *next;
 	CHAR_DATA *mob;
-	CHAR_DATA *mob_next;
 	SCRIPT_DATA *script;
 
-	if ( ch == NULL || room == NULL )
+	if ( room->dynamic == NULL || list_empty( &room->dynamic->script_mobs ) )
 		return;
+	head = &room->dynamic->script_mobs;
 
-	/* Only player entry triggers greet */
-	if ( IS_NPC( ch ) )
+	if ( !sub_cursor_push( &cur, &next ) )
 		return;
-
-	LIST_FOR_EACH_SAFE( mob, mob_next, &room->characters, CHAR_DATA, room_node ) {
-		if ( !IS_NPC( mob ) )
-			continue;
+	for ( pos = head->sentinel.next; pos != &head->sentinel; pos = next ) {
+		cur = pos;
+		next = pos->next;
+		mob = LIST_ENTRY( pos, CHAR_DATA, script_node );
 		if ( mob == ch )
 			continue;
-		if ( mob->pIndexData == NULL )
+
+		ts->visits++;
+		script_signal_event( mob, event, ch, text );
+
+		if ( !IS_SET( mob->pIndexData->script_trigs, trig ) )
 			continue;
 
 		LIST_FOR_EACH( script, &mob->pIndexData->scripts, SCRIPT_DATA, node ) {
-			if ( !IS_SET( script->trigger, TRIG_GREET ) )
+			if ( !IS_SET( script->trigger, trig ) )
+				continue;
+			ts->evals++;
+			if ( text != NULL && !script_pattern_match( script, text ) )
 				continue;
 			if ( !script_chance_check( script ) )
 				continue;
 
-			script_run( script, "on_greet", mob, ch, NULL );
+			ts->fires++;
+			script_run( script, func, mob, ch, text );
+			if ( cur != pos )
+				break;
 		}
 	}
+	sub_cursor_pop();
+}
+
+
+/*
+ * TRIG_GREET — fired when a player enters a room.
+ * Fires the TRIG_GREET scripts of the scripted NPCs in the room.
+ *
+ * Called from act_move.c and nanny.c after char_to_room().
+ */
+void script_trigger_greet( CHAR_DATA *ch, ROOM_INDEX_DATA *room ) {
+	if ( ch == NULL || room == NULL )
+		return;
+
+	/* Only player entry triggers greet */
+	if ( IS_NPC( ch ) )
+		return;
+
+	script_dispatch_room_mobs( ch, room, TS_GREET, TRIG_GREET,
+		"greet", "on_greet", NULL );
 }
 
 
 /*
  * TRIG_SPEECH — fired when a player says something.
- * Iterates all NPCs in the room and fires matching TRIG_SPEECH scripts.
+ * Fires matching TRIG_SPEECH scripts of the scripted NPCs in the room.
  *
  * Called from act_comm.c in do_say().
  */
 void script_trigger_speech( CHAR_DATA *ch, const char *text ) {
-	CHAR_DATA *mob;
-	CHAR_DATA *mob_next;
-	SCRIPT_DATA *script;
-	ROOM_INDEX_DATA *room;
-
 	if ( ch == NULL || text == NULL || text[0] == '\0' )
 		return;
 
@@ -105,29 +306,11 @@ void script_trigger_speech( CHAR_DATA *ch, const char *text ) {
 	if ( IS_NPC( ch ) )
 		return;
 
-	room = ch->in_room;
-	if ( room == NULL )
+	if ( ch->in_room == NULL )
 		return;
 
-	LIST_FOR_EACH_SAFE( mob, mob_next, &room->characters, CHAR_DATA, room_node ) {
-		if ( !IS_NPC( mob ) )
-			continue;
-		if ( mob == ch )
-			continue;
-		if ( mob->pIndexData == NULL )
-			continue;
-
-		LIST_FOR_EACH( script, &mob->pIndexData->scripts, SCRIPT_DATA, node ) {
-			if ( !IS_SET( script->trigger, TRIG_SPEECH ) )
-				continue;
-			if ( !script_pattern_match( script, text ) )
-				continue;
-			if ( !script_chance_check( script ) )
-				continue;
-
-			script_run( script, "on_speech", mob, ch, text );
-		}
-	}
+	script_dispatch_room_mobs( ch, ch->in_room, TS_SPEECH, TRIG_SPEECH,
+		"speech", "on_speech", text );
 }
 
 
@@ -137,23 +320,32 @@ void script_trigger_speech( CHAR_DATA *ch, const char *text ) {
  * scripts as "say <keyword>" would for that specific mob.
  */
 void script_trigger_speech_one( CHAR_DATA *speaker, CHAR_DATA *target, const char *text ) {
+	TRIGGER_STAT *ts = &trig_stats[TS_SPEECH];
 	SCRIPT_DATA *script;
 
 	if ( speaker == NULL || target == NULL || text == NULL || text[0] == '\0' )
 		return;
 	if ( IS_NPC( speaker ) || !IS_NPC( target ) )
 		return;
-	if ( target->pIndexData == NULL )
+	if ( target->pIndexData == NULL || target->pIndexData->script_trigs == 0 )
+		return;
+
+	ts->visits++;
+	script_signal_event( target, "speech", speaker, text );
+
+	if ( !IS_SET( target->pIndexData->script_trigs, TRIG_SPEECH ) )
 		return;
 
 	LIST_FOR_EACH( script, &target->pIndexData->scripts, SCRIPT_DATA, node ) {
 		if ( !IS_SET( script->trigger, TRIG_SPEECH ) )
 			continue;
+		ts->evals++;
 		if ( !script_pattern_match( script, text ) )
 			continue;
 		if ( !script_chance_check( script ) )
 			continue;
 
+		ts->fires++;
 		script_run( script, "on_speech", target, speaker, text );
 	}
 }
@@ -169,32 +361,64 @@ void script_trigger_speech_one( CHAR_DATA *speaker, CHAR_DATA *target, const cha
  * Called from mobile_update() in update.c.
  */
 bool script_trigger_tick( CHAR_DATA *ch ) {
+	TRIGGER_STAT *ts = &trig_stats[TS_TICK];
 	SCRIPT_DATA *script;
 
 	if ( ch == NULL || ch->pIndexData == NULL )
 		return FALSE;
 
-	if ( !ch->pIndexData->has_tick_scripts )
+	if ( !IS_SET( ch->pIndexData->script_trigs, TRIG_TICK ) )
 		return FALSE;
 
-	PROFILE_START( "script_tick" );
+	PROFILE_START( PROF_SCRIPT_TICK );
+	ts->visits++;
 	LIST_FOR_EACH( script, &ch->pIndexData->scripts, SCRIPT_DATA, node ) {
 		if ( !IS_SET( script->trigger, TRIG_TICK ) )
 			continue;
+		ts->evals++;
 		if ( !script_chance_check( script ) )
 			continue;
 
+		ts->fires++;
 		if ( script_run_tick( script, ch ) ) {
-			PROFILE_END( "script_tick" );
+			PROFILE_END( PROF_SCRIPT_TICK );
 			return TRUE;
 		}
 	}
 
-	PROFILE_END( "script_tick" );
+	PROFILE_END( PROF_SCRIPT_TICK );
 	return FALSE;
 }
 
 
+/*
+ * Fire a room's own scripts for one trigger type.
+ */
+static void script_dispatch_room( CHAR_DATA *ch, ROOM_INDEX_DATA *room,
+	int which, uint32_t trig, const char *func, const char *text,
+	bool match_text ) {
+	TRIGGER_STAT *ts = &trig_stats[which];
+	SCRIPT_DATA *script;
+
+	if ( room->extras == NULL || list_empty( &room->extras->scripts ) )
+		return;
+
+	ts->visits++;
+	LIST_FOR_EACH( script, room_scripts( room ), SCRIPT_DATA, node ) {
+		if ( !IS_SET( script->trigger, trig ) )
+			continue;
+		ts->evals++;
+		if ( match_text && !script_pattern_match( script, text ) )
+			continue;
+		if ( !script_chance_check( script ) )
+			continue;
+
+		ts->fires++;
+		script_run_room( script, func, ch, room, text );
+	}
+}
+
+
 /*
  * TRIG_GREET on rooms — fired when a player enters a room.
  * Iterates the room's own scripts (not mob scripts).
@@ -202,22 +426,15 @@ bool script_trigger_tick( CHAR_DATA *ch ) {
  * Lua callback: on_enter(ch, room)
  */
 void script_trigger_room_enter( CHAR_DATA *ch, ROOM_INDEX_DATA *room ) {
-	SCRIPT_DATA *script;
-
 	if ( ch == NULL || room == NULL )
 		return;
 
 	if ( IS_NPC( ch ) )
 		return;
 
-	LIST_FOR_EACH( script, room_scripts( room ), SCRIPT_DATA, node ) {
-		if ( !IS_SET( script->trigger, TRIG_GREET ) )
-			continue;
-		if ( !script_chance_check( script ) )
-			continue;
-
-		script_run_room( script, "on_enter", ch, room, NULL );
-	}
+	script_signal_event( room, "enter", ch, NULL );
+	script_dispatch_room( ch, room, TS_ROOM_ENTER, TRIG_GREET,
+		"on_enter", NULL, FALSE );
 }
 
 
@@ -228,7 +445,6 @@ void script_trigger_room_enter( CHAR_DATA *ch, ROOM_INDEX_DATA *room ) {
  * Lua callback: on_say(ch, room, text)
  */
 void script_trigger_room_speech( CHAR_DATA *ch, const char *text ) {
-	SCRIPT_DATA *script;
 	ROOM_INDEX_DATA *room;
 
 	if ( ch == NULL || text == NULL || text[0] == '\0' )
@@ -241,16 +457,9 @@ void script_trigger_room_speech( CHAR_DATA *ch, const char *text ) {
 	if ( room == NULL )
 		return;
 
-	LIST_FOR_EACH( script, room_scripts( room ), SCRIPT_DATA, node ) {
-		if ( !IS_SET( script->trigger, TRIG_SPEECH ) )
-			continue;
-		if ( !script_pattern_match( script, text ) )
-			continue;
-		if ( !script_chance_check( script ) )
-			continue;
-
-		script_run_room( script, "on_say", ch, room, text );
-	}
+	script_signal_event( room, "say", ch, text );
+	script_dispatch_room( ch, room, TS_ROOM_SAY, TRIG_SPEECH,
+		"on_say", text, TRUE );
 }
 
 
@@ -261,7 +470,6 @@ void script_trigger_room_speech( CHAR_DATA *ch, const char *text ) {
  * Lua callback: on_examine(ch, room, keyword)
  */
 void script_trigger_room_examine( CHAR_DATA *ch, const char *keyword ) {
-	SCRIPT_DATA *script;
 	ROOM_INDEX_DATA *room;
 
 	if ( ch == NULL || keyword == NULL || keyword[0] == '\0' )
@@ -274,53 +482,56 @@ void script_trigger_room_examine( CHAR_DATA *ch, const char *keyword ) {
 	if ( room == NULL )
 		return;
 
-	LIST_FOR_EACH( script, room_scripts( room ), SCRIPT_DATA, node ) {
-		if ( !IS_SET( script->trigger, TRIG_EXAMINE ) )
-			continue;
-		if ( !script_pattern_match( script, keyword ) )
-			continue;
-		if ( !script_chance_check( script ) )
-			continue;
-
-		script_run_room( script, "on_examine", ch, room, keyword );
-	}
+	script_signal_event( room, "examine", ch, keyword );
+	script_dispatch_room( ch, room, TS_ROOM_EXAMINE, TRIG_EXAMINE,
+		"on_examine", keyword, TRUE );
 }
 
 
 /*
  * TRIG_TICK on objects — fired periodically for carried/worn objects.
- * Iterates all objects in the game, fires TRIG_TICK scripts on objects
- * that are carried by a character.
+ * Walks only the carried objects subscribed to TRIG_TICK.
  *
  * Lua callback: on_tick(obj)
  *
  * Called from update_handler() on the pulse_point cycle.
  */
 void script_trigger_obj_tick( void ) {
+	TRIGGER_STAT *ts = &trig_stats[TS_OBJ_TICK];
+	list_head_t *head = tick_objs();
+	list_node_t *pos;
+	list_node_t *cur;
+	list_node_t *next;
 	OBJ_DATA *obj;
-	OBJ_DATA *obj_next;
 	SCRIPT_DATA *script;
-	CHAR_DATA *carrier;
 
-	LIST_FOR_EACH_SAFE( obj, obj_next, &g_objects, OBJ_DATA, obj_node ) {
-		if ( obj->pIndexData == NULL )
-			continue;
-		if ( list_empty( &obj->pIndexData->scripts ) )
-			continue;
+	if ( list_empty( head ) )
+		return;
 
-		carrier = obj->carried_by;
-		if ( carrier == NULL )
+	if ( !sub_cursor_push( &cur, &next ) )
+		return;
+	for ( pos = head->sentinel.next; pos != &head->sentinel; pos = next ) {
+		cur = pos;
+		next = pos->next;
+		obj = LIST_ENTRY( pos, OBJ_DATA, script_node );
+		if ( obj->carried_by == NULL )
 			continue;
 
+		ts->visits++;
 		LIST_FOR_EACH( script, &obj->pIndexData->scripts, SCRIPT_DATA, node ) {
 			if ( !IS_SET( script->trigger, TRIG_TICK ) )
 				continue;
+			ts->evals++;
 			if ( !script_chance_check( script ) )
 				continue;
 
-			script_run_obj( script, "on_tick", obj, carrier, NULL );
+			ts->fires++;
+			script_run_obj( script, "on_tick", obj, obj->carried_by, NULL );
+			if ( cur != pos )
+				break;
 		}
 	}
+	sub_cursor_pop();
 }
 
 
@@ -334,6 +545,7 @@ void script_trigger_obj_tick( void ) {
  * Called from fight.c when a player kills an NPC.
  */
 void script_trigger_obj_kill( CHAR_DATA *ch, CHAR_DATA *victim ) {
+	TRIGGER_STAT *ts = &trig_stats[TS_OBJ_KILL];
 	OBJ_DATA *obj;
 	OBJ_DATA *obj_next;
 	SCRIPT_DATA *script;
@@ -342,17 +554,23 @@ void script_trigger_obj_kill( CHAR_DATA *ch, CHAR_DATA *victim ) {
 		return;
 
 	LIST_FOR_EACH_SAFE( obj, obj_next, &ch->carrying, OBJ_DATA, content_node ) {
-		if ( obj->pIndexData == NULL )
+		if ( obj->pIndexData == NULL || obj->pIndexData->script_trigs == 0 )
 			continue;
-		if ( list_empty( &obj->pIndexData->scripts ) )
+
+		ts->visits++;
+		script_signal_event( obj, "kill", victim, NULL );
+
+		if ( !IS_SET( obj->pIndexData->script_trigs, TRIG_KILL ) )
 			continue;
 
 		LIST_FOR_EACH( script, &obj->pIndexData->scripts, SCRIPT_DATA, node ) {
 			if ( !IS_SET( script->trigger, TRIG_KILL ) )
 				continue;
+			ts->evals++;
 			if ( !script_chance_check( script ) )
 				continue;
 
+			ts->fires++;
 			script_run_obj( script, "on_kill", obj, ch, victim );
 		}
 	}
@@ -369,6 +587,7 @@ void script_trigger_obj_kill( CHAR_DATA *ch, CHAR_DATA *victim ) {
  * Called from fight.c after raw_kill() and autoloot/autosac.
  */
 void script_trigger_mob_death( CHAR_DATA *killer, MOB_INDEX_DATA *victim_idx ) {
+	TRIGGER_STAT *ts = &trig_stats[TS_DEATH];
 	SCRIPT_DATA *script;
 	int area_low = 0;
 	int area_high = 0;
@@ -379,18 +598,55 @@ void script_trigger_mob_death( CHAR_DATA *killer, MOB_INDEX_DATA *victim_idx ) {
 	if ( IS_NPC( killer ) )
 		return;
 
+	if ( !IS_SET( victim_idx->script_trigs, TRIG_DEATH ) )
+		return;
+
 	if ( victim_idx->area != NULL ) {
 		area_low  = victim_idx->area->lvnum;
 		area_high = victim_idx->area->uvnum;
 	}
 
+	ts->visits++;
 	LIST_FOR_EACH( script, &victim_idx->scripts, SCRIPT_DATA, node ) {
 		if ( !IS_SET( script->trigger, TRIG_DEATH ) )
 			continue;
+		ts->evals++;
 		if ( !script_chance_check( script ) )
 			continue;
 
+		ts->fires++;
 		script_run_death( script, "on_death", killer,
 			victim_idx->vnum, area_low, area_high );
 	}
 }
+
+
+/* Totals across all trigger types */
+void script_trigger_totals( long *evals, long *fires ) {
+	int i;
+
+	*evals = 0;
+	*fires = 0;
+	for ( i = 0; i < TS_MAX; i++ ) {
+		*evals += trig_stats[i].evals;
+		*fires += trig_stats[i].fires;
+	}
+}
+
+
+/* Per-trigger dispatch table for "profile scripts" */
+void script_trigger_report( CHAR_DATA *ch ) {
+	char buf[MAX_STRING_LENGTH];
+	int i;
+
+	snprintf( buf, sizeof( buf ), "\n\r#C=== Trigger Dispatch ===#n  (%d carried tick objects)\n\r",
+		list_count( tick_objs() ) );
+	send_to_char( buf, ch );
+	send_to_char( "#CTrigger          Visits      Evals      Fires#n\n\r", ch );
+	for ( i = 0; i < TS_MAX; i++ ) {
+		snprintf( buf, sizeof( buf ), "%-14s %8ld %10ld %10ld\n\r",
+			trig_stats[i].name, trig_stats[i].visits,
+			trig_stats[i].evals, trig_stats[i].fires );
+		send_to_char( buf, ch );
+	}
+}
@@ -74,9 +74,6 @@ const char *szFinishPrompt = "(" BOLD "C" NO_COLOR ")ontinue, (" BOLD "V" NO_COL
 
 long last_note_stamp = 0; /* To generate unique timestamps on notes */
 
-#define BOARD_NOACCESS -1
-#define BOARD_NOTFOUND -1
-
 static bool next_board( CHAR_DATA *ch );
 int board_number( const BOARD_DATA *board );
 
@@ -136,6 +133,7 @@ void free_note( NOTE_DATA *note ) {
 		free(note->date);
 	if ( note->text )
 		free(note->text);
+	free( note->to_ids );
 
 	free( note );
 }
@@ -164,7 +162,7 @@ void finish_note( BOARD_DATA *board, NOTE_DATA *note ) {
 		last_note_stamp = (long) current_time;
 	}
 
-	list_push_back( &board->notes, &note->node );
+	board_append_note( board, note );
 
 	/* Persist note to SQLite */
 	db_game_append_note( board_number( board ), note );
@@ -195,6 +193,7 @@ int board_lookup( const char *name ) {
 /* Remove note from the list. Do not free note */
 static void unlink_note( BOARD_DATA *board, NOTE_DATA *note ) {
 	list_remove( &board->notes, &note->node );
+	board->remove_gen++; /* unread counts on this board are rebuilt */
 }
 
 /* Find the nth note on a board. Return NULL if ch has no access to that note */
@@ -257,52 +256,315 @@ void load_boards() {
 	}
 }
 
-/* Returns TRUE if the specified note is address to ch */
-bool is_note_to( CHAR_DATA *ch, NOTE_DATA *note ) {
-	if ( !str_cmp( ch->pcdata->switchname, note->sender ) )
-		return TRUE;
+/*
+ * Recipient names, interned case-folded so that matching a reader against
+ * a note is an integer compare.  The table only grows: it holds the words
+ * of every to_list, every sender and every reader's name.
+ */
+static char **note_names;	  /* id -> folded name                */
+static int note_name_count;
+static int *note_name_hash;	  /* id + 1, 0 = empty; open addressing */
+static int note_name_hash_size;
 
-	if ( is_full_name( "all", note->to_list ) )
-		return TRUE;
+static unsigned int note_name_hash_str( const char *name ) {
+	unsigned int h = 2166136261u;
 
-	if ( IS_IMMORTAL( ch ) && ( is_full_name( "imm", note->to_list ) || is_full_name( "imms", note->to_list ) || is_full_name( "immortal", note->to_list ) || is_full_name( "god", note->to_list ) || is_full_name( "gods", note->to_list ) || is_full_name( "immortals", note->to_list ) ) )
-		return TRUE;
+	for ( ; *name != '\0'; name++ ) {
+		h ^= (unsigned char) tolower( (unsigned char) *name );
+		h *= 16777619u;
+	}
+	return h;
+}
 
-	if ( ( get_trust( ch ) == MAX_LEVEL ) && ( is_full_name( "imp", note->to_list ) || is_full_name( "imps", note->to_list ) || is_full_name( "implementor", note->to_list ) || is_full_name( "implementors", note->to_list ) ) )
-		return TRUE;
+static bool note_name_eq( const char *folded, const char *name ) {
+	for ( ; *folded != '\0' || *name != '\0'; folded++, name++ )
+		if ( *folded != tolower( (unsigned char) *name ) )
+			return FALSE;
+	return TRUE;
+}
 
-	if ( is_full_name( ch->pcdata->switchname, note->to_list ) )
-		return TRUE;
+static void note_name_rehash( int size ) {
+	int i, h;
+
+	free( note_name_hash );
+	note_name_hash = calloc( size, sizeof( int ) );
+	if ( !note_name_hash ) {
+		bug( "note_name_rehash: calloc failed", 0 );
+		exit( 1 );
+	}
+	note_name_hash_size = size;
+	for ( i = 0; i < note_name_count; i++ ) {
+		h = note_name_hash_str( note_names[i] ) & ( size - 1 );
+		while ( note_name_hash[h] != 0 )
+			h = ( h + 1 ) & ( size - 1 );
+		note_name_hash[h] = i + 1;
+	}
+}
 
-	if ( ch->pcdata->kingdom != 0 ) {
-		if ( IS_IMMORTAL( ch ) ) return TRUE;
-		//	    if(is_full_name(king_table[ch->pcdata->kingdom].name, note->to_list) ) return TRUE;
+/* Id of a name; str_cmp-equal names share one.  -1 for NULL */
+int note_name_id( const char *name ) {
+	char *folded;
+	int h, i;
+
+	if ( name == NULL )
+		return -1;
+
+	if ( ( note_name_count + 1 ) * 2 > note_name_hash_size ) {
+		char **grown = realloc( note_names,
+			( note_name_hash_size ? note_name_hash_size : 256 ) * sizeof( char * ) );
+		if ( !grown ) {
+			bug( "note_name_id: realloc failed", 0 );
+			exit( 1 );
+		}
+		note_names = grown;
+		note_name_rehash( note_name_hash_size ? note_name_hash_size * 2 : 512 );
+	}
+
+	h = note_name_hash_str( name ) & ( note_name_hash_size - 1 );
+	for ( ; note_name_hash[h] != 0; h = ( h + 1 ) & ( note_name_hash_size - 1 ) )
+		if ( note_name_eq( note_names[note_name_hash[h] - 1], name ) )
+			return note_name_hash[h] - 1;
+
+	folded = str_dup( name );
+	for ( i = 0; folded[i] != '\0'; i++ )
+		folded[i] = tolower( (unsigned char) folded[i] );
+	note_names[note_name_count] = folded;
+	note_name_hash[h] = ++note_name_count;
+	return note_name_count - 1;
+}
+
+/* Fill in the recipient fields from sender and to_list */
+static void note_parse_recipients( NOTE_DATA *note ) {
+	char name[MAX_INPUT_LENGTH];
+	char *list = note->to_list;
+	int alloc = 0, id;
+
+	free( note->to_ids );
+	note->to_ids = NULL;
+	note->to_count = 0;
+	note->to_flags = 0;
+	note->to_level = 0;
+	note->sender_id = note_name_id( note->sender );
+
+	if ( list == NULL )
+		return;
+
+	/* Same words is_full_name() would see */
+	for ( ;; ) {
+		list = one_argument( list, name );
+		if ( name[0] == '\0' )
+			break;
+
+		if ( note->to_count >= alloc ) {
+			int *grown;
+			alloc = alloc ? alloc * 2 : 4;
+			grown = realloc( note->to_ids, alloc * sizeof( int ) );
+			if ( !grown ) {
+				bug( "note_parse_recipients: realloc failed", 0 );
+				exit( 1 );
+			}
+			note->to_ids = grown;
+		}
+		id = note_name_id( name );
+		note->to_ids[note->to_count++] = id;
+
+		if ( !str_cmp( name, "all" ) )
+			note->to_flags |= NOTE_TO_ALL;
+		else if ( !str_cmp( name, "imm" ) || !str_cmp( name, "imms" )
+			|| !str_cmp( name, "immortal" ) || !str_cmp( name, "immortals" )
+			|| !str_cmp( name, "god" ) || !str_cmp( name, "gods" ) )
+			note->to_flags |= NOTE_TO_IMM;
+		else if ( !str_cmp( name, "imp" ) || !str_cmp( name, "imps" )
+			|| !str_cmp( name, "implementor" ) || !str_cmp( name, "implementors" ) )
+			note->to_flags |= NOTE_TO_IMP;
 	}
 
 	/* Allow a note to e.g. 40 to send to characters level 40 and above */
-	if ( is_number( note->to_list ) && get_trust( ch ) >= atoi( note->to_list ) )
-		return TRUE;
+	if ( is_number( note->to_list ) ) {
+		note->to_flags |= NOTE_TO_LEVEL;
+		note->to_level = atoi( note->to_list );
+	}
+}
 
+/* Link a note onto the end of a board without saving it */
+void board_append_note( BOARD_DATA *board, NOTE_DATA *note ) {
+	list_node_t *last = list_last( &board->notes );
+
+	note_parse_recipients( note );
+	note->seq = ++board->note_seq;
+
+	/*
+	 * Unread counts rely on date_stamp rising along the board.  Notes
+	 * from finish_note() always do; anything else forces a recount.
+	 */
+	if ( last != NULL && LIST_ENTRY( last, NOTE_DATA, node )->date_stamp >= note->date_stamp )
+		board->remove_gen++;
+	if ( note->date_stamp > last_note_stamp )
+		last_note_stamp = (long) note->date_stamp;
+
+	list_push_back( &board->notes, &note->node );
+}
+
+/* Who is reading, as far as note addressing goes */
+#define READER_IMM		1 /* IS_IMMORTAL                            */
+#define READER_KINGDOM	2 /* Immortal in a kingdom: reads everything */
+
+typedef struct note_reader {
+	int name_id;
+	int trust;
+	int flags;
+} NOTE_READER;
+
+static void note_reader_init( CHAR_DATA *ch, NOTE_READER *r ) {
+	r->name_id = note_name_id( ch->pcdata->switchname );
+	r->trust = get_trust( ch );
+	r->flags = 0;
+	if ( IS_IMMORTAL( ch ) ) {
+		r->flags |= READER_IMM;
+		if ( ch->pcdata->kingdom != 0 )
+			r->flags |= READER_KINGDOM;
+	}
+}
+
+static bool note_to_reader( const NOTE_READER *r, const NOTE_DATA *note ) {
+	int i;
+
+	if ( r->name_id >= 0 && r->name_id == note->sender_id )
+		return TRUE;
+	if ( note->to_flags & NOTE_TO_ALL )
+		return TRUE;
+	if ( ( r->flags & READER_IMM ) && ( note->to_flags & NOTE_TO_IMM ) )
+		return TRUE;
+	if ( r->trust == MAX_LEVEL && ( note->to_flags & NOTE_TO_IMP ) )
+		return TRUE;
+	if ( r->name_id >= 0 )
+		for ( i = 0; i < note->to_count; i++ )
+			if ( note->to_ids[i] == r->name_id )
+				return TRUE;
+	if ( r->flags & READER_KINGDOM )
+		return TRUE;
+	if ( ( note->to_flags & NOTE_TO_LEVEL ) && r->trust >= note->to_level )
+		return TRUE;
 	return FALSE;
 }
 
-/* Return the number of unread notes 'ch' has in 'board' */
-/* Returns BOARD_NOACCESS if ch has no access to board */
-int unread_notes( CHAR_DATA *ch, BOARD_DATA *board ) {
+/* Returns TRUE if the specified note is address to ch */
+bool is_note_to( CHAR_DATA *ch, NOTE_DATA *note ) {
+	NOTE_READER r;
+
+	note_reader_init( ch, &r );
+	return note_to_reader( &r, note );
+}
+
+static NOTE_DATA *note_after( BOARD_DATA *board, NOTE_DATA *note ) {
+	list_node_t *next = note->node.next;
+
+	return next == &board->notes.sentinel ? NULL : LIST_ENTRY( next, NOTE_DATA, node );
+}
+
+/* Count ch's unread notes on board from scratch */
+static void note_cursor_rebuild( BOARD_DATA *board, NOTE_CURSOR *c,
+	const NOTE_READER *r, time_t last_read ) {
 	NOTE_DATA *note;
-	time_t last_read;
-	int count = 0;
+	int num = 0;
 
-	if ( board->read_level > get_trust( ch ) )
-		return BOARD_NOACCESS;
+	c->first = NULL;
+	c->first_num = 0;
+	c->unread = 0;
+	LIST_FOR_EACH( note, &board->notes, NOTE_DATA, node ) {
+		num++;
+		if ( (long) last_read < (long) note->date_stamp && note_to_reader( r, note ) ) {
+			if ( c->first == NULL ) {
+				c->first = note;
+				c->first_num = num;
+			}
+			c->unread++;
+		}
+	}
 
-	last_read = ch->pcdata->last_note[board_number( board )];
+	c->last_read = last_read;
+	c->seq = board->note_seq;
+	c->remove_gen = board->remove_gen;
+	c->name_id = r->name_id;
+	c->trust = r->trust;
+	c->reader_flags = r->flags;
+	c->valid = TRUE;
+}
 
-	LIST_FOR_EACH( note, &board->notes, NOTE_DATA, node )
-		if ( is_note_to( ch, note ) && ( (long) last_read < (long) note->date_stamp ) )
-			count++;
+/* Bring ch's unread count for board up to date and return it */
+static NOTE_CURSOR *note_cursor( CHAR_DATA *ch, BOARD_DATA *board ) {
+	NOTE_CURSOR *c = &ch->pcdata->note_cursor[board_number( board )];
+	time_t last_read = ch->pcdata->last_note[board_number( board )];
+	NOTE_READER r;
+	NOTE_DATA *note;
+	int num;
+
+	note_reader_init( ch, &r );
+	if ( !c->valid || c->remove_gen != board->remove_gen
+		|| c->name_id != r.name_id || c->trust != r.trust
+		|| c->reader_flags != r.flags || last_read < c->last_read ) {
+		note_cursor_rebuild( board, c, &r, last_read );
+		return c;
+	}
 
-	return count;
+	/* Notes posted since: they are all at the end */
+	if ( c->seq != board->note_seq ) {
+		NOTE_DATA *start = NULL;
+		int start_num = 0;
+
+		num = list_count( &board->notes );
+		LIST_FOR_EACH_REVERSE( note, &board->notes, NOTE_DATA, node ) {
+			if ( note->seq <= c->seq )
+				break;
+			start = note;
+			start_num = num--;
+		}
+		for ( note = start, num = start_num; note != NULL; note = note_after( board, note ), num++ ) {
+			if ( (long) c->last_read < (long) note->date_stamp && note_to_reader( &r, note ) ) {
+				if ( c->first == NULL ) {
+					c->first = note;
+					c->first_num = num;
+				}
+				c->unread++;
+			}
+		}
+		c->seq = board->note_seq;
+	}
+
+	/* last_note[] moved on: step the cursor past what is now read */
+	if ( last_read > c->last_read ) {
+		note = c->first;
+		num = c->first_num;
+		while ( note != NULL && (long) note->date_stamp <= (long) last_read ) {
+			if ( note_to_reader( &r, note ) )
+				c->unread--;
+			note = note_after( board, note );
+			num++;
+		}
+		while ( note != NULL && !note_to_reader( &r, note ) ) {
+			note = note_after( board, note );
+			num++;
+		}
+		c->first = note;
+		c->first_num = note != NULL ? num : 0;
+		c->last_read = last_read;
+	}
+
+	return c;
+}
+
+/* Can ch see this board at all? */
+static bool board_readable( CHAR_DATA *ch, BOARD_DATA *board ) {
+	return board->read_level <= get_trust( ch );
+}
+
+/* Return the number of unread notes 'ch' has in 'board' */
+/* Returns BOARD_NOACCESS if ch has no access to board */
+int unread_notes( CHAR_DATA *ch, BOARD_DATA *board ) {
+	if ( !board_readable( ch, board ) )
+		return BOARD_NOACCESS;
+
+	return note_cursor( ch, board )->unread;
 }
 
 /*
@@ -438,8 +700,8 @@ static void do_nread( CHAR_DATA *ch, char *argument ) {
 	} else /* just next one */
 	{
 		char buf[200];
+		NOTE_CURSOR *c;
 
-		count = 1;
 		if ( ch->pcdata->board == NULL ) {
 			send_to_char( "You are not on a board.\n\r", ch );
 			return;
@@ -449,15 +711,12 @@ static void do_nread( CHAR_DATA *ch, char *argument ) {
 			return;
 		}
 
-		LIST_FOR_EACH( p, &ch->pcdata->board->notes, NOTE_DATA, node ) {
-			if ( ( p->date_stamp > *last_note ) && is_note_to( ch, p ) ) {
-				show_note_to_char( ch, p, count );
-				/* Advance if new note is newer than the currently newest for that char */
-				if ( p->date_stamp > *last_note )
-					*last_note = p->date_stamp;
-				return;
-			}
-			count++;
+		/* The first unread note to ch, kept up to date for unread_notes() */
+		c = note_cursor( ch, ch->pcdata->board );
+		if ( c->first != NULL ) {
+			show_note_to_char( ch, c->first, c->first_num );
+			*last_note = c->first->date_stamp;
+			return;
 		}
 
 		send_to_char( "No new notes in this board.\n\r", ch );
@@ -636,7 +895,7 @@ void do_board( CHAR_DATA *ch, char *argument ) {
 		count = 0;
 		number = atoi( argument );
 		for ( i = 0; i < MAX_BOARD; i++ )
-			if ( unread_notes( ch, &boards[i] ) != BOARD_NOACCESS )
+			if ( board_readable( ch, &boards[i] ) )
 				if ( ++count == number )
 					break;
 
@@ -667,7 +926,7 @@ void do_board( CHAR_DATA *ch, char *argument ) {
 	}
 
 	/* Does ch have access to this board? */
-	if ( unread_notes( ch, &boards[i] ) == BOARD_NOACCESS ) {
+	if ( !board_readable( ch, &boards[i] ) ) {
 		send_to_char( "No such board.\n\r", ch );
 		return;
 	}
@@ -725,7 +984,7 @@ void make_note( const char *board_name, const char *sender, const char *to, cons
 static bool next_board( CHAR_DATA *ch ) {
 	int i = board_number( ch->pcdata->board ) + 1;
 
-	while ( ( i < MAX_BOARD ) && ( unread_notes( ch, &boards[i] ) == BOARD_NOACCESS ) )
+	while ( ( i < MAX_BOARD ) && !board_readable( ch, &boards[i] ) )
 		i++;
 
 	if ( i == MAX_BOARD )
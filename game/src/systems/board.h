@@ -22,6 +22,33 @@
 #define MAX_NOTE_TEXT ( 4 * MAX_STRING_LENGTH - 1000 )
 
 #define BOARD_NOTFOUND -1 /* Error code from board_lookup() and board_number */
+#define BOARD_NOACCESS -1 /* From unread_notes() */
+
+/* Recipient classes found in a note's to_list (note->to_flags) */
+#define NOTE_TO_ALL	  1 /* "all"                                        */
+#define NOTE_TO_IMM	  2 /* "imm", "imms", "immortal(s)", "god(s)"        */
+#define NOTE_TO_IMP	  4 /* "imp", "imps", "implementor(s)"               */
+#define NOTE_TO_LEVEL 8 /* to_list is a number: that trust and above     */
+
+/*
+ * What one character has left to read on one board.  unread_notes()
+ * brings it up to date from what changed since: notes posted after
+ * 'seq' are counted in, and a last_note[] that moved past 'last_read'
+ * walks 'first' forward.  A removed note, or a change in who the
+ * character is as a reader, rebuilds it from the board.
+ */
+typedef struct note_cursor {
+	NOTE_DATA *first;		 /* First unread note to ch, NULL if none   */
+	int first_num;			 /* Its number on the board, from 1         */
+	int unread;
+	time_t last_read;		 /* last_note[] these were counted against  */
+	unsigned int seq;		 /* board->note_seq at that time            */
+	unsigned int remove_gen; /* board->remove_gen at that time          */
+	int name_id;			 /* Reader, as of the count                 */
+	int trust;
+	int reader_flags;
+	bool valid;
+} NOTE_CURSOR;
 
 /* Data about a board */
 struct board_data {
@@ -40,6 +67,8 @@ struct board_data {
 
 	list_head_t notes;     /* board's note list */
 	bool changed;		   /* currently unused */
+	unsigned int note_seq;	 /* seq of the newest note                   */
+	unsigned int remove_gen; /* bumped whenever a note leaves the board */
 };
 
 typedef struct board_data BOARD_DATA;
@@ -55,6 +84,9 @@ void free_note( NOTE_DATA *note );						/* deallocate memory used by a note */
 void load_boards( void );								/* load all boards */
 int board_lookup( const char *name );					/* Find a board with that name */
 bool is_note_to( CHAR_DATA *ch, NOTE_DATA *note );		/* is tha note to ch? */
+int unread_notes( CHAR_DATA *ch, BOARD_DATA *board );	/* BOARD_NOACCESS if unreadable */
+void board_append_note( BOARD_DATA *board, NOTE_DATA *note ); /* link, no save */
+int note_name_id( const char *name );					/* interned, case-folded */
 void personal_message( const char *sender, const char *to, const char *subject, const int expire_days, const char *text );
 void make_note( const char *board_name, const char *sender, const char *to, const char *subject, const int expire_days, const char *text );
 void save_notes();
@@ -0,0 +1,290 @@
+/*
+ * capture.c - Input capture for load-test replays
+ *
+ * See capture.h for the file layout.  Writes go through stdio and are
+ * flushed once a second, so a crash loses at most the last second.
+ */
+
+#include "merc.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include "capture.h"
+
+static FILE *capture_fp;
+static char capture_file[MUD_PATH_MAX];
+static uint32_t capture_pulses;		/* Pulses since capture_start() */
+static uint32_t capture_sessions;	/* Last session number handed out */
+static uint32_t capture_lines;
+static struct timeval capture_began;
+static DESCRIPTOR_DATA *capture_pending;
+
+static void put_u16( unsigned char *p, uint32_t v ) {
+	p[0] = (unsigned char) v;
+	p[1] = (unsigned char) ( v >> 8 );
+}
+
+static void put_u32( unsigned char *p, uint32_t v ) {
+	put_u16( p, v );
+	put_u16( p + 2, v >> 16 );
+}
+
+static uint32_t get_u16( const unsigned char *p ) {
+	return (uint32_t) p[0] | ( (uint32_t) p[1] << 8 );
+}
+
+static uint32_t get_u32( const unsigned char *p ) {
+	return get_u16( p ) | ( get_u16( p + 2 ) << 16 );
+}
+
+static uint32_t capture_msec( void ) {
+	struct timeval now;
+
+	gettimeofday( &now, NULL );
+	return (uint32_t) ( ( now.tv_sec - capture_began.tv_sec ) * 1000
+		+ ( now.tv_usec - capture_began.tv_usec ) / 1000 );
+}
+
+static void capture_write( uint32_t session, int type, const void *data, int len ) {
+	unsigned char head[16];
+
+	put_u32( head, capture_pulses );
+	put_u32( head + 4, capture_msec() );
+	put_u32( head + 8, session );
+	put_u16( head + 12, (uint32_t) type );
+	put_u16( head + 14, (uint32_t) len );
+	if ( fwrite( head, sizeof( head ), 1, capture_fp ) != 1
+		|| ( len > 0 && fwrite( data, len, 1, capture_fp ) != 1 ) ) {
+		bug( "capture_write: write failed, capture stopped", 0 );
+		capture_stop();
+	}
+}
+
+/* Give d a session, recording who is playing it and where they stand */
+static void capture_open( DESCRIPTOR_DATA *d ) {
+	CHAR_DATA *ch = d->original ? d->original : d->character;
+	unsigned char data[6 + MAX_INPUT_LENGTH];
+	int len;
+
+	d->capture_id = (int) ++capture_sessions;
+	put_u32( data, ch->in_room ? (uint32_t) ch->in_room->vnum : 0 );
+	put_u16( data + 4, (uint32_t) ch->level );
+	len = UMIN( (int) strlen( ch->name ), MAX_INPUT_LENGTH );
+	memcpy( data + 6, ch->name, len );
+	capture_write( (uint32_t) d->capture_id, CAPTURE_OPEN, data, 6 + len );
+}
+
+bool capture_start( const char *filename ) {
+	DESCRIPTOR_DATA *d;
+	unsigned char head[24];
+
+	if ( capture_fp != NULL )
+		return FALSE;
+
+	snprintf( capture_file, sizeof( capture_file ), "%s", mud_path( mud_log_dir, filename ) );
+	if ( ( capture_fp = fopen( capture_file, "wb" ) ) == NULL )
+		return FALSE;
+
+	gettimeofday( &capture_began, NULL );
+	capture_pulses = 0;
+	capture_sessions = 0;
+	capture_lines = 0;
+	capture_pending = NULL;
+
+	memcpy( head, CAPTURE_MAGIC, 8 );
+	put_u32( head + 8, CAPTURE_VERSION );
+	put_u32( head + 12, PULSE_PER_SECOND );
+	put_u32( head + 16, (uint32_t) capture_began.tv_sec );
+	put_u32( head + 20, (uint32_t) ( (uint64_t) capture_began.tv_sec >> 32 ) );
+	if ( fwrite( head, sizeof( head ), 1, capture_fp ) != 1 ) {
+		fclose( capture_fp );
+		capture_fp = NULL;
+		return FALSE;
+	}
+
+	/* Everyone already playing starts out in the file */
+	LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node ) {
+		d->capture_id = 0;
+		if ( d->connected == CON_PLAYING && d->character != NULL )
+			capture_open( d );
+	}
+
+	snprintf( log_buf, MAX_STRING_LENGTH, "Input capture started: %s", capture_file );
+	log_string( log_buf );
+	return TRUE;
+}
+
+void capture_stop( void ) {
+	DESCRIPTOR_DATA *d;
+	FILE *fp = capture_fp;
+
+	if ( fp == NULL )
+		return;
+
+	capture_fp = NULL;
+	capture_pending = NULL;
+	LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node )
+		d->capture_id = 0;
+
+	if ( fclose( fp ) != 0 )
+		bug( "capture_stop: close failed", 0 );
+	snprintf( log_buf, MAX_STRING_LENGTH,
+		"Input capture stopped: %u lines over %u pulses, %u sessions.",
+		capture_lines, capture_pulses, capture_sessions );
+	log_string( log_buf );
+}
+
+bool capture_active( void ) {
+	return capture_fp != NULL;
+}
+
+void capture_pulse( void ) {
+	if ( capture_fp == NULL )
+		return;
+
+	capture_pending = NULL;
+	if ( ++capture_pulses % PULSE_PER_SECOND == 0 )
+		fflush( capture_fp );
+}
+
+void capture_expect( DESCRIPTOR_DATA *d ) {
+	if ( capture_fp != NULL )
+		capture_pending = d;
+}
+
+/*
+ * Called first thing in interpret().  TRUE when this call carries the line
+ * ch's player just typed.  The expectation is used up either way, so a
+ * force or order later in the pulse is never taken for the player's own,
+ * even when interpret() turned the typed line away before recording it.
+ */
+bool capture_claim( CHAR_DATA *ch ) {
+	DESCRIPTOR_DATA *d = capture_pending;
+
+	capture_pending = NULL;
+	return d != NULL && ch != NULL && ch->desc == d;
+}
+
+/* interpret() reports the line of a call capture_claim() said was typed */
+void capture_command( CHAR_DATA *ch, const char *line ) {
+	DESCRIPTOR_DATA *d = ch->desc;
+
+	if ( capture_fp == NULL || d == NULL )
+		return;
+
+	if ( d->capture_id == 0 )
+		capture_open( d );
+	if ( capture_fp == NULL )
+		return;
+	capture_write( (uint32_t) d->capture_id, CAPTURE_LINE, line,
+		UMIN( (int) strlen( line ), MAX_INPUT_LENGTH - 1 ) );
+	capture_lines++;
+}
+
+void capture_close( DESCRIPTOR_DATA *d ) {
+	if ( d == capture_pending )
+		capture_pending = NULL;
+	if ( capture_fp == NULL || d->capture_id == 0 )
+		return;
+
+	capture_write( (uint32_t) d->capture_id, CAPTURE_CLOSE, NULL, 0 );
+	d->capture_id = 0;
+}
+
+bool capture_read_header( FILE *fp, int *pulse_per_second, uint64_t *start ) {
+	unsigned char head[24];
+
+	if ( fread( head, sizeof( head ), 1, fp ) != 1 )
+		return FALSE;
+	if ( memcmp( head, CAPTURE_MAGIC, 8 ) != 0 || get_u32( head + 8 ) != CAPTURE_VERSION )
+		return FALSE;
+
+	*pulse_per_second = (int) get_u32( head + 12 );
+	*start = (uint64_t) get_u32( head + 16 ) | ( (uint64_t) get_u32( head + 20 ) << 32 );
+	return TRUE;
+}
+
+bool capture_read( FILE *fp, CAPTURE_RECORD *rec ) {
+	unsigned char head[16];
+	int len;
+
+	if ( fread( head, sizeof( head ), 1, fp ) != 1 )
+		return FALSE;
+
+	rec->pulse = get_u32( head );
+	rec->msec = get_u32( head + 4 );
+	rec->session = get_u32( head + 8 );
+	rec->type = (int) get_u16( head + 12 );
+	len = (int) get_u16( head + 14 );
+	if ( len >= (int) sizeof( rec->data ) )
+		return FALSE;
+	if ( len > 0 && fread( rec->data, len, 1, fp ) != 1 )
+		return FALSE;
+	rec->data[len] = '\0';
+	rec->len = len;
+	return TRUE;
+}
+
+/*
+ * Admin command: capture [start [file]|stop]
+ */
+void do_capture( CHAR_DATA *ch, char *argument ) {
+	char arg[MAX_INPUT_LENGTH];
+	char buf[MAX_STRING_LENGTH];
+	const char *p;
+
+	if ( IS_NPC( ch ) )
+		return;
+
+	argument = one_argument( argument, arg );
+
+	if ( !str_cmp( arg, "start" ) ) {
+		if ( capture_fp != NULL ) {
+			send_to_char( "Input is already being captured.\n\r", ch );
+			return;
+		}
+		if ( argument[0] == '\0' )
+			snprintf( arg, sizeof( arg ), "capture-%ld.bin", (long) current_time );
+		else
+			snprintf( arg, sizeof( arg ), "%s", argument );
+		/* A bare file name in the log directory */
+		for ( p = arg; *p != '\0'; p++ ) {
+			if ( !isalnum( (unsigned char) *p ) && *p != '-' && *p != '_' && *p != '.' )
+				break;
+		}
+		if ( *p != '\0' || arg[0] == '.' ) {
+			send_to_char( "File names may use only letters, digits, '-', '_' and '.'.\n\r", ch );
+			return;
+		}
+		if ( !capture_start( arg ) ) {
+			send_to_char( "Could not open the capture file.\n\r", ch );
+			return;
+		}
+		snprintf( buf, sizeof( buf ), "Capturing input to %s.\n\r", capture_file );
+		send_to_char( buf, ch );
+		snprintf( buf, sizeof( buf ), "%s started an input capture", ch->name );
+		log_string( buf );
+		return;
+	}
+
+	if ( !str_cmp( arg, "stop" ) ) {
+		if ( capture_fp == NULL ) {
+			send_to_char( "No capture is running.\n\r", ch );
+			return;
+		}
+		snprintf( buf, sizeof( buf ), "Stopped: %u lines over %u pulses from %u sessions in %s.\n\r",
+			capture_lines, capture_pulses, capture_sessions, capture_file );
+		capture_stop();
+		send_to_char( buf, ch );
+		return;
+	}
+
+	if ( capture_fp == NULL ) {
+		send_to_char( "No capture is running.  Syntax: capture start [file] | capture stop\n\r", ch );
+		return;
+	}
+	snprintf( buf, sizeof( buf ), "Capturing to %s: %u lines over %u pulses from %u sessions.\n\r",
+		capture_file, capture_lines, capture_pulses, capture_sessions );
+	send_to_char( buf, ch );
+}
@@ -0,0 +1,64 @@
+/*
+ * capture.h - Input capture for load-test replays
+ *
+ * "capture start" records every command players type, as interpret() sees
+ * it, to a binary file in the log directory; "capture stop" closes it.
+ * Each record carries the pulse it ran on (counted from the start of the
+ * capture), a millisecond timestamp and a session number standing for
+ * one descriptor, so the file can be fed back pulse for pulse against a
+ * headless build (game/tests: run_tests --replay <file>).
+ *
+ * Only interpret() input is recorded: logins, passwords, editors and
+ * pagers never reach it, and commands flagged LOG_NEVER are recorded by
+ * name without their arguments.
+ *
+ * File layout, all integers little endian:
+ *
+ *   header   "DYSCAPT1", u32 version, u32 pulses per second, u64 start time
+ *   record   u32 pulse, u32 msec, u32 session, u16 type, u16 length,
+ *            then length bytes of payload
+ *
+ *   CAPTURE_OPEN   u32 room vnum, u16 level, then the character's name
+ *   CAPTURE_LINE   the command line
+ *   CAPTURE_CLOSE  nothing; the descriptor was closed
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+
+#define CAPTURE_MAGIC   "DYSCAPT1"
+#define CAPTURE_VERSION 1
+
+enum {
+	CAPTURE_OPEN = 1,
+	CAPTURE_LINE,
+	CAPTURE_CLOSE
+};
+
+typedef struct capture_record {
+	uint32_t pulse;
+	uint32_t msec;
+	uint32_t session;
+	int type;
+	int len;
+	char data[MAX_INPUT_LENGTH + 64]; /* NUL terminated after len bytes */
+} CAPTURE_RECORD;
+
+/* Writing: the game loop side */
+bool capture_start( const char *filename );
+void capture_stop( void );
+bool capture_active( void );
+void capture_pulse( void );                  /* Once a pulse, from game_tick() */
+void capture_expect( DESCRIPTOR_DATA *d );   /* d's line goes to interpret() next */
+bool capture_claim( CHAR_DATA *ch );         /* Top of interpret(): is this d's line? */
+void capture_command( CHAR_DATA *ch, const char *line );
+void capture_close( DESCRIPTOR_DATA *d );
+
+/* Reading: returns FALSE on a bad header */
+bool capture_read_header( FILE *fp, int *pulse_per_second, uint64_t *start );
+/* Returns FALSE at the end of the file or on a short record */
+bool capture_read( FILE *fp, CAPTURE_RECORD *rec );
+
+#endif /* CAPTURE_H */
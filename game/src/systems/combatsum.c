@@ -0,0 +1,142 @@
+/*
+ * combatsum.c - Per-round combat summaries for onlookers
+ *
+ * See combatsum.h.  The hits of one violence_update() are summed per
+ * attacker and victim into a small array, searched from the newest end
+ * since multi_hit() lands its attacks back to back.
+ */
+
+#include "merc.h"
+#include <ctype.h>
+#include "combatsum.h"
+
+typedef struct combatsum_pair {
+	CHAR_DATA *ch;
+	CHAR_DATA *victim;
+	ROOM_INDEX_DATA *room;
+	int hits;
+	int misses;
+	int dam;
+} COMBATSUM_PAIR;
+
+static COMBATSUM_PAIR *sum_pairs;
+static int sum_count;
+static int sum_size;
+static bool sum_open;
+
+static long sum_stat_hits;	/* Hits dam_message() had for the onlookers  */
+static long sum_stat_acts;	/* ...that still went out through act()      */
+static long sum_stat_lines;	/* Summary lines sent                        */
+
+static bool combatsum_takes( CHAR_DATA *to ) {
+	return !IS_NPC( to ) && IS_EXTRA( to, EXTRA_COMBATSUM );
+}
+
+bool combatsum_wants( CHAR_DATA *to ) {
+	return sum_open && combatsum_takes( to );
+}
+
+void combatsum_begin( void ) {
+	sum_count = 0;
+	sum_open = TRUE;
+}
+
+static void combatsum_record( CHAR_DATA *ch, CHAR_DATA *victim, int dam ) {
+	COMBATSUM_PAIR *p;
+	int i;
+
+	for ( i = sum_count - 1; i >= 0; i-- ) {
+		p = &sum_pairs[i];
+		if ( p->ch == ch && p->victim == victim && p->room == ch->in_room )
+			break;
+	}
+	if ( i < 0 ) {
+		if ( sum_count == sum_size ) {
+			sum_size = sum_size ? sum_size * 2 : 32;
+			sum_pairs = realloc( sum_pairs, sum_size * sizeof( COMBATSUM_PAIR ) );
+			if ( !sum_pairs ) {
+				bug( "combatsum_record: realloc failed", 0 );
+				exit( 1 );
+			}
+		}
+		p = &sum_pairs[sum_count++];
+		memset( p, 0, sizeof( *p ) );
+		p->ch = ch;
+		p->victim = victim;
+		p->room = ch->in_room;
+	}
+
+	if ( dam > 0 ) {
+		p->hits++;
+		p->dam += dam;
+	} else
+		p->misses++;
+}
+
+bool combatsum_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dam ) {
+	CHAR_DATA *to;
+	bool each = FALSE, summed = FALSE;
+
+	sum_stat_hits++;
+	if ( !sum_open || ch->in_room == NULL || ch->in_room->vnum == ROOM_VNUM_IN_OBJECT ) {
+		sum_stat_acts++;
+		return TRUE;
+	}
+
+	LIST_FOR_EACH( to, &ch->in_room->characters, CHAR_DATA, room_node ) {
+		if ( to == ch || to == victim )
+			continue;
+		if ( combatsum_takes( to ) )
+			summed = TRUE;
+		else if ( to->desc != NULL || to->wizard != NULL )
+			each = TRUE;	/* A familiar may pass it on to its wizard */
+	}
+
+	if ( summed )
+		combatsum_record( ch, victim, dam );
+	if ( each )
+		sum_stat_acts++;
+	return each;
+}
+
+void combatsum_end( void ) {
+	char buf[MAX_STRING_LENGTH];
+	char miss[64];
+	COMBATSUM_PAIR *p;
+	CHAR_DATA *to;
+	int i;
+
+	sum_open = FALSE;
+	for ( i = 0; i < sum_count; i++ ) {
+		p = &sum_pairs[i];
+		miss[0] = '\0';
+		if ( p->hits > 0 && p->misses > 0 )
+			snprintf( miss, sizeof( miss ), ", missing %d", p->misses );
+
+		LIST_FOR_EACH( to, &p->room->characters, CHAR_DATA, room_node ) {
+			if ( to == p->ch || to == p->victim || !combatsum_takes( to ) )
+				continue;
+			if ( to->desc == NULL || to->desc->connected != CON_PLAYING || !IS_AWAKE( to ) )
+				continue;
+
+			if ( p->hits > 0 )
+				snprintf( buf, sizeof( buf ), "%s hits %s %d time%s for %d%s.\n\r",
+					PERS( p->ch, to ), PERS( p->victim, to ),
+					p->hits, p->hits == 1 ? "" : "s", p->dam, miss );
+			else
+				snprintf( buf, sizeof( buf ), "%s misses %s %d time%s.\n\r",
+					PERS( p->ch, to ), PERS( p->victim, to ),
+					p->misses, p->misses == 1 ? "" : "s" );
+			buf[0] = (char) toupper( (unsigned char) buf[0] );
+			send_to_char( buf, to );
+			sum_stat_lines++;
+		}
+	}
+	sum_count = 0;
+}
+
+void combatsum_get_stats( long *hits, long *acts, long *lines ) {
+	*hits = sum_stat_hits;
+	*acts = sum_stat_acts;
+	*lines = sum_stat_lines;
+}
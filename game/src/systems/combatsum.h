@@ -0,0 +1,35 @@
+/*
+ * combatsum.h - Per-round combat summaries for onlookers
+ *
+ * Every hit dam_message() reports goes to the whole room, so a few
+ * multi-attack fighters fill each bystander's screen every round.
+ * Players who turn on "config +combatsum" instead get, at the end of
+ * each violence_update(), one line per attacker and victim they watched:
+ *
+ *   Alpha hits Beta 7 times for 4123.
+ *
+ * Only the onlooker's copy of a plain hit is summed; the attacker and the
+ * victim still see each hit, and death blows, criticals and spell effects
+ * are shown as they happen.  Hits outside violence_update() (the opening
+ * blow of "kill", spells cast between rounds) are not held back.
+ */
+
+#ifndef COMBATSUM_H
+#define COMBATSUM_H
+
+void combatsum_begin( void );                /* Start of violence_update() */
+void combatsum_end( void );                  /* End of it: send the summaries */
+
+/* Does to take summaries instead of the round's hits? */
+bool combatsum_wants( CHAR_DATA *to );
+
+/*
+ * Count ch's hit on victim for the onlookers who take summaries.  Returns
+ * TRUE when someone in the room still wants the hit itself, and dam_message()
+ * should act() it to them with TO_NOTVICT_HIT.
+ */
+bool combatsum_hit( CHAR_DATA *ch, CHAR_DATA *victim, int dam );
+
+void combatsum_get_stats( long *hits, long *acts, long *lines );
+
+#endif /* COMBATSUM_H */
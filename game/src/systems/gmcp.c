@@ -142,32 +142,20 @@ void gmcp_init( DESCRIPTOR_DATA *d ) {
 }
 
 /*
- * Send a raw GMCP message: IAC SB GMCP <package> <data> IAC SE
+ * Build one GMCP frame, IAC SB GMCP <package> <data> IAC SE, into buf.
+ * Returns its length; the package or data is cut short rather than
+ * overrun size, which must leave room for the framing (16 bytes or more).
  */
-void gmcp_send( DESCRIPTOR_DATA *d, const char *package, const char *data ) {
-	char buf[MAX_STRING_LENGTH * 2];
+int gmcp_frame( char *buf, int size, const char *package, const char *data ) {
 	int len;
 
-	if ( d == NULL || !d->gmcp_enabled )
-		return;
-
-	if ( package == NULL )
-		return;
-
-	/* Flush any pending text output before sending out-of-band data.
-	 * This ensures text (combat messages, etc.) arrives at the client
-	 * before related GMCP messages (sounds, vitals updates). */
-	if ( d->outtop > 0 )
-		process_output( d, FALSE );
-
-	/* Build the GMCP message */
 	buf[0] = (char) IAC;
 	buf[1] = (char) SB;
 	buf[2] = (char) TELOPT_GMCP;
 	len = 3;
 
 	/* Copy package name */
-	while ( *package && len < sizeof( buf ) - 10 )
+	while ( *package && len < size - 10 )
 		buf[len++] = *package++;
 
 	/* Add space separator if we have data */
@@ -175,7 +163,7 @@ void gmcp_send( DESCRIPTOR_DATA *d, const char *package, const char *data ) {
 		buf[len++] = ' ';
 
 		/* Copy JSON data */
-		while ( *data && len < sizeof( buf ) - 5 )
+		while ( *data && len < size - 5 )
 			buf[len++] = *data++;
 	}
 
@@ -184,6 +172,29 @@ void gmcp_send( DESCRIPTOR_DATA *d, const char *package, const char *data ) {
 	buf[len++] = (char) SE;
 	buf[len] = '\0';
 
+	return len;
+}
+
+/*
+ * Send a raw GMCP message: IAC SB GMCP <package> <data> IAC SE
+ */
+void gmcp_send( DESCRIPTOR_DATA *d, const char *package, const char *data ) {
+	char buf[MAX_STRING_LENGTH * 2];
+	int len;
+
+	if ( d == NULL || !d->gmcp_enabled )
+		return;
+
+	if ( package == NULL )
+		return;
+
+	/* Flush any pending text output before sending out-of-band data.
+	 * This ensures text (combat messages, etc.) arrives at the client
+	 * before related GMCP messages (sounds, vitals updates). */
+	if ( d->outtop > 0 )
+		process_output( d, FALSE );
+
+	len = gmcp_frame( buf, sizeof( buf ), package, data );
 	write_to_descriptor( d, buf, len );
 }
 
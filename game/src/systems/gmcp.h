@@ -41,6 +41,9 @@ void gmcp_init( DESCRIPTOR_DATA *d );
 /* Send a raw GMCP message: IAC SB GMCP <package> <data> IAC SE */
 void gmcp_send( DESCRIPTOR_DATA *d, const char *package, const char *data );
 
+/* Build one GMCP frame into buf without sending it; returns its length */
+int gmcp_frame( char *buf, int size, const char *package, const char *data );
+
 /* Send Char.Vitals with current/max hp, mana, move */
 void gmcp_send_vitals( CHAR_DATA *ch );
 
@@ -11,6 +11,9 @@
 #endif
 #include <time.h>
 #include "merc.h"
+#include "../core/input.h"
+#include "../core/prompt.h"
+#include "mcmp.h"
 
 /*
  * Is astr contained within bstr ?
@@ -941,6 +944,9 @@ void recycle_descriptors() {
 		 */
 		free(dclose->host);
 		free( dclose->outbuf );
+		prompt_cache_free( dclose );
+		mcmp_queue_free( dclose );
+		input_close( dclose->input );
 
 		/*
 		 * Mccp
@@ -82,6 +82,138 @@ void mcmp_load( DESCRIPTOR_DATA *d, const char *name ) {
 	gmcp_send( d, "Client.Media.Load", buf );
 }
 
+/*
+ * Per-pulse media queue — see mcmp.h.
+ */
+#define MCMP_BODY_MAX  768	/* Longest Play body that is queued */
+#define MCMP_IDENT_MAX 160	/* "k:<key>" or "n:<name>"           */
+
+typedef struct mcmp_queued {
+	unsigned int hash;			/* Of ident */
+	int priority;
+	char ident[MCMP_IDENT_MAX];
+	char body[MCMP_BODY_MAX];	/* Client.Media.Play JSON */
+} MCMP_QUEUED;
+
+struct mcmp_queue {
+	int count;
+	MCMP_QUEUED q[MCMP_QUEUE_MAX];
+};
+
+static long mcmp_stat_played;	/* mcmp_play() calls that got as far as the queue */
+static long mcmp_stat_sent;		/* Play messages written                          */
+static long mcmp_stat_writes;	/* Socket writes that carried them                */
+
+static unsigned int mcmp_ident_hash( const char *ident ) {
+	unsigned int h = 2166136261u;
+
+	for ( ; *ident != '\0'; ident++ ) {
+		h ^= (unsigned char) *ident;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static void mcmp_queue_set( MCMP_QUEUED *e, unsigned int hash, const char *ident,
+		int priority, const char *body, int len ) {
+	e->hash = hash;
+	e->priority = priority;
+	strcpy( e->ident, ident );
+	memcpy( e->body, body, len + 1 );
+}
+
+/*
+ * Queue one Play body on d.  A sound already queued this pulse is merged:
+ * a keyed one is replaced outright (the client would do the same), an
+ * unkeyed one keeps whichever copy has the higher priority.  On a full
+ * queue the lowest-priority sound gives way, or the new one is dropped if
+ * nothing queued is below it.
+ */
+static void mcmp_queue_play( DESCRIPTOR_DATA *d, const char *ident, bool keyed,
+		int priority, const char *body, int len ) {
+	MCMP_QUEUE *q = d->media_queue;
+	unsigned int hash = mcmp_ident_hash( ident );
+	int i, lo;
+
+	mcmp_stat_played++;
+
+	/* Too long to queue: send it as before, behind anything queued */
+	if ( len >= MCMP_BODY_MAX ) {
+		mcmp_flush( d );
+		gmcp_send( d, "Client.Media.Play", body );
+		mcmp_stat_sent++;
+		mcmp_stat_writes++;
+		return;
+	}
+
+	if ( q == NULL ) {
+		q = d->media_queue = calloc( 1, sizeof( MCMP_QUEUE ) );
+		if ( !q ) {
+			bug( "mcmp_queue_play: calloc failed", 0 );
+			exit( 1 );
+		}
+	}
+
+	for ( i = 0; i < q->count; i++ ) {
+		if ( q->q[i].hash == hash && !strcmp( q->q[i].ident, ident ) ) {
+			if ( keyed || priority > q->q[i].priority )
+				mcmp_queue_set( &q->q[i], hash, ident, priority, body, len );
+			return;
+		}
+	}
+
+	if ( q->count == MCMP_QUEUE_MAX ) {
+		for ( lo = 0, i = 1; i < q->count; i++ )
+			if ( q->q[i].priority < q->q[lo].priority )
+				lo = i;
+		if ( priority <= q->q[lo].priority )
+			return;
+		memmove( &q->q[lo], &q->q[lo + 1], ( q->count - lo - 1 ) * sizeof( MCMP_QUEUED ) );
+		q->count--;
+	}
+
+	mcmp_queue_set( &q->q[q->count++], hash, ident, priority, body, len );
+}
+
+/*
+ * Send everything queued on d as one write, after any pending text.
+ */
+void mcmp_flush( DESCRIPTOR_DATA *d ) {
+	char buf[MCMP_QUEUE_MAX * ( MCMP_BODY_MAX + 32 )];
+	MCMP_QUEUE *q;
+	int i, len = 0;
+
+	if ( d == NULL || ( q = d->media_queue ) == NULL || q->count == 0 )
+		return;
+
+	if ( !mcmp_enabled( d ) ) {
+		q->count = 0;
+		return;
+	}
+
+	if ( d->outtop > 0 )
+		process_output( d, FALSE );
+
+	for ( i = 0; i < q->count; i++ )
+		len += gmcp_frame( buf + len, sizeof( buf ) - len, "Client.Media.Play", q->q[i].body );
+	mcmp_stat_sent += q->count;
+	mcmp_stat_writes++;
+	q->count = 0;
+
+	write_to_descriptor( d, buf, len );
+}
+
+void mcmp_queue_free( DESCRIPTOR_DATA *d ) {
+	free( d->media_queue );
+	d->media_queue = NULL;
+}
+
+void mcmp_get_stats( long *played, long *sent, long *writes ) {
+	*played = mcmp_stat_played;
+	*sent = mcmp_stat_sent;
+	*writes = mcmp_stat_writes;
+}
+
 /*
  * Send Client.Media.Play — play a media file.
  *
@@ -111,6 +243,7 @@ void mcmp_play( DESCRIPTOR_DATA *d, const char *name, const char *type,
                 const char *tag, int volume, int loops, int priority,
                 const char *key, bool cont, const char *caption ) {
 	char buf[MAX_STRING_LENGTH];
+	char ident[MCMP_IDENT_MAX];
 	int len;
 
 	if ( !mcmp_enabled( d ) || name == NULL )
@@ -138,9 +271,12 @@ void mcmp_play( DESCRIPTOR_DATA *d, const char *name, const char *type,
 		len += snprintf( buf + len, sizeof( buf ) - len, ",\"continue\":true" );
 	if ( caption != NULL )
 		len += snprintf( buf + len, sizeof( buf ) - len, ",\"caption\":\"%s\"", caption );
-	snprintf( buf + len, sizeof( buf ) - len, "}" );
+	len += snprintf( buf + len, sizeof( buf ) - len, "}" );
 
-	gmcp_send( d, "Client.Media.Play", buf );
+	/* Same key replaces on the client, so the key is the sound's identity */
+	snprintf( ident, sizeof( ident ), key != NULL ? "k:%s" : "n:%s",
+		key != NULL ? key : name );
+	mcmp_queue_play( d, ident, key != NULL, priority, buf, len );
 }
 
 /*
@@ -171,6 +307,9 @@ void mcmp_stop( DESCRIPTOR_DATA *d, const char *name, const char *type,
 	if ( !mcmp_enabled( d ) )
 		return;
 
+	/* A stop must not overtake plays queued before it */
+	mcmp_flush( d );
+
 	len = snprintf( buf, sizeof( buf ), "{" );
 
 	/* Build filter fields — first field has no leading comma */
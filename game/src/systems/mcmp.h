@@ -106,6 +106,23 @@ void mcmp_stop( DESCRIPTOR_DATA *d, const char *name, const char *type,
 /* Check if a descriptor has MCMP (Client.Media) support enabled */
 bool mcmp_enabled( DESCRIPTOR_DATA *d );
 
+/*
+ * Per-pulse media queue
+ *
+ * mcmp_play() does not write to the socket: the sound is queued on the
+ * descriptor and game_loop() sends the pulse's sounds with mcmp_flush(),
+ * all in one write after the pulse's text.  Within a pulse a sound that is
+ * already queued (same key, or same file when unkeyed) is merged rather
+ * than sent twice, and past MCMP_QUEUE_MAX sounds the lowest-priority
+ * ones are dropped.  mcmp_stop() flushes first, so it still lands after
+ * the plays that preceded it.
+ */
+#define MCMP_QUEUE_MAX 8
+
+void mcmp_flush( DESCRIPTOR_DATA *d );
+void mcmp_queue_free( DESCRIPTOR_DATA *d );
+void mcmp_get_stats( long *played, long *sent, long *writes );
+
 /*
  * High-level game event functions
  * Each checks mcmp_enabled() internally — safe to call unconditionally.
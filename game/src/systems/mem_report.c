@@ -253,6 +253,7 @@ static mem_category_t mem_objects( int *out_affects, int *out_ed,
 		FTRACK( F_QUESTMAKER, obj->questmaker );
 		FTRACK( F_QUESTOWNER, obj->questowner );
 #undef FTRACK
+		r.string_bytes += str_mem( obj->mxp_hint );
 
 		LIST_FOR_EACH( aff, &obj->affects, AFFECT_DATA, node ) {
 			aff_count++;
@@ -792,7 +793,6 @@ static void mem_show_descriptors( CHAR_DATA *ch ) {
 		compress_total, COMPRESS_BUF_SIZE );
 
 	send_to_char( "\n\r#CFixed buffers (embedded in struct):#n\n\r", ch );
-	send_line( ch, "  inbuf:         %zu bytes each\n\r", sizeof( ((DESCRIPTOR_DATA*)0)->inbuf ) );
 	send_line( ch, "  incomm:        %zu bytes each\n\r", sizeof( ((DESCRIPTOR_DATA*)0)->incomm ) );
 	send_line( ch, "  inlast:        %zu bytes each\n\r", sizeof( ((DESCRIPTOR_DATA*)0)->inlast ) );
 	send_line( ch, "  client_name:   %zu bytes each\n\r", sizeof( ((DESCRIPTOR_DATA*)0)->client_name ) );
@@ -45,6 +45,64 @@ const char mxp_sb[] = { (char) IAC, (char) SB, (char) TELOPT_MXP, (char) IAC, (c
  */
 static const char mxp_lock_locked[] = "\033[7z"; /* Set default to locked mode */
 
+/*
+ * Custom link elements, defined once per session by mxpStart().
+ * A link then only carries its parameters, e.g.
+ *   <Og k="'long sword'" h="Weapon, Wt: 5">a long sword</Og>
+ * instead of the whole SEND menu with the keywords repeated per command.
+ * k is always sent already quoted where the command needs quotes, since
+ * a definition cannot hold a literal single quote.  Menus with per-viewer
+ * extras (drop all, put in, forge onto, activate...) still go out as a
+ * plain SEND.
+ */
+static const struct {
+	const char *name;
+	const char *def;
+	const char *att;
+} mxp_element_table[] = {
+	{ "Og", "<send href=\"get &k;|look &k;|sacrifice &k;\" hint=\"&h;|Get|Look|Sacrifice\">", "k h" },
+	{ "Oc", "<send href=\"get &k;|look &k;|look in &k;|sacrifice &k;\" hint=\"&h;|Get|Look|Look In|Sacrifice\">", "k h" },
+	{ "Om", "<send href=\"get &k;|look &k;\" hint=\"&h;|Get|Look\">", "k h" },
+	{ "Op", "<send href=\"enter &k;|look &k;\" hint=\"&h;|Enter|Look\">", "k h" },
+	{ "Of", "<send href=\"sit &k;|rest &k;|sleep &k;|look &k;\" hint=\"&h;|Sit|Rest|Sleep|Look\">", "k h" },
+	{ "Oi", "<send href=\"&u; &k;|look &k;|drop &k;|cast identify &k;\" hint=\"&h;|&l;|Look|Drop|Identify\">", "u l k h" },
+	{ "On", "<send href=\"look &k;|drop &k;|cast identify &k;\" hint=\"&h;|Look|Drop|Identify\">", "k h" },
+	{ "Oe", "<send href=\"remove &k;|look &k;\" hint=\"&h;|Remove|Look\">", "k h" },
+	{ "Ow", "<send href=\"remove &k;|look &k;|look in &k;\" hint=\"&h;|Remove|Look|Look In\">", "k h" },
+	{ "Ot", "<send href=\"get &k; &c;\" hint=\"&h;\">", "k c h" },
+	{ "Mb", "<send href=\"attack &k;|look &k;|consider &k;\" hint=\"&h;|Attack|Look|Consider\">", "k h" },
+	{ "Pc", "<send href=\"attack &k;|look &k;|consider &k;|finger &k;\" hint=\"&h;|Attack|Look|Consider|Finger\">", "k h" },
+	{ "Fi", "<send href=\"finger &k;\" hint=\"&h;\">", "k h" },
+	{ "Ex", "<send href=\"&c;\" hint=\"&h;\">", "c h" },
+	{ "Au", "<send hint=\"&h;\">", "h" },
+};
+
+/*
+ * Write the element definitions into buf; returns the length.
+ * Each definition goes on its own secure line.
+ */
+size_t mxp_element_definitions( char *buf, size_t len ) {
+	size_t used = 0;
+	size_t i;
+
+	if ( buf == NULL || len == 0 )
+		return 0;
+
+	buf[0] = '\0';
+	for ( i = 0; i < sizeof( mxp_element_table ) / sizeof( mxp_element_table[0] ); i++ ) {
+		int n = snprintf( buf + used, len - used,
+			MXP_SECURE_LINE "<!ELEMENT %s '%s' ATT='%s'>" MXP_LOCK_LOCKED,
+			mxp_element_table[i].name, mxp_element_table[i].def, mxp_element_table[i].att );
+
+		if ( n < 0 || (size_t) n >= len - used ) {
+			buf[used] = '\0';
+			break;
+		}
+		used += (size_t) n;
+	}
+	return used;
+}
+
 /*
  * Start MXP mode on a descriptor
  * Called when client responds with IAC DO MXP
@@ -68,6 +126,14 @@ bool mxpStart( DESCRIPTOR_DATA *desc ) {
 	 * Use #M escape in text to switch to secure mode for actual MXP tags. */
 	write_to_descriptor( desc, (char *) mxp_lock_locked, (int) strlen( mxp_lock_locked ) );
 
+	/* Define the link elements once, so links only carry parameters */
+	{
+		char defs[MXP_BUF_MAX_LEN];
+		size_t len = mxp_element_definitions( defs, sizeof( defs ) );
+
+		desc->mxp_elements = len > 0 && write_to_descriptor( desc, defs, (int) len );
+	}
+
 	desc->mxp_enabled = TRUE;
 	return TRUE;
 }
@@ -81,6 +147,7 @@ void mxpEnd( DESCRIPTOR_DATA *desc ) {
 		return;
 
 	desc->mxp_enabled = FALSE;
+	desc->mxp_elements = FALSE;
 }
 
 /*
@@ -440,31 +507,17 @@ static void mxp_build_ground_menu( OBJ_DATA *obj, CHAR_DATA *ch,
 }
 
 /*
- * Build MXP menu for items in inventory (in_room = FALSE)
- * Context-aware primary action based on item type
- * count = number of stacked items (for "Drop All" option)
+ * Primary use command and menu label for an item in inventory, based on
+ * item type.  Both are NULL when the item has no primary action.
  */
-static void mxp_build_inventory_menu( OBJ_DATA *obj, CHAR_DATA *ch,
-	const char *keywords, const char *escaped_hint,
-	char *href_buf, size_t href_size,
-	char *hint_buf, size_t hint_size,
-	int count ) {
-	const char *use_cmd = NULL;
-	const char *use_label = NULL;
-	OBJ_DATA *cont;
-	char cont_keywords[MAX_INPUT_LENGTH];
-
-	if ( obj == NULL || keywords == NULL )
-		return;
-
-	href_buf[0] = '\0';
-	hint_buf[0] = '\0';
+static void mxp_inventory_action( OBJ_DATA *obj, const char **cmd, const char **label ) {
+	*cmd = NULL;
+	*label = NULL;
 
-	/* Determine primary use command based on item type */
 	switch ( obj->item_type ) {
 	case ITEM_POTION:
-		use_cmd = "quaff";
-		use_label = "Quaff";
+		*cmd = "quaff";
+		*label = "Quaff";
 		break;
 	case ITEM_PILL:
 	case ITEM_FOOD:
@@ -472,43 +525,43 @@ static void mxp_build_inventory_menu( OBJ_DATA *obj, CHAR_DATA *ch,
 	case ITEM_QUEST:
 	case ITEM_DTOKEN:
 	case ITEM_DRAGONGEM:
-		use_cmd = "eat";
-		use_label = "Eat";
+		*cmd = "eat";
+		*label = "Eat";
 		break;
 	case ITEM_DRINK_CON:
-		use_cmd = "drink";
-		use_label = "Drink";
+		*cmd = "drink";
+		*label = "Drink";
 		break;
 	case ITEM_SCROLL:
-		use_cmd = "recite";
-		use_label = "Recite";
+		*cmd = "recite";
+		*label = "Recite";
 		break;
 	case ITEM_WAND:
 	case ITEM_STAFF:
-		use_cmd = "brandish";
-		use_label = "Use";
+		*cmd = "brandish";
+		*label = "Use";
 		break;
 	case ITEM_BOOK:
-		use_cmd = "open";
-		use_label = "Open";
+		*cmd = "open";
+		*label = "Open";
 		break;
 	case ITEM_PAGE:
-		use_cmd = "read";
-		use_label = "Read";
+		*cmd = "read";
+		*label = "Read";
 		break;
 	case ITEM_INSTRUMENT:
-		use_cmd = "play";
-		use_label = "Play";
+		*cmd = "play";
+		*label = "Play";
 		break;
 	case ITEM_STAKE:
 	case ITEM_VOODOO:
 	case ITEM_LIGHT:
-		use_cmd = "hold";
-		use_label = "Hold";
+		*cmd = "hold";
+		*label = "Hold";
 		break;
 	case ITEM_HEAD:
-		use_cmd = "sacrifice";
-		use_label = "Sacrifice";
+		*cmd = "sacrifice";
+		*label = "Sacrifice";
 		break;
 	case ITEM_COPPER:
 	case ITEM_IRON:
@@ -516,30 +569,55 @@ static void mxp_build_inventory_menu( OBJ_DATA *obj, CHAR_DATA *ch,
 	case ITEM_ADAMANTITE:
 	case ITEM_GEMSTONE:
 	case ITEM_HILT:
-		/* Forging materials - handle specially below */
-		use_cmd = NULL;
-		use_label = NULL;
+		/* Forging materials - mxp_build_inventory_menu adds forge targets */
+		*cmd = NULL;
+		*label = NULL;
 		break;
 	case ITEM_CONTAINER:
 	case ITEM_CORPSE_NPC:
 	case ITEM_CORPSE_PC:
-		use_cmd = "look in";
-		use_label = "Look In";
+		*cmd = "look in";
+		*label = "Look In";
 		break;
 	default:
 		/* Check wear flags for equipment */
 		if ( CAN_WEAR( obj, ITEM_WIELD ) ) {
-			use_cmd = "wield";
-			use_label = "Wield";
+			*cmd = "wield";
+			*label = "Wield";
 		} else if ( CAN_WEAR( obj, ITEM_HOLD ) ) {
-			use_cmd = "hold";
-			use_label = "Hold";
+			*cmd = "hold";
+			*label = "Hold";
 		} else if ( obj->wear_flags > ITEM_TAKE ) {
-			use_cmd = "wear";
-			use_label = "Wear";
+			*cmd = "wear";
+			*label = "Wear";
 		}
 		break;
 	}
+}
+
+/*
+ * Build MXP menu for items in inventory (in_room = FALSE)
+ * Context-aware primary action based on item type
+ * count = number of stacked items (for "Drop All" option)
+ */
+static void mxp_build_inventory_menu( OBJ_DATA *obj, CHAR_DATA *ch,
+	const char *keywords, const char *escaped_hint,
+	char *href_buf, size_t href_size,
+	char *hint_buf, size_t hint_size,
+	int count ) {
+	const char *use_cmd = NULL;
+	const char *use_label = NULL;
+	OBJ_DATA *cont;
+	char cont_keywords[MAX_INPUT_LENGTH];
+
+	if ( obj == NULL || keywords == NULL )
+		return;
+
+	href_buf[0] = '\0';
+	hint_buf[0] = '\0';
+
+	/* Determine primary use command based on item type */
+	mxp_inventory_action( obj, &use_cmd, &use_label );
 
 	/* Build the menu - start with primary action */
 	if ( use_cmd != NULL ) {
@@ -719,6 +797,122 @@ static void mxp_add_sitem_options( OBJ_DATA *obj, const char *keywords,
 	}
 }
 
+/*
+ * Everything mxp_build_item_tooltip() reads from the object, folded into
+ * one word (FNV-1a).  The cached tooltip is rebuilt when this changes.
+ * Portals also show their destination's name, which redit can change
+ * without touching the portal, so that goes in too.
+ */
+static uint32_t mxp_hint_sig( OBJ_DATA *obj ) {
+	int fields[9];
+	uint32_t h = 2166136261u;
+	const char *p;
+	size_t i;
+
+	fields[0] = obj->item_type;
+	fields[1] = obj->weight;
+	fields[2] = obj->spectype;
+	fields[3] = obj->condition;
+	fields[4] = obj->level;
+	fields[5] = obj->value[0];
+	fields[6] = obj->value[1];
+	fields[7] = obj->value[2];
+	fields[8] = obj->value[3];
+	for ( i = 0; i < sizeof( fields ) / sizeof( fields[0] ); i++ ) {
+		h ^= (uint32_t) fields[i];
+		h *= 16777619u;
+	}
+	if ( obj->item_type == ITEM_PORTAL || obj->item_type == ITEM_WGATE ) {
+		for ( p = mxp_get_portal_destination( obj ); *p != '\0'; p++ ) {
+			h ^= (unsigned char) *p;
+			h *= 16777619u;
+		}
+	}
+	return h;
+}
+
+/*
+ * Escaped item tooltip, built once per object and kept until the fields
+ * it shows change.  The tooltip does not depend on the viewer.
+ */
+static const char *mxp_obj_hint( OBJ_DATA *obj, CHAR_DATA *ch ) {
+	char hint[512];
+	char escaped_hint[1024];
+	uint32_t sig = mxp_hint_sig( obj );
+
+	if ( obj->mxp_hint != NULL && obj->mxp_hint_sig == sig )
+		return obj->mxp_hint;
+
+	mxp_build_item_tooltip( obj, ch, hint, sizeof( hint ) );
+	mxp_escape_string( escaped_hint, hint, sizeof( escaped_hint ) );
+	free( obj->mxp_hint );
+	obj->mxp_hint = str_dup( escaped_hint );
+	obj->mxp_hint_sig = sig;
+	return obj->mxp_hint;
+}
+
+/*
+ * Pick the predefined element for an object link, or NULL when the menu
+ * has per-viewer extras that only a full SEND can carry.  For inventory
+ * items *use_cmd and *use_label are set for the Oi element.
+ */
+static const char *mxp_obj_element( OBJ_DATA *obj, CHAR_DATA *ch, bool in_room, int count,
+	const char **use_cmd, const char **use_label ) {
+	OBJ_DATA *cont;
+
+	if ( IS_SET( obj->spectype, SITEM_ACTIVATE | SITEM_PRESS | SITEM_TWIST | SITEM_PULL ) )
+		return NULL;
+
+	if ( in_room ) {
+		switch ( obj->item_type ) {
+		case ITEM_PORTAL:
+		case ITEM_WGATE:
+			return "Op";
+		case ITEM_FURNITURE:
+			return "Of";
+		case ITEM_CONTAINER:
+		case ITEM_CORPSE_NPC:
+		case ITEM_CORPSE_PC:
+			return "Oc";
+		case ITEM_MONEY:
+			return "Om";
+		case ITEM_FOUNTAIN:
+		case ITEM_QUESTMACHINE:
+			return NULL;
+		default:
+			return "Og";
+		}
+	}
+
+	/* Drop All, forge targets and Put in <container> vary per viewer */
+	if ( count > 1 )
+		return NULL;
+	switch ( obj->item_type ) {
+	case ITEM_COPPER:
+	case ITEM_IRON:
+	case ITEM_STEEL:
+	case ITEM_ADAMANTITE:
+	case ITEM_GEMSTONE:
+	case ITEM_HILT:
+		return NULL;
+	case ITEM_CONTAINER:
+	case ITEM_CORPSE_NPC:
+	case ITEM_CORPSE_PC:
+		break;
+	default:
+		LIST_FOR_EACH( cont, &ch->carrying, OBJ_DATA, content_node ) {
+			if ( cont != obj && cont->item_type == ITEM_CONTAINER
+				&& !IS_SET( cont->value[1], CONT_CLOSED )
+				&& cont->name != NULL && cont->name[0] != '\0' )
+				return NULL;
+		}
+		break;
+	}
+
+	mxp_inventory_action( obj, use_cmd, use_label );
+	return *use_cmd != NULL ? "Oi" : "On";
+}
+
 /*
  * Format an object with MXP clickable link and tooltip
  * Returns a static buffer with MXP-wrapped text
@@ -732,8 +926,7 @@ static void mxp_add_sitem_options( OBJ_DATA *obj, const char *keywords,
 char *mxp_obj_link( OBJ_DATA *obj, CHAR_DATA *ch, char *display_text, bool in_room, int count ) {
 	static char buf[MXP_BUF_MAX_LEN];
 	char keywords[MAX_INPUT_LENGTH];
-	char hint[512];
-	char escaped_hint[1024];
+	const char *escaped_hint;
 	char href_buf[2048];
 	char hint_buf[2048];
 
@@ -751,9 +944,28 @@ char *mxp_obj_link( OBJ_DATA *obj, CHAR_DATA *ch, char *display_text, bool in_ro
 	/* Escape the full name for MXP */
 	mxp_escape_string( keywords, obj->name, sizeof( keywords ) );
 
-	/* Build enhanced tooltip with item-specific information */
-	mxp_build_item_tooltip( obj, ch, hint, sizeof( hint ) );
-	mxp_escape_string( escaped_hint, hint, sizeof( escaped_hint ) );
+	/* Enhanced tooltip with item-specific information, cached on the object */
+	escaped_hint = mxp_obj_hint( obj, ch );
+
+	/* Fixed menus go out as a predefined element carrying only parameters */
+	if ( ch->desc->mxp_elements ) {
+		const char *use_cmd = NULL;
+		const char *use_label = NULL;
+		const char *elem = mxp_obj_element( obj, ch, in_room, count, &use_cmd, &use_label );
+
+		if ( elem != NULL && use_cmd != NULL ) {
+			snprintf( buf, sizeof( buf ),
+				MXP_SECURE_LINE "<%s u=\"%s\" l=\"%s\" k=\"'%s'\" h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</%s>" MXP_LOCK_LOCKED,
+				elem, use_cmd, use_label, keywords, escaped_hint, display_text, elem );
+			return buf;
+		}
+		if ( elem != NULL ) {
+			snprintf( buf, sizeof( buf ),
+				MXP_SECURE_LINE "<%s k=\"'%s'\" h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</%s>" MXP_LOCK_LOCKED,
+				elem, keywords, escaped_hint, display_text, elem );
+			return buf;
+		}
+	}
 
 	/* Build context-aware menu based on location */
 	if ( in_room ) {
@@ -849,7 +1061,13 @@ char *mxp_equip_link( OBJ_DATA *obj, CHAR_DATA *ch, char *display_text ) {
 	{
 		bool is_container = ( obj->item_type == ITEM_CONTAINER || obj->item_type == ITEM_CORPSE_NPC || obj->item_type == ITEM_CORPSE_PC );
 
-		if ( is_container ) {
+		if ( ch->desc->mxp_elements ) {
+			const char *elem = is_container ? "Ow" : "Oe";
+
+			snprintf( buf, sizeof( buf ),
+				MXP_SECURE_LINE "<%s k=\"'%s'\" h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</%s>" MXP_LOCK_LOCKED,
+				elem, keywords, escaped_hint, display_text, elem );
+		} else if ( is_container ) {
 			snprintf( buf, sizeof( buf ),
 				MXP_SECURE_LINE "<SEND href=\"remove '%s'|look '%s'|look in '%s'\" hint=\"%s|Remove|Look|Look In\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</SEND>" MXP_LOCK_LOCKED,
 				keywords, keywords, keywords, escaped_hint, display_text );
@@ -923,6 +1141,12 @@ char *mxp_container_item_link( OBJ_DATA *obj, OBJ_DATA *container, CHAR_DATA *ch
 
 	/* Simple click to get item from container - no menu needed
 	 * Switch to locked mode for display text so angle brackets are safe */
+	if ( ch->desc->mxp_elements ) {
+		snprintf( buf, sizeof( buf ),
+			MXP_SECURE_LINE "<Ot k=\"'%s'\" c=\"'%s'\" h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</Ot>" MXP_LOCK_LOCKED,
+			obj_keywords, container_keywords, escaped_hint, display_text );
+		return buf;
+	}
 	snprintf( buf, sizeof( buf ),
 		MXP_SECURE_LINE "<SEND href=\"get '%s' '%s'\" hint=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</SEND>" MXP_LOCK_LOCKED,
 		obj_keywords, container_keywords, escaped_hint, display_text );
@@ -975,6 +1199,12 @@ char *mxp_player_link( CHAR_DATA *victim, CHAR_DATA *ch, char *display_text ) {
 
 	/* Build the MXP-wrapped string
 	 * Switch to locked mode for display text so angle brackets are safe */
+	if ( ch->desc->mxp_elements ) {
+		snprintf( buf, sizeof( buf ),
+			MXP_SECURE_LINE "<Fi k=\"%s\" h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</Fi>" MXP_LOCK_LOCKED,
+			escaped_name, escaped_hint, display_text );
+		return buf;
+	}
 	snprintf( buf, sizeof( buf ),
 		MXP_SECURE_LINE "<SEND href=\"finger %s\" hint=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</SEND>" MXP_LOCK_LOCKED,
 		escaped_name, escaped_hint, display_text );
@@ -1179,6 +1409,12 @@ char *mxp_exit_link( EXIT_DATA *pexit, int door, CHAR_DATA *ch, char *display_te
 	}
 
 	/* Switch to locked mode for display text so angle brackets are safe */
+	if ( ch->desc->mxp_elements ) {
+		snprintf( outbuf, MXP_BUF_MAX_LEN,
+			MXP_SECURE_LINE "<Ex c=\"%s\" h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</Ex>" MXP_LOCK_LOCKED,
+			cmd, escaped_hint, display_text );
+		return outbuf;
+	}
 	snprintf( outbuf, MXP_BUF_MAX_LEN,
 		MXP_SECURE_LINE "<SEND href=\"%s\" hint=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</SEND>" MXP_LOCK_LOCKED,
 		cmd, escaped_hint, display_text );
@@ -1304,7 +1540,13 @@ char *mxp_char_link( CHAR_DATA *victim, CHAR_DATA *ch, char *display_text ) {
 	 *
 	 * Trailing newlines are added after the MXP closing tag */
 	/* Switch to locked mode for display text so angle brackets are safe */
-	if ( IS_NPC( victim ) ) {
+	if ( ch->desc->mxp_elements ) {
+		const char *elem = IS_NPC( victim ) ? "Mb" : "Pc";
+
+		snprintf( buf, sizeof( buf ),
+			MXP_SECURE_LINE "<%s k=\"%s\" h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</%s>" MXP_LOCK_LOCKED "%s",
+			elem, escaped_keyword, escaped_hint, clean_text, elem, trailing );
+	} else if ( IS_NPC( victim ) ) {
 		/* 3 commands: attack, look, consider -> 4 hints: tooltip + 3 labels */
 		snprintf( buf, sizeof( buf ),
 			MXP_SECURE_LINE "<SEND href=\"attack %s|look %s|consider %s\" hint=\"%s|Attack|Look|Consider\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</SEND>" MXP_LOCK_LOCKED "%s",
@@ -1386,7 +1628,9 @@ char *mxp_aura_tag( CHAR_DATA *ch, const char *prefix, const char *tooltip, int
 
 		/* Switch to locked mode for display text so angle brackets are safe */
 		snprintf( buf, MAX_STRING_LENGTH,
-			MXP_SECURE_LINE "<SEND hint=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</SEND>" MXP_LOCK_LOCKED "%s",
+			ch->desc->mxp_elements
+				? MXP_SECURE_LINE "<Au h=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</Au>" MXP_LOCK_LOCKED "%s"
+				: MXP_SECURE_LINE "<SEND hint=\"%s\">" MXP_LOCK_LOCKED "%s" MXP_SECURE_LINE "</SEND>" MXP_LOCK_LOCKED "%s",
 			escaped_tooltip, clean_prefix, had_trailing_space ? " " : "" );
 	}
 
@@ -55,6 +55,7 @@ char *mxp_exit_link ( EXIT_DATA * pexit, int door, CHAR_DATA *ch, char *display_
 char *mxp_char_link ( CHAR_DATA * victim, CHAR_DATA *ch, char *display_text );
 char *mxp_aura_tag ( CHAR_DATA * ch, const char *prefix, const char *tooltip, int sn );
 void mxp_escape_string ( char *dest, const char *src, size_t maxlen );
+size_t mxp_element_definitions ( char *buf, size_t len );
 
 /* Player command */
 void do_mxp ( CHAR_DATA * ch, char *argument );
@@ -24,46 +24,105 @@
 #include <string.h>
 #include <time.h>
 #include <limits.h>
+#include <math.h>
 #include "../core/merc.h"
 #include "profile.h"
+#include "../script/script.h"
+#include "../db/db_game.h"
 
 /* Global profiling state */
 PROFILE_STATS profile_stats;
 
+/* Marker names, indexed by PROFILE_MARKER_ID */
+#define PROFILE_MARKER_NAME( id, name ) name,
+static const char *const profile_marker_names[PROFILE_MAX_MARKERS] = {
+    PROFILE_MARKER_LIST( PROFILE_MARKER_NAME )
+};
+#undef PROFILE_MARKER_NAME
+
+/*
+ * Monotonic clock in nanoseconds.  Unlike gettimeofday() this never jumps
+ * when the system clock is adjusted.
+ */
+int64_t profile_now_ns( void ) {
+#if defined( WIN32 )
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if ( freq.QuadPart == 0 )
+        QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &now );
+    return (int64_t) ( (double) now.QuadPart * 1000000000.0 / (double) freq.QuadPart );
+#else
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
 /*
- * Helper: Get elapsed time in microseconds
+ * Histogram bucket for a value: exact below SUB_COUNT, then SUB_COUNT
+ * linear steps per power of two.
  */
-static long profile_elapsed_us( struct timeval *start, struct timeval *end ) {
-    return ( end->tv_sec - start->tv_sec ) * 1000000L
-         + ( end->tv_usec - start->tv_usec );
+static int profile_hist_index( long value ) {
+    int msb = 0, shift;
+
+    if ( value < PROFILE_HIST_SUB_COUNT )
+        return value < 0 ? 0 : (int) value;
+
+    while ( ( value >> ( msb + 1 ) ) != 0 )
+        msb++;
+    shift = msb - PROFILE_HIST_SUB_BITS;
+    if ( shift >= PROFILE_HIST_MAX_SHIFT )
+        return PROFILE_HIST_BUCKETS - 1;
+    return shift * PROFILE_HIST_SUB_COUNT + (int) ( value >> shift );
 }
 
 /*
- * Helper: Find or create a marker by name
+ * Highest value that maps to a bucket
  */
-static int profile_find_marker( const char *name ) {
+static long profile_hist_upper( int index ) {
+    int shift, sub;
+
+    if ( index < PROFILE_HIST_SUB_COUNT )
+        return index;
+    shift = index / PROFILE_HIST_SUB_COUNT - 1;
+    sub = index - shift * PROFILE_HIST_SUB_COUNT;
+    return ( (long) ( sub + 1 ) << shift ) - 1;
+}
+
+void profile_hist_record( PROFILE_HIST *hist, long value_us ) {
+    hist->counts[profile_hist_index( value_us )]++;
+    hist->total++;
+    if ( value_us > hist->max )
+        hist->max = value_us;
+}
+
+/*
+ * Value at the given percentile (0-100), accurate to the bucket width and
+ * never above the largest value recorded.
+ */
+long profile_hist_percentile( const PROFILE_HIST *hist, double pct ) {
+    long target, seen = 0;
+    long value;
     int i;
 
-    /* Search existing markers */
-    for ( i = 0; i < profile_stats.marker_count; i++ ) {
-        if ( !strcmp( profile_stats.markers[i].name, name ) )
-            return i;
-    }
+    if ( hist->total == 0 )
+        return 0;
+
+    target = (long) ceil( pct / 100.0 * hist->total );
+    if ( target < 1 )
+        target = 1;
 
-    /* Create new marker if room */
-    if ( profile_stats.marker_count < PROFILE_MAX_MARKERS ) {
-        i = profile_stats.marker_count++;
-        strncpy( profile_stats.markers[i].name, name, PROFILE_NAME_MAX - 1 );
-        profile_stats.markers[i].name[PROFILE_NAME_MAX - 1] = '\0';
-        profile_stats.markers[i].min_us = LONG_MAX;
-        profile_stats.markers[i].max_us = 0;
-        profile_stats.markers[i].total_us = 0;
-        profile_stats.markers[i].call_count = 0;
-        profile_stats.markers[i].active = FALSE;
-        return i;
+    for ( i = 0; i < PROFILE_HIST_BUCKETS; i++ ) {
+        seen += hist->counts[i];
+        if ( seen >= target )
+            break;
     }
 
-    return -1;  /* No room */
+    value = profile_hist_upper( i < PROFILE_HIST_BUCKETS ? i : PROFILE_HIST_BUCKETS - 1 );
+    return value < hist->max ? value : hist->max;
 }
 
 /*
@@ -79,10 +138,13 @@ void profile_init( void ) {
     profile_stats.verbose = FALSE;
     profile_stats.tick_multiplier = 1;  /* Normal speed */
     profile_stats.sample_start_time = current_time;
+    profile_stats.export_enabled = TRUE;
+    profile_stats.export_interval = PROFILE_EXPORT_INTERVAL;
 
-    /* Initialize marker min values */
+    /* Initialize marker names and min values */
     for ( i = 0; i < PROFILE_MAX_MARKERS; i++ ) {
-        profile_stats.markers[i].min_us = LONG_MAX;
+        profile_stats.markers[i].name = profile_marker_names[i];
+        profile_stats.markers[i].min_ns = INT64_MAX;
     }
 
     /* Initialize worst markers */
@@ -101,6 +163,8 @@ void profile_reset( void ) {
     bool was_verbose = profile_stats.verbose;
     long threshold = profile_stats.threshold_us;
     int tick_mult = profile_stats.tick_multiplier;
+    bool export_enabled = profile_stats.export_enabled;
+    int export_interval = profile_stats.export_interval;
 
     profile_init();
 
@@ -109,11 +173,15 @@ void profile_reset( void ) {
     profile_stats.threshold_us = threshold;
     profile_stats.tick_multiplier = tick_mult;
     profile_stats.sample_start_time = current_time;
+    profile_stats.export_enabled = export_enabled;
+    profile_stats.export_interval = export_interval;
 
     /* Clear per-area profiling stats */
     LIST_FOR_EACH( pArea, &g_areas, AREA_DATA, node ) {
         pArea->profile_reset_count = 0;
         pArea->profile_reset_time_us = 0;
+        pArea->profile_reset_pulses = 0;
+        pArea->profile_reset_slice_us = 0;
     }
 }
 
@@ -126,7 +194,7 @@ void profile_tick_start( void ) {
     if ( !profile_stats.enabled )
         return;
 
-    gettimeofday( &profile_stats.tick_start, NULL );
+    profile_stats.tick_start_ns = profile_now_ns();
     profile_stats.tick_active = TRUE;
 
     /* Reset worst markers for this tick */
@@ -140,20 +208,19 @@ void profile_tick_start( void ) {
  * End measuring a tick, log if overbudget
  */
 void profile_tick_end( void ) {
-    struct timeval now;
     long elapsed_us;
     char buf[MAX_STRING_LENGTH];
 
     if ( !profile_stats.enabled || !profile_stats.tick_active )
         return;
 
-    gettimeofday( &now, NULL );
-    elapsed_us = profile_elapsed_us( &profile_stats.tick_start, &now );
+    elapsed_us = (long) ( ( profile_now_ns() - profile_stats.tick_start_ns ) / 1000 );
     profile_stats.tick_active = FALSE;
 
     /* Update statistics */
     profile_stats.tick_count++;
     profile_stats.tick_total_us += elapsed_us;
+    profile_hist_record( &profile_stats.tick_hist, elapsed_us );
 
     if ( elapsed_us < profile_stats.tick_min_us )
         profile_stats.tick_min_us = elapsed_us;
@@ -200,53 +267,87 @@ void profile_tick_end( void ) {
             profile_stats.warnings_suppressed++;
         }
     }
+
+    /* Periodic snapshot for the admin page */
+    if ( profile_stats.export_enabled
+    &&   current_time - profile_stats.last_export_time >= profile_stats.export_interval ) {
+        profile_stats.last_export_time = current_time;
+        profile_export();
+    }
 }
 
 /*
- * Start measuring a named marker
+ * Start measuring a marker.  Markers nest: time spent inside an inner
+ * marker is charged to the outer marker's total but not its self time.
  */
-void profile_marker_start( const char *name ) {
-    int idx;
+void profile_marker_start( int id ) {
+    PROFILE_FRAME *f;
 
-    if ( !profile_stats.enabled )
+    if ( !profile_stats.enabled || id < 0 || id >= PROFILE_MAX_MARKERS )
         return;
 
-    idx = profile_find_marker( name );
-    if ( idx < 0 )
+    if ( profile_stats.depth >= PROFILE_STACK_MAX ) {
+        profile_stats.unbalanced++;
         return;
+    }
 
-    gettimeofday( &profile_stats.markers[idx].start_time, NULL );
-    profile_stats.markers[idx].active = TRUE;
+    f = &profile_stats.stack[profile_stats.depth++];
+    f->id = id;
+    f->child_ns = 0;
+    f->start_ns = profile_now_ns();
 }
 
 /*
- * End measuring a named marker
+ * End measuring a marker
  */
-void profile_marker_end( const char *name ) {
-    int idx, i, j;
-    struct timeval now;
+void profile_marker_end( int id ) {
+    int64_t now, elapsed_ns;
     long elapsed_us;
     PROFILE_MARKER *m;
+    PROFILE_FRAME *f;
+    int i, j, parent;
 
-    if ( !profile_stats.enabled )
+    if ( !profile_stats.enabled || id < 0 || id >= PROFILE_MAX_MARKERS )
         return;
 
-    idx = profile_find_marker( name );
-    if ( idx < 0 || !profile_stats.markers[idx].active )
+    now = profile_now_ns();
+
+    /* Innermost open frame for this marker */
+    for ( i = profile_stats.depth - 1; i >= 0; i-- ) {
+        if ( profile_stats.stack[i].id == id )
+            break;
+    }
+    if ( i < 0 ) {
+        profile_stats.unbalanced++;    /* END without START */
         return;
+    }
+
+    /* Frames opened inside it that never ended are dropped */
+    profile_stats.unbalanced += profile_stats.depth - 1 - i;
+    profile_stats.depth = i;
 
-    m = &profile_stats.markers[idx];
-    gettimeofday( &now, NULL );
-    elapsed_us = profile_elapsed_us( &m->start_time, &now );
-    m->active = FALSE;
+    f = &profile_stats.stack[i];
+    elapsed_ns = now - f->start_ns;
+    if ( elapsed_ns < 0 )
+        elapsed_ns = 0;
+    elapsed_us = (long) ( elapsed_ns / 1000 );
+
+    /* Parent/child attribution */
+    parent = i > 0 ? profile_stats.stack[i - 1].id : PROFILE_MAX_MARKERS;
+    if ( i > 0 )
+        profile_stats.stack[i - 1].child_ns += elapsed_ns;
+    profile_stats.parent_ns[parent][id] += elapsed_ns;
 
     /* Update marker statistics */
+    m = &profile_stats.markers[id];
     m->call_count++;
-    m->total_us += elapsed_us;
-    if ( elapsed_us < m->min_us )
-        m->min_us = elapsed_us;
-    if ( elapsed_us > m->max_us )
-        m->max_us = elapsed_us;
+    m->total_ns += elapsed_ns;
+    m->self_ns += elapsed_ns - f->child_ns;
+    if ( elapsed_ns < m->min_ns )
+        m->min_ns = elapsed_ns;
+    if ( elapsed_ns > m->max_ns )
+        m->max_ns = elapsed_ns;
+    profile_hist_record( &m->hist, elapsed_us );
 
     /* Track top 3 worst for this tick */
     for ( i = 0; i < 3; i++ ) {
@@ -256,7 +357,7 @@ void profile_marker_end( const char *name ) {
                 profile_stats.worst_markers[j] = profile_stats.worst_markers[j - 1];
                 profile_stats.worst_times[j] = profile_stats.worst_times[j - 1];
             }
-            profile_stats.worst_markers[i] = idx;
+            profile_stats.worst_markers[i] = id;
             profile_stats.worst_times[i] = elapsed_us;
             break;
         }
@@ -268,6 +369,7 @@ void profile_marker_end( const char *name ) {
  */
 void profile_set_enabled( bool enabled ) {
     profile_stats.enabled = enabled;
+    profile_stats.depth = 0;    /* Open frames straddle the toggle */
 }
 
 void profile_set_threshold( long threshold_ms ) {
@@ -328,49 +430,63 @@ void profile_report( CHAR_DATA *ch ) {
     snprintf( buf, sizeof( buf ), "  Min: %.2fms  Max: %.2fms\n\r",
         profile_stats.tick_min_us / 1000.0, profile_stats.tick_max_us / 1000.0 );
     send_to_char( buf, ch );
+    snprintf( buf, sizeof( buf ), "  p50: %.2fms  p90: %.2fms  p99: %.2fms  p99.9: %.2fms\n\r",
+        profile_hist_percentile( &profile_stats.tick_hist, 50.0 ) / 1000.0,
+        profile_hist_percentile( &profile_stats.tick_hist, 90.0 ) / 1000.0,
+        profile_hist_percentile( &profile_stats.tick_hist, 99.0 ) / 1000.0,
+        profile_hist_percentile( &profile_stats.tick_hist, 99.9 ) / 1000.0 );
+    send_to_char( buf, ch );
     snprintf( buf, sizeof( buf ), "  Overbudget: %ld ticks (%.1f%%)\n\r",
         profile_stats.tick_overbudget_count,
         100.0 * profile_stats.tick_overbudget_count / profile_stats.tick_count );
     send_to_char( buf, ch );
 
     /* Function breakdown */
-    if ( profile_stats.marker_count > 0 ) {
-        long total_work_us = 0;
-        const char *pct_basis = "tick";
-
-        /* Find game_loop_work marker to use as percentage basis */
-        for ( i = 0; i < profile_stats.marker_count; i++ ) {
-            if ( !strcmp( profile_stats.markers[i].name, "game_loop_work" ) ) {
-                total_work_us = profile_stats.markers[i].total_us;
-                pct_basis = "loop";
-                break;
-            }
-        }
-        /* Fall back to tick time if no game_loop marker */
-        if ( total_work_us == 0 )
-            total_work_us = profile_stats.tick_total_us;
+    {
+        int64_t total_work_ns = profile_stats.markers[PROF_GAME_LOOP_WORK].total_ns;
+        const char *pct_basis = "loop";
+        bool header = FALSE;
 
-        send_to_char( "\n\r#CFunction Breakdown:#n\n\r", ch );
-        snprintf( buf, sizeof( buf ), "  Name                 Calls     Avg(ms)   Max(ms)  %%(%s)\n\r", pct_basis );
-        send_to_char( buf, ch );
-        send_to_char( "  -------------------  --------  --------  -------  ------\n\r", ch );
+        /* Fall back to tick time if no game_loop marker */
+        if ( total_work_ns == 0 ) {
+            total_work_ns = (int64_t) profile_stats.tick_total_us * 1000;
+            pct_basis = "tick";
+        }
 
-        for ( i = 0; i < profile_stats.marker_count; i++ ) {
+        for ( i = 0; i < PROFILE_MAX_MARKERS; i++ ) {
             PROFILE_MARKER *m = &profile_stats.markers[i];
-            long avg_us;
-            double pct;
+            double avg_ms;
+            double pct, self_pct;
 
             if ( m->call_count == 0 )
                 continue;
 
-            avg_us = m->total_us / m->call_count;
-            pct = ( total_work_us > 0 )
-                ? 100.0 * m->total_us / total_work_us
+            if ( !header ) {
+                send_to_char( "\n\r#CFunction Breakdown:#n\n\r", ch );
+                snprintf( buf, sizeof( buf ), "  Name                 Calls     Avg(ms)   p99(ms)   Max(ms)  Self%%  %%(%s)\n\r", pct_basis );
+                send_to_char( buf, ch );
+                send_to_char( "  -------------------  --------  --------  --------  -------  -----  ------\n\r", ch );
+                header = TRUE;
+            }
+
+            avg_ms = m->total_ns / 1000000.0 / m->call_count;
+            pct = ( total_work_ns > 0 )
+                ? 100.0 * m->total_ns / total_work_ns
+                : 0.0;
+            self_pct = ( m->total_ns > 0 )
+                ? 100.0 * m->self_ns / m->total_ns
                 : 0.0;
 
-            snprintf( buf, sizeof( buf ), "  %-19s  %8ld  %8.2f  %7.2f  %5.1f%%\n\r",
-                m->name, m->call_count,
-                avg_us / 1000.0, m->max_us / 1000.0, pct );
+            snprintf( buf, sizeof( buf ), "  %-19s  %8ld  %8.2f  %8.2f  %7.2f  %4.0f%%  %5.1f%%\n\r",
+                m->name, m->call_count, avg_ms,
+                profile_hist_percentile( &m->hist, 99.0 ) / 1000.0,
+                m->max_ns / 1000000.0, self_pct, pct );
+            send_to_char( buf, ch );
+        }
+
+        if ( profile_stats.unbalanced > 0 ) {
+            snprintf( buf, sizeof( buf ), "  (%ld unbalanced START/END pairs ignored)\n\r",
+                profile_stats.unbalanced );
             send_to_char( buf, ch );
         }
     }
@@ -404,19 +520,23 @@ void profile_report( CHAR_DATA *ch ) {
 
         if ( top_count > 0 ) {
             send_to_char( "\n\r#CArea Reset Statistics:#n (top by total time)\n\r", ch );
-            send_to_char( "  Area                    Resets  Rooms  Total(ms)  Avg(ms)\n\r", ch );
-            send_to_char( "  ----------------------  ------  -----  ---------  -------\n\r", ch );
+            send_to_char( "  Area                    Resets  Rooms  Total(ms)  Avg(ms)  Pulses  Slice(ms)\n\r", ch );
+            send_to_char( "  ----------------------  ------  -----  ---------  -------  ------  ---------\n\r", ch );
 
             for ( j = 0; j < top_count && top_areas[j] != NULL; j++ ) {
                 pArea = top_areas[j];
                 double total_ms = pArea->profile_reset_time_us / 1000.0;
                 double avg_ms = pArea->profile_reset_count > 0
                     ? total_ms / pArea->profile_reset_count : 0.0;
-                snprintf( buf, sizeof( buf ), "  %-22s  %6ld  %5d  %9.2f  %7.2f\n\r",
+                /* Pulses: average spread of one reset; Slice: worst single pulse */
+                double avg_pulses = pArea->profile_reset_count > 0
+                    ? (double) pArea->profile_reset_pulses / pArea->profile_reset_count : 0.0;
+                snprintf( buf, sizeof( buf ), "  %-22s  %6ld  %5d  %9.2f  %7.2f  %6.1f  %9.2f\n\r",
                     pArea->name ? pArea->name : "Unknown",
                     pArea->profile_reset_count,
                     pArea->room_count,
-                    total_ms, avg_ms );
+                    total_ms, avg_ms, avg_pulses,
+                    pArea->profile_reset_slice_us / 1000.0 );
                 send_to_char( buf, ch );
             }
         }
@@ -437,15 +557,227 @@ void profile_report_brief( CHAR_DATA *ch ) {
 
     avg = profile_stats.tick_total_us / profile_stats.tick_count;
     snprintf( buf, sizeof( buf ),
-        "Ticks: %ld  Avg: %.1fms  Max: %.1fms  Overbudget: %ld\n\r",
+        "Ticks: %ld  Avg: %.1fms  p99: %.1fms  Max: %.1fms  Overbudget: %ld\n\r",
         profile_stats.tick_count, avg / 1000.0,
+        profile_hist_percentile( &profile_stats.tick_hist, 99.0 ) / 1000.0,
         profile_stats.tick_max_us / 1000.0,
         profile_stats.tick_overbudget_count );
     send_to_char( buf, ch );
 }
 
 /*
- * Admin command: profile [on|off|reset|verbose|threshold <ms>|speed <1-16>|report|brief]
+ * Print the markers that ran directly inside parent, largest first, and
+ * recurse into each.  A nested marker's own children are summed over all
+ * of its callers, so deep rows are an aggregate, not an exact call path.
+ */
+static void profile_tree_children( CHAR_DATA *ch, int parent, int depth, int64_t basis ) {
+    char buf[MAX_STRING_LENGTH];
+    bool shown[PROFILE_MAX_MARKERS];
+    int64_t ns;
+    int i, best;
+
+    memset( shown, 0, sizeof( shown ) );
+
+    for ( ;; ) {
+        best = -1;
+        for ( i = 0; i < PROFILE_MAX_MARKERS; i++ ) {
+            if ( shown[i] || profile_stats.parent_ns[parent][i] == 0 )
+                continue;
+            if ( best < 0 || profile_stats.parent_ns[parent][i] > profile_stats.parent_ns[parent][best] )
+                best = i;
+        }
+        if ( best < 0 )
+            break;
+        shown[best] = TRUE;
+
+        ns = profile_stats.parent_ns[parent][best];
+        snprintf( buf, sizeof( buf ), "  %*s%-*s  %10.2f  %5.1f%%\n\r",
+            depth * 2, "", 24 - depth * 2, profile_stats.markers[best].name,
+            ns / 1000000.0, basis > 0 ? 100.0 * ns / basis : 0.0 );
+        send_to_char( buf, ch );
+
+        if ( best != parent && depth < 5 )
+            profile_tree_children( ch, best, depth + 1, basis );
+    }
+}
+
+/*
+ * Nested marker report: where each marker's time went
+ */
+void profile_report_tree( CHAR_DATA *ch ) {
+    int64_t basis = 0;
+    int i;
+
+    for ( i = 0; i < PROFILE_MAX_MARKERS; i++ )
+        basis += profile_stats.parent_ns[PROFILE_MAX_MARKERS][i];
+
+    if ( basis == 0 ) {
+        send_to_char( "No profiling data.\n\r", ch );
+        return;
+    }
+
+    send_to_char( "#CMarker Tree:#n (time inside each parent)\n\r", ch );
+    send_to_char( "  Name                       Total(ms)   %All\n\r", ch );
+    send_to_char( "  ------------------------  ----------  ------\n\r", ch );
+    profile_tree_children( ch, PROFILE_MAX_MARKERS, 0, basis );
+}
+
+/*
+ * Snapshot writers.  Both formats carry the same numbers: tick latency
+ * quantiles plus per-marker call counts, totals, self time and quantiles.
+ */
+static const double profile_quantiles[] = { 50.0, 90.0, 99.0, 99.9 };
+#define PROFILE_QUANTILE_COUNT ( (int) ( sizeof( profile_quantiles ) / sizeof( profile_quantiles[0] ) ) )
+
+bool profile_write_prometheus( FILE *fp ) {
+    DB_WRITER_STATS dbw;
+    PROFILE_MARKER *m;
+    int i, q;
+
+    fprintf( fp, "# HELP dystopia_tick_seconds Game loop pulse duration.\n" );
+    fprintf( fp, "# TYPE dystopia_tick_seconds summary\n" );
+    for ( q = 0; q < PROFILE_QUANTILE_COUNT; q++ )
+        fprintf( fp, "dystopia_tick_seconds{quantile=\"%g\"} %.6f\n",
+            profile_quantiles[q] / 100.0,
+            profile_hist_percentile( &profile_stats.tick_hist, profile_quantiles[q] ) / 1e6 );
+    fprintf( fp, "dystopia_tick_seconds_sum %.6f\n", profile_stats.tick_total_us / 1e6 );
+    fprintf( fp, "dystopia_tick_seconds_count %ld\n", profile_stats.tick_count );
+
+    fprintf( fp, "# HELP dystopia_tick_overbudget_total Pulses slower than the warning threshold.\n" );
+    fprintf( fp, "# TYPE dystopia_tick_overbudget_total counter\n" );
+    fprintf( fp, "dystopia_tick_overbudget_total %ld\n", profile_stats.tick_overbudget_count );
+
+    fprintf( fp, "# HELP dystopia_marker_seconds Time per profiled section.\n" );
+    fprintf( fp, "# TYPE dystopia_marker_seconds summary\n" );
+    for ( i = 0; i < PROFILE_MAX_MARKERS; i++ ) {
+        m = &profile_stats.markers[i];
+        if ( m->call_count == 0 )
+            continue;
+        for ( q = 0; q < PROFILE_QUANTILE_COUNT; q++ )
+            fprintf( fp, "dystopia_marker_seconds{marker=\"%s\",quantile=\"%g\"} %.6f\n",
+                m->name, profile_quantiles[q] / 100.0,
+                profile_hist_percentile( &m->hist, profile_quantiles[q] ) / 1e6 );
+        fprintf( fp, "dystopia_marker_seconds_sum{marker=\"%s\"} %.6f\n", m->name, m->total_ns / 1e9 );
+        fprintf( fp, "dystopia_marker_seconds_count{marker=\"%s\"} %ld\n", m->name, m->call_count );
+    }
+
+    fprintf( fp, "# HELP dystopia_marker_self_seconds_total Time per section excluding nested sections.\n" );
+    fprintf( fp, "# TYPE dystopia_marker_self_seconds_total counter\n" );
+    for ( i = 0; i < PROFILE_MAX_MARKERS; i++ ) {
+        m = &profile_stats.markers[i];
+        if ( m->call_count > 0 )
+            fprintf( fp, "dystopia_marker_self_seconds_total{marker=\"%s\"} %.6f\n",
+                m->name, m->self_ns / 1e9 );
+    }
+
+    db_game_writer_stats( &dbw );
+    fprintf( fp, "# HELP dystopia_db_write_queue_depth game.db batches waiting for the writer.\n" );
+    fprintf( fp, "# TYPE dystopia_db_write_queue_depth gauge\n" );
+    fprintf( fp, "dystopia_db_write_queue_depth %d\n", dbw.depth );
+    fprintf( fp, "# HELP dystopia_db_write_batches_total game.db batches submitted, by outcome.\n" );
+    fprintf( fp, "# TYPE dystopia_db_write_batches_total counter\n" );
+    fprintf( fp, "dystopia_db_write_batches_total{result=\"queued\"} %ld\n", dbw.batches );
+    fprintf( fp, "dystopia_db_write_batches_total{result=\"coalesced\"} %ld\n", dbw.coalesced );
+    fprintf( fp, "# HELP dystopia_db_write_commits_total game.db group commits.\n" );
+    fprintf( fp, "# TYPE dystopia_db_write_commits_total counter\n" );
+    fprintf( fp, "dystopia_db_write_commits_total %ld\n", dbw.commits );
+
+    return !ferror( fp );
+}
+
+bool profile_write_json( FILE *fp ) {
+    DB_WRITER_STATS dbw;
+    PROFILE_MARKER *m;
+    bool first = TRUE;
+    int i;
+
+    fprintf( fp, "{\n" );
+    fprintf( fp, "  \"timestamp\": %ld,\n", (long) current_time );
+    fprintf( fp, "  \"sample_seconds\": %ld,\n", (long) ( current_time - profile_stats.sample_start_time ) );
+    fprintf( fp, "  \"enabled\": %s,\n", profile_stats.enabled ? "true" : "false" );
+    fprintf( fp, "  \"pulse_budget_us\": %d,\n", PROFILE_EXPECTED_PULSE_US );
+    fprintf( fp, "  \"tick_multiplier\": %d,\n", profile_stats.tick_multiplier );
+    fprintf( fp, "  \"tick\": {\"count\": %ld, \"avg_us\": %ld, \"min_us\": %ld, \"max_us\": %ld, "
+        "\"p50_us\": %ld, \"p90_us\": %ld, \"p99_us\": %ld, \"p999_us\": %ld, "
+        "\"overbudget\": %ld, \"threshold_us\": %ld},\n",
+        profile_stats.tick_count,
+        profile_stats.tick_count > 0 ? profile_stats.tick_total_us / profile_stats.tick_count : 0,
+        profile_stats.tick_count > 0 ? profile_stats.tick_min_us : 0,
+        profile_stats.tick_max_us,
+        profile_hist_percentile( &profile_stats.tick_hist, 50.0 ),
+        profile_hist_percentile( &profile_stats.tick_hist, 90.0 ),
+        profile_hist_percentile( &profile_stats.tick_hist, 99.0 ),
+        profile_hist_percentile( &profile_stats.tick_hist, 99.9 ),
+        profile_stats.tick_overbudget_count, profile_stats.threshold_us );
+
+    db_game_writer_stats( &dbw );
+    fprintf( fp, "  \"db_writer\": {\"depth\": %d, \"peak_depth\": %d, \"batches\": %ld, "
+        "\"coalesced\": %ld, \"commits\": %ld, \"errors\": %ld, \"commit_max_us\": %lld},\n",
+        dbw.depth, dbw.peak_depth, dbw.batches, dbw.coalesced, dbw.commits, dbw.errors,
+        dbw.commit_us_max );
+
+    fprintf( fp, "  \"markers\": [" );
+    for ( i = 0; i < PROFILE_MAX_MARKERS; i++ ) {
+        m = &profile_stats.markers[i];
+        if ( m->call_count == 0 )
+            continue;
+        fprintf( fp, "%s\n    {\"name\": \"%s\", \"calls\": %ld, \"total_us\": %lld, \"self_us\": %lld, "
+            "\"max_us\": %lld, \"p50_us\": %ld, \"p99_us\": %ld}",
+            first ? "" : ",", m->name, m->call_count,
+            (long long) ( m->total_ns / 1000 ), (long long) ( m->self_ns / 1000 ),
+            (long long) ( m->max_ns / 1000 ),
+            profile_hist_percentile( &m->hist, 50.0 ),
+            profile_hist_percentile( &m->hist, 99.0 ) );
+        first = FALSE;
+    }
+    fprintf( fp, "\n  ]\n}\n" );
+
+    return !ferror( fp );
+}
+
+/*
+ * Write one snapshot file via a temp file and rename, so readers never
+ * see a half-written snapshot.
+ */
+static bool profile_export_file( const char *filename, bool ( *writer )( FILE *fp ) ) {
+    char path[MUD_PATH_MAX];
+    char tmp[MUD_PATH_MAX + 8];
+    FILE *fp;
+    bool ok;
+
+    snprintf( path, sizeof( path ), "%s", mud_path( mud_run_dir, filename ) );
+    snprintf( tmp, sizeof( tmp ), "%s.tmp", path );
+
+    if ( ( fp = fopen( tmp, "w" ) ) == NULL )
+        return FALSE;
+    ok = writer( fp );
+    if ( fclose( fp ) != 0 )
+        ok = FALSE;
+#if defined( WIN32 )
+    remove( path );
+#endif
+    if ( !ok || rename( tmp, path ) != 0 ) {
+        remove( tmp );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Write profile.prom and profile.json to the run directory
+ */
+bool profile_export( void ) {
+    bool ok = TRUE;
+
+    if ( !profile_export_file( "profile.prom", profile_write_prometheus ) )
+        ok = FALSE;
+    if ( !profile_export_file( "profile.json", profile_write_json ) )
+        ok = FALSE;
+    return ok;
+}
+
+/*
+ * Admin command: profile [on|off|reset|verbose|threshold <ms>|speed <1-16>|report|brief|tree|export|sample|scripts|db]
  */
 void do_profile( CHAR_DATA *ch, char *argument ) {
     char arg[MAX_INPUT_LENGTH];
@@ -463,7 +795,7 @@ void do_profile( CHAR_DATA *ch, char *argument ) {
     }
 
     if ( !str_cmp( arg, "on" ) ) {
-        profile_stats.enabled = TRUE;
+        profile_set_enabled( TRUE );
         send_to_char( "Profiling enabled.\n\r", ch );
         snprintf( buf, sizeof( buf ), "%s enabled profiling", ch->name );
         log_string( buf );
@@ -471,7 +803,7 @@ void do_profile( CHAR_DATA *ch, char *argument ) {
     }
 
     if ( !str_cmp( arg, "off" ) ) {
-        profile_stats.enabled = FALSE;
+        profile_set_enabled( FALSE );
         send_to_char( "Profiling disabled.\n\r", ch );
         return;
     }
@@ -513,6 +845,96 @@ void do_profile( CHAR_DATA *ch, char *argument ) {
         return;
     }
 
+    if ( !str_cmp( arg, "tree" ) ) {
+        profile_report_tree( ch );
+        return;
+    }
+
+    if ( !str_cmp( arg, "export" ) ) {
+        argument = one_argument( argument, arg );
+        if ( !str_cmp( arg, "on" ) || !str_cmp( arg, "off" ) ) {
+            profile_stats.export_enabled = !str_cmp( arg, "on" );
+        }
+        else if ( !str_cmp( arg, "now" ) ) {
+            send_to_char( profile_export()
+                ? "Snapshot written.\n\r" : "Snapshot export failed.\n\r", ch );
+            return;
+        }
+        else if ( is_number( arg ) ) {
+            int secs = atoi( arg );
+            if ( secs < 1 || secs > 3600 ) {
+                send_to_char( "Export interval must be 1-3600 seconds.\n\r", ch );
+                return;
+            }
+            profile_stats.export_interval = secs;
+        }
+        else if ( arg[0] != '\0' ) {
+            send_to_char( "Usage: profile export [on|off|now|<seconds>]\n\r", ch );
+            return;
+        }
+        snprintf( buf, sizeof( buf ), "Snapshot export %s, every %ds, to %s (profile.json, profile.prom).\n\r",
+            profile_stats.export_enabled ? "on" : "off",
+            profile_stats.export_interval, mud_run_dir );
+        send_to_char( buf, ch );
+        return;
+    }
+
+    if ( !str_cmp( arg, "sample" ) ) {
+        char path[MUD_PATH_MAX];
+        int secs, count;
+
+        argument = one_argument( argument, arg );
+        if ( !str_cmp( arg, "stop" ) ) {
+            if ( !profile_sample_active() ) {
+                send_to_char( "No sampling window is running.\n\r", ch );
+                return;
+            }
+            count = profile_sample_stop( path, sizeof( path ) );
+            snprintf( buf, sizeof( buf ), path[0] != '\0'
+                ? "Sampling stopped: %d samples written to %s.\n\r"
+                : "Sampling stopped: %d samples, could not write file%s.\n\r",
+                count, path );
+            send_to_char( buf, ch );
+            return;
+        }
+        if ( arg[0] == '\0' || !is_number( arg ) ) {
+            send_to_char( "Usage: profile sample <seconds>|stop\n\r", ch );
+            return;
+        }
+        secs = atoi( arg );
+        if ( secs < 1 || secs > PROFILE_SAMPLE_MAX_SECS ) {
+            snprintf( buf, sizeof( buf ), "Sample window must be 1-%d seconds.\n\r",
+                PROFILE_SAMPLE_MAX_SECS );
+            send_to_char( buf, ch );
+            return;
+        }
+        if ( profile_sample_active() ) {
+            send_to_char( "A sampling window is already running.\n\r", ch );
+            return;
+        }
+        if ( !profile_sample_start( secs, ch->name ) ) {
+            send_to_char( "Sampling profiler unavailable on this platform.\n\r", ch );
+            return;
+        }
+        snprintf( buf, sizeof( buf ),
+            "Sampling the game loop at %dHz for %ds; folded stacks go to %s.\n\r",
+            PROFILE_SAMPLE_HZ, secs, mud_log_dir );
+        send_to_char( buf, ch );
+        snprintf( buf, sizeof( buf ), "%s started a %ds sampling profile", ch->name, secs );
+        log_string( buf );
+        return;
+    }
+
+    if ( !str_cmp( arg, "scripts" ) ) {
+        script_report( ch );
+        return;
+    }
+
+    if ( !str_cmp( arg, "db" ) ) {
+        db_game_writer_report( ch );
+        return;
+    }
+
     if ( !str_cmp( arg, "speed" ) ) {
         int mult;
         argument = one_argument( argument, arg );
@@ -538,5 +960,5 @@ void do_profile( CHAR_DATA *ch, char *argument ) {
         return;
     }
 
-    send_to_char( "Usage: profile [on|off|reset|verbose|threshold <ms>|speed <1-16>|report|brief]\n\r", ch );
+    send_to_char( "Usage: profile [on|off|reset|verbose|threshold <ms>|speed <1-16>|report|brief|tree|export|sample|scripts|db]\n\r", ch );
 }
@@ -26,10 +26,54 @@
 #define PROFILE_H
 
 #include <limits.h>
+#include <stdint.h>
 
-/* Maximum number of named profiling markers */
-#define PROFILE_MAX_MARKERS     32
-#define PROFILE_NAME_MAX        32
+/*
+ * Profiling markers.  Each marker has a compile-time ID so PROFILE_START and
+ * PROFILE_END index straight into the marker table instead of looking the
+ * name up on every call.  Add new markers here.
+ */
+#define PROFILE_MARKER_LIST( X ) \
+    X( PROF_GAME_LOOP_WORK,    "game_loop_work"    ) \
+    X( PROF_CMD_DISPATCH,      "cmd_dispatch"      ) \
+    X( PROF_VIOLENCE_UPDATE,   "violence_update"   ) \
+    X( PROF_VIOLENCE_COMBAT,   "violence_combat"   ) \
+    X( PROF_GROUP_ASSIST,      "group_assist"      ) \
+    X( PROF_CHAR_UPDATE,       "char_update"       ) \
+    X( PROF_MOBILE_UPDATE,     "mobile_update"     ) \
+    X( PROF_MOB_PLAYER_UPD,    "mob_player_upd"    ) \
+    X( PROF_MOB_NPC_AI,        "mob_npc_ai"        ) \
+    X( PROF_MOB_NPC_SCAVENGE,  "mob_npc_scavenge"  ) \
+    X( PROF_MOB_NPC_MOVE,      "mob_npc_move"      ) \
+    X( PROF_OBJ_UPDATE,        "obj_update"        ) \
+    X( PROF_WW_UPDATE,         "ww_update"         ) \
+    X( PROF_OBJ_SCRIPT_TICK,   "obj_script_tick"   ) \
+    X( PROF_AREA_UPDATE,       "area_update"       ) \
+    X( PROF_AREA_RESET,        "area_reset"        ) \
+    X( PROF_RESET_ROOM,        "reset_room"        ) \
+    X( PROF_SCRIPT_TICK,       "script_tick"       ) \
+    X( PROF_SCRIPT_SCHEDULER,  "script_scheduler"  ) \
+    X( PROF_LUA_EXEC,          "lua_exec"          ) \
+    X( PROF_LUA_COMPILE,       "lua_compile"       ) \
+    X( PROF_DB_PLAYER_SAVE,    "db_player_save"    ) \
+    X( PROF_SAVE_DELETE_ALL,   "save_delete_all"   ) \
+    X( PROF_SAVE_PLAYER_ROW,   "save_player_row"   ) \
+    X( PROF_SAVE_ARRAYS,       "save_arrays"       ) \
+    X( PROF_SAVE_SKILLS,       "save_skills"       ) \
+    X( PROF_SAVE_ALIASES,      "save_aliases"      ) \
+    X( PROF_SAVE_AFFECTS,      "save_affects"      ) \
+    X( PROF_SAVE_BOARDS,       "save_boards"       ) \
+    X( PROF_SAVE_OBJECTS,      "save_objects"      )
+
+#define PROFILE_MARKER_ENUM( id, name ) id,
+typedef enum {
+    PROFILE_MARKER_LIST( PROFILE_MARKER_ENUM )
+    PROFILE_MAX_MARKERS
+} PROFILE_MARKER_ID;
+#undef PROFILE_MARKER_ENUM
+
+/* Deepest marker nesting tracked for parent/child attribution */
+#define PROFILE_STACK_MAX       16
 
 /* Default threshold for warning (microseconds) - 300ms */
 #define PROFILE_DEFAULT_THRESHOLD_US  300000
@@ -40,22 +84,53 @@
 /* Minimum interval between warnings (seconds) to avoid spam */
 #define PROFILE_WARNING_INTERVAL      60
 
+/* Default interval between metric snapshot exports (seconds) */
+#define PROFILE_EXPORT_INTERVAL       10
+
 /* Expected pulse duration in microseconds (250ms for 4 pulses/sec) */
 #define PROFILE_EXPECTED_PULSE_US     (1000000 / PULSE_PER_SECOND)
 
+/*
+ * HDR-style latency histogram, in microseconds.
+ *
+ * Values below 2^SUB_BITS get one bucket each; every power of two above that
+ * is split into 2^SUB_BITS linear buckets, so any recorded value is known to
+ * within ~3% across the whole range (1us .. ~134s).  Larger values land in
+ * the last bucket.
+ */
+#define PROFILE_HIST_SUB_BITS   5
+#define PROFILE_HIST_SUB_COUNT  ( 1 << PROFILE_HIST_SUB_BITS )
+#define PROFILE_HIST_MAX_SHIFT  22
+#define PROFILE_HIST_BUCKETS    ( ( PROFILE_HIST_MAX_SHIFT + 1 ) * PROFILE_HIST_SUB_COUNT )
+
+typedef struct profile_hist_data {
+    uint32_t        counts[PROFILE_HIST_BUCKETS];
+    long            total;                  /* Values recorded */
+    long            max;                    /* Largest value recorded */
+} PROFILE_HIST;
+
 /*
  * Statistics for a single profiling marker
  */
 typedef struct profile_marker_data {
-    char            name[PROFILE_NAME_MAX]; /* Marker name (e.g., "violence_update") */
-    long            total_us;               /* Total accumulated time (microseconds) */
-    long            min_us;                 /* Minimum single call time */
-    long            max_us;                 /* Maximum single call time */
+    const char     *name;                   /* Marker name (e.g., "violence_update") */
+    int64_t         total_ns;               /* Total accumulated time */
+    int64_t         self_ns;                /* Total minus time spent in nested markers */
+    int64_t         min_ns;                 /* Minimum single call time */
+    int64_t         max_ns;                 /* Maximum single call time */
     long            call_count;             /* Number of times called */
-    struct timeval  start_time;             /* Start timestamp for current measurement */
-    bool            active;                 /* Currently being measured */
+    PROFILE_HIST    hist;                   /* Per-call latency distribution */
 } PROFILE_MARKER;
 
+/*
+ * An open PROFILE_START waiting for its PROFILE_END
+ */
+typedef struct profile_frame_data {
+    int             id;                     /* Marker ID */
+    int64_t         start_ns;               /* Start timestamp */
+    int64_t         child_ns;               /* Time spent in nested markers so far */
+} PROFILE_FRAME;
+
 /*
  * Global profiling statistics
  */
@@ -66,6 +141,7 @@ typedef struct profile_stats_data {
     long            tick_min_us;            /* Fastest tick */
     long            tick_max_us;            /* Slowest tick */
     long            tick_overbudget_count;  /* Ticks exceeding threshold */
+    PROFILE_HIST    tick_hist;              /* Tick latency distribution */
 
     /* Configuration */
     long            threshold_us;           /* Warning threshold (microseconds) */
@@ -78,17 +154,31 @@ typedef struct profile_stats_data {
     time_t          last_warning_time;      /* Last time a warning was logged */
     int             warnings_suppressed;    /* Warnings suppressed since last log */
 
-    /* Per-function markers */
+    /* Per-function markers, indexed by PROFILE_MARKER_ID */
     PROFILE_MARKER  markers[PROFILE_MAX_MARKERS];
-    int             marker_count;
+
+    /*
+     * Nesting: open markers, innermost last.  parent_ns[p][c] is the time
+     * marker c ran while p was its immediate parent; row PROFILE_MAX_MARKERS
+     * holds calls made outside any other marker.
+     */
+    PROFILE_FRAME   stack[PROFILE_STACK_MAX];
+    int             depth;
+    long            unbalanced;             /* ENDs with no matching START, dropped frames */
+    int64_t         parent_ns[PROFILE_MAX_MARKERS + 1][PROFILE_MAX_MARKERS];
 
     /* Current tick tracking */
-    struct timeval  tick_start;             /* When current tick started */
+    int64_t         tick_start_ns;          /* When current tick started */
     bool            tick_active;            /* Currently measuring a tick */
 
     /* Top offenders tracking (for drill-down) */
     int             worst_markers[3];       /* Indices of 3 worst markers this tick */
     long            worst_times[3];         /* Times for worst markers this tick */
+
+    /* Periodic snapshot export (survives profile_reset) */
+    bool            export_enabled;         /* Write snapshots while profiling */
+    int             export_interval;        /* Seconds between snapshots */
+    time_t          last_export_time;       /* When the last snapshot was written */
 } PROFILE_STATS;
 
 /* Global profiling state */
@@ -98,7 +188,7 @@ extern PROFILE_STATS profile_stats;
  * Profiling Macros - Lightweight when disabled
  *
  * These macros check the enabled flag first, so there's minimal
- * overhead when profiling is turned off.
+ * overhead when profiling is turned off.  Markers are PROF_* IDs.
  */
 #define PROFILE_TICK_START() \
     do { if (profile_stats.enabled) profile_tick_start(); } while(0)
@@ -106,11 +196,11 @@ extern PROFILE_STATS profile_stats;
 #define PROFILE_TICK_END() \
     do { if (profile_stats.enabled) profile_tick_end(); } while(0)
 
-#define PROFILE_START(name) \
-    do { if (profile_stats.enabled) profile_marker_start(name); } while(0)
+#define PROFILE_START(id) \
+    do { if (profile_stats.enabled) profile_marker_start(id); } while(0)
 
-#define PROFILE_END(name) \
-    do { if (profile_stats.enabled) profile_marker_end(name); } while(0)
+#define PROFILE_END(id) \
+    do { if (profile_stats.enabled) profile_marker_end(id); } while(0)
 
 /*
  * Function Prototypes
@@ -120,13 +210,20 @@ extern PROFILE_STATS profile_stats;
 void    profile_init        ( void );
 void    profile_reset       ( void );
 
+/* Monotonic clock in nanoseconds */
+int64_t profile_now_ns      ( void );
+
 /* Tick-level profiling */
 void    profile_tick_start  ( void );
 void    profile_tick_end    ( void );
 
 /* Marker-level profiling */
-void    profile_marker_start( const char *name );
-void    profile_marker_end  ( const char *name );
+void    profile_marker_start( int id );
+void    profile_marker_end  ( int id );
+
+/* Histograms */
+void    profile_hist_record ( PROFILE_HIST *hist, long value_us );
+long    profile_hist_percentile( const PROFILE_HIST *hist, double pct );
 
 /* Configuration */
 void    profile_set_enabled ( bool enabled );
@@ -136,5 +233,29 @@ void    profile_set_verbose ( bool verbose );
 /* Reporting */
 void    profile_report      ( CHAR_DATA *ch );
 void    profile_report_brief( CHAR_DATA *ch );
+void    profile_report_tree ( CHAR_DATA *ch );
+
+/*
+ * Sampling profiler (profile_sample.c): SIGPROF backtraces for a bounded
+ * window, written as folded stacks to the log directory.  Linux/glibc only;
+ * elsewhere profile_sample_start() returns FALSE.
+ */
+#define PROFILE_SAMPLE_HZ       200
+#define PROFILE_SAMPLE_DEPTH    48
+#define PROFILE_SAMPLE_MAX_SECS 120
+
+extern volatile int profile_current_cmd;    /* cmd_table index in interpret(), or -1 */
+
+bool    profile_sample_start( int seconds, const char *owner );
+bool    profile_sample_active( void );
+int     profile_sample_count( void );
+int     profile_sample_write( FILE *fp );
+int     profile_sample_stop ( char *path, size_t pathlen );
+void    profile_sample_pulse( void );
+
+/* Snapshot export for server/www (Prometheus text and JSON) */
+bool    profile_export      ( void );
+bool    profile_write_prometheus( FILE *fp );
+bool    profile_write_json  ( FILE *fp );
 
 #endif /* PROFILE_H */
@@ -0,0 +1,381 @@
+/***************************************************************************
+ *  profile_sample.c - Sampling profiler for the game loop                 *
+ *                                                                         *
+ *  PROFILE_START/PROFILE_END only see code someone instrumented.  This    *
+ *  arms a SIGPROF interval timer for a bounded window; each tick the      *
+ *  signal handler captures a backtrace of the main thread into a buffer   *
+ *  allocated before the timer starts, plus the command being run and the  *
+ *  open profiler markers.  When the window closes the samples are         *
+ *  symbolized and written as folded stacks ("a;b;c count") that          *
+ *  flamegraph.pl, speedscope and inferno read directly.                   *
+ ***************************************************************************/
+
+#if !defined( WIN32 )
+#define _GNU_SOURCE
+#endif
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "../core/merc.h"
+#include "profile.h"
+
+#if !defined( WIN32 ) && defined( __GLIBC__ )
+#define PROFILE_SAMPLE_SUPPORTED
+#include <signal.h>
+#include <sys/time.h>
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <link.h>
+#endif
+
+/* Command currently in interpret(), -1 when none (read by the handler) */
+volatile int profile_current_cmd = -1;
+
+#if defined( PROFILE_SAMPLE_SUPPORTED )
+
+/* Frames skipped at the top of each backtrace: the handler and the
+ * kernel's signal trampoline */
+#define SAMPLE_SKIP_FRAMES      2
+
+/* Cap on markers recorded per sample (outermost first) */
+#define SAMPLE_MAX_MARKERS      8
+
+typedef struct profile_sample_data {
+    void           *pc[PROFILE_SAMPLE_DEPTH];
+    short           depth;
+    short           cmd;                    /* cmd_table index or -1 */
+    short           markers[SAMPLE_MAX_MARKERS];
+    short           marker_depth;
+} PROFILE_SAMPLE;
+
+static PROFILE_SAMPLE  *samples;
+static int              sample_max;
+static volatile int     sample_count;
+static volatile long    sample_dropped;     /* Buffer full or off-thread */
+static volatile bool    sample_armed;
+static pthread_t        sample_thread;
+static time_t           sample_end_time;
+static bool             sample_was_enabled; /* Profiling state to restore */
+static char             sample_owner[MAX_INPUT_LENGTH];
+static struct sigaction sample_old_action;
+
+/*
+ * SIGPROF handler.  Only touches preallocated memory and plain integers.
+ * backtrace() is primed once before the timer is armed so its lazy
+ * libgcc load never happens inside the handler.
+ */
+static void profile_sample_handler( int sig ) {
+    PROFILE_SAMPLE *s;
+    void *frames[PROFILE_SAMPLE_DEPTH + SAMPLE_SKIP_FRAMES];
+    int n, i, idx, saved_errno = errno;
+
+    (void) sig;
+
+    if ( !sample_armed || !pthread_equal( pthread_self(), sample_thread ) ) {
+        sample_dropped++;
+        errno = saved_errno;
+        return;
+    }
+
+    idx = sample_count;
+    if ( idx >= sample_max ) {
+        sample_dropped++;
+        errno = saved_errno;
+        return;
+    }
+
+    s = &samples[idx];
+    n = backtrace( frames, PROFILE_SAMPLE_DEPTH + SAMPLE_SKIP_FRAMES );
+    n -= SAMPLE_SKIP_FRAMES;
+    if ( n < 0 )
+        n = 0;
+    for ( i = 0; i < n; i++ )
+        s->pc[i] = frames[i + SAMPLE_SKIP_FRAMES];
+    s->depth = (short) n;
+    s->cmd = (short) profile_current_cmd;
+
+    n = profile_stats.depth;
+    if ( n > SAMPLE_MAX_MARKERS )
+        n = SAMPLE_MAX_MARKERS;
+    for ( i = 0; i < n; i++ )
+        s->markers[i] = (short) profile_stats.stack[i].id;
+    s->marker_depth = (short) n;
+
+    sample_count = idx + 1;
+    errno = saved_errno;
+}
+
+static void profile_sample_disarm( void ) {
+    struct itimerval tv;
+
+    memset( &tv, 0, sizeof( tv ) );
+    setitimer( ITIMER_PROF, &tv, NULL );
+    sample_armed = FALSE;
+    sigaction( SIGPROF, &sample_old_action, NULL );
+}
+
+bool profile_sample_start( int seconds, const char *owner ) {
+    struct sigaction sa;
+    struct itimerval tv;
+    void *prime[4];
+
+    if ( samples != NULL || seconds < 1 )
+        return FALSE;
+
+    sample_max = seconds * PROFILE_SAMPLE_HZ + PROFILE_SAMPLE_HZ;
+    samples = calloc( sample_max, sizeof( PROFILE_SAMPLE ) );
+    if ( samples == NULL )
+        return FALSE;
+
+    sample_count = 0;
+    sample_dropped = 0;
+    sample_thread = pthread_self();
+    sample_end_time = current_time + seconds;
+    snprintf( sample_owner, sizeof( sample_owner ), "%s", owner ? owner : "" );
+
+    /* Marker tags come from the profiler's marker stack */
+    sample_was_enabled = profile_stats.enabled;
+    if ( !profile_stats.enabled )
+        profile_set_enabled( TRUE );
+
+    backtrace( prime, 4 );
+
+    memset( &sa, 0, sizeof( sa ) );
+    sa.sa_handler = profile_sample_handler;
+    sigemptyset( &sa.sa_mask );
+    sa.sa_flags = SA_RESTART;
+    if ( sigaction( SIGPROF, &sa, &sample_old_action ) != 0 ) {
+        free( samples );
+        samples = NULL;
+        return FALSE;
+    }
+
+    sample_armed = TRUE;
+    tv.it_interval.tv_sec = 0;
+    tv.it_interval.tv_usec = 1000000 / PROFILE_SAMPLE_HZ;
+    tv.it_value = tv.it_interval;
+    if ( setitimer( ITIMER_PROF, &tv, NULL ) != 0 ) {
+        profile_sample_disarm();
+        free( samples );
+        samples = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+bool profile_sample_active( void ) {
+    return samples != NULL;
+}
+
+int profile_sample_count( void ) {
+    return sample_count;
+}
+
+/*
+ * Symbol for one return address: the exported name when the address is
+ * inside that symbol (the game links with -rdynamic), otherwise
+ * module+offset, which addr2line resolves.  Static functions take the
+ * second form.
+ */
+typedef struct sample_symbol_data {
+    void           *pc;
+    char           *name;
+} SAMPLE_SYMBOL;
+
+#define SAMPLE_SYMBOL_HASH      4096
+
+static const char *sample_symbol( SAMPLE_SYMBOL *table, void *pc ) {
+    static char buf[256];
+    Dl_info info;
+    ElfW(Sym) *sym = NULL;
+    const char *base;
+    unsigned int h = (unsigned int) ( ( (uintptr_t) pc >> 4 ) % SAMPLE_SYMBOL_HASH );
+    int probes;
+
+    for ( probes = 0; probes < SAMPLE_SYMBOL_HASH && table[h].pc != NULL; probes++ ) {
+        if ( table[h].pc == pc )
+            return table[h].name;
+        h = ( h + 1 ) % SAMPLE_SYMBOL_HASH;
+    }
+
+    if ( !dladdr1( pc, &info, (void **) &sym, RTLD_DL_SYMENT ) ) {
+        snprintf( buf, sizeof( buf ), "0x%lx", (unsigned long) (uintptr_t) pc );
+    }
+    else if ( info.dli_sname != NULL && sym != NULL
+    &&   (char *) pc < (char *) info.dli_saddr + sym->st_size ) {
+        snprintf( buf, sizeof( buf ), "%s", info.dli_sname );
+    }
+    else {
+        base = info.dli_fname ? strrchr( info.dli_fname, '/' ) : NULL;
+        snprintf( buf, sizeof( buf ), "%s+0x%lx",
+            base ? base + 1 : ( info.dli_fname ? info.dli_fname : "?" ),
+            (unsigned long) ( (char *) pc - (char *) info.dli_fbase ) );
+    }
+
+    /* Table full: still answer, just uncached */
+    if ( table[h].pc != NULL )
+        return buf;
+    table[h].pc = pc;
+    table[h].name = str_dup( buf );
+    return table[h].name;
+}
+
+static int sample_line_cmp( const void *a, const void *b ) {
+    return strcmp( *(char * const *) a, *(char * const *) b );
+}
+
+/*
+ * Write collected samples as folded stacks, root first:
+ *   [cmd kill];[violence_update];main;game_loop;...;one_hit 12
+ * Samples outside any command get no [cmd] frame.
+ */
+int profile_sample_write( FILE *fp ) {
+    SAMPLE_SYMBOL *table;
+    char **lines;
+    char line[MAX_STRING_LENGTH];
+    size_t len;
+    int count = sample_count;
+    int i, j, run;
+
+    if ( samples == NULL || count == 0 )
+        return 0;
+
+    table = calloc( SAMPLE_SYMBOL_HASH, sizeof( SAMPLE_SYMBOL ) );
+    lines = calloc( count, sizeof( char * ) );
+    if ( table == NULL || lines == NULL ) {
+        free( table );
+        free( lines );
+        return 0;
+    }
+
+    for ( i = 0; i < count; i++ ) {
+        PROFILE_SAMPLE *s = &samples[i];
+
+        line[0] = '\0';
+        len = 0;
+        if ( s->cmd >= 0 )
+            len += snprintf( line + len, sizeof( line ) - len, "[cmd %s];", cmd_table[s->cmd].name );
+        for ( j = 0; j < s->marker_depth && len < sizeof( line ); j++ )
+            len += snprintf( line + len, sizeof( line ) - len, "[%s];",
+                profile_stats.markers[s->markers[j]].name );
+        /* backtrace() is leaf first; folded stacks are root first */
+        for ( j = s->depth - 1; j >= 0 && len < sizeof( line ); j-- )
+            len += snprintf( line + len, sizeof( line ) - len, "%s;",
+                sample_symbol( table, s->pc[j] ) );
+        if ( len >= sizeof( line ) )
+            len = sizeof( line ) - 1;
+        if ( len > 0 && line[len - 1] == ';' )
+            line[--len] = '\0';
+        lines[i] = str_dup( line[0] != '\0' ? line : "[unknown]" );
+    }
+
+    qsort( lines, count, sizeof( char * ), sample_line_cmp );
+    for ( i = 0; i < count; i = j ) {
+        for ( j = i + 1; j < count && !strcmp( lines[i], lines[j] ); j++ )
+            ;
+        run = j - i;
+        fprintf( fp, "%s %d\n", lines[i], run );
+    }
+
+    for ( i = 0; i < count; i++ )
+        free( lines[i] );
+    for ( i = 0; i < SAMPLE_SYMBOL_HASH; i++ ) {
+        if ( table[i].name != NULL )
+            free( table[i].name );
+    }
+    free( lines );
+    free( table );
+    return count;
+}
+
+/*
+ * Stop sampling.  With a path buffer, write the folded file to the log
+ * directory and return its name there.  Returns the sample count.
+ */
+int profile_sample_stop( char *path, size_t pathlen ) {
+    char filename[64];
+    struct tm *tm;
+    FILE *fp;
+    int count;
+
+    if ( samples == NULL )
+        return 0;
+
+    profile_sample_disarm();
+    if ( !sample_was_enabled )
+        profile_set_enabled( FALSE );
+
+    count = sample_count;
+    if ( path != NULL && pathlen > 0 ) {
+        path[0] = '\0';
+        tm = localtime( &current_time );
+        strftime( filename, sizeof( filename ), "profile-%Y%m%d-%H%M%S.folded", tm );
+        snprintf( path, pathlen, "%s", mud_path( mud_log_dir, filename ) );
+        if ( ( fp = fopen( path, "w" ) ) != NULL ) {
+            profile_sample_write( fp );
+            fclose( fp );
+        }
+        else {
+            path[0] = '\0';
+        }
+    }
+
+    free( samples );
+    samples = NULL;
+    sample_count = 0;
+    return count;
+}
+
+/*
+ * Called once per pulse: close the window when its time is up
+ */
+void profile_sample_pulse( void ) {
+    char path[MUD_PATH_MAX];
+    char buf[MAX_STRING_LENGTH];
+    DESCRIPTOR_DATA *d;
+    long dropped = sample_dropped;
+    int count;
+
+    if ( samples == NULL || current_time < sample_end_time )
+        return;
+
+    count = profile_sample_stop( path, sizeof( path ) );
+    if ( path[0] != '\0' )
+        snprintf( buf, sizeof( buf ), "Sampling profile: %d samples (%ld dropped) written to %s",
+            count, dropped, path );
+    else
+        snprintf( buf, sizeof( buf ), "Sampling profile: could not write %d samples", count );
+    log_string( buf );
+
+    LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node ) {
+        if ( d->connected == CON_PLAYING && d->character != NULL
+        &&   !str_cmp( d->character->name, sample_owner ) ) {
+            send_to_char( buf, d->character );
+            send_to_char( "\n\r", d->character );
+        }
+    }
+}
+
+#else /* !PROFILE_SAMPLE_SUPPORTED */
+
+bool profile_sample_start( int seconds, const char *owner ) {
+    (void) seconds;
+    (void) owner;
+    return FALSE;
+}
+
+bool profile_sample_active( void ) { return FALSE; }
+int  profile_sample_count( void ) { return 0; }
+int  profile_sample_write( FILE *fp ) { (void) fp; return 0; }
+void profile_sample_pulse( void ) { }
+
+int profile_sample_stop( char *path, size_t pathlen ) {
+    if ( path != NULL && pathlen > 0 )
+        path[0] = '\0';
+    return 0;
+}
+
+#endif
@@ -491,6 +491,7 @@ static void quest_auto_complete( CHAR_DATA *ch, int quest_index ) {
     /* Complete and award */
     p->status       = QSTATUS_TURNED_IN;
     p->completed_at = (int) current_time;
+    quest_tracker_touch( ch->pcdata->quest_tracker );
 
     snprintf( buf, sizeof( buf ),
         "\n\r  #tFFD700" U_STAR " Quest Complete: #x035%s #tFFD700" U_STAR "#n\n\r", q->name );
@@ -498,7 +499,7 @@ static void quest_auto_complete( CHAR_DATA *ch, int quest_index ) {
     quest_award_rewards( ch, q );
 
     /* Track quest completion for COMPLETE_QUEST objectives */
-    quest_check_progress( ch, QOBJ_COMPLETE_QUEST, q->id, 1 );
+    quest_check_progress( ch, QOT_COMPLETE_QUEST, q->id, 1 );
 
     /* Re-evaluate availability for cascading unlocks */
     quest_evaluate_availability( ch );
@@ -511,50 +512,84 @@ static void quest_auto_complete( CHAR_DATA *ch, int quest_index ) {
  * Event Hook: quest_check_progress
  *--------------------------------------------------------------------------*/
 
-void quest_check_progress( CHAR_DATA *ch, const char *type,
+/* First entry after 'after' with an open objective of this type, or -1.
+ * Slots of one type are in entry order, so this is a binary search. */
+static int quest_next_open_entry( QUEST_TRACKER *t, int type, int after ) {
+    int lo, hi;
+
+    quest_index_refresh( t );
+    lo = t->slot_start[type];
+    hi = t->slot_start[type + 1];
+    while ( lo < hi ) {
+        int mid = ( lo + hi ) / 2;
+        if ( t->slots[mid].entry <= after )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < t->slot_start[type + 1] ? t->slots[lo].entry : -1;
+}
+
+void quest_check_progress( CHAR_DATA *ch, int type,
                            const char *target, int value ) {
     QUEST_TRACKER *tracker;
-    int i, j;
+    int atom, i;
 
     if ( IS_NPC( ch ) || !ch->pcdata || !ch->pcdata->quest_tracker )
         return;
+    if ( type <= QOT_NONE || type >= QOT_MAX )
+        return;
 
     tracker = ch->pcdata->quest_tracker;
 
-    for ( i = 0; i < tracker->count; i++ ) {
+    /* Nothing open for this event: the common case */
+    if ( quest_open_count( tracker, type ) == 0 )
+        return;
+
+    atom = quest_atom_find( target );
+
+    /*
+     * One entry at a time, re-reading the index each step: auto-complete
+     * can recurse back in here and activate further quests, and those are
+     * still seen if they come later in the tracker, as before.
+     */
+    for ( i = quest_next_open_entry( tracker, type, -1 ); i >= 0;
+          i = quest_next_open_entry( tracker, type, i ) ) {
         QUEST_PROGRESS *p = &tracker->entries[i];
-        const QUEST_DEF *q;
+        const QUEST_DEF *q = quest_def_by_index( p->quest_index );
+        bool closed = FALSE;
+        int j;
 
-        if ( p->status != QSTATUS_ACTIVE )
+        if ( !q || p->status != QSTATUS_ACTIVE )
             continue;
 
-        q = quest_def_by_index( p->quest_index );
-        if ( !q ) continue;
-
         for ( j = 0; j < q->obj_count; j++ ) {
-            QUEST_OBJ_DEF *obj = (QUEST_OBJ_DEF *)&q->objectives[j];
+            const QUEST_OBJ_DEF *obj = &q->objectives[j];
 
             /* Already met this objective */
             if ( p->obj_progress[j].current >= obj->threshold )
                 continue;
 
-            /* Type must match */
-            if ( strcmp( obj->type, type ) != 0 )
+            if ( obj->type_id != type )
                 continue;
 
             /* Target matching: "any" matches everything */
-            if ( strcmp( obj->target, "any" ) != 0
-                    && strcmp( obj->target, target ) != 0 )
+            if ( obj->target_atom != QUEST_ATOM_ANY
+                    && ( atom == QUEST_ATOM_NONE || obj->target_atom != atom ) )
                 continue;
 
             /* Update progress */
             p->obj_progress[j].current += value;
-            if ( p->obj_progress[j].current > obj->threshold )
+            if ( p->obj_progress[j].current >= obj->threshold ) {
                 p->obj_progress[j].current = obj->threshold;
+                quest_tracker_touch( tracker );
+                closed = TRUE;
+            }
         }
 
-        /* Check for auto-complete */
-        quest_auto_complete( ch, p->quest_index );
+        /* Only a newly met objective can complete the quest */
+        if ( closed )
+            quest_auto_complete( ch, p->quest_index );
     }
 }
 
@@ -562,8 +597,60 @@ void quest_check_progress( CHAR_DATA *ch, const char *type,
  * Milestone Check: evaluate REACH_* objectives by character state
  *--------------------------------------------------------------------------*/
 
+static unsigned int quest_sig_mix( unsigned int h, int v ) {
+    int k;
+
+    for ( k = 0; k < 4; k++ ) {
+        h ^= (unsigned int) ( v >> ( k * 8 ) ) & 0xff;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+ * Hash of everything the milestone walk would read for the objectives
+ * open right now.  index_gen changes whenever the open set does.
+ */
+static unsigned int quest_milestone_sig( CHAR_DATA *ch, QUEST_TRACKER *t ) {
+    unsigned int open = t->open_types;
+    unsigned int h = 2166136261u;
+    int k;
+
+    h = quest_sig_mix( h, (int) t->index_gen );
+    if ( open & ( 1u << QOT_REACH_STAT ) ) {
+        h = quest_sig_mix( h, ch->max_hit );
+        h = quest_sig_mix( h, ch->max_mana );
+        h = quest_sig_mix( h, ch->max_move );
+        h = quest_sig_mix( h, ch->class );
+    }
+    if ( open & ( 1u << QOT_REACH_GEN ) )
+        h = quest_sig_mix( h, ch->generation );
+    if ( open & ( 1u << QOT_REACH_PKSCORE ) )
+        h = quest_sig_mix( h, get_ratio( ch ) );
+    if ( open & ( 1u << QOT_REACH_UPGRADE ) )
+        h = quest_sig_mix( h, ch->pcdata->upgrade_level );
+    if ( open & ( 1u << QOT_EARN_QP ) )
+        h = quest_sig_mix( h, ch->pcdata->questtotal );
+    if ( open & ( 1u << QOT_MASTERY ) )
+        h = quest_sig_mix( h, IS_SET( ch->newbits, NEW_MASTERY ) ? 1 : 0 );
+    if ( open & ( ( 1u << QOT_LEARN_STANCE ) | ( 1u << QOT_LEARN_SUPERSTANCE ) ) )
+        for ( k = 1; k <= 17; k++ )
+            h = quest_sig_mix( h, ch_stance(ch)[k] );
+    if ( open & ( 1u << QOT_WEAPON_SKILL ) )
+        for ( k = 0; k <= 12; k++ )
+            h = quest_sig_mix( h, ch_wpn(ch)[k] );
+    if ( open & ( 1u << QOT_SPELL_SKILL ) )
+        for ( k = 0; k < 5; k++ )
+            h = quest_sig_mix( h, ch_spl(ch)[k] );
+    if ( open & ( ( 1u << QOT_LEARN_DISCIPLINE ) | ( 1u << QOT_CLASS_POWER ) ) )
+        for ( k = 1; k < MAX_DISCIPLINES; k++ )
+            h = quest_sig_mix( h, ch_power(ch)[k] );
+    return h;
+}
+
 void quest_check_milestones( CHAR_DATA *ch ) {
     QUEST_TRACKER *tracker;
+    unsigned int sig;
     int i, j;
 
     if ( IS_NPC( ch ) || !ch->pcdata || !ch->pcdata->quest_tracker )
@@ -571,6 +658,14 @@ void quest_check_milestones( CHAR_DATA *ch ) {
 
     tracker = ch->pcdata->quest_tracker;
 
+    /* Nothing it reads has changed since the last walk */
+    quest_index_refresh( tracker );
+    sig = quest_milestone_sig( ch, tracker );
+    if ( tracker->milestone_valid && tracker->milestone_sig == sig )
+        return;
+    tracker->milestone_sig   = sig;
+    tracker->milestone_valid = TRUE;
+
     for ( i = 0; i < tracker->count; i++ ) {
         QUEST_PROGRESS *p = &tracker->entries[i];
         const QUEST_DEF *q;
@@ -582,129 +677,127 @@ void quest_check_milestones( CHAR_DATA *ch ) {
         if ( !q ) continue;
 
         for ( j = 0; j < q->obj_count; j++ ) {
-            QUEST_OBJ_DEF *obj = (QUEST_OBJ_DEF *)&q->objectives[j];
+            const QUEST_OBJ_DEF *obj = &q->objectives[j];
             int cur_val = 0;
+            int k;
 
             /* Already met */
             if ( p->obj_progress[j].current >= obj->threshold )
                 continue;
 
             /* Evaluate milestone objectives by checking current state */
-            if ( !strcmp( obj->type, QOBJ_REACH_STAT ) ) {
-                if ( !strcmp( obj->target, "hp" ) )
-                    cur_val = ch->max_hit;
-                else if ( !strcmp( obj->target, "mana" ) )
-                    cur_val = ch->max_mana;
-                else if ( !strcmp( obj->target, "move" ) )
-                    cur_val = ch->max_move;
-                else if ( !strcmp( obj->target, "class" ) )
-                    cur_val = ( ch->class != 0 ) ? 1 : 0;
-            }
-            else if ( !strcmp( obj->type, QOBJ_REACH_GEN ) ) {
+            switch ( obj->type_id ) {
+            case QOT_REACH_STAT:
+                switch ( obj->target_kind ) {
+                case QTGT_HP:    cur_val = ch->max_hit;  break;
+                case QTGT_MANA:  cur_val = ch->max_mana; break;
+                case QTGT_MOVE:  cur_val = ch->max_move; break;
+                case QTGT_CLASS: cur_val = ( ch->class != 0 ) ? 1 : 0; break;
+                }
+                break;
+
+            case QOT_REACH_GEN:
                 /* Lower gen = better; check if gen <= threshold */
                 if ( ch->generation >= 1 && ch->generation <= obj->threshold )
                     cur_val = obj->threshold;
-            }
-            else if ( !strcmp( obj->type, QOBJ_REACH_PKSCORE ) ) {
+                break;
+
+            case QOT_REACH_PKSCORE:
                 cur_val = get_ratio( ch );
-            }
-            else if ( !strcmp( obj->type, QOBJ_REACH_UPGRADE ) ) {
+                break;
+
+            case QOT_REACH_UPGRADE:
                 cur_val = ch->pcdata->upgrade_level;
-            }
-            else if ( !strcmp( obj->type, QOBJ_EARN_QP ) ) {
+                break;
+
+            case QOT_EARN_QP:
                 cur_val = ch->pcdata->questtotal;
-            }
-            else if ( !strcmp( obj->type, QOBJ_MASTERY ) ) {
+                break;
+
+            case QOT_MASTERY:
                 if ( IS_SET( ch->newbits, NEW_MASTERY ) )
                     cur_val = 1;
-            }
-            else if ( !strcmp( obj->type, QOBJ_LEARN_STANCE ) ) {
-                if ( !strcmp( obj->target, "any" ) ) {
-                    int s;
-                    for ( s = 1; s <= 11; s++ )
-                        if ( ch_stance(ch)[s] > cur_val )
-                            cur_val = ch_stance(ch)[s];
+                break;
+
+            case QOT_LEARN_STANCE:
+                if ( obj->target_kind == QTGT_ANY ) {
+                    for ( k = 1; k <= 11; k++ )
+                        if ( ch_stance(ch)[k] > cur_val )
+                            cur_val = ch_stance(ch)[k];
                 }
-                else if ( !strncmp( obj->target, "count_", 6 ) ) {
+                else if ( obj->target_kind == QTGT_COUNT ) {
                     /* count_100 = count stances >= 100, threshold = required count */
-                    int min_skill = atoi( obj->target + 6 );
-                    int s, count = 0;
-                    for ( s = 1; s <= 11; s++ )
-                        if ( ch_stance(ch)[s] >= min_skill )
-                            count++;
-                    cur_val = count;
+                    for ( k = 1; k <= 11; k++ )
+                        if ( ch_stance(ch)[k] >= obj->target_arg )
+                            cur_val++;
                 }
-            }
-            else if ( !strcmp( obj->type, QOBJ_LEARN_SUPERSTANCE ) ) {
-                if ( !strcmp( obj->target, "any" ) ) {
-                    int s;
-                    for ( s = 13; s <= 17; s++ )
-                        if ( ch_stance(ch)[s] > cur_val )
-                            cur_val = ch_stance(ch)[s];
+                break;
+
+            case QOT_LEARN_SUPERSTANCE:
+                if ( obj->target_kind == QTGT_ANY ) {
+                    for ( k = 13; k <= 17; k++ )
+                        if ( ch_stance(ch)[k] > cur_val )
+                            cur_val = ch_stance(ch)[k];
                 }
-                else if ( !strcmp( obj->target, "all" ) ) {
-                    int s, min_val = 999;
-                    for ( s = 13; s <= 17; s++ )
-                        if ( ch_stance(ch)[s] < min_val )
-                            min_val = ch_stance(ch)[s];
-                    cur_val = min_val;
+                else if ( obj->target_kind == QTGT_ALL ) {
+                    cur_val = 999;
+                    for ( k = 13; k <= 17; k++ )
+                        if ( ch_stance(ch)[k] < cur_val )
+                            cur_val = ch_stance(ch)[k];
                 }
-            }
-            else if ( !strcmp( obj->type, QOBJ_WEAPON_SKILL ) ) {
-                if ( !strcmp( obj->target, "any" ) ) {
-                    int w;
-                    for ( w = 0; w <= 12; w++ )
-                        if ( ch_wpn(ch)[w] > cur_val )
-                            cur_val = ch_wpn(ch)[w];
+                break;
+
+            case QOT_WEAPON_SKILL:
+                if ( obj->target_kind == QTGT_ANY ) {
+                    for ( k = 0; k <= 12; k++ )
+                        if ( ch_wpn(ch)[k] > cur_val )
+                            cur_val = ch_wpn(ch)[k];
                 }
-                else if ( !strcmp( obj->target, "all" ) ) {
-                    int w, min_val = 999;
-                    for ( w = 0; w <= 12; w++ )
-                        if ( ch_wpn(ch)[w] < min_val )
-                            min_val = ch_wpn(ch)[w];
-                    cur_val = min_val;
+                else if ( obj->target_kind == QTGT_ALL ) {
+                    cur_val = 999;
+                    for ( k = 0; k <= 12; k++ )
+                        if ( ch_wpn(ch)[k] < cur_val )
+                            cur_val = ch_wpn(ch)[k];
                 }
-            }
-            else if ( !strcmp( obj->type, QOBJ_SPELL_SKILL ) ) {
-                if ( !strcmp( obj->target, "any" ) ) {
-                    int s;
-                    for ( s = 0; s < 5; s++ )
-                        if ( ch_spl(ch)[s] > cur_val )
-                            cur_val = ch_spl(ch)[s];
-                }
-                else if ( !strcmp( obj->target, "all" ) ) {
-                    int s, min_val = 999;
-                    for ( s = 0; s < 5; s++ )
-                        if ( ch_spl(ch)[s] < min_val )
-                            min_val = ch_spl(ch)[s];
-                    cur_val = min_val;
+                break;
+
+            case QOT_SPELL_SKILL:
+                if ( obj->target_kind == QTGT_ANY ) {
+                    for ( k = 0; k < 5; k++ )
+                        if ( ch_spl(ch)[k] > cur_val )
+                            cur_val = ch_spl(ch)[k];
                 }
-            }
-            else if ( !strcmp( obj->type, QOBJ_LEARN_DISCIPLINE ) ) {
-                if ( !strcmp( obj->target, "any" ) ) {
-                    int d;
-                    for ( d = 1; d < MAX_DISCIPLINES; d++ )
-                        if ( ch_power(ch)[d] > cur_val )
-                            cur_val = ch_power(ch)[d];
+                else if ( obj->target_kind == QTGT_ALL ) {
+                    cur_val = 999;
+                    for ( k = 0; k < 5; k++ )
+                        if ( ch_spl(ch)[k] < cur_val )
+                            cur_val = ch_spl(ch)[k];
                 }
-            }
-            else if ( !strcmp( obj->type, QOBJ_CLASS_POWER ) ) {
-                int d;
-                for ( d = 1; d < MAX_DISCIPLINES; d++ ) {
-                    if ( discipline[d][0] != '\0'
-                      && !str_cmp( obj->target, discipline[d] ) ) {
-                        cur_val = ch_power(ch)[d];
-                        break;
-                    }
+                break;
+
+            case QOT_LEARN_DISCIPLINE:
+                if ( obj->target_kind == QTGT_ANY ) {
+                    for ( k = 1; k < MAX_DISCIPLINES; k++ )
+                        if ( ch_power(ch)[k] > cur_val )
+                            cur_val = ch_power(ch)[k];
                 }
-            }
-            else {
+                break;
+
+            case QOT_CLASS_POWER:
+                if ( obj->target_kind == QTGT_DISCIPLINE )
+                    cur_val = ch_power(ch)[obj->target_arg];
+                break;
+
+            default:
                 continue;  /* Not a milestone type */
             }
 
             /* Always store current value so progress is visible */
-            if ( cur_val > p->obj_progress[j].current )
+            if ( cur_val > p->obj_progress[j].current ) {
                 p->obj_progress[j].current = cur_val;
+                if ( cur_val >= obj->threshold )
+                    quest_tracker_touch( tracker );
+            }
         }
 
         /* Check for auto-complete after milestone evaluation */
@@ -984,6 +1077,7 @@ static void quest_do_accept( CHAR_DATA *ch, char *argument ) {
 
     p->status     = QSTATUS_ACTIVE;
     p->started_at = (int) current_time;
+    quest_tracker_touch( ch->pcdata->quest_tracker );
 
     snprintf( buf, sizeof( buf ),
         "\n\r  #tFFD700" U_STAR " Quest Accepted: #C%s#n\n\r\n\r  %s\n\r\n\r",
@@ -1023,7 +1117,7 @@ static void quest_do_complete( CHAR_DATA *ch, char *argument ) {
             send_to_char( buf, ch );
         }
         quest_award_rewards( ch, q );
-        quest_check_progress( ch, QOBJ_COMPLETE_QUEST, q->id, 1 );
+        quest_check_progress( ch, QOT_COMPLETE_QUEST, q->id, 1 );
         completed++;
     }
 
@@ -1074,6 +1168,7 @@ static void quest_do_abandon( CHAR_DATA *ch, char *argument ) {
     p->started_at = 0;
     for ( j = 0; j < MAX_QUEST_OBJECTIVES; j++ )
         p->obj_progress[j].current = 0;
+    quest_tracker_touch( ch->pcdata->quest_tracker );
 
     {
         char buf[MAX_STRING_LENGTH];
@@ -1343,6 +1438,7 @@ static void qadmin_reset( CHAR_DATA *ch, CHAR_DATA *victim, char *argument ) {
             for ( j = 0; j < MAX_QUEST_OBJECTIVES; j++ )
                 tracker->entries[i].obj_progress[j].current = 0;
         }
+        quest_tracker_touch( tracker );
         snprintf( buf, sizeof( buf ), "Reset ALL quest progress for %s.\n\r", victim->name );
         send_to_char( buf, ch );
 
@@ -1371,6 +1467,7 @@ static void qadmin_reset( CHAR_DATA *ch, CHAR_DATA *victim, char *argument ) {
         p->completed_at = 0;
         for ( j = 0; j < MAX_QUEST_OBJECTIVES; j++ )
             p->obj_progress[j].current = 0;
+        quest_tracker_touch( tracker );
 
         snprintf( buf, sizeof( buf ), "Reset %s quest %s to LOCKED.\n\r",
             victim->name, arg_id );
@@ -45,17 +45,18 @@ bool quest_grant_entry( CHAR_DATA *ch );
  * Event Hook: quest_check_progress
  *
  * Called from various game systems when an event occurs that might
- * advance a quest objective.  Checks all active quests for matching
- * objectives and updates progress.
+ * advance a quest objective.  Only the active quests with an open
+ * objective of this type are visited, so an event nobody is waiting on
+ * costs one lookup in the tracker's index.
  *
  * Parameters:
  *   ch    - The character whose progress is being checked
- *   type  - Objective type string (QOBJ_* constants from db_quest.h)
+ *   type  - Objective type (QOT_* constants from db_quest.h)
  *   target - Target string (command name, stat type, "any", etc.)
  *   value  - The current value or increment amount
  *--------------------------------------------------------------------------*/
 
-void quest_check_progress( CHAR_DATA *ch, const char *type,
+void quest_check_progress( CHAR_DATA *ch, int type,
                            const char *target, int value );
 
 /*--------------------------------------------------------------------------
@@ -66,7 +67,9 @@ void quest_check_progress( CHAR_DATA *ch, const char *type,
  * type objectives during periodic checks.
  *--------------------------------------------------------------------------*/
 
-/* Check all REACH_* objectives for a character (call from tick/update). */
+/* Check all REACH_* objectives for a character (call from tick/update).
+ * Returns at once if none of the stats the open objectives read have
+ * changed since the last check. */
 void quest_check_milestones( CHAR_DATA *ch );
 
 /* Evaluate prerequisites and unlock available quests. */
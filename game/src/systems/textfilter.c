@@ -0,0 +1,245 @@
+/*
+ * textfilter.c - Name and chat filtering against the game.db word tables
+ *
+ * The automaton is rebuilt from scratch whenever the tables change; they
+ * change only at boot and through nameban, so the build need not be
+ * incremental.  Patterns are skeletonized before they go in, the same as
+ * the text they are matched against.
+ */
+
+#include "merc.h"
+#include <ctype.h>
+#include "../core/utf8.h"
+#include "../db/db_game.h"
+#include "textfilter.h"
+
+typedef struct tf_state {
+	int next[256];	/* Goto with failures folded in: never -1 once built  */
+	int dict;		/* Nearest proper suffix that ends a pattern, 0 = none */
+	int depth;		/* Length of the text that leads here                 */
+	int kinds;		/* TF_* of the patterns ending exactly here           */
+} TF_STATE;
+
+static TF_STATE *tf_states; /* [0] is the root */
+static int tf_count;
+static int tf_alloc;
+static int tf_kinds;		/* Every TF_* some pattern has */
+
+static int tf_new_state( int depth ) {
+	TF_STATE *st;
+
+	if ( tf_count == tf_alloc ) {
+		TF_STATE *grown;
+
+		tf_alloc = tf_alloc ? tf_alloc * 2 : 64;
+		grown = realloc( tf_states, tf_alloc * sizeof( TF_STATE ) );
+		if ( !grown ) {
+			bug( "tf_new_state: realloc failed", 0 );
+			exit( 1 );
+		}
+		tf_states = grown;
+	}
+
+	st = &tf_states[tf_count];
+	memset( st->next, 0xff, sizeof( st->next ) );
+	st->dict = 0;
+	st->depth = depth;
+	st->kinds = 0;
+	return tf_count++;
+}
+
+static void tf_insert( const char *pattern, int kind ) {
+	char skeleton[256];
+	int len, i, s = 0, c;
+
+	len = utf8_skeletonize( pattern, skeleton, sizeof( skeleton ) );
+	if ( len == 0 )
+		return;
+
+	for ( i = 0; i < len; i++ ) {
+		c = (unsigned char) skeleton[i];
+		if ( tf_states[s].next[c] < 0 ) {
+			int t = tf_new_state( tf_states[s].depth + 1 );
+			tf_states[s].next[c] = t;
+		}
+		s = tf_states[s].next[c];
+	}
+	tf_states[s].kinds |= kind;
+	tf_kinds |= kind;
+}
+
+/* Breadth first: failure links, then every missing edge filled from them */
+static void tf_link( void ) {
+	int *queue, *fail;
+	int head = 0, tail = 0;
+	int s, c, v, f;
+
+	queue = malloc( tf_count * sizeof( int ) );
+	fail = calloc( tf_count, sizeof( int ) );
+	if ( !queue || !fail ) {
+		bug( "tf_link: alloc failed", 0 );
+		exit( 1 );
+	}
+
+	for ( c = 0; c < 256; c++ ) {
+		v = tf_states[0].next[c];
+		if ( v < 0 )
+			tf_states[0].next[c] = 0;
+		else
+			queue[tail++] = v;
+	}
+
+	while ( head < tail ) {
+		s = queue[head++];
+		for ( c = 0; c < 256; c++ ) {
+			v = tf_states[s].next[c];
+			if ( v < 0 ) {
+				tf_states[s].next[c] = tf_states[fail[s]].next[c];
+				continue;
+			}
+			f = tf_states[fail[s]].next[c];
+			fail[v] = f;
+			tf_states[v].dict = tf_states[f].kinds ? f : tf_states[f].dict;
+			queue[tail++] = v;
+		}
+	}
+
+	/* Skeletons are lower case already; fold what is scanned the same way */
+	for ( s = 0; s < tf_count; s++ )
+		for ( c = 'A'; c <= 'Z'; c++ )
+			tf_states[s].next[c] = tf_states[s].next[c - 'A' + 'a'];
+
+	free( queue );
+	free( fail );
+}
+
+void textfilter_rebuild( void ) {
+	FORBIDDEN_NAME *fn;
+	PROFANITY_FILTER *pf;
+
+	tf_count = 0;
+	tf_kinds = 0;
+	tf_new_state( 0 );
+
+	LIST_FOR_EACH( fn, &forbidden_name_list, FORBIDDEN_NAME, node ) {
+		switch ( fn->type ) {
+		case NAMETYPE_RESERVED:
+		case NAMETYPE_BLOCKED:
+			tf_insert( fn->name, TF_EXACT );
+			break;
+		case NAMETYPE_PROTECTED:
+			tf_insert( fn->name, TF_PROTECTED );
+			break;
+		}
+	}
+	LIST_FOR_EACH( pf, &profanity_filter_list, PROFANITY_FILTER, node )
+		tf_insert( pf->pattern, TF_PROFANITY );
+
+	tf_link();
+}
+
+int textfilter_scan( const char *text, int len, int kinds ) {
+	int i, s = 0, t, k, hit = 0;
+
+	kinds &= tf_kinds;
+	if ( kinds == 0 )
+		return 0;
+
+	for ( i = 0; i < len; i++ ) {
+		s = tf_states[s].next[(unsigned char) text[i]];
+		for ( t = tf_states[s].kinds ? s : tf_states[s].dict; t != 0; t = tf_states[t].dict ) {
+			k = tf_states[t].kinds & kinds;
+			hit |= k & TF_PROFANITY;
+			/* Only a pattern as long as the text can be all of it */
+			if ( tf_states[t].depth == len )
+				hit |= k & TF_EXACT;
+			else
+				hit |= k & TF_PROTECTED;
+		}
+		if ( hit == kinds )
+			break;
+	}
+	return hit;
+}
+
+bool textfilter_name_blocked( const char *name ) {
+	char skeleton[256];
+	int len;
+
+	len = utf8_skeletonize( name, skeleton, sizeof( skeleton ) );
+	return textfilter_scan( skeleton, len, TF_PROFANITY | TF_EXACT | TF_PROTECTED ) != 0;
+}
+
+/* Letters, digits and anything outside ASCII run a word on */
+static bool tf_word_char( const char *skeleton, int i ) {
+	unsigned char c = (unsigned char) skeleton[i];
+
+	return isalnum( c ) || c >= 0x80;
+}
+
+/*
+ * Does skeleton[start..end) stand as a word of its own?  A colour code
+ * such as "#R" right before it counts as a break, not as part of it.
+ */
+static bool tf_whole_word( const char *skeleton, int len, int start, int end ) {
+	if ( start > 0 && tf_word_char( skeleton, start - 1 )
+		&& !( start > 1 && skeleton[start - 2] == '#' ) )
+		return FALSE;
+	if ( end < len && tf_word_char( skeleton, end ) )
+		return FALSE;
+	return TRUE;
+}
+
+bool textfilter_mask( const char *in, char *out, int size ) {
+	static char skeleton[MAX_STRING_LENGTH];
+	static int map[MAX_STRING_LENGTH];
+	static bool masked[MAX_STRING_LENGTH];
+	const char *p;
+	int len, i, j, s = 0, t, o = 0;
+	bool any = FALSE, hide;
+
+	if ( size <= 0 )
+		return FALSE;
+
+	if ( !( tf_kinds & TF_PROFANITY ) ) {
+		snprintf( out, size, "%s", in );
+		return FALSE;
+	}
+
+	len = utf8_skeletonize_map( in, skeleton, sizeof( skeleton ), map );
+
+	memset( masked, 0, len );
+	for ( i = 0; i < len; i++ ) {
+		s = tf_states[s].next[(unsigned char) skeleton[i]];
+		for ( t = tf_states[s].kinds ? s : tf_states[s].dict; t != 0; t = tf_states[t].dict ) {
+			if ( !( tf_states[t].kinds & TF_PROFANITY ) )
+				continue;
+			if ( !tf_whole_word( skeleton, len, i - tf_states[t].depth + 1, i + 1 ) )
+				continue;
+			for ( j = i - tf_states[t].depth + 1; j <= i; j++ )
+				masked[j] = TRUE;
+			any = TRUE;
+		}
+	}
+
+	/* Each input codepoint owns the skeleton bytes whose map[] points at it */
+	for ( p = in, j = 0; *p != '\0' && o < size - 1; ) {
+		const char *start = p;
+
+		hide = FALSE;
+		for ( ; j < len && map[j] == (int) ( p - in ); j++ )
+			hide |= masked[j];
+		utf8_decode( &p );
+
+		if ( hide ) {
+			out[o++] = '*';
+			continue;
+		}
+		if ( o + ( p - start ) > size - 1 )
+			break;
+		memcpy( out + o, start, p - start );
+		o += (int) ( p - start );
+	}
+	out[o] = '\0';
+	return any;
+}
@@ -0,0 +1,38 @@
+/*
+ * textfilter.h - Name and chat filtering against the game.db word tables
+ *
+ * Every profanity pattern and forbidden name is compiled into a single
+ * Aho-Corasick automaton (a full 256-way DFA, ASCII case folded), so one
+ * pass over a skeleton (utf8_skeletonize()) finds every pattern in it
+ * however many rows the tables hold.  textfilter_rebuild() recompiles it;
+ * call it whenever profanity_filter_list or forbidden_name_list changes.
+ * The db_game.c loaders do.
+ *
+ * Names are checked on their skeleton, so lookalike spellings of reserved
+ * and protected names are caught as well as lookalike profanity.
+ */
+
+#ifndef TEXTFILTER_H
+#define TEXTFILTER_H
+
+/* What a pattern rules out */
+#define TF_PROFANITY 1 /* Anywhere in the text                          */
+#define TF_EXACT     2 /* The whole text: reserved and blocked names    */
+#define TF_PROTECTED 4 /* Part of the text, but not the whole of it     */
+
+void textfilter_rebuild( void );
+
+/* TF_* bits of the rules in kinds that text (a skeleton) breaks */
+int textfilter_scan( const char *text, int len, int kinds );
+
+/* TRUE if the forbidden name or profanity tables rule out name */
+bool textfilter_name_blocked( const char *name );
+
+/*
+ * Copy in to out with each character that spells profanity replaced by
+ * '*'.  Only whole words are masked, so "Scunthorpe" and "assassin" go
+ * through whatever the table holds.  Returns TRUE if anything was masked.
+ */
+bool textfilter_mask( const char *in, char *out, int size );
+
+#endif /* TEXTFILTER_H */
@@ -27,7 +27,10 @@
 #include "mcmp.h"
 #include "profile.h"
 #include "../core/cfg.h"
+#include "../core/rng.h"
 #include "../script/script.h"
+#include "../db/db_game.h"
+#include "../classes/class_ops.h"
 
 /*
  * Local functions.
@@ -44,37 +47,6 @@ void werewolf_regen ( CHAR_DATA * ch, int multiplier );
 void update_morted_timer ( CHAR_DATA * ch );
 void update_sit_safe_counter ( CHAR_DATA * ch );
 void update_drunks ( CHAR_DATA * ch );
-void update_vampire ( CHAR_DATA * ch );
-void update_vampire_regen ( CHAR_DATA * ch );
-void update_cyborg ( CHAR_DATA * ch );
-void update_monk ( CHAR_DATA * ch );
-void update_drider ( CHAR_DATA * ch );
-void update_lich ( CHAR_DATA * ch );
-void update_lich_regen ( CHAR_DATA * ch );
-void update_angel ( CHAR_DATA * ch );
-void update_ninja ( CHAR_DATA * ch );
-void update_werewolf ( CHAR_DATA * ch );
-void update_demon_regen ( CHAR_DATA * ch );
-void update_demon ( CHAR_DATA * ch );
-void update_tanarri ( CHAR_DATA * ch );
-void update_drow ( CHAR_DATA * ch );
-void update_highlander ( CHAR_DATA * ch );
-void update_mage ( CHAR_DATA * ch );
-void update_dirgesinger ( CHAR_DATA * ch );
-void update_siren ( CHAR_DATA * ch );
-void update_psion ( CHAR_DATA * ch );
-void update_mindflayer ( CHAR_DATA * ch );
-void update_artificer ( CHAR_DATA * ch );
-void update_mechanist ( CHAR_DATA * ch );
-void update_cultist ( CHAR_DATA * ch );
-void update_voidborn ( CHAR_DATA * ch );
-void update_chronomancer ( CHAR_DATA * ch );
-void update_paradox ( CHAR_DATA * ch );
-void update_shaman ( CHAR_DATA * ch );
-void update_spiritlord ( CHAR_DATA * ch );
-void update_knight ( CHAR_DATA * ch );
-void update_shapeshifter ( CHAR_DATA * ch );
-void update_arti_regen ( CHAR_DATA * ch );
 void regen_limb ( CHAR_DATA * ch );
 void update_safe_powers ( CHAR_DATA * ch );
 
@@ -175,7 +147,7 @@ void char_update( void ) {
 	time_t save_time;
 	int count = 0, i;
 
-	PROFILE_START( "char_update" );
+	PROFILE_START( PROF_CHAR_UPDATE );
 
 	save_time = current_time;
 
@@ -439,7 +411,7 @@ void char_update( void ) {
 		}
 	}
 
-	PROFILE_END( "char_update" );
+	PROFILE_END( PROF_CHAR_UPDATE );
 	return;
 }
 
@@ -455,10 +427,10 @@ void mobile_update( void ) {
 	EXIT_DATA *pexit;
 	int door;
 
-	PROFILE_START( "mobile_update" );
+	PROFILE_START( PROF_MOBILE_UPDATE );
 
 	/* --- Player updates (iterate connected descriptors only) --- */
-	PROFILE_START( "mob_player_upd" );
+	PROFILE_START( PROF_MOB_PLAYER_UPD );
 	LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node ) {
 		ch = d->character;
 		if ( !ch || !ch->in_room || IS_NPC( ch ) ) continue;
@@ -473,69 +445,7 @@ void mobile_update( void ) {
 		update_drunks( ch );
 		if ( ch->level < 7 && IS_HERO( ch ) ) update_safe_powers( ch );
 		if ( IS_HERO( ch ) && ch->hit > 0 && !IS_SET( ch->extra, EXTRA_AFK ) ) {
-			if ( IS_CLASS( ch, CLASS_VAMPIRE ) ) {
-				if ( ch->rage > 0 )
-					update_vampire_regen( ch );
-				else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
-					update_arti_regen( ch );
-				update_vampire( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_DROID ) ) {
-				update_drider( ch );
-				if ( ch->pcdata->powers[CYBORG_BODY] > 5 )
-					update_cyborg( ch );
-				else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
-					update_arti_regen( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_ANGEL ) ) {
-				if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
-				update_angel( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_TANARRI ) ) {
-				if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
-				update_tanarri( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_LICH ) ) {
-				if ( ch->pcdata->powers[LIFE_LORE] > 0 )
-					update_lich_regen( ch );
-				else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
-					update_arti_regen( ch );
-				update_lich( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_MONK ) ) update_monk( ch );
-			if ( IS_CLASS( ch, CLASS_NINJA ) ) update_ninja( ch );
-			if ( IS_CLASS( ch, CLASS_UNDEAD_KNIGHT ) ) update_knight( ch );
-			if ( IS_CLASS( ch, CLASS_WEREWOLF ) ) update_werewolf( ch );
-			if ( IS_CLASS( ch, CLASS_DEMON ) ) {
-				update_demon( ch );
-				if ( IS_SET( ch->warp, WARP_REGENERATE ) )
-					update_demon_regen( ch );
-				else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
-					update_arti_regen( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_SHAPESHIFTER ) ) update_shapeshifter( ch );
-			if ( IS_CLASS( ch, CLASS_DROW ) ) {
-				update_drow( ch );
-				if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_SAMURAI ) ) update_highlander( ch );
-			if ( IS_CLASS( ch, CLASS_MAGE ) ) {
-				update_mage( ch );
-				if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
-			}
-			if ( IS_CLASS( ch, CLASS_DIRGESINGER ) ) update_dirgesinger( ch );
-			if ( IS_CLASS( ch, CLASS_SIREN ) ) update_siren( ch );
-			if ( IS_CLASS( ch, CLASS_PSION ) ) update_psion( ch );
-			if ( IS_CLASS( ch, CLASS_MINDFLAYER ) ) update_mindflayer( ch );
-			if ( IS_CLASS( ch, CLASS_ARTIFICER ) ) update_artificer( ch );
-			if ( IS_CLASS( ch, CLASS_MECHANIST ) ) update_mechanist( ch );
-			if ( IS_CLASS( ch, CLASS_CULTIST ) ) update_cultist( ch );
-			if ( IS_CLASS( ch, CLASS_VOIDBORN ) ) update_voidborn( ch );
-			if ( IS_CLASS( ch, CLASS_CHRONOMANCER ) ) update_chronomancer( ch );
-			if ( IS_CLASS( ch, CLASS_PARADOX ) ) update_paradox( ch );
-			if ( IS_CLASS( ch, CLASS_SHAMAN ) ) update_shaman( ch );
-			if ( IS_CLASS( ch, CLASS_SPIRITLORD ) ) update_spiritlord( ch );
-			if ( ch->class == 0 && IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
+			class_tick( ch );
 		} else {
 			heal_char( ch, number_range( 1, 5 ) );
 			update_pos( ch );
@@ -543,28 +453,28 @@ void mobile_update( void ) {
 				update_arti_regen( ch );
 		}
 	}
-	PROFILE_END( "mob_player_upd" );
+	PROFILE_END( PROF_MOB_PLAYER_UPD );
 
 	/* --- NPC AI updates (iterate NPC list only) --- */
 	LIST_FOR_EACH_SAFE( ch, ch_next, &g_npcs, CHAR_DATA, npc_node ) {
 
 		if ( ch->in_room == NULL ) continue;
 
-		PROFILE_START( "mob_npc_ai" );
+		PROFILE_START( PROF_MOB_NPC_AI );
 		if ( IS_AFFECTED( ch, AFF_CHARM ) ) {
-			PROFILE_END( "mob_npc_ai" );
+			PROFILE_END( PROF_MOB_NPC_AI );
 			continue;
 		}
 		if ( script_trigger_tick( ch ) ) {
-			PROFILE_END( "mob_npc_ai" );
+			PROFILE_END( PROF_MOB_NPC_AI );
 			continue;
 		}
 		if ( ch->position != POS_STANDING ) {
 			do_stand( ch, "" );
-			PROFILE_END( "mob_npc_ai" );
+			PROFILE_END( PROF_MOB_NPC_AI );
 			continue;
 		}
-		PROFILE_START( "mob_npc_scavenge" );
+		PROFILE_START( PROF_MOB_NPC_SCAVENGE );
 		if ( IS_SET( ch->act, ACT_SCAVENGER ) && !list_empty( &ch->in_room->objects ) && number_bits( 2 ) == 0 ) {
 			OBJ_DATA *obj;
 			OBJ_DATA *obj_best = 0;
@@ -585,10 +495,10 @@ void mobile_update( void ) {
 				}
 			}
 		}
-		PROFILE_END( "mob_npc_scavenge" );
-		/* Random movement */
-		PROFILE_START( "mob_npc_move" );
-		if ( !IS_SET( ch->act, ACT_SENTINEL ) && ( door = number_bits( 5 ) ) <= 5 && ( pexit = ch->in_room->exit[door] ) != NULL && pexit->to_room != NULL && !IS_SET( pexit->exit_info, EX_CLOSED ) && !IS_SET( pexit->to_room->room_flags, ROOM_NO_MOB ) && ( ch->hunting == NULL || strlen( ch->hunting ) < 2 ) && ( ( !IS_SET( ch->act, ACT_STAY_AREA ) && ch->level < 900 ) || pexit->to_room->area == ch->in_room->area ) ) {
+		PROFILE_END( PROF_MOB_NPC_SCAVENGE );
+		/* Hunting and homing, else random movement */
+		PROFILE_START( PROF_MOB_NPC_MOVE );
+		if ( !mob_path_step( ch ) && !IS_SET( ch->act, ACT_SENTINEL ) && ( door = number_bits( 5 ) ) <= 5 && ( pexit = ch->in_room->exit[door] ) != NULL && pexit->to_room != NULL && !IS_SET( pexit->exit_info, EX_CLOSED ) && !IS_SET( pexit->to_room->room_flags, ROOM_NO_MOB ) && ( ch->hunting == NULL || strlen( ch->hunting ) < 2 ) && ( ( !IS_SET( ch->act, ACT_STAY_AREA ) && ch->level < 900 ) || pexit->to_room->area == ch->in_room->area ) ) {
 			move_char( ch, door );
 		}
 		if ( ch->hit < ch->max_hit / 2 && ( door = number_bits( 3 ) ) <= 5 && ( pexit = ch->in_room->exit[door] ) != NULL && pexit->to_room != NULL && !IS_AFFECTED( ch, AFF_WEBBED ) && ch->level < 900 && !IS_SET( pexit->exit_info, EX_CLOSED ) && !IS_SET( pexit->to_room->room_flags, ROOM_NO_MOB ) ) {
@@ -604,11 +514,11 @@ void mobile_update( void ) {
 			if ( !found )
 				move_char( ch, door );
 		}
-		PROFILE_END( "mob_npc_move" );
-		PROFILE_END( "mob_npc_ai" );
+		PROFILE_END( PROF_MOB_NPC_MOVE );
+		PROFILE_END( PROF_MOB_NPC_AI );
 	}
 
-	PROFILE_END( "mobile_update" );
+	PROFILE_END( PROF_MOBILE_UPDATE );
 	return;
 }
 
@@ -924,7 +834,7 @@ void obj_update( void ) {
 	OBJ_DATA *obj;
 	OBJ_DATA *obj_next;
 
-	PROFILE_START( "obj_update" );
+	PROFILE_START( PROF_OBJ_UPDATE );
 
 	LIST_FOR_EACH_SAFE( obj, obj_next, &g_objects, OBJ_DATA, obj_node ) {
 		CHAR_DATA *rch;
@@ -997,7 +907,7 @@ void obj_update( void ) {
 		extract_obj( obj );
 	}
 
-	PROFILE_END( "obj_update" );
+	PROFILE_END( PROF_OBJ_UPDATE );
 	return;
 }
 
@@ -1111,7 +1021,7 @@ void ww_update( void ) {
 	CHAR_DATA *victim;
 	int dam = 0;
 
-	PROFILE_START( "ww_update" );
+	PROFILE_START( PROF_WW_UPDATE );
 
 	LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node ) {
 		if ( !IS_PLAYING( d ) || ( victim = d->character ) == NULL || IS_NPC( victim ) || IS_IMMORTAL( victim ) || victim->in_room == NULL || victim->pcdata->chobj != NULL || IS_CLASS( victim, CLASS_WEREWOLF ) ) {
@@ -1134,7 +1044,7 @@ void ww_update( void ) {
 		update_pos( victim );
 	}
 
-	PROFILE_END( "ww_update" );
+	PROFILE_END( PROF_WW_UPDATE );
 	return;
 }
 
@@ -1170,15 +1080,24 @@ void update_handler( void ) {
 	}
 	if ( --pulse_area <= 0 ) {
 		pulse_area = number_range( PULSE_AREA / 2, 3 * PULSE_AREA / 2 );
+		rng_select( RNG_LOOT );
 		area_update();
+		rng_select( RNG_DEFAULT );
 	}
+	rng_select( RNG_LOOT );
+	area_reset_pulse();
+	rng_select( RNG_DEFAULT );
 	if ( --pulse_mobile <= 0 ) {
 		pulse_mobile = PULSE_MOBILE;
+		rng_select( RNG_AI );
 		mobile_update();
+		rng_select( RNG_DEFAULT );
 	}
 	if ( --pulse_violence <= 0 ) {
 		pulse_violence = PULSE_VIOLENCE;
+		rng_select( RNG_COMBAT );
 		violence_update();
+		rng_select( RNG_DEFAULT );
 		mem_debug_check_freelists();
 	}
 	if ( --pulse_embrace <= 0 ) {
@@ -1187,12 +1106,14 @@ void update_handler( void ) {
 	}
 	if ( --pulse_point <= 0 ) {
 		pulse_point = number_range( PULSE_TICK / 2, 3 * PULSE_TICK / 2 );
+		rng_select( RNG_WEATHER );
 		weather_update();
+		rng_select( RNG_DEFAULT );
 		char_update();
 		obj_update();
-		PROFILE_START( "obj_script_tick" );
+		PROFILE_START( PROF_OBJ_SCRIPT_TICK );
 		script_trigger_obj_tick();
-		PROFILE_END( "obj_script_tick" );
+		PROFILE_END( PROF_OBJ_SCRIPT_TICK );
 		room_update();
 
 		/*
@@ -1207,6 +1128,16 @@ void update_handler( void ) {
 			iDelete++;
 		}
 	}
+
+	/* Resume Lua coroutines whose wait() or wait_for_event() is over */
+	script_scheduler_pulse();
+
+	/* Close a 'profile sample' window once its time is up */
+	profile_sample_pulse();
+
+	/* Group-commit queued game.db writes */
+	db_game_writer_pulse();
+
 	tail_chain();
 
 	PROFILE_TICK_END();
@@ -1616,7 +1547,7 @@ void update_arti_regen( CHAR_DATA *ch ) {
 
 void regen_limb( CHAR_DATA *ch ) {
 	if ( ch_loc_hp(ch)[6] > 0 ) {
-		int sn = skill_lookup( "clot" );
+		int sn = gsn_clot;
 		( *skill_table[sn].spell_fun )( sn, ch->level, ch, ch );
 	} else if ( ( ch_loc_hp(ch)[0] + ch_loc_hp(ch)[1] + ch_loc_hp(ch)[2] + ch_loc_hp(ch)[3] + ch_loc_hp(ch)[4] + ch_loc_hp(ch)[5] ) != 0 )
 		reg_mend( ch );
@@ -29,6 +29,7 @@
 #endif
 #include "merc.h"
 #include "../db/db_game.h"
+#include "help_index.h"
 
 /*
  * Returns value 0 - 9 based on directional text.
@@ -694,14 +695,12 @@ void stop_editing( CHAR_DATA *ch ) {
 }
 
 /*
- * Moved into a separate function so it can be used for other things
- * ie: online help editing				-Thoric
+ * Normalize a help argument: strip an optional N. level prefix and
+ * collapse the words into argall.  Returns the level (-2 for any).
  */
-HELP_DATA *get_help( CHAR_DATA *ch, char *argument ) {
-	char argall[MAX_INPUT_LENGTH];
+static int help_parse_argument( char *argument, char *argall ) {
 	char argone[MAX_INPUT_LENGTH];
 	char argnew[MAX_INPUT_LENGTH];
-	HELP_DATA *pHelp;
 	int lev;
 
 	if ( argument[0] == '\0' )
@@ -723,17 +722,59 @@ HELP_DATA *get_help( CHAR_DATA *ch, char *argument ) {
 		strcat( argall, argone );
 	}
 
-	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
-		if ( pHelp->level > get_trust( ch ) )
-			continue;
-		if ( lev != -2 && pHelp->level != lev )
-			continue;
+	return lev;
+}
+
+/*
+ * Moved into a separate function so it can be used for other things
+ * ie: online help editing				-Thoric
+ * Lookups go through the keyword index (help_index.c).
+ */
+HELP_DATA *get_help( CHAR_DATA *ch, char *argument ) {
+	char argall[MAX_INPUT_LENGTH];
+	int lev;
+
+	lev = help_parse_argument( argument, argall );
+	return help_index_find( ch, argall, lev );
+}
 
-		if ( is_name( argall, pHelp->keyword ) )
-			return pHelp;
+static void help_show_suggestions( CHAR_DATA *ch, char *argument ) {
+	HELP_DATA *found[HELP_INDEX_MAX_RESULTS];
+	char argall[MAX_INPUT_LENGTH];
+	char buf[MAX_STRING_LENGTH];
+	int count, i;
+
+	help_parse_argument( argument, argall );
+	count = help_index_suggest( ch, argall, found, 5 );
+	if ( count == 0 )
+		return;
+
+	snprintf( buf, sizeof( buf ), "Did you mean:" );
+	for ( i = 0; i < count; i++ ) {
+		strncat( buf, i == 0 ? " " : ", ", sizeof( buf ) - strlen( buf ) - 1 );
+		strncat( buf, found[i]->keyword, sizeof( buf ) - strlen( buf ) - 1 );
 	}
+	strncat( buf, "?\n\r", sizeof( buf ) - strlen( buf ) - 1 );
+	send_to_char( buf, ch );
+}
+
+static void help_show_search( CHAR_DATA *ch, char *query ) {
+	HELP_DATA *found[HELP_INDEX_MAX_RESULTS];
+	char buf[MAX_STRING_LENGTH];
+	int count, i;
 
-	return NULL;
+	count = help_index_search( ch, query, found, HELP_INDEX_MAX_RESULTS );
+	if ( count == 0 ) {
+		send_to_char( "No help pages mention that.\n\r", ch );
+		return;
+	}
+
+	snprintf( buf, sizeof( buf ), "Help pages matching '%s':\n\r", query );
+	send_to_char( buf, ch );
+	for ( i = 0; i < count; i++ ) {
+		snprintf( buf, sizeof( buf ), "  %s\n\r", found[i]->keyword );
+		send_to_char( buf, ch );
+	}
 }
 
 /*
@@ -741,9 +782,18 @@ HELP_DATA *get_help( CHAR_DATA *ch, char *argument ) {
  */
 void do_help( CHAR_DATA *ch, char *argument ) {
 	HELP_DATA *pHelp;
+	char arg[MAX_INPUT_LENGTH];
+	char *rest;
 
 	if ( ( pHelp = get_help( ch, argument ) ) == NULL ) {
+		/* 'help search <words>' when no page is actually keyed that way */
+		rest = one_argument( argument, arg );
+		if ( !str_cmp( arg, "search" ) && rest[0] != '\0' ) {
+			help_show_search( ch, rest );
+			return;
+		}
 		send_to_char( "No help on that word.\n\r", ch );
+		help_show_suggestions( ch, argument );
 		return;
 	}
 
@@ -791,6 +841,7 @@ void do_hset( CHAR_DATA *ch, char *argument ) {
 	}
 	if ( !str_cmp( arg1, "remove" ) ) {
 		list_remove( &g_helps, &pHelp->node );
+		help_index_invalidate();
 		free( pHelp->text );
 		free( pHelp->keyword );
 		free( pHelp );
@@ -805,6 +856,7 @@ void do_hset( CHAR_DATA *ch, char *argument ) {
 	if ( !str_cmp( arg1, "keyword" ) ) {
 		free( pHelp->keyword );
 		pHelp->keyword = str_dup( strupper( arg2 ) );
+		help_index_invalidate();
 		send_to_char( "Done.\n\r", ch );
 		return;
 	}
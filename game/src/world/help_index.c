@@ -0,0 +1,517 @@
+/*
+ * help_index.c - Inverted index over help keywords and body text
+ *
+ * Every keyword token (as split by one_argument, so quoted phrases stay
+ * whole) and every body word maps to a posting list of help ordinals.
+ * Ordinals follow g_helps order, which add_help() keeps sorted, so the
+ * lowest matching ordinal is the entry the old linear scan returned.
+ *
+ * The index is rebuilt lazily: mutations only flip a dirty flag, and the
+ * next lookup pays for one pass over g_helps.  Boot loads hundreds of
+ * entries through add_help() without rebuilding once per entry.
+ */
+
+#include "merc.h"
+#include "help_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HELP_HASH_SIZE 4096
+#define HELP_WORD_MAX  64 /* Longest body word indexed (longer are truncated) */
+#define HELP_QUERY_MAX 8  /* Words honoured in a search query */
+
+typedef struct help_posting {
+	int help;	   /* Ordinal into help_vec */
+	int kw_hits;   /* Occurrences as a whole keyword token */
+	int body_hits; /* Occurrences in body text (or inside a keyword phrase) */
+} HELP_POSTING;
+
+typedef struct help_term {
+	struct help_term *next; /* Hash chain */
+	char *word;
+	HELP_POSTING *posts; /* Ascending by help ordinal, one per entry */
+	int post_count;
+	int post_cap;
+	bool keyword; /* Whole keyword token of at least one entry */
+} HELP_TERM;
+
+static HELP_TERM *term_hash[HELP_HASH_SIZE];
+static HELP_TERM **kw_terms; /* Keyword terms sorted by word, for prefix ranges */
+static int kw_term_count;
+static int term_count;
+static HELP_DATA **help_vec;
+static int help_count;
+static bool index_dirty = TRUE;
+static int rebuild_count;
+
+static unsigned int term_hash_fn( const char *word ) {
+	unsigned int h = 5381;
+
+	while ( *word != '\0' )
+		h = ( h << 5 ) + h + (unsigned char) *word++;
+	return h % HELP_HASH_SIZE;
+}
+
+static HELP_TERM *term_find( const char *word ) {
+	HELP_TERM *term;
+
+	for ( term = term_hash[term_hash_fn( word )]; term != NULL; term = term->next ) {
+		if ( !strcmp( term->word, word ) )
+			return term;
+	}
+	return NULL;
+}
+
+static HELP_TERM *term_get( const char *word ) {
+	HELP_TERM *term;
+	unsigned int h;
+
+	if ( ( term = term_find( word ) ) != NULL )
+		return term;
+
+	h = term_hash_fn( word );
+	term = calloc( 1, sizeof( HELP_TERM ) );
+	term->word = str_dup( word );
+	term->next = term_hash[h];
+	term_hash[h] = term;
+	term_count++;
+	return term;
+}
+
+static void term_add_hit( const char *word, int ordinal, bool is_keyword ) {
+	HELP_TERM *term = term_get( word );
+	HELP_POSTING *post;
+
+	if ( term->post_count == 0 || term->posts[term->post_count - 1].help != ordinal ) {
+		if ( term->post_count >= term->post_cap ) {
+			term->post_cap = term->post_cap ? term->post_cap * 2 : 4;
+			term->posts = realloc( term->posts, term->post_cap * sizeof( HELP_POSTING ) );
+		}
+		post = &term->posts[term->post_count++];
+		post->help = ordinal;
+		post->kw_hits = 0;
+		post->body_hits = 0;
+	}
+
+	post = &term->posts[term->post_count - 1];
+	if ( is_keyword ) {
+		post->kw_hits++;
+		term->keyword = TRUE;
+	} else
+		post->body_hits++;
+}
+
+/*
+ * Split text into lowercase alphanumeric words, skipping #-color codes
+ * the same way mxp_strip_colors() does.
+ */
+static void index_words( const char *text, int ordinal ) {
+	char word[HELP_WORD_MAX];
+	int len = 0;
+
+	if ( text == NULL )
+		return;
+
+	for ( ;; ) {
+		if ( *text == '#' && text[1] != '\0' ) {
+			text++;
+			if ( *text == 'x' && isdigit( text[1] ) && isdigit( text[2] ) && isdigit( text[3] ) )
+				text += 4;
+			else
+				text++;
+			continue;
+		}
+
+		if ( *text != '\0' && isalnum( (unsigned char) *text ) ) {
+			if ( len < HELP_WORD_MAX - 1 )
+				word[len++] = tolower( (unsigned char) *text );
+			text++;
+			continue;
+		}
+
+		if ( len >= 2 ) {
+			word[len] = '\0';
+			term_add_hit( word, ordinal, FALSE );
+		}
+		len = 0;
+
+		if ( *text == '\0' )
+			break;
+		text++;
+	}
+}
+
+static void index_keywords( char *keyword, int ordinal ) {
+	char token[MAX_INPUT_LENGTH];
+
+	if ( keyword == NULL )
+		return;
+
+	for ( ;; ) {
+		keyword = one_argument( keyword, token );
+		if ( token[0] == '\0' )
+			break;
+		term_add_hit( token, ordinal, TRUE );
+
+		/* Quoted phrases also feed their words to the search index */
+		if ( strchr( token, ' ' ) != NULL )
+			index_words( token, ordinal );
+	}
+}
+
+static int term_sort_cmp( const void *a, const void *b ) {
+	return strcmp( ( *(HELP_TERM *const *) a )->word, ( *(HELP_TERM *const *) b )->word );
+}
+
+static void help_index_free( void ) {
+	HELP_TERM *term, *term_next;
+	int i;
+
+	for ( i = 0; i < HELP_HASH_SIZE; i++ ) {
+		for ( term = term_hash[i]; term != NULL; term = term_next ) {
+			term_next = term->next;
+			free( term->word );
+			free( term->posts );
+			free( term );
+		}
+		term_hash[i] = NULL;
+	}
+
+	free( kw_terms );
+	free( help_vec );
+	kw_terms = NULL;
+	help_vec = NULL;
+	kw_term_count = 0;
+	term_count = 0;
+	help_count = 0;
+}
+
+static void help_index_build( void ) {
+	HELP_DATA *pHelp;
+	HELP_TERM *term;
+	int i, n;
+
+	help_index_free();
+
+	n = 0;
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node )
+		n++;
+
+	help_vec = malloc( ( n > 0 ? n : 1 ) * sizeof( HELP_DATA * ) );
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
+		help_vec[help_count] = pHelp;
+		index_keywords( pHelp->keyword, help_count );
+		index_words( pHelp->text, help_count );
+		help_count++;
+	}
+
+	n = 0;
+	for ( i = 0; i < HELP_HASH_SIZE; i++ )
+		for ( term = term_hash[i]; term != NULL; term = term->next )
+			if ( term->keyword )
+				n++;
+
+	kw_terms = malloc( ( n > 0 ? n : 1 ) * sizeof( HELP_TERM * ) );
+	for ( i = 0; i < HELP_HASH_SIZE; i++ )
+		for ( term = term_hash[i]; term != NULL; term = term->next )
+			if ( term->keyword )
+				kw_terms[kw_term_count++] = term;
+	qsort( kw_terms, kw_term_count, sizeof( HELP_TERM * ), term_sort_cmp );
+
+	index_dirty = FALSE;
+	rebuild_count++;
+}
+
+static void help_index_refresh( void ) {
+	if ( index_dirty )
+		help_index_build();
+}
+
+void help_index_invalidate( void ) {
+	index_dirty = TRUE;
+}
+
+static bool help_visible( CHAR_DATA *ch, HELP_DATA *pHelp, int lev ) {
+	if ( pHelp->level > get_trust( ch ) )
+		return FALSE;
+	if ( lev != -2 && pHelp->level != lev )
+		return FALSE;
+	return TRUE;
+}
+
+/* First keyword term whose word is >= prefix */
+static int kw_lower_bound( const char *prefix ) {
+	int lo = 0, hi = kw_term_count;
+
+	while ( lo < hi ) {
+		int mid = ( lo + hi ) / 2;
+		if ( strcmp( kw_terms[mid]->word, prefix ) < 0 )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+HELP_DATA *help_index_find( CHAR_DATA *ch, char *argall, int lev ) {
+	char first[MAX_INPUT_LENGTH];
+	HELP_TERM *term;
+	size_t len;
+	int best, i, j;
+
+	if ( argall[0] == '\0' )
+		return NULL;
+
+	help_index_refresh();
+
+	/*
+	 * Exact keyword token: one hash probe.  An earlier entry may still
+	 * match as a prefix, so this only bounds the scan below.
+	 */
+	best = help_count;
+	if ( ( term = term_find( argall ) ) != NULL && term->keyword ) {
+		for ( i = 0; i < term->post_count; i++ ) {
+			if ( term->posts[i].kw_hits > 0
+				&& help_visible( ch, help_vec[term->posts[i].help], lev ) ) {
+				best = term->posts[i].help;
+				break;
+			}
+		}
+	}
+
+	/*
+	 * Prefix match.  Any entry is_name() accepts has a keyword token that
+	 * starts with the first word of the argument, so only those entries
+	 * need the full check.  Keep the earliest in g_helps order.
+	 */
+	one_argument( argall, first );
+	len = strlen( first );
+	if ( len == 0 )
+		return best < help_count ? help_vec[best] : NULL;
+
+	for ( i = kw_lower_bound( first ); i < kw_term_count; i++ ) {
+		term = kw_terms[i];
+		if ( strncmp( term->word, first, len ) )
+			break;
+		for ( j = 0; j < term->post_count && term->posts[j].help < best; j++ ) {
+			HELP_DATA *pHelp = help_vec[term->posts[j].help];
+
+			if ( term->posts[j].kw_hits == 0 || !help_visible( ch, pHelp, lev ) )
+				continue;
+			if ( is_name( argall, pHelp->keyword ) )
+				best = term->posts[j].help;
+		}
+	}
+
+	return best < help_count ? help_vec[best] : NULL;
+}
+
+/*
+ * Levenshtein distance, giving up once every cell in a row exceeds limit.
+ */
+static int bounded_distance( const char *a, const char *b, int limit ) {
+	int prev[MAX_INPUT_LENGTH + 1], cur[MAX_INPUT_LENGTH + 1];
+	int la = strlen( a ), lb = strlen( b );
+	int i, j;
+
+	if ( la > MAX_INPUT_LENGTH || lb > MAX_INPUT_LENGTH )
+		return limit + 1;
+	if ( abs( la - lb ) > limit )
+		return limit + 1;
+
+	for ( j = 0; j <= lb; j++ )
+		prev[j] = j;
+
+	for ( i = 1; i <= la; i++ ) {
+		int row_min;
+
+		cur[0] = i;
+		row_min = i;
+		for ( j = 1; j <= lb; j++ ) {
+			int cost = ( a[i - 1] == b[j - 1] ) ? 0 : 1;
+			int v = prev[j - 1] + cost;
+
+			if ( prev[j] + 1 < v )
+				v = prev[j] + 1;
+			if ( cur[j - 1] + 1 < v )
+				v = cur[j - 1] + 1;
+			cur[j] = v;
+			if ( v < row_min )
+				row_min = v;
+		}
+		if ( row_min > limit )
+			return limit + 1;
+		memcpy( prev, cur, ( lb + 1 ) * sizeof( int ) );
+	}
+
+	return prev[lb];
+}
+
+typedef struct help_rank {
+	int help;
+	int score;
+} HELP_RANK;
+
+static int rank_ascending( const void *a, const void *b ) {
+	const HELP_RANK *ra = a, *rb = b;
+
+	if ( ra->score != rb->score )
+		return ra->score - rb->score;
+	return ra->help - rb->help;
+}
+
+static int rank_descending( const void *a, const void *b ) {
+	const HELP_RANK *ra = a, *rb = b;
+
+	if ( ra->score != rb->score )
+		return rb->score - ra->score;
+	return ra->help - rb->help;
+}
+
+int help_index_suggest( CHAR_DATA *ch, const char *word, HELP_DATA **out, int max ) {
+	HELP_RANK *ranks;
+	int *best;
+	int limit, i, j, n;
+
+	if ( word == NULL || word[0] == '\0' || max <= 0 )
+		return 0;
+
+	help_index_refresh();
+	if ( help_count == 0 )
+		return 0;
+
+	/* Short words tolerate one typo, longer ones two */
+	limit = strlen( word ) <= 4 ? 1 : 2;
+
+	best = malloc( help_count * sizeof( int ) );
+	for ( i = 0; i < help_count; i++ )
+		best[i] = INT_MAX;
+
+	/* Score: 1 = one edit away, 2 = contains the word, 3 = two edits away */
+	for ( i = 0; i < kw_term_count; i++ ) {
+		HELP_TERM *term = kw_terms[i];
+		int score, d;
+
+		d = bounded_distance( word, term->word, limit );
+		if ( d <= 1 )
+			score = 1;
+		else if ( strstr( term->word, word ) != NULL )
+			score = 2;
+		else if ( d <= limit )
+			score = 3;
+		else
+			continue;
+
+		for ( j = 0; j < term->post_count; j++ ) {
+			int h = term->posts[j].help;
+
+			if ( term->posts[j].kw_hits > 0 && score < best[h] )
+				best[h] = score;
+		}
+	}
+
+	ranks = malloc( help_count * sizeof( HELP_RANK ) );
+	n = 0;
+	for ( i = 0; i < help_count; i++ ) {
+		if ( best[i] == INT_MAX || !help_visible( ch, help_vec[i], -2 ) )
+			continue;
+		ranks[n].help = i;
+		ranks[n].score = best[i];
+		n++;
+	}
+	qsort( ranks, n, sizeof( HELP_RANK ), rank_ascending );
+
+	if ( n > max )
+		n = max;
+	for ( i = 0; i < n; i++ )
+		out[i] = help_vec[ranks[i].help];
+
+	free( ranks );
+	free( best );
+	return n;
+}
+
+int help_index_search( CHAR_DATA *ch, const char *query, HELP_DATA **out, int max ) {
+	char words[HELP_QUERY_MAX][MAX_INPUT_LENGTH];
+	char *p = (char *) query;
+	HELP_RANK *ranks;
+	unsigned int *matched;
+	int *score;
+	int nwords = 0;
+	int i, j, w, n;
+
+	if ( query == NULL || max <= 0 )
+		return 0;
+
+	while ( nwords < HELP_QUERY_MAX ) {
+		p = one_argument( p, words[nwords] );
+		if ( words[nwords][0] == '\0' )
+			break;
+		nwords++;
+	}
+	if ( nwords == 0 )
+		return 0;
+
+	help_index_refresh();
+	if ( help_count == 0 )
+		return 0;
+
+	score = calloc( help_count, sizeof( int ) );
+	matched = calloc( help_count, sizeof( unsigned int ) );
+
+	/*
+	 * Substring match against the vocabulary rather than every body:
+	 * the term list is far smaller than the text it was built from.
+	 */
+	for ( w = 0; w < nwords; w++ ) {
+		for ( i = 0; i < HELP_HASH_SIZE; i++ ) {
+			HELP_TERM *term;
+
+			for ( term = term_hash[i]; term != NULL; term = term->next ) {
+				int weight;
+
+				if ( strstr( term->word, words[w] ) == NULL )
+					continue;
+				weight = strcmp( term->word, words[w] ) ? 1 : 2;
+
+				for ( j = 0; j < term->post_count; j++ ) {
+					HELP_POSTING *post = &term->posts[j];
+
+					score[post->help] += weight * ( post->kw_hits * 10 + post->body_hits );
+					matched[post->help] |= 1u << w;
+				}
+			}
+		}
+	}
+
+	ranks = malloc( help_count * sizeof( HELP_RANK ) );
+	n = 0;
+	for ( i = 0; i < help_count; i++ ) {
+		if ( matched[i] != ( 1u << nwords ) - 1 || !help_visible( ch, help_vec[i], -2 ) )
+			continue;
+		ranks[n].help = i;
+		ranks[n].score = score[i];
+		n++;
+	}
+	qsort( ranks, n, sizeof( HELP_RANK ), rank_descending );
+
+	if ( n > max )
+		n = max;
+	for ( i = 0; i < n; i++ )
+		out[i] = help_vec[ranks[i].help];
+
+	free( ranks );
+	free( matched );
+	free( score );
+	return n;
+}
+
+int help_index_term_count( void ) {
+	help_index_refresh();
+	return term_count;
+}
+
+int help_index_rebuild_count( void ) {
+	return rebuild_count;
+}
@@ -0,0 +1,49 @@
+/*
+ * help_index.h - Inverted index over help keywords and body text
+ *
+ * get_help() used to walk every entry in g_helps and run is_name() against
+ * each keyword list.  The index maps every keyword token and body word to a
+ * posting list of help entries (kept in g_helps order), so exact keyword
+ * hits are a single hash probe and prefix matches only verify candidates.
+ *
+ * The index holds raw HELP_DATA pointers.  Anything that adds, removes or
+ * re-keys a help entry must call help_index_invalidate(); the index is then
+ * rebuilt lazily on the next lookup.  Levels are read live from HELP_DATA,
+ * so trust filtering never goes stale.
+ */
+
+#ifndef HELP_INDEX_H
+#define HELP_INDEX_H
+
+/* Maximum results returned by suggestion and search queries */
+#define HELP_INDEX_MAX_RESULTS 10
+
+/* Mark the index stale (help added, removed, re-keyed or re-texted) */
+void help_index_invalidate( void );
+
+/*
+ * Find the help entry for an already-normalized argument string.
+ * Returns the first entry in g_helps order whose keyword list satisfies
+ * is_name(), whether it matches exactly or as a prefix.
+ * lev is -2 for "any level", or the exact level requested with N.keyword.
+ */
+HELP_DATA *help_index_find( CHAR_DATA *ch, char *argall, int lev );
+
+/*
+ * Ranked "did you mean" candidates for a keyword that did not match.
+ * Returns the number of entries written to out (at most max).
+ */
+int help_index_suggest( CHAR_DATA *ch, const char *word, HELP_DATA **out, int max );
+
+/*
+ * Substring search over keywords and body text.  Every word in query must
+ * appear (as a substring of some indexed term) in the entry.  Keyword hits
+ * rank above body hits.  Returns the number of entries written to out.
+ */
+int help_index_search( CHAR_DATA *ch, const char *query, HELP_DATA **out, int max );
+
+/* Index size, for diagnostics and tests */
+int help_index_term_count( void );
+int help_index_rebuild_count( void );
+
+#endif /* HELP_INDEX_H */
@@ -0,0 +1,288 @@
+/***************************************************************************
+ *  map_layout.c - Precomputed 2D room layouts                             *
+ *                                                                         *
+ *  See map_layout.h.  A sheet is built by a breadth-first walk that      *
+ *  records coordinates in a small hash, then packed into a bounding-box   *
+ *  grid so a map is a slice of it.                                        *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "merc.h"
+#include "map_layout.h"
+
+/* Direction offsets: N=0, E=1, S=2, W=3 */
+static const int layout_dx[] = { 0, 1, 0, -1 };
+static const int layout_dy[] = { 1, 0, -1, 0 };
+
+static MAP_SHEET *sheet_list;
+static bool layout_dirty = TRUE;
+static unsigned int layout_stamp;	/* room->map_stamp of the sheet being built */
+
+typedef struct {
+	ROOM_INDEX_DATA *room;
+	int x, y;
+	int depth;	/* Steps outside the sheet's area; 0 inside it */
+} layout_entry;
+
+/* Coordinate -> room, open addressing; only lives for one sheet build */
+typedef struct {
+	int64_t *key;
+	ROOM_INDEX_DATA **room;
+	size_t mask;
+	size_t used;
+} layout_hash;
+
+static int64_t layout_key( int x, int y ) {
+	return ( (int64_t) x << 32 ) | (uint32_t) y;
+}
+
+static size_t layout_slot( const layout_hash *h, int64_t key ) {
+	uint64_t k = (uint64_t) key * 0x9e3779b97f4a7c15ull;
+	size_t i = (size_t) ( k >> 32 ) & h->mask;
+
+	while ( h->room[i] != NULL && h->key[i] != key )
+		i = ( i + 1 ) & h->mask;
+	return i;
+}
+
+static void layout_hash_init( layout_hash *h, size_t size ) {
+	h->key = calloc( size, sizeof( *h->key ) );
+	h->room = calloc( size, sizeof( *h->room ) );
+	h->mask = size - 1;
+	h->used = 0;
+}
+
+static ROOM_INDEX_DATA *layout_hash_get( const layout_hash *h, int x, int y ) {
+	return h->room[layout_slot( h, layout_key( x, y ) )];
+}
+
+static void layout_hash_put( layout_hash *h, int x, int y, ROOM_INDEX_DATA *room ) {
+	size_t i;
+
+	if ( ( h->used + 1 ) * 2 > h->mask + 1 ) {
+		layout_hash old = *h;
+		size_t j;
+
+		layout_hash_init( h, ( old.mask + 1 ) * 2 );
+		for ( j = 0; j <= old.mask; j++ ) {
+			if ( old.room[j] != NULL ) {
+				i = layout_slot( h, old.key[j] );
+				h->key[i] = old.key[j];
+				h->room[i] = old.room[j];
+				h->used++;
+			}
+		}
+		free( old.key );
+		free( old.room );
+	}
+	i = layout_slot( h, layout_key( x, y ) );
+	h->key[i] = layout_key( x, y );
+	h->room[i] = room;
+	h->used++;
+}
+
+static bool layout_one_way( ROOM_INDEX_DATA *from, int dir ) {
+	EXIT_DATA *reverse = from->exit[dir]->to_room->exit[rev_dir[dir]];
+
+	return reverse == NULL || reverse->to_room != from;
+}
+
+static unsigned short layout_cell_bits( const MAP_SHEET *sheet, ROOM_INDEX_DATA *room, int x, int y ) {
+	unsigned short bits = 0;
+	int dir, kind;
+
+	for ( dir = 0; dir < 4; dir++ ) {
+		EXIT_DATA *pexit = room->exit[dir];
+		ROOM_INDEX_DATA *there;
+
+		if ( pexit == NULL || pexit->to_room == NULL )
+			continue;
+		kind = layout_one_way( room, dir ) ? MAP_EXIT_ONE_WAY : MAP_EXIT_TWO_WAY;
+		there = map_sheet_room( sheet, x + layout_dx[dir], y + layout_dy[dir] );
+		if ( there != NULL ? there != pexit->to_room : pexit->to_room->map_stamp == layout_stamp )
+			kind = MAP_EXIT_WARPED;	/* Next cell holds another room, or ours sits elsewhere */
+		bits |= kind << ( dir * 2 );
+	}
+
+	if ( room->exit[DIR_UP] && room->exit[DIR_UP]->to_room )
+		bits |= MAP_CELL_UP;
+	if ( room->exit[DIR_DOWN] && room->exit[DIR_DOWN]->to_room )
+		bits |= MAP_CELL_DOWN;
+	for ( dir = 0; dir < 6; dir++ )
+		if ( room->exit[dir] != NULL )
+			break;
+	if ( dir == 6 )
+		bits |= MAP_CELL_DEAD_END;
+	return bits;
+}
+
+/*
+ * Lay out everything reachable from seed on a new sheet.  seed's area
+ * owns the sheet; its rooms not yet on another sheet become primaries.
+ */
+static void layout_sheet( ROOM_INDEX_DATA *seed ) {
+	AREA_DATA *area = seed->area;
+	MAP_SHEET *sheet;
+	layout_entry *queue;
+	layout_hash hash;
+	size_t cap = 64, head = 0, tail = 0, i;
+	int min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+	int dir, x, y;
+
+	layout_stamp++;
+	queue = malloc( cap * sizeof( *queue ) );
+	layout_hash_init( &hash, 64 );
+
+	sheet = calloc( 1, sizeof( *sheet ) );
+	sheet->area = area;
+
+	seed->map_stamp = layout_stamp;
+	layout_hash_put( &hash, 0, 0, seed );
+	queue[tail++] = ( layout_entry ) { seed, 0, 0, 0 };
+
+	while ( head < tail ) {
+		layout_entry e = queue[head++];
+
+		for ( dir = 0; dir < 4; dir++ ) {
+			EXIT_DATA *pexit = e.room->exit[dir];
+			ROOM_INDEX_DATA *to;
+			int depth;
+
+			if ( pexit == NULL || ( to = pexit->to_room ) == NULL )
+				continue;
+			if ( to->map_stamp == layout_stamp )
+				continue;
+			x = e.x + layout_dx[dir];
+			y = e.y + layout_dy[dir];
+			if ( layout_hash_get( &hash, x, y ) != NULL )
+				continue;	/* Taken: to is warped from here */
+
+			depth = ( to->area == area && to->map_sheet == NULL ) ? 0 : e.depth + 1;
+			if ( depth > MAX_MAP_RADIUS )
+				continue;
+
+			to->map_stamp = layout_stamp;
+			layout_hash_put( &hash, x, y, to );
+			if ( tail == cap ) {
+				cap *= 2;
+				queue = realloc( queue, cap * sizeof( *queue ) );
+			}
+			queue[tail++] = ( layout_entry ) { to, x, y, depth };
+			if ( x < min_x ) min_x = x;
+			if ( x > max_x ) max_x = x;
+			if ( y < min_y ) min_y = y;
+			if ( y > max_y ) max_y = y;
+		}
+	}
+
+	sheet->width = max_x - min_x + 1;
+	sheet->height = max_y - min_y + 1;
+	sheet->room = calloc( (size_t) sheet->width * sheet->height, sizeof( *sheet->room ) );
+	sheet->cell = calloc( (size_t) sheet->width * sheet->height, sizeof( *sheet->cell ) );
+
+	for ( i = 0; i < tail; i++ ) {
+		x = queue[i].x - min_x;
+		y = queue[i].y - min_y;
+		sheet->room[y * sheet->width + x] = queue[i].room;
+		if ( queue[i].depth == 0 ) {
+			queue[i].room->map_sheet = sheet;
+			queue[i].room->map_x = (short) x;
+			queue[i].room->map_y = (short) y;
+		}
+	}
+	for ( i = 0; i < tail; i++ ) {
+		x = queue[i].x - min_x;
+		y = queue[i].y - min_y;
+		sheet->cell[y * sheet->width + x] = layout_cell_bits( sheet, queue[i].room, x, y );
+	}
+
+	free( queue );
+	free( hash.key );
+	free( hash.room );
+	sheet->next = sheet_list;
+	sheet_list = sheet;
+}
+
+static int layout_vnum_cmp( const void *a, const void *b ) {
+	const ROOM_INDEX_DATA *ra = *(ROOM_INDEX_DATA *const *) a;
+	const ROOM_INDEX_DATA *rb = *(ROOM_INDEX_DATA *const *) b;
+
+	return ( ra->vnum > rb->vnum ) - ( ra->vnum < rb->vnum );
+}
+
+static void layout_free_all( void ) {
+	MAP_SHEET *sheet, *sheet_next;
+
+	for ( sheet = sheet_list; sheet != NULL; sheet = sheet_next ) {
+		sheet_next = sheet->next;
+		free( sheet->room );
+		free( sheet->cell );
+		free( sheet );
+	}
+	sheet_list = NULL;
+}
+
+/*
+ * Lay out every room.  Seeds go in vnum order so a given world always
+ * produces the same sheets.
+ */
+void map_layout_build( void ) {
+	ROOM_INDEX_DATA **rooms;
+	ROOM_INDEX_DATA *room;
+	size_t count = 0, n = 0, i;
+	int hash;
+
+	layout_free_all();
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ ) {
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next ) {
+			room->map_sheet = NULL;
+			count++;
+		}
+	}
+
+	rooms = malloc( ( count > 0 ? count : 1 ) * sizeof( *rooms ) );
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ )
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next )
+			rooms[n++] = room;
+	qsort( rooms, n, sizeof( *rooms ), layout_vnum_cmp );
+
+	for ( i = 0; i < n; i++ )
+		if ( rooms[i]->map_sheet == NULL )
+			layout_sheet( rooms[i] );
+
+	free( rooms );
+	layout_dirty = FALSE;
+}
+
+void map_layout_invalidate( void ) {
+	layout_dirty = TRUE;
+}
+
+bool map_layout_find( ROOM_INDEX_DATA *room, MAP_SHEET **sheet, int *x, int *y ) {
+	if ( layout_dirty )
+		map_layout_build();
+	if ( room == NULL || room->map_sheet == NULL )
+		return FALSE;
+	*sheet = room->map_sheet;
+	*x = room->map_x;
+	*y = room->map_y;
+	return TRUE;
+}
+
+void map_layout_get_stats( int *sheets, long *cells, long *rooms ) {
+	MAP_SHEET *sheet;
+	long i;
+
+	*sheets = 0;
+	*cells = 0;
+	*rooms = 0;
+	for ( sheet = sheet_list; sheet != NULL; sheet = sheet->next ) {
+		( *sheets )++;
+		*cells += (long) sheet->width * sheet->height;
+		for ( i = 0; i < (long) sheet->width * sheet->height; i++ )
+			if ( sheet->room[i] != NULL )
+				( *rooms )++;
+	}
+}
@@ -0,0 +1,70 @@
+/*
+ * map_layout.h - Precomputed 2D room layouts for map, amap and automap
+ *
+ * Each area is laid out once on a grid by walking its north/east/south/west
+ * exits from its lowest vnum.  A room that would land on a cell already
+ * taken (a non-Euclidean area) starts a sheet of its own, as do rooms
+ * reachable only by up/down, so every room is the primary of exactly one
+ * sheet.  Neighbouring areas' rooms are copied in up to MAX_MAP_RADIUS
+ * steps past the border, so maps near an area edge still show next door.
+ *
+ * Cells hold only what the room graph decides: the room, exit kinds,
+ * up/down and dead ends.  Doors, walls and the viewer's marker change
+ * without OLC and are overlaid by the renderer.  A window holding a
+ * warped exit has no single right placement, so act_map.c walks exits
+ * from the viewer there instead.
+ *
+ * Layouts are built at boot and rebuilt on the next lookup after
+ * map_layout_invalidate() (OLC room, exit or area edits).
+ */
+
+#ifndef MAP_LAYOUT_H
+#define MAP_LAYOUT_H
+
+/* Largest radius any map asks for; also the cross-area margin */
+#define MAX_MAP_RADIUS 5
+
+/* Exit kinds, two bits per direction (N, E, S, W) */
+#define MAP_EXIT_NONE	 0
+#define MAP_EXIT_TWO_WAY 1
+#define MAP_EXIT_ONE_WAY 2
+#define MAP_EXIT_WARPED	 3
+#define MAP_CELL_EXIT( bits, dir ) ( ( ( bits ) >> ( ( dir ) * 2 ) ) & 3 )
+
+#define MAP_CELL_UP		  0x100
+#define MAP_CELL_DOWN	  0x200
+#define MAP_CELL_DEAD_END 0x400
+
+typedef struct map_sheet MAP_SHEET;
+
+struct map_sheet {
+	MAP_SHEET *next;
+	AREA_DATA *area;
+	int width;
+	int height;
+	ROOM_INDEX_DATA **room;	 /* width * height, row y = 0 is the south edge */
+	unsigned short *cell;	 /* MAP_CELL_* bits, same indexing */
+};
+
+/* Room at sheet cell (x, y), or NULL when empty or off the sheet */
+static inline ROOM_INDEX_DATA *map_sheet_room( const MAP_SHEET *sheet, int x, int y ) {
+	if ( x < 0 || y < 0 || x >= sheet->width || y >= sheet->height )
+		return NULL;
+	return sheet->room[y * sheet->width + x];
+}
+
+static inline unsigned short map_sheet_cell( const MAP_SHEET *sheet, int x, int y ) {
+	return sheet->cell[y * sheet->width + x];
+}
+
+/*
+ * Sheet and cell where room is laid out.  FALSE for rooms the layout has
+ * not seen (created since the last build outside OLC).
+ */
+bool map_layout_find( ROOM_INDEX_DATA *room, MAP_SHEET **sheet, int *x, int *y );
+
+void map_layout_build( void );
+void map_layout_invalidate( void );
+void map_layout_get_stats( int *sheets, long *cells, long *rooms );
+
+#endif /* MAP_LAYOUT_H */
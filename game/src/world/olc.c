@@ -36,6 +36,9 @@
 #include <time.h>
 #include "merc.h"
 #include "olc.h"
+#include "map_layout.h"
+#include "pathfind.h"
+#include "room_render.h"
 
 /*
  * Local functions.
@@ -382,8 +385,12 @@ void aedit( CHAR_DATA *ch, char *argument ) {
 	/* Search Table and Dispatch Command. */
 	for ( cmd = 0; *aedit_table[cmd].name; cmd++ ) {
 		if ( !str_prefix( command, aedit_table[cmd].name ) ) {
-			if ( ( *aedit_table[cmd].olc_fun )( ch, argument ) )
+			if ( ( *aedit_table[cmd].olc_fun )( ch, argument ) ) {
 				SET_BIT( pArea->area_flags, AREA_CHANGED );
+				room_render_invalidate_all();
+				map_layout_invalidate();
+				path_invalidate();
+			}
 			return;
 		}
 	}
@@ -438,8 +445,13 @@ void redit( CHAR_DATA *ch, char *argument ) {
 	/* Search Table and Dispatch Command. */
 	for ( cmd = 0; *redit_table[cmd].name; cmd++ ) {
 		if ( !str_prefix( command, redit_table[cmd].name ) ) {
-			if ( ( *redit_table[cmd].olc_fun )( ch, argument ) )
+			/* Exit edits reshape neighbours' automaps and routes too, so drop everything */
+			if ( ( *redit_table[cmd].olc_fun )( ch, argument ) ) {
 				SET_BIT( pArea->area_flags, AREA_CHANGED );
+				room_render_invalidate_all();
+				map_layout_invalidate();
+				path_invalidate();
+			}
 			return;
 		}
 	}
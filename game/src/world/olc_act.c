@@ -37,6 +37,7 @@
 #include <limits.h> /* OLC 1.1b */
 #include "merc.h"
 #include "olc.h"
+#include "help_index.h"
 
 #define HEDIT( fun ) bool fun( CHAR_DATA *ch, char *argument )
 
@@ -3005,6 +3006,7 @@ HEDIT( hedit_keyword ) {
 			}
 		}
 		pHelp->keyword = str_dup( argument );
+		help_index_invalidate();
 		return TRUE;
 	}
 	send_to_char( "Syntax: keyword [word(s)]\n\r", ch );
@@ -3038,6 +3040,7 @@ HEDIT( hedit_delete ) {
 	LIST_FOR_EACH( target, &g_helps, HELP_DATA, node ) {
 		if ( is_name( argument, target->keyword ) ) {
 			list_remove( &g_helps, &target->node );
+			help_index_invalidate();
 			top_help--;
 			send_to_char( "{rHelp removed.{x\n\r", ch );
 			return TRUE;
@@ -0,0 +1,472 @@
+/***************************************************************************
+ *  pathfind.c - Shortest paths over the room graph                        *
+ *                                                                         *
+ *  See pathfind.h.  Rooms are numbered by (area, vnum) so each area's    *
+ *  rooms are one contiguous id range; the incoming-exit index and the     *
+ *  search scratch arrays are indexed by that id.                          *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "merc.h"
+#include "pathfind.h"
+
+#define PATH_NO_HOP		   0xff
+#define PATH_TABLE_MAX	   1024	/* Larger areas get no table (n*n bytes) */
+#define PATH_CACHE_SIZE	   4096
+#define PATH_CACHE_STEPS   48
+
+/* Per-area next-hop table, hung off AREA_DATA */
+struct path_area {
+	int base;			/* Id of the area's lowest vnum */
+	int n;				/* Rooms in the area */
+	uint32_t sig;		/* Hash of the area's own exits when hop was built */
+	unsigned char *hop;	/* hop[from * n + to]: first direction, or PATH_NO_HOP */
+};
+
+typedef struct {
+	int from, to;
+	int flags;
+	unsigned int gen;
+	int len;
+	unsigned char dirs[PATH_CACHE_STEPS];
+} path_cache_entry;
+
+static bool graph_dirty = TRUE;
+static unsigned int graph_gen = 1;
+static ROOM_INDEX_DATA **graph_room;
+static int graph_n;
+
+/* Incoming exits of room v: in_from/in_dir[in_start[v] .. in_start[v + 1]) */
+static int *in_start;
+static int *in_from;
+static unsigned char *in_dir;
+
+/* Search scratch, by room id */
+static unsigned int search_stamp;
+static unsigned int *seen_f, *seen_b;
+static int *link_f, *link_b;	/* Parent (forward) / next room (backward) */
+static unsigned char *dir_f, *dir_b;
+static int *dist_f, *dist_b;
+static int *queue_f, *queue_b;
+static int *route;
+
+static path_cache_entry path_cache[PATH_CACHE_SIZE];
+static PATH_STATS stats;
+
+static int path_room_cmp( const void *a, const void *b ) {
+	const ROOM_INDEX_DATA *ra = *(ROOM_INDEX_DATA *const *) a;
+	const ROOM_INDEX_DATA *rb = *(ROOM_INDEX_DATA *const *) b;
+
+	if ( ra->area != rb->area )
+		return ( (uintptr_t) ra->area > (uintptr_t) rb->area ) ? 1 : -1;
+	return ( ra->vnum > rb->vnum ) - ( ra->vnum < rb->vnum );
+}
+
+static bool path_known( ROOM_INDEX_DATA *room ) {
+	return room->path_id >= 0 && room->path_id < graph_n && graph_room[room->path_id] == room;
+}
+
+/* FNV-1a over an area's rooms and the exits that stay inside it */
+static uint32_t path_area_sig( int base, int n ) {
+	uint32_t h = 2166136261u;
+	int i, door;
+
+	for ( i = base; i < base + n; i++ ) {
+		ROOM_INDEX_DATA *room = graph_room[i];
+
+		h = ( h ^ (uint32_t) room->vnum ) * 16777619u;
+		for ( door = 0; door < 6; door++ ) {
+			EXIT_DATA *pexit = room->exit[door];
+			int to = -1;
+
+			if ( pexit != NULL && pexit->to_room != NULL && pexit->to_room->area == room->area )
+				to = pexit->to_room->vnum;
+			h = ( h ^ (uint32_t) to ) * 16777619u;
+		}
+	}
+	return h;
+}
+
+static void path_area_update( AREA_DATA *area, int base, int n ) {
+	struct path_area *pa = area->path;
+	uint32_t sig = path_area_sig( base, n );
+
+	if ( pa == NULL ) {
+		pa = calloc( 1, sizeof( *pa ) );
+		area->path = pa;
+	}
+	if ( pa->hop != NULL && ( pa->sig != sig || pa->n != n ) ) {
+		stats.table_bytes -= (long) pa->n * pa->n;
+		free( pa->hop );
+		pa->hop = NULL;
+	}
+	pa->base = base;
+	pa->n = n;
+	pa->sig = sig;
+}
+
+/*
+ * Number every room and index incoming exits.  Cheap (one pass over
+ * rooms and exits); area tables survive unless their exits changed.
+ */
+static void path_graph_build( void ) {
+	ROOM_INDEX_DATA *room;
+	int hash, i, door, n = 0, edges = 0, start;
+
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ )
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next )
+			n++;
+
+	free( graph_room );
+	graph_room = malloc( ( n > 0 ? n : 1 ) * sizeof( *graph_room ) );
+	graph_n = 0;
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ )
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next )
+			graph_room[graph_n++] = room;
+	qsort( graph_room, graph_n, sizeof( *graph_room ), path_room_cmp );
+	for ( i = 0; i < graph_n; i++ )
+		graph_room[i]->path_id = i;
+
+	free( in_start );
+	in_start = calloc( graph_n + 1, sizeof( *in_start ) );
+	for ( i = 0; i < graph_n; i++ ) {
+		for ( door = 0; door < 6; door++ ) {
+			EXIT_DATA *pexit = graph_room[i]->exit[door];
+
+			if ( pexit != NULL && pexit->to_room != NULL && path_known( pexit->to_room ) ) {
+				in_start[pexit->to_room->path_id + 1]++;
+				edges++;
+			}
+		}
+	}
+	for ( i = 0; i < graph_n; i++ )
+		in_start[i + 1] += in_start[i];
+
+	free( in_from );
+	free( in_dir );
+	in_from = malloc( ( edges > 0 ? edges : 1 ) * sizeof( *in_from ) );
+	in_dir = malloc( edges > 0 ? edges : 1 );
+	{
+		int *fill = malloc( ( graph_n > 0 ? graph_n : 1 ) * sizeof( *fill ) );
+
+		memcpy( fill, in_start, graph_n * sizeof( *fill ) );
+		for ( i = 0; i < graph_n; i++ ) {
+			for ( door = 0; door < 6; door++ ) {
+				EXIT_DATA *pexit = graph_room[i]->exit[door];
+
+				if ( pexit != NULL && pexit->to_room != NULL && path_known( pexit->to_room ) ) {
+					int at = fill[pexit->to_room->path_id]++;
+
+					in_from[at] = i;
+					in_dir[at] = (unsigned char) door;
+				}
+			}
+		}
+		free( fill );
+	}
+
+	for ( start = 0; start < graph_n; start = i ) {
+		for ( i = start; i < graph_n && graph_room[i]->area == graph_room[start]->area; i++ )
+			;
+		if ( graph_room[start]->area != NULL )
+			path_area_update( graph_room[start]->area, start, i - start );
+	}
+
+#define PATH_SCRATCH( p ) p = realloc( p, ( graph_n > 0 ? graph_n : 1 ) * sizeof( *p ) )
+	PATH_SCRATCH( seen_f );
+	PATH_SCRATCH( seen_b );
+	PATH_SCRATCH( link_f );
+	PATH_SCRATCH( link_b );
+	PATH_SCRATCH( dir_f );
+	PATH_SCRATCH( dir_b );
+	PATH_SCRATCH( dist_f );
+	PATH_SCRATCH( dist_b );
+	PATH_SCRATCH( queue_f );
+	PATH_SCRATCH( queue_b );
+	PATH_SCRATCH( route );
+#undef PATH_SCRATCH
+	memset( seen_f, 0, graph_n * sizeof( *seen_f ) );
+	memset( seen_b, 0, graph_n * sizeof( *seen_b ) );
+	search_stamp = 0;
+
+	graph_gen++;
+	graph_dirty = FALSE;
+}
+
+/* Make sure both rooms are numbered; a room made since the last build forces one */
+static bool path_ready( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to ) {
+	if ( graph_dirty || !path_known( from ) || !path_known( to ) )
+		path_graph_build();
+	return path_known( from ) && path_known( to );
+}
+
+static bool path_room_ok( ROOM_INDEX_DATA *room, int flags, AREA_DATA *area ) {
+	if ( ( flags & PATH_NO_MOB ) && IS_SET( room->room_flags, ROOM_NO_MOB ) )
+		return FALSE;
+	if ( ( flags & PATH_STAY_AREA ) && room->area != area )
+		return FALSE;
+	return TRUE;
+}
+
+/* Take step dir out of room under flags; the room reached goes in *next */
+static bool path_step_ok( ROOM_INDEX_DATA *room, int dir, int flags, AREA_DATA *area,
+	ROOM_INDEX_DATA **next ) {
+	EXIT_DATA *pexit = room->exit[dir];
+
+	if ( pexit == NULL || pexit->to_room == NULL )
+		return FALSE;
+	if ( ( flags & PATH_OPEN_ONLY ) && IS_SET( pexit->exit_info, EX_CLOSED ) )
+		return FALSE;
+	if ( !path_room_ok( pexit->to_room, flags, area ) )
+		return FALSE;
+	*next = pexit->to_room;
+	return TRUE;
+}
+
+/*
+ * Bidirectional breadth-first search.  Expands one whole level of the
+ * smaller frontier at a time and, once the frontiers meet, finishes that
+ * level so the shortest meeting point wins.  Route goes in route[].
+ */
+static int path_search( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth ) {
+	AREA_DATA *area = from->area;
+	int head_f = 0, tail_f = 0, head_b = 0, tail_b = 0;
+	int depth_f = 0, depth_b = 0;
+	int best = -1, meet = -1;
+	int src = from->path_id, dst = to->path_id;
+	int i, len, at;
+
+	stats.searches++;
+	if ( ++search_stamp == 0 ) {
+		memset( seen_f, 0, graph_n * sizeof( *seen_f ) );
+		memset( seen_b, 0, graph_n * sizeof( *seen_b ) );
+		search_stamp = 1;
+	}
+
+	seen_f[src] = search_stamp;
+	dist_f[src] = 0;
+	queue_f[tail_f++] = src;
+	seen_b[dst] = search_stamp;
+	dist_b[dst] = 0;
+	queue_b[tail_b++] = dst;
+
+	while ( best < 0 && head_f < tail_f && head_b < tail_b && depth_f + depth_b < max_depth ) {
+		int level_end;
+
+		if ( tail_f - head_f <= tail_b - head_b ) {
+			for ( level_end = tail_f; head_f < level_end; head_f++ ) {
+				int u = queue_f[head_f];
+				int door;
+
+				for ( door = 0; door < 6; door++ ) {
+					ROOM_INDEX_DATA *next;
+					int v;
+
+					if ( !path_step_ok( graph_room[u], door, flags, area, &next ) || !path_known( next ) )
+						continue;
+					v = next->path_id;
+					if ( seen_f[v] == search_stamp )
+						continue;
+					seen_f[v] = search_stamp;
+					link_f[v] = u;
+					dir_f[v] = (unsigned char) door;
+					dist_f[v] = depth_f + 1;
+					queue_f[tail_f++] = v;
+					if ( seen_b[v] == search_stamp && ( best < 0 || dist_f[v] + dist_b[v] < best ) ) {
+						best = dist_f[v] + dist_b[v];
+						meet = v;
+					}
+				}
+			}
+			depth_f++;
+		} else {
+			for ( level_end = tail_b; head_b < level_end; head_b++ ) {
+				int w = queue_b[head_b];
+				int e;
+
+				for ( e = in_start[w]; e < in_start[w + 1]; e++ ) {
+					ROOM_INDEX_DATA *next;
+					int s = in_from[e];
+
+					if ( seen_b[s] == search_stamp )
+						continue;
+					if ( s != src && !path_room_ok( graph_room[s], flags, area ) )
+						continue;
+					if ( !path_step_ok( graph_room[s], in_dir[e], flags, area, &next ) || next != graph_room[w] )
+						continue;
+					seen_b[s] = search_stamp;
+					link_b[s] = w;
+					dir_b[s] = in_dir[e];
+					dist_b[s] = depth_b + 1;
+					queue_b[tail_b++] = s;
+					if ( seen_f[s] == search_stamp && ( best < 0 || dist_f[s] + dist_b[s] < best ) ) {
+						best = dist_f[s] + dist_b[s];
+						meet = s;
+					}
+				}
+			}
+			depth_b++;
+		}
+	}
+
+	if ( best < 0 || best > max_depth )
+		return -1;
+
+	/* from .. meet along parents (reversed), then meet .. to along next links */
+	len = dist_f[meet];
+	for ( at = meet, i = len - 1; at != src; at = link_f[at], i-- )
+		route[i] = dir_f[at];
+	for ( at = meet; at != dst; at = link_b[at] )
+		route[len++] = dir_b[at];
+	return len;
+}
+
+static void path_table_build( struct path_area *pa ) {
+	int n = pa->n;
+	int *queue = malloc( n * sizeof( *queue ) );
+	int t, head, tail, e;
+
+	pa->hop = malloc( (size_t) n * n );
+	memset( pa->hop, PATH_NO_HOP, (size_t) n * n );
+
+	/* One backward search per destination, over exits inside the area */
+	for ( t = 0; t < n; t++ ) {
+		head = tail = 0;
+		queue[tail++] = t;
+		while ( head < tail ) {
+			int w = queue[head++];
+
+			for ( e = in_start[pa->base + w]; e < in_start[pa->base + w + 1]; e++ ) {
+				int s = in_from[e] - pa->base;
+
+				if ( s < 0 || s >= n || s == t || pa->hop[s * n + t] != PATH_NO_HOP )
+					continue;
+				pa->hop[s * n + t] = in_dir[e];
+				queue[tail++] = s;
+			}
+		}
+	}
+	free( queue );
+	stats.tables_built++;
+	stats.table_bytes += (long) n * n;
+}
+
+/* First step of the area table's route, if the whole route is walkable now */
+static int path_hint( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth ) {
+	struct path_area *pa = from->area != NULL ? from->area->path : NULL;
+	ROOM_INDEX_DATA *room = from;
+	int steps = 0, first = -1, t, d;
+
+	if ( pa == NULL || to->area != from->area || pa->n > PATH_TABLE_MAX )
+		return -1;
+	if ( pa->hop == NULL )
+		path_table_build( pa );
+
+	t = to->path_id - pa->base;
+	while ( room != to ) {
+		d = pa->hop[( room->path_id - pa->base ) * pa->n + t];
+		if ( d == PATH_NO_HOP || ++steps > max_depth )
+			return -1;
+		if ( !path_step_ok( room, d, flags, from->area, &room ) )
+			return -1;
+		if ( room->area != from->area || !path_known( room ) )
+			return -1;	/* Exits changed without an invalidate */
+		if ( first < 0 )
+			first = d;
+	}
+	return first;
+}
+
+static path_cache_entry *path_cache_slot( int from, int to, int flags ) {
+	unsigned int h = (unsigned int) from * 2654435761u ^ (unsigned int) to * 40503u ^ (unsigned int) flags;
+
+	return &path_cache[( h ^ ( h >> 16 ) ) & ( PATH_CACHE_SIZE - 1 )];
+}
+
+/* Cached route for the query, if it is still walkable; its length, or -1 */
+static int path_cache_get( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth ) {
+	path_cache_entry *c = path_cache_slot( from->path_id, to->path_id, flags );
+	ROOM_INDEX_DATA *room = from;
+	int i;
+
+	if ( c->gen != graph_gen || c->from != from->path_id || c->to != to->path_id
+		|| c->flags != flags || c->len > max_depth )
+		return -1;
+	for ( i = 0; i < c->len; i++ )
+		if ( !path_step_ok( room, c->dirs[i], flags, from->area, &room ) )
+			return -1;
+	if ( room != to )
+		return -1;
+	for ( i = 0; i < c->len; i++ )
+		route[i] = c->dirs[i];
+	stats.cache_hits++;
+	return c->len;
+}
+
+static void path_cache_put( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int len ) {
+	path_cache_entry *c = path_cache_slot( from->path_id, to->path_id, flags );
+	int i;
+
+	if ( len > PATH_CACHE_STEPS )
+		return;
+	c->from = from->path_id;
+	c->to = to->path_id;
+	c->flags = flags;
+	c->gen = graph_gen;
+	c->len = len;
+	for ( i = 0; i < len; i++ )
+		c->dirs[i] = (unsigned char) route[i];
+}
+
+/* Route into route[]: cache, then search */
+static int path_route( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth ) {
+	int len;
+
+	if ( ( len = path_cache_get( from, to, flags, max_depth ) ) >= 0 )
+		return len;
+	if ( ( len = path_search( from, to, flags, max_depth ) ) > 0 )
+		path_cache_put( from, to, flags, len );
+	return len;
+}
+
+int path_next_dir( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth ) {
+	int dir;
+
+	if ( from == NULL || to == NULL || from == to || max_depth < 1 )
+		return -1;
+	if ( !path_ready( from, to ) || !path_room_ok( to, flags, from->area ) )
+		return -1;
+
+	if ( ( dir = path_hint( from, to, flags, max_depth ) ) >= 0 ) {
+		stats.hint_hits++;
+		return dir;
+	}
+	return path_route( from, to, flags, max_depth ) > 0 ? route[0] : -1;
+}
+
+int path_find( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth,
+	int *dirs, int max_dirs ) {
+	int len, i;
+
+	if ( from == NULL || to == NULL )
+		return -1;
+	if ( from == to )
+		return 0;
+	if ( max_depth < 1 || !path_ready( from, to ) || !path_room_ok( to, flags, from->area ) )
+		return -1;
+
+	len = path_route( from, to, flags, max_depth );
+	for ( i = 0; i < len && i < max_dirs; i++ )
+		dirs[i] = route[i];
+	return len;
+}
+
+void path_invalidate( void ) {
+	graph_dirty = TRUE;
+}
+
+void path_get_stats( PATH_STATS *out ) {
+	*out = stats;
+}
@@ -0,0 +1,49 @@
+/*
+ * pathfind.h - Shortest paths over the room graph
+ *
+ * Searches are bidirectional breadth-first: forward along exits from the
+ * start, backward along an index of incoming exits from the goal, one
+ * level at a time on whichever side has the smaller frontier.
+ *
+ * Each area also keeps a next-hop table between every pair of its rooms
+ * over its own exits.  It is only a hint: path_next_dir() walks the
+ * hinted route under the caller's flags and falls back to a search when
+ * any step is blocked or the route is longer than max_depth.  Search
+ * results are cached by (from, to, flags) with their whole route, which
+ * is re-walked the same way before reuse, so a door that closes after
+ * caching never sends a walker back and forth.
+ *
+ * Exit edits call path_invalidate().  The exit index is rebuilt on the
+ * next query and only areas whose own exits changed lose their table.
+ */
+
+#ifndef PATHFIND_H
+#define PATHFIND_H
+
+/* Query flags */
+#define PATH_STAY_AREA 1	/* Never leave from's area */
+#define PATH_OPEN_ONLY 2	/* Closed doors block */
+#define PATH_NO_MOB	   4	/* ROOM_NO_MOB rooms block */
+
+typedef struct path_stats {
+	long hint_hits;		/* Answered from an area table */
+	long cache_hits;	/* Answered from the query cache */
+	long searches;		/* Bidirectional searches run */
+	long tables_built;	/* Area tables (re)built */
+	long table_bytes;	/* Memory held by area tables */
+} PATH_STATS;
+
+/* Direction of the first step from from to to, or -1 if none within max_depth */
+int path_next_dir( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth );
+
+/*
+ * Shortest route from from to to.  Writes up to max_dirs directions and
+ * returns the route's length (0 when from == to), or -1 if none.
+ */
+int path_find( ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to, int flags, int max_depth,
+	int *dirs, int max_dirs );
+
+void path_invalidate( void );
+void path_get_stats( PATH_STATS *stats );
+
+#endif /* PATHFIND_H */
@@ -0,0 +1,133 @@
+/***************************************************************************
+ *  room_render.c - Per-room cache of rendered look text                   *
+ *                                                                         *
+ *  See room_render.h.  Each room keeps a short list of entries, one per   *
+ *  (kind, variant) actually requested, built on first use.                *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "merc.h"
+#include "room_render.h"
+
+/* Large enough for a full description plus tint */
+#define ROOM_RENDER_BUF ( MAX_STRING_LENGTH * 2 )
+
+struct room_render {
+	struct room_render *next;
+	int kind;
+	int variant;
+	unsigned int gen;   /* room_render_gen when built */
+	uint32_t sig;       /* Exit signature, for exit-dependent kinds */
+	const char *tint;   /* get_room_tint_color() when built, for RR_DESC */
+	char *text;
+};
+
+static unsigned int room_render_gen = 1;
+static long room_render_hits;
+static long room_render_misses;
+
+void room_render_invalidate_all( void ) {
+	room_render_gen++;
+}
+
+void room_render_get_stats( long *hits, long *misses ) {
+	*hits = room_render_hits;
+	*misses = room_render_misses;
+}
+
+/*
+ * Destination and door/wall bits of every exit, folded into one word
+ * (FNV-1a).  Doors open and close and walls come and go without OLC, so
+ * exit-dependent text is checked against this rather than a hook at
+ * every site that touches exit_info.
+ */
+static uint32_t room_exit_sig( ROOM_INDEX_DATA *room ) {
+	uint32_t h = 2166136261u;
+	int door;
+
+	for ( door = 0; door < 6; door++ ) {
+		EXIT_DATA *pexit = room->exit[door];
+		uintptr_t to = ( pexit != NULL ) ? (uintptr_t) pexit->to_room : 0;
+
+		h ^= (uint32_t) to;
+		h *= 16777619u;
+		h ^= ( pexit != NULL ) ? (uint32_t) pexit->exit_info : 0xffffffffu;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static void render_room_desc( ROOM_INDEX_DATA *room, const char *tint, char *buf, size_t len ) {
+	snprintf( buf, len, "%s%s#n", tint, room->description ? room->description : "" );
+}
+
+const char *room_render_get( ROOM_INDEX_DATA *room, int kind, int variant ) {
+	static char buf[ROOM_RENDER_BUF];
+	struct room_render *rr;
+	const char *tint = NULL;
+	uint32_t sig = 0;
+
+	if ( room == NULL || kind < 0 || kind >= RR_MAX )
+		return "";
+
+	if ( kind == RR_DESC )
+		tint = get_room_tint_color( room );
+	else if ( kind == RR_EXITS || kind == RR_WALLS )
+		sig = room_exit_sig( room );
+
+	for ( rr = room->render; rr != NULL; rr = rr->next ) {
+		if ( rr->kind == kind && rr->variant == variant )
+			break;
+	}
+
+	if ( rr != NULL && rr->gen == room_render_gen && rr->sig == sig && rr->tint == tint ) {
+		room_render_hits++;
+		return rr->text;
+	}
+
+	room_render_misses++;
+	buf[0] = '\0';
+	switch ( kind ) {
+	case RR_DESC:
+		render_room_desc( room, tint, buf, sizeof( buf ) );
+		break;
+	case RR_EXITS:
+		render_room_exits( room, variant, buf, sizeof( buf ) );
+		break;
+	case RR_WALLS:
+		render_room_walls( room, variant, buf, sizeof( buf ) );
+		break;
+	}
+
+	if ( rr == NULL ) {
+		rr = calloc( 1, sizeof( *rr ) );
+		if ( rr == NULL ) {
+			bug( "room_render_get: calloc failed", 0 );
+			return buf;
+		}
+		rr->kind = kind;
+		rr->variant = variant;
+		rr->next = room->render;
+		room->render = rr;
+	} else {
+		free( rr->text );
+	}
+	rr->gen = room_render_gen;
+	rr->sig = sig;
+	rr->tint = tint;
+	rr->text = str_dup( buf );
+	return rr->text;
+}
+
+void room_render_free( ROOM_INDEX_DATA *room ) {
+	struct room_render *rr, *rr_next;
+
+	for ( rr = room->render; rr != NULL; rr = rr_next ) {
+		rr_next = rr->next;
+		free( rr->text );
+		free( rr );
+	}
+	room->render = NULL;
+}
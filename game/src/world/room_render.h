@@ -0,0 +1,46 @@
+/*
+ * room_render.h - Per-room cache of rendered look text
+ *
+ * The parts of 'look' that depend only on the room - the tinted
+ * description, the plain auto-exit line and wall lines - are rendered
+ * once per room and viewer class and shared by everyone who looks.
+ * Occupants, objects, blood and MXP exit links (whose tooltips preview
+ * the next room as this viewer sees it) are still rendered per viewer.
+ * The automap is sliced from world/map_layout.c instead.
+ *
+ * Text is cached with colour codes unexpanded, so one entry serves every
+ * colour depth; colour is applied per descriptor on output.  Look output
+ * does not wrap, so terminal width is not part of the key.
+ *
+ * Entries are checked on every lookup: exit-dependent text against a
+ * signature of the room's exits and door/wall bits, the description
+ * against the time-of-day tint, and everything against a global
+ * generation that OLC bumps through room_render_invalidate_all().
+ */
+
+#ifndef ROOM_RENDER_H
+#define ROOM_RENDER_H
+
+enum {
+	RR_DESC,     /* Tinted description; variant unused */
+	RR_EXITS,    /* 'exits auto' without MXP; variant 1 = screen reader */
+	RR_WALLS,    /* "You see a wall of ... " lines; variant unused */
+	RR_MAX
+};
+
+/* Cached text for room; never NULL.  Valid until the next lookup. */
+const char *room_render_get( ROOM_INDEX_DATA *room, int kind, int variant );
+
+/* Drop every room's cached text (OLC room, exit or area edits) */
+void room_render_invalidate_all( void );
+
+/* Free a room's entries (room being freed) */
+void room_render_free( ROOM_INDEX_DATA *room );
+
+void room_render_get_stats( long *hits, long *misses );
+
+/* Builders, defined next to the code that used to render live */
+void render_room_exits( ROOM_INDEX_DATA *room, int variant, char *buf, size_t len );
+void render_room_walls( ROOM_INDEX_DATA *room, int variant, char *buf, size_t len );
+
+#endif /* ROOM_RENDER_H */
@@ -0,0 +1,246 @@
+/*
+ * Board tests (game/src/systems/board.c)
+ *
+ * Tests: is_note_to() on parsed recipients against the name-parsing
+ * version it replaced, and unread_notes() against the full scan it
+ * replaced while 50,000 notes are posted, read, caught up on and
+ * removed.  The benchmark lists every board for a reader with a long
+ * backlog.  Requires boot (the boards are loaded with the game).
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../systems/profile.h"
+
+#define BULK_NOTES	 50000
+#define BENCH_LISTS	 200
+
+/* is_note_to() as it was, parsing to_list on every call */
+static bool legacy_is_note_to( CHAR_DATA *ch, NOTE_DATA *note ) {
+	if ( !str_cmp( ch->pcdata->switchname, note->sender ) )
+		return TRUE;
+	if ( is_full_name( "all", note->to_list ) )
+		return TRUE;
+	if ( IS_IMMORTAL( ch ) && ( is_full_name( "imm", note->to_list ) || is_full_name( "imms", note->to_list ) || is_full_name( "immortal", note->to_list ) || is_full_name( "god", note->to_list ) || is_full_name( "gods", note->to_list ) || is_full_name( "immortals", note->to_list ) ) )
+		return TRUE;
+	if ( ( get_trust( ch ) == MAX_LEVEL ) && ( is_full_name( "imp", note->to_list ) || is_full_name( "imps", note->to_list ) || is_full_name( "implementor", note->to_list ) || is_full_name( "implementors", note->to_list ) ) )
+		return TRUE;
+	if ( is_full_name( ch->pcdata->switchname, note->to_list ) )
+		return TRUE;
+	if ( ch->pcdata->kingdom != 0 && IS_IMMORTAL( ch ) )
+		return TRUE;
+	if ( is_number( note->to_list ) && get_trust( ch ) >= atoi( note->to_list ) )
+		return TRUE;
+	return FALSE;
+}
+
+/* unread_notes() as it was: one pass over the board */
+static int legacy_unread_notes( CHAR_DATA *ch, BOARD_DATA *board ) {
+	NOTE_DATA *note;
+	time_t last_read;
+	int count = 0;
+
+	if ( board->read_level > get_trust( ch ) )
+		return -1;
+
+	last_read = ch->pcdata->last_note[board_lookup( board->short_name )];
+	LIST_FOR_EACH( note, &board->notes, NOTE_DATA, node )
+		if ( legacy_is_note_to( ch, note ) && ( (long) last_read < (long) note->date_stamp ) )
+			count++;
+	return count;
+}
+
+static const char *to_lists[] = {
+	"all", "imm", "Gods", "imp", "Alice", "bob", "Alice Bob", "carol imm",
+	"5", "10", "Dave", "'all'", "immortals Eve", "implementors", "Zed", "all Zed"
+};
+static const char *senders[] = { "Alice", "Bob", "Carol", "Dave", "Eve", "Frank" };
+
+static NOTE_DATA *make_test_note( int i, time_t stamp ) {
+	NOTE_DATA *note = calloc( 1, sizeof( NOTE_DATA ) );
+
+	note->sender = str_dup( senders[i % 6] );
+	note->to_list = str_dup( to_lists[( i * 7 ) % 16] );
+	note->subject = str_dup( "test" );
+	note->text = str_dup( "" );
+	note->date_stamp = stamp;
+	return note;
+}
+
+static CHAR_DATA *make_reader( const char *name, int level, int kingdom ) {
+	CHAR_DATA *ch = make_test_player();
+
+	ch->pcdata->switchname = str_dup( name );
+	ch->level = level;
+	ch->pcdata->kingdom = kingdom;
+	return ch;
+}
+
+static void free_reader( CHAR_DATA *ch ) {
+	free( ch->pcdata->switchname );
+	ch->pcdata->switchname = NULL;
+	free_test_char( ch );
+}
+
+#define N_READERS 6
+
+static CHAR_DATA *readers[N_READERS];
+
+static void make_readers( void ) {
+	readers[0] = make_reader( "Alice", 3, 0 );
+	readers[1] = make_reader( "bob", 2, 0 );
+	readers[2] = make_reader( "Carol", LEVEL_IMMORTAL, 0 );
+	readers[3] = make_reader( "Zed", MAX_LEVEL, 0 );
+	readers[4] = make_reader( "Quinn", LEVEL_IMMORTAL + 1, 3 );
+	readers[5] = make_reader( "Mort", 1, 0 );
+}
+
+static void free_readers( void ) {
+	int r;
+
+	for ( r = 0; r < N_READERS; r++ )
+		free_reader( readers[r] );
+}
+
+/* Every reader agrees with the full scan on every board */
+static void assert_counts_match( void ) {
+	int r, b;
+
+	for ( r = 0; r < N_READERS; r++ )
+		for ( b = 0; b < MAX_BOARD; b++ )
+			TEST_ASSERT_EQ( unread_notes( readers[r], &boards[b] ),
+				legacy_unread_notes( readers[r], &boards[b] ) );
+}
+
+/* Unlink and free every note on board with seq above 'from' */
+static void remove_notes_after( BOARD_DATA *board, unsigned int from ) {
+	NOTE_DATA *note, *next;
+
+	LIST_FOR_EACH_SAFE( note, next, &board->notes, NOTE_DATA, node ) {
+		if ( note->seq > from ) {
+			list_remove( &board->notes, &note->node );
+			free_note( note );
+		}
+	}
+	board->remove_gen++;
+}
+
+static void test_is_note_to_matches_parse( void ) {
+	BOARD_DATA *board = &boards[board_lookup( "Personal" )];
+	unsigned int base_seq = board->note_seq;
+	NOTE_DATA *note;
+	int i, r;
+
+	make_readers();
+	for ( i = 0; i < 64; i++ )
+		board_append_note( board, make_test_note( i, current_time + 1000000 + i ) );
+
+	LIST_FOR_EACH( note, &board->notes, NOTE_DATA, node ) {
+		if ( note->seq <= base_seq )
+			continue;
+		for ( r = 0; r < N_READERS; r++ )
+			TEST_ASSERT_EQ( is_note_to( readers[r], note ),
+				legacy_is_note_to( readers[r], note ) );
+	}
+
+	remove_notes_after( board, base_seq );
+	free_readers();
+}
+
+static void test_unread_counts_match_scan( void ) {
+	int bi = board_lookup( "Personal" );
+	BOARD_DATA *board = &boards[bi];
+	unsigned int base_seq = board->note_seq;
+	time_t stamp = current_time + 2000000;
+	NOTE_DATA *note;
+	int i, r, n;
+
+	make_readers();
+	assert_counts_match();
+
+	/* Post 50k notes in batches, checking the incremental counts */
+	for ( i = 0; i < BULK_NOTES; i++ ) {
+		board_append_note( board, make_test_note( i, stamp++ ) );
+		if ( i % 10000 == 9999 )
+			assert_counts_match();
+	}
+
+	/* Read up to various points on the board */
+	for ( r = 0; r < N_READERS; r++ ) {
+		n = 0;
+		LIST_FOR_EACH( note, &board->notes, NOTE_DATA, node )
+			if ( ++n == ( r + 1 ) * BULK_NOTES / 8 )
+				break;
+		if ( note != NULL )
+			readers[r]->pcdata->last_note[bi] = note->date_stamp;
+	}
+	assert_counts_match();
+
+	/* More posts after reading */
+	for ( i = 0; i < 500; i++ )
+		board_append_note( board, make_test_note( i + 3, stamp++ ) );
+	assert_counts_match();
+
+	/* Reading backwards, catching up, and a reader who changes trust */
+	readers[0]->pcdata->last_note[bi] = 0;
+	readers[1]->pcdata->last_note[bi] = stamp;
+	readers[5]->level = LEVEL_IMMORTAL;
+	assert_counts_match();
+
+	/* A note removed from the middle */
+	n = 0;
+	LIST_FOR_EACH( note, &board->notes, NOTE_DATA, node )
+		if ( note->seq > base_seq && ++n == BULK_NOTES / 2 )
+			break;
+	if ( note != NULL ) {
+		list_remove( &board->notes, &note->node );
+		board->remove_gen++;
+		free_note( note );
+	}
+	assert_counts_match();
+
+	remove_notes_after( board, base_seq );
+	assert_counts_match();
+	free_readers();
+}
+
+static void test_bench_board_listing( void ) {
+	BOARD_DATA *board = &boards[board_lookup( "Personal" )];
+	unsigned int base_seq = board->note_seq;
+	time_t stamp = current_time + 3000000;
+	CHAR_DATA *ch = make_reader( "Alice", 3, 0 );
+	long long start, legacy_ns, cached_ns;
+	volatile int sink = 0;
+	int i, b;
+
+	for ( i = 0; i < BULK_NOTES; i++ )
+		board_append_note( board, make_test_note( i, stamp++ ) );
+
+	start = profile_now_ns();
+	for ( i = 0; i < BENCH_LISTS; i++ )
+		for ( b = 0; b < MAX_BOARD; b++ )
+			sink += legacy_unread_notes( ch, &boards[b] );
+	legacy_ns = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( i = 0; i < BENCH_LISTS; i++ )
+		for ( b = 0; b < MAX_BOARD; b++ )
+			sink += unread_notes( ch, &boards[b] );
+	cached_ns = profile_now_ns() - start;
+
+	printf( "    [bench] board list x %d, %d notes: scan %lld us, counters %lld us\n",
+		BENCH_LISTS, list_count( &board->notes ), legacy_ns / 1000, cached_ns / 1000 );
+	TEST_ASSERT( sink != 0 );
+
+	remove_notes_after( board, base_seq );
+	free_reader( ch );
+}
+
+void suite_board( void ) {
+	if ( !ensure_booted() ) return;
+
+	RUN_TEST( test_is_note_to_matches_parse );
+	RUN_TEST( test_unread_counts_match_scan );
+	RUN_TEST( test_bench_board_listing );
+}
@@ -0,0 +1,325 @@
+/*
+ * Class function table tests (game/src/classes/class_ops.c)
+ *
+ * Tests: lookup gates and registry coverage, prompt codes, and the
+ * per-pulse tick against the IS_CLASS chain mobile_update() used to run.
+ * The pulse benchmark times both over every registered class.  Requires
+ * boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "class_ops.h"
+#include "dragonkin.h"
+#include "../db/db_class.h"
+#include "../systems/profile.h"
+
+#define TICK_PULSES	   20
+#define BENCH_PER_CLASS 8
+#define BENCH_PULSES   500
+#define BENCH_ROUNDS   3
+
+/* mobile_update()'s hero branch as it was before the table */
+static void ref_class_chain( CHAR_DATA *ch ) {
+	if ( IS_CLASS( ch, CLASS_VAMPIRE ) ) {
+		if ( ch->rage > 0 )
+			update_vampire_regen( ch );
+		else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
+			update_arti_regen( ch );
+		update_vampire( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_DROID ) ) {
+		update_drider( ch );
+		if ( ch->pcdata->powers[CYBORG_BODY] > 5 )
+			update_cyborg( ch );
+		else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
+			update_arti_regen( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_ANGEL ) ) {
+		if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
+		update_angel( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_TANARRI ) ) {
+		if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
+		update_tanarri( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_LICH ) ) {
+		if ( ch->pcdata->powers[LIFE_LORE] > 0 )
+			update_lich_regen( ch );
+		else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
+			update_arti_regen( ch );
+		update_lich( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_MONK ) ) update_monk( ch );
+	if ( IS_CLASS( ch, CLASS_NINJA ) ) update_ninja( ch );
+	if ( IS_CLASS( ch, CLASS_UNDEAD_KNIGHT ) ) update_knight( ch );
+	if ( IS_CLASS( ch, CLASS_WEREWOLF ) ) update_werewolf( ch );
+	if ( IS_CLASS( ch, CLASS_DEMON ) ) {
+		update_demon( ch );
+		if ( IS_SET( ch->warp, WARP_REGENERATE ) )
+			update_demon_regen( ch );
+		else if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) )
+			update_arti_regen( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_SHAPESHIFTER ) ) update_shapeshifter( ch );
+	if ( IS_CLASS( ch, CLASS_DROW ) ) {
+		update_drow( ch );
+		if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_SAMURAI ) ) update_highlander( ch );
+	if ( IS_CLASS( ch, CLASS_MAGE ) ) {
+		update_mage( ch );
+		if ( IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
+	}
+	if ( IS_CLASS( ch, CLASS_DIRGESINGER ) ) update_dirgesinger( ch );
+	if ( IS_CLASS( ch, CLASS_SIREN ) ) update_siren( ch );
+	if ( IS_CLASS( ch, CLASS_PSION ) ) update_psion( ch );
+	if ( IS_CLASS( ch, CLASS_MINDFLAYER ) ) update_mindflayer( ch );
+	if ( IS_CLASS( ch, CLASS_ARTIFICER ) ) update_artificer( ch );
+	if ( IS_CLASS( ch, CLASS_MECHANIST ) ) update_mechanist( ch );
+	if ( IS_CLASS( ch, CLASS_CULTIST ) ) update_cultist( ch );
+	if ( IS_CLASS( ch, CLASS_VOIDBORN ) ) update_voidborn( ch );
+	if ( IS_CLASS( ch, CLASS_CHRONOMANCER ) ) update_chronomancer( ch );
+	if ( IS_CLASS( ch, CLASS_PARADOX ) ) update_paradox( ch );
+	if ( IS_CLASS( ch, CLASS_SHAMAN ) ) update_shaman( ch );
+	if ( IS_CLASS( ch, CLASS_SPIRITLORD ) ) update_spiritlord( ch );
+	if ( ch->class == 0 && IS_ITEMAFF( ch, ITEMA_REGENERATE ) ) update_arti_regen( ch );
+}
+
+static CHAR_DATA *make_classed( int class_id, ROOM_INDEX_DATA *room ) {
+	CHAR_DATA *ch = make_test_player();
+
+	ch->class = class_id;
+	ch->level = LEVEL_AVATAR;
+	ch->position = POS_STANDING;
+	ch->max_hit = ch->max_mana = ch->max_move = 100000;
+	ch->hit = ch->mana = ch->move = 1000;
+	if ( room != NULL )
+		char_to_room( ch, room );
+	return ch;
+}
+
+static void free_classed( CHAR_DATA *ch ) {
+	if ( ch->in_room != NULL )
+		char_from_room( ch );
+	free_test_char( ch );
+}
+
+static bool same_state( CHAR_DATA *a, CHAR_DATA *b ) {
+	return a->hit == b->hit && a->mana == b->mana && a->move == b->move
+		&& a->rage == b->rage && a->position == b->position
+		&& !memcmp( a->pcdata->powers, b->pcdata->powers, sizeof( a->pcdata->powers ) )
+		&& !memcmp( a->pcdata->stats, b->pcdata->stats, sizeof( a->pcdata->stats ) )
+		&& !memcmp( a->pcdata->condition, b->pcdata->condition, sizeof( a->pcdata->condition ) );
+}
+
+/* --- Lookup --- */
+
+void test_class_ops_gates( void ) {
+	CHAR_DATA *ch = make_test_player();
+	CHAR_DATA *npc = make_test_npc();
+
+	ensure_booted();
+
+	TEST_ASSERT( class_ops( ch ) == &class_ops_classless );
+	TEST_ASSERT( class_ops( ch )->regen != NULL );
+
+	/* IS_CLASS() needs LEVEL_AVATAR; so does the table */
+	ch->class = CLASS_VAMPIRE;
+	ch->level = LEVEL_AVATAR - 1;
+	TEST_ASSERT( class_ops( ch ) == &class_ops_none );
+	ch->level = LEVEL_AVATAR;
+	TEST_ASSERT_EQ( class_ops( ch )->class_id, CLASS_VAMPIRE );
+
+	npc->class = CLASS_VAMPIRE;
+	npc->level = LEVEL_AVATAR;
+	TEST_ASSERT( class_ops( npc ) == &class_ops_none );
+
+	free_test_char( ch );
+	free_test_char( npc );
+}
+
+void test_class_ops_cover_registry( void ) {
+	const CLASS_REGISTRY_ENTRY *reg;
+	CHAR_DATA *ch = make_test_player();
+	int i;
+
+	ensure_booted();
+	ch->level = LEVEL_AVATAR;
+	TEST_ASSERT( db_class_get_registry_count() > 0 );
+	for ( i = 0; ( reg = db_class_get_registry_by_index( i ) ) != NULL; i++ ) {
+		TEST_ASSERT( class_ops_by_id( reg->class_id ) != NULL );
+		ch->class = reg->class_id;
+		TEST_ASSERT_EQ( class_ops( ch )->class_id, reg->class_id );
+	}
+	free_test_char( ch );
+}
+
+/* --- Prompt codes --- */
+
+void test_class_ops_prompt_codes( void ) {
+	CHAR_DATA *ch = make_test_player();
+	char buf[MAX_STRING_LENGTH];
+
+	ensure_booted();
+	ch->level = LEVEL_AVATAR;
+	ch->rage = 42;
+
+	/* Classless: nothing is ours */
+	TEST_ASSERT_FALSE( class_prompt( ch, 'R', buf, sizeof( buf ) ) );
+
+	ch->class = CLASS_SHAPESHIFTER;
+	ch->pcdata->powers[SHAPE_COUNTER] = 7;
+	TEST_ASSERT_TRUE( class_prompt( ch, 'k', buf, sizeof( buf ) ) );
+	TEST_ASSERT_STR_EQ( buf, "#C7#n" );
+	TEST_ASSERT_FALSE( class_prompt( ch, 'R', buf, sizeof( buf ) ) );
+
+	ch->class = CLASS_SAMURAI;
+	ch->pcdata->powers[SAMURAI_FOCUS] = 3;
+	TEST_ASSERT_TRUE( class_prompt( ch, 'k', buf, sizeof( buf ) ) );
+	TEST_ASSERT_STR_EQ( buf, "3" );
+
+	ch->class = CLASS_VAMPIRE;
+	ch->pcdata->condition[COND_THIRST] = 55;
+	TEST_ASSERT_TRUE( class_prompt( ch, 'R', buf, sizeof( buf ) ) );
+	TEST_ASSERT_STR_EQ( buf, "#r42#n" );
+	TEST_ASSERT_TRUE( class_prompt( ch, 'B', buf, sizeof( buf ) ) );
+	TEST_ASSERT_STR_EQ( buf, "#r55#n" );
+
+	/* Werewolf gnosis only shows once there is a maximum */
+	ch->class = CLASS_WEREWOLF;
+	TEST_ASSERT_FALSE( class_prompt( ch, 'G', buf, sizeof( buf ) ) );
+	TEST_ASSERT_TRUE( class_prompt( ch, 'R', buf, sizeof( buf ) ) );
+
+	ch->class = CLASS_DROW;
+	ch->pcdata->stats[9] = 12;
+	TEST_ASSERT_TRUE( class_prompt( ch, 'D', buf, sizeof( buf ) ) );
+	TEST_ASSERT_STR_EQ( buf, "#C12#n" );
+	ch->class = CLASS_TANARRI;
+	TEST_ASSERT_TRUE( class_prompt( ch, 'd', buf, sizeof( buf ) ) );
+	TEST_ASSERT_FALSE( class_prompt( ch, 'D', buf, sizeof( buf ) ) );
+
+	ch->class = CLASS_WYRM;
+	ch->pcdata->powers[DRAGON_ATTUNEMENT] = 2;
+	TEST_ASSERT_TRUE( class_prompt( ch, 'E', buf, sizeof( buf ) ) );
+	TEST_ASSERT_STR_EQ( buf, "#CStorm#n" );
+
+	free_test_char( ch );
+}
+
+/* --- Tick --- */
+
+void test_class_ops_tick_matches_chain( void ) {
+	const CLASS_REGISTRY_ENTRY *reg;
+	ROOM_INDEX_DATA *room;
+	CHAR_DATA *a, *b;
+	int i, pulse, variant, mismatches = 0;
+
+	ensure_booted();
+	room = get_room_index( ROOM_VNUM_LIMBO );
+	TEST_ASSERT( room != NULL );
+
+	/* The chain ticked these four before regenerating them */
+	TEST_ASSERT( class_ops_by_id( CLASS_DEMON )->tick_first );
+	TEST_ASSERT( class_ops_by_id( CLASS_DROW )->tick_first );
+	TEST_ASSERT( class_ops_by_id( CLASS_MAGE )->tick_first );
+	TEST_ASSERT( class_ops_by_id( CLASS_DROID )->tick_first );
+	TEST_ASSERT_FALSE( class_ops_by_id( CLASS_VAMPIRE )->tick_first );
+
+	for ( i = 0; ( reg = db_class_get_registry_by_index( i ) ) != NULL; i++ ) {
+		for ( variant = 0; variant < 2; variant++ ) {
+			a = make_classed( reg->class_id, room );
+			b = make_classed( reg->class_id, room );
+			if ( variant ) {
+				a->rage = b->rage = 10;
+				SET_BIT( a->itemaffect, ITEMA_REGENERATE );
+				SET_BIT( b->itemaffect, ITEMA_REGENERATE );
+			}
+
+			seed_rng( 4242 + i );
+			for ( pulse = 0; pulse < TICK_PULSES; pulse++ )
+				ref_class_chain( a );
+			seed_rng( 4242 + i );
+			for ( pulse = 0; pulse < TICK_PULSES; pulse++ )
+				class_tick( b );
+
+			if ( !same_state( a, b ) ) {
+				fprintf( stderr, "    class %d (%s) variant %d diverged\n",
+					reg->class_id, reg->class_name, variant );
+				mismatches++;
+			}
+			free_classed( a );
+			free_classed( b );
+		}
+	}
+	TEST_ASSERT_EQ( mismatches, 0 );
+}
+
+/* --- Benchmark --- */
+
+/*
+ * Each run gets its own, identical set of characters, and the two take
+ * turns so neither always runs on a warmer cache.  Best of BENCH_ROUNDS.
+ */
+void test_class_ops_bench_pulse( void ) {
+	CHAR_DATA *chain_chars[64 * BENCH_PER_CLASS];
+	CHAR_DATA *table_chars[64 * BENCH_PER_CLASS];
+	const CLASS_REGISTRY_ENTRY *reg;
+	ROOM_INDEX_DATA *room;
+	int64_t start, ns, chain_ns = 0, table_ns = 0;
+	int count = 0, i, j, pulse, round, mismatches = 0;
+
+	ensure_booted();
+	room = get_room_index( ROOM_VNUM_LIMBO );
+	for ( i = 0; ( reg = db_class_get_registry_by_index( i ) ) != NULL && i < 64; i++ ) {
+		for ( j = 0; j < BENCH_PER_CLASS; j++ ) {
+			chain_chars[count] = make_classed( reg->class_id, room );
+			table_chars[count] = make_classed( reg->class_id, room );
+			count++;
+		}
+	}
+	TEST_ASSERT( count > 0 );
+
+	for ( round = 0; round < BENCH_ROUNDS; round++ ) {
+		seed_rng( 99 + round );
+		start = profile_now_ns();
+		for ( pulse = 0; pulse < BENCH_PULSES; pulse++ )
+			for ( i = 0; i < count; i++ )
+				ref_class_chain( chain_chars[i] );
+		ns = profile_now_ns() - start;
+		if ( round == 0 || ns < chain_ns )
+			chain_ns = ns;
+
+		seed_rng( 99 + round );
+		start = profile_now_ns();
+		for ( pulse = 0; pulse < BENCH_PULSES; pulse++ )
+			for ( i = 0; i < count; i++ )
+				class_tick( table_chars[i] );
+		ns = profile_now_ns() - start;
+		if ( round == 0 || ns < table_ns )
+			table_ns = ns;
+	}
+
+	/* Same seeds on the same starting state: both sets end up alike */
+	for ( i = 0; i < count; i++ )
+		if ( !same_state( chain_chars[i], table_chars[i] ) )
+			mismatches++;
+	TEST_ASSERT_EQ( mismatches, 0 );
+
+	printf( "    [bench] class tick, %d chars x %d pulses, best of %d: chain %lld us, table %lld us\n",
+		count, BENCH_PULSES, BENCH_ROUNDS, (long long) ( chain_ns / 1000 ), (long long) ( table_ns / 1000 ) );
+
+	for ( i = 0; i < count; i++ ) {
+		free_classed( chain_chars[i] );
+		free_classed( table_chars[i] );
+	}
+}
+
+void suite_class_ops( void ) {
+	RUN_TEST( test_class_ops_gates );
+	RUN_TEST( test_class_ops_cover_registry );
+	RUN_TEST( test_class_ops_prompt_codes );
+	RUN_TEST( test_class_ops_tick_matches_chain );
+	RUN_TEST( test_class_ops_bench_pulse );
+}
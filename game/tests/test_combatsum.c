@@ -0,0 +1,231 @@
+/*
+ * Combat summary tests (game/src/systems/combatsum.c)
+ *
+ * Tests:
+ * - An onlooker with config +combatsum gets one line per attacker and
+ *   victim at the end of the round; other onlookers and the fighters
+ *   still see every hit
+ * - No act() for a hit when everyone watching takes summaries, and hits
+ *   outside a round shown as they happen
+ * - act() calls and bytes over a headless 20 player melee, everyone
+ *   seeing every hit against everyone taking summaries
+ *
+ * Players get a descriptor whose output is only counted, never sent.
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../systems/combatsum.h"
+#include "../core/rng.h"
+#include "../db/db_player.h"
+
+#define MELEE_PLAYERS 20
+#define MELEE_ROUNDS  20
+
+extern void dam_message( CHAR_DATA *ch, CHAR_DATA *victim, int dam, int dt );
+
+static CHAR_DATA *sum_player( const char *name, ROOM_INDEX_DATA *room ) {
+	DESCRIPTOR_DATA *d = calloc( 1, sizeof( DESCRIPTOR_DATA ) );
+	CHAR_DATA *ch;
+
+	d->descriptor = -1;
+	d->connected = CON_PLAYING;
+	d->lookup_status = STATUS_DONE;
+	d->outsize = 2000;
+	d->outbuf = calloc( 1, d->outsize );
+
+	ch = init_char_for_load( d, (char *) name );
+	ch->level = LEVEL_AVATAR;
+	ch->max_hit = ch->hit = 30000000;
+	list_push_back( &g_characters, &ch->char_node );
+	char_to_room( ch, room );
+	return ch;
+}
+
+static void sum_remove( CHAR_DATA *ch ) {
+	DESCRIPTOR_DATA *d = ch->desc;
+
+	ch->fighting = NULL;
+	ch->position = POS_STANDING;
+	if ( ch->in_room != NULL )
+		char_from_room( ch );
+	list_remove( &g_characters, &ch->char_node );
+	ch->desc = NULL;
+	free_char( ch );
+	free( d->outbuf );
+	free( d );
+}
+
+/* What ch was sent, NUL terminated, and forget it */
+static const char *sum_output( CHAR_DATA *ch ) {
+	static char buf[262144];
+	DESCRIPTOR_DATA *d = ch->desc;
+	int len = UMIN( d->outtop, (int) sizeof( buf ) - 1 );
+
+	memcpy( buf, d->outbuf, len );
+	buf[len] = '\0';
+	d->outtop = 0;
+	return buf;
+}
+
+static int count_of( const char *s, const char *what ) {
+	int n = 0;
+
+	while ( ( s = strstr( s, what ) ) != NULL ) {
+		n++;
+		s += strlen( what );
+	}
+	return n;
+}
+
+static ROOM_INDEX_DATA *sum_room( int *saved_flags ) {
+	ROOM_INDEX_DATA *room = get_room_index( ROOM_VNUM_LIMBO );
+
+	*saved_flags = room->room_flags;
+	REMOVE_BIT( room->room_flags, ROOM_SAFE );
+	return room;
+}
+
+static void test_onlooker_gets_summary( void ) {
+	ROOM_INDEX_DATA *room;
+	CHAR_DATA *a, *b, *watch, *plain;
+	const char *out;
+	int saved_flags, i;
+
+	room = sum_room( &saved_flags );
+	a = sum_player( "Sumalpha", room );
+	b = sum_player( "Sumbeta", room );
+	watch = sum_player( "Sumwatch", room );
+	plain = sum_player( "Sumplain", room );
+	SET_BIT( watch->extra, EXTRA_COMBATSUM );
+	sum_output( watch );
+	sum_output( plain );
+	sum_output( a );
+
+	combatsum_begin();
+	for ( i = 0; i < 3; i++ )
+		dam_message( a, b, 100, TYPE_HIT );
+	dam_message( a, b, 0, TYPE_HIT );
+	dam_message( b, a, 0, TYPE_HIT );
+
+	/* Nothing for the summary taker until the round is over */
+	TEST_ASSERT_EQ( watch->desc->outtop, 0 );
+	TEST_ASSERT_EQ( count_of( sum_output( plain ), "[100]" ), 3 );
+	TEST_ASSERT_EQ( count_of( sum_output( a ), "[100]" ), 3 );
+
+	combatsum_end();
+	out = sum_output( watch );
+	TEST_ASSERT( strstr( out, "Sumalpha hits Sumbeta 3 times for 300, missing 1.\n\r" ) != NULL );
+	TEST_ASSERT( strstr( out, "Sumbeta misses Sumalpha 1 time.\n\r" ) != NULL );
+	TEST_ASSERT_EQ( count_of( out, "[100]" ), 0 );
+	TEST_ASSERT_EQ( count_of( sum_output( plain ), " times for " ), 0 );
+
+	sum_remove( a );
+	sum_remove( b );
+	sum_remove( watch );
+	sum_remove( plain );
+	room->room_flags = saved_flags;
+}
+
+static void test_no_act_without_plain_onlookers( void ) {
+	ROOM_INDEX_DATA *room;
+	CHAR_DATA *a, *b, *watch;
+	long hits0, acts0, lines0, hits, acts, lines;
+	int saved_flags;
+
+	room = sum_room( &saved_flags );
+	a = sum_player( "Sumalpha", room );
+	b = sum_player( "Sumbeta", room );
+	watch = sum_player( "Sumwatch", room );
+	SET_BIT( watch->extra, EXTRA_COMBATSUM );
+	sum_output( watch );
+
+	combatsum_get_stats( &hits0, &acts0, &lines0 );
+	combatsum_begin();
+	dam_message( a, b, 250, TYPE_HIT );
+	dam_message( a, b, 250, TYPE_HIT );
+	combatsum_end();
+	combatsum_get_stats( &hits, &acts, &lines );
+	TEST_ASSERT_EQ( hits - hits0, 2 );
+	TEST_ASSERT_EQ( acts - acts0, 0 );
+	TEST_ASSERT_EQ( lines - lines0, 1 );
+	TEST_ASSERT( strstr( sum_output( watch ), "Sumalpha hits Sumbeta 2 times for 500.\n\r" ) != NULL );
+
+	/* Between rounds the hit is shown straight away */
+	dam_message( a, b, 250, TYPE_HIT );
+	TEST_ASSERT_EQ( count_of( sum_output( watch ), "[250]" ), 1 );
+
+	sum_remove( a );
+	sum_remove( b );
+	sum_remove( watch );
+	room->room_flags = saved_flags;
+}
+
+/* Run the melee for MELEE_ROUNDS rounds; returns the bytes sent to everyone */
+static long melee_rounds( CHAR_DATA **fighters, long *acts, long *lines ) {
+	long hits0, acts0, lines0, hits;
+	long bytes = 0;
+	int r, i;
+
+	rng_seed_all( 50 );
+	combatsum_get_stats( &hits0, &acts0, &lines0 );
+	for ( r = 0; r < MELEE_ROUNDS; r++ ) {
+		violence_update();
+		for ( i = 0; i < MELEE_PLAYERS; i++ ) {
+			bytes += fighters[i]->desc->outtop;
+			fighters[i]->desc->outtop = 0;
+		}
+	}
+	combatsum_get_stats( &hits, acts, lines );
+	*acts -= acts0;
+	*lines -= lines0;
+	return bytes;
+}
+
+static void test_bench_melee( void ) {
+	CHAR_DATA *fighters[MELEE_PLAYERS];
+	ROOM_INDEX_DATA *room;
+	char name[32];
+	long each_bytes, each_acts, each_lines, sum_bytes, sum_acts, sum_lines;
+	int saved_flags, i;
+
+	room = sum_room( &saved_flags );
+	for ( i = 0; i < MELEE_PLAYERS; i++ ) {
+		snprintf( name, sizeof( name ), "Melee%c", 'a' + i );
+		fighters[i] = sum_player( name, room );
+	}
+	for ( i = 0; i < MELEE_PLAYERS; i += 2 ) {
+		set_fighting( fighters[i], fighters[i + 1] );
+		set_fighting( fighters[i + 1], fighters[i] );
+	}
+
+	each_bytes = melee_rounds( fighters, &each_acts, &each_lines );
+	for ( i = 0; i < MELEE_PLAYERS; i++ )
+		SET_BIT( fighters[i]->extra, EXTRA_COMBATSUM );
+	sum_bytes = melee_rounds( fighters, &sum_acts, &sum_lines );
+
+	printf( "    [bench] %d player melee x %d rounds: every hit %ld act() calls, %ld bytes; summaries %ld act() calls, %ld lines, %ld bytes\n",
+		MELEE_PLAYERS, MELEE_ROUNDS, each_acts, each_bytes, sum_acts, sum_lines, sum_bytes );
+
+	TEST_ASSERT( each_acts > 0 );
+	TEST_ASSERT_EQ( each_lines, 0 );
+	TEST_ASSERT_EQ( sum_acts, 0 );
+	TEST_ASSERT( sum_lines > 0 );
+	TEST_ASSERT( sum_bytes < each_bytes );
+	for ( i = 0; i < MELEE_PLAYERS; i++ )
+		TEST_ASSERT( fighters[i]->fighting != NULL );
+
+	for ( i = 0; i < MELEE_PLAYERS; i++ )
+		sum_remove( fighters[i] );
+	room->room_flags = saved_flags;
+}
+
+void suite_combatsum( void ) {
+	if ( !ensure_booted() ) return;
+
+	RUN_TEST( test_onlooker_gets_summary );
+	RUN_TEST( test_no_act_without_plain_onlookers );
+	RUN_TEST( test_bench_melee );
+}
@@ -88,7 +88,7 @@ static void test_tell_npc_no_crash( void ) {
 	free( player->pcdata );
 	player->pcdata = NULL;
 	free_char( player );
-	free_char( mob );
+	free_test_mobile( mob );
 }
 
 /*--------------------------------------------------------------------------
@@ -132,7 +132,7 @@ static void test_tell_npc_reply_not_set( void ) {
 	free( player->pcdata );
 	player->pcdata = NULL;
 	free_char( player );
-	free_char( mob );
+	free_test_mobile( mob );
 }
 
 /*--------------------------------------------------------------------------
@@ -176,7 +176,7 @@ static void test_speech_one_fires_on_match( void ) {
 	char_from_room( player );
 	char_from_room( mob );
 	free_char( player );
-	free_char( mob );
+	free_test_mobile( mob );
 	free_test_script( script );
 }
 
@@ -220,7 +220,7 @@ static void test_speech_one_no_match( void ) {
 	char_from_room( player );
 	char_from_room( mob );
 	free_char( player );
-	free_char( mob );
+	free_test_mobile( mob );
 	free_test_script( script );
 }
 
@@ -0,0 +1,271 @@
+/*
+ * Unit tests for the game.db write-behind queue (game/src/db/db_writer.c)
+ *
+ * Tests:
+ * - Batches stay queued until kicked or flushed, then commit together in order
+ * - Keyed batches coalesce, and the survivor runs after batches queued between
+ * - Bound text is copied at submit time
+ * - A failing statement is reported once and does not lose the rest of the commit
+ * - A full queue commits without a kick; close flushes what is left
+ */
+
+#include "../db/db_util.h"   /* sqlite3.h must precede merc.h */
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "../db/db_writer.h"
+
+#include <unistd.h>
+
+#define TEST_WRITER_DB "test_db_writer.db"
+
+enum { TW_LOG, TW_SNAP_CLEAR, TW_SNAP_PUT, TW_MISSING, TW_MAX };
+
+static const char *const test_writer_sql[TW_MAX] = {
+	"INSERT INTO log (v) VALUES (?)",
+	"DELETE FROM snap",
+	"INSERT INTO snap (k, v) VALUES (?,?)",
+	"INSERT INTO no_such_table (v) VALUES (?)",
+};
+
+static void test_writer_remove_db( void ) {
+	unlink( TEST_WRITER_DB );
+	unlink( TEST_WRITER_DB "-wal" );
+	unlink( TEST_WRITER_DB "-shm" );
+}
+
+static DB_WRITER *test_writer_open( void ) {
+	sqlite3 *db;
+
+	test_writer_remove_db();
+	if ( sqlite3_open( TEST_WRITER_DB, &db ) != SQLITE_OK )
+		return NULL;
+	sqlite3_exec( db,
+		"CREATE TABLE log (id INTEGER PRIMARY KEY, v TEXT);"
+		"CREATE TABLE snap (k TEXT, v INTEGER);",
+		NULL, NULL, NULL );
+	sqlite3_close( db );
+	return db_writer_open( TEST_WRITER_DB, test_writer_sql, TW_MAX );
+}
+
+/* Read back through a separate connection, as another process would */
+static void test_writer_query( const char *sql, char *out, size_t len ) {
+	sqlite3 *db;
+	sqlite3_stmt *stmt;
+
+	out[0] = '\0';
+	if ( sqlite3_open( TEST_WRITER_DB, &db ) != SQLITE_OK )
+		return;
+	if ( sqlite3_prepare_v2( db, sql, -1, &stmt, NULL ) == SQLITE_OK ) {
+		if ( sqlite3_step( stmt ) == SQLITE_ROW )
+			snprintf( out, len, "%s", col_text( stmt, 0 ) );
+		sqlite3_finalize( stmt );
+	}
+	sqlite3_close( db );
+}
+
+static void test_writer_log( DB_WRITER *w, const char *key, const char *v ) {
+	DB_BATCH *b = db_batch_new( key );
+
+	db_batch_op( b, TW_LOG );
+	db_batch_text( b, v );
+	db_writer_submit( w, b );
+}
+
+static void test_db_writer_group_commit( void ) {
+	DB_WRITER_STATS st;
+	DB_WRITER *w;
+	char buf[MAX_STRING_LENGTH];
+	char v[16];
+	int i;
+
+	w = test_writer_open();
+	TEST_ASSERT( w != NULL );
+	if ( w == NULL )
+		return;
+
+	for ( i = 0; i < 50; i++ ) {
+		snprintf( v, sizeof( v ), "%d", i );
+		test_writer_log( w, NULL, v );
+	}
+
+	db_writer_get_stats( w, &st );
+	if ( st.threaded ) {
+		/* Nothing reaches the file before a kick or flush */
+		TEST_ASSERT_EQ( st.depth, 50 );
+		TEST_ASSERT_EQ( st.peak_depth, 50 );
+		TEST_ASSERT_EQ( st.commits, 0 );
+		test_writer_query( "SELECT COUNT(*) FROM log", buf, sizeof( buf ) );
+		TEST_ASSERT_STR_EQ( buf, "0" );
+	}
+
+	db_writer_flush( w );
+	db_writer_get_stats( w, &st );
+	TEST_ASSERT_EQ( st.depth, 0 );
+	TEST_ASSERT_EQ( st.batches, 50 );
+	TEST_ASSERT_EQ( st.ops, 50 );
+	TEST_ASSERT_EQ( st.errors, 0 );
+	if ( st.threaded )
+		TEST_ASSERT_EQ( st.commits, 1 );
+
+	test_writer_query( "SELECT COUNT(*) FROM log", buf, sizeof( buf ) );
+	TEST_ASSERT_STR_EQ( buf, "50" );
+	/* Submission order is preserved */
+	test_writer_query( "SELECT group_concat(v, ',') FROM (SELECT v FROM log ORDER BY id LIMIT 5)",
+		buf, sizeof( buf ) );
+	TEST_ASSERT_STR_EQ( buf, "0,1,2,3,4" );
+
+	db_writer_close( w );
+	test_writer_remove_db();
+}
+
+static void test_db_writer_coalesce( void ) {
+	DB_WRITER_STATS st;
+	DB_WRITER *w;
+	DB_BATCH *b;
+	char buf[MAX_STRING_LENGTH];
+	int i;
+
+	w = test_writer_open();
+	TEST_ASSERT( w != NULL );
+	if ( w == NULL )
+		return;
+
+	/* Five whole-table snapshots under one key: only the last is written */
+	for ( i = 1; i <= 5; i++ ) {
+		b = db_batch_new( "snap" );
+		db_batch_op( b, TW_SNAP_CLEAR );
+		db_batch_op( b, TW_SNAP_PUT );
+		db_batch_text( b, "a" );
+		db_batch_int( b, i );
+		db_batch_op( b, TW_SNAP_PUT );
+		db_batch_text( b, "b" );
+		db_batch_int( b, i * 10 );
+		db_writer_submit( w, b );
+	}
+
+	db_writer_get_stats( w, &st );
+	if ( st.threaded ) {
+		TEST_ASSERT_EQ( st.depth, 1 );
+		TEST_ASSERT_EQ( st.coalesced, 4 );
+	}
+
+	/* The replacement moves behind anything queued after the original */
+	test_writer_log( w, "order", "first" );
+	test_writer_log( w, NULL, "middle" );
+	test_writer_log( w, "order", "last" );
+
+	db_writer_flush( w );
+	test_writer_query( "SELECT group_concat(k || '=' || v, ',') FROM snap", buf, sizeof( buf ) );
+	TEST_ASSERT_STR_EQ( buf, "a=5,b=50" );
+	test_writer_query( "SELECT group_concat(v, ',') FROM (SELECT v FROM log ORDER BY id)",
+		buf, sizeof( buf ) );
+	if ( st.threaded )
+		TEST_ASSERT_STR_EQ( buf, "middle,last" );
+	else
+		TEST_ASSERT_STR_EQ( buf, "first,middle,last" );
+
+	db_writer_close( w );
+	test_writer_remove_db();
+}
+
+static void test_db_writer_copies_text( void ) {
+	DB_WRITER *w;
+	DB_BATCH *b;
+	char buf[MAX_STRING_LENGTH];
+	char text[32];
+
+	w = test_writer_open();
+	TEST_ASSERT( w != NULL );
+	if ( w == NULL )
+		return;
+
+	snprintf( text, sizeof( text ), "original" );
+	b = db_batch_new( NULL );
+	db_batch_op( b, TW_LOG );
+	db_batch_text( b, text );
+	db_batch_op( b, TW_LOG );
+	db_batch_text( b, NULL );
+	db_writer_submit( w, b );
+	snprintf( text, sizeof( text ), "clobbered" );
+
+	db_writer_flush( w );
+	test_writer_query( "SELECT v FROM log ORDER BY id LIMIT 1", buf, sizeof( buf ) );
+	TEST_ASSERT_STR_EQ( buf, "original" );
+	test_writer_query( "SELECT COUNT(*) FROM log WHERE v IS NULL", buf, sizeof( buf ) );
+	TEST_ASSERT_STR_EQ( buf, "1" );
+
+	db_writer_close( w );
+	test_writer_remove_db();
+}
+
+static void test_db_writer_error_isolated( void ) {
+	DB_WRITER_STATS st;
+	DB_WRITER *w;
+	DB_BATCH *b;
+	char buf[MAX_STRING_LENGTH];
+
+	w = test_writer_open();
+	TEST_ASSERT( w != NULL );
+	if ( w == NULL )
+		return;
+
+	test_writer_log( w, NULL, "before" );
+	b = db_batch_new( NULL );
+	db_batch_op( b, TW_MISSING );
+	db_batch_int( b, 1 );
+	db_writer_submit( w, b );
+	test_writer_log( w, NULL, "after" );
+
+	db_writer_flush( w );
+	db_writer_get_stats( w, &st );
+	TEST_ASSERT( st.errors >= 1 );
+	TEST_ASSERT_TRUE( db_writer_take_error( w, buf, sizeof( buf ) ) );
+	TEST_ASSERT( strstr( buf, "no_such_table" ) != NULL );
+	TEST_ASSERT_FALSE( db_writer_take_error( w, buf, sizeof( buf ) ) );
+
+	test_writer_query( "SELECT group_concat(v, ',') FROM (SELECT v FROM log ORDER BY id)",
+		buf, sizeof( buf ) );
+	TEST_ASSERT_STR_EQ( buf, "before,after" );
+
+	db_writer_close( w );
+	test_writer_remove_db();
+}
+
+static void test_db_writer_full_queue_and_close( void ) {
+	DB_WRITER_STATS st;
+	DB_WRITER *w;
+	char buf[MAX_STRING_LENGTH];
+	int i;
+
+	w = test_writer_open();
+	TEST_ASSERT( w != NULL );
+	if ( w == NULL )
+		return;
+
+	/* Reaching DB_WRITER_MAX_DEPTH commits without a kick */
+	for ( i = 0; i < DB_WRITER_MAX_DEPTH; i++ )
+		test_writer_log( w, NULL, "x" );
+	for ( i = 0; i < 200; i++ ) {
+		db_writer_get_stats( w, &st );
+		if ( st.commits > 0 )
+			break;
+		usleep( 10000 );
+	}
+	TEST_ASSERT( st.commits >= 1 );
+
+	/* Close commits whatever is still queued */
+	test_writer_log( w, NULL, "tail" );
+	db_writer_close( w );
+	test_writer_query( "SELECT COUNT(*) FROM log", buf, sizeof( buf ) );
+	TEST_ASSERT_EQ( atoi( buf ), DB_WRITER_MAX_DEPTH + 1 );
+
+	test_writer_remove_db();
+}
+
+void suite_db_writer( void ) {
+	RUN_TEST( test_db_writer_group_commit );
+	RUN_TEST( test_db_writer_coalesce );
+	RUN_TEST( test_db_writer_copies_text );
+	RUN_TEST( test_db_writer_error_isolated );
+	RUN_TEST( test_db_writer_full_queue_and_close );
+}
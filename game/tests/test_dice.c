@@ -1,11 +1,15 @@
 /*
  * Unit tests for RNG and math functions (game/src/core/db.c)
  *
- * Tests: dice(), number_range(), number_percent(), number_bits(), interpolate()
+ * Tests: dice(), number_range(), number_percent(), number_bits(), interpolate(),
+ * and the named streams in rng.c
  */
 
+#include <math.h>
 #include "test_framework.h"
 #include "test_helpers.h"
+#include "rng.h"
+#include "../systems/profile.h"
 
 /* --- interpolate() tests --- */
 
@@ -189,6 +193,106 @@ void test_dice_distribution( void ) {
 	TEST_ASSERT( has_variety >= 5 );
 }
 
+void test_dice_large_matches_exact_sum( void ) {
+	/* Past DICE_EXACT_MAX rolls: same mean and variance as the real sum */
+	const int rolls = 20000, number = 50, size = 20;
+	double want_mean = number * ( size + 1 ) / 2.0;
+	double want_var = number * ( (double) size * size - 1 ) / 12.0;
+	double sum = 0, sumsq = 0, mean, var;
+	int i, val;
+
+	seed_rng( 900 );
+	for ( i = 0; i < rolls; i++ ) {
+		val = dice( number, size );
+		TEST_ASSERT( val >= number && val <= number * size );
+		sum += val;
+		sumsq += (double) val * val;
+	}
+	mean = sum / rolls;
+	var = sumsq / rolls - mean * mean;
+	TEST_ASSERT( fabs( mean - want_mean ) < 1.0 );
+	TEST_ASSERT( fabs( var - want_var ) / want_var < 0.05 );
+}
+
+/* --- Named stream tests --- */
+
+void test_rng_streams_independent( void ) {
+	int combat[8];
+	int i, old, same = 0;
+
+	rng_seed_all( 99 );
+	for ( i = 0; i < 8; i++ )
+		combat[i] = rng_range( RNG_COMBAT, 0, 1 << 30 );
+
+	/* Same seed, another stream: another sequence */
+	for ( i = 0; i < 8; i++ )
+		if ( rng_range( RNG_LOOT, 0, 1 << 30 ) == combat[i] )
+			same++;
+	TEST_ASSERT( same < 8 );
+
+	/* Drawing from or reseeding other streams leaves combat alone */
+	rng_seed_all( 99 );
+	rng_seed( RNG_WEATHER, 7 );
+	for ( i = 0; i < 100; i++ )
+		rng_range( RNG_AI, 0, 100 );
+	old = rng_select( RNG_COMBAT );
+	for ( i = 0; i < 8; i++ )
+		TEST_ASSERT_EQ( number_range( 0, 1 << 30 ), combat[i] );
+	TEST_ASSERT_EQ( rng_select( old ), RNG_COMBAT );
+	TEST_ASSERT_EQ( rng_active(), old );
+}
+
+void test_number_range_uniform( void ) {
+	int counts[7];
+	int i;
+
+	memset( counts, 0, sizeof( counts ) );
+	seed_rng( 1000 );
+	for ( i = 0; i < 70000; i++ )
+		counts[number_range( -3, 3 ) + 3]++;
+
+	/* 10000 expected each; five standard deviations either way */
+	for ( i = 0; i < 7; i++ )
+		TEST_ASSERT( counts[i] > 9500 && counts[i] < 10500 );
+}
+
+/* dice() as it was: one number_range() per die */
+static int legacy_dice( int number, int size ) {
+	int idice, sum;
+
+	switch ( size ) {
+	case 0:
+		return 0;
+	case 1:
+		return number;
+	}
+	for ( idice = 0, sum = 0; idice < number; idice++ )
+		sum += number_range( 1, size );
+	return sum;
+}
+
+void test_bench_dice( void ) {
+	const int rolls = 200000;
+	long long start, legacy_ns, fast_ns;
+	volatile int sink = 0;
+	int i;
+
+	seed_rng( 1100 );
+	start = profile_now_ns();
+	for ( i = 0; i < rolls; i++ )
+		sink += legacy_dice( 60, 100 );
+	legacy_ns = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( i = 0; i < rolls; i++ )
+		sink += dice( 60, 100 );
+	fast_ns = profile_now_ns() - start;
+
+	printf( "    [bench] %d x dice(60, 100): per-die %lld us, approximated %lld us\n",
+		rolls, legacy_ns / 1000, fast_ns / 1000 );
+	TEST_ASSERT( sink != 0 );
+}
+
 /* --- Test suite --- */
 
 void suite_dice( void ) {
@@ -209,4 +313,8 @@ void suite_dice( void ) {
 	RUN_TEST( test_dice_zero_size );
 	RUN_TEST( test_dice_size_one );
 	RUN_TEST( test_dice_distribution );
+	RUN_TEST( test_dice_large_matches_exact_sum );
+	RUN_TEST( test_rng_streams_independent );
+	RUN_TEST( test_number_range_uniform );
+	RUN_TEST( test_bench_dice );
 }
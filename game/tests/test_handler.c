@@ -2,16 +2,21 @@
  * Character/Object movement tests for Dystopia MUD
  *
  * Tests char_to_room, char_from_room, obj_to_char, obj_from_char,
- * obj_to_room, obj_from_room from handler.c.
+ * obj_to_room, obj_from_room from handler.c, the per-template
+ * live instance lists behind get_obj_type() and count_obj_*(), and
+ * incremental area resets.
  * Requires boot_headless() for real rooms and objects.
  */
 
 #include "test_framework.h"
 #include "test_helpers.h"
 #include "merc.h"
+#include "cfg.h"
+#include "../systems/profile.h"
 
 extern ROOM_INDEX_DATA *room_index_hash[MAX_KEY_HASH];
 extern OBJ_INDEX_DATA *obj_index_hash[MAX_KEY_HASH];
+extern MOB_INDEX_DATA *mob_index_hash[MAX_KEY_HASH];
 
 static ROOM_INDEX_DATA *get_test_room( void ) {
 	return get_room_index( ROOM_VNUM_LIMBO );
@@ -286,6 +291,261 @@ void test_obj_from_room_unlinks_node( void ) {
 
 /* --- Suite registration --- */
 
+/* --- Template instance lists --- */
+
+static MOB_INDEX_DATA *get_any_mob_index( void ) {
+	int i;
+	for ( i = 0; i < MAX_KEY_HASH; i++ ) {
+		if ( mob_index_hash[i] != NULL )
+			return mob_index_hash[i];
+	}
+	return NULL;
+}
+
+void test_obj_instances_track_create_extract( void ) {
+	ensure_booted();
+	OBJ_INDEX_DATA *pObjIndex = get_any_obj_index();
+	TEST_ASSERT_TRUE( pObjIndex != NULL );
+	int before = list_count( &pObjIndex->instances );
+
+	OBJ_DATA *a = create_object( pObjIndex, 0 );
+	OBJ_DATA *b = create_object( pObjIndex, 0 );
+	TEST_ASSERT_EQ( list_count( &pObjIndex->instances ), before + 2 );
+	TEST_ASSERT_EQ( list_count( &pObjIndex->instances ), pObjIndex->count );
+	TEST_ASSERT_TRUE( list_node_is_linked( &a->proto_node ) );
+
+	extract_obj( b );
+	TEST_ASSERT_EQ( list_count( &pObjIndex->instances ), before + 1 );
+	extract_obj( a );
+	TEST_ASSERT_EQ( list_count( &pObjIndex->instances ), before );
+	TEST_ASSERT_EQ( list_count( &pObjIndex->instances ), pObjIndex->count );
+}
+
+void test_get_obj_type_returns_oldest( void ) {
+	ensure_booted();
+	OBJ_INDEX_DATA *pObjIndex = get_any_obj_index();
+	TEST_ASSERT_TRUE( pObjIndex != NULL );
+
+	/* Same answer the old g_objects scan gave: the first one created */
+	OBJ_DATA *expect = NULL, *obj;
+	LIST_FOR_EACH( obj, &g_objects, OBJ_DATA, obj_node ) {
+		if ( obj->pIndexData == pObjIndex ) {
+			expect = obj;
+			break;
+		}
+	}
+	OBJ_DATA *a = create_object( pObjIndex, 0 );
+	OBJ_DATA *b = create_object( pObjIndex, 0 );
+	TEST_ASSERT_TRUE( get_obj_type( pObjIndex ) == ( expect != NULL ? expect : a ) );
+
+	extract_obj( a );
+	if ( expect == NULL )
+		TEST_ASSERT_TRUE( get_obj_type( pObjIndex ) == b );
+	extract_obj( b );
+	TEST_ASSERT_TRUE( get_obj_type( pObjIndex ) == expect );
+}
+
+void test_count_obj_room_and_list( void ) {
+	ensure_booted();
+	OBJ_INDEX_DATA *pObjIndex = get_any_obj_index();
+	TEST_ASSERT_TRUE( pObjIndex != NULL );
+	ROOM_INDEX_DATA *room = get_test_room();
+	CHAR_DATA *ch = make_full_test_npc();
+	OBJ_DATA *objs[6];
+	int base_room = count_obj_room( pObjIndex, &room->objects );
+	int i;
+
+	char_to_room( ch, room );
+	for ( i = 0; i < 6; i++ )
+		objs[i] = create_object( pObjIndex, 0 );
+
+	/* Three on the floor, two carried, one elsewhere */
+	for ( i = 0; i < 3; i++ )
+		obj_to_room( objs[i], room );
+	obj_to_char( objs[3], ch );
+	obj_to_char( objs[4], ch );
+	obj_to_room( objs[5], get_second_room() );
+
+	TEST_ASSERT_EQ( count_obj_room( pObjIndex, &room->objects ), base_room + 3 );
+	TEST_ASSERT_EQ( count_obj_list( pObjIndex, &ch->carrying ), 2 );
+
+	/* Pad the carried list so the instance-list path is taken too */
+	OBJ_INDEX_DATA *other = NULL;
+	for ( i = 0; i < MAX_KEY_HASH && other == NULL; i++ ) {
+		OBJ_INDEX_DATA *p;
+		for ( p = obj_index_hash[i]; p != NULL; p = p->next ) {
+			if ( p != pObjIndex && list_count( &p->instances ) == 0 ) {
+				other = p;
+				break;
+			}
+		}
+	}
+	TEST_ASSERT_TRUE( other != NULL );
+	TEST_ASSERT_EQ( count_obj_list( other, &ch->carrying ), 0 );
+	TEST_ASSERT_EQ( count_obj_room( other, &room->objects ), 0 );
+
+	for ( i = 0; i < 6; i++ )
+		extract_obj( objs[i] );
+	char_from_room( ch );
+	free_char( ch );
+}
+
+void test_mob_instances_track_create_extract( void ) {
+	ensure_booted();
+	MOB_INDEX_DATA *pMobIndex = get_any_mob_index();
+	TEST_ASSERT_TRUE( pMobIndex != NULL );
+	int before = list_count( &pMobIndex->instances );
+
+	CHAR_DATA *mob = create_mobile( pMobIndex );
+	TEST_ASSERT_EQ( list_count( &pMobIndex->instances ), before + 1 );
+	TEST_ASSERT_EQ( list_count( &pMobIndex->instances ), pMobIndex->count );
+
+	char_to_room( mob, get_test_room() );
+	extract_char( mob, TRUE );
+	TEST_ASSERT_EQ( list_count( &pMobIndex->instances ), before );
+	TEST_ASSERT_FALSE( list_node_is_linked( &mob->proto_node ) );
+}
+
+/* --- Incremental area reset --- */
+
+/* The area with the most rooms that have resets */
+static AREA_DATA *get_reset_test_area( void ) {
+	AREA_DATA *pArea, *best = NULL;
+	ROOM_INDEX_DATA *pRoom;
+	int n, best_n = 0;
+
+	LIST_FOR_EACH( pArea, &g_areas, AREA_DATA, node ) {
+		n = 0;
+		for ( pRoom = pArea->room_first; pRoom != NULL; pRoom = pRoom->next_in_area )
+			if ( !list_empty( &pRoom->resets ) )
+				n++;
+		if ( n > best_n ) {
+			best = pArea;
+			best_n = n;
+		}
+	}
+	return best;
+}
+
+/* Remove every reset-made mob and object from the area's rooms */
+static void clear_area_contents( AREA_DATA *pArea ) {
+	ROOM_INDEX_DATA *pRoom;
+	CHAR_DATA *vch, *vch_next;
+	OBJ_DATA *obj, *obj_next;
+
+	for ( pRoom = pArea->room_first; pRoom != NULL; pRoom = pRoom->next_in_area ) {
+		LIST_FOR_EACH_SAFE( vch, vch_next, &pRoom->characters, CHAR_DATA, room_node ) {
+			if ( IS_NPC( vch ) && vch->pIndexData != NULL )
+				extract_char( vch, TRUE );
+		}
+		LIST_FOR_EACH_SAFE( obj, obj_next, &pRoom->objects, OBJ_DATA, room_node )
+			extract_obj( obj );
+	}
+}
+
+/* Order-independent digest of what is in the area's rooms */
+static unsigned long area_contents_digest( AREA_DATA *pArea ) {
+	ROOM_INDEX_DATA *pRoom;
+	CHAR_DATA *vch;
+	OBJ_DATA *obj;
+	unsigned long sum = 0;
+
+	for ( pRoom = pArea->room_first; pRoom != NULL; pRoom = pRoom->next_in_area ) {
+		LIST_FOR_EACH( vch, &pRoom->characters, CHAR_DATA, room_node ) {
+			if ( IS_NPC( vch ) && vch->pIndexData != NULL )
+				sum += (unsigned long) pRoom->vnum * 2654435761u ^ (unsigned long) vch->pIndexData->vnum;
+		}
+		LIST_FOR_EACH( obj, &pRoom->objects, OBJ_DATA, room_node )
+			sum += (unsigned long) pRoom->vnum * 40503u ^ ( (unsigned long) obj->pIndexData->vnum << 20 );
+	}
+	return sum;
+}
+
+void test_incremental_reset_matches_atomic( void ) {
+	ensure_booted();
+	AREA_DATA *pArea = get_reset_test_area();
+	TEST_ASSERT_TRUE( pArea != NULL );
+	if ( pArea == NULL )
+		return;
+
+	clear_area_contents( pArea );
+	reset_area( pArea );
+	TEST_ASSERT_TRUE( pArea->reset_next == NULL );
+	unsigned long atomic = area_contents_digest( pArea );
+	TEST_ASSERT( atomic != 0 );
+
+	cfg_set( CFG_WORLD_RESET_ROOMS_PER_PULSE, 7 );
+	clear_area_contents( pArea );
+	reset_area_begin( pArea );
+	TEST_ASSERT_TRUE( pArea->reset_next != NULL );
+
+	int pulses = 0;
+	while ( pArea->reset_next != NULL && pulses < 100000 ) {
+		area_reset_pulse();
+		pulses++;
+	}
+	TEST_ASSERT_EQ( pulses, ( pArea->room_count + 6 ) / 7 );
+	TEST_ASSERT( area_contents_digest( pArea ) == atomic );
+	cfg_reset( CFG_WORLD_RESET_ROOMS_PER_PULSE );
+}
+
+void test_incremental_reset_entered_room_first( void ) {
+	ensure_booted();
+	AREA_DATA *pArea = get_reset_test_area();
+	TEST_ASSERT_TRUE( pArea != NULL );
+	if ( pArea == NULL )
+		return;
+
+	/* The last room in cursor order, as far from its turn as possible */
+	ROOM_INDEX_DATA *pRoom, *last = NULL;
+	for ( pRoom = pArea->room_first; pRoom != NULL; pRoom = pRoom->next_in_area )
+		last = pRoom;
+
+	cfg_set( CFG_WORLD_RESET_ROOMS_PER_PULSE, 1 );
+	reset_area_begin( pArea );
+	TEST_ASSERT_TRUE( last->reset_gen != pArea->reset_gen );
+
+	/* A player walking in gets the room reset on arrival */
+	CHAR_DATA *ch = make_test_player();
+	char_to_room( ch, last );
+	TEST_ASSERT_EQ( last->reset_gen, pArea->reset_gen );
+	char_from_room( ch );
+	free_test_char( ch );
+
+	/* ...and the cursor does not spend a pulse on it again */
+	int pulses = 0;
+	while ( pArea->reset_next != NULL && pulses < 100000 ) {
+		area_reset_pulse();
+		pulses++;
+	}
+	TEST_ASSERT_EQ( pulses, pArea->room_count - 1 );
+	for ( pRoom = pArea->room_first; pRoom != NULL; pRoom = pRoom->next_in_area )
+		TEST_ASSERT_EQ( pRoom->reset_gen, pArea->reset_gen );
+	cfg_reset( CFG_WORLD_RESET_ROOMS_PER_PULSE );
+}
+
+/* Benchmark: reset every area, as area_update() does when they come due */
+void test_reset_all_areas_bench( void ) {
+	AREA_DATA *pArea;
+	int64_t start, elapsed;
+	int pass, areas = 0;
+
+	ensure_booted();
+	LIST_FOR_EACH( pArea, &g_areas, AREA_DATA, node )
+		areas++;
+
+	start = profile_now_ns();
+	for ( pass = 0; pass < 5; pass++ ) {
+		LIST_FOR_EACH( pArea, &g_areas, AREA_DATA, node )
+			reset_area( pArea );
+	}
+	elapsed = profile_now_ns() - start;
+
+	TEST_ASSERT( areas > 0 );
+	printf( "    [bench] reset_area x %d areas: %lld us per full pass (%d objects live)\n",
+		areas, (long long) ( elapsed / 5 / 1000 ), list_count( &g_objects ) );
+}
+
 void suite_handler( void ) {
 	RUN_TEST( test_char_to_room_sets_in_room );
 	RUN_TEST( test_char_to_room_links_node );
@@ -304,4 +564,11 @@ void suite_handler( void ) {
 	RUN_TEST( test_obj_to_room_links_node );
 	RUN_TEST( test_obj_from_room_clears_in_room );
 	RUN_TEST( test_obj_from_room_unlinks_node );
+	RUN_TEST( test_obj_instances_track_create_extract );
+	RUN_TEST( test_get_obj_type_returns_oldest );
+	RUN_TEST( test_count_obj_room_and_list );
+	RUN_TEST( test_mob_instances_track_create_extract );
+	RUN_TEST( test_incremental_reset_matches_atomic );
+	RUN_TEST( test_incremental_reset_entered_room_first );
+	RUN_TEST( test_reset_all_areas_bench );
 }
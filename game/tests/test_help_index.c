@@ -0,0 +1,290 @@
+/*
+ * Unit tests for the help keyword index (game/src/world/help_index.c)
+ *
+ * Tests:
+ * - Exact keyword lookups agree with the old linear is_name() scan, and
+ *   quoted phrase keywords resolve to the first entry owning them
+ * - An earlier prefix match wins over a later exact keyword
+ * - Prefix and multi-word lookups agree with the old linear is_name() scan
+ * - Trust levels hide entries from lookups, suggestions and search
+ * - "Did you mean" suggestions and body text search
+ * - Invalidation after entries are added or removed
+ *
+ * Tier 2 tests (boot required): all tests use the loaded help database.
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../world/help_index.h"
+
+/*
+ * The pre-index get_help() loop, kept here as the reference implementation.
+ */
+static HELP_DATA *legacy_get_help( CHAR_DATA *ch, char *argall ) {
+	HELP_DATA *pHelp;
+
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
+		if ( pHelp->level > get_trust( ch ) )
+			continue;
+		if ( is_name( argall, pHelp->keyword ) )
+			return pHelp;
+	}
+	return NULL;
+}
+
+/* First visible entry that has token as a whole keyword */
+static HELP_DATA *first_exact( CHAR_DATA *ch, const char *token ) {
+	char name[MAX_INPUT_LENGTH];
+	HELP_DATA *pHelp;
+	char *list;
+
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
+		if ( pHelp->level > get_trust( ch ) )
+			continue;
+		list = pHelp->keyword;
+		for ( ;; ) {
+			list = one_argument( list, name );
+			if ( name[0] == '\0' )
+				break;
+			if ( !strcmp( name, token ) )
+				return pHelp;
+		}
+	}
+	return NULL;
+}
+
+static CHAR_DATA *make_immortal( void ) {
+	CHAR_DATA *ch = make_test_player();
+	ch->level = MAX_LEVEL;
+	return ch;
+}
+
+static void test_help_index_exact_keywords( void ) {
+	char token[MAX_INPUT_LENGTH];
+	CHAR_DATA *ch;
+	HELP_DATA *pHelp;
+	int checked = 0;
+	char *list;
+
+	ensure_booted();
+	ch = make_immortal();
+
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
+		list = pHelp->keyword;
+		for ( ;; ) {
+			list = one_argument( list, token );
+			if ( token[0] == '\0' )
+				break;
+			/* Quoted phrases never matched is_name(); they resolve whole */
+			if ( strchr( token, ' ' ) != NULL )
+				TEST_ASSERT( help_index_find( ch, token, -2 ) == first_exact( ch, token ) );
+			else
+				TEST_ASSERT( help_index_find( ch, token, -2 ) == legacy_get_help( ch, token ) );
+			checked++;
+		}
+	}
+
+	TEST_ASSERT( checked > 0 );
+	free_test_char( ch );
+}
+
+static void test_help_index_prefix_matches_legacy( void ) {
+	char token[MAX_INPUT_LENGTH];
+	CHAR_DATA *ch;
+	HELP_DATA *pHelp;
+	char *list;
+
+	ensure_booted();
+	ch = make_immortal();
+
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
+		list = pHelp->keyword;
+		for ( ;; ) {
+			list = one_argument( list, token );
+			if ( token[0] == '\0' )
+				break;
+			if ( strlen( token ) < 4 )
+				continue;
+			token[3] = '\0';
+			TEST_ASSERT( help_index_find( ch, token, -2 ) == legacy_get_help( ch, token ) );
+		}
+	}
+
+	/* Multi-word arguments must satisfy every word, as before */
+	TEST_ASSERT( help_index_find( ch, "zzz qqq", -2 ) == legacy_get_help( ch, "zzz qqq" ) );
+	free_test_char( ch );
+}
+
+static void test_help_index_earlier_prefix_wins( void ) {
+	CHAR_DATA *ch;
+	HELP_DATA *prefix, *exact;
+
+	ensure_booted();
+	ch = make_immortal();
+
+	/* add_help() sorts by keyword, so "ZZA ..." lands before "ZZB ..." */
+	prefix = calloc( 1, sizeof( HELP_DATA ) );
+	prefix->keyword = str_dup( "ZZA ZZPREFIXLONG" );
+	prefix->text = str_dup( "text" );
+	add_help( prefix );
+	exact = calloc( 1, sizeof( HELP_DATA ) );
+	exact->keyword = str_dup( "ZZB ZZPREFIX" );
+	exact->text = str_dup( "text" );
+	add_help( exact );
+
+	TEST_ASSERT( help_index_find( ch, "zzprefix", -2 ) == prefix );
+	TEST_ASSERT( legacy_get_help( ch, "zzprefix" ) == prefix );
+	TEST_ASSERT( help_index_find( ch, "zzprefixlong", -2 ) == prefix );
+	TEST_ASSERT( help_index_find( ch, "zzb", -2 ) == exact );
+
+	list_remove( &g_helps, &prefix->node );
+	list_remove( &g_helps, &exact->node );
+	help_index_invalidate();
+	top_help -= 2;
+
+	free( prefix->keyword );
+	free( prefix->text );
+	free( prefix );
+	free( exact->keyword );
+	free( exact->text );
+	free( exact );
+	free_test_char( ch );
+}
+
+static void test_help_index_respects_trust( void ) {
+	CHAR_DATA *mortal, *imm;
+	HELP_DATA *pHelp, *found[HELP_INDEX_MAX_RESULTS];
+	char token[MAX_INPUT_LENGTH];
+	int i, n;
+
+	ensure_booted();
+	mortal = make_test_player();
+	imm = make_immortal();
+
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
+		if ( pHelp->level <= get_trust( mortal ) )
+			continue;
+		one_argument( pHelp->keyword, token );
+		if ( first_exact( imm, token ) != pHelp )
+			continue;
+
+		TEST_ASSERT( help_index_find( imm, token, -2 ) == pHelp );
+		TEST_ASSERT( help_index_find( mortal, token, -2 ) != pHelp );
+
+		n = help_index_search( mortal, token, found, HELP_INDEX_MAX_RESULTS );
+		for ( i = 0; i < n; i++ )
+			TEST_ASSERT( found[i]->level <= get_trust( mortal ) );
+		break;
+	}
+
+	free_test_char( mortal );
+	free_test_char( imm );
+}
+
+static void test_help_index_suggests_typos( void ) {
+	char token[MAX_INPUT_LENGTH];
+	CHAR_DATA *ch;
+	HELP_DATA *pHelp, *found[HELP_INDEX_MAX_RESULTS];
+	bool hit = FALSE;
+	int i, n;
+
+	ensure_booted();
+	ch = make_immortal();
+
+	LIST_FOR_EACH( pHelp, &g_helps, HELP_DATA, node ) {
+		one_argument( pHelp->keyword, token );
+		if ( strlen( token ) >= 6 && strchr( token, ' ' ) == NULL )
+			break;
+	}
+	TEST_ASSERT( pHelp != NULL );
+
+	/* Drop one letter from the middle of the keyword */
+	memmove( token + 2, token + 3, strlen( token + 3 ) + 1 );
+	n = help_index_suggest( ch, token, found, HELP_INDEX_MAX_RESULTS );
+	for ( i = 0; i < n; i++ )
+		if ( found[i] == pHelp )
+			hit = TRUE;
+	TEST_ASSERT_TRUE( hit );
+
+	TEST_ASSERT_EQ( help_index_suggest( ch, "", found, HELP_INDEX_MAX_RESULTS ), 0 );
+	free_test_char( ch );
+}
+
+static void test_help_index_search_body( void ) {
+	CHAR_DATA *ch;
+	HELP_DATA *pHelp, *found[HELP_INDEX_MAX_RESULTS];
+	HELP_DATA *target = NULL;
+	int n;
+
+	ensure_booted();
+	ch = make_immortal();
+
+	pHelp = calloc( 1, sizeof( HELP_DATA ) );
+	pHelp->level = 0;
+	pHelp->keyword = str_dup( "ZZINDEXTEST" );
+	pHelp->text = str_dup( "The #Rquuxplorative#n mode is documented here.\n\r" );
+	add_help( pHelp );
+
+	n = help_index_search( ch, "quuxplor", found, HELP_INDEX_MAX_RESULTS );
+	TEST_ASSERT_EQ( n, 1 );
+	if ( n > 0 )
+		target = found[0];
+	TEST_ASSERT( target == pHelp );
+
+	/* Every query word must match */
+	TEST_ASSERT_EQ( help_index_search( ch, "quuxplor zzznotaword", found, HELP_INDEX_MAX_RESULTS ), 0 );
+
+	list_remove( &g_helps, &pHelp->node );
+	help_index_invalidate();
+	top_help--;
+	TEST_ASSERT_EQ( help_index_search( ch, "quuxplor", found, HELP_INDEX_MAX_RESULTS ), 0 );
+
+	free( pHelp->keyword );
+	free( pHelp->text );
+	free( pHelp );
+	free_test_char( ch );
+}
+
+static void test_help_index_add_remove( void ) {
+	CHAR_DATA *ch;
+	HELP_DATA *pHelp;
+	int rebuilds;
+
+	ensure_booted();
+	ch = make_immortal();
+
+	pHelp = calloc( 1, sizeof( HELP_DATA ) );
+	pHelp->level = 0;
+	pHelp->keyword = str_dup( "ZZINDEXADD ZZOTHER" );
+	pHelp->text = str_dup( "text" );
+	add_help( pHelp );
+
+	TEST_ASSERT( get_help( ch, "zzindexadd" ) == pHelp );
+	TEST_ASSERT( get_help( ch, "zzoth" ) == pHelp );
+
+	/* Repeat lookups must not rebuild */
+	rebuilds = help_index_rebuild_count();
+	get_help( ch, "zzindexadd" );
+	TEST_ASSERT_EQ( help_index_rebuild_count(), rebuilds );
+
+	list_remove( &g_helps, &pHelp->node );
+	help_index_invalidate();
+	top_help--;
+	TEST_ASSERT( get_help( ch, "zzindexadd" ) == NULL );
+
+	free( pHelp->keyword );
+	free( pHelp->text );
+	free( pHelp );
+	free_test_char( ch );
+}
+
+void suite_help_index( void ) {
+	RUN_TEST( test_help_index_exact_keywords );
+	RUN_TEST( test_help_index_prefix_matches_legacy );
+	RUN_TEST( test_help_index_earlier_prefix_wins );
+	RUN_TEST( test_help_index_respects_trust );
+	RUN_TEST( test_help_index_suggests_typos );
+	RUN_TEST( test_help_index_search_body );
+	RUN_TEST( test_help_index_add_remove );
+}
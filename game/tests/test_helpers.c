@@ -62,6 +62,8 @@ CHAR_DATA *make_test_npc( void ) {
 	list_node_init( &ch->char_node );
 	list_node_init( &ch->room_node );
 	list_node_init( &ch->extracted_node );
+	list_node_init( &ch->script_node );
+	list_node_init( &ch->proto_node );
 	list_init( &ch->affects );
 	list_init( &ch->carrying );
 
@@ -99,6 +101,19 @@ void free_test_char( CHAR_DATA *ch ) {
 	free( ch );
 }
 
+void free_test_mobile( CHAR_DATA *mob ) {
+	if ( mob == NULL )
+		return;
+
+	if ( list_node_is_linked( &mob->char_node ) )
+		list_remove( &g_characters, &mob->char_node );
+	if ( list_node_is_linked( &mob->npc_node ) )
+		list_remove( &g_npcs, &mob->npc_node );
+	if ( mob->pIndexData != NULL )
+		mob->pIndexData->count--;
+	free_char( mob );
+}
+
 void seed_rng( int seed ) {
 	current_time = (time_t) seed;
 	init_mm();
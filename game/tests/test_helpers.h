@@ -37,6 +37,13 @@ CHAR_DATA *make_full_test_npc( void );
  */
 void free_test_char( CHAR_DATA *ch );
 
+/*
+ * Free a mobile created with create_mobile() that was never extracted.
+ * Unlinks it from g_characters/g_npcs first so the global lists do not
+ * keep a dangling node.  Caller must have removed it from its room.
+ */
+void free_test_mobile( CHAR_DATA *mob );
+
 /*
  * Seed the RNG for deterministic testing.
  * Sets current_time to the given value and calls init_mm().
@@ -0,0 +1,432 @@
+/*
+ * Input queue tests (game/src/core/input.c, read_from_buffer in comm.c)
+ *
+ * Tests:
+ * - Lines, options and subnegotiations come out in the order sent
+ * - Any split of the same stream into reads parses identically
+ * - Hostile telnet: unterminated, nested and oversized subnegotiations,
+ *   stray IAC SE, IAC at the end of a read, escaped 255 inside NAWS
+ * - Line cleanup: line endings, backspace, split and broken UTF-8, length limit
+ * - A client that gets a full queue ahead is cut off with FLOOD
+ * - read_from_buffer: NAWS reaches the descriptor, one line per call, flood
+ *   warns the client and closes
+ * - Producer and consumer on separate threads keep every line in order
+ * - The I/O thread reads a real socket
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../core/input.h"
+#include "../systems/telnet.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+extern bool read_from_buffer( DESCRIPTOR_DATA *d, bool want_line );
+
+/* Pop every queued event into a readable transcript */
+static void input_drain( INPUT_CONN *c, char *out, size_t len ) {
+	INPUT_EVENT *ev;
+	size_t used = 0;
+	int i;
+
+	out[0] = '\0';
+	while ( ( ev = input_front( c ) ) != NULL ) {
+		switch ( ev->type ) {
+		case INPUT_EV_LINE:
+			used += snprintf( out + used, len - used, "L%s[%s]", ev->truncated ? "!" : "", ev->data );
+			break;
+		case INPUT_EV_OPTION:
+			used += snprintf( out + used, len - used, "O%d,%d", ev->cmd, ev->opt );
+			break;
+		case INPUT_EV_SUBNEG:
+			used += snprintf( out + used, len - used, "S%d:", ev->opt );
+			for ( i = 0; i < ev->len && used < len; i++ )
+				used += snprintf( out + used, len - used, "%02x", (unsigned char) ev->data[i] );
+			break;
+		case INPUT_EV_FLOOD:
+			used += snprintf( out + used, len - used, "F" );
+			break;
+		case INPUT_EV_CLOSED:
+			used += snprintf( out + used, len - used, "C" );
+			break;
+		}
+		used += snprintf( out + used, len - used, " " );
+		input_pop( c );
+	}
+}
+
+static void input_feed_str( INPUT_CONN *c, const char *s, int len ) {
+	input_feed( c, (const unsigned char *) s, len );
+}
+
+/* String literals may hold NULs, so take their length from sizeof */
+#define FEED( c, lit ) input_feed_str( ( c ), ( lit ), (int) sizeof( lit ) - 1 )
+
+/* Everything a client sends at login, and some of what it shouldn't */
+static const unsigned char test_stream[] = {
+	IAC, DO, TELOPT_COMPRESS2,
+	IAC, WILL, TELOPT_NAWS,
+	IAC, SB, TELOPT_NAWS, 0, 100, 0, 40, IAC, SE,
+	'n', 'a', 'm', IAC, NOP, 'e', '\r', '\n',
+	IAC, SB, TELOPT_TTYPE, 0, 'M', 'U', 'D', 'L', 'E', 'T', IAC, SE,
+	'p', 'w', 0xC3, 0xA9, '\r', '\0',
+	IAC, SB, TELOPT_GMCP, 'C', 'o', 'r', 'e', IAC, IAC, 'x', IAC, SE,
+	'\n', '\n',
+	IAC, SE, 'l', 'o', 'o', 'k', '\n', '\r',
+	IAC
+};
+
+#define TEST_STREAM_EVENTS \
+	"O253,86 O251,31 S31:00640028 L[name] S24:004d55444c4554 L[pw\xc3\xa9] " \
+	"S201:436f7265ffff78 L[] L[] L[look] "
+
+void test_input_events_in_order( void ) {
+	INPUT_CONN *c = input_open( -1 );
+	char out[1024];
+
+	input_feed( c, test_stream, sizeof( test_stream ) );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, TEST_STREAM_EVENTS );
+
+	/* The trailing IAC was waiting for its command */
+	FEED( c, "\xfb\x18" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "O251,24 " );
+	input_close( c );
+}
+
+void test_input_fragmented( void ) {
+	char whole[1024], split[1024];
+	INPUT_CONN *c;
+	int i, chunk, pos, n;
+
+	c = input_open( -1 );
+	input_feed( c, test_stream, sizeof( test_stream ) );
+	input_drain( c, whole, sizeof( whole ) );
+	input_close( c );
+
+	/* Byte at a time, then every fixed chunk size, then pseudo-random splits */
+	for ( chunk = 1; chunk <= (int) sizeof( test_stream ) + 7; chunk++ ) {
+		c = input_open( -1 );
+		for ( pos = 0; pos < (int) sizeof( test_stream ); pos += chunk )
+			input_feed( c, test_stream + pos, UMIN( chunk, (int) sizeof( test_stream ) - pos ) );
+		input_drain( c, split, sizeof( split ) );
+		TEST_ASSERT_STR_EQ( split, whole );
+		input_close( c );
+	}
+
+	srand( 39 );
+	for ( i = 0; i < 200; i++ ) {
+		c = input_open( -1 );
+		for ( pos = 0; pos < (int) sizeof( test_stream ); pos += n ) {
+			n = UMIN( 1 + rand() % 9, (int) sizeof( test_stream ) - pos );
+			input_feed( c, test_stream + pos, n );
+		}
+		input_drain( c, split, sizeof( split ) );
+		TEST_ASSERT_STR_EQ( split, whole );
+		input_close( c );
+	}
+}
+
+void test_input_hostile_telnet( void ) {
+	INPUT_CONN *c = input_open( -1 );
+	unsigned char *big;
+	char out[1024];
+	int i;
+
+	/* Subnegotiation never closed: the next command ends and drops it */
+	FEED( c, "\xff\xfa\x18\x00xterm\xff\xfb\x1f" "ok\n" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "O251,31 L[ok] " );
+
+	/* SB inside SB: only the inner one survives */
+	FEED( c, "\xff\xfa\x18\x00" "a\xff\xfa\x1f\x00\x50\x00\x18\xff\xf0" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "S31:00500018 " );
+
+	/* Oversized subnegotiation is discarded whole, without growing past the cap */
+	big = malloc( INPUT_SUBNEG_MAX * 3 );
+	memset( big, 'x', INPUT_SUBNEG_MAX * 3 );
+	FEED( c, "\xff\xfa\xc9" );
+	for ( i = 0; i < 10; i++ )
+		input_feed( c, big, INPUT_SUBNEG_MAX * 3 );
+	FEED( c, "\xff\xf0" "after\n" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "L[after] " );
+	free( big );
+
+	/* Exactly INPUT_SUBNEG_MAX still arrives */
+	big = malloc( INPUT_SUBNEG_MAX );
+	memset( big, 'y', INPUT_SUBNEG_MAX );
+	FEED( c, "\xff\xfa\xc9" );
+	input_feed( c, big, INPUT_SUBNEG_MAX );
+	FEED( c, "\xff\xf0" );
+	TEST_ASSERT( input_front( c ) != NULL );
+	TEST_ASSERT_EQ( input_front( c )->type, INPUT_EV_SUBNEG );
+	TEST_ASSERT_EQ( input_front( c )->len, INPUT_SUBNEG_MAX );
+	input_pop( c );
+	free( big );
+
+	/* Stray IAC SE, NOP, GA and an escaped 255 in text are not input */
+	FEED( c, "\xff\xf0lo\xff\xf1o\xff\xf9k\xff\xff\n" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "L[look] " );
+
+	/* Escaped 255 in NAWS stays escaped for the handler */
+	FEED( c, "\xff\xfa\x1f\x00\xff\xff\x00\x18\xff\xf0" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "S31:00ffff0018 " );
+
+	input_close( c );
+}
+
+void test_input_line_cleanup( void ) {
+	INPUT_CONN *c = input_open( -1 );
+	char line[MAX_INPUT_LENGTH * 2];
+	char out[2048];
+
+	/* CR LF, LF CR and CR NUL each end one line; CR CR is two */
+	FEED( c, "a\r\nb\n\rc\r\0d\r\r" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "L[a] L[b] L[c] L[d] L[] " );
+
+	/* Backspace takes the whole character; control bytes vanish */
+	FEED( c, "ab\xc3\xa9\b\bc\x07\x1b\n" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "L[ac] " );
+
+	/* A character split across reads is kept; a broken one is dropped */
+	FEED( c, "\xe2\x82" );
+	FEED( c, "\xac!\n" );
+	FEED( c, "x\xe2\x82y\xc3\n" );
+	input_drain( c, out, sizeof( out ) );
+	TEST_ASSERT_STR_EQ( out, "L[\xe2\x82\xac!] L[xy] " );
+
+	/* Long lines are cut at MAX_INPUT_LENGTH - 2 and flagged */
+	memset( line, 'z', sizeof( line ) );
+	line[sizeof( line ) - 1] = '\n';
+	input_feed_str( c, line, sizeof( line ) );
+	TEST_ASSERT( input_front( c ) != NULL );
+	TEST_ASSERT( input_front( c )->truncated );
+	TEST_ASSERT_EQ( input_front( c )->len, MAX_INPUT_LENGTH - 2 );
+	input_pop( c );
+	TEST_ASSERT( input_front( c ) == NULL );
+
+	input_close( c );
+}
+
+void test_input_flood( void ) {
+	INPUT_CONN *c = input_open( -1 );
+	INPUT_EVENT *ev;
+	int i, lines = 0, floods = 0;
+
+	for ( i = 0; i < INPUT_QUEUE_SIZE * 2; i++ )
+		FEED( c, "n\r\n" );
+
+	while ( ( ev = input_front( c ) ) != NULL ) {
+		if ( ev->type == INPUT_EV_LINE )
+			lines++;
+		else if ( ev->type == INPUT_EV_FLOOD )
+			floods++;
+		input_pop( c );
+	}
+	TEST_ASSERT_EQ( lines, INPUT_QUEUE_SIZE - 1 );
+	TEST_ASSERT_EQ( floods, 1 );
+
+	/* Nothing more is accepted once cut off */
+	FEED( c, "n\r\n" );
+	TEST_ASSERT( input_front( c ) == NULL );
+	input_close( c );
+}
+
+/* Writes straight to the socket land in a pipe, read back through *rfd */
+static DESCRIPTOR_DATA *input_test_descriptor( int *rfd ) {
+	DESCRIPTOR_DATA *d = calloc( 1, sizeof( *d ) );
+	int fds[2];
+
+	if ( pipe( fds ) != 0 )
+		fds[0] = fds[1] = -1;
+	fcntl( fds[0], F_SETFL, O_NONBLOCK );
+	*rfd = fds[0];
+	d->descriptor = fds[1];
+	d->connected = CON_GET_NAME;
+	d->outsize = 2000;
+	d->outbuf = calloc( 1, d->outsize );
+	d->client_width = NAWS_DEFAULT_WIDTH;
+	d->client_height = NAWS_DEFAULT_HEIGHT;
+	d->host = str_dup( "127.0.0.1" );
+	d->input = input_open( -1 );
+	list_node_init( &d->node );
+	return d;
+}
+
+void test_input_dispatch( void ) {
+	char sent[256];
+	DESCRIPTOR_DATA *d;
+	int rfd, i, n;
+
+	d = input_test_descriptor( &rfd );
+	TEST_ASSERT( rfd >= 0 );
+
+	/* Negotiation is handled even while the line behind it waits */
+	FEED( d->input, "\xff\xfa\x1f\x00\x64\x00\x28\xff\xf0" "look\r\n" "!\r\n" "\r\n" );
+	TEST_ASSERT( read_from_buffer( d, FALSE ) );
+	TEST_ASSERT_EQ( d->client_width, 100 );
+	TEST_ASSERT_EQ( d->client_height, 40 );
+	TEST_ASSERT( d->naws_enabled );
+	TEST_ASSERT_STR_EQ( d->incomm, "" );
+
+	/* One line per call, and none while a command is pending */
+	TEST_ASSERT( read_from_buffer( d, TRUE ) );
+	TEST_ASSERT_STR_EQ( d->incomm, "look" );
+	strcpy( d->incomm, "held" );
+	TEST_ASSERT( read_from_buffer( d, TRUE ) );
+	TEST_ASSERT_STR_EQ( d->incomm, "held" );
+	d->incomm[0] = '\0';
+	TEST_ASSERT( read_from_buffer( d, TRUE ) );
+	TEST_ASSERT_STR_EQ( d->incomm, "look" );	/* ! repeats the last command */
+	d->incomm[0] = '\0';
+	TEST_ASSERT( read_from_buffer( d, TRUE ) );
+	TEST_ASSERT_STR_EQ( d->incomm, " " );		/* A blank line is still a command */
+	d->incomm[0] = '\0';
+	TEST_ASSERT( read_from_buffer( d, TRUE ) );
+	TEST_ASSERT_STR_EQ( d->incomm, "" );
+
+	/* Negotiation spam overruns the queue and closes the connection */
+	for ( i = 0; i < INPUT_QUEUE_SIZE; i++ )
+		FEED( d->input, "\xff\xfd\x63" );
+	TEST_ASSERT_FALSE( read_from_buffer( d, TRUE ) );
+	n = (int) read( rfd, sent, sizeof( sent ) - 1 );
+	sent[n > 0 ? n : 0] = '\0';
+	TEST_ASSERT( strstr( sent, "PUT A LID ON IT" ) != NULL );
+
+	input_close( d->input );
+	close( d->descriptor );
+	close( rfd );
+	free( d->host );
+	free( d->outbuf );
+	free( d );
+}
+
+#define STRESS_LINES 200000
+
+typedef struct {
+	INPUT_CONN *c;
+	int consumed;	/* Written by the consumer, read by the producer */
+} STRESS_STATE;
+
+static void *input_stress_producer( void *arg ) {
+	STRESS_STATE *s = arg;
+	char buf[64];
+	unsigned int seed = 7;
+	int i, len, pos, n;
+
+	for ( i = 0; i < STRESS_LINES; i++ ) {
+		/* Stay clear of the flood limit */
+		while ( i - __atomic_load_n( &s->consumed, __ATOMIC_ACQUIRE ) > INPUT_QUEUE_SIZE / 2 )
+			sched_yield();
+		len = snprintf( buf, sizeof( buf ), "cmd %d\r\n", i );
+		for ( pos = 0; pos < len; pos += n ) {
+			seed = seed * 1103515245 + 12345;
+			n = UMIN( 1 + (int) ( ( seed >> 16 ) % 4 ), len - pos );
+			input_feed( s->c, (unsigned char *) buf + pos, n );
+		}
+	}
+	return NULL;
+}
+
+void test_input_spsc_stress( void ) {
+	STRESS_STATE s;
+	pthread_t producer;
+	INPUT_EVENT *ev;
+	char expect[64];
+	int bad = 0;
+
+	s.c = input_open( -1 );
+	s.consumed = 0;
+	TEST_ASSERT_EQ( pthread_create( &producer, NULL, input_stress_producer, &s ), 0 );
+
+	while ( s.consumed < STRESS_LINES ) {
+		if ( ( ev = input_front( s.c ) ) == NULL ) {
+			sched_yield();
+			continue;
+		}
+		snprintf( expect, sizeof( expect ), "cmd %d", s.consumed );
+		if ( ev->type != INPUT_EV_LINE || strcmp( ev->data, expect ) )
+			bad++;
+		input_pop( s.c );
+		__atomic_store_n( &s.consumed, s.consumed + 1, __ATOMIC_RELEASE );
+		if ( bad > 0 )
+			break;
+	}
+	pthread_join( producer, NULL );
+	TEST_ASSERT_EQ( bad, 0 );
+	TEST_ASSERT( input_front( s.c ) == NULL );
+	input_close( s.c );
+}
+
+/* Wait up to a second for the I/O thread to queue something */
+static INPUT_EVENT *input_wait_front( INPUT_CONN *c ) {
+	INPUT_EVENT *ev;
+	int i;
+
+	for ( i = 0; i < 1000; i++ ) {
+		if ( ( ev = input_front( c ) ) != NULL )
+			return ev;
+		usleep( 1000 );
+	}
+	return NULL;
+}
+
+void test_input_thread_socket( void ) {
+	INPUT_STATS stats;
+	INPUT_CONN *c;
+	INPUT_EVENT *ev;
+	int sv[2];
+
+	TEST_ASSERT_EQ( socketpair( AF_UNIX, SOCK_STREAM, 0, sv ), 0 );
+	fcntl( sv[0], F_SETFL, O_NONBLOCK );
+
+	input_start();
+	TEST_ASSERT( input_threaded() );
+	c = input_open( sv[0] );
+
+	TEST_ASSERT_EQ( (int) write( sv[1], "say hi\r\n\xff\xfb", 10 ), 10 );
+	ev = input_wait_front( c );
+	TEST_ASSERT( ev != NULL && ev->type == INPUT_EV_LINE && !strcmp( ev->data, "say hi" ) );
+	input_pop( c );
+
+	/* The option's last byte arrives in a later read */
+	TEST_ASSERT_EQ( (int) write( sv[1], "\x1f", 1 ), 1 );
+	ev = input_wait_front( c );
+	TEST_ASSERT( ev != NULL && ev->type == INPUT_EV_OPTION && ev->opt == TELOPT_NAWS );
+	input_pop( c );
+
+	close( sv[1] );
+	ev = input_wait_front( c );
+	TEST_ASSERT( ev != NULL && ev->type == INPUT_EV_CLOSED );
+
+	input_get_stats( &stats );
+	TEST_ASSERT( stats.threaded );
+	TEST_ASSERT( stats.bytes >= 11 );
+
+	input_stop();
+	TEST_ASSERT( !input_threaded() );
+	input_close( c );
+	close( sv[0] );
+}
+
+void suite_input( void ) {
+	RUN_TEST( test_input_events_in_order );
+	RUN_TEST( test_input_fragmented );
+	RUN_TEST( test_input_hostile_telnet );
+	RUN_TEST( test_input_line_cleanup );
+	RUN_TEST( test_input_flood );
+	RUN_TEST( test_input_dispatch );
+	RUN_TEST( test_input_spsc_stress );
+	RUN_TEST( test_input_thread_socket );
+}
@@ -3,10 +3,16 @@
  *
  * Runs all unit test suites. Links against game object files with
  * TEST_BUILD defined to exclude the production main().
+ *
+ * "run_tests --replay <file> [seed]" instead replays an input capture
+ * (see test_replay.c) and prints its timings.
  */
 
 #include "test_framework.h"
 #include "test_helpers.h"
+#include "../db/db_game.h"
+#include <stdint.h>
+#include <stdlib.h>
 
 /* Define the global test counters (declared extern in test_framework.h) */
 int test_passes = 0;
@@ -34,17 +40,35 @@ extern void suite_isname( void );
 extern void suite_interp( void );
 extern void suite_handler( void );
 extern void suite_create_obj( void );
+extern void suite_show_list( void );
+extern void suite_mxp( void );
+extern void suite_mcmp( void );
+extern void suite_textfilter( void );
+extern void suite_replay( void );
+extern void suite_combatsum( void );
+extern int replay_main( const char *path, uint64_t seed );
+extern void suite_room_render( void );
+extern void suite_map_layout( void );
+extern void suite_pathfind( void );
+extern void suite_input( void );
+extern void suite_skill_lookup( void );
+extern void suite_class_ops( void );
+extern void suite_prompt( void );
 extern void suite_combat( void );
 extern void suite_scripting( void );
 extern void suite_quest( void );
 extern void suite_extraction( void );
 extern void suite_comm( void );
+extern void suite_board( void );
 extern void suite_db_player( void );
 extern void suite_olc( void );
+extern void suite_help_index( void );
+extern void suite_profile( void );
+extern void suite_db_writer( void );
 
 int main( int argc, char **argv ) {
-	(void) argc;
-	(void) argv;
+	if ( argc >= 3 && !strcmp( argv[1], "--replay" ) )
+		return replay_main( argv[2], argc >= 4 ? strtoull( argv[3], NULL, 10 ) : 1 );
 
 	printf( "Dystopia MUD - Unit Test Runner\n" );
 	printf( "========================================\n" );
@@ -57,6 +81,8 @@ int main( int argc, char **argv ) {
 	RUN_SUITE( "Affect System", suite_affects );
 	RUN_SUITE( "Name Matching", suite_isname );
 	RUN_SUITE( "Command Interpreter", suite_interp );
+	RUN_SUITE( "Profiler", suite_profile );
+	RUN_SUITE( "game.db Writer", suite_db_writer );
 
 	RUN_SUITE( "Character Extraction", suite_extraction );
 
@@ -64,12 +90,30 @@ int main( int argc, char **argv ) {
 	RUN_SUITE( "Game Boot", suite_boot );
 	RUN_SUITE( "Character/Object Movement", suite_handler );
 	RUN_SUITE( "Object Creation", suite_create_obj );
+	RUN_SUITE( "Object List Display", suite_show_list );
+	RUN_SUITE( "MXP Links", suite_mxp );
+	RUN_SUITE( "Client Media", suite_mcmp );
+	RUN_SUITE( "Text Filter", suite_textfilter );
+	RUN_SUITE( "Input Replay", suite_replay );
+	RUN_SUITE( "Combat Summary", suite_combatsum );
+	RUN_SUITE( "Room Render Cache", suite_room_render );
+	RUN_SUITE( "Map Layout", suite_map_layout );
+	RUN_SUITE( "Pathfinding", suite_pathfind );
+	RUN_SUITE( "Input Queue", suite_input );
+	RUN_SUITE( "Skill Lookup", suite_skill_lookup );
+	RUN_SUITE( "Class Ops", suite_class_ops );
+	RUN_SUITE( "Prompt", suite_prompt );
 	RUN_SUITE( "Combat Engagement", suite_combat );
 	RUN_SUITE( "Lua Scripting", suite_scripting );
 	RUN_SUITE( "Quest System", suite_quest );
 	RUN_SUITE( "Communication Commands", suite_comm );
+	RUN_SUITE( "Note Boards", suite_board );
 	RUN_SUITE( "Player Database", suite_db_player );
 	RUN_SUITE( "OLC Systems", suite_olc );
+	RUN_SUITE( "Help Index", suite_help_index );
+
+	/* Commit queued game.db writes, as the game does at shutdown */
+	db_game_close_writer();
 
 	return test_summary();
 }
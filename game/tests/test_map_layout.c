@@ -0,0 +1,299 @@
+/*
+ * Map layout tests (game/src/world/map_layout.c, commands/act_map.c)
+ *
+ * Tests:
+ * - A slice of the layout draws the same automap as walking exits
+ * - Closed doors and walls are overlaid live, without a rebuild
+ * - Warped windows are drawn by walking out from the viewer
+ * - OLC invalidation picks up new rooms on the next map
+ * - Every booted room is laid out; layout matches the walk world-wide
+ * - Benchmark: 10k automap renders, layout versus walk
+ *
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../world/olc.h"
+#include "../world/map_layout.h"
+#include "../systems/profile.h"
+
+extern ROOM_INDEX_DATA *room_index_hash[MAX_KEY_HASH];
+extern int top_vnum_room;
+
+#define GRID 3
+
+static AREA_DATA layout_area;
+static ROOM_INDEX_DATA *grid[GRID][GRID];	/* [x][y], y = 0 is south */
+
+static ROOM_INDEX_DATA *layout_room( int vnum ) {
+	ROOM_INDEX_DATA *room = new_room_index();
+	int hash = vnum % MAX_KEY_HASH;
+
+	room->vnum = vnum;
+	room->area = &layout_area;
+	room->next = room_index_hash[hash];
+	room_index_hash[hash] = room;
+	return room;
+}
+
+static void layout_unlink( ROOM_INDEX_DATA *room ) {
+	ROOM_INDEX_DATA **prev = &room_index_hash[room->vnum % MAX_KEY_HASH];
+
+	while ( *prev != room )
+		prev = &( *prev )->next;
+	*prev = room->next;
+	free_room_index( room );
+}
+
+static void layout_exit( ROOM_INDEX_DATA *from, int dir, ROOM_INDEX_DATA *to ) {
+	if ( from->exit[dir] == NULL )
+		from->exit[dir] = new_exit();
+	from->exit[dir]->to_room = to;
+	from->exit[dir]->vnum = to->vnum;
+}
+
+/* A 3x3 grid of two-way rooms in an area of its own */
+static void layout_grid_make( void ) {
+	int base = top_vnum_room + 1000;
+	int x, y;
+
+	layout_area.name = "Layout Test";
+	for ( x = 0; x < GRID; x++ )
+		for ( y = 0; y < GRID; y++ )
+			grid[x][y] = layout_room( base + y * GRID + x );
+
+	for ( x = 0; x < GRID; x++ ) {
+		for ( y = 0; y < GRID; y++ ) {
+			if ( y + 1 < GRID ) {
+				layout_exit( grid[x][y], DIR_NORTH, grid[x][y + 1] );
+				layout_exit( grid[x][y + 1], DIR_SOUTH, grid[x][y] );
+			}
+			if ( x + 1 < GRID ) {
+				layout_exit( grid[x][y], DIR_EAST, grid[x + 1][y] );
+				layout_exit( grid[x + 1][y], DIR_WEST, grid[x][y] );
+			}
+		}
+	}
+	map_layout_invalidate();
+}
+
+static void layout_grid_free( void ) {
+	int x, y;
+
+	for ( x = 0; x < GRID; x++ )
+		for ( y = 0; y < GRID; y++ )
+			layout_unlink( grid[x][y] );
+}
+
+/* Automap as the exit walk draws it, by hiding room from the layout */
+static void layout_walk_automap( ROOM_INDEX_DATA *room, int radius, char *buf, size_t len ) {
+	MAP_SHEET *sheet;
+	int x, y;
+
+	map_layout_find( room, &sheet, &x, &y );
+	room->map_sheet = NULL;
+	render_automap( room, radius, buf, len );
+	room->map_sheet = sheet;
+}
+
+static int count_str( const char *s, const char *what ) {
+	int n = 0;
+
+	while ( ( s = strstr( s, what ) ) != NULL ) {
+		n++;
+		s += strlen( what );
+	}
+	return n;
+}
+
+void test_map_layout_matches_walk( void ) {
+	char sliced[MAX_STRING_LENGTH * 2];
+	char walked[MAX_STRING_LENGTH * 2];
+	char expect[MAX_STRING_LENGTH];
+
+	ensure_booted();
+	layout_grid_make();
+
+	render_automap( grid[1][1], 1, sliced, sizeof( sliced ) );
+	layout_walk_automap( grid[1][1], 1, walked, sizeof( walked ) );
+	TEST_ASSERT_STR_EQ( sliced, walked );
+
+	snprintf( expect, sizeof( expect ),
+		"[AUTOMAP vnum=%d area=\"Layout Test\"]\n\r"
+		"#C[ ]#n#w-#n#C[ ]#n#w-#n#C[ ]#n\n\r"
+		" #w|#n   #w|#n   #w|#n \n\r"
+		"#C[ ]#n#w-#n#G[@]#n#w-#n#C[ ]#n\n\r"
+		" #w|#n   #w|#n   #w|#n \n\r"
+		"#C[ ]#n#w-#n#C[ ]#n#w-#n#C[ ]#n\n\r"
+		"[/AUTOMAP]\n\r", grid[1][1]->vnum );
+	TEST_ASSERT_STR_EQ( sliced, expect );
+
+	/* Off-centre: the corner sees only its own quadrant */
+	render_automap( grid[0][0], 1, sliced, sizeof( sliced ) );
+	layout_walk_automap( grid[0][0], 1, walked, sizeof( walked ) );
+	TEST_ASSERT_STR_EQ( sliced, walked );
+
+	layout_grid_free();
+}
+
+void test_map_layout_overlays( void ) {
+	char buf[MAX_STRING_LENGTH * 2];
+
+	ensure_booted();
+	layout_grid_make();
+	render_automap( grid[1][1], 1, buf, sizeof( buf ) );
+
+	/* A closed door east, with no rebuild in between */
+	SET_BIT( grid[1][1]->exit[DIR_EAST]->exit_info, EX_ISDOOR | EX_CLOSED );
+	render_automap( grid[1][1], 1, buf, sizeof( buf ) );
+	TEST_ASSERT( strstr( buf, "#G[@]#n#y+#n#C[ ]#n" ) != NULL );
+
+	/* Opening it puts the plain connector back */
+	REMOVE_BIT( grid[1][1]->exit[DIR_EAST]->exit_info, EX_CLOSED );
+	render_automap( grid[1][1], 1, buf, sizeof( buf ) );
+	TEST_ASSERT( strstr( buf, "#G[@]#n#w-#n#C[ ]#n" ) != NULL );
+
+	/* A wall north */
+	SET_BIT( grid[1][1]->exit[DIR_NORTH]->exit_info, EX_FIRE_WALL );
+	render_automap( grid[1][1], 1, buf, sizeof( buf ) );
+	TEST_ASSERT( strstr( buf, " #w|#n   #Rx#n   #w|#n " ) != NULL );
+
+	layout_grid_free();
+}
+
+void test_map_layout_warped( void ) {
+	char buf[MAX_STRING_LENGTH * 2];
+
+	ensure_booted();
+	layout_grid_make();
+
+	/* East of the centre now leads to the north-east corner */
+	layout_exit( grid[1][1], DIR_EAST, grid[2][2] );
+	map_layout_invalidate();
+	render_automap( grid[1][1], 1, buf, sizeof( buf ) );
+	TEST_ASSERT( strstr( buf, "#G[@]#n#R~#n#C[ ]#n" ) != NULL );
+
+	layout_grid_free();
+}
+
+void test_map_layout_rebuild_after_edit( void ) {
+	ROOM_INDEX_DATA *extra;
+	char buf[MAX_STRING_LENGTH * 2];
+
+	ensure_booted();
+	layout_grid_make();
+	render_automap( grid[1][1], 2, buf, sizeof( buf ) );
+	TEST_ASSERT_EQ( count_str( buf, "#C[ ]#n" ), 8 );
+
+	/* A room dug east of the grid, as redit would */
+	extra = layout_room( grid[2][1]->vnum + 100 );
+	layout_exit( grid[2][1], DIR_EAST, extra );
+	layout_exit( extra, DIR_WEST, grid[2][1] );
+	map_layout_invalidate();
+
+	render_automap( grid[1][1], 2, buf, sizeof( buf ) );
+	TEST_ASSERT_EQ( count_str( buf, "#C[ ]#n" ), 9 );
+	TEST_ASSERT( extra->map_sheet == grid[1][1]->map_sheet );
+
+	layout_unlink( extra );
+	free_exit( grid[2][1]->exit[DIR_EAST] );
+	grid[2][1]->exit[DIR_EAST] = NULL;
+	layout_grid_free();
+}
+
+void test_map_layout_world( void ) {
+	ROOM_INDEX_DATA *room;
+	MAP_SHEET *sheet;
+	char sliced[MAX_STRING_LENGTH * 2];
+	char walked[MAX_STRING_LENGTH * 2];
+	long cells, rooms, total = 0, unplaced = 0, same = 0;
+	int sheets, hash, x, y;
+
+	ensure_booted();
+	map_layout_invalidate();
+
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ ) {
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next ) {
+			total++;
+			if ( !map_layout_find( room, &sheet, &x, &y ) ) {
+				unplaced++;
+				continue;
+			}
+			TEST_ASSERT( map_sheet_room( sheet, x, y ) == room );
+			render_automap( room, 3, sliced, sizeof( sliced ) );
+			layout_walk_automap( room, 3, walked, sizeof( walked ) );
+			if ( !strcmp( sliced, walked ) )
+				same++;
+		}
+	}
+	TEST_ASSERT_EQ( (int) unplaced, 0 );
+
+	map_layout_get_stats( &sheets, &cells, &rooms );
+	TEST_ASSERT( sheets > 0 );
+	TEST_ASSERT( rooms >= total );
+	/*
+	 * Warped windows are walked, so the rest differ only where the layout
+	 * also shows rooms in view that the walk reaches by leaving it
+	 */
+	TEST_ASSERT( same * 5 >= total * 4 );
+	printf( "    [bench] layout: %ld rooms on %d sheets, %ld cells (%ld KB); "
+		"%ld of %ld automaps identical to the walk\n",
+		total, sheets, cells, cells * (long) ( sizeof( ROOM_INDEX_DATA * ) + sizeof( unsigned short ) ) / 1024,
+		same, total );
+}
+
+void test_map_layout_bench( void ) {
+	ROOM_INDEX_DATA *room, *best = NULL;
+	MAP_SHEET *sheet;
+	char buf[MAX_STRING_LENGTH * 2];
+	int64_t start, sliced, walked;
+	int hash, i, x, y, n, best_n = -1;
+
+	ensure_booted();
+
+	/* The room with the fullest 7x7 neighbourhood */
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ ) {
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next ) {
+			if ( !map_layout_find( room, &sheet, &x, &y ) )
+				continue;
+			n = 0;
+			for ( i = 0; i < 49; i++ )
+				if ( map_sheet_room( sheet, x - 3 + i % 7, y - 3 + i / 7 ) != NULL )
+					n++;
+			if ( n > best_n ) {
+				best_n = n;
+				best = room;
+			}
+		}
+	}
+	TEST_ASSERT( best != NULL );
+	if ( best == NULL )
+		return;
+
+	start = profile_now_ns();
+	for ( i = 0; i < 10000; i++ )
+		render_automap( best, 3, buf, sizeof( buf ) );
+	sliced = profile_now_ns() - start;
+
+	map_layout_find( best, &sheet, &x, &y );
+	best->map_sheet = NULL;
+	start = profile_now_ns();
+	for ( i = 0; i < 10000; i++ )
+		render_automap( best, 3, buf, sizeof( buf ) );
+	walked = profile_now_ns() - start;
+	best->map_sheet = sheet;
+
+	printf( "    [bench] 10k automaps (room %d, %d/49 cells): %lld us from layout, %lld us walking exits\n",
+		best->vnum, best_n, (long long) ( sliced / 1000 ), (long long) ( walked / 1000 ) );
+}
+
+void suite_map_layout( void ) {
+	RUN_TEST( test_map_layout_matches_walk );
+	RUN_TEST( test_map_layout_overlays );
+	RUN_TEST( test_map_layout_warped );
+	RUN_TEST( test_map_layout_rebuild_after_edit );
+	RUN_TEST( test_map_layout_world );
+	RUN_TEST( test_map_layout_bench );
+}
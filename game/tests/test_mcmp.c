@@ -0,0 +1,295 @@
+/*
+ * MCMP tests (game/src/systems/mcmp.c, audio config in db/db_game.c)
+ *
+ * Tests:
+ * - audio_config_find() through the (category, key) hash, any case
+ * - The per-pulse media queue: repeats merged, same key replaced, lowest
+ *   priority dropped past MCMP_QUEUE_MAX, a stop never overtaking plays
+ * - Messages and writes per client over a headless group fight, against
+ *   one message and one write per sound as before
+ *
+ * Each client descriptor writes into a pipe so the frames that would
+ * reach the client can be read back and counted.
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../systems/gmcp.h"
+#include "../systems/mcmp.h"
+#include "../db/db_game.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define GROUP_SIZE	 5
+#define FIGHT_PULSES 60
+
+typedef struct mcmp_client {
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+	int fds[2];
+	char got[65536];
+	int got_len;
+} MCMP_CLIENT;
+
+static bool client_open( MCMP_CLIENT *c ) {
+	memset( c, 0, sizeof( *c ) );
+	if ( pipe( c->fds ) != 0 )
+		return FALSE;
+	fcntl( c->fds[0], F_SETFL, O_NONBLOCK );
+
+	c->ch = make_test_player();
+	SET_BIT( c->ch->act, PLR_PREFER_MCMP );
+	c->ch->desc = &c->desc;
+	c->desc.character = c->ch;
+	c->desc.descriptor = c->fds[1];
+	c->desc.gmcp_enabled = TRUE;
+	c->desc.gmcp_packages = GMCP_PACKAGE_CLIENT_MEDIA;
+	return TRUE;
+}
+
+static void client_close( MCMP_CLIENT *c ) {
+	mcmp_queue_free( &c->desc );
+	c->ch->desc = NULL;
+	free_test_char( c->ch );
+	close( c->fds[0] );
+	close( c->fds[1] );
+}
+
+/* Append whatever reached the client since the last read */
+static void client_drain( MCMP_CLIENT *c ) {
+	int n;
+
+	while ( c->got_len < (int) sizeof( c->got ) - 1
+		&& ( n = read( c->fds[0], c->got + c->got_len, sizeof( c->got ) - 1 - c->got_len ) ) > 0 )
+		c->got_len += n;
+	c->got[c->got_len] = '\0';
+}
+
+static void client_reset( MCMP_CLIENT *c ) {
+	client_drain( c );
+	c->got_len = 0;
+	c->got[0] = '\0';
+}
+
+/* Occurrences of what in the bytes read so far (frames hold IAC, not NUL) */
+static int client_count( MCMP_CLIENT *c, const char *what ) {
+	int len = (int) strlen( what );
+	int i, n = 0;
+
+	for ( i = 0; i + len <= c->got_len; i++ )
+		if ( !memcmp( c->got + i, what, len ) )
+			n++;
+	return n;
+}
+
+static const char *client_find( MCMP_CLIENT *c, const char *what ) {
+	int len = (int) strlen( what );
+	int i;
+
+	for ( i = 0; i + len <= c->got_len; i++ )
+		if ( !memcmp( c->got + i, what, len ) )
+			return c->got + i;
+	return NULL;
+}
+
+/* Copy of src in upper case */
+static void upcase( char *dst, const char *src, int size ) {
+	int i;
+
+	for ( i = 0; src[i] != '\0' && i < size - 1; i++ )
+		dst[i] = toupper( (unsigned char) src[i] );
+	dst[i] = '\0';
+}
+
+static void test_audio_config_find( void ) {
+	static const char *pairs[][2] = {
+		{ "combat", "combat_miss" }, { "combat", "combat_death" },
+		{ "ui", "ui_death" }, { "channel", "CHANNEL_TELL" },
+		{ "ambient", "SECT_FOREST" }, { "footstep", "SECT_CITY" }
+	};
+	char cat[64], key[64];
+	AUDIO_ENTRY *ae;
+	size_t i;
+
+	for ( i = 0; i < sizeof( pairs ) / sizeof( pairs[0] ); i++ ) {
+		ae = audio_config_find( pairs[i][0], pairs[i][1] );
+		if ( ae == NULL )
+			continue;
+		TEST_ASSERT( !str_cmp( ae->category, pairs[i][0] ) );
+		TEST_ASSERT( !str_cmp( ae->trigger_key, pairs[i][1] ) );
+
+		/* str_cmp() rules: case does not matter */
+		upcase( cat, pairs[i][0], sizeof( cat ) );
+		upcase( key, pairs[i][1], sizeof( key ) );
+		TEST_ASSERT( audio_config_find( cat, key ) == ae );
+	}
+
+	/* The sector tables come from the same entries */
+	ae = audio_config_find( "ambient", "SECT_FOREST" );
+	if ( ae != NULL )
+		TEST_ASSERT( audio_ambient[SECT_FOREST] == ae );
+
+	TEST_ASSERT( audio_config_find( "combat", "no_such_sound" ) == NULL );
+	TEST_ASSERT( audio_config_find( "combat_miss", "combat" ) == NULL );
+	TEST_ASSERT( audio_config_find( NULL, "combat_miss" ) == NULL );
+	TEST_ASSERT( audio_config_find( "combat", NULL ) == NULL );
+}
+
+static void test_queue_merges_and_caps( void ) {
+	MCMP_CLIENT c;
+	char name[32];
+	int i;
+
+	if ( !client_open( &c ) ) {
+		TEST_ASSERT( FALSE );
+		return;
+	}
+
+	/* Nothing is written until the flush */
+	mcmp_play( &c.desc, "combat/miss.mp3", MCMP_SOUND, MCMP_TAG_COMBAT, 30, 1, 30, NULL, FALSE, NULL );
+	mcmp_play( &c.desc, "combat/miss.mp3", MCMP_SOUND, MCMP_TAG_COMBAT, 30, 1, 30, NULL, FALSE, NULL );
+	client_drain( &c );
+	TEST_ASSERT_EQ( c.got_len, 0 );
+	mcmp_flush( &c.desc );
+	client_drain( &c );
+	TEST_ASSERT_EQ( client_count( &c, "Client.Media.Play" ), 1 );
+
+	/* Unkeyed repeat keeps the higher priority copy */
+	client_reset( &c );
+	mcmp_play( &c.desc, "combat/miss.mp3", MCMP_SOUND, NULL, 30, 1, 30, NULL, FALSE, NULL );
+	mcmp_play( &c.desc, "combat/miss.mp3", MCMP_SOUND, NULL, 30, 1, 70, NULL, FALSE, NULL );
+	mcmp_play( &c.desc, "combat/miss.mp3", MCMP_SOUND, NULL, 30, 1, 50, NULL, FALSE, NULL );
+	mcmp_flush( &c.desc );
+	client_drain( &c );
+	TEST_ASSERT_EQ( client_count( &c, "Client.Media.Play" ), 1 );
+	TEST_ASSERT_EQ( client_count( &c, "\"priority\":70" ), 1 );
+
+	/* Same key: the later sound replaces the earlier, as on the client */
+	client_reset( &c );
+	mcmp_play( &c.desc, "weather/rain.mp3", MCMP_MUSIC, NULL, 25, -1, 20, "weather", FALSE, NULL );
+	mcmp_play( &c.desc, "weather/snow.mp3", MCMP_MUSIC, NULL, 25, -1, 20, "weather", FALSE, NULL );
+	mcmp_flush( &c.desc );
+	client_drain( &c );
+	TEST_ASSERT_EQ( client_count( &c, "Client.Media.Play" ), 1 );
+	TEST_ASSERT( client_find( &c, "snow.mp3" ) != NULL );
+	TEST_ASSERT( client_find( &c, "rain.mp3" ) == NULL );
+
+	/* Past the cap the lowest priorities go, the rest keep their order */
+	client_reset( &c );
+	for ( i = 0; i < MCMP_QUEUE_MAX + 4; i++ ) {
+		snprintf( name, sizeof( name ), "s%02d.mp3", i );
+		mcmp_play( &c.desc, name, MCMP_SOUND, NULL, 0, 0, i % 2 ? 90 : 10 + i, NULL, FALSE, NULL );
+	}
+	mcmp_flush( &c.desc );
+	client_drain( &c );
+	TEST_ASSERT_EQ( client_count( &c, "Client.Media.Play" ), MCMP_QUEUE_MAX );
+	for ( i = 1; i < MCMP_QUEUE_MAX + 4; i += 2 ) {
+		snprintf( name, sizeof( name ), "s%02d.mp3", i );
+		TEST_ASSERT( client_find( &c, name ) != NULL );
+	}
+	TEST_ASSERT( client_find( &c, "s00.mp3" ) == NULL );
+	TEST_ASSERT( client_find( &c, "s10.mp3" ) != NULL );
+	TEST_ASSERT( client_find( &c, "s01.mp3" ) < client_find( &c, "s03.mp3" ) );
+
+	/* A stop goes out after the plays queued before it */
+	client_reset( &c );
+	mcmp_play( &c.desc, "combat/engage.mp3", MCMP_SOUND, NULL, 0, 0, 50, NULL, FALSE, NULL );
+	mcmp_stop( &c.desc, NULL, NULL, NULL, NULL, TRUE, 1000 );
+	client_drain( &c );
+	TEST_ASSERT( client_find( &c, "engage.mp3" ) != NULL );
+	TEST_ASSERT( client_find( &c, "Client.Media.Stop" ) != NULL );
+	TEST_ASSERT( client_find( &c, "engage.mp3" ) < client_find( &c, "Client.Media.Stop" ) );
+
+	/* Queue is dropped, not sent, once the client turns media off */
+	client_reset( &c );
+	mcmp_play( &c.desc, "combat/engage.mp3", MCMP_SOUND, NULL, 0, 0, 50, NULL, FALSE, NULL );
+	REMOVE_BIT( c.ch->act, PLR_PREFER_MCMP );
+	mcmp_flush( &c.desc );
+	client_drain( &c );
+	TEST_ASSERT_EQ( c.got_len, 0 );
+
+	client_close( &c );
+}
+
+/*
+ * A group of players fighting a pack of mobs: each player's round sound
+ * from violence_update(), the group's chatter arriving on every member's
+ * channel, mobs dying (several to one area spell every tenth round) and
+ * the victory sound when the pack is gone.
+ */
+static void test_group_fight_message_count( void ) {
+	static MCMP_CLIENT group[GROUP_SIZE];
+	long played0, sent0, writes0, played, sent, writes;
+	int p, i, k, pack = 0, received = 0;
+
+	seed_rng( 47 );
+	for ( p = 0; p < GROUP_SIZE; p++ ) {
+		if ( !client_open( &group[p] ) ) {
+			TEST_ASSERT( FALSE );
+			while ( --p >= 0 )
+				client_close( &group[p] );
+			return;
+		}
+	}
+
+	mcmp_get_stats( &played0, &sent0, &writes0 );
+	for ( i = 0; i < FIGHT_PULSES; i++ ) {
+		if ( pack == 0 ) {
+			pack = 6;
+			for ( p = 0; p < GROUP_SIZE; p++ )
+				mcmp_combat_start( group[p].ch, NULL );
+		}
+
+		for ( p = 0; p < GROUP_SIZE; p++ ) {
+			int dam = number_range( 0, 3000 );
+			mcmp_combat_round( group[p].ch, NULL, dam > 0, dam == 0, dam );
+		}
+
+		for ( k = number_range( 1, 4 ); k > 0; k-- )
+			for ( p = 0; p < GROUP_SIZE; p++ )
+				mcmp_channel_notify( group[p].ch, CHANNEL_CHAT );
+
+		if ( i % 10 == 9 || i % 4 == 3 ) {
+			CHAR_DATA *killer = group[number_range( 0, GROUP_SIZE - 1 )].ch;
+
+			for ( k = ( i % 10 == 9 ) ? 3 : 1; k > 0 && pack > 0; k--, pack-- )
+				mcmp_combat_death( killer, NULL );
+			if ( pack == 0 )
+				mcmp_combat_end( killer );
+		}
+
+		/* End of the pulse: game_loop()'s output pass */
+		for ( p = 0; p < GROUP_SIZE; p++ ) {
+			mcmp_flush( &group[p].desc );
+			client_drain( &group[p] );
+		}
+	}
+	mcmp_get_stats( &played, &sent, &writes );
+	played -= played0;
+	sent -= sent0;
+	writes -= writes0;
+
+	for ( p = 0; p < GROUP_SIZE; p++ )
+		received += client_count( &group[p], "Client.Media.Play" );
+
+	printf( "    [bench] group fight, %d players x %d pulses: %ld sounds; legacy %ld messages in %ld writes, queued %ld messages in %ld writes\n",
+		GROUP_SIZE, FIGHT_PULSES, played, played, played, sent, writes );
+
+	TEST_ASSERT_EQ( (long) received, sent );
+	TEST_ASSERT( sent < played );
+	TEST_ASSERT( writes <= (long) GROUP_SIZE * FIGHT_PULSES );
+
+	for ( p = 0; p < GROUP_SIZE; p++ )
+		client_close( &group[p] );
+}
+
+void suite_mcmp( void ) {
+	if ( !ensure_booted() ) return;
+
+	RUN_TEST( test_audio_config_find );
+	RUN_TEST( test_queue_merges_and_caps );
+	RUN_TEST( test_group_fight_message_count );
+}
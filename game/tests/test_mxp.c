@@ -0,0 +1,292 @@
+/*
+ * MXP link tests (game/src/systems/mxp.c)
+ *
+ * Tests:
+ * - Element definitions are well formed and hold no literal single quotes
+ * - Object links use the predefined element once negotiated, and fall back
+ *   to a full SEND when the menu has per-viewer extras
+ * - Item tooltips are cached per object and rebuilt when the object changes,
+ *   or when a portal's destination room is renamed
+ * - Bytes per look with full SEND tags versus predefined elements
+ *
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../systems/mxp.h"
+
+extern OBJ_INDEX_DATA *obj_index_hash[MAX_KEY_HASH];
+extern MOB_INDEX_DATA *mob_index_hash[MAX_KEY_HASH];
+
+/* Up to max object prototypes with distinct, non-empty names */
+static int mxp_obj_protos( OBJ_INDEX_DATA **out, int max ) {
+	OBJ_INDEX_DATA *p;
+	int n = 0, i, j;
+
+	for ( i = 0; i < MAX_KEY_HASH && n < max; i++ ) {
+		for ( p = obj_index_hash[i]; p != NULL && n < max; p = p->next ) {
+			if ( p->name == NULL || p->name[0] == '\0' || p->short_descr == NULL )
+				continue;
+			for ( j = 0; j < n; j++ )
+				if ( !strcmp( out[j]->short_descr, p->short_descr ) )
+					break;
+			if ( j == n )
+				out[n++] = p;
+		}
+	}
+	return n;
+}
+
+static int mxp_mob_protos( MOB_INDEX_DATA **out, int max ) {
+	MOB_INDEX_DATA *p;
+	int n = 0, i;
+
+	for ( i = 0; i < MAX_KEY_HASH && n < max; i++ )
+		for ( p = mob_index_hash[i]; p != NULL && n < max; p = p->next )
+			if ( p->player_name != NULL && p->player_name[0] != '\0' )
+				out[n++] = p;
+	return n;
+}
+
+/* Viewer with an MXP descriptor; elements says whether they were negotiated */
+static CHAR_DATA *mxp_viewer( DESCRIPTOR_DATA *desc, bool elements ) {
+	CHAR_DATA *ch = make_full_test_npc();
+
+	memset( desc, 0, sizeof( *desc ) );
+	desc->descriptor = -1;
+	desc->mxp_enabled = TRUE;
+	desc->mxp_elements = elements;
+	ch->desc = desc;
+	SET_BIT( ch->affected_by, AFF_INFRARED );
+	return ch;
+}
+
+static OBJ_DATA *mxp_plain_obj( OBJ_INDEX_DATA *proto ) {
+	OBJ_DATA *obj = create_object( proto, 0 );
+
+	obj->item_type = ITEM_TREASURE;
+	obj->spectype = 0;
+	obj->condition = 100;
+	return obj;
+}
+
+void test_mxp_element_definitions( void ) {
+	static const char *names[] = { "Og", "Oc", "Om", "Op", "Of", "Oi", "On",
+		"Oe", "Ow", "Ot", "Mb", "Pc", "Fi", "Ex", "Au" };
+	char buf[MXP_BUF_MAX_LEN];
+	char want[32];
+	size_t len, i;
+	int quotes = 0;
+	const char *p;
+
+	len = mxp_element_definitions( buf, sizeof( buf ) );
+	TEST_ASSERT( len > 0 );
+	TEST_ASSERT_EQ( (int) len, (int) strlen( buf ) );
+
+	for ( i = 0; i < sizeof( names ) / sizeof( names[0] ); i++ ) {
+		snprintf( want, sizeof( want ), "<!ELEMENT %s '<send ", names[i] );
+		TEST_ASSERT( strstr( buf, want ) != NULL );
+	}
+
+	/* Only the quotes around each definition and its ATT list */
+	for ( p = buf; *p; p++ )
+		if ( *p == '\'' )
+			quotes++;
+	TEST_ASSERT_EQ( quotes, 4 * (int) ( sizeof( names ) / sizeof( names[0] ) ) );
+
+	/* Too small a buffer never leaves a partial definition */
+	len = mxp_element_definitions( buf, 64 );
+	TEST_ASSERT_EQ( (int) len, 0 );
+	TEST_ASSERT_STR_EQ( buf, "" );
+}
+
+void test_mxp_obj_link_element( void ) {
+	OBJ_INDEX_DATA *proto;
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+	OBJ_DATA *obj;
+	char want[MAX_STRING_LENGTH];
+	char *out;
+
+	ensure_booted();
+	TEST_ASSERT_EQ( mxp_obj_protos( &proto, 1 ), 1 );
+
+	ch = mxp_viewer( &desc, FALSE );
+	obj = mxp_plain_obj( proto );
+
+	/* Not negotiated: full SEND menu */
+	snprintf( want, sizeof( want ), "<SEND href=\"get '%s'|look '%s'|sacrifice '%s'\"",
+		obj->name, obj->name, obj->name );
+	out = mxp_obj_link( obj, ch, "thing", TRUE, 1 );
+	TEST_ASSERT( strstr( out, want ) != NULL );
+
+	/* Negotiated: the Og element with just keywords and tooltip */
+	desc.mxp_elements = TRUE;
+	snprintf( want, sizeof( want ), MXP_SECURE_LINE "<Og k=\"'%s'\" h=\"%s\">" MXP_LOCK_LOCKED "thing"
+		MXP_SECURE_LINE "</Og>" MXP_LOCK_LOCKED, obj->name, obj->mxp_hint );
+	out = mxp_obj_link( obj, ch, "thing", TRUE, 1 );
+	TEST_ASSERT_STR_EQ( out, want );
+
+	/* Inventory: primary action travels as parameters */
+	obj->item_type = ITEM_POTION;
+	out = mxp_obj_link( obj, ch, "thing", FALSE, 1 );
+	TEST_ASSERT( strstr( out, MXP_SECURE_LINE "<Oi u=\"quaff\" l=\"Quaff\" k=\"'" ) == out );
+
+	/* A stack needs Drop All, so it stays a full SEND */
+	out = mxp_obj_link( obj, ch, "thing", FALSE, 2 );
+	TEST_ASSERT( strstr( out, "<SEND href=\"quaff '" ) != NULL );
+	TEST_ASSERT( strstr( out, "Drop All" ) != NULL );
+
+	/* As do special actions */
+	obj->item_type = ITEM_TREASURE;
+	SET_BIT( obj->spectype, SITEM_PRESS );
+	out = mxp_obj_link( obj, ch, "thing", TRUE, 1 );
+	TEST_ASSERT( strstr( out, "|Press\">" ) != NULL );
+
+	extract_obj( obj );
+	ch->desc = NULL;
+	free_char( ch );
+}
+
+void test_mxp_hint_cache( void ) {
+	OBJ_INDEX_DATA *proto;
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+	OBJ_DATA *obj;
+	char *hint;
+
+	ensure_booted();
+	TEST_ASSERT_EQ( mxp_obj_protos( &proto, 1 ), 1 );
+
+	ch = mxp_viewer( &desc, TRUE );
+	obj = mxp_plain_obj( proto );
+	TEST_ASSERT( obj->mxp_hint == NULL );
+
+	mxp_obj_link( obj, ch, "thing", TRUE, 1 );
+	hint = obj->mxp_hint;
+	TEST_ASSERT( hint != NULL );
+	TEST_ASSERT( strstr( hint, "%" ) == NULL );
+
+	/* Unchanged object: the same string is reused */
+	mxp_obj_link( obj, ch, "thing", FALSE, 1 );
+	TEST_ASSERT( obj->mxp_hint == hint );
+
+	/* Damage shows up on the next link */
+	obj->condition = 42;
+	mxp_obj_link( obj, ch, "thing", TRUE, 1 );
+	TEST_ASSERT( strstr( obj->mxp_hint, ", 42%" ) != NULL );
+
+	extract_obj( obj );
+	ch->desc = NULL;
+	free_char( ch );
+}
+
+void test_mxp_hint_portal_rename( void ) {
+	OBJ_INDEX_DATA *proto;
+	ROOM_INDEX_DATA *dest;
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+	OBJ_DATA *obj;
+	char *old_name;
+
+	ensure_booted();
+	TEST_ASSERT_EQ( mxp_obj_protos( &proto, 1 ), 1 );
+	dest = get_room_index( ROOM_VNUM_LIMBO );
+	TEST_ASSERT( dest != NULL );
+
+	ch = mxp_viewer( &desc, TRUE );
+	obj = mxp_plain_obj( proto );
+	obj->item_type = ITEM_PORTAL;
+	obj->value[0] = dest->vnum;
+	mxp_obj_link( obj, ch, "thing", TRUE, 1 );
+	TEST_ASSERT( obj->mxp_hint != NULL );
+
+	/* Renaming the far room alone changes the tooltip */
+	old_name = dest->name;
+	dest->name = str_dup( "Renamed Test Room" );
+	mxp_obj_link( obj, ch, "thing", TRUE, 1 );
+	TEST_ASSERT( strstr( obj->mxp_hint, "To: Renamed Test Room" ) != NULL );
+	free( dest->name );
+	dest->name = old_name;
+
+	extract_obj( obj );
+	ch->desc = NULL;
+	free_char( ch );
+}
+
+/* One 'look' in a room holding the given objects and mobs */
+static size_t mxp_look_bytes( CHAR_DATA *ch ) {
+	size_t len;
+
+	test_output_start( ch );
+	do_look( ch, "auto" );
+	len = strlen( test_output_get() );
+	test_output_stop();
+	return len;
+}
+
+void test_mxp_bytes_per_look( void ) {
+	OBJ_INDEX_DATA *oprotos[12];
+	MOB_INDEX_DATA *mprotos[4];
+	CHAR_DATA *mobs[4];
+	OBJ_DATA *objs[12];
+	ROOM_INDEX_DATA *room;
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+	char defs[MXP_BUF_MAX_LEN];
+	size_t before, after, def_len;
+	int nobj, nmob, i;
+
+	ensure_booted();
+	room = get_room_index( ROOM_VNUM_LIMBO );
+	TEST_ASSERT( room != NULL );
+	if ( room == NULL )
+		return;
+	nobj = mxp_obj_protos( oprotos, 12 );
+	nmob = mxp_mob_protos( mprotos, 4 );
+	TEST_ASSERT( nobj > 0 );
+	TEST_ASSERT( nmob > 0 );
+
+	ch = mxp_viewer( &desc, FALSE );
+	char_to_room( ch, room );
+	for ( i = 0; i < nobj; i++ ) {
+		objs[i] = mxp_plain_obj( oprotos[i] );
+		SET_BIT( objs[i]->extra_flags, ITEM_GLOW );
+		obj_to_room( objs[i], room );
+	}
+	for ( i = 0; i < nmob; i++ ) {
+		mobs[i] = create_mobile( mprotos[i] );
+		char_to_room( mobs[i], room );
+	}
+
+	before = mxp_look_bytes( ch );
+	desc.mxp_elements = TRUE;
+	after = mxp_look_bytes( ch );
+	def_len = mxp_element_definitions( defs, sizeof( defs ) );
+
+	TEST_ASSERT( after < before );
+	printf( "    [bench] look with %d objects, %d mobs: %zu bytes with SEND, %zu with elements"
+		" (definitions %zu bytes once, repaid after %zu looks)\n",
+		nobj, nmob, before, after, def_len,
+		before > after ? ( def_len + before - after - 1 ) / ( before - after ) : (size_t) 0 );
+
+	for ( i = 0; i < nmob; i++ ) {
+		char_from_room( mobs[i] );
+		free_test_mobile( mobs[i] );
+	}
+	for ( i = 0; i < nobj; i++ )
+		extract_obj( objs[i] );
+	char_from_room( ch );
+	ch->desc = NULL;
+	free_char( ch );
+}
+
+void suite_mxp( void ) {
+	RUN_TEST( test_mxp_element_definitions );
+	RUN_TEST( test_mxp_obj_link_element );
+	RUN_TEST( test_mxp_hint_cache );
+	RUN_TEST( test_mxp_hint_portal_rename );
+	RUN_TEST( test_mxp_bytes_per_look );
+}
@@ -0,0 +1,471 @@
+/*
+ * Pathfinding tests (game/src/world/pathfind.c)
+ *
+ * Tests:
+ * - Shortest routes on a grid, and the route actually arrives
+ * - PATH_OPEN_ONLY detours around closed doors; PATH_STAY_AREA around
+ *   shortcuts through another area
+ * - Area-table hints agree with the search; repeat queries hit the cache
+ * - Exit edits plus path_invalidate() change the answer
+ * - Stay-area mobs walk home; scripts use room:path_to / mob:step_toward
+ * - Benchmark: random pairs over the booted world, against a plain BFS
+ *
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../world/olc.h"
+#include "../world/pathfind.h"
+#include "../script/script.h"
+#include "../systems/profile.h"
+
+extern ROOM_INDEX_DATA *room_index_hash[MAX_KEY_HASH];
+extern int top_vnum_room;
+
+#define GRID 3
+
+static AREA_DATA path_area_a;
+static AREA_DATA path_area_b;
+static ROOM_INDEX_DATA *grid[GRID][GRID];	/* [x][y], y = 0 is south */
+static ROOM_INDEX_DATA *bridge;				/* In path_area_b */
+
+static ROOM_INDEX_DATA *path_room( AREA_DATA *area, int vnum ) {
+	ROOM_INDEX_DATA *room = new_room_index();
+	int hash = vnum % MAX_KEY_HASH;
+
+	room->vnum = vnum;
+	room->area = area;
+	room->next = room_index_hash[hash];
+	room_index_hash[hash] = room;
+	return room;
+}
+
+static void path_unlink( ROOM_INDEX_DATA *room ) {
+	ROOM_INDEX_DATA **prev = &room_index_hash[room->vnum % MAX_KEY_HASH];
+
+	while ( *prev != room )
+		prev = &( *prev )->next;
+	*prev = room->next;
+	free_room_index( room );
+}
+
+static void path_exit( ROOM_INDEX_DATA *from, int dir, ROOM_INDEX_DATA *to ) {
+	if ( from->exit[dir] == NULL )
+		from->exit[dir] = new_exit();
+	from->exit[dir]->to_room = to;
+	from->exit[dir]->vnum = to->vnum;
+}
+
+/*
+ * A 3x3 grid of two-way rooms in area A, plus a bridge room in area B
+ * reached up from the south-west corner that drops down into the
+ * north-east corner.
+ */
+static void path_world_make( void ) {
+	int base = top_vnum_room + 2000;
+	int x, y;
+
+	path_area_a.name = "Path Test A";
+	path_area_b.name = "Path Test B";
+	for ( x = 0; x < GRID; x++ )
+		for ( y = 0; y < GRID; y++ )
+			grid[x][y] = path_room( &path_area_a, base + y * GRID + x );
+	bridge = path_room( &path_area_b, base + 100 );
+
+	for ( x = 0; x < GRID; x++ ) {
+		for ( y = 0; y < GRID; y++ ) {
+			if ( y + 1 < GRID ) {
+				path_exit( grid[x][y], DIR_NORTH, grid[x][y + 1] );
+				path_exit( grid[x][y + 1], DIR_SOUTH, grid[x][y] );
+			}
+			if ( x + 1 < GRID ) {
+				path_exit( grid[x][y], DIR_EAST, grid[x + 1][y] );
+				path_exit( grid[x + 1][y], DIR_WEST, grid[x][y] );
+			}
+		}
+	}
+	path_exit( grid[0][0], DIR_UP, bridge );
+	path_exit( bridge, DIR_DOWN, grid[2][2] );
+	path_invalidate();
+}
+
+static void path_world_free( void ) {
+	int x, y;
+
+	for ( x = 0; x < GRID; x++ )
+		for ( y = 0; y < GRID; y++ )
+			path_unlink( grid[x][y] );
+	path_unlink( bridge );
+}
+
+/* Follow dirs from from; the room reached, or NULL if an exit is missing */
+static ROOM_INDEX_DATA *path_follow( ROOM_INDEX_DATA *from, const int *dirs, int len ) {
+	int i;
+
+	for ( i = 0; i < len && from != NULL; i++ )
+		from = from->exit[dirs[i]] != NULL ? from->exit[dirs[i]]->to_room : NULL;
+	return from;
+}
+
+void test_path_grid_shortest( void ) {
+	int dirs[16];
+	int len;
+
+	ensure_booted();
+	path_world_make();
+
+	len = path_find( grid[0][2], grid[2][0], PATH_STAY_AREA, 100, dirs, 16 );
+	TEST_ASSERT_EQ( len, 4 );
+	TEST_ASSERT( path_follow( grid[0][2], dirs, len ) == grid[2][0] );
+
+	TEST_ASSERT_EQ( path_find( grid[1][1], grid[1][1], 0, 100, dirs, 16 ), 0 );
+	TEST_ASSERT_EQ( path_next_dir( grid[1][1], grid[1][1], 0, 100 ), -1 );
+
+	/* Too far for max_depth */
+	TEST_ASSERT_EQ( path_find( grid[0][2], grid[2][0], PATH_STAY_AREA, 3, dirs, 16 ), -1 );
+
+	/* The bridge is one way: nothing leads back into it from the grid but up */
+	TEST_ASSERT_EQ( path_find( grid[2][2], bridge, 0, 100, dirs, 16 ), 5 );
+	TEST_ASSERT_EQ( dirs[4], DIR_UP );
+
+	path_world_free();
+}
+
+void test_path_closed_door( void ) {
+	int dirs[16];
+
+	ensure_booted();
+	path_world_make();
+
+	SET_BIT( grid[0][1]->exit[DIR_EAST]->exit_info, EX_ISDOOR | EX_CLOSED );
+	TEST_ASSERT_EQ( path_find( grid[0][1], grid[2][1], 0, 100, dirs, 16 ), 2 );
+	TEST_ASSERT_EQ( path_find( grid[0][1], grid[2][1], PATH_OPEN_ONLY, 100, dirs, 16 ), 4 );
+	TEST_ASSERT( dirs[0] != DIR_EAST );
+
+	/* The table's hint goes through the door; the walk rejects it */
+	TEST_ASSERT( path_next_dir( grid[0][1], grid[2][1], PATH_OPEN_ONLY, 100 ) != DIR_EAST );
+	TEST_ASSERT_EQ( path_next_dir( grid[0][1], grid[2][1], 0, 100 ), DIR_EAST );
+
+	/* NO_MOB rooms block like walls, but a mob may start in one */
+	SET_BIT( grid[1][1]->room_flags, ROOM_NO_MOB );
+	TEST_ASSERT_EQ( path_find( grid[0][1], grid[2][1], PATH_NO_MOB, 100, dirs, 16 ), 4 );
+	TEST_ASSERT_EQ( path_find( grid[1][1], grid[2][1], PATH_NO_MOB, 100, dirs, 16 ), 1 );
+	TEST_ASSERT_EQ( path_find( grid[0][1], grid[1][1], PATH_NO_MOB, 100, dirs, 16 ), -1 );
+
+	path_world_free();
+}
+
+void test_path_stay_area( void ) {
+	int dirs[16];
+
+	ensure_booted();
+	path_world_make();
+
+	/* Up and over the bridge is shorter than crossing the grid */
+	TEST_ASSERT_EQ( path_find( grid[0][0], grid[2][2], 0, 100, dirs, 16 ), 2 );
+	TEST_ASSERT_EQ( dirs[0], DIR_UP );
+	TEST_ASSERT_EQ( path_find( grid[0][0], grid[2][2], PATH_STAY_AREA, 100, dirs, 16 ), 4 );
+	TEST_ASSERT( dirs[0] == DIR_NORTH || dirs[0] == DIR_EAST );
+	TEST_ASSERT_EQ( path_find( grid[0][0], bridge, PATH_STAY_AREA, 100, dirs, 16 ), -1 );
+
+	path_world_free();
+}
+
+void test_path_hint_matches_search( void ) {
+	PATH_STATS before, after;
+	ROOM_INDEX_DATA *from, *to, *next;
+	int dirs[16];
+	int i, j, dir, len;
+
+	ensure_booted();
+	path_world_make();
+	path_get_stats( &before );
+
+	/* Every step the hint takes is a step along some shortest route */
+	for ( i = 0; i < GRID * GRID; i++ ) {
+		for ( j = 0; j < GRID * GRID; j++ ) {
+			if ( i == j )
+				continue;
+			from = grid[i % GRID][i / GRID];
+			to = grid[j % GRID][j / GRID];
+			len = path_find( from, to, PATH_STAY_AREA, 100, dirs, 16 );
+			dir = path_next_dir( from, to, PATH_STAY_AREA, 100 );
+			TEST_ASSERT( dir >= 0 );
+			if ( dir < 0 )
+				continue;
+			next = from->exit[dir]->to_room;
+			TEST_ASSERT_EQ( path_find( next, to, PATH_STAY_AREA, 100, dirs, 16 ), len - 1 );
+		}
+	}
+
+	path_get_stats( &after );
+	TEST_ASSERT( after.hint_hits - before.hint_hits >= GRID * GRID * ( GRID * GRID - 1 ) );
+
+	path_world_free();
+}
+
+void test_path_cache_hit( void ) {
+	PATH_STATS before, after;
+	int dir;
+
+	ensure_booted();
+	path_world_make();
+
+	/* Across areas there is no table, so the second query is the cache's */
+	dir = path_next_dir( grid[2][2], bridge, PATH_OPEN_ONLY, 100 );
+	TEST_ASSERT( dir >= 0 );
+	path_get_stats( &before );
+	TEST_ASSERT_EQ( path_next_dir( grid[2][2], bridge, PATH_OPEN_ONLY, 100 ), dir );
+	path_get_stats( &after );
+	TEST_ASSERT_EQ( (int) ( after.cache_hits - before.cache_hits ), 1 );
+	TEST_ASSERT_EQ( (int) ( after.searches - before.searches ), 0 );
+
+	/* A door closing on the cached route sends the next query back to search */
+	SET_BIT( grid[0][0]->exit[DIR_UP]->exit_info, EX_ISDOOR | EX_CLOSED );
+	path_get_stats( &before );
+	TEST_ASSERT_EQ( path_next_dir( grid[2][2], bridge, PATH_OPEN_ONLY, 100 ), -1 );
+	path_get_stats( &after );
+	TEST_ASSERT_EQ( (int) ( after.cache_hits - before.cache_hits ), 0 );
+	TEST_ASSERT_EQ( (int) ( after.searches - before.searches ), 1 );
+
+	path_world_free();
+}
+
+void test_path_invalidate_after_edit( void ) {
+	PATH_STATS before, after;
+	int dirs[16];
+
+	ensure_booted();
+	path_world_make();
+	TEST_ASSERT_EQ( path_find( grid[0][0], grid[2][0], PATH_STAY_AREA, 100, dirs, 16 ), 2 );
+	TEST_ASSERT( path_next_dir( grid[0][0], grid[2][0], PATH_STAY_AREA, 100 ) >= 0 );
+
+	/* Cut the south row in the middle, as redit would */
+	free_exit( grid[1][0]->exit[DIR_EAST] );
+	grid[1][0]->exit[DIR_EAST] = NULL;
+	free_exit( grid[2][0]->exit[DIR_WEST] );
+	grid[2][0]->exit[DIR_WEST] = NULL;
+	path_invalidate();
+
+	path_get_stats( &before );
+	TEST_ASSERT_EQ( path_find( grid[0][0], grid[2][0], PATH_STAY_AREA, 100, dirs, 16 ), 4 );
+	TEST_ASSERT( path_follow( grid[0][0], dirs, 4 ) == grid[2][0] );
+	TEST_ASSERT( path_next_dir( grid[0][0], grid[2][0], PATH_STAY_AREA, 100 ) >= 0 );
+	path_get_stats( &after );
+	TEST_ASSERT_EQ( (int) ( after.tables_built - before.tables_built ), 1 );
+
+	/* A new room dug off the grid is found without another invalidate */
+	{
+		ROOM_INDEX_DATA *extra = path_room( &path_area_a, grid[2][0]->vnum + 200 );
+
+		path_exit( grid[2][0], DIR_EAST, extra );
+		TEST_ASSERT_EQ( path_find( grid[0][0], extra, PATH_STAY_AREA, 100, dirs, 16 ), 5 );
+		free_exit( grid[2][0]->exit[DIR_EAST] );
+		grid[2][0]->exit[DIR_EAST] = NULL;
+		path_unlink( extra );
+	}
+
+	path_world_free();
+}
+
+void test_path_mob_walks_home( void ) {
+	CHAR_DATA *mob;
+
+	ensure_booted();
+	path_world_make();
+
+	mob = make_full_test_npc();
+	SET_BIT( mob->act, ACT_STAY_AREA );
+	mob->home = grid[0][0]->vnum;
+	mob->move = mob->max_move = 1000;
+	char_to_room( mob, bridge );
+
+	TEST_ASSERT( mob_path_step( mob ) );
+	TEST_ASSERT( mob->in_room == grid[2][2] );
+
+	/* Back in its own area it wanders like any other */
+	TEST_ASSERT( !mob_path_step( mob ) );
+	TEST_ASSERT( mob->in_room == grid[2][2] );
+
+	char_from_room( mob );
+	free_char( mob );
+	path_world_free();
+}
+
+void test_path_script_api( void ) {
+	SCRIPT_DATA *script;
+	CHAR_DATA *mob, *ch;
+
+	ensure_booted();
+	path_world_make();
+
+	mob = make_full_test_npc();
+	ch = make_full_test_npc();
+	mob->move = mob->max_move = 1000;
+	char_to_room( mob, grid[0][2] );
+	char_to_room( ch, grid[2][0] );
+
+	script = calloc( 1, sizeof( *script ) );
+	script->name = str_dup( "path_test" );
+	script->trigger = TRIG_GREET;
+	script->code = str_dup(
+		"function on_greet(mob, ch)\n"
+		"  local route = mob:room():path_to(ch:room(), true)\n"
+		"  if route ~= nil and #route == 4 and mob:room():path_to(mob:room()) ~= nil then\n"
+		"    mob:step_toward(ch:room())\n"
+		"  end\n"
+		"end\n" );
+	script->lua_ref = SCRIPT_LUA_NOREF;
+	list_node_init( &script->node );
+
+	script_run( script, "on_greet", mob, ch, NULL );
+	TEST_ASSERT( mob->in_room == grid[1][2] || mob->in_room == grid[0][1] );
+
+	script_invalidate_cache( script );
+	free( script->name );
+	free( script->code );
+	free( script );
+	char_from_room( mob );
+	char_from_room( ch );
+	free_char( mob );
+	free_char( ch );
+	path_world_free();
+}
+
+/* Plain breadth-first search, the baseline the benchmark compares against */
+static int plain_bfs( ROOM_INDEX_DATA **rooms, int n, ROOM_INDEX_DATA *from, ROOM_INDEX_DATA *to,
+	int *dist, int *queue, int max_depth ) {
+	int head = 0, tail = 0, i, door;
+
+	for ( i = 0; i < n; i++ )
+		dist[i] = -1;
+	dist[from->path_id] = 0;
+	queue[tail++] = from->path_id;
+	while ( head < tail ) {
+		ROOM_INDEX_DATA *room = rooms[queue[head++]];
+
+		if ( room == to )
+			return dist[room->path_id];
+		if ( dist[room->path_id] >= max_depth )
+			continue;
+		for ( door = 0; door < 6; door++ ) {
+			EXIT_DATA *pexit = room->exit[door];
+
+			if ( pexit == NULL || pexit->to_room == NULL || dist[pexit->to_room->path_id] >= 0 )
+				continue;
+			dist[pexit->to_room->path_id] = dist[room->path_id] + 1;
+			queue[tail++] = pexit->to_room->path_id;
+		}
+	}
+	return -1;
+}
+
+void test_path_bench( void ) {
+	ROOM_INDEX_DATA **rooms, *room;
+	PATH_STATS before, after;
+	int64_t start, t_path, t_again, t_plain;
+	int *dist, *queue, *from, *to;
+	int dirs[128];
+	int n = 0, hash, i, pairs = 20000, checked = 0, found = 0;
+	unsigned int seed = 12345;
+
+	ensure_booted();
+	path_invalidate();
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ )
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next )
+			n++;
+	rooms = malloc( n * sizeof( *rooms ) );
+	dist = malloc( n * sizeof( *dist ) );
+	queue = malloc( n * sizeof( *queue ) );
+	from = malloc( pairs * sizeof( *from ) );
+	to = malloc( pairs * sizeof( *to ) );
+
+	/* Any query numbers every room (path_id), which plain_bfs borrows */
+	i = 0;
+	for ( hash = 0; hash < MAX_KEY_HASH; hash++ )
+		for ( room = room_index_hash[hash]; room != NULL; room = room->next )
+			rooms[i++] = room;
+	path_next_dir( rooms[0], rooms[n - 1], 0, 1 );
+	{
+		ROOM_INDEX_DATA **by_id = malloc( n * sizeof( *by_id ) );
+
+		for ( i = 0; i < n; i++ )
+			by_id[rooms[i]->path_id] = rooms[i];
+		free( rooms );
+		rooms = by_id;
+	}
+
+	/* Half the pairs share an area, like hunters and homing mobs mostly do */
+	for ( i = 0; i < pairs; i++ ) {
+		seed = seed * 1103515245u + 12345u;
+		from[i] = (int) ( ( seed >> 8 ) % (unsigned int) n );
+		seed = seed * 1103515245u + 12345u;
+		to[i] = (int) ( ( seed >> 8 ) % (unsigned int) n );
+		if ( i % 2 == 0 ) {
+			int lo = from[i], hi = from[i];
+
+			while ( lo > 0 && rooms[lo - 1]->area == rooms[from[i]]->area )
+				lo--;
+			while ( hi + 1 < n && rooms[hi + 1]->area == rooms[from[i]]->area )
+				hi++;
+			to[i] = lo + (int) ( ( seed >> 8 ) % (unsigned int) ( hi - lo + 1 ) );
+		}
+	}
+
+	/* The search is exact: same length as a plain BFS */
+	for ( i = 0; i < 500; i++ ) {
+		int expect = plain_bfs( rooms, n, rooms[from[i]], rooms[to[i]], dist, queue, 100 );
+
+		TEST_ASSERT_EQ( path_find( rooms[from[i]], rooms[to[i]], 0, 100, dirs, 128 ), expect );
+		checked++;
+	}
+
+	path_get_stats( &before );
+	start = profile_now_ns();
+	for ( i = 0; i < pairs; i++ )
+		if ( path_next_dir( rooms[from[i]], rooms[to[i]], 0, 100 ) >= 0 )
+			found++;
+	t_path = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( i = 0; i < pairs; i++ )
+		path_next_dir( rooms[from[i]], rooms[to[i]], 0, 100 );
+	t_again = profile_now_ns() - start;
+	path_get_stats( &after );
+
+	start = profile_now_ns();
+	for ( i = 0; i < pairs; i++ )
+		plain_bfs( rooms, n, rooms[from[i]], rooms[to[i]], dist, queue, 100 );
+	t_plain = profile_now_ns() - start;
+
+	TEST_ASSERT_EQ( checked, 500 );
+	TEST_ASSERT( found > 0 );
+	printf( "    [bench] %d route queries over %d rooms (%d routable): %lld us first pass, "
+		"%lld us repeated, %lld us plain BFS\n",
+		pairs, n, found, (long long) ( t_path / 1000 ), (long long) ( t_again / 1000 ),
+		(long long) ( t_plain / 1000 ) );
+	printf( "    [bench] pathfind: %ld hint hits, %ld cache hits, %ld searches, "
+		"%ld area tables (%ld KB)\n",
+		after.hint_hits - before.hint_hits, after.cache_hits - before.cache_hits,
+		after.searches - before.searches, after.tables_built, after.table_bytes / 1024 );
+
+	free( rooms );
+	free( dist );
+	free( queue );
+	free( from );
+	free( to );
+}
+
+void suite_pathfind( void ) {
+	RUN_TEST( test_path_grid_shortest );
+	RUN_TEST( test_path_closed_door );
+	RUN_TEST( test_path_stay_area );
+	RUN_TEST( test_path_hint_matches_search );
+	RUN_TEST( test_path_cache_hit );
+	RUN_TEST( test_path_invalidate_after_edit );
+	RUN_TEST( test_path_mob_walks_home );
+	RUN_TEST( test_path_script_api );
+	RUN_TEST( test_path_bench );
+}
@@ -0,0 +1,243 @@
+/*
+ * Unit tests for the profiler (game/src/systems/profile.c)
+ *
+ * Tests:
+ * - Histogram buckets stay within ~3% of the recorded value
+ * - Percentiles over known distributions
+ * - Nested markers: self time and parent/child attribution
+ * - Unbalanced START/END pairs are dropped, not misattributed
+ * - Prometheus and JSON snapshot output
+ * - Sampling profiler folded-stack output with command and marker tags
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "../systems/profile.h"
+
+/* Busy-wait so nested markers have measurable, ordered durations */
+static void spin_us( long us ) {
+	int64_t until = profile_now_ns() + (int64_t) us * 1000;
+	while ( profile_now_ns() < until )
+		;
+}
+
+static void profile_fresh( void ) {
+	profile_init();
+	profile_set_enabled( TRUE );
+}
+
+static void test_profile_hist_precision( void ) {
+	static PROFILE_HIST hist;
+	long values[] = { 0, 1, 31, 32, 33, 63, 64, 100, 1000, 12345, 250000, 5000000 };
+	long got;
+	int i;
+
+	for ( i = 0; i < (int) ( sizeof( values ) / sizeof( values[0] ) ); i++ ) {
+		memset( &hist, 0, sizeof( hist ) );
+		profile_hist_record( &hist, values[i] );
+		got = profile_hist_percentile( &hist, 100.0 );
+		/* Never above the max; never more than one bucket width below */
+		TEST_ASSERT( got <= values[i] );
+		TEST_ASSERT( got >= values[i] - values[i] / 32 - 1 );
+	}
+
+	/* Beyond the top bucket clamps instead of overflowing */
+	memset( &hist, 0, sizeof( hist ) );
+	profile_hist_record( &hist, LONG_MAX / 2 );
+	TEST_ASSERT_EQ( hist.counts[PROFILE_HIST_BUCKETS - 1], 1 );
+}
+
+static void test_profile_hist_percentiles( void ) {
+	static PROFILE_HIST hist;
+	long p50, p99;
+	int i;
+
+	memset( &hist, 0, sizeof( hist ) );
+	TEST_ASSERT_EQ( profile_hist_percentile( &hist, 99.0 ), 0 );
+
+	/* 1..1000us, uniform */
+	for ( i = 1; i <= 1000; i++ )
+		profile_hist_record( &hist, i );
+	p50 = profile_hist_percentile( &hist, 50.0 );
+	p99 = profile_hist_percentile( &hist, 99.0 );
+	TEST_ASSERT_RANGE( p50, 485, 515 );
+	TEST_ASSERT_RANGE( p99, 960, 1000 );
+	TEST_ASSERT_EQ( profile_hist_percentile( &hist, 100.0 ), 1000 );
+
+	/* One slow outlier in a thousand moves p99.9 but not p99 */
+	memset( &hist, 0, sizeof( hist ) );
+	for ( i = 0; i < 999; i++ )
+		profile_hist_record( &hist, 200 );
+	profile_hist_record( &hist, 300000 );
+	TEST_ASSERT_RANGE( profile_hist_percentile( &hist, 99.0 ), 200, 206 );
+	TEST_ASSERT( profile_hist_percentile( &hist, 100.0 ) > 290000 );
+}
+
+static void test_profile_nesting_attribution( void ) {
+	PROFILE_MARKER *outer, *inner;
+
+	profile_fresh();
+
+	PROFILE_START( PROF_MOBILE_UPDATE );
+	spin_us( 500 );
+	PROFILE_START( PROF_MOB_NPC_AI );
+	spin_us( 2000 );
+	PROFILE_END( PROF_MOB_NPC_AI );
+	PROFILE_END( PROF_MOBILE_UPDATE );
+
+	outer = &profile_stats.markers[PROF_MOBILE_UPDATE];
+	inner = &profile_stats.markers[PROF_MOB_NPC_AI];
+
+	TEST_ASSERT_EQ( outer->call_count, 1 );
+	TEST_ASSERT_EQ( inner->call_count, 1 );
+	TEST_ASSERT_EQ( profile_stats.depth, 0 );
+
+	/* Outer total includes the inner call; its self time does not */
+	TEST_ASSERT( outer->total_ns >= inner->total_ns + 500000 );
+	TEST_ASSERT( outer->self_ns < inner->total_ns );
+	TEST_ASSERT( inner->self_ns == inner->total_ns );
+
+	TEST_ASSERT( profile_stats.parent_ns[PROF_MOBILE_UPDATE][PROF_MOB_NPC_AI] == inner->total_ns );
+	TEST_ASSERT( profile_stats.parent_ns[PROFILE_MAX_MARKERS][PROF_MOBILE_UPDATE] == outer->total_ns );
+	TEST_ASSERT( profile_stats.parent_ns[PROFILE_MAX_MARKERS][PROF_MOB_NPC_AI] == 0 );
+
+	profile_init();
+}
+
+static void test_profile_unbalanced_markers( void ) {
+	profile_fresh();
+
+	/* END with no START is ignored */
+	PROFILE_END( PROF_SAVE_PLAYER_ROW );
+	TEST_ASSERT_EQ( profile_stats.markers[PROF_SAVE_PLAYER_ROW].call_count, 0 );
+	TEST_ASSERT_EQ( profile_stats.unbalanced, 1 );
+
+	/* An inner START left open is dropped when the outer END arrives */
+	PROFILE_START( PROF_DB_PLAYER_SAVE );
+	PROFILE_START( PROF_SAVE_SKILLS );
+	PROFILE_END( PROF_DB_PLAYER_SAVE );
+	TEST_ASSERT_EQ( profile_stats.depth, 0 );
+	TEST_ASSERT_EQ( profile_stats.unbalanced, 2 );
+	TEST_ASSERT_EQ( profile_stats.markers[PROF_DB_PLAYER_SAVE].call_count, 1 );
+	TEST_ASSERT_EQ( profile_stats.markers[PROF_SAVE_SKILLS].call_count, 0 );
+
+	/* Disabled profiling records nothing */
+	profile_set_enabled( FALSE );
+	PROFILE_START( PROF_OBJ_UPDATE );
+	PROFILE_END( PROF_OBJ_UPDATE );
+	TEST_ASSERT_EQ( profile_stats.markers[PROF_OBJ_UPDATE].call_count, 0 );
+
+	profile_init();
+}
+
+static void test_profile_snapshot_formats( void ) {
+	char buf[16384];
+	size_t n;
+	FILE *fp;
+	int i;
+
+	profile_fresh();
+	profile_stats.export_enabled = FALSE;
+	for ( i = 0; i < 10; i++ ) {
+		profile_tick_start();
+		PROFILE_START( PROF_CHAR_UPDATE );
+		PROFILE_END( PROF_CHAR_UPDATE );
+		profile_tick_end();
+	}
+
+	fp = tmpfile();
+	TEST_ASSERT( fp != NULL );
+	if ( fp == NULL )
+		return;
+	TEST_ASSERT_TRUE( profile_write_prometheus( fp ) );
+	rewind( fp );
+	n = fread( buf, 1, sizeof( buf ) - 1, fp );
+	buf[n] = '\0';
+	fclose( fp );
+
+	TEST_ASSERT( strstr( buf, "# TYPE dystopia_tick_seconds summary" ) != NULL );
+	TEST_ASSERT( strstr( buf, "dystopia_tick_seconds{quantile=\"0.99\"}" ) != NULL );
+	TEST_ASSERT( strstr( buf, "dystopia_tick_seconds_count 10" ) != NULL );
+	TEST_ASSERT( strstr( buf, "dystopia_marker_seconds_count{marker=\"char_update\"} 10" ) != NULL );
+	/* Markers that never ran are omitted */
+	TEST_ASSERT( strstr( buf, "marker=\"obj_update\"" ) == NULL );
+
+	fp = tmpfile();
+	TEST_ASSERT( fp != NULL );
+	if ( fp == NULL )
+		return;
+	TEST_ASSERT_TRUE( profile_write_json( fp ) );
+	rewind( fp );
+	n = fread( buf, 1, sizeof( buf ) - 1, fp );
+	buf[n] = '\0';
+	fclose( fp );
+
+	TEST_ASSERT( strstr( buf, "\"tick\": {\"count\": 10," ) != NULL );
+	TEST_ASSERT( strstr( buf, "\"p99_us\"" ) != NULL );
+	TEST_ASSERT( strstr( buf, "{\"name\": \"char_update\", \"calls\": 10," ) != NULL );
+	TEST_ASSERT( buf[n - 2] == '}' );
+
+	profile_init();
+}
+
+static void test_profile_sample_folded( void ) {
+	char buf[65536];
+	char tag[128];
+	char *line, *sp;
+	bool tagged = FALSE, well_formed = TRUE;
+	size_t n;
+	FILE *fp;
+
+	profile_init();
+	if ( !profile_sample_start( 5, "" ) ) {
+		/* Not supported on this platform */
+		TEST_ASSERT_FALSE( profile_sample_active() );
+		return;
+	}
+	TEST_ASSERT_TRUE( profile_sample_active() );
+	TEST_ASSERT_FALSE( profile_sample_start( 5, "" ) );   /* One window at a time */
+
+	/* ~300ms of CPU inside a command and a marker */
+	profile_current_cmd = 0;
+	PROFILE_START( PROF_CHAR_UPDATE );
+	spin_us( 300000 );
+	PROFILE_END( PROF_CHAR_UPDATE );
+	profile_current_cmd = -1;
+
+	TEST_ASSERT( profile_sample_count() > 10 );
+
+	fp = tmpfile();
+	TEST_ASSERT( fp != NULL );
+	if ( fp != NULL ) {
+		TEST_ASSERT( profile_sample_write( fp ) > 10 );
+		rewind( fp );
+		n = fread( buf, 1, sizeof( buf ) - 1, fp );
+		buf[n] = '\0';
+		fclose( fp );
+
+		snprintf( tag, sizeof( tag ), "[cmd %s];[char_update];", cmd_table[0].name );
+		for ( line = strtok( buf, "\n" ); line != NULL; line = strtok( NULL, "\n" ) ) {
+			if ( !strncmp( line, tag, strlen( tag ) ) )
+				tagged = TRUE;
+			/* "frame;frame;... count" */
+			sp = strrchr( line, ' ' );
+			if ( sp == NULL || atoi( sp + 1 ) < 1 )
+				well_formed = FALSE;
+		}
+		TEST_ASSERT_TRUE( tagged );
+		TEST_ASSERT_TRUE( well_formed );
+	}
+
+	TEST_ASSERT( profile_sample_stop( NULL, 0 ) > 10 );
+	TEST_ASSERT_FALSE( profile_sample_active() );
+	TEST_ASSERT_FALSE( profile_stats.enabled );   /* Restored */
+}
+
+void suite_profile( void ) {
+	RUN_TEST( test_profile_hist_precision );
+	RUN_TEST( test_profile_hist_percentiles );
+	RUN_TEST( test_profile_nesting_attribution );
+	RUN_TEST( test_profile_unbalanced_markers );
+	RUN_TEST( test_profile_snapshot_formats );
+	RUN_TEST( test_profile_sample_folded );
+}
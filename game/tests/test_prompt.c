@@ -0,0 +1,594 @@
+/*
+ * Prompt tests (game/src/core/prompt.c)
+ *
+ * Tests: the compiled bust_a_prompt() against the character-by-character
+ * version it replaced, byte for byte after colour translation, and when
+ * the per-descriptor cache replays or rebuilds.  The benchmark flushes
+ * the combat prompt of 500 fighting players both ways.  Requires
+ * boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "class_ops.h"
+#include "prompt.h"
+#include "../systems/profile.h"
+
+#define BENCH_DESCS	  500
+#define BENCH_FLUSHES 40
+
+/* bust_a_prompt() as it was before prompts were compiled */
+static void legacy_bust_a_prompt( DESCRIPTOR_DATA *d ) {
+	CHAR_DATA *ch;
+	CHAR_DATA *victim;
+	CHAR_DATA *tank;
+	const char *str;
+	const char *i;
+	char *point;
+	char buf[MAX_STRING_LENGTH];
+	char buf2[MAX_STRING_LENGTH];
+	bool is_fighting = TRUE;
+
+	if ( ( ch = d->character ) == NULL ) return;
+	if ( ch->pcdata == NULL ) {
+		send_to_char( "\n\r\n\r", ch );
+		return;
+	}
+	if ( ch->position == POS_FIGHTING && ch->pcdata->cprompt[0] == '\0' ) {
+		if ( ch->pcdata->prompt[0] == '\0' ) {
+			send_to_char( "\n\r\n\r", ch );
+			return;
+		}
+		is_fighting = FALSE;
+	} else if ( ch->position != POS_FIGHTING && ch->pcdata->prompt[0] == '\0' ) {
+		send_to_char( "\n\r\n\r", ch );
+		return;
+	}
+
+	point = buf;
+	if ( ch->position == POS_FIGHTING && is_fighting )
+		str = d->original ? d->original->pcdata->cprompt : d->character->pcdata->cprompt;
+	else
+		str = d->original ? d->original->pcdata->prompt : d->character->pcdata->prompt;
+	while ( *str != '\0' ) {
+		if ( point >= buf + sizeof( buf ) - 10 )
+			break;
+		if ( *str != '%' ) {
+			*point++ = *str++;
+			continue;
+		}
+		++str;
+		switch ( *str ) {
+		default:
+			i = " ";
+			break;
+		case 'h':
+			snprintf( buf2, sizeof(buf2), "%s%d#n", col_scale_code(ch->hit, ch->max_hit), ch->hit );
+			i = buf2;
+			break;
+		case 'H':
+			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->max_hit );
+			i = buf2;
+			break;
+		case 'm':
+			snprintf( buf2, sizeof(buf2), "%s%d#n", col_scale_code(ch->mana, ch->max_mana), ch->mana );
+			i = buf2;
+			break;
+		case 'M':
+			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->max_mana );
+			i = buf2;
+			break;
+		case 'v':
+			snprintf( buf2, sizeof(buf2), "%s%d#n", col_scale_code(ch->move, ch->max_move), ch->move );
+			i = buf2;
+			break;
+		case 'V':
+			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->max_move );
+			i = buf2;
+			break;
+		case 'x': {
+			char xp_tmp[32];
+			add_commas_to_number( ch->exp, xp_tmp, sizeof( xp_tmp ) );
+			snprintf( buf2, sizeof( buf2 ), "%s%s#n", col_scale_code( ch->exp, 10000000 ), xp_tmp );
+			i = buf2;
+			break;
+		}
+		case 'g':
+			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->gold );
+			i = buf2;
+			break;
+		case 'q':
+			snprintf( buf2, sizeof(buf2), "#C%d#n", ch->pcdata->quest );
+			i = buf2;
+			break;
+		case 'f':
+			if ( ( victim = ch->fighting ) == NULL ) {
+				snprintf( buf2, sizeof( buf2 ), "#CN/A#n" );
+			} else {
+				if ( ( victim->hit * 100 / victim->max_hit ) < 25 ) {
+					snprintf( buf2, sizeof( buf2 ), "#RAwful#n" );
+				} else if ( ( victim->hit * 100 / victim->max_hit ) < 50 ) {
+					snprintf( buf2, sizeof( buf2 ), "#LPoor#n" );
+				} else if ( ( victim->hit * 100 / victim->max_hit ) < 75 ) {
+					snprintf( buf2, sizeof( buf2 ), "#GFair#n" );
+				} else if ( ( victim->hit * 100 / victim->max_hit ) < 100 ) {
+					snprintf( buf2, sizeof( buf2 ), "#yGood#n" );
+				} else {
+					snprintf( buf2, sizeof( buf2 ), "#CPerfect#n" );
+				}
+			}
+			i = buf2;
+			break;
+		case 'F':
+			if ( ( victim = ch->fighting ) == NULL ) {
+				snprintf( buf2, sizeof( buf2 ), "#CN/A#n" );
+			} else if ( ( tank = victim->fighting ) == NULL ) {
+				snprintf( buf2, sizeof( buf2 ), "#CN/A#n" );
+			} else {
+				if ( ( tank->hit * 100 / tank->max_hit ) < 25 ) {
+					snprintf( buf2, sizeof( buf2 ), "#RAwful#n" );
+				} else if ( ( tank->hit * 100 / tank->max_hit ) < 50 ) {
+					snprintf( buf2, sizeof( buf2 ), "#LPoor#n" );
+				} else if ( ( tank->hit * 100 / tank->max_hit ) < 75 ) {
+					snprintf( buf2, sizeof( buf2 ), "#GFair#n" );
+				} else if ( ( tank->hit * 100 / tank->max_hit ) < 100 ) {
+					snprintf( buf2, sizeof( buf2 ), "#yGood#n" );
+				} else {
+					snprintf( buf2, sizeof( buf2 ), "#CPerfect#n" );
+				}
+			}
+			i = buf2;
+			break;
+		case 'n':
+			if ( ( victim = ch->fighting ) == NULL )
+				snprintf( buf2, sizeof( buf2 ), "N/A" );
+			else {
+				if ( IS_AFFECTED( victim, AFF_POLYMORPH ) )
+					snprintf( buf2, sizeof( buf2 ), "%s", victim->morph );
+				else if ( IS_NPC( victim ) )
+					snprintf( buf2, sizeof( buf2 ), "%s", victim->short_descr );
+				else
+					snprintf( buf2, sizeof( buf2 ), "%s", victim->name );
+				buf2[0] = toupper( buf2[0] );
+			}
+			i = buf2;
+			break;
+		case 'N':
+			if ( ( victim = ch->fighting ) == NULL )
+				snprintf( buf2, sizeof( buf2 ), "N/A" );
+			else if ( ( tank = victim->fighting ) == NULL )
+				snprintf( buf2, sizeof( buf2 ), "N/A" );
+			else {
+				if ( ch == tank )
+					snprintf( buf2, sizeof( buf2 ), "You" );
+				else if ( IS_AFFECTED( tank, AFF_POLYMORPH ) )
+					snprintf( buf2, sizeof( buf2 ), "%s", tank->morph );
+				else if ( IS_NPC( victim ) )
+					snprintf( buf2, sizeof( buf2 ), "%s", tank->short_descr );
+				else
+					snprintf( buf2, sizeof( buf2 ), "%s", tank->name );
+				buf2[0] = toupper( buf2[0] );
+			}
+			i = buf2;
+			break;
+		case 'a':
+			snprintf( buf2, sizeof( buf2 ), "#C%s#n", IS_GOOD( ch ) ? "good" : IS_EVIL( ch ) ? "evil"
+																							   : "neutral" );
+			i = buf2;
+			break;
+		case 'A':
+			snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->alignment );
+			i = buf2;
+			break;
+		case 't':
+			snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->fight_timer );
+			i = buf2;
+			break;
+		case 'r':
+			if ( ch->in_room )
+				snprintf( buf2, sizeof( buf2 ), "#C%s#n", ch->in_room->name );
+			else
+				snprintf( buf2, sizeof( buf2 ), " " );
+			i = buf2;
+			break;
+		case 'k':
+		case 'E':
+			/* Class prompt codes: see class_ops.c */
+			if ( !class_prompt( ch, *str, buf2, sizeof( buf2 ) ) )
+				snprintf( buf2, sizeof( buf2 ), " " );
+			i = buf2;
+			break;
+		case 'R':
+		case 'G':
+		case 'i':
+		case 'I':
+		case 'd':
+		case 'D':
+		case 'B':
+			if ( !class_prompt( ch, *str, buf2, sizeof( buf2 ) ) )
+				snprintf( buf2, sizeof( buf2 ), "0" );
+			i = buf2;
+			break;
+		case 'b':
+			snprintf( buf2, sizeof( buf2 ), "#C%d#n", ch->beast );
+			i = buf2;
+			break;
+		case 'c':
+			snprintf( buf2, sizeof( buf2 ), "%d", char_ac( ch ) );
+			i = buf2;
+			break;
+		case 'p':
+			snprintf( buf2, sizeof( buf2 ), "%s%d#n", col_scale_code( char_hitroll( ch ), 200 ), char_hitroll( ch ) );
+			i = buf2;
+			break;
+		case 'P':
+			snprintf( buf2, sizeof( buf2 ), "%s%d#n", col_scale_code( char_damroll( ch ), 200 ), char_damroll( ch ) );
+			i = buf2;
+			break;
+		case 's':
+			if ( !IS_NPC( ch ) && ch->pcdata->stage[2] + 25 >= ch->pcdata->stage[1] && ch->pcdata->stage[1] > 0 ) {
+				snprintf( buf2, sizeof( buf2 ), "#Cyes#n" );
+			} else
+				snprintf( buf2, sizeof( buf2 ), "no" );
+			i = buf2;
+			break;
+		case 'O':
+			if ( ( victim = ch->pcdata->partner ) == NULL )
+				snprintf( buf2, sizeof( buf2 ), "no" );
+			else if ( !IS_NPC( victim ) && victim != NULL && victim->pcdata->stage[1] > 0 && victim->pcdata->stage[2] + 25 >= victim->pcdata->stage[1] ) {
+				snprintf( buf2, sizeof( buf2 ), "#Cyes#n" );
+			} else
+				snprintf( buf2, sizeof( buf2 ), "no" );
+			i = buf2;
+			break;
+		case 'l':
+			if ( ( victim = ch->pcdata->partner ) == NULL )
+				snprintf( buf2, sizeof( buf2 ), "Nobody" );
+			else {
+				if ( IS_AFFECTED( victim, AFF_POLYMORPH ) )
+					snprintf( buf2, sizeof( buf2 ), "%s", victim->morph );
+				else if ( IS_NPC( victim ) )
+					snprintf( buf2, sizeof( buf2 ), "%s", victim->short_descr );
+				else
+					snprintf( buf2, sizeof( buf2 ), "%s", victim->name );
+				buf2[0] = toupper( buf2[0] );
+			}
+			i = buf2;
+			break;
+		case '%':
+			snprintf( buf2, sizeof( buf2 ), "%%" );
+			i = buf2;
+			break;
+		}
+		++str;
+		point = buf_append_safe( point, i, buf, sizeof( buf ), 10 );
+		if ( point == NULL ) {
+			point = buf + sizeof( buf ) - 10;
+			break;
+		}
+	}
+	*point = '\0';
+	write_to_buffer( d, buf, (int) ( point - buf ) );
+	return;
+}
+
+static const char *prompts[] = {
+	"<%h/%Hhp %m/%Mm %v/%Vmv> ",
+	"[%x xp] [%g gold] [%q qp] %a %A %t %b %c %p %P ",
+	"%f %F %n %N %r %s %O %l %% %z",
+	"#R%k %E %R %G %i %I %d %D %B#n ",
+	"#t00ff80%h#n #x123%m#n #TFF0000%v#b #Mhi#] #<#> ##s ",
+	"no codes at all",
+	"%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h%h",
+};
+
+static void prompt_desc( DESCRIPTOR_DATA *d, CHAR_DATA *ch ) {
+	memset( d, 0, sizeof( *d ) );
+	d->descriptor = -1;
+	d->connected = CON_PLAYING;
+	d->outsize = 2000;
+	d->outbuf = calloc( 1, d->outsize );
+	d->character = ch;
+	ch->desc = d;
+}
+
+static void free_prompt_desc( DESCRIPTOR_DATA *d ) {
+	prompt_cache_free( d );
+	free( d->outbuf );
+}
+
+static CHAR_DATA *prompt_player( const char *prompt, const char *cprompt ) {
+	CHAR_DATA *ch = make_test_player();
+
+	ch->level = 3;
+	ch->max_hit = ch->max_mana = ch->max_move = 5000;
+	ch->hit = 4000;
+	ch->mana = 1200;
+	ch->move = 5000;
+	ch->exp = 1234567;
+	ch->gold = 42;
+	ch->position = POS_STANDING;
+	SET_BIT( ch->act, PLR_ANSI );
+	ch->pcdata->prompt = str_dup( prompt );
+	ch->pcdata->cprompt = str_dup( cprompt );
+	prompt_recompile( ch );
+	return ch;
+}
+
+static void free_prompt_player( CHAR_DATA *ch ) {
+	free( ch->pcdata->prompt );
+	free( ch->pcdata->cprompt );
+	prompt_free( ch->pcdata->prompt_prog );
+	prompt_free( ch->pcdata->cprompt_prog );
+	free_test_char( ch );
+}
+
+static CHAR_DATA *prompt_foe( void ) {
+	CHAR_DATA *mob = make_test_npc();
+
+	mob->short_descr = "a training dummy";
+	mob->max_hit = 1000;
+	mob->hit = 1000;
+	mob->position = POS_FIGHTING;
+	return mob;
+}
+
+/* Flush the prompt both ways and compare what each queued */
+static void check_same_output( DESCRIPTOR_DATA *d ) {
+	char want[MAX_STRING_LENGTH * 4];
+	int want_len;
+
+	d->outtop = 0;
+	legacy_bust_a_prompt( d );
+	want_len = d->outtop;
+	TEST_ASSERT( want_len < (int) sizeof( want ) );
+	memcpy( want, d->outbuf, want_len );
+
+	d->outtop = 0;
+	bust_a_prompt( d );
+	TEST_ASSERT_EQ( d->outtop, want_len );
+	if ( d->outtop == want_len )
+		TEST_ASSERT( memcmp( d->outbuf, want, want_len ) == 0 );
+}
+
+void test_prompt_matches_legacy( void ) {
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch, *mob, *partner;
+	size_t i, j;
+
+	ensure_booted();
+	partner = prompt_player( "", "" );
+	partner->name = "partner";
+	partner->pcdata->stage[1] = 10;
+	mob = prompt_foe();
+
+	for ( i = 0; i < sizeof( prompts ) / sizeof( prompts[0] ); i++ ) {
+		for ( j = 0; j < sizeof( prompts ) / sizeof( prompts[0] ); j++ ) {
+			ch = prompt_player( prompts[i], prompts[j] );
+			prompt_desc( &desc, ch );
+			ch->in_room = get_room_index( ROOM_VNUM_LIMBO );
+
+			check_same_output( &desc );
+
+			/* Fighting: cprompt, with the foe's condition moving */
+			ch->position = POS_FIGHTING;
+			ch->fighting = mob;
+			mob->fighting = ch;
+			mob->hit = 1000;
+			check_same_output( &desc );
+			mob->hit = 600;
+			check_same_output( &desc );
+			mob->hit = 100;
+			check_same_output( &desc );
+			SET_BIT( mob->affected_by, AFF_POLYMORPH );
+			mob->morph = "a shape";
+			check_same_output( &desc );
+			REMOVE_BIT( mob->affected_by, AFF_POLYMORPH );
+			mob->fighting = NULL;
+			check_same_output( &desc );
+
+			/* Out of combat again, with a partner and changed stats */
+			ch->position = POS_STANDING;
+			ch->fighting = NULL;
+			ch->pcdata->partner = partner;
+			ch->hit = 0;
+			ch->alignment = -900;
+			ch->pcdata->stage[1] = 5;
+			check_same_output( &desc );
+			partner->pcdata->stage[2] = 20;
+			check_same_output( &desc );
+
+			/* Every colour depth */
+			REMOVE_BIT( ch->act, PLR_ANSI );
+			check_same_output( &desc );
+			SET_BIT( ch->act, PLR_ANSI );
+			SET_BIT( ch->act, PLR_XTERM );
+			check_same_output( &desc );
+			SET_BIT( ch->extra, EXTRA_TRUECOLOR );
+			check_same_output( &desc );
+			desc.mxp_enabled = TRUE;
+			check_same_output( &desc );
+			SET_BIT( ch->act, PLR_SCREENREADER );
+			check_same_output( &desc );
+
+			ch->in_room = NULL;
+			check_same_output( &desc );
+			free_prompt_desc( &desc );
+			free_prompt_player( ch );
+		}
+	}
+
+	/* Class codes for a hero of each class that has them */
+	ch = prompt_player( prompts[3], prompts[3] );
+	prompt_desc( &desc, ch );
+	ch->level = LEVEL_AVATAR;
+	for ( i = 0; i < 28; i++ ) {
+		ch->class = 1 << i;
+		ch->rage = (int) i * 7;
+		ch->beast = (int) i;
+		check_same_output( &desc );
+	}
+	free_prompt_desc( &desc );
+	free_prompt_player( ch );
+
+	free_test_char( mob );
+	free_prompt_player( partner );
+}
+
+void test_prompt_cache_replays( void ) {
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+	long hits, misses, hits0, misses0;
+
+	ensure_booted();
+	ch = prompt_player( prompts[0], "" );
+	prompt_desc( &desc, ch );
+
+	prompt_cache_get_stats( &hits0, &misses0 );
+	bust_a_prompt( &desc );
+	bust_a_prompt( &desc );
+	bust_a_prompt( &desc );
+	prompt_cache_get_stats( &hits, &misses );
+	TEST_ASSERT_EQ( (int) ( misses - misses0 ), 1 );
+	TEST_ASSERT_EQ( (int) ( hits - hits0 ), 2 );
+
+	/* A field the prompt shows */
+	ch->hit--;
+	check_same_output( &desc );
+	prompt_cache_get_stats( &hits0, &misses0 );
+	TEST_ASSERT_EQ( (int) ( misses0 - misses ), 1 );
+
+	/* A field it does not show */
+	ch->gold += 100;
+	bust_a_prompt( &desc );
+	prompt_cache_get_stats( &hits, &misses );
+	TEST_ASSERT_EQ( (int) ( misses - misses0 ), 0 );
+	TEST_ASSERT_EQ( (int) ( hits - hits0 ), 1 );
+
+	/* Colour settings */
+	SET_BIT( ch->extra, EXTRA_TRUECOLOR );
+	check_same_output( &desc );
+	prompt_cache_get_stats( &hits0, &misses0 );
+	TEST_ASSERT_EQ( (int) ( misses0 - misses ), 1 );
+
+	/* A new prompt with the same fields */
+	do_prompt( ch, "<%h/%Hhp %m/%Mm %v/%Vmv>!" );
+	desc.outtop = 0;
+	bust_a_prompt( &desc );
+	prompt_cache_get_stats( &hits, &misses );
+	TEST_ASSERT_EQ( (int) ( misses - misses0 ), 1 );
+	desc.outbuf[desc.outtop] = '\0';
+	TEST_ASSERT( strstr( desc.outbuf, "mv>!" ) != NULL );
+
+	free_prompt_desc( &desc );
+	free_prompt_player( ch );
+}
+
+/* The old loop read past the end of a prompt ending in %; it shows a blank */
+void test_prompt_trailing_percent( void ) {
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+
+	ensure_booted();
+	ch = prompt_player( "ok%", "" );
+	prompt_desc( &desc, ch );
+	desc.fcommand = TRUE;
+	bust_a_prompt( &desc );
+	TEST_ASSERT_EQ( desc.outtop, 3 );
+	TEST_ASSERT( memcmp( desc.outbuf, "ok ", 3 ) == 0 );
+
+	free_prompt_desc( &desc );
+	free_prompt_player( ch );
+}
+
+void test_prompt_random_colour_not_cached( void ) {
+	DESCRIPTOR_DATA desc;
+	CHAR_DATA *ch;
+	long hits, misses, hits0, misses0;
+
+	ensure_booted();
+	ch = prompt_player( "#s%h#n> ", "" );
+	prompt_desc( &desc, ch );
+
+	prompt_cache_get_stats( &hits0, &misses0 );
+	bust_a_prompt( &desc );
+	bust_a_prompt( &desc );
+	prompt_cache_get_stats( &hits, &misses );
+	TEST_ASSERT_EQ( (int) ( misses - misses0 ), 2 );
+	TEST_ASSERT_EQ( (int) ( hits - hits0 ), 0 );
+
+	free_prompt_desc( &desc );
+	free_prompt_player( ch );
+}
+
+/* Fields that move every round of combat: hp, the foe, the fight timer */
+void test_prompt_bench_combat( void ) {
+	static DESCRIPTOR_DATA descs[BENCH_DESCS];
+	CHAR_DATA *chars[BENCH_DESCS];
+	CHAR_DATA *mob;
+	int64_t start, legacy_ns, compiled_ns;
+	long hits, misses, hits0, misses0;
+	int i, flush;
+
+	ensure_booted();
+	mob = prompt_foe();
+	for ( i = 0; i < BENCH_DESCS; i++ ) {
+		chars[i] = prompt_player( prompts[0],
+			"#R[#n%h/%Hhp %m/%Mm %v/%Vmv#R]#n #C%n#n: %f  tank %N: %F  [%t] " );
+		prompt_desc( &descs[i], chars[i] );
+		chars[i]->position = POS_FIGHTING;
+		chars[i]->fighting = mob;
+		SET_BIT( chars[i]->act, PLR_XTERM );
+	}
+	mob->fighting = chars[0];
+
+	/* Each round: a tenth of the fighters take a hit, the foe always does */
+	seed_rng( 7 );
+	start = profile_now_ns();
+	for ( flush = 0; flush < BENCH_FLUSHES; flush++ ) {
+		mob->hit = 1000 - flush;
+		for ( i = 0; i < BENCH_DESCS; i++ ) {
+			if ( i % 10 == flush % 10 )
+				chars[i]->hit -= 3;
+			descs[i].outtop = 0;
+			legacy_bust_a_prompt( &descs[i] );
+		}
+	}
+	legacy_ns = profile_now_ns() - start;
+
+	for ( i = 0; i < BENCH_DESCS; i++ )
+		chars[i]->hit = 4000;
+	prompt_cache_get_stats( &hits0, &misses0 );
+	start = profile_now_ns();
+	for ( flush = 0; flush < BENCH_FLUSHES; flush++ ) {
+		mob->hit = 1000 - flush;
+		for ( i = 0; i < BENCH_DESCS; i++ ) {
+			if ( i % 10 == flush % 10 )
+				chars[i]->hit -= 3;
+			descs[i].outtop = 0;
+			bust_a_prompt( &descs[i] );
+		}
+	}
+	compiled_ns = profile_now_ns() - start;
+	prompt_cache_get_stats( &hits, &misses );
+	TEST_ASSERT( hits - hits0 > misses - misses0 );
+
+	printf( "    [bench] combat prompt, %d descriptors x %d flushes: legacy %lld us, compiled %lld us (%ld replayed, %ld built)\n",
+		BENCH_DESCS, BENCH_FLUSHES, (long long) ( legacy_ns / 1000 ), (long long) ( compiled_ns / 1000 ),
+		hits - hits0, misses - misses0 );
+
+	for ( i = 0; i < BENCH_DESCS; i++ ) {
+		free_prompt_desc( &descs[i] );
+		free_prompt_player( chars[i] );
+	}
+	free_test_char( mob );
+}
+
+void suite_prompt( void ) {
+	RUN_TEST( test_prompt_matches_legacy );
+	RUN_TEST( test_prompt_cache_replays );
+	RUN_TEST( test_prompt_trailing_percent );
+	RUN_TEST( test_prompt_random_colour_not_cached );
+	RUN_TEST( test_prompt_bench_combat );
+}
@@ -13,6 +13,7 @@
 #include "merc.h"
 #include "../db/db_quest.h"
 #include "../systems/quest_new.h"
+#include "../systems/profile.h"
 
 /*--------------------------------------------------------------------------
  * Tier 1: Quest Tracker (no boot required)
@@ -223,7 +224,7 @@ static void test_check_progress_use_command( void ) {
 		p->status = QSTATUS_ACTIVE;
 
 		/* Simulate using the "look" command */
-		quest_check_progress( ch, QOBJ_USE_COMMAND, "look", 1 );
+		quest_check_progress( ch, QOT_USE_COMMAND, "look", 1 );
 
 		/* Find the "look" objective and check progress */
 		int j;
@@ -252,7 +253,7 @@ static void test_check_progress_ignores_inactive( void ) {
 		/* Leave as LOCKED - should NOT track progress */
 		p->status = QSTATUS_LOCKED;
 
-		quest_check_progress( ch, QOBJ_USE_COMMAND, "look", 1 );
+		quest_check_progress( ch, QOT_USE_COMMAND, "look", 1 );
 
 		int j;
 		for ( j = 0; j < MAX_QUEST_OBJECTIVES; j++ ) {
@@ -268,7 +269,7 @@ static void test_check_progress_ignores_inactive( void ) {
 static void test_check_progress_npc_noop( void ) {
 	CHAR_DATA *npc = make_test_npc();
 	/* Should not crash on NPC */
-	quest_check_progress( npc, QOBJ_USE_COMMAND, "look", 1 );
+	quest_check_progress( npc, QOT_USE_COMMAND, "look", 1 );
 	TEST_ASSERT( 1 );
 	free_test_char( npc );
 }
@@ -277,7 +278,7 @@ static void test_check_progress_no_tracker_noop( void ) {
 	CHAR_DATA *ch = make_test_player();
 	ch->pcdata->quest_tracker = NULL;
 	/* Should not crash */
-	quest_check_progress( ch, QOBJ_USE_COMMAND, "look", 1 );
+	quest_check_progress( ch, QOT_USE_COMMAND, "look", 1 );
 	TEST_ASSERT( 1 );
 	free_test_char( ch );
 }
@@ -299,7 +300,7 @@ static void test_progress_capped_at_threshold( void ) {
 			if ( !strcmp( q->objectives[j].type, QOBJ_USE_COMMAND ) ) {
 				/* Set near threshold then exceed it */
 				p->obj_progress[j].current = q->objectives[j].threshold - 1;
-				quest_check_progress( ch, QOBJ_USE_COMMAND,
+				quest_check_progress( ch, QOT_USE_COMMAND,
 					q->objectives[j].target, 100 );
 
 				/* Should be capped at threshold */
@@ -332,7 +333,7 @@ static void test_target_matching_any( void ) {
 			if ( !strcmp( q->objectives[j].type, QOBJ_KILL_MOB )
 					&& !strcmp( q->objectives[j].target, "any" ) ) {
 				/* "any" target should match any mob name */
-				quest_check_progress( ch, QOBJ_KILL_MOB, "random_mob_12345", 1 );
+				quest_check_progress( ch, QOT_KILL_MOB, "random_mob_12345", 1 );
 				TEST_ASSERT_EQ( p->obj_progress[j].current, 1 );
 				break;
 			}
@@ -357,7 +358,7 @@ static void test_target_matching_specific( void ) {
 		p->status = QSTATUS_ACTIVE;
 
 		/* "kill" should NOT match "look" objective */
-		quest_check_progress( ch, QOBJ_USE_COMMAND, "kill", 1 );
+		quest_check_progress( ch, QOT_USE_COMMAND, "kill", 1 );
 
 		int j;
 		for ( j = 0; j < q->obj_count; j++ ) {
@@ -837,6 +838,165 @@ static void test_m01_class_milestone_met_with_class( void ) {
 	free_test_char( ch );
 }
 
+/*--------------------------------------------------------------------------
+ * Tier 2: Interned Objectives and the Open-Objective Index
+ *--------------------------------------------------------------------------*/
+
+static void test_objectives_interned_at_load( void ) {
+	int i, j;
+
+	TEST_ASSERT_EQ( quest_obj_type_lookup( QOBJ_USE_COMMAND ), QOT_USE_COMMAND );
+	TEST_ASSERT_EQ( quest_obj_type_lookup( QOBJ_CLASS_POWER ), QOT_CLASS_POWER );
+	TEST_ASSERT_EQ( quest_obj_type_lookup( "NOT_A_TYPE" ), QOT_NONE );
+	TEST_ASSERT_EQ( quest_atom_find( "any" ), QUEST_ATOM_ANY );
+	TEST_ASSERT_EQ( quest_atom_find( "no_such_target_xyz" ), QUEST_ATOM_NONE );
+
+	for ( i = 0; i < quest_def_count(); i++ ) {
+		const QUEST_DEF *q = quest_def_by_index( i );
+		for ( j = 0; j < q->obj_count; j++ ) {
+			const QUEST_OBJ_DEF *obj = &q->objectives[j];
+			TEST_ASSERT( obj->type_id != QOT_NONE );
+			TEST_ASSERT_EQ( obj->type_id, quest_obj_type_lookup( obj->type ) );
+			TEST_ASSERT_EQ( obj->target_atom, quest_atom_find( obj->target ) );
+		}
+	}
+}
+
+static void test_milestone_targets_classified( void ) {
+	const QUEST_DEF *q = quest_def_by_id( "M01" );
+	TEST_ASSERT( q != NULL );
+	if ( !q ) return;
+	TEST_ASSERT_EQ( q->objectives[0].target_kind, QTGT_HP );
+	TEST_ASSERT_EQ( q->objectives[1].target_kind, QTGT_NAME );
+	TEST_ASSERT_EQ( q->objectives[2].target_kind, QTGT_CLASS );
+}
+
+static void test_index_counts_open_objectives( void ) {
+	QUEST_TRACKER *t = quest_tracker_new();
+	int qi = quest_def_index_by_id( "M01" );
+	QUEST_PROGRESS *p;
+
+	if ( qi < 0 ) { quest_tracker_free( t ); return; }
+
+	/* Nothing active: every event type is closed */
+	p = quest_tracker_get( t, qi );
+	TEST_ASSERT_EQ( quest_open_count( t, QOT_USE_COMMAND ), 0 );
+	TEST_ASSERT_EQ( t->open_types, 0 );
+
+	p = quest_tracker_get( t, qi );
+	p->status = QSTATUS_ACTIVE;
+	TEST_ASSERT_EQ( quest_open_count( t, QOT_REACH_STAT ), 2 );
+	TEST_ASSERT_EQ( quest_open_count( t, QOT_USE_COMMAND ), 1 );
+	TEST_ASSERT_EQ( quest_open_count( t, QOT_KILL_PLAYER ), 0 );
+
+	/* A met objective drops out once the entry is touched */
+	p->obj_progress[1].current = quest_def_by_index( qi )->objectives[1].threshold;
+	quest_tracker_touch( t );
+	TEST_ASSERT_EQ( quest_open_count( t, QOT_USE_COMMAND ), 0 );
+	TEST_ASSERT_EQ( quest_open_count( t, QOT_REACH_STAT ), 2 );
+
+	quest_tracker_free( t );
+}
+
+static void test_check_progress_closes_met_objective( void ) {
+	CHAR_DATA *ch = make_test_player();
+	QUEST_TRACKER *t = quest_tracker_new();
+	int qi = quest_def_index_by_id( "M01" );
+	ch->pcdata->quest_tracker = t;
+
+	if ( qi >= 0 ) {
+		const QUEST_DEF *q = quest_def_by_index( qi );
+		QUEST_PROGRESS *p = quest_tracker_get( t, qi );
+		p->status = QSTATUS_ACTIVE;
+
+		quest_check_progress( ch, QOT_USE_COMMAND, "look", 1 );
+		TEST_ASSERT_EQ( p->obj_progress[1].current, 0 );
+		quest_check_progress( ch, QOT_USE_COMMAND, "train",
+			q->objectives[1].threshold );
+		TEST_ASSERT_EQ( p->obj_progress[1].current, q->objectives[1].threshold );
+		TEST_ASSERT_EQ( quest_open_count( t, QOT_USE_COMMAND ), 0 );
+	}
+
+	quest_tracker_free( t );
+	ch->pcdata->quest_tracker = NULL;
+	free_test_char( ch );
+}
+
+static void test_milestone_gate_skips_unchanged_stats( void ) {
+	CHAR_DATA *ch = make_test_player();
+	QUEST_TRACKER *t = quest_tracker_new();
+	int qi = quest_def_index_by_id( "M01" );
+	ch->pcdata->quest_tracker = t;
+
+	if ( qi >= 0 ) {
+		const QUEST_DEF *q = quest_def_by_index( qi );
+		QUEST_PROGRESS *p = quest_tracker_get( t, qi );
+		p->status = QSTATUS_ACTIVE;
+
+		ch->class   = 0;
+		ch->max_hit = q->objectives[0].threshold - 10;
+		quest_check_milestones( ch );
+		TEST_ASSERT_EQ( p->obj_progress[0].current, ch->max_hit );
+
+		/* Stats unchanged: the walk is skipped, so this stays put */
+		p->obj_progress[0].current = 0;
+		quest_check_milestones( ch );
+		TEST_ASSERT_EQ( p->obj_progress[0].current, 0 );
+
+		/* A stat an open objective reads changed: the walk runs again */
+		ch->max_hit++;
+		quest_check_milestones( ch );
+		TEST_ASSERT_EQ( p->obj_progress[0].current, ch->max_hit );
+
+		ch->class = 1;
+		quest_check_milestones( ch );
+		TEST_ASSERT_EQ( p->obj_progress[2].current, 1 );
+	}
+
+	quest_tracker_free( t );
+	ch->pcdata->quest_tracker = NULL;
+	free_test_char( ch );
+}
+
+static void test_bench_command_events( void ) {
+	CHAR_DATA *ch = make_test_player();
+	QUEST_TRACKER *t = quest_tracker_new();
+	const int iters = 200000;
+	long long start, idle_ns, open_ns;
+	int i, qi, closed;
+
+	ch->pcdata->quest_tracker = t;
+
+	/* Every quest active; find an event type none of them wait on */
+	for ( qi = 0; qi < quest_def_count(); qi++ )
+		quest_tracker_get( t, qi )->status = QSTATUS_ACTIVE;
+	for ( closed = QOT_USE_COMMAND; closed < QOT_MAX; closed++ )
+		if ( quest_open_count( t, closed ) == 0 )
+			break;
+	TEST_ASSERT( quest_open_count( t, QOT_USE_COMMAND ) > 0 );
+	if ( closed == QOT_MAX )
+		closed = QOT_NONE;
+
+	start = profile_now_ns();
+	for ( i = 0; i < iters; i++ ) {
+		quest_check_progress( ch, closed, "none", 0 );
+		quest_check_milestones( ch );
+	}
+	idle_ns = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( i = 0; i < iters; i++ )
+		quest_check_progress( ch, QOT_USE_COMMAND, "no_such_command", 0 );
+	open_ns = profile_now_ns() - start;
+
+	printf( "    [bench] %d command events, %d quests active: closed type %lld us, open type %lld us\n",
+		iters, quest_def_count(), idle_ns / 1000, open_ns / 1000 );
+
+	quest_tracker_free( t );
+	ch->pcdata->quest_tracker = NULL;
+	free_test_char( ch );
+}
+
 /*--------------------------------------------------------------------------
  * Tier 2: Story Clue Lookup (centralized in quest.db)
  *--------------------------------------------------------------------------*/
@@ -968,6 +1128,13 @@ void suite_quest( void ) {
 	RUN_TEST( test_m01_class_milestone_not_met_without_class );
 	RUN_TEST( test_m01_class_milestone_met_with_class );
 
+	RUN_TEST( test_objectives_interned_at_load );
+	RUN_TEST( test_milestone_targets_classified );
+	RUN_TEST( test_index_counts_open_objectives );
+	RUN_TEST( test_check_progress_closes_met_objective );
+	RUN_TEST( test_milestone_gate_skips_unchanged_stats );
+	RUN_TEST( test_bench_command_events );
+
 	RUN_TEST( test_evaluate_availability_unlocks );
 	RUN_TEST( test_evaluate_availability_npc_noop );
 	RUN_TEST( test_ftue_visibility_explevel0 );
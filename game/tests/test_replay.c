@@ -0,0 +1,720 @@
+/*
+ * Input capture and replay (game/src/systems/capture.c)
+ *
+ * The replayer feeds a capture file back through interpret() on its
+ * recorded pulse schedule, one descriptor per recorded session, with
+ * game_tick() between pulses as in game_loop().  It reports the wall
+ * time of each pulse, the latency of each command and every byte the
+ * descriptors were sent, with a hash of those bytes so two builds can be
+ * checked against each other.  Run it on a real capture with
+ *
+ *   ./run_tests --replay <file> [seed]
+ *
+ * Replayed characters are fresh mortals under the recorded names, capped
+ * below immortal level; "quit" and "save" are skipped so no pfile is
+ * written, and a name that already has a pfile here is replaced.
+ *
+ * Tests:
+ * - What capture records: sessions, lines, redacted LOG_NEVER commands,
+ *   refused lines, forced commands left out, closes
+ * - Replay keeps to the schedule: one line per descriptor per pulse
+ * - Two replays of the same file with the same seed send the same bytes
+ * - Benchmark: a 20 player evening captured live, then replayed
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../systems/capture.h"
+#include "../systems/profile.h"
+#include "../systems/mcmp.h"
+#include "../core/rng.h"
+#include "../db/db_game.h"
+#include "../db/db_player.h"
+#include "../db/db_sql.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern void init_descriptor( DESCRIPTOR_DATA *dnew, int desc );
+extern const char go_ahead_str[];
+extern void stop_idling( CHAR_DATA *ch );
+
+#define REPLAY_QUEUE	 32
+#define EVENING_PLAYERS	 20
+#define EVENING_PULSES	 240
+
+typedef struct replay_line {
+	uint32_t due;
+	char text[MAX_INPUT_LENGTH];
+} REPLAY_LINE;
+
+typedef struct replay_session {
+	DESCRIPTOR_DATA *d;	 /* NULL once the descriptor is closed */
+	CHAR_DATA *ch;
+	int rfd;			 /* Read end of the descriptor's pipe */
+	bool made_pfile;	 /* No pfile had this name before */
+	char name[32];
+	REPLAY_LINE queue[REPLAY_QUEUE];
+	int head;
+	int count;
+} REPLAY_SESSION;
+
+typedef struct replay {
+	REPLAY_SESSION **sessions; /* By session number, [0] unused */
+	int nsessions;
+	int pulses;
+	int commands;
+	int late;				   /* Ran on a later pulse than recorded */
+	int skipped;			   /* quit, save, or a full queue */
+	long long bytes;
+	uint32_t hash;			   /* FNV-1a over every byte sent */
+	long long *pulse_ns;
+	long long *cmd_ns;
+	int pulse_cap;
+	int cmd_cap;
+} REPLAY;
+
+static void replay_init( REPLAY *rp ) {
+	memset( rp, 0, sizeof( *rp ) );
+	rp->hash = 2166136261u;
+}
+
+static void push_ns( long long **v, int *cap, int n, long long ns ) {
+	if ( n == *cap ) {
+		*cap = *cap ? *cap * 2 : 1024;
+		*v = realloc( *v, *cap * sizeof( long long ) );
+	}
+	( *v )[n] = ns;
+}
+
+/* Read everything the game sent s since the last drain */
+static void replay_drain( REPLAY *rp, REPLAY_SESSION *s ) {
+	unsigned char buf[8192];
+	int n, i;
+
+	if ( s->rfd < 0 )
+		return;
+	while ( ( n = (int) read( s->rfd, buf, sizeof( buf ) ) ) > 0 ) {
+		rp->bytes += n;
+		for ( i = 0; i < n; i++ )
+			rp->hash = ( rp->hash ^ buf[i] ) * 16777619u;
+	}
+}
+
+/*
+ * A playing descriptor and character, as nanny leaves them, whose output
+ * goes down a pipe.
+ */
+static REPLAY_SESSION *replay_connect( REPLAY *rp, int id, const char *name, int vnum, int level ) {
+	REPLAY_SESSION *s;
+	ROOM_INDEX_DATA *room;
+	DESCRIPTOR_DATA *d;
+	int fds[2];
+
+	if ( id <= 0 || pipe( fds ) != 0 )
+		return NULL;
+	fcntl( fds[0], F_SETFL, O_NONBLOCK );
+#if defined( F_SETPIPE_SZ )
+	fcntl( fds[1], F_SETPIPE_SZ, 1 << 20 );
+#endif
+
+	if ( id >= rp->nsessions ) {
+		int n = id + 16;
+		rp->sessions = realloc( rp->sessions, n * sizeof( REPLAY_SESSION * ) );
+		memset( rp->sessions + rp->nsessions, 0, ( n - rp->nsessions ) * sizeof( REPLAY_SESSION * ) );
+		rp->nsessions = n;
+	}
+	free( rp->sessions[id] );
+	s = rp->sessions[id] = calloc( 1, sizeof( REPLAY_SESSION ) );
+	s->rfd = fds[0];
+
+	snprintf( s->name, sizeof( s->name ), "%s", name );
+	if ( s->name[0] == '\0' || db_player_exists( s->name ) )
+		snprintf( s->name, sizeof( s->name ), "Replay%d", id );
+	s->made_pfile = !db_player_exists( s->name );
+
+	d = s->d = calloc( 1, sizeof( DESCRIPTOR_DATA ) );
+	init_descriptor( d, fds[1] );
+	d->host = str_dup( "replay" );
+	d->lookup_status = STATUS_DONE;
+	d->connected = CON_PLAYING;
+	list_push_back( &g_descriptors, &d->node );
+
+	s->ch = init_char_for_load( d, s->name );
+	s->ch->level = URANGE( 1, level, LEVEL_IMMORTAL - 1 );
+	list_push_back( &g_characters, &s->ch->char_node );
+	if ( ( room = get_room_index( vnum ) ) == NULL )
+		room = get_room_index( ROOM_VNUM_TEMPLE );
+	char_to_room( s->ch, room );
+	return s;
+}
+
+static bool replay_live( REPLAY_SESSION *s ) {
+	return s != NULL && s->d != NULL && s->d->lookup_status == STATUS_DONE
+		&& s->d->character != NULL;
+}
+
+/* quit and save reset the save timer and write a pfile */
+static bool replay_skip( const char *line ) {
+	char word[MAX_INPUT_LENGTH];
+	int cmd;
+
+	one_argument( (char *) line, word );
+	if ( word[0] == '\0' )
+		return FALSE;
+	for ( cmd = 0; cmd_table[cmd].name[0] != '\0'; cmd++ ) {
+		if ( !str_prefix( word, cmd_table[cmd].name ) )
+			return cmd_table[cmd].do_fun == do_quit || cmd_table[cmd].do_fun == do_save;
+	}
+	return FALSE;
+}
+
+static void replay_apply( REPLAY *rp, CAPTURE_RECORD *rec ) {
+	REPLAY_SESSION *s = (int) rec->session < rp->nsessions ? rp->sessions[rec->session] : NULL;
+	REPLAY_LINE *line;
+	const unsigned char *p = (const unsigned char *) rec->data;
+	int len;
+
+	switch ( rec->type ) {
+	case CAPTURE_OPEN:
+		if ( rec->len < 6 )
+			return;
+		s = replay_connect( rp, (int) rec->session, rec->data + 6,
+			(int) ( p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24 ), p[4] | p[5] << 8 );
+		if ( s != NULL )
+			s->d->capture_id = (int) rec->session;
+		break;
+	case CAPTURE_LINE:
+		if ( !replay_live( s ) )
+			return;
+		if ( s->count == REPLAY_QUEUE ) {
+			rp->skipped++;
+			return;
+		}
+		line = &s->queue[( s->head + s->count++ ) % REPLAY_QUEUE];
+		line->due = rec->pulse;
+		len = UMIN( rec->len, (int) sizeof( line->text ) - 1 );
+		memcpy( line->text, rec->data, len );
+		line->text[len] = '\0';
+		break;
+	case CAPTURE_CLOSE:
+		if ( replay_live( s ) )
+			close_socket( s->d );
+		break;
+	}
+}
+
+/* game_loop()'s input pass: one line per descriptor, held while waiting */
+static void replay_input( REPLAY *rp, uint32_t pulse ) {
+	REPLAY_SESSION *s;
+	REPLAY_LINE *line;
+	DESCRIPTOR_DATA *d;
+	long long start;
+	int i;
+
+	for ( i = 1; i < rp->nsessions; i++ ) {
+		if ( !replay_live( s = rp->sessions[i] ) )
+			continue;
+		d = s->d;
+		d->fcommand = FALSE;
+
+		if ( d->character->wait > 0 ) {
+			--d->character->wait;
+			continue;
+		}
+		if ( s->count == 0 )
+			continue;
+
+		line = &s->queue[s->head];
+		s->head = ( s->head + 1 ) % REPLAY_QUEUE;
+		s->count--;
+		if ( pulse > line->due )
+			rp->late++;
+		if ( replay_skip( line->text ) ) {
+			rp->skipped++;
+			continue;
+		}
+
+		snprintf( d->incomm, sizeof( d->incomm ), "%s", line->text );
+		d->fcommand = TRUE;
+		d->character->timer = 0;
+		stop_idling( d->character );
+
+		start = profile_now_ns();
+		interpret( d->character, d->incomm );
+		if ( d->outtop > 0 ) {
+			if ( d->character && IS_SET( d->character->act, PLR_TELNET_GA ) )
+				write_to_buffer( d, go_ahead_str, 0 );
+			process_output( d, FALSE );
+		}
+		push_ns( &rp->cmd_ns, &rp->cmd_cap, rp->commands, profile_now_ns() - start );
+		rp->commands++;
+		d->incomm[0] = '\0';
+		replay_drain( rp, s );
+	}
+}
+
+static void replay_output( REPLAY *rp ) {
+	REPLAY_SESSION *s;
+	int i;
+
+	for ( i = 1; i < rp->nsessions; i++ ) {
+		if ( !replay_live( s = rp->sessions[i] ) )
+			continue;
+		if ( s->d->fcommand || s->d->outtop > 0 ) {
+			if ( !process_output( s->d, TRUE ) ) {
+				s->d->outtop = 0;
+				close_socket( s->d );
+			}
+		}
+		mcmp_flush( s->d );
+		replay_drain( rp, s );
+	}
+}
+
+/*
+ * Forget descriptors the game has closed or already freed.  No capture
+ * runs during a replay, so capture_id is free to name the session.
+ */
+static void replay_reap( REPLAY *rp ) {
+	DESCRIPTOR_DATA *d;
+	REPLAY_SESSION *s;
+	bool *seen;
+	int i;
+
+	if ( rp->nsessions == 0 )
+		return;
+	seen = calloc( rp->nsessions, sizeof( bool ) );
+	LIST_FOR_EACH( d, &g_descriptors, DESCRIPTOR_DATA, node ) {
+		if ( d->capture_id > 0 && d->capture_id < rp->nsessions
+			&& rp->sessions[d->capture_id] != NULL && rp->sessions[d->capture_id]->d == d
+			&& d->lookup_status == STATUS_DONE )
+			seen[d->capture_id] = TRUE;
+	}
+	for ( i = 1; i < rp->nsessions; i++ ) {
+		if ( ( s = rp->sessions[i] ) == NULL || seen[i] || s->rfd < 0 )
+			continue;
+		s->d = NULL;
+		replay_drain( rp, s );
+		close( s->rfd );
+		s->rfd = -1;
+		s->count = 0;
+	}
+	free( seen );
+}
+
+static bool replay_queued( REPLAY *rp ) {
+	int i;
+
+	for ( i = 1; i < rp->nsessions; i++ )
+		if ( replay_live( rp->sessions[i] ) && rp->sessions[i]->count > 0 )
+			return TRUE;
+	return FALSE;
+}
+
+/* Take every replayed character out of the game and remove their pfiles */
+static void replay_finish( REPLAY *rp ) {
+	char path[MUD_PATH_MAX];
+	REPLAY_SESSION *s;
+	CHAR_DATA *ch;
+	DESCRIPTOR_DATA *d;
+	int i;
+
+	for ( i = 1; i < rp->nsessions; i++ ) {
+		if ( ( s = rp->sessions[i] ) == NULL )
+			continue;
+		LIST_FOR_EACH( ch, &g_characters, CHAR_DATA, char_node ) {
+			if ( ch == s->ch && !IS_NPC( ch ) && !ch->extracted ) {
+				d = ch->desc;
+				extract_char( ch, TRUE );
+				if ( d != NULL )
+					close_socket( d );
+				break;
+			}
+		}
+	}
+	recycle_descriptors();
+	free_extracted_chars();
+	replay_reap( rp );
+	db_player_wait_pending();
+
+	for ( i = 1; i < rp->nsessions; i++ ) {
+		if ( ( s = rp->sessions[i] ) == NULL )
+			continue;
+		if ( s->made_pfile ) {
+			if ( db_player_exists( s->name ) )
+				db_player_delete( s->name );
+			if ( snprintf( path, sizeof( path ), "%s%splayers%sbackup%s%s.db",
+					mud_db_dir, PATH_SEPARATOR, PATH_SEPARATOR, PATH_SEPARATOR,
+					s->name ) < (int) sizeof( path ) )
+				remove( path );
+		}
+		free( s );
+	}
+	free( rp->sessions );
+	free( rp->pulse_ns );
+	free( rp->cmd_ns );
+	rp->sessions = NULL;
+	rp->nsessions = 0;
+	rp->pulse_ns = rp->cmd_ns = NULL;
+}
+
+/*
+ * Replay fp from its first pulse until every recorded line has run.
+ * Returns FALSE if fp is not a capture.
+ */
+static bool replay_run( REPLAY *rp, FILE *fp, uint64_t seed ) {
+	static CAPTURE_RECORD rec;
+	uint64_t start_time;
+	uint32_t pulse;
+	long long start;
+	int pps;
+	bool more;
+
+	if ( !capture_read_header( fp, &pps, &start_time ) || pps <= 0 )
+		return FALSE;
+
+	signal( SIGPIPE, SIG_IGN );
+	rng_seed_all( seed );
+	current_time = (time_t) start_time;
+	more = capture_read( fp, &rec );
+
+	for ( pulse = 0; more || replay_queued( rp ); pulse++ ) {
+		start = profile_now_ns();
+		if ( pulse > 0 && pulse % pps == 0 )
+			current_time++;
+
+		while ( more && rec.pulse <= pulse ) {
+			replay_apply( rp, &rec );
+			more = capture_read( fp, &rec );
+		}
+		replay_input( rp, pulse );
+		game_tick();
+		replay_output( rp );
+		replay_reap( rp );
+
+		push_ns( &rp->pulse_ns, &rp->pulse_cap, rp->pulses, profile_now_ns() - start );
+		rp->pulses++;
+	}
+	return TRUE;
+}
+
+static int cmp_ll( const void *a, const void *b ) {
+	long long x = *(const long long *) a, y = *(const long long *) b;
+	return ( x > y ) - ( x < y );
+}
+
+/* Sorts v; pct of 100 is the maximum */
+static long long percentile( long long *v, int n, int pct ) {
+	if ( n == 0 )
+		return 0;
+	qsort( v, n, sizeof( long long ), cmp_ll );
+	return v[(long long) ( n - 1 ) * pct / 100];
+}
+
+static void replay_report( REPLAY *rp, const char *indent ) {
+	long long total = 0;
+	int i;
+
+	for ( i = 0; i < rp->pulses; i++ )
+		total += rp->pulse_ns[i];
+	printf( "%s%d commands over %d pulses, %d late, %d skipped\n",
+		indent, rp->commands, rp->pulses, rp->late, rp->skipped );
+	printf( "%spulse wall time us: mean %lld, p50 %lld, p99 %lld, max %lld\n", indent,
+		rp->pulses ? total / rp->pulses / 1000 : 0,
+		percentile( rp->pulse_ns, rp->pulses, 50 ) / 1000,
+		percentile( rp->pulse_ns, rp->pulses, 99 ) / 1000,
+		percentile( rp->pulse_ns, rp->pulses, 100 ) / 1000 );
+	printf( "%scommand latency us: p50 %lld, p90 %lld, p99 %lld, max %lld\n", indent,
+		percentile( rp->cmd_ns, rp->commands, 50 ) / 1000,
+		percentile( rp->cmd_ns, rp->commands, 90 ) / 1000,
+		percentile( rp->cmd_ns, rp->commands, 99 ) / 1000,
+		percentile( rp->cmd_ns, rp->commands, 100 ) / 1000 );
+	printf( "%soutput: %lld bytes, hash %08x\n", indent, rp->bytes, rp->hash );
+}
+
+/* run_tests --replay <file> [seed] */
+int replay_main( const char *path, uint64_t seed ) {
+	REPLAY rp;
+	FILE *fp;
+	bool ok;
+
+	if ( ( fp = fopen( path, "rb" ) ) == NULL ) {
+		perror( path );
+		return 1;
+	}
+	ensure_booted();
+	replay_init( &rp );
+	ok = replay_run( &rp, fp, seed );
+	fclose( fp );
+	if ( !ok ) {
+		fprintf( stderr, "%s: not a capture file\n", path );
+		replay_finish( &rp );
+		return 1;
+	}
+
+	printf( "Replay of %s, seed %llu:\n", path, (unsigned long long) seed );
+	replay_report( &rp, "  " );
+	replay_finish( &rp );
+	db_game_close_writer();
+	return 0;
+}
+
+/*--------------------------------------------------------------------------
+ * Tests
+ *--------------------------------------------------------------------------*/
+
+#define TEST_CAPTURE "test_capture.bin"
+
+static FILE *open_capture( void ) {
+	return fopen( mud_path( mud_log_dir, TEST_CAPTURE ), "rb" );
+}
+
+static void test_capture_records_input( void ) {
+	REPLAY live;
+	REPLAY_SESSION *a, *b;
+	CAPTURE_RECORD rec;
+	uint64_t start;
+	FILE *fp;
+	int pps;
+
+	replay_init( &live );
+	a = replay_connect( &live, 1, "Capturea", ROOM_VNUM_TEMPLE, 3 );
+	TEST_ASSERT( capture_start( TEST_CAPTURE ) );
+	TEST_ASSERT( capture_active() );
+	b = replay_connect( &live, 2, "Captureb", ROOM_VNUM_TEMPLE, 3 );
+
+	capture_expect( a->d );
+	interpret( a->ch, "say hello" );
+	game_tick();
+
+	/* Passwords stay out of the file */
+	capture_expect( b->d );
+	interpret( b->ch, "password secret other" );
+	/* Only the line the player typed, not a force after it */
+	capture_expect( a->d );
+	interpret( a->ch, "look" );
+	interpret( a->ch, "score" );
+	/* Nor after a line interpret() turned away */
+	SET_BIT( a->ch->extra, TIED_UP );
+	capture_expect( a->d );
+	interpret( a->ch, "north" );
+	REMOVE_BIT( a->ch->extra, TIED_UP );
+	interpret( a->ch, "who" );
+	game_tick();
+
+	close_socket( b->d );
+	capture_stop();
+	TEST_ASSERT( !capture_active() );
+	replay_finish( &live );
+
+	fp = open_capture();
+	TEST_ASSERT( fp != NULL );
+	if ( fp == NULL )
+		return;
+	TEST_ASSERT( capture_read_header( fp, &pps, &start ) );
+	TEST_ASSERT_EQ( pps, PULSE_PER_SECOND );
+
+	TEST_ASSERT( capture_read( fp, &rec ) );
+	TEST_ASSERT_EQ( rec.type, CAPTURE_OPEN );
+	TEST_ASSERT_EQ( rec.session, 1 );
+	TEST_ASSERT_STR_EQ( rec.data + 6, "Capturea" );
+
+	TEST_ASSERT( capture_read( fp, &rec ) );
+	TEST_ASSERT_EQ( rec.type, CAPTURE_LINE );
+	TEST_ASSERT_EQ( rec.pulse, 0 );
+	TEST_ASSERT_STR_EQ( rec.data, "say hello" );
+
+	/* b came in after the start, so is opened on its first line */
+	TEST_ASSERT( capture_read( fp, &rec ) );
+	TEST_ASSERT_EQ( rec.type, CAPTURE_OPEN );
+	TEST_ASSERT_EQ( rec.session, 2 );
+	TEST_ASSERT_EQ( rec.data[4], 3 );
+
+	TEST_ASSERT( capture_read( fp, &rec ) );
+	TEST_ASSERT_EQ( rec.type, CAPTURE_LINE );
+	TEST_ASSERT_EQ( rec.pulse, 1 );
+	TEST_ASSERT_STR_EQ( rec.data, "password" );
+
+	TEST_ASSERT( capture_read( fp, &rec ) );
+	TEST_ASSERT_EQ( rec.session, 1 );
+	TEST_ASSERT_STR_EQ( rec.data, "look" );
+
+	TEST_ASSERT( capture_read( fp, &rec ) );
+	TEST_ASSERT_EQ( rec.session, 1 );
+	TEST_ASSERT_STR_EQ( rec.data, "north" );
+
+	TEST_ASSERT( capture_read( fp, &rec ) );
+	TEST_ASSERT_EQ( rec.type, CAPTURE_CLOSE );
+	TEST_ASSERT_EQ( rec.session, 2 );
+	TEST_ASSERT_EQ( rec.pulse, 2 );
+
+	TEST_ASSERT( !capture_read( fp, &rec ) );
+	fclose( fp );
+	remove( mud_path( mud_log_dir, TEST_CAPTURE ) );
+}
+
+static void test_replay_keeps_schedule( void ) {
+	REPLAY live, rp;
+	REPLAY_SESSION *a;
+	FILE *fp;
+
+	replay_init( &live );
+	a = replay_connect( &live, 1, "Schedulea", ROOM_VNUM_TEMPLE, 3 );
+	TEST_ASSERT( capture_start( TEST_CAPTURE ) );
+
+	/* Two lines in one pulse: the second has to wait for the next */
+	capture_expect( a->d );
+	interpret( a->ch, "look" );
+	capture_expect( a->d );
+	interpret( a->ch, "say one" );
+	game_tick();
+	game_tick();
+	capture_expect( a->d );
+	interpret( a->ch, "save" );
+	game_tick();
+	capture_expect( a->d );
+	interpret( a->ch, "say two" );
+	capture_stop();
+	replay_finish( &live );
+
+	fp = open_capture();
+	TEST_ASSERT( fp != NULL );
+	if ( fp == NULL )
+		return;
+	replay_init( &rp );
+	TEST_ASSERT( replay_run( &rp, fp, 1 ) );
+	fclose( fp );
+
+	TEST_ASSERT_EQ( rp.commands, 3 );
+	TEST_ASSERT_EQ( rp.skipped, 1 );
+	TEST_ASSERT_EQ( rp.late, 1 );
+	TEST_ASSERT_EQ( rp.pulses, 4 );
+	TEST_ASSERT( rp.bytes > 0 );
+	replay_finish( &rp );
+	TEST_ASSERT( !db_player_exists( "Schedulea" ) );
+	remove( mud_path( mud_log_dir, TEST_CAPTURE ) );
+}
+
+static const char *evening_lines[] = {
+	"look", "score", "say evening all", "who", "inventory", "north", "south",
+	"east", "west", "equipment", "time", "weather", "exits", "consider guard",
+	"help newbie", "chat anyone about?"
+};
+
+/* Twenty players at it for a minute, captured as the game loop would */
+static void capture_evening( void ) {
+	REPLAY live;
+	REPLAY_SESSION *s;
+	char name[32];
+	unsigned int lcg = 12345;
+	int i, pulse;
+
+	replay_init( &live );
+	for ( i = 1; i <= EVENING_PLAYERS; i++ ) {
+		snprintf( name, sizeof( name ), "Evening%c", 'a' + i - 1 );
+		replay_connect( &live, i, name, ROOM_VNUM_TEMPLE, 3 );
+	}
+	capture_start( TEST_CAPTURE );
+	for ( pulse = 0; pulse < EVENING_PULSES; pulse++ ) {
+		for ( i = 1; i <= EVENING_PLAYERS; i++ ) {
+			lcg = lcg * 1103515245u + 12345u;
+			if ( ( lcg >> 16 ) % 4 != 0 || !replay_live( s = live.sessions[i] ) )
+				continue;
+			if ( s->ch->wait > 0 ) {
+				s->ch->wait--;
+				continue;
+			}
+			snprintf( s->d->incomm, sizeof( s->d->incomm ), "%s",
+				evening_lines[( lcg >> 20 ) % ( sizeof( evening_lines ) / sizeof( evening_lines[0] ) )] );
+			capture_expect( s->d );
+			interpret( s->ch, s->d->incomm );
+			s->d->outtop = 0;
+		}
+		game_tick();
+		for ( i = 1; i <= EVENING_PLAYERS; i++ )
+			if ( replay_live( s = live.sessions[i] ) )
+				s->d->outtop = 0;
+	}
+	capture_stop();
+	replay_finish( &live );
+}
+
+/* Replays in a child so the world it leaves behind is thrown away */
+static bool replay_in_child( uint64_t seed, long long *bytes, uint32_t *hash ) {
+	long long result[2] = { 0, 0 };
+	int fds[2], status;
+	pid_t pid;
+
+	if ( pipe( fds ) != 0 )
+		return FALSE;
+	fflush( stdout );
+	if ( ( pid = fork() ) == 0 ) {
+		REPLAY rp;
+		FILE *fp = open_capture();
+
+		close( fds[0] );
+		replay_init( &rp );
+		if ( fp != NULL && replay_run( &rp, fp, seed ) ) {
+			result[0] = rp.bytes;
+			result[1] = rp.hash;
+		}
+		/* Autosaves are still in flight; the next child must not find them */
+		replay_finish( &rp );
+		if ( write( fds[1], result, sizeof( result ) ) != sizeof( result ) )
+			_exit( 1 );
+		_exit( 0 );
+	}
+	close( fds[1] );
+	if ( pid < 0 || read( fds[0], result, sizeof( result ) ) != sizeof( result ) ) {
+		close( fds[0] );
+		return FALSE;
+	}
+	close( fds[0] );
+	waitpid( pid, &status, 0 );
+	*bytes = result[0];
+	*hash = (uint32_t) result[1];
+	return TRUE;
+}
+
+static void test_replay_is_repeatable( void ) {
+	long long bytes1, bytes2;
+	uint32_t hash1, hash2;
+
+	capture_evening();
+	TEST_ASSERT( replay_in_child( 42, &bytes1, &hash1 ) );
+	TEST_ASSERT( replay_in_child( 42, &bytes2, &hash2 ) );
+	TEST_ASSERT( bytes1 > 0 );
+	TEST_ASSERT_EQ( bytes1, bytes2 );
+	TEST_ASSERT_EQ( hash1, hash2 );
+}
+
+static void test_bench_replay( void ) {
+	REPLAY rp;
+	FILE *fp = open_capture();
+
+	TEST_ASSERT( fp != NULL );
+	if ( fp == NULL )
+		return;
+	replay_init( &rp );
+	TEST_ASSERT( replay_run( &rp, fp, 42 ) );
+	fclose( fp );
+	TEST_ASSERT( rp.commands > EVENING_PULSES );
+
+	printf( "    [bench] replay of a %d player, %d pulse capture:\n", EVENING_PLAYERS, EVENING_PULSES );
+	replay_report( &rp, "    [bench]   " );
+	replay_finish( &rp );
+	remove( mud_path( mud_log_dir, TEST_CAPTURE ) );
+}
+
+void suite_replay( void ) {
+	if ( !ensure_booted() ) return;
+
+	RUN_TEST( test_capture_records_input );
+	RUN_TEST( test_replay_keeps_schedule );
+	RUN_TEST( test_replay_is_repeatable );
+	RUN_TEST( test_bench_replay );
+}
@@ -0,0 +1,180 @@
+/*
+ * Room render cache tests (game/src/world/room_render.c)
+ *
+ * Tests:
+ * - Auto-exit lines are built once and shared, in both plain and screen
+ *   reader forms
+ * - Wall lines follow exit bits without explicit invalidation
+ * - The description follows the room's tint; OLC invalidation rebuilds
+ * - Benchmark: static look parts, cached versus rebuilt
+ *
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../world/room_render.h"
+#include "../systems/profile.h"
+
+extern ROOM_INDEX_DATA *room_index_hash[MAX_KEY_HASH];
+extern char *const dir_name[];
+
+/* A room with at least two exits and no walls, or NULL */
+static ROOM_INDEX_DATA *rr_test_room( void ) {
+	ROOM_INDEX_DATA *room;
+	int i, door, exits;
+
+	for ( i = 0; i < MAX_KEY_HASH; i++ ) {
+		for ( room = room_index_hash[i]; room != NULL; room = room->next ) {
+			exits = 0;
+			for ( door = 0; door < 6; door++ )
+				if ( room->exit[door] != NULL && room->exit[door]->to_room != NULL
+					&& room->exit[door]->exit_info == 0 )
+					exits++;
+			if ( exits >= 2 && room->description != NULL && room->description[0] != '\0' )
+				return room;
+		}
+	}
+	return NULL;
+}
+
+void test_room_render_exits_cached( void ) {
+	ROOM_INDEX_DATA *room;
+	char expect[MAX_STRING_LENGTH];
+	char reader[MAX_STRING_LENGTH];
+	const char *a, *b;
+	long hits0, misses0, hits, misses;
+	int door;
+	bool first = TRUE;
+
+	ensure_booted();
+	room = rr_test_room();
+	TEST_ASSERT( room != NULL );
+	if ( room == NULL )
+		return;
+
+	strcpy( expect, "#R[#GExits#7:#C" );
+	strcpy( reader, "Exits:" );
+	for ( door = 0; door < 6; door++ ) {
+		if ( room->exit[door] == NULL || room->exit[door]->to_room == NULL )
+			continue;
+		strcat( expect, " " );
+		strcat( expect, dir_name[door] );
+		strcat( reader, first ? " " : ", " );
+		strcat( reader, dir_name[door] );
+		first = FALSE;
+	}
+	strcat( expect, "#R]#x\n\r" );
+	strcat( reader, "\n\r" );
+
+	room_render_get_stats( &hits0, &misses0 );
+	a = room_render_get( room, RR_EXITS, 0 );
+	b = room_render_get( room, RR_EXITS, 0 );
+	TEST_ASSERT_STR_EQ( a, expect );
+	TEST_ASSERT( a == b );
+	TEST_ASSERT_STR_EQ( room_render_get( room, RR_EXITS, 1 ), reader );
+	room_render_get_stats( &hits, &misses );
+	TEST_ASSERT( hits - hits0 >= 1 );
+	TEST_ASSERT( misses - misses0 <= 2 );
+}
+
+void test_room_render_walls_follow_exits( void ) {
+	ROOM_INDEX_DATA *room;
+	EXIT_DATA *pexit = NULL;
+	int door;
+
+	ensure_booted();
+	room = rr_test_room();
+	TEST_ASSERT( room != NULL );
+	if ( room == NULL )
+		return;
+
+	for ( door = 0; door < 6 && pexit == NULL; door++ )
+		if ( room->exit[door] != NULL && room->exit[door]->to_room != NULL )
+			pexit = room->exit[door];
+
+	TEST_ASSERT_STR_EQ( room_render_get( room, RR_WALLS, 0 ), "" );
+
+	/* A wall going up is seen without anyone invalidating */
+	SET_BIT( pexit->exit_info, EX_FIRE_WALL );
+	TEST_ASSERT( strstr( room_render_get( room, RR_WALLS, 0 ), "blazing wall of fire" ) != NULL );
+	REMOVE_BIT( pexit->exit_info, EX_FIRE_WALL );
+	TEST_ASSERT_STR_EQ( room_render_get( room, RR_WALLS, 0 ), "" );
+}
+
+void test_room_render_desc_tint( void ) {
+	ROOM_INDEX_DATA *room;
+	uint32_t flags;
+	char expect[MAX_STRING_LENGTH * 2];
+	const char *a;
+	long hits0, misses0, hits, misses;
+
+	ensure_booted();
+	room = rr_test_room();
+	TEST_ASSERT( room != NULL );
+	if ( room == NULL )
+		return;
+
+	snprintf( expect, sizeof( expect ), "%s%s#n", get_room_tint_color( room ), room->description );
+	TEST_ASSERT_STR_EQ( room_render_get( room, RR_DESC, 0 ), expect );
+
+	/* A flaming room changes tint, so the text changes with it */
+	flags = room->room_flags;
+	SET_BIT( room->room_flags, ROOM_FLAMING );
+	a = room_render_get( room, RR_DESC, 0 );
+	TEST_ASSERT( strncmp( a, "#x202", 5 ) == 0 );
+	room->room_flags = flags;
+	TEST_ASSERT_STR_EQ( room_render_get( room, RR_DESC, 0 ), expect );
+
+	/* OLC invalidation rebuilds the same text */
+	room_render_get_stats( &hits0, &misses0 );
+	room_render_invalidate_all();
+	TEST_ASSERT_STR_EQ( room_render_get( room, RR_DESC, 0 ), expect );
+	room_render_get_stats( &hits, &misses );
+	TEST_ASSERT_EQ( (int) ( misses - misses0 ), 1 );
+	TEST_ASSERT_EQ( (int) ( hits - hits0 ), 0 );
+}
+
+static void rr_static_parts( ROOM_INDEX_DATA *room ) {
+	room_render_get( room, RR_DESC, 0 );
+	room_render_get( room, RR_EXITS, 0 );
+	room_render_get( room, RR_WALLS, 0 );
+}
+
+void test_room_render_bench( void ) {
+	ROOM_INDEX_DATA *room;
+	int64_t start, cached, rebuilt;
+	int i;
+
+	ensure_booted();
+	room = rr_test_room();
+	TEST_ASSERT( room != NULL );
+	if ( room == NULL )
+		return;
+
+	rr_static_parts( room );
+	start = profile_now_ns();
+	for ( i = 0; i < 10000; i++ )
+		rr_static_parts( room );
+	cached = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( i = 0; i < 10000; i++ ) {
+		room_render_invalidate_all();
+		rr_static_parts( room );
+	}
+	rebuilt = profile_now_ns() - start;
+
+	printf( "    [bench] 10k looks, static parts (desc, exits, walls): "
+		"%lld us cached, %lld us rebuilt\n",
+		(long long) ( cached / 1000 ), (long long) ( rebuilt / 1000 ) );
+	TEST_ASSERT( cached < rebuilt );
+}
+
+void suite_room_render( void ) {
+	RUN_TEST( test_room_render_exits_cached );
+	RUN_TEST( test_room_render_walls_follow_exits );
+	RUN_TEST( test_room_render_desc_tint );
+	RUN_TEST( test_room_render_bench );
+}
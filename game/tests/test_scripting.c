@@ -13,6 +13,9 @@
 
 extern MOB_INDEX_DATA *mob_index_hash[MAX_KEY_HASH];
 
+/* Defined in script_lua.c */
+bool script_run_tick( SCRIPT_DATA *script, CHAR_DATA *mob );
+
 /* Create a SCRIPT_DATA with the given Lua code */
 static SCRIPT_DATA *make_test_script( uint32_t trigger, const char *code,
 	const char *pattern, int chance ) {
@@ -30,6 +33,7 @@ static SCRIPT_DATA *make_test_script( uint32_t trigger, const char *code,
 
 static void free_test_script( SCRIPT_DATA *script ) {
 	if ( script == NULL ) return;
+	script_invalidate_cache( script );
 	if ( script->name ) free( script->name );
 	if ( script->code ) free( script->code );
 	if ( script->pattern ) free( script->pattern );
@@ -37,6 +41,21 @@ static void free_test_script( SCRIPT_DATA *script ) {
 	free( script );
 }
 
+extern OBJ_INDEX_DATA *obj_index_hash[MAX_KEY_HASH];
+
+/* Find an object index with no scripts of its own */
+static OBJ_INDEX_DATA *get_unscripted_obj_index( void ) {
+	OBJ_INDEX_DATA *pObj;
+	int i;
+	for ( i = 0; i < MAX_KEY_HASH; i++ ) {
+		for ( pObj = obj_index_hash[i]; pObj != NULL; pObj = pObj->next ) {
+			if ( list_empty( &pObj->scripts ) )
+				return pObj;
+		}
+	}
+	return NULL;
+}
+
 /* Find any valid mob index from the hash table */
 static MOB_INDEX_DATA *get_any_mob_index( void ) {
 	int i;
@@ -204,6 +223,7 @@ void test_script_trigger_greet_fires( void ) {
 		"function on_greet(mob, ch) mob:say('hello from test') end",
 		NULL, 0 );
 	list_push_back( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
 
 	/* Create mob from this index and a player */
 	CHAR_DATA *mob = create_mobile( pMobIndex );
@@ -215,18 +235,21 @@ void test_script_trigger_greet_fires( void ) {
 	char_to_room( player, room );
 
 	/* Fire the greet trigger */
+	long evals0, fires0, evals1, fires1;
+	script_trigger_totals( &evals0, &fires0 );
 	script_trigger_greet( player, room );
-	/* If we get here without crash, the trigger dispatched correctly */
-	TEST_ASSERT_TRUE( TRUE );
+	script_trigger_totals( &evals1, &fires1 );
+	TEST_ASSERT( fires1 > fires0 );
 
 	/* Clean up: remove our test script from the mob index */
 	list_remove( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
 	TEST_ASSERT_EQ( (int) list_count( &pMobIndex->scripts ), (int) orig_script_count );
 
 	char_from_room( player );
 	char_from_room( mob );
 	free_char( player );
-	free_char( mob );
+	free_test_mobile( mob );
 	free_test_script( script );
 }
 
@@ -241,6 +264,7 @@ void test_script_trigger_speech_matches( void ) {
 		"function on_speech(mob, ch, text) mob:say('heard you') end",
 		"hello", 0 );
 	list_push_back( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
 
 	CHAR_DATA *mob = create_mobile( pMobIndex );
 	CHAR_DATA *player = make_full_test_npc();
@@ -250,16 +274,20 @@ void test_script_trigger_speech_matches( void ) {
 	char_to_room( mob, room );
 	char_to_room( player, room );
 
+	long evals0, fires0, evals1, fires1;
+	script_trigger_totals( &evals0, &fires0 );
 	script_trigger_speech( player, "hello world" );
-	TEST_ASSERT_TRUE( TRUE ); /* No crash, pattern matched */
+	script_trigger_totals( &evals1, &fires1 );
+	TEST_ASSERT( fires1 > fires0 ); /* Pattern matched */
 
 	list_remove( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
 	TEST_ASSERT_EQ( (int) list_count( &pMobIndex->scripts ), (int) orig_script_count );
 
 	char_from_room( player );
 	char_from_room( mob );
 	free_char( player );
-	free_char( mob );
+	free_test_mobile( mob );
 	free_test_script( script );
 }
 
@@ -274,6 +302,7 @@ void test_script_trigger_speech_no_match( void ) {
 		"function on_speech(mob, ch, text) mob:say('heard you') end",
 		"hello", 0 );
 	list_push_back( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
 
 	CHAR_DATA *mob = create_mobile( pMobIndex );
 	CHAR_DATA *player = make_full_test_npc();
@@ -284,17 +313,411 @@ void test_script_trigger_speech_no_match( void ) {
 	char_to_room( player, room );
 
 	/* "goodbye" should NOT match "hello" pattern */
+	long evals0, fires0, evals1, fires1;
+	script_trigger_totals( &evals0, &fires0 );
 	script_trigger_speech( player, "goodbye" );
-	TEST_ASSERT_TRUE( TRUE ); /* No crash, pattern did not match */
+	script_trigger_totals( &evals1, &fires1 );
+	/* Our script was evaluated but did not fire */
+	TEST_ASSERT( evals1 - evals0 > fires1 - fires0 );
 
 	list_remove( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
 	TEST_ASSERT_EQ( (int) list_count( &pMobIndex->scripts ), (int) orig_script_count );
 
 	char_from_room( player );
 	char_from_room( mob );
 	free_char( player );
+	free_test_mobile( mob );
+	free_test_script( script );
+}
+
+/* --- Coroutine scheduler tests --- */
+
+static void run_pulses( int n ) {
+	while ( n-- > 0 )
+		script_scheduler_pulse();
+}
+
+void test_script_wait_resumes_after_pulses( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	CHAR_DATA *ch = make_full_test_npc();
+	int threads = script_thread_count();
+
+	SCRIPT_DATA *script = make_test_script( TRIG_GREET,
+		"function on_greet(mob, ch)\n"
+		"  ch:set_gold(1)\n"
+		"  wait(3)\n"
+		"  ch:set_gold(2)\n"
+		"end", NULL, 0 );
+
+	ch->gold = 0;
+	script_run( script, "on_greet", mob, ch, NULL );
+	TEST_ASSERT_EQ( ch->gold, 1 );
+	TEST_ASSERT_EQ( script_thread_count(), threads + 1 );
+
+	run_pulses( 2 );
+	TEST_ASSERT_EQ( ch->gold, 1 );
+	run_pulses( 1 );
+	TEST_ASSERT_EQ( ch->gold, 2 );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+	TEST_ASSERT_EQ( (int) script->resumes, 2 );
+
+	free_test_script( script );
 	free_char( mob );
+	free_char( ch );
+}
+
+void test_script_yield_spreads_loop( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	CHAR_DATA *ch = make_full_test_npc();
+	int threads = script_thread_count();
+
+	SCRIPT_DATA *script = make_test_script( TRIG_GREET,
+		"function on_greet(mob, ch)\n"
+		"  for i = 1, 5 do\n"
+		"    ch:set_gold(i)\n"
+		"    yield()\n"
+		"  end\n"
+		"end", NULL, 0 );
+
+	script_run( script, "on_greet", mob, ch, NULL );
+	TEST_ASSERT_EQ( ch->gold, 1 );
+	run_pulses( 2 );
+	TEST_ASSERT_EQ( ch->gold, 3 );
+	run_pulses( 3 );
+	TEST_ASSERT_EQ( ch->gold, 5 );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+
 	free_test_script( script );
+	free_char( mob );
+	free_char( ch );
+}
+
+void test_script_long_loop_is_preempted( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	CHAR_DATA *ch = make_full_test_npc();
+	int threads = script_thread_count();
+	int pulses = 0;
+
+	/* Several slices of work, but finite: must complete, not be killed */
+	SCRIPT_DATA *script = make_test_script( TRIG_GREET,
+		"function on_greet(mob, ch)\n"
+		"  local n = 0\n"
+		"  for i = 1, 200000 do n = n + 1 end\n"
+		"  ch:set_gold(n)\n"
+		"end", NULL, 0 );
+
+	ch->gold = 0;
+	script_run( script, "on_greet", mob, ch, NULL );
+	TEST_ASSERT_EQ( ch->gold, 0 );
+	TEST_ASSERT_EQ( script_thread_count(), threads + 1 );
+
+	while ( script_thread_count() > threads && pulses < 20 ) {
+		script_scheduler_pulse();
+		pulses++;
+	}
+	TEST_ASSERT_EQ( ch->gold, 200000 );
+	TEST_ASSERT( pulses > 0 );
+
+	free_test_script( script );
+	free_char( mob );
+	free_char( ch );
+}
+
+void test_script_runaway_is_killed( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	CHAR_DATA *ch = make_full_test_npc();
+	int threads = script_thread_count();
+
+	SCRIPT_DATA *script = make_test_script( TRIG_GREET,
+		"function on_greet(mob, ch) while true do end end", NULL, 0 );
+
+	script_run( script, "on_greet", mob, ch, NULL );
+	run_pulses( 100 );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+
+	free_test_script( script );
+	free_char( mob );
+	free_char( ch );
+}
+
+void test_script_wait_for_event( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	CHAR_DATA *ch = make_full_test_npc();
+	CHAR_DATA *other = make_full_test_npc();
+	int threads = script_thread_count();
+
+	SCRIPT_DATA *script = make_test_script( TRIG_SPEECH,
+		"function on_speech(mob, ch, text)\n"
+		"  local who, said = wait_for_event('speech')\n"
+		"  if who and said == 'again' then who:set_gold(42) end\n"
+		"  local none = wait_for_event('never', 2)\n"
+		"  if none == nil then ch:set_gold(7) end\n"
+		"end", NULL, 0 );
+
+	ch->gold = 0;
+	other->gold = 0;
+	script_run( script, "on_speech", mob, ch, "hello" );
+	run_pulses( 5 );
+	TEST_ASSERT_EQ( other->gold, 0 );
+
+	/* Events for another owner are ignored */
+	script_signal_event( ch, "speech", other, "again" );
+	run_pulses( 1 );
+	TEST_ASSERT_EQ( other->gold, 0 );
+
+	/* Delivered on the next pulse, not from inside the signal */
+	script_signal_event( mob, "speech", other, "again" );
+	TEST_ASSERT_EQ( other->gold, 0 );
+	run_pulses( 1 );
+	TEST_ASSERT_EQ( other->gold, 42 );
+
+	/* Second wait times out */
+	TEST_ASSERT_EQ( ch->gold, 0 );
+	run_pulses( 2 );
+	TEST_ASSERT_EQ( ch->gold, 7 );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+
+	free_test_script( script );
+	free_char( mob );
+	free_char( ch );
+	free_char( other );
+}
+
+void test_script_forget_cancels_and_nulls( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	CHAR_DATA *ch = make_full_test_npc();
+	CHAR_DATA *mob2 = make_full_test_npc();
+	int threads = script_thread_count();
+
+	SCRIPT_DATA *script = make_test_script( TRIG_GREET,
+		"function on_greet(mob, ch)\n"
+		"  wait(2)\n"
+		"  ch:set_gold(99)\n"
+		"end", NULL, 0 );
+
+	/* Owner leaves the world: its coroutine is cancelled */
+	ch->gold = 0;
+	script_run( script, "on_greet", mob, ch, NULL );
+	TEST_ASSERT_EQ( script_thread_count(), threads + 1 );
+	free_char( mob );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+	run_pulses( 3 );
+	TEST_ASSERT_EQ( ch->gold, 0 );
+
+	/* Target leaves the world: the script errors cleanly on resume */
+	script_run( script, "on_greet", mob2, ch, NULL );
+	free_char( ch );
+	run_pulses( 3 );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+
+	free_test_script( script );
+	free_char( mob2 );
+}
+
+void test_script_tick_busy_while_waiting( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	int threads = script_thread_count();
+
+	SCRIPT_DATA *script = make_test_script( TRIG_TICK,
+		"function on_tick(mob)\n"
+		"  mob:set_gold(mob:gold() + 1)\n"
+		"  wait(2)\n"
+		"  return false\n"
+		"end", NULL, 0 );
+
+	mob->gold = 0;
+	TEST_ASSERT_TRUE( script_run_tick( script, mob ) );
+	/* Still waiting: no second on_tick is started */
+	TEST_ASSERT_TRUE( script_run_tick( script, mob ) );
+	TEST_ASSERT_EQ( mob->gold, 1 );
+
+	run_pulses( 2 );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+	TEST_ASSERT_TRUE( script_run_tick( script, mob ) );
+	TEST_ASSERT_EQ( mob->gold, 2 );
+
+	free_char( mob );
+	free_test_script( script );
+}
+
+void test_script_wait_outside_coroutine( void ) {
+	ensure_booted();
+	CHAR_DATA *mob = make_full_test_npc();
+	CHAR_DATA *ch = make_full_test_npc();
+	int threads = script_thread_count();
+
+	/* wait() at chunk level runs outside any trigger coroutine */
+	SCRIPT_DATA *script = make_test_script( TRIG_GREET,
+		"wait(1)\n"
+		"function on_greet(mob, ch) ch:set_gold(3) end", NULL, 0 );
+
+	ch->gold = 0;
+	script_run( script, "on_greet", mob, ch, NULL );
+	TEST_ASSERT_EQ( ch->gold, 0 );
+	TEST_ASSERT_EQ( script_thread_count(), threads );
+
+	free_test_script( script );
+	free_char( mob );
+	free_char( ch );
+}
+
+/* --- Subscription index tests --- */
+
+static bool room_has_subscriber( ROOM_INDEX_DATA *room, CHAR_DATA *mob ) {
+	CHAR_DATA *rch;
+	if ( room->dynamic == NULL )
+		return FALSE;
+	LIST_FOR_EACH( rch, &room->dynamic->script_mobs, CHAR_DATA, script_node ) {
+		if ( rch == mob )
+			return TRUE;
+	}
+	return FALSE;
+}
+
+void test_script_sub_follows_room_moves( void ) {
+	ensure_booted();
+	MOB_INDEX_DATA *pMobIndex = get_any_mob_index();
+	ROOM_INDEX_DATA *limbo = get_room_index( ROOM_VNUM_LIMBO );
+	ROOM_INDEX_DATA *altar = get_room_index( ROOM_VNUM_ALTAR );
+	TEST_ASSERT_TRUE( pMobIndex != NULL );
+
+	SCRIPT_DATA *script = make_test_script( TRIG_GREET,
+		"function on_greet(mob, ch) end", NULL, 0 );
+	list_push_back( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
+	TEST_ASSERT_TRUE( IS_SET( pMobIndex->script_trigs, TRIG_GREET ) );
+
+	CHAR_DATA *mob = create_mobile( pMobIndex );
+	char_to_room( mob, limbo );
+	TEST_ASSERT_TRUE( room_has_subscriber( limbo, mob ) );
+
+	char_from_room( mob );
+	TEST_ASSERT_FALSE( room_has_subscriber( limbo, mob ) );
+	char_to_room( mob, altar );
+	TEST_ASSERT_TRUE( room_has_subscriber( altar, mob ) );
+
+	/* Removing the script unsubscribes live instances */
+	list_remove( &pMobIndex->scripts, &script->node );
+	script_index_refresh_mob( pMobIndex );
+	if ( list_empty( &pMobIndex->scripts ) )
+		TEST_ASSERT_FALSE( room_has_subscriber( altar, mob ) );
+
+	char_from_room( mob );
+	free_test_mobile( mob );
+	free_test_script( script );
+}
+
+void test_script_unscripted_mobs_not_visited( void ) {
+	ensure_booted();
+	ROOM_INDEX_DATA *room = get_room_index( ROOM_VNUM_LIMBO );
+	CHAR_DATA *player = make_full_test_npc();
+	CHAR_DATA *npcs[20];
+	long evals0, fires0, evals1, fires1;
+	int i;
+
+	player->act = 0;
+	char_to_room( player, room );
+	for ( i = 0; i < 20; i++ ) {
+		npcs[i] = make_full_test_npc();
+		char_to_room( npcs[i], room );
+	}
+
+	/* Plain NPCs never subscribe, so nothing is evaluated */
+	script_trigger_totals( &evals0, &fires0 );
+	script_trigger_speech( player, "hello there" );
+	script_trigger_greet( player, room );
+	script_trigger_totals( &evals1, &fires1 );
+	if ( room->dynamic == NULL || list_empty( &room->dynamic->script_mobs ) )
+		TEST_ASSERT_EQ( (int) ( evals1 - evals0 ), 0 );
+
+	for ( i = 0; i < 20; i++ ) {
+		char_from_room( npcs[i] );
+		free_char( npcs[i] );
+	}
+	char_from_room( player );
+	free_char( player );
+}
+
+void test_script_obj_tick_only_carried( void ) {
+	ensure_booted();
+	OBJ_INDEX_DATA *pObjIndex = get_unscripted_obj_index();
+	CHAR_DATA *ch = make_full_test_npc();
+	OBJ_DATA *obj;
+	TEST_ASSERT_TRUE( pObjIndex != NULL );
+
+	SCRIPT_DATA *script = make_test_script( TRIG_TICK,
+		"function on_tick(obj, ch) ch:set_gold(ch:gold() + 1) end", NULL, 0 );
+	list_push_back( &pObjIndex->scripts, &script->node );
+	script_index_refresh_obj( pObjIndex );
+
+	ch->gold = 0;
+	obj = create_object( pObjIndex, 1 );
+	script_trigger_obj_tick();
+	TEST_ASSERT_EQ( ch->gold, 0 );    /* Not carried: not subscribed */
+
+	obj_to_char( obj, ch );
+	script_trigger_obj_tick();
+	TEST_ASSERT_EQ( ch->gold, 1 );
+
+	obj_from_char( obj );
+	script_trigger_obj_tick();
+	TEST_ASSERT_EQ( ch->gold, 1 );
+
+	/* Refresh picks up objects that were already carried */
+	list_remove( &pObjIndex->scripts, &script->node );
+	script_index_refresh_obj( pObjIndex );
+	obj_to_char( obj, ch );
+	list_push_back( &pObjIndex->scripts, &script->node );
+	script_index_refresh_obj( pObjIndex );
+	script_trigger_obj_tick();
+	TEST_ASSERT_EQ( ch->gold, 2 );
+
+	/* Extraction while carried unsubscribes */
+	extract_obj( obj );
+	script_trigger_obj_tick();
+	TEST_ASSERT_EQ( ch->gold, 2 );
+
+	list_remove( &pObjIndex->scripts, &script->node );
+	script_index_refresh_obj( pObjIndex );
+	free_test_script( script );
+	free_char( ch );
+}
+
+void test_script_obj_tick_survives_self_extract( void ) {
+	ensure_booted();
+	OBJ_INDEX_DATA *pObjIndex = get_unscripted_obj_index();
+	CHAR_DATA *ch = make_full_test_npc();
+	OBJ_DATA *a, *b;
+	TEST_ASSERT_TRUE( pObjIndex != NULL );
+
+	/* Each object destroys itself from its own tick callback */
+	SCRIPT_DATA *script = make_test_script( TRIG_TICK,
+		"function on_tick(obj, ch) ch:set_gold(ch:gold() + 1) obj:extract() end",
+		NULL, 0 );
+	list_push_back( &pObjIndex->scripts, &script->node );
+	script_index_refresh_obj( pObjIndex );
+
+	ch->gold = 0;
+	a = create_object( pObjIndex, 1 );
+	b = create_object( pObjIndex, 1 );
+	obj_to_char( a, ch );
+	obj_to_char( b, ch );
+	script_trigger_obj_tick();
+	TEST_ASSERT_EQ( ch->gold, 2 );
+	TEST_ASSERT_TRUE( list_empty( &ch->carrying ) );
+
+	list_remove( &pObjIndex->scripts, &script->node );
+	script_index_refresh_obj( pObjIndex );
+	free_test_script( script );
+	free_char( ch );
 }
 
 /* --- Suite registration --- */
@@ -312,4 +735,16 @@ void suite_scripting( void ) {
 	RUN_TEST( test_script_trigger_greet_fires );
 	RUN_TEST( test_script_trigger_speech_matches );
 	RUN_TEST( test_script_trigger_speech_no_match );
+	RUN_TEST( test_script_wait_resumes_after_pulses );
+	RUN_TEST( test_script_yield_spreads_loop );
+	RUN_TEST( test_script_long_loop_is_preempted );
+	RUN_TEST( test_script_runaway_is_killed );
+	RUN_TEST( test_script_wait_for_event );
+	RUN_TEST( test_script_forget_cancels_and_nulls );
+	RUN_TEST( test_script_tick_busy_while_waiting );
+	RUN_TEST( test_script_wait_outside_coroutine );
+	RUN_TEST( test_script_sub_follows_room_moves );
+	RUN_TEST( test_script_unscripted_mobs_not_visited );
+	RUN_TEST( test_script_obj_tick_only_carried );
+	RUN_TEST( test_script_obj_tick_survives_self_extract );
 }
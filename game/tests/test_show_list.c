@@ -0,0 +1,227 @@
+/*
+ * Object list display tests (show_list_to_char in commands/act_info.c)
+ *
+ * Tests:
+ * - Identical objects combine into one counted line, in first-seen order
+ * - Damaged and restrung copies of the same prototype stay separate
+ * - Each line matches format_obj_to_char() for its first object
+ * - Without PLR_COMBINE every object gets its own line
+ * - Empty inventories print "Nothing."
+ * - Benchmark: a 2000-item pile
+ *
+ * Requires boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../systems/profile.h"
+
+extern OBJ_INDEX_DATA *obj_index_hash[MAX_KEY_HASH];
+extern char *format_obj_to_char( OBJ_DATA *obj, CHAR_DATA *ch, bool fShort );
+
+/* Collect up to max distinct object prototypes with distinct short descriptions */
+static int show_list_protos( OBJ_INDEX_DATA **out, int max ) {
+	OBJ_INDEX_DATA *p;
+	int n = 0, i, j;
+
+	for ( i = 0; i < MAX_KEY_HASH && n < max; i++ ) {
+		for ( p = obj_index_hash[i]; p != NULL && n < max; p = p->next ) {
+			if ( p->short_descr == NULL || p->short_descr[0] == '\0' )
+				continue;
+			for ( j = 0; j < n; j++ )
+				if ( !strcmp( out[j]->short_descr, p->short_descr ) )
+					break;
+			if ( j == n )
+				out[n++] = p;
+		}
+	}
+	return n;
+}
+
+/* Fresh object that any viewer can see, added to list */
+static OBJ_DATA *show_list_add( list_head_t *list, OBJ_INDEX_DATA *proto ) {
+	OBJ_DATA *obj = create_object( proto, 0 );
+
+	SET_BIT( obj->extra_flags, ITEM_GLOW );
+	obj->condition = 100;
+	list_push_back( list, &obj->content_node );
+	return obj;
+}
+
+static void show_list_clear( list_head_t *list ) {
+	OBJ_DATA *obj, *obj_next;
+
+	LIST_FOR_EACH_SAFE( obj, obj_next, list, OBJ_DATA, content_node ) {
+		list_remove( list, &obj->content_node );
+		extract_obj( obj );
+	}
+}
+
+static int count_lines( const char *s ) {
+	int n = 0;
+
+	while ( ( s = strstr( s, "\n\r" ) ) != NULL ) {
+		n++;
+		s += 2;
+	}
+	return n;
+}
+
+void test_show_list_combines_in_order( void ) {
+	OBJ_INDEX_DATA *protos[2];
+	OBJ_DATA *a, *b, *damaged, *restrung;
+	DESCRIPTOR_DATA desc;
+	list_head_t list;
+	CHAR_DATA *ch;
+	char expect[MAX_STRING_LENGTH];
+	char line[MAX_STRING_LENGTH];
+	int i;
+
+	ensure_booted();
+	TEST_ASSERT_EQ( show_list_protos( protos, 2 ), 2 );
+
+	ch = make_full_test_npc();
+	memset( &desc, 0, sizeof( desc ) );
+	desc.descriptor = -1;
+	ch->desc = &desc;
+	list_init( &list );
+
+	/* A B A B A, then a damaged A and a restrung A */
+	a = b = NULL;
+	for ( i = 0; i < 5; i++ ) {
+		if ( i % 2 == 0 )
+			a = show_list_add( &list, protos[0] );
+		else
+			b = show_list_add( &list, protos[1] );
+	}
+	damaged = show_list_add( &list, protos[0] );
+	damaged->condition = 50;
+	restrung = show_list_add( &list, protos[0] );
+	free( restrung->short_descr );
+	restrung->short_descr = str_dup( "a lovingly restrung trinket" );
+
+	expect[0] = '\0';
+	snprintf( line, sizeof( line ), "( 3) %s\n\r", format_obj_to_char( a, ch, TRUE ) );
+	strcat( expect, line );
+	snprintf( line, sizeof( line ), "( 2) %s\n\r", format_obj_to_char( b, ch, TRUE ) );
+	strcat( expect, line );
+	snprintf( line, sizeof( line ), "     %s\n\r", format_obj_to_char( damaged, ch, TRUE ) );
+	strcat( expect, line );
+	snprintf( line, sizeof( line ), "     %s\n\r", format_obj_to_char( restrung, ch, TRUE ) );
+	strcat( expect, line );
+
+	test_output_start( ch );
+	show_list_to_char( &list, ch, TRUE, TRUE, FALSE );
+	TEST_ASSERT_STR_EQ( test_output_get(), expect );
+	test_output_stop();
+
+	show_list_clear( &list );
+	ch->desc = NULL;
+	free_char( ch );
+}
+
+void test_show_list_no_combine( void ) {
+	OBJ_INDEX_DATA *proto;
+	DESCRIPTOR_DATA desc;
+	list_head_t list;
+	CHAR_DATA *ch;
+	int i;
+
+	ensure_booted();
+	TEST_ASSERT_EQ( show_list_protos( &proto, 1 ), 1 );
+
+	ch = make_test_player();
+	memset( &desc, 0, sizeof( desc ) );
+	desc.descriptor = -1;
+	ch->desc = &desc;
+	REMOVE_BIT( ch->act, PLR_COMBINE );
+	list_init( &list );
+
+	for ( i = 0; i < 4; i++ )
+		show_list_add( &list, proto );
+
+	test_output_start( ch );
+	show_list_to_char( &list, ch, TRUE, TRUE, FALSE );
+	TEST_ASSERT_EQ( count_lines( test_output_get() ), 4 );
+	TEST_ASSERT( strstr( test_output_get(), "( 4)" ) == NULL );
+	test_output_stop();
+
+	show_list_clear( &list );
+	ch->desc = NULL;
+	free_test_char( ch );
+}
+
+void test_show_list_nothing( void ) {
+	DESCRIPTOR_DATA desc;
+	list_head_t list;
+	CHAR_DATA *ch;
+
+	ensure_booted();
+	ch = make_full_test_npc();
+	memset( &desc, 0, sizeof( desc ) );
+	desc.descriptor = -1;
+	ch->desc = &desc;
+	list_init( &list );
+
+	test_output_start( ch );
+	show_list_to_char( &list, ch, TRUE, TRUE, FALSE );
+	TEST_ASSERT_STR_EQ( test_output_get(), "     Nothing.\n\r" );
+	test_output_clear();
+	show_list_to_char( &list, ch, TRUE, FALSE, FALSE );
+	TEST_ASSERT_STR_EQ( test_output_get(), "" );
+	test_output_stop();
+
+	ch->desc = NULL;
+	free_char( ch );
+}
+
+void test_show_list_bench_2000( void ) {
+	OBJ_INDEX_DATA *protos[20];
+	DESCRIPTOR_DATA desc;
+	list_head_t list;
+	CHAR_DATA *ch;
+	int64_t start, elapsed;
+	int nproto, i, pass;
+
+	ensure_booted();
+	nproto = show_list_protos( protos, 20 );
+	TEST_ASSERT( nproto > 0 );
+	if ( nproto == 0 )
+		return;
+
+	ch = make_full_test_npc();
+	memset( &desc, 0, sizeof( desc ) );
+	desc.descriptor = -1;
+	ch->desc = &desc;
+	list_init( &list );
+
+	for ( i = 0; i < 2000; i++ )
+		show_list_add( &list, protos[i % nproto] );
+
+	test_output_start( ch );
+	start = profile_now_ns();
+	for ( pass = 0; pass < 10; pass++ ) {
+		test_output_clear();
+		show_list_to_char( &list, ch, TRUE, TRUE, FALSE );
+	}
+	elapsed = profile_now_ns() - start;
+	TEST_ASSERT_EQ( count_lines( test_output_get() ), nproto );
+	if ( nproto == 20 )
+		TEST_ASSERT( strstr( test_output_get(), "(100) " ) != NULL );
+	test_output_stop();
+
+	printf( "    [bench] show_list_to_char, 2000 items / %d kinds: %lld us per call\n",
+		nproto, (long long) ( elapsed / 10 / 1000 ) );
+
+	show_list_clear( &list );
+	ch->desc = NULL;
+	free_char( ch );
+}
+
+void suite_show_list( void ) {
+	RUN_TEST( test_show_list_combines_in_order );
+	RUN_TEST( test_show_list_no_combine );
+	RUN_TEST( test_show_list_nothing );
+	RUN_TEST( test_show_list_bench_2000 );
+}
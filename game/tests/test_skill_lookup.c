@@ -0,0 +1,111 @@
+/*
+ * Skill name tests (game/src/combat/magic.c, core/skill_names.h)
+ *
+ * Tests: the boot-resolved gsn_* handles and the hashed skill_lookup()
+ * against the linear skill_table scan they replaced.  Requires
+ * boot_headless().
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+
+/* The lookup as it was before the name index */
+static int linear_skill_lookup( const char *name ) {
+	int sn;
+
+	for ( sn = 0; sn < MAX_SKILL; sn++ ) {
+		if ( skill_table[sn].name == NULL )
+			break;
+		if ( tolower( name[0] ) == tolower( skill_table[sn].name[0] ) && !str_prefix( name, skill_table[sn].name ) )
+			return sn;
+	}
+
+	return -1;
+}
+
+typedef struct {
+	int *pgsn;
+	const char *name;
+} NAMED_GSN;
+
+void test_skill_handles_match_linear( void ) {
+	static const NAMED_GSN handles[] = {
+#define SKILL_X( gsn, name ) { &gsn, name },
+		SKILL_NAME_ENTRIES
+#undef SKILL_X
+		/* Literals that were rewritten to an existing pgsn handle */
+		{ &gsn_blindness, "blindness" },
+		{ &gsn_charm_person, "charm" },
+		{ &gsn_charm_person, "charm person" },
+		{ &gsn_curse, "curse" },
+		{ &gsn_drowfire, "drowfire" },
+		{ &gsn_invis, "invis" },
+		{ &gsn_sleep, "sleep" },
+		{ &gsn_spew, "spew" },
+		{ &gsn_web, "web" },
+	};
+	size_t i;
+
+	ensure_booted();
+	for ( i = 0; i < sizeof( handles ) / sizeof( handles[0] ); i++ ) {
+		if ( *handles[i].pgsn != linear_skill_lookup( handles[i].name ) )
+			fprintf( stderr, "    handle for \"%s\" is stale\n", handles[i].name );
+		TEST_ASSERT_EQ( *handles[i].pgsn, linear_skill_lookup( handles[i].name ) );
+	}
+}
+
+void test_skill_handles_spot_checks( void ) {
+	ensure_booted();
+
+	TEST_ASSERT_STR_EQ( skill_table[gsn_clay_ball].name, "clay ball" );
+	TEST_ASSERT_STR_EQ( skill_table[gsn_reserved].name, "reserved" );
+	TEST_ASSERT_TRUE( gsn_fireball_spell != gsn_fireball );
+	TEST_ASSERT_STR_EQ( skill_table[gsn_fireball_spell].name, "fireball" );
+	TEST_ASSERT_EQ( gsn_cone, -1 );
+}
+
+/* Every prefix of every name, as written, lowercased and uppercased */
+void test_skill_lookup_prefixes_match_linear( void ) {
+	char buf[MAX_INPUT_LENGTH];
+	int sn, len, i, checked = 0;
+
+	for ( sn = 0; sn < MAX_SKILL && skill_table[sn].name != NULL; sn++ ) {
+		const char *name = skill_table[sn].name;
+
+		for ( len = 1; len <= (int) strlen( name ); len++ ) {
+			memcpy( buf, name, len );
+			buf[len] = '\0';
+			TEST_ASSERT_EQ( skill_lookup( buf ), linear_skill_lookup( buf ) );
+			for ( i = 0; i < len; i++ )
+				buf[i] = (char) toupper( buf[i] );
+			TEST_ASSERT_EQ( skill_lookup( buf ), linear_skill_lookup( buf ) );
+			for ( i = 0; i < len; i++ )
+				buf[i] = (char) tolower( buf[i] );
+			TEST_ASSERT_EQ( skill_lookup( buf ), linear_skill_lookup( buf ) );
+			checked++;
+		}
+	}
+	TEST_ASSERT_TRUE( checked > MAX_SKILL );
+}
+
+void test_skill_lookup_misses_match_linear( void ) {
+	static const char *misses[] = {
+		"", " ", " fireball", "fireballs", "fireball ", "cone", "zzz", "123",
+		"imp fireballx", "charm personal", "sanctuaryyyyyyyyyyyyyyyyyyyyyyyyyyyyy",
+		"\xe9t\xe9", "#rfireball",
+	};
+	size_t i;
+
+	for ( i = 0; i < sizeof( misses ) / sizeof( misses[0] ); i++ ) {
+		TEST_ASSERT_EQ( skill_lookup( misses[i] ), linear_skill_lookup( misses[i] ) );
+		TEST_ASSERT_EQ( skill_lookup( misses[i] ), -1 );
+	}
+}
+
+void suite_skill_lookup( void ) {
+	RUN_TEST( test_skill_handles_match_linear );
+	RUN_TEST( test_skill_handles_spot_checks );
+	RUN_TEST( test_skill_lookup_prefixes_match_linear );
+	RUN_TEST( test_skill_lookup_misses_match_linear );
+}
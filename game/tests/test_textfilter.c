@@ -0,0 +1,353 @@
+/*
+ * Text filter tests (game/src/systems/textfilter.c)
+ *
+ * Tests:
+ * - Name checks agree with the per-row loop check_parse_name() used to
+ *   run, on a corpus of names against the shipped tables and against
+ *   several hundred extra generated rules
+ * - Lookalike spellings of reserved names are caught on the skeleton
+ * - Chat masking: case, lookalikes, overlapping matches, clean lines
+ * - Chat masking leaves words that only contain a pattern alone
+ * - Throughput of the loop against the automaton for names and chat
+ *
+ * Requires boot (the tables load from game.db with the game).
+ */
+
+#include "test_framework.h"
+#include "test_helpers.h"
+#include "merc.h"
+#include "../core/utf8.h"
+#include "../db/db_game.h"
+#include "../systems/textfilter.h"
+#include "../systems/profile.h"
+
+#define EXTRA_RULES	 600
+#define GEN_NAMES	 4000
+#define BENCH_PASSES 20
+
+/* Steps 5 and 6 of check_parse_name() as they were */
+static bool legacy_name_blocked( char *name ) {
+	char skeleton[256];
+	FORBIDDEN_NAME *fn;
+	PROFANITY_FILTER *pf;
+
+	LIST_FOR_EACH( fn, &forbidden_name_list, FORBIDDEN_NAME, node ) {
+		switch ( fn->type ) {
+		case NAMETYPE_RESERVED:
+		case NAMETYPE_BLOCKED:
+			if ( !str_cmp( name, fn->name ) )
+				return TRUE;
+			break;
+		case NAMETYPE_PROTECTED:
+			if ( is_contained( fn->name, name ) && str_cmp( name, fn->name ) )
+				return TRUE;
+			break;
+		}
+	}
+
+	utf8_skeletonize( name, skeleton, sizeof( skeleton ) );
+	LIST_FOR_EACH( pf, &profanity_filter_list, PROFANITY_FILTER, node ) {
+		if ( is_contained( pf->pattern, skeleton ) )
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* The loop a chat line would have needed */
+static bool legacy_chat_profane( const char *text ) {
+	static char skeleton[MAX_STRING_LENGTH];
+	PROFANITY_FILTER *pf;
+
+	utf8_skeletonize( text, skeleton, sizeof( skeleton ) );
+	LIST_FOR_EACH( pf, &profanity_filter_list, PROFANITY_FILTER, node ) {
+		if ( is_contained( pf->pattern, skeleton ) )
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static char *corpus[] = {
+	"Alice", "Bob", "Zarathustra", "Kip", "Gaia", "GAIA", "gaiaborn",
+	"All", "Allison", "Tall", "Wtf", "Wtfbbq", "Self", "Selfish", "Someone",
+	"Noneya", "Immortal", "Immortals", "Automaton", "Auto", "Fuckface",
+	"Bitchy", "Whorehouse", "Shitake", "Scunthorpe", "Mitchell", "Sunset",
+	"Xyzzy", "Quinn", "Elbereth", "Aragorn", "Legolas", "Gimli", "Frodo"
+};
+
+static char *chat_corpus[] = {
+	"anyone want to group for the dragon in the north?",
+	"lol that was a fuckin mess, the healer left halfway through",
+	"selling a sword of sharpness, tell me offers",
+	"BITCH please, that build is garbage",
+	"has anyone seen the new quest board? it shows unread now",
+	"whoreson! you stole my kill",
+	"gg all, thanks for the run",
+	"brb, dinner"
+};
+
+static void gen_word( char *buf, int len ) {
+	int i;
+
+	for ( i = 0; i < len; i++ )
+		buf[i] = 'a' + number_range( 0, 25 );
+	buf[len] = '\0';
+}
+
+/* Extra rules on the live tables, tracked so they can be taken off again */
+static void add_extra_rules( void ) {
+	char word[16];
+	int i;
+
+	for ( i = 0; i < EXTRA_RULES; i++ ) {
+		gen_word( word, number_range( 3, 7 ) );
+		if ( i % 3 == 0 ) {
+			PROFANITY_FILTER *pf = calloc( 1, sizeof( PROFANITY_FILTER ) );
+			pf->pattern = str_dup( word );
+			list_push_back( &profanity_filter_list, &pf->node );
+		} else {
+			FORBIDDEN_NAME *fn = calloc( 1, sizeof( FORBIDDEN_NAME ) );
+			fn->name = str_dup( word );
+			fn->type = i % 3 == 1 ? NAMETYPE_PROTECTED : NAMETYPE_RESERVED;
+			list_push_back( &forbidden_name_list, &fn->node );
+		}
+	}
+	textfilter_rebuild();
+}
+
+static void remove_extra_rules( void ) {
+	FORBIDDEN_NAME *fn, *fn_next;
+	PROFANITY_FILTER *pf, *pf_next;
+	int keep;
+
+	/* The extras are at the tail of each list */
+	keep = list_count( &forbidden_name_list ) - ( EXTRA_RULES - EXTRA_RULES / 3 );
+	LIST_FOR_EACH_SAFE( fn, fn_next, &forbidden_name_list, FORBIDDEN_NAME, node ) {
+		if ( keep-- > 0 )
+			continue;
+		list_remove( &forbidden_name_list, &fn->node );
+		free( fn->name );
+		free( fn );
+	}
+
+	keep = list_count( &profanity_filter_list ) - EXTRA_RULES / 3;
+	LIST_FOR_EACH_SAFE( pf, pf_next, &profanity_filter_list, PROFANITY_FILTER, node ) {
+		if ( keep-- > 0 )
+			continue;
+		list_remove( &profanity_filter_list, &pf->node );
+		free( pf->pattern );
+		free( pf );
+	}
+	textfilter_rebuild();
+}
+
+/* Random names, some built around an existing rule */
+static void gen_names( char names[][32] ) {
+	FORBIDDEN_NAME *fn;
+	char word[16];
+	int i, k;
+
+	for ( i = 0; i < GEN_NAMES; i++ ) {
+		gen_word( names[i], number_range( 3, 12 ) );
+		if ( i % 4 != 0 )
+			continue;
+
+		/* Pick a rule and use it whole, or inside a longer name */
+		k = number_range( 0, list_count( &forbidden_name_list ) - 1 );
+		LIST_FOR_EACH( fn, &forbidden_name_list, FORBIDDEN_NAME, node )
+			if ( k-- == 0 )
+				break;
+		if ( i % 8 == 0 ) {
+			snprintf( names[i], 32, "%s", fn->name );
+		} else {
+			gen_word( word, number_range( 0, 3 ) );
+			snprintf( names[i], 32, "%s%s", word, fn->name );
+		}
+		if ( i % 16 == 4 )
+			names[i][0] = toupper( (unsigned char) names[i][0] );
+	}
+}
+
+static void test_names_match_loop( void ) {
+	static char names[GEN_NAMES][32];
+	size_t i;
+	int blocked = 0;
+
+	/* Shipped tables */
+	for ( i = 0; i < sizeof( corpus ) / sizeof( corpus[0] ); i++ )
+		TEST_ASSERT_EQ( textfilter_name_blocked( corpus[i] ), legacy_name_blocked( corpus[i] ) );
+
+	/* Many more rules */
+	seed_rng( 48 );
+	add_extra_rules();
+	gen_names( names );
+	for ( i = 0; i < GEN_NAMES; i++ ) {
+		bool want = legacy_name_blocked( names[i] );
+
+		TEST_ASSERT_EQ( textfilter_name_blocked( names[i] ), want );
+		blocked += want;
+	}
+	for ( i = 0; i < sizeof( corpus ) / sizeof( corpus[0] ); i++ )
+		TEST_ASSERT_EQ( textfilter_name_blocked( corpus[i] ), legacy_name_blocked( corpus[i] ) );
+	remove_extra_rules();
+
+	/* Both outcomes were exercised */
+	TEST_ASSERT( blocked > 0 );
+	TEST_ASSERT( blocked < GEN_NAMES );
+}
+
+static void test_rebuild_follows_tables( void ) {
+	PROFANITY_FILTER *pf = calloc( 1, sizeof( PROFANITY_FILTER ) );
+
+	TEST_ASSERT( !textfilter_name_blocked( "Grobnik" ) );
+
+	pf->pattern = str_dup( "GROB" );
+	list_push_back( &profanity_filter_list, &pf->node );
+	textfilter_rebuild();
+	TEST_ASSERT( textfilter_name_blocked( "Grobnik" ) );
+	TEST_ASSERT( textfilter_name_blocked( "xxgrob" ) );
+
+	list_remove( &profanity_filter_list, &pf->node );
+	free( pf->pattern );
+	free( pf );
+	textfilter_rebuild();
+	TEST_ASSERT( !textfilter_name_blocked( "Grobnik" ) );
+}
+
+static void test_lookalike_names( void ) {
+	/* Fullwidth letters skeletonize to ASCII */
+	TEST_ASSERT( textfilter_name_blocked( "\xef\xbd\x87\xef\xbd\x81\xef\xbd\x89\xef\xbd\x81" ) );	/* gaia */
+	TEST_ASSERT( textfilter_name_blocked( "\xef\xbd\x86\xef\xbd\x95\xef\xbd\x83\xef\xbd\x8b" "er" ) ); /* fucker */
+	TEST_ASSERT( !textfilter_name_blocked( "\xef\xbd\x87\xef\xbd\x81\xef\xbd\x89\xef\xbd\x8c" ) );	/* gail */
+}
+
+static void test_chat_mask( void ) {
+	char out[MAX_STRING_LENGTH];
+
+	TEST_ASSERT( !textfilter_mask( "gg all, thanks for the run", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "gg all, thanks for the run" );
+
+	TEST_ASSERT( textfilter_mask( "what the fuck", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "what the ****" );
+
+	TEST_ASSERT( textfilter_mask( "#RFuCk#n off", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "#R****#n off" );
+
+	/* Next to each other, and one codepoint per star */
+	TEST_ASSERT( textfilter_mask( "bitch,whore!", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "*****,*****!" );
+	TEST_ASSERT( textfilter_mask( "a \xef\xbd\x86\xef\xbd\x95\xef\xbd\x83\xef\xbd\x8b b", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "a **** b" );
+
+	/* Other UTF-8 passes through untouched */
+	TEST_ASSERT( !textfilter_mask( "caf\xc3\xa9 \xe2\x9c\x93", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "caf\xc3\xa9 \xe2\x9c\x93" );
+
+	/* Never overruns a small buffer */
+	textfilter_mask( "fuck fuck fuck", out, 6 );
+	TEST_ASSERT_STR_EQ( out, "**** " );
+}
+
+/* Patterns that turn up inside everyday words */
+static char *innocent_patterns[] = { "ass", "cunt", "tit", "hell", "cock" };
+
+static char *innocent_corpus[] = {
+	"anyone from scunthorpe on tonight?",
+	"the assassin class is overpowered",
+	"check the title on that quest, it says Hello",
+	"Shellfish stew heals more than you'd think",
+	"Hancock the smith buys swords at a fair price",
+	"#RPetition#n the imms for a constitution reset"
+};
+
+static void test_chat_mask_innocent_words( void ) {
+	PROFANITY_FILTER *pf[sizeof( innocent_patterns ) / sizeof( innocent_patterns[0] )];
+	char out[MAX_STRING_LENGTH];
+	size_t i;
+
+	for ( i = 0; i < sizeof( pf ) / sizeof( pf[0] ); i++ ) {
+		pf[i] = calloc( 1, sizeof( PROFANITY_FILTER ) );
+		pf[i]->pattern = str_dup( innocent_patterns[i] );
+		list_push_back( &profanity_filter_list, &pf[i]->node );
+	}
+	textfilter_rebuild();
+
+	for ( i = 0; i < sizeof( innocent_corpus ) / sizeof( innocent_corpus[0] ); i++ ) {
+		TEST_ASSERT( !textfilter_mask( innocent_corpus[i], out, sizeof( out ) ) );
+		TEST_ASSERT_STR_EQ( out, innocent_corpus[i] );
+	}
+
+	/* The same patterns standing alone are still caught */
+	TEST_ASSERT( textfilter_mask( "what the hell, you ass", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "what the ****, you ***" );
+	TEST_ASSERT( textfilter_mask( "#RCunt#n", out, sizeof( out ) ) );
+	TEST_ASSERT_STR_EQ( out, "#R****#n" );
+
+	/* Names are still checked anywhere in the name */
+	TEST_ASSERT( textfilter_name_blocked( "Scunthorpe" ) );
+
+	for ( i = 0; i < sizeof( pf ) / sizeof( pf[0] ); i++ ) {
+		list_remove( &profanity_filter_list, &pf[i]->node );
+		free( pf[i]->pattern );
+		free( pf[i] );
+	}
+	textfilter_rebuild();
+}
+
+static void test_bench_filter( void ) {
+	static char names[GEN_NAMES][32];
+	long long start, legacy_ns, ac_ns, legacy_chat_ns, ac_chat_ns;
+	volatile int sink = 0;
+	int pass, i;
+	size_t c;
+
+	seed_rng( 4848 );
+	add_extra_rules();
+	gen_names( names );
+
+	start = profile_now_ns();
+	for ( pass = 0; pass < BENCH_PASSES; pass++ )
+		for ( i = 0; i < GEN_NAMES; i++ )
+			sink += legacy_name_blocked( names[i] );
+	legacy_ns = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( pass = 0; pass < BENCH_PASSES; pass++ )
+		for ( i = 0; i < GEN_NAMES; i++ )
+			sink += textfilter_name_blocked( names[i] );
+	ac_ns = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( pass = 0; pass < BENCH_PASSES * 50; pass++ )
+		for ( c = 0; c < sizeof( chat_corpus ) / sizeof( chat_corpus[0] ); c++ )
+			sink += legacy_chat_profane( chat_corpus[c] );
+	legacy_chat_ns = profile_now_ns() - start;
+
+	start = profile_now_ns();
+	for ( pass = 0; pass < BENCH_PASSES * 50; pass++ )
+		for ( c = 0; c < sizeof( chat_corpus ) / sizeof( chat_corpus[0] ); c++ ) {
+			char out[MAX_STRING_LENGTH];
+			sink += textfilter_mask( chat_corpus[c], out, sizeof( out ) );
+		}
+	ac_chat_ns = profile_now_ns() - start;
+
+	printf( "    [bench] %d names x %d, %d rules: loop %lld us, automaton %lld us\n",
+		GEN_NAMES, BENCH_PASSES, list_count( &forbidden_name_list ) + list_count( &profanity_filter_list ),
+		legacy_ns / 1000, ac_ns / 1000 );
+	printf( "    [bench] %d chat lines: loop (detect only) %lld us, automaton (mask) %lld us\n",
+		BENCH_PASSES * 50 * (int) ( sizeof( chat_corpus ) / sizeof( chat_corpus[0] ) ),
+		legacy_chat_ns / 1000, ac_chat_ns / 1000 );
+	TEST_ASSERT( sink > 0 );
+
+	remove_extra_rules();
+}
+
+void suite_textfilter( void ) {
+	if ( !ensure_booted() ) return;
+
+	RUN_TEST( test_names_match_loop );
+	RUN_TEST( test_rebuild_follows_tables );
+	RUN_TEST( test_lookalike_names );
+	RUN_TEST( test_chat_mask );
+	RUN_TEST( test_chat_mask_innocent_words );
+	RUN_TEST( test_bench_filter );
+}
@@ -38,6 +38,7 @@ function load_config() {
         'description'    => 'A dark cyberpunk text-based multiplayer game.',
         'theme'          => 'cyberpunk',
         'player_db_path' => '/home/mud/fatu/edition/gamedata/db/players',
+        'profile_json_path' => '/home/mud/fatu/edition/gamedata/run/profile.json',
     );
     if (file_exists($config_file)) {
         $json = file_get_contents($config_file);
@@ -188,6 +189,19 @@ if (isset($_SESSION['admin_name'])) {
     }
 }
 
+// -- Profiler snapshot (polled by the Performance panel) ----------------------
+
+if ($logged_in && isset($_GET['metrics'])) {
+    header('Content-Type: application/json');
+    header('Cache-Control: no-store');
+    $snapshot = false;
+    if (is_readable($config['profile_json_path'])) {
+        $snapshot = file_get_contents($config['profile_json_path']);
+    }
+    echo ($snapshot !== false && $snapshot !== '') ? $snapshot : '{}';
+    exit;
+}
+
 // -- Handle POST: login or config save ----------------------------------------
 
 if ($_SERVER['REQUEST_METHOD'] === 'POST') {
@@ -330,10 +344,70 @@ $csrf = generate_csrf();
         </form>
     </div>
 
+    <!-- ============ Performance ============ -->
+    <div class="panel">
+        <h2>Performance</h2>
+        <p class="muted" id="perf-status">
+            Waiting for a profiler snapshot. In game: <code>profile on</code>
+            (snapshots are written every 10s while profiling).
+        </p>
+        <table class="perf" id="perf-tick"></table>
+        <table class="perf" id="perf-markers"></table>
+    </div>
+
     <div class="footer">
         <a href="index.php">&larr; View public page</a>
     </div>
 
+    <script>
+    (function () {
+        function ms(us) { return (us / 1000).toFixed(2); }
+        function esc(s) {
+            return String(s).replace(/[&<>"]/g, function (c) {
+                return { '&': '&amp;', '<': '&lt;', '>': '&gt;', '"': '&quot;' }[c];
+            });
+        }
+        function render(d) {
+            var status = document.getElementById('perf-status');
+            if (!d || !d.tick) {
+                return;
+            }
+            var age = Math.round(Date.now() / 1000 - d.timestamp);
+            status.textContent = (d.enabled ? 'Profiling on' : 'Profiling off')
+                + ' \u2014 snapshot ' + age + 's old, ' + d.tick.count + ' pulses over '
+                + d.sample_seconds + 's (budget ' + ms(d.pulse_budget_us) + 'ms)';
+
+            var t = d.tick;
+            document.getElementById('perf-tick').innerHTML =
+                '<tr><th>Pulse</th><th>p50</th><th>p90</th><th>p99</th><th>p99.9</th><th>max</th><th>over</th></tr>'
+                + '<tr><td>ms</td><td>' + ms(t.p50_us) + '</td><td>' + ms(t.p90_us) + '</td>'
+                + '<td class="' + (t.p99_us > d.pulse_budget_us ? 'perf-bad' : '') + '">' + ms(t.p99_us) + '</td>'
+                + '<td>' + ms(t.p999_us) + '</td><td>' + ms(t.max_us) + '</td><td>' + t.overbudget + '</td></tr>';
+
+            var rows = '<tr><th>Marker</th><th>calls</th><th>total ms</th><th>self ms</th><th>p99 ms</th></tr>';
+            var m = (d.markers || []).slice().sort(function (a, b) { return b.total_us - a.total_us; });
+            for (var i = 0; i < m.length && i < 15; i++) {
+                rows += '<tr><td>' + esc(m[i].name) + '</td><td>' + m[i].calls + '</td><td>'
+                    + ms(m[i].total_us) + '</td><td>' + ms(m[i].self_us) + '</td><td>'
+                    + ms(m[i].p99_us) + '</td></tr>';
+            }
+            document.getElementById('perf-markers').innerHTML = m.length ? rows : '';
+        }
+        function poll() {
+            var xhr = new XMLHttpRequest();
+            xhr.open('GET', 'admin.php?metrics=1', true);
+            xhr.onload = function () {
+                if (xhr.status === 200) {
+                    try { render(JSON.parse(xhr.responseText)); } catch (e) { }
+                }
+            };
+            xhr.send();
+        }
+        poll();
+        setInterval(poll, 5000);
+    })();
+    </script>
+
     <?php endif; ?>
 
 </div>